@@ -35,6 +35,8 @@
 #include "core/io/resource_loader.h"
 #include "core/math/math_funcs.h"
 #include "core/os/copymem.h"
+#include "core/os/mutex.h"
+#include "core/os/thread_work_pool.h"
 #include "core/print_string.h"
 
 #include "thirdparty/misc/hq2x.h"
@@ -365,14 +367,141 @@ int Image::get_mipmap_count() const {
 		return 0;
 }
 
+ThreadWorkPool *Image::work_pool = NULL;
+Mutex *Image::work_pool_mutex = NULL;
+
+void Image::setup_work_pool() {
+
+	ERR_FAIL_COND(work_pool_mutex != NULL);
+	//not recursive, so an operation that runs inside another one can not reenter the pool
+	work_pool_mutex = Mutex::create(false);
+}
+
+void Image::finish_work_pool() {
+
+	if (work_pool) {
+		work_pool->finish();
+		memdelete(work_pool);
+		work_pool = NULL;
+	}
+
+	if (work_pool_mutex) {
+		memdelete(work_pool_mutex);
+		work_pool_mutex = NULL;
+	}
+}
+
+ThreadWorkPool *Image::lock_work_pool() {
+
+	//images processed at the same time (e.g. by import threads) do not wait for each other, only one of them gets the pool
+	if (!work_pool_mutex || work_pool_mutex->try_lock() != OK) {
+		return NULL;
+	}
+
+	if (!work_pool) {
+		//threads are only created once an image is large enough to need them
+		work_pool = memnew(ThreadWorkPool);
+		work_pool->init();
+	}
+
+	if (work_pool->get_thread_count() == 0) {
+		work_pool_mutex->unlock();
+		return NULL;
+	}
+
+	return work_pool;
+}
+
+void Image::unlock_work_pool() {
+
+	work_pool_mutex->unlock();
+}
+
+enum {
+	IMAGE_ROW_CHUNK_PIXELS = 65536 // smallest amount of destination pixels worth a job
+};
+
+// processes destination rows [p_from_row, p_to_row)
+typedef void (*ImageRowFunc)(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row);
+
+template <class C>
+struct ImageRowChunks {
+
+	C *job;
+	uint32_t rows;
+	uint32_t rows_per_chunk;
+
+	void process_chunk(uint32_t p_chunk, void *p_userdata) {
+
+		uint32_t from = p_chunk * rows_per_chunk;
+		job->process_rows(from, MIN(from + rows_per_chunk, rows));
+	}
+};
+
+static uint32_t _get_rows_per_chunk(uint32_t p_width) {
+
+	return MAX(IMAGE_ROW_CHUNK_PIXELS / MAX(p_width, 1u), 1u);
+}
+
+// Calls p_job->process_rows() on chunks of rows, split across the work pool when there is more than one chunk.
+template <class C>
+static void _process_row_job(C *p_job, uint32_t p_rows, uint32_t p_rows_per_chunk) {
+
+	ImageRowChunks<C> chunks;
+	chunks.job = p_job;
+	chunks.rows = p_rows;
+	chunks.rows_per_chunk = p_rows_per_chunk;
+
+	uint32_t chunk_count = (p_rows + p_rows_per_chunk - 1) / p_rows_per_chunk;
+	ThreadWorkPool *pool = chunk_count > 1 ? Image::lock_work_pool() : NULL;
+
+	if (!pool) {
+		p_job->process_rows(0, p_rows);
+		return;
+	}
+
+	pool->do_work(chunk_count, &chunks, &ImageRowChunks<C>::process_chunk, (void *)NULL);
+	Image::unlock_work_pool();
+}
+
+struct ImageRowFuncJob {
+
+	ImageRowFunc func;
+	const uint8_t *src;
+	uint8_t *dst;
+	uint32_t src_width;
+	uint32_t src_height;
+	uint32_t dst_width;
+	uint32_t dst_height;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+
+		func(src, dst, src_width, src_height, dst_width, dst_height, p_from, p_to);
+	}
+};
+
+static void _process_rows(ImageRowFunc p_func, const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+
+	ImageRowFuncJob job;
+	job.func = p_func;
+	job.src = p_src;
+	job.dst = p_dst;
+	job.src_width = p_src_width;
+	job.src_height = p_src_height;
+	job.dst_width = p_dst_width;
+	job.dst_height = p_dst_height;
+
+	_process_row_job(&job, p_dst_height, _get_rows_per_chunk(p_dst_width));
+}
+
 //using template generates perfectly optimized code due to constant expression reduction and unused variable removal present in all compilers
 template <uint32_t read_bytes, bool read_alpha, uint32_t write_bytes, bool write_alpha, bool read_gray, bool write_gray>
-static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p_dst) {
+static void _convert(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	uint32_t max_bytes = MAX(read_bytes, write_bytes);
 
-	for (int y = 0; y < p_height; y++) {
-		for (int x = 0; x < p_width; x++) {
+	for (uint32_t y = p_from_row; y < p_to_row; y++) {
+		for (uint32_t x = 0; x < p_width; x++) {
 
 			const uint8_t *rofs = &p_src[((y * p_width) + x) * (read_bytes + (read_alpha ? 1 : 0))];
 			uint8_t *wofs = &p_dst[((y * p_width) + x) * (write_bytes + (write_alpha ? 1 : 0))];
@@ -412,6 +541,75 @@ static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p
 	}
 }
 
+//same results as going through get_pixel() and set_pixel(), missing channels are 0 and missing alpha is 1
+template <uint32_t read_channels, uint32_t write_channels>
+static void _convert_unorm8_to_float(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
+
+	const uint8_t *src = &p_src[p_from_row * p_width * read_channels];
+	float *dst = &reinterpret_cast<float *>(p_dst)[p_from_row * p_width * write_channels];
+	uint32_t count = (p_to_row - p_from_row) * p_width;
+
+	for (uint32_t i = 0; i < count; i++) {
+
+		for (uint32_t j = 0; j < write_channels; j++) {
+			dst[j] = j < read_channels ? float(src[j] / 255.0) : (j == 3 ? 1.0f : 0.0f);
+		}
+
+		src += read_channels;
+		dst += write_channels;
+	}
+}
+
+template <uint32_t read_channels, uint32_t write_channels>
+static void _convert_float_to_unorm8(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
+
+	const float *src = &reinterpret_cast<const float *>(p_src)[p_from_row * p_width * read_channels];
+	uint8_t *dst = &p_dst[p_from_row * p_width * write_channels];
+	uint32_t count = (p_to_row - p_from_row) * p_width;
+
+	for (uint32_t i = 0; i < count; i++) {
+
+		for (uint32_t j = 0; j < write_channels; j++) {
+			dst[j] = j < read_channels ? uint8_t(CLAMP(src[j] * 255.0, 0, 255)) : (j == 3 ? 255 : 0);
+		}
+
+		src += read_channels;
+		dst += write_channels;
+	}
+}
+
+//indexed by channel count - 1 of the source and destination formats
+static const ImageRowFunc _convert_unorm8_to_float_funcs[4][4] = {
+	{ _convert_unorm8_to_float<1, 1>, _convert_unorm8_to_float<1, 2>, _convert_unorm8_to_float<1, 3>, _convert_unorm8_to_float<1, 4> },
+	{ _convert_unorm8_to_float<2, 1>, _convert_unorm8_to_float<2, 2>, _convert_unorm8_to_float<2, 3>, _convert_unorm8_to_float<2, 4> },
+	{ _convert_unorm8_to_float<3, 1>, _convert_unorm8_to_float<3, 2>, _convert_unorm8_to_float<3, 3>, _convert_unorm8_to_float<3, 4> },
+	{ _convert_unorm8_to_float<4, 1>, _convert_unorm8_to_float<4, 2>, _convert_unorm8_to_float<4, 3>, _convert_unorm8_to_float<4, 4> }
+};
+
+static const ImageRowFunc _convert_float_to_unorm8_funcs[4][4] = {
+	{ _convert_float_to_unorm8<1, 1>, _convert_float_to_unorm8<1, 2>, _convert_float_to_unorm8<1, 3>, _convert_float_to_unorm8<1, 4> },
+	{ _convert_float_to_unorm8<2, 1>, _convert_float_to_unorm8<2, 2>, _convert_float_to_unorm8<2, 3>, _convert_float_to_unorm8<2, 4> },
+	{ _convert_float_to_unorm8<3, 1>, _convert_float_to_unorm8<3, 2>, _convert_float_to_unorm8<3, 3>, _convert_float_to_unorm8<3, 4> },
+	{ _convert_float_to_unorm8<4, 1>, _convert_float_to_unorm8<4, 2>, _convert_float_to_unorm8<4, 3>, _convert_float_to_unorm8<4, 4> }
+};
+
+struct ImagePixelConvertJob {
+
+	Image *src;
+	Image *dst;
+	int width;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+
+		for (uint32_t y = p_from; y < p_to; y++) {
+			for (int x = 0; x < width; x++) {
+
+				dst->set_pixel(x, y, src->get_pixel(x, y));
+			}
+		}
+	}
+};
+
 void Image::convert(Format p_new_format) {
 
 	if (data.size() == 0)
@@ -427,20 +625,39 @@ void Image::convert(Format p_new_format) {
 
 	} else if (format > FORMAT_RGBA8 || p_new_format > FORMAT_RGBA8) {
 
-		//use put/set pixel which is slower but works with non byte formats
 		Image new_img(width, height, 0, p_new_format);
-		lock();
-		new_img.lock();
 
-		for (int i = 0; i < width; i++) {
-			for (int j = 0; j < height; j++) {
+		bool from_unorm8 = format >= FORMAT_R8 && format <= FORMAT_RGBA8;
+		bool from_float = format >= FORMAT_RF && format <= FORMAT_RGBAF;
+		bool to_unorm8 = p_new_format >= FORMAT_R8 && p_new_format <= FORMAT_RGBA8;
+		bool to_float = p_new_format >= FORMAT_RF && p_new_format <= FORMAT_RGBAF;
+
+		if ((from_unorm8 && to_float) || (from_float && to_unorm8)) {
 
-				new_img.set_pixel(i, j, get_pixel(i, j));
+			PoolVector<uint8_t>::Read r = data.read();
+			PoolVector<uint8_t>::Write w = new_img.data.write();
+
+			if (from_unorm8) {
+				_process_rows(_convert_unorm8_to_float_funcs[format - FORMAT_R8][p_new_format - FORMAT_RF], r.ptr(), w.ptr(), width, height, width, height);
+			} else {
+				_process_rows(_convert_float_to_unorm8_funcs[format - FORMAT_RF][p_new_format - FORMAT_R8], r.ptr(), w.ptr(), width, height, width, height);
 			}
-		}
 
-		unlock();
-		new_img.unlock();
+		} else {
+
+			//use put/set pixel which is slower but works with non byte formats
+			lock();
+			new_img.lock();
+
+			ImagePixelConvertJob job;
+			job.src = this;
+			job.dst = &new_img;
+			job.width = width;
+			_process_row_job(&job, height, _get_rows_per_chunk(width));
+
+			unlock();
+			new_img.unlock();
+		}
 
 		if (has_mipmaps()) {
 			new_img.generate_mipmaps();
@@ -460,39 +677,44 @@ void Image::convert(Format p_new_format) {
 	uint8_t *wptr = w.ptr();
 
 	int conversion_type = format | p_new_format << 8;
+	ImageRowFunc convert_func = NULL;
 
 	switch (conversion_type) {
 
-		case FORMAT_L8 | (FORMAT_LA8 << 8): _convert<1, false, 1, true, true, true>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_R8 << 8): _convert<1, false, 1, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_RG8 << 8): _convert<1, false, 2, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_RGB8 << 8): _convert<1, false, 3, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_L8 | (FORMAT_RGBA8 << 8): _convert<1, false, 3, true, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_L8 << 8): _convert<1, true, 1, false, true, true>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_R8 << 8): _convert<1, true, 1, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_RG8 << 8): _convert<1, true, 2, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_RGB8 << 8): _convert<1, true, 3, false, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_LA8 | (FORMAT_RGBA8 << 8): _convert<1, true, 3, true, true, false>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_L8 << 8): _convert<1, false, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_LA8 << 8): _convert<1, false, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_RG8 << 8): _convert<1, false, 2, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_RGB8 << 8): _convert<1, false, 3, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_R8 | (FORMAT_RGBA8 << 8): _convert<1, false, 3, true, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_L8 << 8): _convert<2, false, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_LA8 << 8): _convert<2, false, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_R8 << 8): _convert<2, false, 1, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_RGB8 << 8): _convert<2, false, 3, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RG8 | (FORMAT_RGBA8 << 8): _convert<2, false, 3, true, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_L8 << 8): _convert<3, false, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_LA8 << 8): _convert<3, false, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_R8 << 8): _convert<3, false, 1, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_RG8 << 8): _convert<3, false, 2, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGB8 | (FORMAT_RGBA8 << 8): _convert<3, false, 3, true, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_L8 << 8): _convert<3, true, 1, false, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_LA8 << 8): _convert<3, true, 1, true, false, true>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_R8 << 8): _convert<3, true, 1, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_RG8 << 8): _convert<3, true, 2, false, false, false>(width, height, rptr, wptr); break;
-		case FORMAT_RGBA8 | (FORMAT_RGB8 << 8): _convert<3, true, 3, false, false, false>(width, height, rptr, wptr); break;
+		case FORMAT_L8 | (FORMAT_LA8 << 8): convert_func = _convert<1, false, 1, true, true, true>; break;
+		case FORMAT_L8 | (FORMAT_R8 << 8): convert_func = _convert<1, false, 1, false, true, false>; break;
+		case FORMAT_L8 | (FORMAT_RG8 << 8): convert_func = _convert<1, false, 2, false, true, false>; break;
+		case FORMAT_L8 | (FORMAT_RGB8 << 8): convert_func = _convert<1, false, 3, false, true, false>; break;
+		case FORMAT_L8 | (FORMAT_RGBA8 << 8): convert_func = _convert<1, false, 3, true, true, false>; break;
+		case FORMAT_LA8 | (FORMAT_L8 << 8): convert_func = _convert<1, true, 1, false, true, true>; break;
+		case FORMAT_LA8 | (FORMAT_R8 << 8): convert_func = _convert<1, true, 1, false, true, false>; break;
+		case FORMAT_LA8 | (FORMAT_RG8 << 8): convert_func = _convert<1, true, 2, false, true, false>; break;
+		case FORMAT_LA8 | (FORMAT_RGB8 << 8): convert_func = _convert<1, true, 3, false, true, false>; break;
+		case FORMAT_LA8 | (FORMAT_RGBA8 << 8): convert_func = _convert<1, true, 3, true, true, false>; break;
+		case FORMAT_R8 | (FORMAT_L8 << 8): convert_func = _convert<1, false, 1, false, false, true>; break;
+		case FORMAT_R8 | (FORMAT_LA8 << 8): convert_func = _convert<1, false, 1, true, false, true>; break;
+		case FORMAT_R8 | (FORMAT_RG8 << 8): convert_func = _convert<1, false, 2, false, false, false>; break;
+		case FORMAT_R8 | (FORMAT_RGB8 << 8): convert_func = _convert<1, false, 3, false, false, false>; break;
+		case FORMAT_R8 | (FORMAT_RGBA8 << 8): convert_func = _convert<1, false, 3, true, false, false>; break;
+		case FORMAT_RG8 | (FORMAT_L8 << 8): convert_func = _convert<2, false, 1, false, false, true>; break;
+		case FORMAT_RG8 | (FORMAT_LA8 << 8): convert_func = _convert<2, false, 1, true, false, true>; break;
+		case FORMAT_RG8 | (FORMAT_R8 << 8): convert_func = _convert<2, false, 1, false, false, false>; break;
+		case FORMAT_RG8 | (FORMAT_RGB8 << 8): convert_func = _convert<2, false, 3, false, false, false>; break;
+		case FORMAT_RG8 | (FORMAT_RGBA8 << 8): convert_func = _convert<2, false, 3, true, false, false>; break;
+		case FORMAT_RGB8 | (FORMAT_L8 << 8): convert_func = _convert<3, false, 1, false, false, true>; break;
+		case FORMAT_RGB8 | (FORMAT_LA8 << 8): convert_func = _convert<3, false, 1, true, false, true>; break;
+		case FORMAT_RGB8 | (FORMAT_R8 << 8): convert_func = _convert<3, false, 1, false, false, false>; break;
+		case FORMAT_RGB8 | (FORMAT_RG8 << 8): convert_func = _convert<3, false, 2, false, false, false>; break;
+		case FORMAT_RGB8 | (FORMAT_RGBA8 << 8): convert_func = _convert<3, false, 3, true, false, false>; break;
+		case FORMAT_RGBA8 | (FORMAT_L8 << 8): convert_func = _convert<3, true, 1, false, false, true>; break;
+		case FORMAT_RGBA8 | (FORMAT_LA8 << 8): convert_func = _convert<3, true, 1, true, false, true>; break;
+		case FORMAT_RGBA8 | (FORMAT_R8 << 8): convert_func = _convert<3, true, 1, false, false, false>; break;
+		case FORMAT_RGBA8 | (FORMAT_RG8 << 8): convert_func = _convert<3, true, 2, false, false, false>; break;
+		case FORMAT_RGBA8 | (FORMAT_RGB8 << 8): convert_func = _convert<3, true, 3, false, false, false>; break;
+	}
+
+	if (convert_func) {
+		_process_rows(convert_func, rptr, wptr, width, height, width, height);
 	}
 
 	r = PoolVector<uint8_t>::Read();
@@ -526,7 +748,7 @@ static double _bicubic_interp_kernel(double x) {
 }
 
 template <int CC, class T>
-static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	// get source image size
 	int width = p_src_width;
@@ -542,7 +764,7 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 	int xmax = width - 1;
 	// temporary pointer
 
-	for (uint32_t y = 0; y < p_dst_height; y++) {
+	for (uint32_t y = p_from_row; y < p_to_row; y++) {
 		// Y coordinates
 		oy = (double)y * yfac - 0.5f;
 		oy1 = (int)oy;
@@ -588,7 +810,7 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 
 					for (int i = 0; i < CC; i++) {
 						if (sizeof(T) == 2) { //half float
-							color[i] = Math::half_to_float(p[i]);
+							color[i] += Math::half_to_float(p[i]) * k2;
 						} else {
 							color[i] += p[i] * k2;
 						}
@@ -610,7 +832,7 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 }
 
 template <int CC, class T>
-static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	enum {
 		FRAC_BITS = 8,
@@ -619,110 +841,315 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 
 	};
 
-	for (uint32_t i = 0; i < p_dst_height; i++) {
+	//source columns are stepped with a quotient and a remainder, instead of dividing for every pixel
+	uint32_t left_step = p_src_width * FRAC_LEN / p_dst_width;
+	uint32_t left_step_rem = p_src_width * FRAC_LEN % p_dst_width;
+	uint32_t right_step = p_src_width / p_dst_width;
+	uint32_t right_step_rem = p_src_width % p_dst_width;
+
+	const T *src = (const T *)p_src;
 
-		uint32_t src_yofs_up_fp = (i * p_src_height * FRAC_LEN / p_dst_height);
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
+
+		uint32_t src_yofs_up_fp = uint64_t(i) * p_src_height * FRAC_LEN / p_dst_height;
 		uint32_t src_yofs_frac = src_yofs_up_fp & FRAC_MASK;
 		uint32_t src_yofs_up = src_yofs_up_fp >> FRAC_BITS;
 
-		uint32_t src_yofs_down = (i + 1) * p_src_height / p_dst_height;
+		uint32_t src_yofs_down = uint64_t(i + 1) * p_src_height / p_dst_height;
 		if (src_yofs_down >= p_src_height)
 			src_yofs_down = p_src_height - 1;
 
-		//src_yofs_up*=CC;
-		//src_yofs_down*=CC;
+		const T *src_up = src + src_yofs_up * p_src_width * CC;
+		const T *src_down = src + src_yofs_down * p_src_width * CC;
+		T *dst = ((T *)p_dst) + i * p_dst_width * CC;
 
-		uint32_t y_ofs_up = src_yofs_up * p_src_width * CC;
-		uint32_t y_ofs_down = src_yofs_down * p_src_width * CC;
+		uint32_t src_xofs_left_fp = 0;
+		uint32_t src_xofs_left_rem = 0;
+		uint32_t src_xofs_right_next = right_step;
+		uint32_t src_xofs_right_rem = right_step_rem;
 
 		for (uint32_t j = 0; j < p_dst_width; j++) {
 
-			uint32_t src_xofs_left_fp = (j * p_src_width * FRAC_LEN / p_dst_width);
 			uint32_t src_xofs_frac = src_xofs_left_fp & FRAC_MASK;
-			uint32_t src_xofs_left = src_xofs_left_fp >> FRAC_BITS;
-			uint32_t src_xofs_right = (j + 1) * p_src_width / p_dst_width;
-			if (src_xofs_right >= p_src_width)
-				src_xofs_right = p_src_width - 1;
-
-			src_xofs_left *= CC;
-			src_xofs_right *= CC;
+			uint32_t src_xofs_left = (src_xofs_left_fp >> FRAC_BITS) * CC;
+			uint32_t src_xofs_right = MIN(src_xofs_right_next, p_src_width - 1) * CC;
 
 			for (uint32_t l = 0; l < CC; l++) {
 
 				if (sizeof(T) == 1) { //uint8
-					uint32_t p00 = p_src[y_ofs_up + src_xofs_left + l] << FRAC_BITS;
-					uint32_t p10 = p_src[y_ofs_up + src_xofs_right + l] << FRAC_BITS;
-					uint32_t p01 = p_src[y_ofs_down + src_xofs_left + l] << FRAC_BITS;
-					uint32_t p11 = p_src[y_ofs_down + src_xofs_right + l] << FRAC_BITS;
+					uint32_t p00 = uint32_t(src_up[src_xofs_left + l]) << FRAC_BITS;
+					uint32_t p10 = uint32_t(src_up[src_xofs_right + l]) << FRAC_BITS;
+					uint32_t p01 = uint32_t(src_down[src_xofs_left + l]) << FRAC_BITS;
+					uint32_t p11 = uint32_t(src_down[src_xofs_right + l]) << FRAC_BITS;
 
 					uint32_t interp_up = p00 + (((p10 - p00) * src_xofs_frac) >> FRAC_BITS);
 					uint32_t interp_down = p01 + (((p11 - p01) * src_xofs_frac) >> FRAC_BITS);
 					uint32_t interp = interp_up + (((interp_down - interp_up) * src_yofs_frac) >> FRAC_BITS);
 					interp >>= FRAC_BITS;
-					p_dst[i * p_dst_width * CC + j * CC + l] = interp;
+					dst[l] = interp;
 				} else if (sizeof(T) == 2) { //half float
 
 					float xofs_frac = float(src_xofs_frac) / (1 << FRAC_BITS);
 					float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
-					const T *src = ((const T *)p_src);
-					T *dst = ((T *)p_dst);
 
-					float p00 = Math::half_to_float(src[y_ofs_up + src_xofs_left + l]);
-					float p10 = Math::half_to_float(src[y_ofs_up + src_xofs_right + l]);
-					float p01 = Math::half_to_float(src[y_ofs_down + src_xofs_left + l]);
-					float p11 = Math::half_to_float(src[y_ofs_down + src_xofs_right + l]);
+					float p00 = Math::half_to_float(src_up[src_xofs_left + l]);
+					float p10 = Math::half_to_float(src_up[src_xofs_right + l]);
+					float p01 = Math::half_to_float(src_down[src_xofs_left + l]);
+					float p11 = Math::half_to_float(src_down[src_xofs_right + l]);
 
 					float interp_up = p00 + (p10 - p00) * xofs_frac;
 					float interp_down = p01 + (p11 - p01) * xofs_frac;
 					float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
 
-					dst[i * p_dst_width * CC + j * CC + l] = Math::make_half_float(interp);
+					dst[l] = Math::make_half_float(interp);
 				} else if (sizeof(T) == 4) { //float
 
 					float xofs_frac = float(src_xofs_frac) / (1 << FRAC_BITS);
 					float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
-					const T *src = ((const T *)p_src);
-					T *dst = ((T *)p_dst);
 
-					float p00 = src[y_ofs_up + src_xofs_left + l];
-					float p10 = src[y_ofs_up + src_xofs_right + l];
-					float p01 = src[y_ofs_down + src_xofs_left + l];
-					float p11 = src[y_ofs_down + src_xofs_right + l];
+					float p00 = src_up[src_xofs_left + l];
+					float p10 = src_up[src_xofs_right + l];
+					float p01 = src_down[src_xofs_left + l];
+					float p11 = src_down[src_xofs_right + l];
 
 					float interp_up = p00 + (p10 - p00) * xofs_frac;
 					float interp_down = p01 + (p11 - p01) * xofs_frac;
 					float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
 
-					dst[i * p_dst_width * CC + j * CC + l] = interp;
+					dst[l] = interp;
 				}
 			}
+
+			dst += CC;
+
+			src_xofs_left_fp += left_step;
+			src_xofs_left_rem += left_step_rem;
+			if (src_xofs_left_rem >= p_dst_width) {
+				src_xofs_left_rem -= p_dst_width;
+				src_xofs_left_fp++;
+			}
+
+			src_xofs_right_next += right_step;
+			src_xofs_right_rem += right_step_rem;
+			if (src_xofs_right_rem >= p_dst_width) {
+				src_xofs_right_rem -= p_dst_width;
+				src_xofs_right_next++;
+			}
 		}
 	}
 }
 
 template <int CC, class T>
-static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
-	for (uint32_t i = 0; i < p_dst_height; i++) {
+	//source columns are stepped with a quotient and a remainder, instead of dividing for every pixel
+	uint32_t x_step = p_src_width / p_dst_width;
+	uint32_t x_step_rem = p_src_width % p_dst_width;
 
-		uint32_t src_yofs = i * p_src_height / p_dst_height;
-		uint32_t y_ofs = src_yofs * p_src_width * CC;
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 
-		for (uint32_t j = 0; j < p_dst_width; j++) {
+		uint32_t src_yofs = uint64_t(i) * p_src_height / p_dst_height;
+		const T *src = ((const T *)p_src) + src_yofs * p_src_width * CC;
+		T *dst = ((T *)p_dst) + i * p_dst_width * CC;
 
-			uint32_t src_xofs = j * p_src_width / p_dst_width;
-			src_xofs *= CC;
+		uint32_t src_xofs = 0;
+		uint32_t src_xofs_rem = 0;
+
+		for (uint32_t j = 0; j < p_dst_width; j++) {
 
 			for (uint32_t l = 0; l < CC; l++) {
+				dst[l] = src[src_xofs * CC + l];
+			}
+
+			dst += CC;
+
+			src_xofs += x_step;
+			src_xofs_rem += x_step_rem;
+			if (src_xofs_rem >= p_dst_width) {
+				src_xofs_rem -= p_dst_width;
+				src_xofs++;
+			}
+		}
+	}
+}
+
+#define LANCZOS_TYPE 3
+
+static float _lanczos(float p_x) {
+
+	if (p_x == 0) {
+		return 1;
+	}
+
+	if (Math::abs(p_x) >= LANCZOS_TYPE) {
+		return 0;
+	}
+
+	float pi_x = Math_PI * p_x;
+	return LANCZOS_TYPE * Math::sin(pi_x) * Math::sin(pi_x / LANCZOS_TYPE) / (pi_x * pi_x);
+}
+
+static _FORCE_INLINE_ float _pixel_to_float(uint8_t p_value) {
+	return p_value;
+}
+
+static _FORCE_INLINE_ float _pixel_to_float(uint16_t p_value) {
+	return Math::half_to_float(p_value);
+}
+
+static _FORCE_INLINE_ float _pixel_to_float(float p_value) {
+	return p_value;
+}
+
+static _FORCE_INLINE_ void _pixel_from_float(float p_value, uint8_t &r_value) {
+	r_value = CLAMP(Math::fast_ftoi(p_value), 0, 255);
+}
+
+static _FORCE_INLINE_ void _pixel_from_float(float p_value, uint16_t &r_value) {
+	r_value = Math::make_half_float(p_value);
+}
+
+static _FORCE_INLINE_ void _pixel_from_float(float p_value, float &r_value) {
+	r_value = p_value;
+}
+
+//source pixels and weights of every destination pixel along one axis, the border pixels are repeated
+struct ImageLanczosAxis {
+
+	uint32_t taps;
+	Vector<uint32_t> offsets;
+	Vector<float> weights;
+
+	void setup(uint32_t p_src_size, uint32_t p_dst_size) {
+
+		float scale = float(p_src_size) / p_dst_size;
+		//when shrinking, the kernel is stretched to filter out what the destination can not represent
+		float kernel_scale = MAX(scale, 1.0f);
+		float radius = LANCZOS_TYPE * kernel_scale;
+		taps = uint32_t(Math::ceil(radius)) * 2;
+
+		offsets.resize(p_dst_size * taps);
+		weights.resize(p_dst_size * taps);
+		uint32_t *offsets_ptr = offsets.ptrw();
+		float *weights_ptr = weights.ptrw();
 
-				const T *src = ((const T *)p_src);
-				T *dst = ((T *)p_dst);
+		for (uint32_t i = 0; i < p_dst_size; i++) {
 
-				T p = src[y_ofs + src_xofs + l];
-				dst[i * p_dst_width * CC + j * CC + l] = p;
+			float center = (i + 0.5f) * scale - 0.5f;
+			int first = int(Math::floor(center - radius)) + 1;
+			float total = 0;
+
+			for (uint32_t k = 0; k < taps; k++) {
+				int pos = first + k;
+				float weight = _lanczos((pos - center) / kernel_scale);
+				offsets_ptr[k] = CLAMP(pos, 0, int(p_src_size) - 1);
+				weights_ptr[k] = weight;
+				total += weight;
+			}
+
+			for (uint32_t k = 0; k < taps; k++) {
+				weights_ptr[k] /= total;
+			}
+
+			offsets_ptr += taps;
+			weights_ptr += taps;
+		}
+	}
+};
+
+template <int CC, class T>
+struct ImageLanczosJob {
+
+	const T *src;
+	T *dst;
+	uint32_t src_width;
+	uint32_t dst_width;
+	ImageLanczosAxis x_axis;
+	ImageLanczosAxis y_axis;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+
+		//filter horizontally only the source rows these destination rows need, then vertically a whole row at a time
+		const uint32_t *y_offsets = y_axis.offsets.ptr();
+		const float *y_weights = y_axis.weights.ptr();
+		uint32_t src_first = y_offsets[p_from * y_axis.taps];
+		uint32_t src_last = y_offsets[p_to * y_axis.taps - 1];
+		uint32_t row_size = dst_width * CC;
+
+		Vector<float> buffer;
+		buffer.resize((src_last - src_first + 2) * row_size);
+		float *rows = buffer.ptrw();
+		float *accum = rows + (src_last - src_first + 1) * row_size;
+
+		for (uint32_t y = src_first; y <= src_last; y++) {
+
+			const T *src_row = src + y * src_width * CC;
+			float *row = rows + (y - src_first) * row_size;
+			const uint32_t *offsets = x_axis.offsets.ptr();
+			const float *weights = x_axis.weights.ptr();
+
+			for (uint32_t x = 0; x < dst_width; x++) {
+
+				float color[CC];
+				for (int i = 0; i < CC; i++) {
+					color[i] = 0;
+				}
+
+				for (uint32_t k = 0; k < x_axis.taps; k++) {
+					const T *p = src_row + offsets[k] * CC;
+					for (int i = 0; i < CC; i++) {
+						color[i] += _pixel_to_float(p[i]) * weights[k];
+					}
+				}
+
+				for (int i = 0; i < CC; i++) {
+					row[x * CC + i] = color[i];
+				}
+
+				offsets += x_axis.taps;
+				weights += x_axis.taps;
+			}
+		}
+
+		for (uint32_t y = p_from; y < p_to; y++) {
+
+			const uint32_t *offsets = &y_offsets[y * y_axis.taps];
+			const float *weights = &y_weights[y * y_axis.taps];
+
+			for (uint32_t i = 0; i < row_size; i++) {
+				accum[i] = 0;
+			}
+
+			for (uint32_t k = 0; k < y_axis.taps; k++) {
+				const float *row = rows + (offsets[k] - src_first) * row_size;
+				float weight = weights[k];
+				for (uint32_t i = 0; i < row_size; i++) {
+					accum[i] += row[i] * weight;
+				}
+			}
+
+			T *dst_row = dst + y * row_size;
+			for (uint32_t i = 0; i < row_size; i++) {
+				_pixel_from_float(accum[i], dst_row[i]);
 			}
 		}
 	}
+};
+
+template <int CC, class T>
+static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+
+	ImageLanczosJob<CC, T> job;
+	job.src = (const T *)p_src;
+	job.dst = (T *)p_dst;
+	job.src_width = p_src_width;
+	job.dst_width = p_dst_width;
+	job.x_axis.setup(p_src_width, p_dst_width);
+	job.y_axis.setup(p_src_height, p_dst_height);
+
+	//larger chunks, so fewer source rows are filtered twice by neighbouring chunks
+	uint32_t rows_per_chunk = MAX(_get_rows_per_chunk(p_dst_width), job.y_axis.taps * 8);
+	_process_row_job(&job, p_dst_height, rows_per_chunk);
 }
 
 static void _overlay(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, float p_alpha, uint32_t p_width, uint32_t p_height, uint32_t p_pixel_size) {
@@ -811,34 +1238,40 @@ void Image::resize(int p_width, int p_height, Interpolation p_interpolation) {
 	PoolVector<uint8_t>::Write w = dst.data.write();
 	unsigned char *w_ptr = w.ptr();
 
+	ImageRowFunc scale_func = NULL;
+
 	switch (p_interpolation) {
 
 		case INTERPOLATE_NEAREST: {
 
 			if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
 				switch (get_format_pixel_size(format)) {
-					case 1: _scale_nearest<1, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 2: _scale_nearest<2, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 3: _scale_nearest<3, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_nearest<4, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 1: scale_func = _scale_nearest<1, uint8_t>; break;
+					case 2: scale_func = _scale_nearest<2, uint8_t>; break;
+					case 3: scale_func = _scale_nearest<3, uint8_t>; break;
+					case 4: scale_func = _scale_nearest<4, uint8_t>; break;
 				}
 			} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
 				switch (get_format_pixel_size(format)) {
-					case 4: _scale_nearest<1, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_nearest<2, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 12: _scale_nearest<3, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 16: _scale_nearest<4, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: scale_func = _scale_nearest<1, float>; break;
+					case 8: scale_func = _scale_nearest<2, float>; break;
+					case 12: scale_func = _scale_nearest<3, float>; break;
+					case 16: scale_func = _scale_nearest<4, float>; break;
 				}
 
 			} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
 				switch (get_format_pixel_size(format)) {
-					case 2: _scale_nearest<1, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_nearest<2, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 6: _scale_nearest<3, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_nearest<4, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: scale_func = _scale_nearest<1, uint16_t>; break;
+					case 4: scale_func = _scale_nearest<2, uint16_t>; break;
+					case 6: scale_func = _scale_nearest<3, uint16_t>; break;
+					case 8: scale_func = _scale_nearest<4, uint16_t>; break;
 				}
 			}
 
+			if (scale_func) {
+				_process_rows(scale_func, r_ptr, w_ptr, width, height, p_width, p_height);
+			}
+
 		} break;
 		case INTERPOLATE_BILINEAR:
 		case INTERPOLATE_TRILINEAR: {
@@ -881,26 +1314,30 @@ void Image::resize(int p_width, int p_height, Interpolation p_interpolation) {
 
 				if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
 					switch (get_format_pixel_size(format)) {
-						case 1: _scale_bilinear<1, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 2: _scale_bilinear<2, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 3: _scale_bilinear<3, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 4: _scale_bilinear<4, uint8_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 1: scale_func = _scale_bilinear<1, uint8_t>; break;
+						case 2: scale_func = _scale_bilinear<2, uint8_t>; break;
+						case 3: scale_func = _scale_bilinear<3, uint8_t>; break;
+						case 4: scale_func = _scale_bilinear<4, uint8_t>; break;
 					}
 				} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
 					switch (get_format_pixel_size(format)) {
-						case 4: _scale_bilinear<1, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 8: _scale_bilinear<2, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 12: _scale_bilinear<3, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 16: _scale_bilinear<4, float>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 4: scale_func = _scale_bilinear<1, float>; break;
+						case 8: scale_func = _scale_bilinear<2, float>; break;
+						case 12: scale_func = _scale_bilinear<3, float>; break;
+						case 16: scale_func = _scale_bilinear<4, float>; break;
 					}
 				} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
 					switch (get_format_pixel_size(format)) {
-						case 2: _scale_bilinear<1, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 4: _scale_bilinear<2, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 6: _scale_bilinear<3, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
-						case 8: _scale_bilinear<4, uint16_t>(src_ptr, w_ptr, src_width, src_height, p_width, p_height); break;
+						case 2: scale_func = _scale_bilinear<1, uint16_t>; break;
+						case 4: scale_func = _scale_bilinear<2, uint16_t>; break;
+						case 6: scale_func = _scale_bilinear<3, uint16_t>; break;
+						case 8: scale_func = _scale_bilinear<4, uint16_t>; break;
 					}
 				}
+
+				if (scale_func) {
+					_process_rows(scale_func, src_ptr, w_ptr, src_width, src_height, p_width, p_height);
+				}
 			}
 
 			if (interpolate_mipmaps) {
@@ -914,24 +1351,53 @@ void Image::resize(int p_width, int p_height, Interpolation p_interpolation) {
 
 			if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
 				switch (get_format_pixel_size(format)) {
-					case 1: _scale_cubic<1, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 2: _scale_cubic<2, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 3: _scale_cubic<3, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_cubic<4, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 1: scale_func = _scale_cubic<1, uint8_t>; break;
+					case 2: scale_func = _scale_cubic<2, uint8_t>; break;
+					case 3: scale_func = _scale_cubic<3, uint8_t>; break;
+					case 4: scale_func = _scale_cubic<4, uint8_t>; break;
 				}
 			} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
 				switch (get_format_pixel_size(format)) {
-					case 4: _scale_cubic<1, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_cubic<2, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 12: _scale_cubic<3, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 16: _scale_cubic<4, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: scale_func = _scale_cubic<1, float>; break;
+					case 8: scale_func = _scale_cubic<2, float>; break;
+					case 12: scale_func = _scale_cubic<3, float>; break;
+					case 16: scale_func = _scale_cubic<4, float>; break;
 				}
 			} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
 				switch (get_format_pixel_size(format)) {
-					case 2: _scale_cubic<1, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 4: _scale_cubic<2, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 6: _scale_cubic<3, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
-					case 8: _scale_cubic<4, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: scale_func = _scale_cubic<1, uint16_t>; break;
+					case 4: scale_func = _scale_cubic<2, uint16_t>; break;
+					case 6: scale_func = _scale_cubic<3, uint16_t>; break;
+					case 8: scale_func = _scale_cubic<4, uint16_t>; break;
+				}
+			}
+
+			if (scale_func) {
+				_process_rows(scale_func, r_ptr, w_ptr, width, height, p_width, p_height);
+			}
+		} break;
+		case INTERPOLATE_LANCZOS: {
+
+			if (format >= FORMAT_L8 && format <= FORMAT_RGBA8) {
+				switch (get_format_pixel_size(format)) {
+					case 1: _scale_lanczos<1, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 2: _scale_lanczos<2, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 3: _scale_lanczos<3, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _scale_lanczos<4, uint8_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+				}
+			} else if (format >= FORMAT_RF && format <= FORMAT_RGBAF) {
+				switch (get_format_pixel_size(format)) {
+					case 4: _scale_lanczos<1, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 8: _scale_lanczos<2, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 12: _scale_lanczos<3, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 16: _scale_lanczos<4, float>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+				}
+			} else if (format >= FORMAT_RH && format <= FORMAT_RGBAH) {
+				switch (get_format_pixel_size(format)) {
+					case 2: _scale_lanczos<1, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 4: _scale_lanczos<2, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 6: _scale_lanczos<3, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
+					case 8: _scale_lanczos<4, uint16_t>(r_ptr, w_ptr, width, height, p_width, p_height); break;
 				}
 			}
 		} break;
@@ -1134,20 +1600,21 @@ bool Image::_can_modify(Format p_format) const {
 template <class Component, int CC, bool renormalize,
 		void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
 		void (*renormalize_func)(Component *)>
-static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+static void _generate_po2_mipmap(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 
 	//fast power of 2 mipmap generation
+	const Component *src = reinterpret_cast<const Component *>(p_src);
+	Component *dst = reinterpret_cast<Component *>(p_dst);
 	uint32_t dst_w = MAX(p_width >> 1, 1);
-	uint32_t dst_h = MAX(p_height >> 1, 1);
 
 	int right_step = (p_width == 1) ? 0 : CC;
 	int down_step = (p_height == 1) ? 0 : (p_width * CC);
 
-	for (uint32_t i = 0; i < dst_h; i++) {
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 
-		const Component *rup_ptr = &p_src[i * 2 * down_step];
+		const Component *rup_ptr = &src[i * 2 * down_step];
 		const Component *rdown_ptr = rup_ptr + down_step;
-		Component *dst_ptr = &p_dst[i * dst_w * CC];
+		Component *dst_ptr = &dst[i * dst_w * CC];
 		uint32_t count = dst_w;
 
 		while (count--) {
@@ -1241,29 +1708,34 @@ void Image::shrink_x2() {
 		{
 			PoolVector<uint8_t>::Write w = new_img.write();
 			PoolVector<uint8_t>::Read r = data.read();
+			ImageRowFunc mipmap_func = NULL;
 
 			switch (format) {
 
 				case FORMAT_L8:
-				case FORMAT_R8: _generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_LA8: _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_RG8: _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_RGB8: _generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-				case FORMAT_RGBA8: _generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>(r.ptr(), w.ptr(), width, height); break;
-
-				case FORMAT_RF: _generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-				case FORMAT_RGF: _generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-				case FORMAT_RGBF: _generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-				case FORMAT_RGBAF: _generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(r.ptr()), reinterpret_cast<float *>(w.ptr()), width, height); break;
-
-				case FORMAT_RH: _generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-				case FORMAT_RGH: _generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-				case FORMAT_RGBH: _generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-				case FORMAT_RGBAH: _generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(r.ptr()), reinterpret_cast<uint16_t *>(w.ptr()), width, height); break;
-
-				case FORMAT_RGBE9995: _generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(r.ptr()), reinterpret_cast<uint32_t *>(w.ptr()), width, height); break;
+				case FORMAT_R8: mipmap_func = _generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+				case FORMAT_LA8: mipmap_func = _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+				case FORMAT_RG8: mipmap_func = _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+				case FORMAT_RGB8: mipmap_func = _generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+				case FORMAT_RGBA8: mipmap_func = _generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+
+				case FORMAT_RF: mipmap_func = _generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>; break;
+				case FORMAT_RGF: mipmap_func = _generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>; break;
+				case FORMAT_RGBF: mipmap_func = _generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>; break;
+				case FORMAT_RGBAF: mipmap_func = _generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>; break;
+
+				case FORMAT_RH: mipmap_func = _generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>; break;
+				case FORMAT_RGH: mipmap_func = _generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>; break;
+				case FORMAT_RGBH: mipmap_func = _generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>; break;
+				case FORMAT_RGBAH: mipmap_func = _generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>; break;
+
+				case FORMAT_RGBE9995: mipmap_func = _generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>; break;
 				default: {}
 			}
+
+			if (mipmap_func) {
+				_process_rows(mipmap_func, r.ptr(), w.ptr(), width, height, width / 2, height / 2);
+			}
 		}
 
 		width /= 2;
@@ -1319,82 +1791,88 @@ Error Image::generate_mipmaps(bool p_renormalize) {
 
 	PoolVector<uint8_t>::Write wp = data.write();
 
-	int prev_ofs = 0;
-	int prev_h = height;
-	int prev_w = width;
+	ImageRowFunc mipmap_func = NULL;
 
-	for (int i = 1; i <= mmcount; i++) {
+	switch (format) {
 
-		int ofs, w, h;
-		_get_mipmap_offset_and_size(i, ofs, w, h);
+		case FORMAT_L8:
+		case FORMAT_R8: mipmap_func = _generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+		case FORMAT_LA8:
+		case FORMAT_RG8: mipmap_func = _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>; break;
+		case FORMAT_RGB8:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<uint8_t, 3, true, Image::average_4_uint8, Image::renormalize_uint8>;
+			else
+				mipmap_func = _generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>;
 
-		switch (format) {
+			break;
+		case FORMAT_RGBA8:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<uint8_t, 4, true, Image::average_4_uint8, Image::renormalize_uint8>;
+			else
+				mipmap_func = _generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>;
+			break;
+		case FORMAT_RF:
+			mipmap_func = _generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>;
+			break;
+		case FORMAT_RGF:
+			mipmap_func = _generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>;
+			break;
+		case FORMAT_RGBF:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<float, 3, true, Image::average_4_float, Image::renormalize_float>;
+			else
+				mipmap_func = _generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>;
 
-			case FORMAT_L8:
-			case FORMAT_R8: _generate_po2_mipmap<uint8_t, 1, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h); break;
-			case FORMAT_LA8:
-			case FORMAT_RG8: _generate_po2_mipmap<uint8_t, 2, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h); break;
-			case FORMAT_RGB8:
-				if (p_renormalize)
-					_generate_po2_mipmap<uint8_t, 3, true, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
-				else
-					_generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+			break;
+		case FORMAT_RGBAF:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<float, 4, true, Image::average_4_float, Image::renormalize_float>;
+			else
+				mipmap_func = _generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>;
 
-				break;
-			case FORMAT_RGBA8:
-				if (p_renormalize)
-					_generate_po2_mipmap<uint8_t, 4, true, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
-				else
-					_generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
-				break;
-			case FORMAT_RF:
-				_generate_po2_mipmap<float, 1, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-				break;
-			case FORMAT_RGF:
-				_generate_po2_mipmap<float, 2, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-				break;
-			case FORMAT_RGBF:
-				if (p_renormalize)
-					_generate_po2_mipmap<float, 3, true, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-				else
-					_generate_po2_mipmap<float, 3, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+			break;
+		case FORMAT_RH:
+			mipmap_func = _generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>;
+			break;
+		case FORMAT_RGH:
+			mipmap_func = _generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>;
+			break;
+		case FORMAT_RGBH:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<uint16_t, 3, true, Image::average_4_half, Image::renormalize_half>;
+			else
+				mipmap_func = _generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>;
 
-				break;
-			case FORMAT_RGBAF:
-				if (p_renormalize)
-					_generate_po2_mipmap<float, 4, true, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-				else
-					_generate_po2_mipmap<float, 4, false, Image::average_4_float, Image::renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+			break;
+		case FORMAT_RGBAH:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<uint16_t, 4, true, Image::average_4_half, Image::renormalize_half>;
+			else
+				mipmap_func = _generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>;
 
-				break;
-			case FORMAT_RH:
-				_generate_po2_mipmap<uint16_t, 1, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-				break;
-			case FORMAT_RGH:
-				_generate_po2_mipmap<uint16_t, 2, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-				break;
-			case FORMAT_RGBH:
-				if (p_renormalize)
-					_generate_po2_mipmap<uint16_t, 3, true, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-				else
-					_generate_po2_mipmap<uint16_t, 3, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+			break;
+		case FORMAT_RGBE9995:
+			if (p_renormalize)
+				mipmap_func = _generate_po2_mipmap<uint32_t, 1, true, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>;
+			else
+				mipmap_func = _generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>;
 
-				break;
-			case FORMAT_RGBAH:
-				if (p_renormalize)
-					_generate_po2_mipmap<uint16_t, 4, true, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-				else
-					_generate_po2_mipmap<uint16_t, 4, false, Image::average_4_half, Image::renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+			break;
+		default: {}
+	}
 
-				break;
-			case FORMAT_RGBE9995:
-				if (p_renormalize)
-					_generate_po2_mipmap<uint32_t, 1, true, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(&wp[prev_ofs]), reinterpret_cast<uint32_t *>(&wp[ofs]), prev_w, prev_h);
-				else
-					_generate_po2_mipmap<uint32_t, 1, false, Image::average_4_rgbe9995, Image::renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(&wp[prev_ofs]), reinterpret_cast<uint32_t *>(&wp[ofs]), prev_w, prev_h);
+	int prev_ofs = 0;
+	int prev_h = height;
+	int prev_w = width;
 
-				break;
-			default: {}
+	for (int i = 1; i <= mmcount; i++) {
+
+		int ofs, w, h;
+		_get_mipmap_offset_and_size(i, ofs, w, h);
+
+		if (mipmap_func) {
+			_process_rows(mipmap_func, &wp[prev_ofs], &wp[ofs], prev_w, prev_h, w, h);
 		}
 
 		prev_ofs = ofs;
@@ -1796,6 +2274,85 @@ Error Image::decompress() {
 	return OK;
 }
 
+enum {
+	IMAGE_COMPRESS_BAND_PIXELS = 16384 // block compression is far more expensive per pixel than the row jobs
+};
+
+struct ImageCompressBand {
+
+	const uint8_t *src;
+	uint8_t *dst;
+	int width;
+	int height;
+};
+
+struct ImageCompressBandJob {
+
+	Image::CompressBandFunc func;
+	void *userdata;
+	const ImageCompressBand *bands;
+
+	void process_band(uint32_t p_band, void *p_unused) {
+
+		const ImageCompressBand &band = bands[p_band];
+		func(band.src, band.width, band.height, band.dst, userdata);
+	}
+};
+
+void Image::compress_bands(const uint8_t *p_src, Format p_src_format, uint8_t *p_dst, Format p_dst_format, int p_width, int p_height, bool p_mipmaps, CompressBandFunc p_func, void *p_userdata) {
+
+	ERR_FAIL_COND(get_format_block_size(p_dst_format) != 4);
+
+	int src_pixel_size = get_format_pixel_size(p_src_format);
+	//bytes taken by a 4x4 block
+	int dst_block_size = (16 * get_format_pixel_size(p_dst_format)) >> get_format_pixel_rshift(p_dst_format);
+	int mm_count = p_mipmaps ? get_image_required_mipmaps(p_width, p_height, p_dst_format) : 0;
+
+	//bands only depend on the mipmap size, so codecs that look at a whole band at once (etc) give the same result with any amount of threads
+	Vector<ImageCompressBand> bands;
+
+	int w = p_width;
+	int h = p_height;
+
+	for (int i = 0; i <= mm_count; i++) {
+
+		const uint8_t *src = p_src + get_image_mipmap_offset(p_width, p_height, p_src_format, i);
+		uint8_t *dst = p_dst + get_image_mipmap_offset(p_width, p_height, p_dst_format, i);
+		int blocks_per_row = (w + 3) / 4;
+		int band_rows = MAX((IMAGE_COMPRESS_BAND_PIXELS / w) & ~3, 4);
+
+		for (int y = 0; y < h; y += band_rows) {
+
+			ImageCompressBand band;
+			band.src = src + int64_t(y) * w * src_pixel_size;
+			band.dst = dst + int64_t(y / 4) * blocks_per_row * dst_block_size;
+			band.width = w;
+			band.height = MIN(band_rows, h - y);
+			bands.push_back(band);
+		}
+
+		w = MAX(w >> 1, 1);
+		h = MAX(h >> 1, 1);
+	}
+
+	ImageCompressBandJob job;
+	job.func = p_func;
+	job.userdata = p_userdata;
+	job.bands = bands.ptr();
+
+	ThreadWorkPool *pool = bands.size() > 1 ? lock_work_pool() : NULL;
+
+	if (!pool) {
+		for (int i = 0; i < bands.size(); i++) {
+			job.process_band(i, NULL);
+		}
+		return;
+	}
+
+	pool->do_work(bands.size(), &job, &ImageCompressBandJob::process_band, (void *)NULL);
+	unlock_work_pool();
+}
+
 Error Image::compress(CompressMode p_mode, CompressSource p_source, float p_lossy_quality) {
 
 	switch (p_mode) {
@@ -2678,6 +3235,7 @@ void Image::_bind_methods() {
 	BIND_ENUM_CONSTANT(INTERPOLATE_BILINEAR);
 	BIND_ENUM_CONSTANT(INTERPOLATE_CUBIC);
 	BIND_ENUM_CONSTANT(INTERPOLATE_TRILINEAR);
+	BIND_ENUM_CONSTANT(INTERPOLATE_LANCZOS);
 
 	BIND_ENUM_CONSTANT(ALPHA_NONE);
 	BIND_ENUM_CONSTANT(ALPHA_BIT);
@@ -45,6 +45,8 @@
 */
 
 class Image;
+class Mutex;
+class ThreadWorkPool;
 
 typedef Error (*SavePNGFunc)(const String &p_path, const Ref<Image> &p_img);
 typedef Ref<Image> (*ImageMemLoadFunc)(const uint8_t *p_png, int p_size);
@@ -109,6 +111,7 @@ public:
 		INTERPOLATE_BILINEAR,
 		INTERPOLATE_CUBIC,
 		INTERPOLATE_TRILINEAR,
+		INTERPOLATE_LANCZOS,
 		/* INTERPOLATE_TRICUBIC, */
 		/* INTERPOLATE GAUSS */
 	};
@@ -163,6 +166,9 @@ private:
 	int width, height;
 	bool mipmaps;
 
+	static ThreadWorkPool *work_pool;
+	static Mutex *work_pool_mutex;
+
 	void _copy_internals_from(const Image &p_image) {
 		format = p_image.format;
 		width = p_image.width;
@@ -321,6 +327,17 @@ public:
 	static void set_compress_bptc_func(void (*p_compress_func)(Image *, float, CompressSource));
 	static String get_format_name(Format p_format);
 
+	//large images are split in rows and processed on a shared pool of worker threads
+	static void setup_work_pool();
+	static void finish_work_pool();
+	static ThreadWorkPool *lock_work_pool(); //NULL if busy or there are no worker threads, process on the calling thread then
+	static void unlock_work_pool();
+
+	//compresses p_height rows of 4x4 blocks (the last band of a mipmap may end in a partial block row), p_src and p_dst point to the first row of the band
+	typedef void (*CompressBandFunc)(const uint8_t *p_src, int p_width, int p_height, uint8_t *p_dst, void *p_userdata);
+	//splits every mipmap of a block compressed image in bands of block rows and compresses them on the work pool, output does not depend on the thread count
+	static void compress_bands(const uint8_t *p_src, Format p_src_format, uint8_t *p_dst, Format p_dst_format, int p_width, int p_height, bool p_mipmaps, CompressBandFunc p_func, void *p_userdata);
+
 	Error load_png_from_buffer(const PoolVector<uint8_t> &p_array);
 	Error load_jpg_from_buffer(const PoolVector<uint8_t> &p_array);
 	Error load_webp_from_buffer(const PoolVector<uint8_t> &p_array);
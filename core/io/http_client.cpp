@@ -507,11 +507,29 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 	ERR_FAIL_COND_V(status != STATUS_BODY, PoolByteArray());
 
 	PoolByteArray ret;
+	ret.resize(!chunked && !read_until_eof ? MIN(body_left, read_chunk_size) : read_chunk_size);
+
+	int read;
+	{
+		PoolByteArray::Write w = ret.write();
+		read = read_response_body_data(w.ptr(), ret.size());
+	}
+	ret.resize(read);
+
+	return ret;
+}
+
+int HTTPClient::read_response_body_data(uint8_t *p_buffer, int p_size) {
+
+	ERR_FAIL_COND_V(status != STATUS_BODY, 0);
+	ERR_FAIL_COND_V(p_size < 0, 0);
+
+	int total = 0;
 	Error err = OK;
 
 	if (chunked) {
 
-		while (true) {
+		while (total < p_size && status == STATUS_BODY) {
 
 			if (chunk_trailer_part) {
 				// We need to consume the trailer part too or keep-alive will break
@@ -587,51 +605,58 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 					}
 
 					chunk_left = len + 2;
-					chunk.resize(chunk_left);
+					chunk.clear();
 				}
-			} else {
-
+			} else if (chunk_left > 2) {
+				// Chunk data goes straight to the caller
 				int rec = 0;
-				err = _get_http_data(&chunk.write[chunk.size() - chunk_left], chunk_left, rec);
+				err = _get_http_data(p_buffer + total, MIN(chunk_left - 2, p_size - total), rec);
 				if (rec == 0) {
 					break;
 				}
+				total += rec;
 				chunk_left -= rec;
 
+				if (err != OK)
+					break;
+			} else {
+				// Chunk terminator
+				uint8_t b;
+				int rec = 0;
+				err = _get_http_data(&b, 1, rec);
+
+				if (rec == 0)
+					break;
+
+				chunk.push_back(b);
+				chunk_left--;
+
 				if (chunk_left == 0) {
 
-					if (chunk[chunk.size() - 2] != '\r' || chunk[chunk.size() - 1] != '\n') {
+					if (chunk[0] != '\r' || chunk[1] != '\n') {
 						ERR_PRINT("HTTP Invalid chunk terminator (not \\r\\n)");
 						status = STATUS_CONNECTION_ERROR;
 						break;
 					}
 
-					ret.resize(chunk.size() - 2);
-					PoolByteArray::Write w = ret.write();
-					copymem(w.ptr(), chunk.ptr(), chunk.size() - 2);
 					chunk.clear();
-				}
 
-				break;
+					if (total > 0)
+						break; // Hand out what we have at chunk boundaries
+				}
 			}
 		}
 
 	} else {
 
-		int to_read = !read_until_eof ? MIN(body_left, read_chunk_size) : read_chunk_size;
-		ret.resize(to_read);
-		int _offset = 0;
+		int to_read = !read_until_eof ? MIN(body_left, p_size) : p_size;
 		while (to_read > 0) {
 			int rec = 0;
-			{
-				PoolByteArray::Write w = ret.write();
-				err = _get_http_data(w.ptr() + _offset, to_read, rec);
-			}
+			err = _get_http_data(p_buffer + total, to_read, rec);
 			if (rec <= 0) { // Ended up reading less
-				ret.resize(_offset);
 				break;
 			} else {
-				_offset += rec;
+				total += rec;
 				to_read -= rec;
 				if (!read_until_eof) {
 					body_left -= rec;
@@ -658,7 +683,7 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 		status = STATUS_CONNECTED;
 	}
 
-	return ret;
+	return total;
 }
 
 HTTPClient::Status HTTPClient::get_status() const {
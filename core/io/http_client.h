@@ -215,6 +215,7 @@ public:
 	int get_response_body_length() const;
 
 	PoolByteArray read_response_body_chunk(); // Can't get body as partial text because of most encodings UTF8, gzip, etc.
+	int read_response_body_data(uint8_t *p_buffer, int p_size); // Same, into a caller owned buffer, returns the bytes read
 
 	void set_blocking_mode(bool p_enable); // Useful mostly if running in a thread
 	bool is_blocking_mode_enabled() const;
@@ -31,6 +31,7 @@
 #include "multiplayer_api.h"
 
 #include "core/io/marshalls.h"
+#include "core/os/os.h"
 #include "scene/main/node.h"
 
 _FORCE_INLINE_ bool _should_call_local(MultiplayerAPI::RPCMode mode, bool is_master, bool &r_skip_rpc) {
@@ -87,6 +88,249 @@ _FORCE_INLINE_ bool _can_call_mode(Node *p_node, MultiplayerAPI::RPCMode mode, i
 	return false;
 }
 
+// Variable length unsigned integers, 7 bits per byte, low bits first.
+static int _encode_varint(uint64_t p_value, uint8_t *p_arr) {
+
+	int len = 0;
+	do {
+		uint8_t byte = p_value & 0x7F;
+		p_value >>= 7;
+		if (p_value)
+			byte |= 0x80;
+		if (p_arr)
+			p_arr[len] = byte;
+		len++;
+	} while (p_value);
+
+	return len;
+}
+
+static Error _decode_varint(uint64_t &r_value, const uint8_t *p_arr, int p_len, int &r_used) {
+
+	r_value = 0;
+	for (int i = 0; i < p_len && i < 10; i++) {
+
+		r_value |= uint64_t(p_arr[i] & 0x7F) << (7 * i);
+		if (!(p_arr[i] & 0x80)) {
+			r_used = i + 1;
+			return OK;
+		}
+	}
+
+	return ERR_INVALID_DATA;
+}
+
+// Returns the bytes used including the terminator, or -1 if there is none.
+static int _decode_cstring(String &r_string, const uint8_t *p_arr, int p_len) {
+
+	for (int i = 0; i < p_len; i++) {
+		if (p_arr[i] == 0) {
+			r_string.parse_utf8((const char *)p_arr, i);
+			return i + 1;
+		}
+	}
+
+	return -1;
+}
+
+// RPC arguments and RSET values use a tighter encoding than encode_variant() for the
+// types games send most, a one byte tag instead of a four byte header and no padding.
+enum CompactVariantType {
+	COMPACT_NIL,
+	COMPACT_FALSE,
+	COMPACT_TRUE,
+	COMPACT_INT, // Zigzag varint.
+	COMPACT_FLOAT,
+	COMPACT_DOUBLE, // Only when the value doesn't fit in a float.
+	COMPACT_STRING, // Varint length and UTF-8, no terminator.
+	COMPACT_VECTOR2,
+	COMPACT_VECTOR3,
+	COMPACT_VARIANT, // Anything else, as encode_variant() writes it.
+};
+
+// With a NULL buffer, only advances r_ofs by the length that would be written.
+static Error _encode_compact_variant(const Variant &p_variant, Vector<uint8_t> *r_buffer, int &r_ofs) {
+
+//writes the type byte and leaves w past it, or NULL when only measuring
+#define MAKE_ROOM(m_type, m_amount)                \
+	uint8_t *w = NULL;                             \
+	if (r_buffer) {                                \
+		if (r_buffer->size() < r_ofs + (m_amount)) \
+			r_buffer->resize(r_ofs + (m_amount));  \
+		w = r_buffer->ptrw() + r_ofs;              \
+		*w++ = m_type;                             \
+	}
+
+	switch (p_variant.get_type()) {
+
+		case Variant::NIL: {
+
+			MAKE_ROOM(COMPACT_NIL, 1);
+			r_ofs += 1;
+		} break;
+		case Variant::BOOL: {
+
+			MAKE_ROOM(bool(p_variant) ? COMPACT_TRUE : COMPACT_FALSE, 1);
+			r_ofs += 1;
+		} break;
+		case Variant::INT: {
+
+			int64_t value = p_variant;
+			uint64_t zigzag = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+
+			MAKE_ROOM(COMPACT_INT, 11);
+			r_ofs += 1 + _encode_varint(zigzag, w);
+		} break;
+		case Variant::REAL: {
+
+			double d = p_variant;
+			float f = d;
+
+			if (double(f) == d) {
+				MAKE_ROOM(COMPACT_FLOAT, 5);
+				if (w)
+					encode_float(f, w);
+				r_ofs += 5;
+			} else {
+				MAKE_ROOM(COMPACT_DOUBLE, 9);
+				if (w)
+					encode_double(d, w);
+				r_ofs += 9;
+			}
+		} break;
+		case Variant::STRING: {
+
+			CharString utf8 = String(p_variant).utf8();
+			int len = utf8.length();
+
+			MAKE_ROOM(COMPACT_STRING, 6 + len);
+			int len_size = _encode_varint(len, w);
+			if (w)
+				copymem(w + len_size, utf8.get_data(), len);
+			r_ofs += 1 + len_size + len;
+		} break;
+		case Variant::VECTOR2: {
+
+			Vector2 v = p_variant;
+
+			MAKE_ROOM(COMPACT_VECTOR2, 9);
+			if (w) {
+				encode_float(v.x, &w[0]);
+				encode_float(v.y, &w[4]);
+			}
+			r_ofs += 9;
+		} break;
+		case Variant::VECTOR3: {
+
+			Vector3 v = p_variant;
+
+			MAKE_ROOM(COMPACT_VECTOR3, 13);
+			if (w) {
+				encode_float(v.x, &w[0]);
+				encode_float(v.y, &w[4]);
+				encode_float(v.z, &w[8]);
+			}
+			r_ofs += 13;
+		} break;
+		default: {
+
+			int len;
+			Error err = encode_variant(p_variant, NULL, len);
+			ERR_FAIL_COND_V(err != OK, err);
+
+			MAKE_ROOM(COMPACT_VARIANT, 1 + len);
+			if (w)
+				encode_variant(p_variant, w, len);
+			r_ofs += 1 + len;
+		} break;
+	}
+
+#undef MAKE_ROOM
+
+	return OK;
+}
+
+static Error _decode_compact_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int &r_used) {
+
+	ERR_FAIL_COND_V(p_len < 1, ERR_INVALID_DATA);
+
+	const uint8_t *buf = p_buffer + 1;
+	int len = p_len - 1;
+
+	switch (p_buffer[0]) {
+
+		case COMPACT_NIL: {
+
+			r_variant = Variant();
+			r_used = 1;
+		} break;
+		case COMPACT_FALSE:
+		case COMPACT_TRUE: {
+
+			r_variant = p_buffer[0] == COMPACT_TRUE;
+			r_used = 1;
+		} break;
+		case COMPACT_INT: {
+
+			uint64_t zigzag;
+			int used;
+			ERR_FAIL_COND_V(_decode_varint(zigzag, buf, len, used) != OK, ERR_INVALID_DATA);
+
+			r_variant = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+			r_used = 1 + used;
+		} break;
+		case COMPACT_FLOAT: {
+
+			ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+			r_variant = decode_float(buf);
+			r_used = 5;
+		} break;
+		case COMPACT_DOUBLE: {
+
+			ERR_FAIL_COND_V(len < 8, ERR_INVALID_DATA);
+			r_variant = decode_double(buf);
+			r_used = 9;
+		} break;
+		case COMPACT_STRING: {
+
+			uint64_t str_len;
+			int used;
+			ERR_FAIL_COND_V(_decode_varint(str_len, buf, len, used) != OK, ERR_INVALID_DATA);
+			ERR_FAIL_COND_V(str_len > uint64_t(len - used), ERR_INVALID_DATA);
+
+			String str;
+			str.parse_utf8((const char *)buf + used, str_len);
+			r_variant = str;
+			r_used = 1 + used + str_len;
+		} break;
+		case COMPACT_VECTOR2: {
+
+			ERR_FAIL_COND_V(len < 8, ERR_INVALID_DATA);
+			r_variant = Vector2(decode_float(buf), decode_float(buf + 4));
+			r_used = 9;
+		} break;
+		case COMPACT_VECTOR3: {
+
+			ERR_FAIL_COND_V(len < 12, ERR_INVALID_DATA);
+			r_variant = Vector3(decode_float(buf), decode_float(buf + 4), decode_float(buf + 8));
+			r_used = 13;
+		} break;
+		case COMPACT_VARIANT: {
+
+			int used;
+			Error err = decode_variant(r_variant, buf, len, &used);
+			ERR_FAIL_COND_V(err != OK, err);
+			r_used = 1 + used;
+		} break;
+		default: {
+
+			ERR_FAIL_V(ERR_INVALID_DATA);
+		}
+	}
+
+	return OK;
+}
+
 void MultiplayerAPI::poll() {
 
 	if (!network_peer.is_valid() || network_peer->get_connection_status() == NetworkedMultiplayerPeer::CONNECTION_DISCONNECTED)
@@ -116,14 +360,25 @@ void MultiplayerAPI::poll() {
 			break; // It's also possible that a packet or RPC caused a disconnection, so also check here.
 		}
 	}
+
+	if (network_peer.is_valid() && network_peer->is_server()) {
+		_replication_tick();
+	}
 }
 
 void MultiplayerAPI::clear() {
 	connected_peers.clear();
 	path_get_cache.clear();
 	path_send_cache.clear();
+	name_send_cache.clear();
+	node_send_cache.clear();
 	packet_cache.clear();
+	args_cache.clear();
 	last_send_cache_id = 1;
+	last_name_cache_id = 1;
+	node_send_cache_prune_size = NODE_SEND_CACHE_PRUNE_MIN;
+	replication_peers.clear();
+	replication_last_tick = 0;
 }
 
 void MultiplayerAPI::set_root_node(Node *p_node) {
@@ -168,16 +423,19 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 	ERR_EXPLAIN("Invalid packet received. Size too small.");
 	ERR_FAIL_COND(p_packet_len < 1);
 
-	uint8_t packet_type = p_packet[0];
+	uint8_t packet_type = p_packet[0] & NETWORK_COMMAND_MASK;
+	uint8_t packet_flags = p_packet[0] & ~NETWORK_COMMAND_MASK;
 
 	switch (packet_type) {
 
-		case NETWORK_COMMAND_SIMPLIFY_PATH: {
+		case NETWORK_COMMAND_SIMPLIFY_PATH:
+		case NETWORK_COMMAND_SIMPLIFY_NAME: {
 
 			_process_simplify_path(p_from, p_packet, p_packet_len);
 		} break;
 
-		case NETWORK_COMMAND_CONFIRM_PATH: {
+		case NETWORK_COMMAND_CONFIRM_PATH:
+		case NETWORK_COMMAND_CONFIRM_NAME: {
 
 			_process_confirm_path(p_from, p_packet, p_packet_len);
 		} break;
@@ -186,33 +444,26 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 		case NETWORK_COMMAND_REMOTE_SET: {
 
 			ERR_EXPLAIN("Invalid packet received. Size too small.");
-			ERR_FAIL_COND(p_packet_len < 6);
+			ERR_FAIL_COND(p_packet_len < 4);
 
-			Node *node = _process_get_node(p_from, p_packet, p_packet_len);
+			int ofs = 1;
+			Node *node = _process_get_node(p_from, p_packet, p_packet_len, packet_flags, ofs);
 
 			ERR_EXPLAIN("Invalid packet received. Requested node was not found.");
 			ERR_FAIL_COND(node == NULL);
 
-			// Detect cstring end.
-			int len_end = 5;
-			for (; len_end < p_packet_len; len_end++) {
-				if (p_packet[len_end] == 0) {
-					break;
-				}
-			}
-
-			ERR_EXPLAIN("Invalid packet received. Size too small.");
-			ERR_FAIL_COND(len_end >= p_packet_len);
+			StringName name = _process_get_name(p_from, p_packet, p_packet_len, packet_flags, ofs);
 
-			StringName name = String::utf8((const char *)&p_packet[5]);
+			ERR_EXPLAIN("Invalid packet received. Requested method or property was not found.");
+			ERR_FAIL_COND(name == StringName());
 
 			if (packet_type == NETWORK_COMMAND_REMOTE_CALL) {
 
-				_process_rpc(node, name, p_from, p_packet, p_packet_len, len_end + 1);
+				_process_rpc(node, name, p_from, p_packet, p_packet_len, ofs);
 
 			} else {
 
-				_process_rset(node, name, p_from, p_packet, p_packet_len, len_end + 1);
+				_process_rset(node, name, p_from, p_packet, p_packet_len, ofs);
 			}
 
 		} break;
@@ -221,24 +472,32 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 
 			_process_raw(p_from, p_packet, p_packet_len);
 		} break;
+
+		case NETWORK_COMMAND_REPLICATE: {
+
+			_process_replicate(p_from, p_packet, p_packet_len);
+		} break;
+
+		case NETWORK_COMMAND_REPLICATE_ACK: {
+
+			_process_replicate_ack(p_from, p_packet, p_packet_len);
+		} break;
 	}
 }
 
-Node *MultiplayerAPI::_process_get_node(int p_from, const uint8_t *p_packet, int p_packet_len) {
+Node *MultiplayerAPI::_process_get_node(int p_from, const uint8_t *p_packet, int p_packet_len, uint8_t p_flags, int &r_ofs) {
 
-	uint32_t target = decode_uint32(&p_packet[1]);
 	Node *node = NULL;
 
-	if (target & 0x80000000) {
+	if (p_flags & NETWORK_COMMAND_FLAG_FULL_PATH) {
 		// Use full path (not cached yet).
 
-		int ofs = target & 0x7FFFFFFF;
+		String paths;
+		int len = _decode_cstring(paths, &p_packet[r_ofs], p_packet_len - r_ofs);
 
 		ERR_EXPLAIN("Invalid packet received. Size smaller than declared.");
-		ERR_FAIL_COND_V(ofs >= p_packet_len, NULL);
-
-		String paths;
-		paths.parse_utf8((const char *)&p_packet[ofs], p_packet_len - ofs);
+		ERR_FAIL_COND_V(len < 0, NULL);
+		r_ofs += len;
 
 		NodePath np = paths;
 
@@ -248,26 +507,82 @@ Node *MultiplayerAPI::_process_get_node(int p_from, const uint8_t *p_packet, int
 			ERR_PRINTS("Failed to get path from RPC: " + String(np));
 	} else {
 		// Use cached path.
-		int id = target;
+		uint64_t id;
+		int len;
+
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND_V(_decode_varint(id, &p_packet[r_ofs], p_packet_len - r_ofs, len) != OK, NULL);
+		r_ofs += len;
 
-		Map<int, PathGetCache>::Element *E = path_get_cache.find(p_from);
-		ERR_EXPLAIN("Invalid packet received. Requests invalid peer cache.");
-		ERR_FAIL_COND_V(!E, NULL);
+		node = _get_cached_node(p_from, id);
+	}
+	return node;
+}
 
-		Map<int, PathGetCache::NodeInfo>::Element *F = E->get().nodes.find(id);
-		ERR_EXPLAIN("Invalid packet received. Unabled to find requested cached node.");
-		ERR_FAIL_COND_V(!F, NULL);
+Node *MultiplayerAPI::_get_cached_node(int p_from, int p_id, bool p_report_missing) {
 
-		PathGetCache::NodeInfo *ni = &F->get();
-		// Do proper caching later.
+	Map<int, PathGetCache>::Element *E = path_get_cache.find(p_from);
+	ERR_EXPLAIN("Invalid packet received. Requests invalid peer cache.");
+	ERR_FAIL_COND_V(!E, NULL);
 
-		node = root_node->get_node(ni->path);
-		if (!node)
-			ERR_PRINTS("Failed to get cached path from RPC: " + String(ni->path));
+	Map<int, PathGetCache::NodeInfo>::Element *F = E->get().nodes.find(p_id);
+	ERR_EXPLAIN("Invalid packet received. Unabled to find requested cached node.");
+	ERR_FAIL_COND_V(!F, NULL);
+
+	PathGetCache::NodeInfo *ni = &F->get();
+
+	// Reuse the node found last time, unless it's gone or was moved.
+	Node *node = ni->instance ? Object::cast_to<Node>(ObjectDB::get_instance(ni->instance)) : NULL;
+	if (!node || !node->is_inside_tree() || node->get_path() != ni->instance_path) {
+
+		node = root_node->get_node_or_null(ni->path);
+		if (!node) {
+			ni->instance = 0;
+			if (p_report_missing)
+				ERR_PRINTS("Failed to get cached path from RPC: " + String(ni->path));
+		} else {
+			ni->instance = node->get_instance_id();
+			ni->instance_path = node->get_path();
+		}
 	}
+
 	return node;
 }
 
+StringName MultiplayerAPI::_process_get_name(int p_from, const uint8_t *p_packet, int p_packet_len, uint8_t p_flags, int &r_ofs) {
+
+	if (p_flags & NETWORK_COMMAND_FLAG_FULL_NAME) {
+		// Use full name (not cached yet).
+
+		String name;
+		int len = _decode_cstring(name, &p_packet[r_ofs], p_packet_len - r_ofs);
+
+		ERR_EXPLAIN("Invalid packet received. Size smaller than declared.");
+		ERR_FAIL_COND_V(len < 0, StringName());
+		r_ofs += len;
+
+		return name;
+	}
+
+	// Use cached name.
+	uint64_t id;
+	int len;
+
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND_V(_decode_varint(id, &p_packet[r_ofs], p_packet_len - r_ofs, len) != OK, StringName());
+	r_ofs += len;
+
+	Map<int, PathGetCache>::Element *E = path_get_cache.find(p_from);
+	ERR_EXPLAIN("Invalid packet received. Requests invalid peer cache.");
+	ERR_FAIL_COND_V(!E, StringName());
+
+	Map<int, StringName>::Element *F = E->get().names.find(id);
+	ERR_EXPLAIN("Invalid packet received. Unabled to find requested cached name.");
+	ERR_FAIL_COND_V(!F, StringName());
+
+	return F->get();
+}
+
 void MultiplayerAPI::_process_rpc(Node *p_node, const StringName &p_name, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset) {
 
 	ERR_EXPLAIN("Invalid packet received. Size too small.");
@@ -299,7 +614,7 @@ void MultiplayerAPI::_process_rpc(Node *p_node, const StringName &p_name, int p_
 		ERR_FAIL_COND(p_offset >= p_packet_len);
 
 		int vlen;
-		Error err = decode_variant(args.write[i], &p_packet[p_offset], p_packet_len - p_offset, &vlen);
+		Error err = _decode_compact_variant(args.write[i], &p_packet[p_offset], p_packet_len - p_offset, vlen);
 		ERR_EXPLAIN("Invalid packet received. Unable to decode RPC argument.");
 		ERR_FAIL_COND(err != OK);
 
@@ -335,7 +650,8 @@ void MultiplayerAPI::_process_rset(Node *p_node, const StringName &p_name, int p
 	ERR_FAIL_COND(!_can_call_mode(p_node, rset_mode, p_from));
 
 	Variant value;
-	Error err = decode_variant(value, &p_packet[p_offset], p_packet_len - p_offset);
+	int vlen;
+	Error err = _decode_compact_variant(value, &p_packet[p_offset], p_packet_len - p_offset, vlen);
 
 	ERR_EXPLAIN("Invalid packet received. Unable to decode RSET value.");
 	ERR_FAIL_COND(err != OK);
@@ -358,26 +674,37 @@ void MultiplayerAPI::_process_simplify_path(int p_from, const uint8_t *p_packet,
 	String paths;
 	paths.parse_utf8((const char *)&p_packet[5], p_packet_len - 5);
 
-	NodePath path = paths;
-
 	if (!path_get_cache.has(p_from)) {
 		path_get_cache[p_from] = PathGetCache();
 	}
 
-	PathGetCache::NodeInfo ni;
-	ni.path = path;
-	ni.instance = 0;
+	uint8_t confirm_command;
+
+	if (p_packet[0] == NETWORK_COMMAND_SIMPLIFY_NAME) {
 
-	path_get_cache[p_from].nodes[id] = ni;
+		path_get_cache[p_from].names[id] = paths;
+		confirm_command = NETWORK_COMMAND_CONFIRM_NAME;
+	} else {
+
+		NodePath path = paths;
+
+		PathGetCache::NodeInfo ni;
+		ni.path = path;
+		ni.instance = 0;
+
+		path_get_cache[p_from].nodes[id] = ni;
+		paths = path;
+		confirm_command = NETWORK_COMMAND_CONFIRM_PATH;
+	}
 
 	// Encode path to send ack.
-	CharString pname = String(path).utf8();
+	CharString pname = paths.utf8();
 	int len = encode_cstring(pname.get_data(), NULL);
 
 	Vector<uint8_t> packet;
 
 	packet.resize(1 + len);
-	packet.write[0] = NETWORK_COMMAND_CONFIRM_PATH;
+	packet.write[0] = confirm_command;
 	encode_cstring(pname.get_data(), &packet.write[1]);
 
 	network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_RELIABLE);
@@ -393,21 +720,32 @@ void MultiplayerAPI::_process_confirm_path(int p_from, const uint8_t *p_packet,
 	String paths;
 	paths.parse_utf8((const char *)&p_packet[1], p_packet_len - 1);
 
-	NodePath path = paths;
+	PathSentCache *psc;
+	if (p_packet[0] == NETWORK_COMMAND_CONFIRM_NAME) {
+		psc = name_send_cache.getptr(paths);
+	} else {
+		psc = path_send_cache.getptr(paths);
+	}
 
-	PathSentCache *psc = path_send_cache.getptr(path);
 	ERR_EXPLAIN("Invalid packet received. Tries to confirm a path which was not found in cache.");
 	ERR_FAIL_COND(!psc);
 
 	Map<int, bool>::Element *E = psc->confirmed_peers.find(p_from);
 	ERR_EXPLAIN("Invalid packet received. Source peer was not found in cache for the given path.");
 	ERR_FAIL_COND(!E);
-	E->get() = true;
+
+	if (!E->get()) {
+		E->get() = true;
+		psc->confirmed_count++;
+	}
 }
 
-bool MultiplayerAPI::_send_confirm_path(NodePath p_path, PathSentCache *psc, int p_target) {
+bool MultiplayerAPI::_check_confirmed_peers(PathSentCache *psc, int p_target, List<int> &r_peers_to_add) {
+
+	if (p_target == 0 && psc->confirmed_count == connected_peers.size())
+		return true; // Everyone has it already, and peers are removed from the caches when they leave.
+
 	bool has_all_peers = true;
-	List<int> peers_to_add; // If one is missing, take note to add it.
 
 	for (Set<int>::Element *E = connected_peers.front(); E; E = E->next()) {
 
@@ -423,27 +761,29 @@ bool MultiplayerAPI::_send_confirm_path(NodePath p_path, PathSentCache *psc, int
 			// Path was not cached, or was cached but is unconfirmed.
 			if (!F) {
 				// Not cached at all, take note.
-				peers_to_add.push_back(E->get());
+				r_peers_to_add.push_back(E->get());
 			}
 
 			has_all_peers = false;
 		}
 	}
 
-	// Those that need to be added, send a message for this.
+	return has_all_peers;
+}
+
+void MultiplayerAPI::_send_simplify(uint8_t p_command, const String &p_key, PathSentCache *psc, const List<int> &p_peers) {
 
-	for (List<int>::Element *E = peers_to_add.front(); E; E = E->next()) {
+	CharString pname = p_key.utf8();
+	int len = encode_cstring(pname.get_data(), NULL);
 
-		// Encode function name.
-		CharString pname = String(p_path).utf8();
-		int len = encode_cstring(pname.get_data(), NULL);
+	Vector<uint8_t> packet;
 
-		Vector<uint8_t> packet;
+	packet.resize(1 + 4 + len);
+	packet.write[0] = p_command;
+	encode_uint32(psc->id, &packet.write[1]);
+	encode_cstring(pname.get_data(), &packet.write[5]);
 
-		packet.resize(1 + 4 + len);
-		packet.write[0] = NETWORK_COMMAND_SIMPLIFY_PATH;
-		encode_uint32(psc->id, &packet.write[1]);
-		encode_cstring(pname.get_data(), &packet.write[5]);
+	for (const List<int>::Element *E = p_peers.front(); E; E = E->next()) {
 
 		network_peer->set_target_peer(E->get()); // To all of you.
 		network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_RELIABLE);
@@ -451,10 +791,118 @@ bool MultiplayerAPI::_send_confirm_path(NodePath p_path, PathSentCache *psc, int
 
 		psc->confirmed_peers.insert(E->get(), false); // Insert into confirmed, but as false since it was not confirmed.
 	}
+}
+
+bool MultiplayerAPI::_send_confirm_path(const NodePath &p_path, PathSentCache *psc, int p_target) {
+
+	List<int> peers_to_add; // If one is missing, take note to add it.
+	bool has_all_peers = _check_confirmed_peers(psc, p_target, peers_to_add);
+
+	if (!peers_to_add.empty()) {
+		_send_simplify(NETWORK_COMMAND_SIMPLIFY_PATH, p_path, psc, peers_to_add);
+	}
 
 	return has_all_peers;
 }
 
+bool MultiplayerAPI::_send_confirm_name(const StringName &p_name, PathSentCache *psc, int p_target) {
+
+	List<int> peers_to_add;
+	bool has_all_peers = _check_confirmed_peers(psc, p_target, peers_to_add);
+
+	if (!peers_to_add.empty()) {
+		_send_simplify(NETWORK_COMMAND_SIMPLIFY_NAME, p_name, psc, peers_to_add);
+	}
+
+	return has_all_peers;
+}
+
+MultiplayerAPI::NodeSendCache *MultiplayerAPI::_get_node_send_cache(Node *p_node) {
+
+	// Both paths are cached by the nodes, so comparing them is cheap as long as nothing moved.
+	NodePath root_path = root_node->get_path();
+	NodePath node_path = p_node->get_path();
+
+	NodeSendCache *nsc = node_send_cache.getptr(p_node->get_instance_id());
+	if (nsc && nsc->node_path == node_path && nsc->root_path == root_path)
+		return nsc;
+
+	NodePath from_path = root_path.rel_path_to(node_path);
+	ERR_EXPLAIN("Unable to send RPC. Relative path is empty. THIS IS LIKELY A BUG IN THE ENGINE!");
+	ERR_FAIL_COND_V(from_path.is_empty(), NULL);
+
+	// See if the path is cached.
+	PathSentCache *psc = path_send_cache.getptr(from_path);
+	if (!psc) {
+		// Path is not cached, create.
+		path_send_cache[from_path] = PathSentCache();
+		psc = path_send_cache.getptr(from_path);
+		psc->id = last_send_cache_id++;
+	}
+
+	if (!nsc) {
+
+		if ((int)node_send_cache.size() >= node_send_cache_prune_size) {
+			// Forget nodes that were freed, ids are never reused.
+			List<ObjectID> freed;
+			const ObjectID *k = NULL;
+			while ((k = node_send_cache.next(k))) {
+				if (!ObjectDB::get_instance(*k))
+					freed.push_back(*k);
+			}
+			for (List<ObjectID>::Element *E = freed.front(); E; E = E->next()) {
+				node_send_cache.erase(E->get());
+			}
+			node_send_cache_prune_size = MAX(NODE_SEND_CACHE_PRUNE_MIN, (int)node_send_cache.size() * 2);
+		}
+
+		node_send_cache[p_node->get_instance_id()] = NodeSendCache();
+		nsc = node_send_cache.getptr(p_node->get_instance_id());
+	}
+
+	nsc->root_path = root_path;
+	nsc->node_path = node_path;
+	nsc->from_path = from_path;
+	nsc->path_cache = psc;
+
+	return nsc;
+}
+
+#define MAKE_ROOM(m_amount) \
+	if (packet_cache.size() < m_amount) packet_cache.resize(m_amount);
+
+int MultiplayerAPI::_make_rpc_packet(bool p_set, int p_path_id, const CharString *p_path, int p_name_id, const CharString *p_name, int p_args_len) {
+
+	// Paths and names go by their cached id once the target confirmed it, else in full.
+	uint8_t command = p_set ? NETWORK_COMMAND_REMOTE_SET : NETWORK_COMMAND_REMOTE_CALL;
+	if (p_path)
+		command |= NETWORK_COMMAND_FLAG_FULL_PATH;
+	if (p_name)
+		command |= NETWORK_COMMAND_FLAG_FULL_NAME;
+
+	MAKE_ROOM(1 + (p_path ? p_path->length() + 1 : 5) + (p_name ? p_name->length() + 1 : 5) + p_args_len);
+	uint8_t *w = packet_cache.ptrw();
+
+	int ofs = 0;
+	w[ofs++] = command;
+
+	if (p_path) {
+		ofs += encode_cstring(p_path->get_data(), &w[ofs]);
+	} else {
+		ofs += _encode_varint(p_path_id, &w[ofs]);
+	}
+
+	if (p_name) {
+		ofs += encode_cstring(p_name->get_data(), &w[ofs]);
+	} else {
+		ofs += _encode_varint(p_name_id, &w[ofs]);
+	}
+
+	copymem(&w[ofs], args_cache.ptr(), p_args_len);
+
+	return ofs + p_args_len;
+}
+
 void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount) {
 
 	if (network_peer.is_null()) {
@@ -487,69 +935,46 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 		ERR_FAIL();
 	}
 
-	NodePath from_path = (root_node->get_path()).rel_path_to(p_from->get_path());
-	ERR_EXPLAIN("Unable to send RPC. Relative path is empty. THIS IS LIKELY A BUG IN THE ENGINE!");
-	ERR_FAIL_COND(from_path.is_empty());
+	NodeSendCache *nsc = _get_node_send_cache(p_from);
+	if (!nsc)
+		return; // Error printed already.
 
-	// See if the path is cached.
-	PathSentCache *psc = path_send_cache.getptr(from_path);
-	if (!psc) {
-		// Path is not cached, create.
-		path_send_cache[from_path] = PathSentCache();
-		psc = path_send_cache.getptr(from_path);
-		psc->id = last_send_cache_id++;
-	}
-
-	// Create base packet, lots of hardcode because it must be tight.
+	PathSentCache *psc = nsc->path_cache;
 
-	int ofs = 0;
+	// See if the method or property name is cached.
+	PathSentCache *nc = name_send_cache.getptr(p_name);
+	if (!nc) {
+		name_send_cache[p_name] = PathSentCache();
+		nc = name_send_cache.getptr(p_name);
+		nc->id = last_name_cache_id++;
+	}
 
-#define MAKE_ROOM(m_amount) \
-	if (packet_cache.size() < m_amount) packet_cache.resize(m_amount);
+	// Encode the arguments once, what goes in front of them depends on each peer.
 
-	// Encode type.
-	MAKE_ROOM(1);
-	packet_cache.write[0] = p_set ? NETWORK_COMMAND_REMOTE_SET : NETWORK_COMMAND_REMOTE_CALL;
-	ofs += 1;
-
-	// Encode ID.
-	MAKE_ROOM(ofs + 4);
-	encode_uint32(psc->id, &(packet_cache.write[ofs]));
-	ofs += 4;
-
-	// Encode function name.
-	CharString name = String(p_name).utf8();
-	int len = encode_cstring(name.get_data(), NULL);
-	MAKE_ROOM(ofs + len);
-	encode_cstring(name.get_data(), &(packet_cache.write[ofs]));
-	ofs += len;
+	int args_len = 0;
 
 	if (p_set) {
 		// Set argument.
-		Error err = encode_variant(*p_arg[0], NULL, len);
+		Error err = _encode_compact_variant(*p_arg[0], &args_cache, args_len);
 		ERR_EXPLAIN("Unable to encode RSET value. THIS IS LIKELY A BUG IN THE ENGINE!");
 		ERR_FAIL_COND(err != OK);
-		MAKE_ROOM(ofs + len);
-		encode_variant(*p_arg[0], &(packet_cache.write[ofs]), len);
-		ofs += len;
 
 	} else {
 		// Call arguments.
-		MAKE_ROOM(ofs + 1);
-		packet_cache.write[ofs] = p_argcount;
-		ofs += 1;
+		if (args_cache.size() < 1)
+			args_cache.resize(1);
+		args_cache.write[0] = p_argcount;
+		args_len += 1;
 		for (int i = 0; i < p_argcount; i++) {
-			Error err = encode_variant(*p_arg[i], NULL, len);
+			Error err = _encode_compact_variant(*p_arg[i], &args_cache, args_len);
 			ERR_EXPLAIN("Unable to encode RPC argument. THIS IS LIKELY A BUG IN THE ENGINE!");
 			ERR_FAIL_COND(err != OK);
-			MAKE_ROOM(ofs + len);
-			encode_variant(*p_arg[i], &(packet_cache.write[ofs]), len);
-			ofs += len;
 		}
 	}
 
-	// See if all peers have cached path (is so, call can be fast).
-	bool has_all_peers = _send_confirm_path(from_path, psc, p_to);
+	// See if all peers have cached path and name (is so, call can be fast).
+	bool has_all_peers = _send_confirm_path(nsc->from_path, psc, p_to);
+	has_all_peers = _send_confirm_name(p_name, nc, p_to) && has_all_peers;
 
 	// Take chance and set transfer mode, since all send methods will use it.
 	network_peer->set_transfer_mode(p_unreliable ? NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE : NetworkedMultiplayerPeer::TRANSFER_MODE_RELIABLE);
@@ -557,16 +982,14 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 	if (has_all_peers) {
 
 		// They all have verified paths, so send fast.
+		int len = _make_rpc_packet(p_set, psc->id, NULL, nc->id, NULL, args_len);
 		network_peer->set_target_peer(p_to); // To all of you.
-		network_peer->put_packet(packet_cache.ptr(), ofs); // A message with love.
+		network_peer->put_packet(packet_cache.ptr(), len); // A message with love.
 	} else {
 		// Not all verified path, so send one by one.
 
-		// Append path at the end, since we will need it for some packets.
-		CharString pname = String(from_path).utf8();
-		int path_len = encode_cstring(pname.get_data(), NULL);
-		MAKE_ROOM(ofs + path_len);
-		encode_cstring(pname.get_data(), &(packet_cache.write[ofs]));
+		CharString pname = String(nsc->from_path).utf8();
+		CharString name = String(p_name).utf8();
 
 		for (Set<int>::Element *E = connected_peers.front(); E; E = E->next()) {
 
@@ -577,23 +1000,29 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 				continue; // Continue, not for this peer.
 
 			Map<int, bool>::Element *F = psc->confirmed_peers.find(E->get());
-			ERR_CONTINUE(!F); // Should never happen.
+			Map<int, bool>::Element *G = nc->confirmed_peers.find(E->get());
+			ERR_CONTINUE(!F || !G); // Should never happen.
 
 			network_peer->set_target_peer(E->get()); // To this one specifically.
 
-			if (F->get()) {
-				// This one confirmed path, so use id.
-				encode_uint32(psc->id, &(packet_cache.write[1]));
-				network_peer->put_packet(packet_cache.ptr(), ofs);
-			} else {
-				// This one did not confirm path yet, so use entire path (sorry!).
-				encode_uint32(0x80000000 | ofs, &(packet_cache.write[1])); // Offset to path and flag.
-				network_peer->put_packet(packet_cache.ptr(), ofs + path_len);
-			}
+			// Whatever this one did not confirm yet goes in full (sorry!).
+			int len = _make_rpc_packet(p_set, psc->id, F->get() ? NULL : &pname, nc->id, G->get() ? NULL : &name, args_len);
+			network_peer->put_packet(packet_cache.ptr(), len);
 		}
 	}
 }
 
+void MultiplayerAPI::_erase_confirmed_peer(PathSentCache &psc, int p_id) {
+
+	Map<int, bool>::Element *E = psc.confirmed_peers.find(p_id);
+	if (!E)
+		return;
+
+	if (E->get())
+		psc.confirmed_count--;
+	psc.confirmed_peers.erase(E);
+}
+
 void MultiplayerAPI::_add_peer(int p_id) {
 	connected_peers.insert(p_id);
 	path_get_cache.insert(p_id, PathGetCache());
@@ -603,6 +1032,18 @@ void MultiplayerAPI::_add_peer(int p_id) {
 void MultiplayerAPI::_del_peer(int p_id) {
 	connected_peers.erase(p_id);
 	path_get_cache.erase(p_id); // I no longer need your cache, sorry.
+	replication_peers.erase(p_id);
+
+	// Keep confirmed_count in sync with the peers that are still around.
+	const NodePath *k = NULL;
+	while ((k = path_send_cache.next(k))) {
+		_erase_confirmed_peer(path_send_cache[*k], p_id);
+	}
+	const StringName *n = NULL;
+	while ((n = name_send_cache.next(n))) {
+		_erase_confirmed_peer(name_send_cache[*n], p_id);
+	}
+
 	emit_signal("network_peer_disconnected", p_id);
 }
 
@@ -776,6 +1217,675 @@ void MultiplayerAPI::_process_raw(int p_from, const uint8_t *p_packet, int p_pac
 	emit_signal("network_peer_packet", p_from, out);
 }
 
+void MultiplayerAPI::replicate_property(Node *p_node, const StringName &p_property, real_t p_quantization) {
+
+	ERR_FAIL_NULL(p_node);
+
+	ReplicatedNode *rn = replicated_nodes.getptr(p_node->get_instance_id());
+	if (!rn) {
+		replicated_nodes[p_node->get_instance_id()] = ReplicatedNode();
+		rn = replicated_nodes.getptr(p_node->get_instance_id());
+		rn->priority = 1.0;
+	}
+
+	for (int i = 0; i < rn->properties.size(); i++) {
+		if (rn->properties[i].name == p_property) {
+			rn->properties.write[i].quantization = MAX(p_quantization, 0);
+			return;
+		}
+	}
+
+	ERR_EXPLAIN("Too many replicated properties on node, the maximum is " + itos(REPLICATION_MAX_PROPERTIES) + ".");
+	ERR_FAIL_COND(rn->properties.size() >= REPLICATION_MAX_PROPERTIES);
+
+	ReplicatedProperty rp;
+	rp.name = p_property;
+	rp.quantization = MAX(p_quantization, 0);
+	rn->properties.push_back(rp);
+}
+
+void MultiplayerAPI::stop_replication(Node *p_node) {
+
+	ERR_FAIL_NULL(p_node);
+	_forget_replicated_node(p_node->get_instance_id());
+}
+
+void MultiplayerAPI::_forget_replicated_node(ObjectID p_instance) {
+
+	replicated_nodes.erase(p_instance);
+	for (Map<int, ReplicationPeer>::Element *E = replication_peers.front(); E; E = E->next()) {
+		E->get().priorities.erase(p_instance);
+	}
+}
+
+void MultiplayerAPI::set_replication_priority(Node *p_node, float p_priority) {
+
+	ERR_FAIL_NULL(p_node);
+
+	ReplicatedNode *rn = replicated_nodes.getptr(p_node->get_instance_id());
+	ERR_EXPLAIN("Node has no replicated properties.");
+	ERR_FAIL_COND(!rn);
+
+	rn->priority = MAX(p_priority, 0);
+}
+
+void MultiplayerAPI::set_replication_budget(int p_bytes) {
+
+	replication_budget = MAX(p_bytes, 64);
+}
+
+int MultiplayerAPI::get_replication_budget() const {
+
+	return replication_budget;
+}
+
+void MultiplayerAPI::set_replication_interval(float p_seconds) {
+
+	replication_interval = MAX(p_seconds, 0);
+}
+
+float MultiplayerAPI::get_replication_interval() const {
+
+	return replication_interval;
+}
+
+void MultiplayerAPI::set_replication_transfer_mode(NetworkedMultiplayerPeer::TransferMode p_mode) {
+
+	replication_transfer_mode = p_mode;
+}
+
+NetworkedMultiplayerPeer::TransferMode MultiplayerAPI::get_replication_transfer_mode() const {
+
+	return replication_transfer_mode;
+}
+
+// Snaps a value to the quantization grid, both ends store what the grid gives.
+static Variant _quantize_replicated(const Variant &p_value, real_t p_step) {
+
+	if (p_step <= 0)
+		return p_value;
+
+	switch (p_value.get_type()) {
+
+		case Variant::REAL: {
+
+			return Math::round(double(p_value) / p_step) * p_step;
+		} break;
+		case Variant::VECTOR2: {
+
+			Vector2 v = p_value;
+			return Vector2(Math::round(v.x / p_step) * p_step, Math::round(v.y / p_step) * p_step);
+		} break;
+		case Variant::VECTOR3: {
+
+			Vector3 v = p_value;
+			return Vector3(Math::round(v.x / p_step) * p_step, Math::round(v.y / p_step) * p_step, Math::round(v.z / p_step) * p_step);
+		} break;
+		default: {
+
+			return p_value;
+		}
+	}
+}
+
+// Ints and quantized reals and vectors go as steps from the baseline, anything else whole.
+static bool _can_replicate_delta(const Variant &p_value, const Variant &p_baseline, real_t p_step) {
+
+	if (p_value.get_type() != p_baseline.get_type())
+		return false;
+
+	switch (p_value.get_type()) {
+
+		case Variant::INT: {
+
+			return true;
+		} break;
+		case Variant::REAL:
+		case Variant::VECTOR2:
+		case Variant::VECTOR3: {
+
+			return p_step > 0;
+		} break;
+		default: {
+
+			return false;
+		}
+	}
+}
+
+static _FORCE_INLINE_ uint64_t _zigzag(int64_t p_value) {
+
+	return (uint64_t(p_value) << 1) ^ uint64_t(p_value >> 63);
+}
+
+static _FORCE_INLINE_ int64_t _unzigzag(uint64_t p_value) {
+
+	return int64_t(p_value >> 1) ^ -int64_t(p_value & 1);
+}
+
+static _FORCE_INLINE_ int64_t _quantized_steps(real_t p_value, real_t p_step) {
+
+	return int64_t(Math::round(double(p_value) / p_step));
+}
+
+static int _encode_replicated_delta(const Variant &p_value, const Variant &p_baseline, real_t p_step, uint8_t *p_arr) {
+
+	switch (p_value.get_type()) {
+
+		case Variant::INT: {
+
+			return _encode_varint(_zigzag(int64_t(p_value) - int64_t(p_baseline)), p_arr);
+		} break;
+		case Variant::REAL: {
+
+			return _encode_varint(_zigzag(_quantized_steps(p_value, p_step) - _quantized_steps(p_baseline, p_step)), p_arr);
+		} break;
+		case Variant::VECTOR2: {
+
+			Vector2 v = p_value;
+			Vector2 b = p_baseline;
+			int len = _encode_varint(_zigzag(_quantized_steps(v.x, p_step) - _quantized_steps(b.x, p_step)), p_arr);
+			len += _encode_varint(_zigzag(_quantized_steps(v.y, p_step) - _quantized_steps(b.y, p_step)), p_arr + len);
+			return len;
+		} break;
+		case Variant::VECTOR3: {
+
+			Vector3 v = p_value;
+			Vector3 b = p_baseline;
+			int len = _encode_varint(_zigzag(_quantized_steps(v.x, p_step) - _quantized_steps(b.x, p_step)), p_arr);
+			len += _encode_varint(_zigzag(_quantized_steps(v.y, p_step) - _quantized_steps(b.y, p_step)), p_arr + len);
+			len += _encode_varint(_zigzag(_quantized_steps(v.z, p_step) - _quantized_steps(b.z, p_step)), p_arr + len);
+			return len;
+		} break;
+		default: {
+
+			ERR_FAIL_V(0);
+		}
+	}
+}
+
+static Error _decode_replicated_delta(Variant &r_value, const Variant &p_baseline, real_t p_step, const uint8_t *p_arr, int p_len, int &r_used) {
+
+	int components = p_baseline.get_type() == Variant::VECTOR3 ? 3 : (p_baseline.get_type() == Variant::VECTOR2 ? 2 : 1);
+	int64_t deltas[3];
+
+	r_used = 0;
+	for (int i = 0; i < components; i++) {
+
+		uint64_t zigzag;
+		int used;
+		ERR_FAIL_COND_V(_decode_varint(zigzag, p_arr + r_used, p_len - r_used, used) != OK, ERR_INVALID_DATA);
+		deltas[i] = _unzigzag(zigzag);
+		r_used += used;
+	}
+
+	switch (p_baseline.get_type()) {
+
+		case Variant::INT: {
+
+			r_value = int64_t(p_baseline) + deltas[0];
+		} break;
+		case Variant::REAL: {
+
+			ERR_FAIL_COND_V(p_step <= 0, ERR_INVALID_DATA);
+			r_value = (_quantized_steps(p_baseline, p_step) + deltas[0]) * p_step;
+		} break;
+		case Variant::VECTOR2: {
+
+			ERR_FAIL_COND_V(p_step <= 0, ERR_INVALID_DATA);
+			Vector2 b = p_baseline;
+			r_value = Vector2((_quantized_steps(b.x, p_step) + deltas[0]) * p_step, (_quantized_steps(b.y, p_step) + deltas[1]) * p_step);
+		} break;
+		case Variant::VECTOR3: {
+
+			ERR_FAIL_COND_V(p_step <= 0, ERR_INVALID_DATA);
+			Vector3 b = p_baseline;
+			r_value = Vector3((_quantized_steps(b.x, p_step) + deltas[0]) * p_step, (_quantized_steps(b.y, p_step) + deltas[1]) * p_step, (_quantized_steps(b.z, p_step) + deltas[2]) * p_step);
+		} break;
+		default: {
+
+			ERR_FAIL_V(ERR_INVALID_DATA);
+		}
+	}
+
+	return OK;
+}
+
+void MultiplayerAPI::_replication_tick() {
+
+	if (replicated_nodes.empty() || connected_peers.empty())
+		return;
+
+	if (replication_interval > 0) {
+		uint64_t now = OS::get_singleton()->get_ticks_usec();
+		if (replication_last_tick && now - replication_last_tick < uint64_t(replication_interval * 1000000.0))
+			return;
+		replication_last_tick = now;
+	}
+
+	// Read and quantize every value once, all peers get deltas of the same state.
+	Vector<ReplicationItem> items;
+	List<ObjectID> freed;
+
+	const ObjectID *k = NULL;
+	while ((k = replicated_nodes.next(k))) {
+
+		Node *node = Object::cast_to<Node>(ObjectDB::get_instance(*k));
+		if (!node) {
+			freed.push_back(*k);
+			continue;
+		}
+
+		if (!node->is_inside_tree() || (node != root_node && !root_node->is_a_parent_of(node)))
+			continue;
+
+		NodeSendCache *nsc = _get_node_send_cache(node);
+		if (!nsc)
+			continue;
+
+		const ReplicatedNode *rn = replicated_nodes.getptr(*k);
+
+		ReplicationItem item;
+		item.instance = *k;
+		item.info = rn;
+		item.path = nsc->from_path;
+		item.path_cache = nsc->path_cache;
+		item.values.resize(rn->properties.size());
+		for (int i = 0; i < rn->properties.size(); i++) {
+			item.values.write[i] = _quantize_replicated(node->get(rn->properties[i].name), rn->properties[i].quantization);
+		}
+		items.push_back(item);
+	}
+
+	for (List<ObjectID>::Element *E = freed.front(); E; E = E->next()) {
+		_forget_replicated_node(E->get());
+	}
+
+	for (Set<int>::Element *E = connected_peers.front(); E; E = E->next()) {
+		_replicate_to_peer(E->get(), items);
+	}
+}
+
+int MultiplayerAPI::_encode_replicated_node(const ReplicationItem &p_item, const Vector<Variant> *p_baseline, int p_ofs) {
+
+	// Node entry: path id, length of the rest, changed mask, mask of the values sent whole, values.
+	uint64_t changed = 0;
+	uint64_t whole = 0;
+	int values_len = 0;
+	int count = p_item.values.size();
+
+	for (int i = 0; i < count; i++) {
+
+		const Variant &value = p_item.values[i];
+		real_t step = p_item.info->properties[i].quantization;
+
+		if (p_baseline && i < p_baseline->size()) {
+
+			const Variant &base = (*p_baseline)[i];
+			if (value.get_type() == base.get_type() && value == base)
+				continue;
+
+			changed |= uint64_t(1) << i;
+			if (_can_replicate_delta(value, base, step)) {
+				uint8_t buf[30];
+				values_len += _encode_replicated_delta(value, base, step, buf);
+				continue;
+			}
+		} else {
+			changed |= uint64_t(1) << i;
+		}
+
+		whole |= uint64_t(1) << i;
+		_encode_compact_variant(value, NULL, values_len);
+	}
+
+	if (!changed)
+		return 0;
+
+	int body_len = _encode_varint(changed, NULL) + _encode_varint(whole, NULL) + values_len;
+	int entry_len = _encode_varint(p_item.path_cache->id, NULL) + _encode_varint(body_len, NULL) + body_len;
+
+	if (replication_cache.size() < p_ofs + entry_len)
+		replication_cache.resize(p_ofs + entry_len);
+
+	int ofs = p_ofs;
+	ofs += _encode_varint(p_item.path_cache->id, &replication_cache.write[ofs]);
+	ofs += _encode_varint(body_len, &replication_cache.write[ofs]);
+	ofs += _encode_varint(changed, &replication_cache.write[ofs]);
+	ofs += _encode_varint(whole, &replication_cache.write[ofs]);
+
+	for (int i = 0; i < count; i++) {
+
+		if (!(changed & (uint64_t(1) << i)))
+			continue;
+
+		if (whole & (uint64_t(1) << i)) {
+			_encode_compact_variant(p_item.values[i], &replication_cache, ofs);
+		} else {
+			ofs += _encode_replicated_delta(p_item.values[i], (*p_baseline)[i], p_item.info->properties[i].quantization, &replication_cache.write[ofs]);
+		}
+	}
+
+	return entry_len;
+}
+
+struct _ReplicationOrder {
+
+	float priority;
+	int index;
+
+	bool operator<(const _ReplicationOrder &p_other) const {
+		return priority > p_other.priority; // Highest first.
+	}
+};
+
+void MultiplayerAPI::_replicate_to_peer(int p_peer, const Vector<ReplicationItem> &p_items) {
+
+	ReplicationPeer &rp = replication_peers[p_peer];
+
+	// Peers keep only the last snapshots, past that send the full state again.
+	const ReplicationSnapshot *baseline = NULL;
+	if (rp.acked && rp.sequence - rp.acked < REPLICATION_MAX_SNAPSHOTS) {
+		Map<uint32_t, ReplicationSnapshot>::Element *E = rp.snapshots.find(rp.acked);
+		if (E)
+			baseline = &E->get();
+	}
+
+	// Nodes that waited longest for bandwidth go first.
+	Vector<_ReplicationOrder> order;
+	order.resize(p_items.size());
+	for (int i = 0; i < p_items.size(); i++) {
+
+		float *acc = rp.priorities.getptr(p_items[i].instance);
+		if (!acc) {
+			rp.priorities[p_items[i].instance] = 0;
+			acc = rp.priorities.getptr(p_items[i].instance);
+		}
+		*acc += p_items[i].info->priority;
+
+		order.write[i].priority = *acc;
+		order.write[i].index = i;
+	}
+	order.sort();
+
+	// Nodes left out keep their baseline state in the new snapshot.
+	ReplicationSnapshot snapshot;
+	if (baseline)
+		snapshot = *baseline;
+
+	uint32_t sequence = rp.sequence + 1;
+
+	int ofs = 0;
+	if (replication_cache.size() < 11)
+		replication_cache.resize(11);
+	replication_cache.write[ofs++] = NETWORK_COMMAND_REPLICATE;
+	ofs += _encode_varint(sequence, &replication_cache.write[ofs]);
+	ofs += _encode_varint(baseline ? rp.acked : 0, &replication_cache.write[ofs]);
+
+	int header_len = ofs;
+
+	for (int i = 0; i < order.size(); i++) {
+
+		const ReplicationItem &item = p_items[order[i].index];
+
+		// The peer has to know the node by id first.
+		List<int> peers_to_add;
+		if (!_check_confirmed_peers(item.path_cache, p_peer, peers_to_add)) {
+			if (!peers_to_add.empty())
+				_send_simplify(NETWORK_COMMAND_SIMPLIFY_PATH, item.path, item.path_cache, peers_to_add);
+			continue;
+		}
+
+		const Vector<Variant> *base_values = baseline ? baseline->getptr(item.path_cache->id) : NULL;
+
+		int len = _encode_replicated_node(item, base_values, ofs);
+		if (len == 0) {
+			*rp.priorities.getptr(item.instance) = 0; // Nothing changed, nothing to wait for.
+			continue;
+		}
+
+		if (ofs + len > replication_budget && ofs > header_len)
+			continue; // Out of budget, try smaller ones and send this one next time.
+
+		ofs += len;
+		snapshot[item.path_cache->id] = item.values;
+		*rp.priorities.getptr(item.instance) = 0;
+	}
+
+	if (ofs == header_len)
+		return;
+
+	rp.sequence = sequence;
+	rp.snapshots[sequence] = snapshot;
+
+	// Without acknowledgements for a while, forget the oldest ones but the baseline.
+	while (rp.snapshots.size() > REPLICATION_MAX_SNAPSHOTS) {
+		Map<uint32_t, ReplicationSnapshot>::Element *E = rp.snapshots.front();
+		if (E->key() == rp.acked)
+			E = E->next();
+		rp.snapshots.erase(E);
+	}
+
+	network_peer->set_target_peer(p_peer);
+	network_peer->set_transfer_mode(replication_transfer_mode);
+	network_peer->put_packet(replication_cache.ptr(), ofs);
+}
+
+void MultiplayerAPI::_process_replicate(int p_from, const uint8_t *p_packet, int p_packet_len) {
+
+	ERR_EXPLAIN("Invalid packet received. Replicated state can only come from the server.");
+	ERR_FAIL_COND(p_from != NetworkedMultiplayerPeer::TARGET_PEER_SERVER || network_peer->is_server());
+
+	int ofs = 1;
+	uint64_t sequence;
+	uint64_t baseline_sequence;
+	int len;
+
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND(_decode_varint(sequence, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+	ofs += len;
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND(_decode_varint(baseline_sequence, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+	ofs += len;
+
+	ReplicationPeer &rp = replication_peers[p_from];
+
+	if (sequence <= rp.sequence)
+		return; // Late, a newer state was applied already.
+
+	const ReplicationSnapshot *baseline = NULL;
+	if (baseline_sequence) {
+		Map<uint32_t, ReplicationSnapshot>::Element *E = rp.snapshots.find(baseline_sequence);
+		if (!E) {
+			// Can't apply it, ask for the full state instead (sequence 0 in the ack).
+			uint8_t resync[3];
+			resync[0] = NETWORK_COMMAND_REPLICATE_ACK;
+			resync[1] = 0;
+			resync[2] = 0;
+			network_peer->set_target_peer(p_from);
+			network_peer->set_transfer_mode(replication_transfer_mode);
+			network_peer->put_packet(resync, sizeof(resync));
+			return;
+		}
+		baseline = &E->get();
+	}
+
+	ReplicationSnapshot snapshot;
+	if (baseline)
+		snapshot = *baseline;
+
+	// Nodes this side can't follow, the server sends them whole next time.
+	List<int> skipped;
+
+	while (ofs < p_packet_len) {
+
+		uint64_t id;
+		uint64_t body_len;
+
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(_decode_varint(id, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+		ofs += len;
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(_decode_varint(body_len, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+		ofs += len;
+		ERR_EXPLAIN("Invalid packet received. Size smaller than declared.");
+		ERR_FAIL_COND(body_len > uint64_t(p_packet_len - ofs));
+
+		const uint8_t *body = &p_packet[ofs];
+		int body_end = body_len;
+		ofs += body_len;
+
+		Node *node = _get_cached_node(p_from, id, false);
+		const ReplicatedNode *rn = node ? replicated_nodes.getptr(node->get_instance_id()) : NULL;
+		const Vector<Variant> *base_values = baseline ? baseline->getptr(id) : NULL;
+		if (!rn) {
+			skipped.push_back(id);
+			snapshot.erase(id);
+			continue;
+		}
+
+		uint64_t changed;
+		uint64_t whole;
+		int bofs = 0;
+
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(_decode_varint(changed, body, body_end, len) != OK);
+		bofs += len;
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(_decode_varint(whole, body + bofs, body_end - bofs, len) != OK);
+		bofs += len;
+
+		Vector<Variant> values;
+		values.resize(rn->properties.size());
+		if (base_values) {
+			for (int i = 0; i < values.size() && i < base_values->size(); i++) {
+				values.write[i] = (*base_values)[i];
+			}
+		}
+
+		bool valid = true;
+		for (int i = 0; i < REPLICATION_MAX_PROPERTIES && valid; i++) {
+
+			uint64_t bit = uint64_t(1) << i;
+			if (!(changed & bit))
+				continue;
+
+			if (i >= values.size() || (!(whole & bit) && (!base_values || i >= base_values->size()))) {
+				valid = false; // Properties don't match the server's, or the baseline is missing.
+				break;
+			}
+
+			Error err;
+			if (whole & bit) {
+				err = _decode_compact_variant(values.write[i], body + bofs, body_end - bofs, len);
+			} else {
+				err = _decode_replicated_delta(values.write[i], (*base_values)[i], rn->properties[i].quantization, body + bofs, body_end - bofs, len);
+			}
+			if (err != OK) {
+				valid = false;
+				break;
+			}
+			bofs += len;
+		}
+
+		if (!valid) {
+			skipped.push_back(id);
+			snapshot.erase(id);
+			continue;
+		}
+
+		for (int i = 0; i < values.size(); i++) {
+			if (changed & (uint64_t(1) << i))
+				node->set(rn->properties[i].name, values[i]);
+		}
+		snapshot[id] = values;
+	}
+
+	rp.sequence = sequence;
+	rp.snapshots[sequence] = snapshot;
+
+	// The server only makes deltas against snapshots it got an acknowledgement for,
+	// so anything older than the baseline it used is not needed anymore.
+	while (rp.snapshots.size() && rp.snapshots.front()->key() < baseline_sequence) {
+		rp.snapshots.erase(rp.snapshots.front());
+	}
+
+	// Acknowledgements may be getting lost, keep the baseline and the newest ones.
+	while (rp.snapshots.size() > REPLICATION_MAX_SNAPSHOTS) {
+		Map<uint32_t, ReplicationSnapshot>::Element *E = rp.snapshots.front();
+		if (E->key() == baseline_sequence)
+			E = E->next();
+		rp.snapshots.erase(E);
+	}
+
+	// Acknowledge, telling which nodes could not be applied.
+	int ack_len = 1 + _encode_varint(sequence, NULL) + _encode_varint(skipped.size(), NULL);
+	for (List<int>::Element *E = skipped.front(); E; E = E->next()) {
+		ack_len += _encode_varint(E->get(), NULL);
+	}
+
+	Vector<uint8_t> packet;
+	packet.resize(ack_len);
+	int aofs = 0;
+	packet.write[aofs++] = NETWORK_COMMAND_REPLICATE_ACK;
+	aofs += _encode_varint(sequence, &packet.write[aofs]);
+	aofs += _encode_varint(skipped.size(), &packet.write[aofs]);
+	for (List<int>::Element *E = skipped.front(); E; E = E->next()) {
+		aofs += _encode_varint(E->get(), &packet.write[aofs]);
+	}
+
+	network_peer->set_target_peer(p_from);
+	network_peer->set_transfer_mode(replication_transfer_mode);
+	network_peer->put_packet(packet.ptr(), packet.size());
+}
+
+void MultiplayerAPI::_process_replicate_ack(int p_from, const uint8_t *p_packet, int p_packet_len) {
+
+	int ofs = 1;
+	uint64_t sequence;
+	uint64_t skipped_count;
+	int len;
+
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND(_decode_varint(sequence, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+	ofs += len;
+	ERR_EXPLAIN("Invalid packet received. Size too small.");
+	ERR_FAIL_COND(_decode_varint(skipped_count, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+	ofs += len;
+
+	Map<int, ReplicationPeer>::Element *E = replication_peers.find(p_from);
+	if (!E)
+		return;
+
+	if (sequence == 0) {
+		E->get().acked = 0; // The peer lost its baseline, the next state goes whole.
+		return;
+	}
+
+	if (sequence <= E->get().acked)
+		return; // Stale.
+
+	ReplicationPeer &rp = E->get();
+
+	Map<uint32_t, ReplicationSnapshot>::Element *S = rp.snapshots.find(sequence);
+	if (!S)
+		return; // Forgotten already, keep the current baseline.
+
+	// Whatever the peer could not apply is not part of its state.
+	for (uint64_t i = 0; i < skipped_count; i++) {
+		uint64_t id;
+		ERR_EXPLAIN("Invalid packet received. Size too small.");
+		ERR_FAIL_COND(_decode_varint(id, &p_packet[ofs], p_packet_len - ofs, len) != OK);
+		ofs += len;
+		S->get().erase(id);
+	}
+
+	rp.acked = sequence;
+	while (rp.snapshots.front()->key() < sequence) {
+		rp.snapshots.erase(rp.snapshots.front());
+	}
+}
+
 int MultiplayerAPI::get_network_unique_id() const {
 
 	ERR_EXPLAIN("No network peer is assigned. Unable to get unique network ID.");
@@ -838,7 +1948,19 @@ void MultiplayerAPI::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_network_connected_peers"), &MultiplayerAPI::get_network_connected_peers);
 	ClassDB::bind_method(D_METHOD("set_refuse_new_network_connections", "refuse"), &MultiplayerAPI::set_refuse_new_network_connections);
 	ClassDB::bind_method(D_METHOD("is_refusing_new_network_connections"), &MultiplayerAPI::is_refusing_new_network_connections);
+	ClassDB::bind_method(D_METHOD("replicate_property", "node", "property", "quantization"), &MultiplayerAPI::replicate_property, DEFVAL(0.0));
+	ClassDB::bind_method(D_METHOD("stop_replication", "node"), &MultiplayerAPI::stop_replication);
+	ClassDB::bind_method(D_METHOD("set_replication_priority", "node", "priority"), &MultiplayerAPI::set_replication_priority);
+	ClassDB::bind_method(D_METHOD("set_replication_budget", "bytes"), &MultiplayerAPI::set_replication_budget);
+	ClassDB::bind_method(D_METHOD("get_replication_budget"), &MultiplayerAPI::get_replication_budget);
+	ClassDB::bind_method(D_METHOD("set_replication_interval", "seconds"), &MultiplayerAPI::set_replication_interval);
+	ClassDB::bind_method(D_METHOD("get_replication_interval"), &MultiplayerAPI::get_replication_interval);
+	ClassDB::bind_method(D_METHOD("set_replication_transfer_mode", "mode"), &MultiplayerAPI::set_replication_transfer_mode);
+	ClassDB::bind_method(D_METHOD("get_replication_transfer_mode"), &MultiplayerAPI::get_replication_transfer_mode);
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "refuse_new_network_connections"), "set_refuse_new_network_connections", "is_refusing_new_network_connections");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "replication_budget", PROPERTY_HINT_RANGE, "64,65536,1"), "set_replication_budget", "get_replication_budget");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "replication_interval", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_replication_interval", "get_replication_interval");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "replication_transfer_mode", PROPERTY_HINT_ENUM, "Unreliable,Unreliable Ordered,Reliable"), "set_replication_transfer_mode", "get_replication_transfer_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "network_peer", PROPERTY_HINT_RESOURCE_TYPE, "NetworkedMultiplayerPeer", 0), "set_network_peer", "get_network_peer");
 
 	ADD_SIGNAL(MethodInfo("network_peer_connected", PropertyInfo(Variant::INT, "id")));
@@ -862,6 +1984,9 @@ void MultiplayerAPI::_bind_methods() {
 MultiplayerAPI::MultiplayerAPI() {
 	rpc_sender_id = 0;
 	root_node = NULL;
+	replication_budget = 1024;
+	replication_interval = 0;
+	replication_transfer_mode = NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE;
 	clear();
 }
 
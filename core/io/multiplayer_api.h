@@ -42,7 +42,13 @@ private:
 	//path sent caches
 	struct PathSentCache {
 		Map<int, bool> confirmed_peers;
+		int confirmed_count;
 		int id;
+
+		PathSentCache() {
+			confirmed_count = 0;
+			id = 0;
+		}
 	};
 
 	//path get caches
@@ -50,33 +56,111 @@ private:
 		struct NodeInfo {
 			NodePath path;
 			ObjectID instance;
+			NodePath instance_path; // Where the instance was when it was resolved.
 		};
 
 		Map<int, NodeInfo> nodes;
+		Map<int, StringName> names;
+	};
+
+	// What sending needs from a node, valid until the node or the root are moved.
+	struct NodeSendCache {
+		NodePath root_path;
+		NodePath node_path;
+		NodePath from_path;
+		PathSentCache *path_cache;
+	};
+
+	// State replication, see replicate_property().
+	struct ReplicatedProperty {
+		StringName name;
+		real_t quantization;
+	};
+
+	struct ReplicatedNode {
+		Vector<ReplicatedProperty> properties;
+		float priority;
+	};
+
+	// Replicated values of every node in a snapshot, by node path id.
+	typedef HashMap<int, Vector<Variant> > ReplicationSnapshot;
+
+	struct ReplicationPeer {
+		uint32_t sequence; // Last snapshot sent to this peer, or applied from the server.
+		uint32_t acked; // Last snapshot the peer acknowledged, deltas are made against it.
+		Map<uint32_t, ReplicationSnapshot> snapshots;
+		HashMap<ObjectID, float> priorities; // Grows while a node waits for bandwidth.
+
+		ReplicationPeer() {
+			sequence = 0;
+			acked = 0;
+		}
+	};
+
+	struct ReplicationItem {
+		ObjectID instance;
+		const ReplicatedNode *info;
+		NodePath path;
+		PathSentCache *path_cache;
+		Vector<Variant> values;
+	};
+
+	enum {
+		NODE_SEND_CACHE_PRUNE_MIN = 256,
+		REPLICATION_MAX_PROPERTIES = 64, // Bits in the change masks.
+		REPLICATION_MAX_SNAPSHOTS = 64 // Kept per peer while waiting for acknowledgements.
 	};
 
 	Ref<NetworkedMultiplayerPeer> network_peer;
 	int rpc_sender_id;
 	Set<int> connected_peers;
 	HashMap<NodePath, PathSentCache> path_send_cache;
+	HashMap<StringName, PathSentCache> name_send_cache;
+	HashMap<ObjectID, NodeSendCache> node_send_cache;
 	Map<int, PathGetCache> path_get_cache;
 	int last_send_cache_id;
+	int last_name_cache_id;
+	int node_send_cache_prune_size;
 	Vector<uint8_t> packet_cache;
+	Vector<uint8_t> args_cache;
 	Node *root_node;
 
+	HashMap<ObjectID, ReplicatedNode> replicated_nodes;
+	Map<int, ReplicationPeer> replication_peers;
+	Vector<uint8_t> replication_cache;
+	int replication_budget;
+	float replication_interval;
+	uint64_t replication_last_tick;
+	NetworkedMultiplayerPeer::TransferMode replication_transfer_mode;
+
 protected:
 	static void _bind_methods();
 
 	void _process_packet(int p_from, const uint8_t *p_packet, int p_packet_len);
 	void _process_simplify_path(int p_from, const uint8_t *p_packet, int p_packet_len);
 	void _process_confirm_path(int p_from, const uint8_t *p_packet, int p_packet_len);
-	Node *_process_get_node(int p_from, const uint8_t *p_packet, int p_packet_len);
+	Node *_process_get_node(int p_from, const uint8_t *p_packet, int p_packet_len, uint8_t p_flags, int &r_ofs);
+	StringName _process_get_name(int p_from, const uint8_t *p_packet, int p_packet_len, uint8_t p_flags, int &r_ofs);
 	void _process_rpc(Node *p_node, const StringName &p_name, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_rset(Node *p_node, const StringName &p_name, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_raw(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replicate(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replicate_ack(int p_from, const uint8_t *p_packet, int p_packet_len);
+	Node *_get_cached_node(int p_from, int p_id, bool p_report_missing = true);
 
 	void _send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount);
-	bool _send_confirm_path(NodePath p_path, PathSentCache *psc, int p_from);
+	int _make_rpc_packet(bool p_set, int p_path_id, const CharString *p_path, int p_name_id, const CharString *p_name, int p_args_len);
+	NodeSendCache *_get_node_send_cache(Node *p_node);
+	bool _check_confirmed_peers(PathSentCache *psc, int p_target, List<int> &r_peers_to_add);
+	void _send_simplify(uint8_t p_command, const String &p_key, PathSentCache *psc, const List<int> &p_peers);
+	bool _send_confirm_path(const NodePath &p_path, PathSentCache *psc, int p_target);
+	bool _send_confirm_name(const StringName &p_name, PathSentCache *psc, int p_target);
+	void _erase_confirmed_peer(PathSentCache &psc, int p_id);
+
+	void _replication_tick();
+	void _forget_replicated_node(ObjectID p_instance);
+	void _replicate_to_peer(int p_peer, const Vector<ReplicationItem> &p_items);
+	int _encode_replicated_node(const ReplicationItem &p_item, const Vector<Variant> *p_baseline, int p_ofs);
 
 public:
 	enum NetworkCommands {
@@ -85,6 +169,16 @@ public:
 		NETWORK_COMMAND_SIMPLIFY_PATH,
 		NETWORK_COMMAND_CONFIRM_PATH,
 		NETWORK_COMMAND_RAW,
+		NETWORK_COMMAND_SIMPLIFY_NAME,
+		NETWORK_COMMAND_CONFIRM_NAME,
+		NETWORK_COMMAND_REPLICATE,
+		NETWORK_COMMAND_REPLICATE_ACK,
+	};
+
+	enum NetworkCommandFlags {
+		NETWORK_COMMAND_MASK = 0x0F, // The command itself, the other bits are flags.
+		NETWORK_COMMAND_FLAG_FULL_PATH = 0x10, // Node sent by path, the peer didn't confirm its id yet.
+		NETWORK_COMMAND_FLAG_FULL_NAME = 0x20, // Method or property sent by name, the peer didn't confirm its id yet.
 	};
 
 	enum RPCMode {
@@ -112,6 +206,16 @@ public:
 	// Called by Node.rset
 	void rsetp(Node *p_node, int p_peer_id, bool p_unreliable, const StringName &p_property, const Variant &p_value);
 
+	void replicate_property(Node *p_node, const StringName &p_property, real_t p_quantization = 0);
+	void stop_replication(Node *p_node);
+	void set_replication_priority(Node *p_node, float p_priority);
+	void set_replication_budget(int p_bytes);
+	int get_replication_budget() const;
+	void set_replication_interval(float p_seconds);
+	float get_replication_interval() const;
+	void set_replication_transfer_mode(NetworkedMultiplayerPeer::TransferMode p_mode);
+	NetworkedMultiplayerPeer::TransferMode get_replication_transfer_mode() const;
+
 	void _add_peer(int p_id);
 	void _del_peer(int p_id);
 	void _connected_to_server();
@@ -31,6 +31,7 @@
 #include "net_socket.h"
 
 NetSocket *(*NetSocket::_create)() = NULL;
+NetSocketPoller *(*NetSocketPoller::_create)() = NULL;
 
 NetSocket *NetSocket::create() {
 
@@ -40,3 +41,157 @@ NetSocket *NetSocket::create() {
 	ERR_PRINT("Unable to create network socket, platform not supported");
 	return NULL;
 }
+
+void NetSocket::_unwatch() {
+
+	if (_poller)
+		_poller->remove(this);
+}
+
+Error NetSocket::recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_received) {
+
+	r_received = 0;
+	while (r_received < p_count) {
+
+		Datagram &d = r_datagrams[r_received];
+		Error err = recvfrom(d.buffer, d.buffer_size, d.size, d.ip, d.port);
+		if (err != OK)
+			return r_received ? OK : err;
+		r_received++;
+	}
+
+	return OK;
+}
+
+Error NetSocket::sendto_batch(const Datagram *p_datagrams, int p_count, int &r_sent) {
+
+	r_sent = 0;
+	while (r_sent < p_count) {
+
+		const Datagram &d = p_datagrams[r_sent];
+		int sent;
+		Error err = sendto(d.buffer, d.size, sent, d.ip, d.port);
+		if (err != OK)
+			return r_sent ? OK : err;
+		r_sent++;
+	}
+
+	return OK;
+}
+
+NetSocketPoller *NetSocketPoller::create() {
+
+	if (_create)
+		return _create();
+
+	ERR_PRINT("Unable to create socket poller, platform not supported");
+	return NULL;
+}
+
+void NetSocketPoller::_set_ready(NetSocket *p_sock, int p_events) {
+
+	if (!p_sock->_ready_events) {
+		if (ready.size() == ready_count)
+			ready.resize(MAX(16, ready_count * 2));
+		ready.write[ready_count++] = p_sock;
+	}
+	p_sock->_ready_events |= p_events;
+}
+
+Error NetSocketPoller::add(NetSocket *p_sock, int p_events) {
+
+	ERR_FAIL_COND_V(!p_sock || !p_sock->is_open(), ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_sock->_poller != NULL, ERR_ALREADY_IN_USE);
+
+	p_sock->_poller_index = sockets.size();
+	sockets.push_back(p_sock);
+
+	Error err = _add(p_sock, p_events);
+	if (err != OK) {
+		sockets.resize(sockets.size() - 1);
+		p_sock->_poller_index = -1;
+		return err;
+	}
+
+	p_sock->_poller = this;
+	p_sock->_ready_events = 0;
+	return OK;
+}
+
+Error NetSocketPoller::modify(NetSocket *p_sock, int p_events) {
+
+	ERR_FAIL_COND_V(!p_sock || p_sock->_poller != this, ERR_INVALID_PARAMETER);
+
+	return _modify(p_sock, p_events);
+}
+
+void NetSocketPoller::remove(NetSocket *p_sock) {
+
+	ERR_FAIL_COND(!p_sock || p_sock->_poller != this);
+
+	_remove(p_sock);
+
+	int index = p_sock->_poller_index;
+	int last = sockets.size() - 1;
+	if (index != last) {
+		sockets.write[index] = sockets[last];
+		sockets[index]->_poller_index = index;
+	}
+	sockets.resize(last);
+
+	if (p_sock->_ready_events) {
+		for (int i = 0; i < ready_count; i++) {
+			if (ready[i] == p_sock) {
+				ready.write[i] = ready[--ready_count];
+				break;
+			}
+		}
+	}
+
+	p_sock->_poller = NULL;
+	p_sock->_poller_index = -1;
+	p_sock->_ready_events = 0;
+}
+
+Error NetSocketPoller::wait(int p_timeout) {
+
+	for (int i = 0; i < ready_count; i++) {
+		ready[i]->_ready_events = 0;
+	}
+	ready_count = 0;
+
+	if (sockets.empty())
+		return OK;
+
+	return _wait(p_timeout);
+}
+
+int NetSocketPoller::get_ready_count() const {
+
+	return ready_count;
+}
+
+NetSocket *NetSocketPoller::get_ready_socket(int p_index) const {
+
+	ERR_FAIL_INDEX_V(p_index, ready_count, NULL);
+	return ready[p_index];
+}
+
+int NetSocketPoller::get_watched_count() const {
+
+	return sockets.size();
+}
+
+NetSocketPoller::NetSocketPoller() :
+		ready_count(0) {
+}
+
+NetSocketPoller::~NetSocketPoller() {
+
+	// Implementations released their handles already, only the sockets are left to let go.
+	for (int i = 0; i < sockets.size(); i++) {
+		sockets[i]->_poller = NULL;
+		sockets[i]->_poller_index = -1;
+		sockets[i]->_ready_events = 0;
+	}
+}
@@ -34,11 +34,22 @@
 #include "core/io/ip.h"
 #include "core/reference.h"
 
+class NetSocketPoller;
+
 class NetSocket : public Reference {
 
+	friend class NetSocketPoller;
+
+	NetSocketPoller *_poller;
+	int _poller_index;
+	mutable int _ready_events;
+
 protected:
 	static NetSocket *(*_create)();
 
+	// Implementations call this before closing the socket.
+	void _unwatch();
+
 public:
 	static NetSocket *create();
 
@@ -54,6 +65,23 @@ public:
 		TYPE_UDP,
 	};
 
+	// One datagram for the batch calls. On receive, buffer and buffer_size
+	// are filled by the caller, the rest by the socket. A size larger than
+	// buffer_size means the datagram did not fit and was cut.
+	struct Datagram {
+		uint8_t *buffer;
+		int buffer_size;
+		int size;
+		IP_Address ip;
+		uint16_t port;
+
+		Datagram() :
+				buffer(NULL),
+				buffer_size(0),
+				size(0),
+				port(0) {}
+	};
+
 	virtual Error open(Type p_type, IP::Type &ip_type) = 0;
 	virtual void close() = 0;
 	virtual Error bind(IP_Address p_addr, uint16_t p_port) = 0;
@@ -66,6 +94,11 @@ public:
 	virtual Error sendto(const uint8_t *p_buffer, int p_len, int &r_sent, IP_Address p_ip, uint16_t p_port) = 0;
 	virtual Ref<NetSocket> accept(IP_Address &r_ip, uint16_t &r_port) = 0;
 
+	// Default implementations loop over recvfrom() and sendto(), platforms
+	// able to move many datagrams in a single call override them.
+	virtual Error recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_received);
+	virtual Error sendto_batch(const Datagram *p_datagrams, int p_count, int &r_sent);
+
 	virtual bool is_open() const = 0;
 	virtual int get_available_bytes() const = 0;
 
@@ -74,6 +107,62 @@ public:
 	virtual void set_ipv6_only_enabled(bool p_enabled) = 0;
 	virtual void set_tcp_no_delay_enabled(bool p_enabled) = 0;
 	virtual void set_reuse_address_enabled(bool p_enabled) = 0;
+	virtual void set_recv_buffer_size(int p_bytes) = 0;
+	virtual void set_send_buffer_size(int p_bytes) = 0;
+
+	// Readiness seen by the last NetSocketPoller::wait(), for sockets added to a poller.
+	_FORCE_INLINE_ bool is_watched() const { return _poller != NULL; }
+	_FORCE_INLINE_ int get_ready_events() const { return _ready_events; }
+	_FORCE_INLINE_ void clear_ready_events(int p_events) const { _ready_events &= ~p_events; }
+
+	NetSocket() :
+			_poller(NULL),
+			_poller_index(-1),
+			_ready_events(0) {}
+};
+
+// Waits on many sockets with a single call. After wait(), each watched
+// socket knows if it was ready, so its owner can skip the syscalls for the
+// idle ones until the next wait(). Sockets leave the poller when closed.
+class NetSocketPoller : public Reference {
+
+	Vector<NetSocket *> ready;
+	int ready_count;
+
+protected:
+	static NetSocketPoller *(*_create)();
+
+	Vector<NetSocket *> sockets;
+
+	void _set_ready(NetSocket *p_sock, int p_events);
+	_FORCE_INLINE_ static int _get_index(const NetSocket *p_sock) { return p_sock->_poller_index; }
+
+	// Implementations mirror sockets, the removed one is replaced by the last.
+	virtual Error _add(NetSocket *p_sock, int p_events) = 0;
+	virtual Error _modify(NetSocket *p_sock, int p_events) = 0;
+	virtual void _remove(NetSocket *p_sock) = 0;
+	virtual Error _wait(int p_timeout) = 0;
+
+public:
+	enum Event {
+		EVENT_IN = 1,
+		EVENT_OUT = 2,
+		EVENT_ERROR = 4
+	};
+
+	static NetSocketPoller *create();
+
+	Error add(NetSocket *p_sock, int p_events = EVENT_IN);
+	Error modify(NetSocket *p_sock, int p_events);
+	void remove(NetSocket *p_sock);
+
+	Error wait(int p_timeout);
+	int get_ready_count() const;
+	NetSocket *get_ready_socket(int p_index) const;
+	int get_watched_count() const;
+
+	NetSocketPoller();
+	~NetSocketPoller();
 };
 
 #endif // NET_SOCKET_H
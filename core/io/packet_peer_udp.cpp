@@ -32,6 +32,29 @@
 
 #include "core/io/ip.h"
 
+uint8_t *PacketPeerUDP::recv_batch = NULL;
+NetSocket::Datagram PacketPeerUDP::recv_datagrams[PacketPeerUDP::RECV_BATCH_SIZE];
+Mutex *PacketPeerUDP::recv_batch_mutex = NULL;
+
+void PacketPeerUDP::setup_recv_batch() {
+
+	ERR_FAIL_COND(recv_batch_mutex != NULL);
+	recv_batch_mutex = Mutex::create();
+}
+
+void PacketPeerUDP::finish_recv_batch() {
+
+	if (recv_batch) {
+		memfree(recv_batch);
+		recv_batch = NULL;
+	}
+
+	if (recv_batch_mutex) {
+		memdelete(recv_batch_mutex);
+		recv_batch_mutex = NULL;
+	}
+}
+
 void PacketPeerUDP::set_blocking_mode(bool p_enable) {
 
 	blocking = p_enable;
@@ -67,6 +90,74 @@ int PacketPeerUDP::get_available_packet_count() const {
 	return queue_count;
 }
 
+void PacketPeerUDP::_release_packet() {
+
+	if (!packet_reserved)
+		return;
+
+	packet_reserved = false;
+
+	if (queue_count == 0) {
+		data_read = 0;
+		data_write = 0;
+		data_wrapped = false;
+		return;
+	}
+
+	int next = queue[queue_front].ofs;
+	if (next < data_read)
+		data_wrapped = false; // Reading went around too.
+	data_read = next;
+}
+
+bool PacketPeerUDP::_queue_packet(const uint8_t *p_data, int p_size, const IP_Address &p_ip, uint16_t p_port) {
+
+	int capacity = queue_data.size();
+	int ofs = -1;
+
+	if (queue_count == 0 && !packet_reserved) {
+		data_read = 0;
+		data_write = 0;
+		data_wrapped = false;
+	}
+
+	// Packets are never split, when the end can't fit one it goes back to the start.
+	if (!data_wrapped) {
+		if (capacity - data_write >= p_size) {
+			ofs = data_write;
+		} else if (p_size <= data_read) {
+			ofs = 0;
+			data_wrapped = true;
+		}
+	} else if (data_read - data_write >= p_size) {
+		ofs = data_write;
+	}
+
+	if (ofs < 0)
+		return false;
+
+	if (queue_count == queue.size()) {
+		Vector<Packet> grown;
+		grown.resize(MAX(16, queue.size() * 2));
+		for (int i = 0; i < queue_count; i++) {
+			grown.write[i] = queue[(queue_front + i) % queue.size()];
+		}
+		queue = grown;
+		queue_front = 0;
+	}
+
+	Packet &packet = queue.write[(queue_front + queue_count) % queue.size()];
+	packet.ofs = ofs;
+	packet.size = p_size;
+	packet.ip = p_ip;
+	packet.port = p_port;
+	++queue_count;
+
+	copymem(queue_data.ptrw() + ofs, p_data, p_size);
+	data_write = ofs + p_size;
+	return true;
+}
+
 Error PacketPeerUDP::get_packet(const uint8_t **r_buffer, int &r_buffer_size) {
 
 	Error err = _poll();
@@ -75,16 +166,32 @@ Error PacketPeerUDP::get_packet(const uint8_t **r_buffer, int &r_buffer_size) {
 	if (queue_count == 0)
 		return ERR_UNAVAILABLE;
 
-	uint32_t size = 0;
-	uint8_t ipv6[16];
-	rb.read(ipv6, 16, true);
-	packet_ip.set_ipv6(ipv6);
-	rb.read((uint8_t *)&packet_port, 4, true);
-	rb.read((uint8_t *)&size, 4, true);
-	rb.read(packet_buffer, size, true);
+	_release_packet();
+
+	const Packet &packet = queue[queue_front];
+	packet_ip = packet.ip;
+	packet_port = packet.port;
+	*r_buffer = queue_data.ptr() + packet.ofs;
+	r_buffer_size = packet.size;
+
+	// Stays where it is until the next call, data_read already points to it.
+	packet_reserved = true;
+	queue_front = (queue_front + 1) % queue.size();
 	--queue_count;
-	*r_buffer = packet_buffer;
-	r_buffer_size = size;
+	return OK;
+}
+
+Error PacketPeerUDP::_open_socket(IP::Type p_ip_type) {
+
+	Error err = _sock->open(NetSocket::TYPE_UDP, p_ip_type);
+	if (err != OK)
+		return err;
+
+	_sock->set_blocking_enabled(false);
+	if (socket_recv_buffer_size > 0)
+		_sock->set_recv_buffer_size(socket_recv_buffer_size);
+	if (socket_send_buffer_size > 0)
+		_sock->set_send_buffer_size(socket_send_buffer_size);
 	return OK;
 }
 
@@ -97,10 +204,30 @@ Error PacketPeerUDP::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 	int sent = -1;
 
 	if (!_sock->is_open()) {
-		IP::Type ip_type = peer_addr.is_ipv4() ? IP::TYPE_IPV4 : IP::TYPE_IPV6;
-		err = _sock->open(NetSocket::TYPE_UDP, ip_type);
+		err = _open_socket(peer_addr.is_ipv4() ? IP::TYPE_IPV4 : IP::TYPE_IPV6);
 		ERR_FAIL_COND_V(err != OK, err);
-		_sock->set_blocking_enabled(false);
+	}
+
+	if (send_batching) {
+
+		if (send_count == SEND_BATCH_SIZE) {
+			err = flush();
+			if (err != OK)
+				return err;
+		}
+
+		if (send_data.size() < send_data_size + p_buffer_size)
+			send_data.resize(next_power_of_2(send_data_size + p_buffer_size));
+
+		Packet &packet = send_queue.write[send_count++];
+		packet.ofs = send_data_size;
+		packet.size = p_buffer_size;
+		packet.ip = peer_addr;
+		packet.port = peer_port;
+
+		copymem(send_data.ptrw() + send_data_size, p_buffer, p_buffer_size);
+		send_data_size += p_buffer_size;
+		return OK;
 	}
 
 	do {
@@ -120,6 +247,101 @@ Error PacketPeerUDP::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 	return OK;
 }
 
+Error PacketPeerUDP::flush() {
+
+	ERR_FAIL_COND_V(!_sock.is_valid(), ERR_UNAVAILABLE);
+
+	if (send_count == 0)
+		return OK;
+
+	ERR_FAIL_COND_V(!_sock->is_open(), ERR_UNCONFIGURED);
+
+	for (int i = 0; i < send_count; i++) {
+		NetSocket::Datagram &d = send_datagrams.write[i];
+		d.buffer = send_data.ptrw() + send_queue[i].ofs;
+		d.size = send_queue[i].size;
+		d.ip = send_queue[i].ip;
+		d.port = send_queue[i].port;
+	}
+
+	int done = 0;
+	Error err = OK;
+
+	while (done < send_count) {
+
+		int sent;
+		err = _sock->sendto_batch(send_datagrams.ptr() + done, send_count - done, sent);
+		if (err == OK) {
+			done += sent;
+			continue;
+		}
+
+		if (err != ERR_BUSY) {
+			// Like a failed sendto(), the packets are gone.
+			done = send_count;
+			err = FAILED;
+			break;
+		}
+
+		if (!blocking)
+			break;
+
+		_sock->poll(NetSocket::POLL_TYPE_OUT, -1);
+	}
+
+	if (done == send_count) {
+		send_count = 0;
+		send_data_size = 0;
+		return err;
+	}
+
+	// Keep the rest for the next flush, their data stays where it is.
+	for (int i = done; i < send_count; i++) {
+		send_queue.write[i - done] = send_queue[i];
+	}
+	send_count -= done;
+	return ERR_BUSY;
+}
+
+void PacketPeerUDP::set_send_batching(bool p_enable) {
+
+	if (send_batching && !p_enable)
+		flush();
+
+	send_batching = p_enable;
+}
+
+bool PacketPeerUDP::is_send_batching() const {
+
+	return send_batching;
+}
+
+void PacketPeerUDP::set_socket_recv_buffer_size(int p_bytes) {
+
+	ERR_FAIL_COND(p_bytes < 0);
+	socket_recv_buffer_size = p_bytes;
+	if (p_bytes > 0 && _sock.is_valid() && _sock->is_open())
+		_sock->set_recv_buffer_size(p_bytes);
+}
+
+int PacketPeerUDP::get_socket_recv_buffer_size() const {
+
+	return socket_recv_buffer_size;
+}
+
+void PacketPeerUDP::set_socket_send_buffer_size(int p_bytes) {
+
+	ERR_FAIL_COND(p_bytes < 0);
+	socket_send_buffer_size = p_bytes;
+	if (p_bytes > 0 && _sock.is_valid() && _sock->is_open())
+		_sock->set_send_buffer_size(p_bytes);
+}
+
+int PacketPeerUDP::get_socket_send_buffer_size() const {
+
+	return socket_send_buffer_size;
+}
+
 int PacketPeerUDP::get_max_packet_size() const {
 
 	return 512; // uhm maybe not
@@ -137,12 +359,11 @@ Error PacketPeerUDP::listen(int p_port, const IP_Address &p_bind_address, int p_
 	if (p_bind_address.is_valid())
 		ip_type = p_bind_address.is_ipv4() ? IP::TYPE_IPV4 : IP::TYPE_IPV6;
 
-	err = _sock->open(NetSocket::TYPE_UDP, ip_type);
+	err = _open_socket(ip_type);
 
 	if (err != OK)
 		return ERR_CANT_CREATE;
 
-	_sock->set_blocking_enabled(false);
 	_sock->set_reuse_address_enabled(true);
 	err = _sock->bind(p_bind_address, p_port);
 
@@ -150,16 +371,27 @@ Error PacketPeerUDP::listen(int p_port, const IP_Address &p_bind_address, int p_
 		_sock->close();
 		return err;
 	}
-	rb.resize(nearest_shift(p_recv_buffer_size));
+	queue_data.resize(1 << nearest_shift(p_recv_buffer_size));
 	return OK;
 }
 
 void PacketPeerUDP::close() {
 
-	if (_sock.is_valid())
+	if (_sock.is_valid()) {
+		if (_sock->is_open())
+			flush();
 		_sock->close();
-	rb.resize(16);
+	}
+
+	queue_data.resize(1 << 16);
+	queue_front = 0;
 	queue_count = 0;
+	data_read = 0;
+	data_write = 0;
+	data_wrapped = false;
+	packet_reserved = false;
+	send_count = 0;
+	send_data_size = 0;
 }
 
 Error PacketPeerUDP::wait() {
@@ -176,13 +408,20 @@ Error PacketPeerUDP::_poll() {
 		return FAILED;
 	}
 
-	Error err;
-	int read;
-	IP_Address ip;
-	uint16_t port;
+	MutexLock lock(recv_batch_mutex);
+
+	if (!recv_batch) {
+		recv_batch = (uint8_t *)memalloc(RECV_BATCH_SIZE * PACKET_BUFFER_SIZE);
+		for (int i = 0; i < RECV_BATCH_SIZE; i++) {
+			recv_datagrams[i].buffer = recv_batch + i * PACKET_BUFFER_SIZE;
+			recv_datagrams[i].buffer_size = PACKET_BUFFER_SIZE;
+		}
+	}
 
 	while (true) {
-		err = _sock->recvfrom(recv_buffer, sizeof(recv_buffer), read, ip, port);
+
+		int received;
+		Error err = _sock->recvfrom_batch(recv_datagrams, RECV_BATCH_SIZE, received);
 
 		if (err != OK) {
 			if (err == ERR_BUSY)
@@ -190,23 +429,23 @@ Error PacketPeerUDP::_poll() {
 			return FAILED;
 		}
 
-		if (rb.space_left() < read + 24) {
+		for (int i = 0; i < received; i++) {
+
+			const NetSocket::Datagram &d = recv_datagrams[i];
+			if (!_queue_packet(d.buffer, MIN(d.size, d.buffer_size), d.ip, d.port)) {
 #ifdef TOOLS_ENABLED
-			WARN_PRINTS("Buffer full, dropping packets!");
+				WARN_PRINTS("Buffer full, dropping packets!");
 #endif
-			continue;
+			}
 		}
 
-		uint32_t port32 = port;
-		rb.write(ip.get_ipv6(), 16);
-		rb.write((uint8_t *)&port32, 4);
-		rb.write((uint8_t *)&read, 4);
-		rb.write(recv_buffer, read);
-		++queue_count;
+		if (received < RECV_BATCH_SIZE)
+			break;
 	}
 
 	return OK;
 }
+
 bool PacketPeerUDP::is_listening() const {
 
 	return _sock.is_valid() && _sock->is_open();
@@ -237,15 +476,34 @@ void PacketPeerUDP::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_packet_ip"), &PacketPeerUDP::_get_packet_ip);
 	ClassDB::bind_method(D_METHOD("get_packet_port"), &PacketPeerUDP::get_packet_port);
 	ClassDB::bind_method(D_METHOD("set_dest_address", "host", "port"), &PacketPeerUDP::_set_dest_address);
+	ClassDB::bind_method(D_METHOD("set_send_batching", "enable"), &PacketPeerUDP::set_send_batching);
+	ClassDB::bind_method(D_METHOD("is_send_batching"), &PacketPeerUDP::is_send_batching);
+	ClassDB::bind_method(D_METHOD("flush"), &PacketPeerUDP::flush);
+	ClassDB::bind_method(D_METHOD("set_socket_recv_buffer_size", "bytes"), &PacketPeerUDP::set_socket_recv_buffer_size);
+	ClassDB::bind_method(D_METHOD("get_socket_recv_buffer_size"), &PacketPeerUDP::get_socket_recv_buffer_size);
+	ClassDB::bind_method(D_METHOD("set_socket_send_buffer_size", "bytes"), &PacketPeerUDP::set_socket_send_buffer_size);
+	ClassDB::bind_method(D_METHOD("get_socket_send_buffer_size"), &PacketPeerUDP::get_socket_send_buffer_size);
 }
 
 PacketPeerUDP::PacketPeerUDP() :
-		packet_port(0),
+		queue_front(0),
 		queue_count(0),
+		data_read(0),
+		data_write(0),
+		data_wrapped(false),
+		packet_reserved(false),
+		packet_port(0),
+		send_batching(false),
+		send_data_size(0),
+		send_count(0),
+		socket_recv_buffer_size(0),
+		socket_send_buffer_size(0),
 		peer_port(0),
 		blocking(true),
 		_sock(Ref<NetSocket>(NetSocket::create())) {
-	rb.resize(16);
+	queue_data.resize(1 << 16);
+	send_queue.resize(SEND_BATCH_SIZE);
+	send_datagrams.resize(SEND_BATCH_SIZE);
 }
 
 PacketPeerUDP::~PacketPeerUDP() {
@@ -34,21 +34,54 @@
 #include "core/io/ip.h"
 #include "core/io/net_socket.h"
 #include "core/io/packet_peer.h"
+#include "core/os/mutex.h"
 
 class PacketPeerUDP : public PacketPeer {
 	GDCLASS(PacketPeerUDP, PacketPeer);
 
 protected:
 	enum {
-		PACKET_BUFFER_SIZE = 65536
+		PACKET_BUFFER_SIZE = 65536,
+		RECV_BATCH_SIZE = 8,
+		SEND_BATCH_SIZE = 64
 	};
 
-	RingBuffer<uint8_t> rb;
-	uint8_t recv_buffer[PACKET_BUFFER_SIZE];
-	uint8_t packet_buffer[PACKET_BUFFER_SIZE];
+	struct Packet {
+		int ofs;
+		int size;
+		IP_Address ip;
+		uint16_t port;
+	};
+
+	// Received packets are kept whole in a byte ring, get_packet() returns
+	// a pointer into it. The last returned one stays reserved until the
+	// next get_packet() call.
+	Vector<uint8_t> queue_data;
+	Vector<Packet> queue;
+	int queue_front;
+	int queue_count;
+	int data_read;
+	int data_write;
+	bool data_wrapped;
+	bool packet_reserved;
 	IP_Address packet_ip;
 	int packet_port;
-	int queue_count;
+
+	// The receive batch is shared by every peer, as it takes RECV_BATCH_SIZE
+	// full size datagrams. It is allocated on the first poll.
+	static uint8_t *recv_batch;
+	static NetSocket::Datagram recv_datagrams[RECV_BATCH_SIZE];
+	static Mutex *recv_batch_mutex;
+
+	bool send_batching;
+	Vector<uint8_t> send_data;
+	int send_data_size;
+	Vector<Packet> send_queue;
+	int send_count;
+	Vector<NetSocket::Datagram> send_datagrams;
+
+	int socket_recv_buffer_size;
+	int socket_send_buffer_size;
 
 	IP_Address peer_addr;
 	int peer_port;
@@ -61,8 +94,14 @@ protected:
 
 	Error _set_dest_address(const String &p_address, int p_port);
 	Error _poll();
+	Error _open_socket(IP::Type p_ip_type);
+	bool _queue_packet(const uint8_t *p_data, int p_size, const IP_Address &p_ip, uint16_t p_port);
+	void _release_packet();
 
 public:
+	static void setup_recv_batch();
+	static void finish_recv_batch();
+
 	void set_blocking_mode(bool p_enable);
 
 	Error listen(int p_port, const IP_Address &p_bind_address = IP_Address("*"), int p_recv_buffer_size = 65536);
@@ -73,6 +112,15 @@ public:
 	int get_packet_port() const;
 	void set_dest_address(const IP_Address &p_address, int p_port);
 
+	void set_send_batching(bool p_enable);
+	bool is_send_batching() const;
+	Error flush();
+
+	void set_socket_recv_buffer_size(int p_bytes);
+	int get_socket_recv_buffer_size() const;
+	void set_socket_send_buffer_size(int p_bytes);
+	int get_socket_send_buffer_size() const;
+
 	Error put_packet(const uint8_t *p_buffer, int p_buffer_size);
 	Error get_packet(const uint8_t **r_buffer, int &r_buffer_size);
 	int get_available_packet_count() const;
@@ -49,11 +49,19 @@ Error StreamPeerTCP::_poll_connection() {
 	return ERR_CONNECTION_ERROR;
 }
 
+bool StreamPeerTCP::_is_idle() const {
+
+	return status == STATUS_CONNECTED && _sock->is_watched() && !(_sock->get_ready_events() & (NetSocketPoller::EVENT_IN | NetSocketPoller::EVENT_ERROR));
+}
+
 void StreamPeerTCP::accept_socket(Ref<NetSocket> p_sock, IP_Address p_host, uint16_t p_port) {
 
 	_sock = p_sock;
 	_sock->set_blocking_enabled(false);
 
+	if (poller.is_valid())
+		poller->add(_sock.ptr());
+
 	status = STATUS_CONNECTING;
 
 	peer_host = p_host;
@@ -74,6 +82,9 @@ Error StreamPeerTCP::connect_to_host(const IP_Address &p_host, uint16_t p_port)
 
 	_sock->set_blocking_enabled(false);
 
+	if (poller.is_valid())
+		poller->add(_sock.ptr());
+
 	err = _sock->connect_to_host(p_host, p_port);
 
 	if (err == OK) {
@@ -183,6 +194,9 @@ Error StreamPeerTCP::read(uint8_t *p_buffer, int p_bytes, int &r_received, bool
 	int total_read = 0;
 	r_received = 0;
 
+	if (!p_block && _is_idle())
+		return OK;
+
 	while (to_read) {
 
 		int read = 0;
@@ -196,6 +210,8 @@ Error StreamPeerTCP::read(uint8_t *p_buffer, int p_bytes, int &r_received, bool
 			}
 
 			if (!p_block) {
+				if (_sock->is_watched())
+					_sock->clear_ready_events(NetSocketPoller::EVENT_IN);
 				r_received = total_read;
 				return OK;
 			}
@@ -250,6 +266,9 @@ StreamPeerTCP::Status StreamPeerTCP::get_status() {
 	if (status == STATUS_CONNECTING) {
 		_poll_connection();
 	} else if (status == STATUS_CONNECTED) {
+		if (_is_idle())
+			return status;
+
 		Error err;
 		err = _sock->poll(NetSocket::POLL_TYPE_IN, 0);
 		if (err == OK) {
@@ -258,6 +277,8 @@ StreamPeerTCP::Status StreamPeerTCP::get_status() {
 				disconnect_from_host();
 				return status;
 			}
+		} else if (_sock->is_watched()) {
+			_sock->clear_ready_events(NetSocketPoller::EVENT_IN);
 		}
 		// Also poll write
 		err = _sock->poll(NetSocket::POLL_TYPE_IN_OUT, 0);
@@ -306,9 +327,30 @@ Error StreamPeerTCP::get_partial_data(uint8_t *p_buffer, int p_bytes, int &r_rec
 int StreamPeerTCP::get_available_bytes() const {
 
 	ERR_FAIL_COND_V(!_sock.is_valid(), -1);
+	if (_is_idle())
+		return 0;
 	return _sock->get_available_bytes();
 }
 
+void StreamPeerTCP::set_poller(const Ref<NetSocketPoller> &p_poller) {
+
+	if (poller == p_poller)
+		return;
+
+	if (_sock.is_valid() && _sock->is_watched())
+		poller->remove(_sock.ptr());
+
+	poller = p_poller;
+
+	if (poller.is_valid() && _sock.is_valid() && _sock->is_open())
+		poller->add(_sock.ptr());
+}
+
+Ref<NetSocketPoller> StreamPeerTCP::get_poller() const {
+
+	return poller;
+}
+
 IP_Address StreamPeerTCP::get_connected_host() const {
 
 	return peer_host;
@@ -52,12 +52,14 @@ public:
 
 protected:
 	Ref<NetSocket> _sock;
+	Ref<NetSocketPoller> poller;
 	Status status;
 	IP_Address peer_host;
 	uint16_t peer_port;
 
 	Error _connect(const String &p_address, int p_port);
 	Error _poll_connection();
+	_FORCE_INLINE_ bool _is_idle() const;
 	Error write(const uint8_t *p_data, int p_bytes, int &r_sent, bool p_block);
 	Error read(uint8_t *p_buffer, int p_bytes, int &r_received, bool p_block);
 
@@ -77,6 +79,11 @@ public:
 
 	void set_no_delay(bool p_enabled);
 
+	// Once watched, reads and status checks skip their syscalls while the
+	// last wait of p_poller saw nothing on this connection.
+	void set_poller(const Ref<NetSocketPoller> &p_poller);
+	Ref<NetSocketPoller> get_poller() const;
+
 	// Read/Write from StreamPeer
 	Error put_data(const uint8_t *p_data, int p_bytes);
 	Error put_partial_data(const uint8_t *p_data, int p_bytes, int &r_sent);
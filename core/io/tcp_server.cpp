@@ -72,6 +72,10 @@ Error TCP_Server::listen(uint16_t p_port, const IP_Address &p_bind_address) {
 		_sock->close();
 		return FAILED;
 	}
+
+	if (poller.is_valid())
+		poller->add(_sock.ptr());
+
 	return OK;
 }
 
@@ -82,8 +86,14 @@ bool TCP_Server::is_connection_available() const {
 	if (!_sock->is_open())
 		return false;
 
+	// Nothing came in since the last wait of the poller.
+	if (_sock->is_watched() && !(_sock->get_ready_events() & (NetSocketPoller::EVENT_IN | NetSocketPoller::EVENT_ERROR)))
+		return false;
+
 	Error err = _sock->poll(NetSocket::POLL_TYPE_IN, 0);
 	if (err != OK) {
+		if (_sock->is_watched())
+			_sock->clear_ready_events(NetSocketPoller::EVENT_IN | NetSocketPoller::EVENT_ERROR);
 		return false;
 	}
 
@@ -105,10 +115,30 @@ Ref<StreamPeerTCP> TCP_Server::take_connection() {
 		return conn;
 
 	conn = Ref<StreamPeerTCP>(memnew(StreamPeerTCP));
+	conn->set_poller(poller);
 	conn->accept_socket(ns, ip, port);
 	return conn;
 }
 
+void TCP_Server::set_poller(const Ref<NetSocketPoller> &p_poller) {
+
+	if (poller == p_poller)
+		return;
+
+	if (_sock.is_valid() && _sock->is_watched())
+		poller->remove(_sock.ptr());
+
+	poller = p_poller;
+
+	if (poller.is_valid() && _sock.is_valid() && _sock->is_open())
+		poller->add(_sock.ptr());
+}
+
+Ref<NetSocketPoller> TCP_Server::get_poller() const {
+
+	return poller;
+}
+
 void TCP_Server::stop() {
 
 	if (_sock.is_valid()) {
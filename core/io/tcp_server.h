@@ -46,6 +46,7 @@ protected:
 	};
 
 	Ref<NetSocket> _sock;
+	Ref<NetSocketPoller> poller;
 	static void _bind_methods();
 
 public:
@@ -53,6 +54,10 @@ public:
 	bool is_connection_available() const;
 	Ref<StreamPeerTCP> take_connection();
 
+	// The listening socket and the connections it hands out get watched by p_poller.
+	void set_poller(const Ref<NetSocketPoller> &p_poller);
+	Ref<NetSocketPoller> get_poller() const;
+
 	void stop(); // Stop listening
 
 	TCP_Server();
@@ -0,0 +1,1202 @@
+/*************************************************************************/
+/*  bvh.h                                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "core/math/aabb.h"
+#include "core/math/plane.h"
+#include "core/math/vector3.h"
+#include "core/sort_array.h"
+#include "core/vector.h"
+
+/**
+	Dynamic bounding volume hierarchy, meant as a drop-in alternative to Octree
+	for scenes where many elements move every frame.
+
+	- Elements are kept in separate trees. New elements go to a static tree
+	  with tight bounds, and are moved to a dynamic tree the first time they
+	  move. Leaves in the dynamic tree use enlarged (fat) bounds, so small
+	  movements don't need to touch the tree at all.
+	- Pairable elements (ie. lights) are kept in their own small tree, so
+	  non pairable elements only have to search that one for new pairs.
+	- Trees are kept balanced with rotations on insertion and removal.
+	- Every node caches the union of the types and masks of its subtree, so
+	  culling by type mask and pair searches skip whole subtrees. A moving
+	  element that can't pair with anything (ie. geometry in a scene without
+	  lights) does not descend the tree at all.
+	- Unlike Octree, only pairs that actually intersect are stored.
+*/
+
+typedef uint32_t BVHElementID;
+
+#define BVH_ELEMENT_INVALID_ID 0
+
+template <class T, bool use_pairs = false>
+class BVH {
+public:
+	typedef void *(*PairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int);
+	typedef void (*UnpairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int, void *);
+
+private:
+	enum {
+		TREE_STATIC,
+		TREE_DYNAMIC,
+		TREE_PAIRABLE,
+		TREE_MAX,
+	};
+
+	enum {
+		NODE_NULL = -1,
+		STACK_SIZE = 256,
+		DISPLACEMENT_MULTIPLIER = 4,
+		MAX_PLANE_MASK_COUNT = 32,
+	};
+
+	struct Node {
+
+		AABB aabb;
+		int parent; // also next free node, when in the free list
+		int children[2];
+		int element; // only for leaves
+		int height;
+
+		// unions for the whole subtree
+		uint32_t types;
+		uint32_t masks;
+		uint32_t pairable_types;
+		uint32_t pairable_masks;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == NODE_NULL; }
+
+		Node() {
+			parent = NODE_NULL;
+			children[0] = NODE_NULL;
+			children[1] = NODE_NULL;
+			element = NODE_NULL;
+			height = 0;
+			types = 0;
+			masks = 0;
+			pairable_types = 0;
+			pairable_masks = 0;
+		}
+	};
+
+	struct PairLink {
+
+		BVHElementID other;
+		void *ud;
+	};
+
+	struct Element {
+
+		T *userdata;
+		int subindex;
+		bool pairable;
+		uint32_t pairable_type;
+		uint32_t pairable_mask;
+
+		AABB aabb;
+		int tree;
+		int leaf; // NODE_NULL if not inside a tree (no surface)
+		bool used;
+
+		Vector<PairLink> pairs; // sorted by other element
+
+		Element() {
+			userdata = NULL;
+			subindex = 0;
+			pairable = false;
+			pairable_type = 0;
+			pairable_mask = 0;
+			tree = TREE_STATIC;
+			leaf = NODE_NULL;
+			used = false;
+		}
+	};
+
+	Vector<Node> nodes;
+	int node_free;
+	int roots[TREE_MAX];
+
+	Vector<Element> elements; // element ID is index + 1
+	Vector<BVHElementID> element_free;
+
+	PairCallback pair_callback;
+	UnpairCallback unpair_callback;
+	void *pair_callback_userdata;
+	void *unpair_callback_userdata;
+
+	int pair_count;
+	real_t dynamic_margin;
+
+	// scratch buffers for pair updates, only grow
+	Vector<BVHElementID> pair_query;
+	int pair_query_count;
+	Vector<BVHElementID> pair_changes;
+	int pair_changes_count;
+
+	_FORCE_INLINE_ static void _push_id(Vector<BVHElementID> &r_buffer, int &r_count, BVHElementID p_id) {
+		if (r_count == r_buffer.size()) {
+			r_buffer.resize(MAX(16, r_count * 2));
+		}
+		r_buffer.write[r_count++] = p_id;
+	}
+
+	_FORCE_INLINE_ static real_t _cost(const AABB &p_aabb) {
+		// half surface area
+		return p_aabb.size.x * p_aabb.size.y + p_aabb.size.y * p_aabb.size.z + p_aabb.size.z * p_aabb.size.x;
+	}
+
+	_FORCE_INLINE_ Element &_get_element(BVHElementID p_id) {
+		return elements.write[p_id - 1];
+	}
+
+	_FORCE_INLINE_ const Element &_get_element(BVHElementID p_id) const {
+		return elements[p_id - 1];
+	}
+
+	_FORCE_INLINE_ bool _is_valid_id(BVHElementID p_id) const {
+		return p_id != BVH_ELEMENT_INVALID_ID && int(p_id) <= elements.size() && elements[p_id - 1].used;
+	}
+
+	int _node_alloc();
+	void _node_free(int p_node);
+
+	void _node_update(Node *p_nodes, int p_node);
+	int _balance(int p_tree, int p_node);
+	void _refit_upwards(int p_tree, int p_node);
+
+	void _insert_leaf(int p_tree, int p_leaf);
+	void _remove_leaf(int p_tree, int p_leaf);
+
+	void _element_insert(BVHElementID p_id, int p_tree, const Vector3 &p_displacement = Vector3());
+	void _element_remove(BVHElementID p_id);
+
+	_FORCE_INLINE_ static bool _can_pair(bool p_pairable, uint32_t p_type, uint32_t p_mask, const Node &p_node) {
+
+		if (p_pairable) {
+			return (p_node.types & p_mask) || (p_type & p_node.masks);
+		} else {
+			return (p_node.pairable_types & p_mask) || (p_type & p_node.pairable_masks);
+		}
+	}
+
+	_FORCE_INLINE_ static bool _can_pair(const Element &p_a, const Element &p_b) {
+
+		if (!p_a.pairable && !p_b.pairable) {
+			return false;
+		}
+		return (p_a.pairable_type & p_b.pairable_mask) || (p_b.pairable_type & p_a.pairable_mask);
+	}
+
+	void _pair(BVHElementID p_a, BVHElementID p_b);
+	void _unpair(BVHElementID p_a, BVHElementID p_b);
+	void _update_pairs(BVHElementID p_id);
+
+	_FORCE_INLINE_ static int _find_pair(const Vector<PairLink> &p_pairs, BVHElementID p_other);
+
+	// returns false if fully outside, clears from r_mask the planes that p_aabb is fully inside of
+	_FORCE_INLINE_ static bool _cull_planes(const AABB &p_aabb, const Plane *p_planes, int p_plane_count, uint32_t &r_mask);
+
+	struct _CullConvexData {
+
+		const Plane *planes;
+		int plane_count;
+		T **result_array;
+		int result_idx;
+		int result_max;
+		uint32_t mask;
+	};
+
+	void _cull_convex(int p_tree, _CullConvexData &p_cull);
+	void _cull_convex_add_subtree(int p_node, _CullConvexData &p_cull);
+
+	enum CullType {
+		CULL_AABB,
+		CULL_SEGMENT,
+		CULL_POINT,
+	};
+
+	struct _CullData {
+
+		CullType type;
+		AABB aabb;
+		Vector3 from;
+		Vector3 to;
+		T **result_array;
+		int *subindex_array;
+		int result_idx;
+		int result_max;
+		uint32_t mask;
+
+		_FORCE_INLINE_ bool test(const AABB &p_aabb) const {
+			switch (type) {
+				case CULL_AABB: return p_aabb.intersects_inclusive(aabb);
+				case CULL_SEGMENT: return p_aabb.intersects_segment(from, to);
+				case CULL_POINT: return p_aabb.has_point(from);
+			}
+			return false;
+		}
+	};
+
+	void _cull(int p_tree, _CullData &p_cull);
+
+public:
+	BVHElementID create(T *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
+	void move(BVHElementID p_id, const AABB &p_aabb);
+	void set_pairable(BVHElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
+	void erase(BVHElementID p_id);
+
+	bool is_pairable(BVHElementID p_id) const;
+	T *get(BVHElementID p_id) const;
+	int get_subindex(BVHElementID p_id) const;
+
+	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata);
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+
+	// how much leaves of moving elements are enlarged, relative to their size
+	void set_dynamic_margin(real_t p_margin) { dynamic_margin = p_margin; }
+	real_t get_dynamic_margin() const { return dynamic_margin; }
+
+	int get_pair_count() const { return pair_count; }
+	int get_node_count() const { return nodes.size(); }
+	int get_height() const;
+
+	BVH();
+	~BVH();
+};
+
+/* NODES */
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::_node_alloc() {
+
+	if (node_free != NODE_NULL) {
+		int n = node_free;
+		node_free = nodes[n].parent;
+		nodes.write[n] = Node();
+		return n;
+	}
+
+	nodes.push_back(Node());
+	return nodes.size() - 1;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_node_free(int p_node) {
+
+	Node &n = nodes.write[p_node];
+	n.element = NODE_NULL;
+	n.children[0] = NODE_NULL;
+	n.children[1] = NODE_NULL;
+	n.parent = node_free;
+	node_free = p_node;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_node_update(Node *p_nodes, int p_node) {
+
+	Node &n = p_nodes[p_node];
+	const Node &a = p_nodes[n.children[0]];
+	const Node &b = p_nodes[n.children[1]];
+
+	n.aabb = a.aabb.merge(b.aabb);
+	n.height = 1 + MAX(a.height, b.height);
+	n.types = a.types | b.types;
+	n.masks = a.masks | b.masks;
+	n.pairable_types = a.pairable_types | b.pairable_types;
+	n.pairable_masks = a.pairable_masks | b.pairable_masks;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::_balance(int p_tree, int p_node) {
+
+	// AVL style rotation, returns the new root of the subtree
+
+	Node *n = nodes.ptrw();
+	int ia = p_node;
+	Node &a = n[ia];
+
+	if (a.is_leaf() || a.height < 2) {
+		return ia;
+	}
+
+	int ib = a.children[0];
+	int ic = a.children[1];
+	int balance = n[ic].height - n[ib].height;
+
+	if (balance > 1) {
+		// rotate C up
+		Node &c = n[ic];
+		int f = c.children[0];
+		int g = c.children[1];
+
+		c.children[0] = ia;
+		c.parent = a.parent;
+		a.parent = ic;
+
+		if (c.parent != NODE_NULL) {
+			Node &p = n[c.parent];
+			p.children[p.children[0] == ia ? 0 : 1] = ic;
+		} else {
+			roots[p_tree] = ic;
+		}
+
+		if (n[f].height > n[g].height) {
+			c.children[1] = f;
+			a.children[1] = g;
+			n[g].parent = ia;
+		} else {
+			c.children[1] = g;
+			a.children[1] = f;
+			n[f].parent = ia;
+		}
+
+		_node_update(n, ia);
+		_node_update(n, ic);
+		return ic;
+	}
+
+	if (balance < -1) {
+		// rotate B up
+		Node &b = n[ib];
+		int d = b.children[0];
+		int e = b.children[1];
+
+		b.children[0] = ia;
+		b.parent = a.parent;
+		a.parent = ib;
+
+		if (b.parent != NODE_NULL) {
+			Node &p = n[b.parent];
+			p.children[p.children[0] == ia ? 0 : 1] = ib;
+		} else {
+			roots[p_tree] = ib;
+		}
+
+		if (n[d].height > n[e].height) {
+			b.children[1] = d;
+			a.children[0] = e;
+			n[e].parent = ia;
+		} else {
+			b.children[1] = e;
+			a.children[0] = d;
+			n[d].parent = ia;
+		}
+
+		_node_update(n, ia);
+		_node_update(n, ib);
+		return ib;
+	}
+
+	return ia;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_refit_upwards(int p_tree, int p_node) {
+
+	int index = p_node;
+	while (index != NODE_NULL) {
+
+		index = _balance(p_tree, index);
+		Node *n = nodes.ptrw();
+		_node_update(n, index);
+		index = n[index].parent;
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_insert_leaf(int p_tree, int p_leaf) {
+
+	if (roots[p_tree] == NODE_NULL) {
+		roots[p_tree] = p_leaf;
+		nodes.write[p_leaf].parent = NODE_NULL;
+		return;
+	}
+
+	// find the best sibling, using the surface area heuristic
+	int sibling;
+	{
+		const Node *n = nodes.ptr();
+		const AABB &leaf_aabb = n[p_leaf].aabb;
+
+		sibling = roots[p_tree];
+		while (!n[sibling].is_leaf()) {
+
+			const Node &node = n[sibling];
+			real_t area = _cost(node.aabb);
+			real_t combined_area = _cost(node.aabb.merge(leaf_aabb));
+
+			// cost of creating a new parent for this node and the new leaf
+			real_t cost = 2.0 * combined_area;
+			// minimum cost of pushing the leaf further down the tree
+			real_t inheritance_cost = 2.0 * (combined_area - area);
+
+			real_t child_cost[2];
+			for (int i = 0; i < 2; i++) {
+				const Node &child = n[node.children[i]];
+				child_cost[i] = _cost(child.aabb.merge(leaf_aabb)) + inheritance_cost;
+				if (!child.is_leaf()) {
+					child_cost[i] -= _cost(child.aabb);
+				}
+			}
+
+			if (cost < child_cost[0] && cost < child_cost[1]) {
+				break;
+			}
+
+			sibling = child_cost[0] < child_cost[1] ? node.children[0] : node.children[1];
+		}
+	}
+
+	int new_parent = _node_alloc();
+
+	Node *n = nodes.ptrw();
+	int old_parent = n[sibling].parent;
+
+	n[new_parent].parent = old_parent;
+	n[new_parent].children[0] = sibling;
+	n[new_parent].children[1] = p_leaf;
+	n[sibling].parent = new_parent;
+	n[p_leaf].parent = new_parent;
+
+	if (old_parent != NODE_NULL) {
+		Node &p = n[old_parent];
+		p.children[p.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		roots[p_tree] = new_parent;
+	}
+
+	_refit_upwards(p_tree, new_parent);
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_remove_leaf(int p_tree, int p_leaf) {
+
+	if (roots[p_tree] == p_leaf) {
+		roots[p_tree] = NODE_NULL;
+		return;
+	}
+
+	Node *n = nodes.ptrw();
+	int parent = n[p_leaf].parent;
+	int grand_parent = n[parent].parent;
+	int sibling = n[parent].children[0] == p_leaf ? n[parent].children[1] : n[parent].children[0];
+
+	_node_free(parent);
+	n = nodes.ptrw();
+
+	if (grand_parent != NODE_NULL) {
+		Node &g = n[grand_parent];
+		g.children[g.children[0] == parent ? 0 : 1] = sibling;
+		n[sibling].parent = grand_parent;
+		_refit_upwards(p_tree, grand_parent);
+	} else {
+		roots[p_tree] = sibling;
+		n[sibling].parent = NODE_NULL;
+	}
+}
+
+/* ELEMENTS */
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_element_insert(BVHElementID p_id, int p_tree, const Vector3 &p_displacement) {
+
+	int leaf = _node_alloc();
+
+	Element &e = _get_element(p_id);
+	Node &n = nodes.write[leaf];
+
+	if (e.pairable) {
+		p_tree = TREE_PAIRABLE;
+	} else if (p_tree == TREE_PAIRABLE) {
+		p_tree = TREE_STATIC;
+	}
+
+	n.element = p_id - 1;
+	n.aabb = e.aabb;
+	if (p_tree != TREE_STATIC) {
+		n.aabb.grow_by(e.aabb.get_longest_axis_size() * dynamic_margin);
+
+		// also extend in the direction it's moving, so steady movement does not
+		// need reinserting every frame (but don't grow much on teleports)
+		real_t max_ext = e.aabb.get_longest_axis_size() * DISPLACEMENT_MULTIPLIER;
+		Vector3 ext = p_displacement * DISPLACEMENT_MULTIPLIER;
+		for (int i = 0; i < 3; i++) {
+			ext[i] = CLAMP(ext[i], -max_ext, max_ext);
+			if (ext[i] < 0) {
+				n.aabb.position[i] += ext[i];
+				n.aabb.size[i] -= ext[i];
+			} else {
+				n.aabb.size[i] += ext[i];
+			}
+		}
+	}
+	n.types = e.pairable_type;
+	n.masks = e.pairable_mask;
+	n.pairable_types = e.pairable ? e.pairable_type : 0;
+	n.pairable_masks = e.pairable ? e.pairable_mask : 0;
+
+	e.tree = p_tree;
+	e.leaf = leaf;
+
+	_insert_leaf(p_tree, leaf);
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_element_remove(BVHElementID p_id) {
+
+	Element &e = _get_element(p_id);
+	ERR_FAIL_COND(e.leaf == NODE_NULL);
+
+	_remove_leaf(e.tree, e.leaf);
+	_node_free(e.leaf);
+	e.leaf = NODE_NULL;
+}
+
+/* PAIRING */
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::_find_pair(const Vector<PairLink> &p_pairs, BVHElementID p_other) {
+
+	int low = 0;
+	int high = p_pairs.size() - 1;
+	const PairLink *links = p_pairs.ptr();
+
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		if (p_other < links[middle].other) {
+			high = middle - 1;
+		} else if (links[middle].other < p_other) {
+			low = middle + 1;
+		} else {
+			return middle;
+		}
+	}
+
+	return -(low + 1); // where it should be inserted
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_pair(BVHElementID p_a, BVHElementID p_b) {
+
+	Element &a = _get_element(p_a);
+	Element &b = _get_element(p_b);
+
+	PairLink link;
+	link.ud = NULL;
+	if (pair_callback) {
+		link.ud = pair_callback(pair_callback_userdata, p_a, a.userdata, a.subindex, p_b, b.userdata, b.subindex);
+	}
+
+	int pos = _find_pair(a.pairs, p_b);
+	ERR_FAIL_COND(pos >= 0);
+	link.other = p_b;
+	a.pairs.insert(-pos - 1, link);
+
+	pos = _find_pair(b.pairs, p_a);
+	ERR_FAIL_COND(pos >= 0);
+	link.other = p_a;
+	b.pairs.insert(-pos - 1, link);
+
+	pair_count++;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_unpair(BVHElementID p_a, BVHElementID p_b) {
+
+	Element &a = _get_element(p_a);
+	Element &b = _get_element(p_b);
+
+	int pos_a = _find_pair(a.pairs, p_b);
+	int pos_b = _find_pair(b.pairs, p_a);
+	ERR_FAIL_COND(pos_a < 0 || pos_b < 0);
+
+	void *ud = a.pairs[pos_a].ud;
+	a.pairs.remove(pos_a);
+	b.pairs.remove(pos_b);
+
+	if (unpair_callback) {
+		unpair_callback(unpair_callback_userdata, p_a, a.userdata, a.subindex, p_b, b.userdata, b.subindex, ud);
+	}
+
+	pair_count--;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_update_pairs(BVHElementID p_id) {
+
+	if (!use_pairs) {
+		return;
+	}
+
+	pair_query_count = 0;
+
+	{
+		const Element &e = _get_element(p_id);
+
+		if (e.leaf != NODE_NULL && (e.pairable_type || e.pairable_mask)) {
+
+			// collect everything this element should be paired with
+			const Node *n = nodes.ptr();
+			const Element *elems = elements.ptr();
+			int stack[STACK_SIZE];
+
+			// non pairable elements can only pair with pairable ones
+			for (int t = e.pairable ? 0 : int(TREE_PAIRABLE); t < TREE_MAX; t++) {
+
+				if (roots[t] == NODE_NULL) {
+					continue;
+				}
+
+				int stack_size = 0;
+				stack[stack_size++] = roots[t];
+
+				while (stack_size) {
+
+					const Node &node = n[stack[--stack_size]];
+
+					if (!_can_pair(e.pairable, e.pairable_type, e.pairable_mask, node) || !node.aabb.intersects_inclusive(e.aabb)) {
+						continue;
+					}
+
+					if (node.is_leaf()) {
+						const Element &other = elems[node.element];
+						BVHElementID other_id = node.element + 1;
+						if (other_id != p_id && !(other.userdata == e.userdata && e.userdata) && _can_pair(e, other) && other.aabb.intersects_inclusive(e.aabb)) {
+							_push_id(pair_query, pair_query_count, other_id);
+						}
+						continue;
+					}
+
+					ERR_FAIL_COND(stack_size + 2 > STACK_SIZE);
+					stack[stack_size++] = node.children[0];
+					stack[stack_size++] = node.children[1];
+				}
+			}
+
+			SortArray<BVHElementID> sorter;
+			sorter.sort(pair_query.ptrw(), pair_query_count);
+		}
+	}
+
+	// compare against the current pairs, both lists are sorted
+	pair_changes_count = 0;
+	{
+		const Element &e = _get_element(p_id);
+		const PairLink *links = e.pairs.ptr();
+		int link_count = e.pairs.size();
+		const BVHElementID *query = pair_query.ptr();
+		int query_count = pair_query_count;
+
+		int i = 0;
+		int j = 0;
+		while (i < link_count || j < query_count) {
+			if (j == query_count || (i < link_count && links[i].other < query[j])) {
+				_push_id(pair_changes, pair_changes_count, links[i].other); // lost
+				i++;
+			} else if (i == link_count || query[j] < links[i].other) {
+				j++; // new, added below
+			} else {
+				i++;
+				j++;
+			}
+		}
+	}
+
+	for (int i = 0; i < pair_changes_count; i++) {
+		_unpair(p_id, pair_changes[i]);
+	}
+
+	for (int i = 0; i < pair_query_count; i++) {
+		if (_find_pair(_get_element(p_id).pairs, pair_query[i]) < 0) {
+			_pair(p_id, pair_query[i]);
+		}
+	}
+}
+
+/* CULLING */
+
+template <class T, bool use_pairs>
+bool BVH<T, use_pairs>::_cull_planes(const AABB &p_aabb, const Plane *p_planes, int p_plane_count, uint32_t &r_mask) {
+
+	Vector3 half_extents = p_aabb.size * 0.5;
+	Vector3 center = p_aabb.position + half_extents;
+
+	for (int i = 0; i < p_plane_count; i++) {
+
+		if (!(r_mask & (1 << i))) {
+			continue;
+		}
+
+		const Plane &p = p_planes[i];
+		real_t d = p.distance_to(center);
+		real_t r = Math::abs(half_extents.x * p.normal.x) + Math::abs(half_extents.y * p.normal.y) + Math::abs(half_extents.z * p.normal.z);
+
+		if (d - r > 0) {
+			return false; // fully outside
+		}
+		if (d + r <= 0) {
+			r_mask &= ~(1 << i); // fully inside, no need to test children against it
+		}
+	}
+
+	return true;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_cull_convex_add_subtree(int p_node, _CullConvexData &p_cull) {
+
+	const Node *n = nodes.ptr();
+	const Element *elems = elements.ptr();
+	int stack[STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = p_node;
+
+	while (stack_size) {
+
+		const Node &node = n[stack[--stack_size]];
+
+		if (!(node.types & p_cull.mask)) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+			if (p_cull.result_idx == p_cull.result_max) {
+				return;
+			}
+			p_cull.result_array[p_cull.result_idx++] = elems[node.element].userdata;
+			continue;
+		}
+
+		ERR_FAIL_COND(stack_size + 2 > STACK_SIZE);
+		stack[stack_size++] = node.children[0];
+		stack[stack_size++] = node.children[1];
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_cull_convex(int p_tree, _CullConvexData &p_cull) {
+
+	if (roots[p_tree] == NODE_NULL) {
+		return;
+	}
+
+	const Node *n = nodes.ptr();
+	const Element *elems = elements.ptr();
+
+	// planes that still need to be tested are tracked as a mask, when a node
+	// is fully inside all planes its whole subtree is added without tests.
+	uint32_t all_planes = p_cull.plane_count >= MAX_PLANE_MASK_COUNT ? 0xFFFFFFFF : (1 << p_cull.plane_count) - 1;
+	bool use_plane_mask = p_cull.plane_count <= MAX_PLANE_MASK_COUNT;
+
+	struct StackItem {
+		int node;
+		uint32_t planes;
+	};
+
+	StackItem stack[STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size].node = roots[p_tree];
+	stack[stack_size].planes = all_planes;
+	stack_size++;
+
+	while (stack_size) {
+
+		if (p_cull.result_idx == p_cull.result_max) {
+			return;
+		}
+
+		const StackItem item = stack[--stack_size];
+		const Node &node = n[item.node];
+
+		if (!(node.types & p_cull.mask)) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+
+			const Element &e = elems[node.element];
+			if (use_plane_mask) {
+				uint32_t planes = item.planes;
+				if (!_cull_planes(e.aabb, p_cull.planes, p_cull.plane_count, planes)) {
+					continue;
+				}
+			} else if (!e.aabb.intersects_convex_shape(p_cull.planes, p_cull.plane_count)) {
+				continue;
+			}
+
+			p_cull.result_array[p_cull.result_idx++] = e.userdata;
+			continue;
+		}
+
+		uint32_t planes = item.planes;
+		if (use_plane_mask) {
+			if (!_cull_planes(node.aabb, p_cull.planes, p_cull.plane_count, planes)) {
+				continue;
+			}
+			if (planes == 0) {
+				_cull_convex_add_subtree(item.node, p_cull);
+				continue;
+			}
+		} else if (!node.aabb.intersects_convex_shape(p_cull.planes, p_cull.plane_count)) {
+			continue;
+		}
+
+		ERR_FAIL_COND(stack_size + 2 > STACK_SIZE);
+		for (int i = 0; i < 2; i++) {
+			stack[stack_size].node = node.children[i];
+			stack[stack_size].planes = planes;
+			stack_size++;
+		}
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_cull(int p_tree, _CullData &p_cull) {
+
+	if (roots[p_tree] == NODE_NULL) {
+		return;
+	}
+
+	const Node *n = nodes.ptr();
+	const Element *elems = elements.ptr();
+	int stack[STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = roots[p_tree];
+
+	while (stack_size) {
+
+		if (p_cull.result_idx == p_cull.result_max) {
+			return;
+		}
+
+		const Node &node = n[stack[--stack_size]];
+
+		if (!(node.types & p_cull.mask)) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+
+			const Element &e = elems[node.element];
+			if (!p_cull.test(e.aabb)) {
+				continue;
+			}
+
+			if (p_cull.subindex_array) {
+				p_cull.subindex_array[p_cull.result_idx] = e.subindex;
+			}
+			p_cull.result_array[p_cull.result_idx++] = e.userdata;
+			continue;
+		}
+
+		if (!p_cull.test(node.aabb)) {
+			continue;
+		}
+
+		ERR_FAIL_COND(stack_size + 2 > STACK_SIZE);
+		stack[stack_size++] = node.children[0];
+		stack[stack_size++] = node.children[1];
+	}
+}
+
+/* API */
+
+template <class T, bool use_pairs>
+BVHElementID BVH<T, use_pairs>::create(T *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+#ifdef DEBUG_ENABLED
+	// check for AABB validity
+	ERR_FAIL_COND_V(p_aabb.size.x < 0.0 || p_aabb.size.y < 0.0 || p_aabb.size.z < 0.0, BVH_ELEMENT_INVALID_ID);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.x) || Math::is_nan(p_aabb.size.y) || Math::is_nan(p_aabb.size.z), BVH_ELEMENT_INVALID_ID);
+#endif
+
+	BVHElementID id;
+	if (element_free.size()) {
+		id = element_free[element_free.size() - 1];
+		element_free.resize(element_free.size() - 1);
+	} else {
+		elements.push_back(Element());
+		id = elements.size();
+	}
+
+	Element &e = _get_element(id);
+	e.userdata = p_userdata;
+	e.subindex = p_subindex;
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+	e.aabb = p_aabb;
+	e.used = true;
+
+	if (!p_aabb.has_no_surface()) {
+		_element_insert(id, TREE_STATIC);
+		_update_pairs(id);
+	}
+
+	return id;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::move(BVHElementID p_id, const AABB &p_aabb) {
+
+#ifdef DEBUG_ENABLED
+	// check for AABB validity
+	ERR_FAIL_COND(p_aabb.size.x < 0.0 || p_aabb.size.y < 0.0 || p_aabb.size.z < 0.0);
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.x) || Math::is_nan(p_aabb.size.y) || Math::is_nan(p_aabb.size.z));
+#endif
+	ERR_FAIL_COND(!_is_valid_id(p_id));
+
+	Element &e = _get_element(p_id);
+	bool old_has_surf = e.leaf != NODE_NULL;
+	bool new_has_surf = !p_aabb.has_no_surface();
+
+	if (!new_has_surf) {
+		if (old_has_surf) {
+			_element_remove(p_id);
+			e.aabb = AABB();
+			_update_pairs(p_id);
+		}
+		return;
+	}
+
+	Vector3 old_position = e.aabb.position;
+	e.aabb = p_aabb;
+
+	if (!old_has_surf) {
+		_element_insert(p_id, TREE_STATIC);
+	} else if (e.tree == TREE_STATIC) {
+		// started moving, from now on it's considered dynamic
+		_element_remove(p_id);
+		_element_insert(p_id, TREE_DYNAMIC);
+	} else if (!nodes[e.leaf].aabb.encloses(p_aabb)) {
+		// escaped its enlarged bounds
+		int tree = e.tree;
+		_element_remove(p_id);
+		_element_insert(p_id, tree, p_aabb.position - old_position);
+	}
+
+	_update_pairs(p_id);
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::set_pairable(BVHElementID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	ERR_FAIL_COND(!_is_valid_id(p_id));
+
+	Element &e = _get_element(p_id);
+
+	if (p_pairable == e.pairable && e.pairable_type == p_pairable_type && e.pairable_mask == p_pairable_mask)
+		return; // no changes, return
+
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+
+	if (e.leaf != NODE_NULL) {
+		// reinsert, so subtree masks are updated (and it's moved to the right tree)
+		int tree = e.tree;
+		_element_remove(p_id);
+		_element_insert(p_id, tree);
+	}
+
+	_update_pairs(p_id);
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::erase(BVHElementID p_id) {
+
+	ERR_FAIL_COND(!_is_valid_id(p_id));
+
+	if (_get_element(p_id).leaf != NODE_NULL) {
+		_element_remove(p_id);
+	}
+
+	while (_get_element(p_id).pairs.size()) {
+		_unpair(p_id, _get_element(p_id).pairs[0].other);
+	}
+
+	_get_element(p_id) = Element();
+	element_free.push_back(p_id);
+}
+
+template <class T, bool use_pairs>
+bool BVH<T, use_pairs>::is_pairable(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(!_is_valid_id(p_id), false);
+	return _get_element(p_id).pairable;
+}
+
+template <class T, bool use_pairs>
+T *BVH<T, use_pairs>::get(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(!_is_valid_id(p_id), NULL);
+	return _get_element(p_id).userdata;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::get_subindex(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(!_is_valid_id(p_id), -1);
+	return _get_element(p_id).subindex;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) {
+
+	_CullConvexData cdata;
+	cdata.planes = &p_convex[0];
+	cdata.plane_count = p_convex.size();
+	cdata.result_array = p_result_array;
+	cdata.result_idx = 0;
+	cdata.result_max = p_result_max;
+	cdata.mask = p_mask;
+
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull_convex(i, cdata);
+	}
+
+	return cdata.result_idx;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	_CullData cdata;
+	cdata.type = CULL_AABB;
+	cdata.aabb = p_aabb;
+	cdata.result_array = p_result_array;
+	cdata.subindex_array = p_subindex_array;
+	cdata.result_idx = 0;
+	cdata.result_max = p_result_max;
+	cdata.mask = p_mask;
+
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull(i, cdata);
+	}
+
+	return cdata.result_idx;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	_CullData cdata;
+	cdata.type = CULL_SEGMENT;
+	cdata.from = p_from;
+	cdata.to = p_to;
+	cdata.result_array = p_result_array;
+	cdata.subindex_array = p_subindex_array;
+	cdata.result_idx = 0;
+	cdata.result_max = p_result_max;
+	cdata.mask = p_mask;
+
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull(i, cdata);
+	}
+
+	return cdata.result_idx;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	_CullData cdata;
+	cdata.type = CULL_POINT;
+	cdata.from = p_point;
+	cdata.result_array = p_result_array;
+	cdata.subindex_array = p_subindex_array;
+	cdata.result_idx = 0;
+	cdata.result_max = p_result_max;
+	cdata.mask = p_mask;
+
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull(i, cdata);
+	}
+
+	return cdata.result_idx;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	pair_callback = p_callback;
+	pair_callback_userdata = p_userdata;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	unpair_callback = p_callback;
+	unpair_callback_userdata = p_userdata;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::get_height() const {
+
+	int height = 0;
+	for (int i = 0; i < TREE_MAX; i++) {
+		if (roots[i] != NODE_NULL) {
+			height = MAX(height, nodes[roots[i]].height);
+		}
+	}
+	return height;
+}
+
+template <class T, bool use_pairs>
+BVH<T, use_pairs>::BVH() {
+
+	node_free = NODE_NULL;
+	for (int i = 0; i < TREE_MAX; i++) {
+		roots[i] = NODE_NULL;
+	}
+
+	pair_callback = NULL;
+	unpair_callback = NULL;
+	pair_callback_userdata = NULL;
+	unpair_callback_userdata = NULL;
+	pair_count = 0;
+	pair_query_count = 0;
+	pair_changes_count = 0;
+	dynamic_margin = 0.25;
+}
+
+template <class T, bool use_pairs>
+BVH<T, use_pairs>::~BVH() {
+}
+
+#endif // BVH_H
@@ -0,0 +1,396 @@
+/*************************************************************************/
+/*  mesh_simplifier.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "mesh_simplifier.h"
+
+#include "core/math/aabb.h"
+#include "core/sort_array.h"
+#include "core/vector.h"
+
+MeshSimplifier::Quadric::Quadric() {
+
+	a2 = ab = ac = ad = 0;
+	b2 = bc = bd = 0;
+	c2 = cd = 0;
+	d2 = 0;
+	weight = 0;
+}
+
+void MeshSimplifier::Quadric::add_plane(const Vector3 &p_normal, double p_d, double p_weight) {
+
+	double x = p_normal.x;
+	double y = p_normal.y;
+	double z = p_normal.z;
+
+	a2 += p_weight * x * x;
+	ab += p_weight * x * y;
+	ac += p_weight * x * z;
+	ad += p_weight * x * p_d;
+	b2 += p_weight * y * y;
+	bc += p_weight * y * z;
+	bd += p_weight * y * p_d;
+	c2 += p_weight * z * z;
+	cd += p_weight * z * p_d;
+	d2 += p_weight * p_d * p_d;
+	weight += p_weight;
+}
+
+void MeshSimplifier::Quadric::add(const Quadric &p_q) {
+
+	a2 += p_q.a2;
+	ab += p_q.ab;
+	ac += p_q.ac;
+	ad += p_q.ad;
+	b2 += p_q.b2;
+	bc += p_q.bc;
+	bd += p_q.bd;
+	c2 += p_q.c2;
+	cd += p_q.cd;
+	d2 += p_q.d2;
+	weight += p_q.weight;
+}
+
+double MeshSimplifier::Quadric::evaluate(const Vector3 &p_point) const {
+
+	double x = p_point.x;
+	double y = p_point.y;
+	double z = p_point.z;
+
+	double e = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+			   b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+			   c2 * z * z + 2.0 * cd * z +
+			   d2;
+
+	//mean squared distance to the planes merged so far
+	return weight > 0 ? MAX(e, 0.0) / weight : 0.0;
+}
+
+bool MeshSimplifier::_collapse_flips(const Vector3 *p_vertices, const int *p_indices, const int *p_adjacency, const int *p_adjacency_offsets, int p_from, int p_to) {
+
+	for (int i = p_adjacency_offsets[p_from]; i < p_adjacency_offsets[p_from + 1]; i++) {
+
+		const int *tri = &p_indices[p_adjacency[i] * 3];
+		if (tri[0] == p_to || tri[1] == p_to || tri[2] == p_to) {
+			continue; //this one goes away
+		}
+
+		Vector3 old_pos[3];
+		Vector3 new_pos[3];
+		for (int j = 0; j < 3; j++) {
+			old_pos[j] = p_vertices[tri[j]];
+			new_pos[j] = tri[j] == p_from ? p_vertices[p_to] : old_pos[j];
+		}
+
+		Vector3 old_normal = (old_pos[1] - old_pos[0]).cross(old_pos[2] - old_pos[0]);
+		Vector3 new_normal = (new_pos[1] - new_pos[0]).cross(new_pos[2] - new_pos[0]);
+
+		if (old_normal.dot(new_normal) <= 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+struct _MeshSimplifierPositionSort {
+
+	const Vector3 *vertices;
+
+	_FORCE_INLINE_ bool operator()(int p_a, int p_b) const {
+		return vertices[p_a] < vertices[p_b];
+	}
+};
+
+PoolVector<int> MeshSimplifier::simplify(const PoolVector<Vector3> &p_vertices, const PoolVector<int> &p_indices, int p_target_index_count, float p_max_error, float *r_error) {
+
+	if (r_error) {
+		*r_error = 0;
+	}
+
+	int vertex_count = p_vertices.size();
+	int index_count = p_indices.size();
+	ERR_FAIL_COND_V(index_count % 3 != 0, p_indices);
+
+	if (p_target_index_count >= index_count || vertex_count == 0) {
+		return p_indices;
+	}
+
+	PoolVector<Vector3>::Read vr = p_vertices.read();
+	const Vector3 *vertices = vr.ptr();
+
+	Vector<int> indices;
+	indices.resize(index_count);
+	{
+		PoolVector<int>::Read ir = p_indices.read();
+		for (int i = 0; i < index_count; i++) {
+			ERR_FAIL_INDEX_V(ir[i], vertex_count, p_indices);
+			indices.write[i] = ir[i];
+		}
+	}
+
+	AABB bounds(vertices[0], Vector3());
+	for (int i = 1; i < vertex_count; i++) {
+		bounds.expand_to(vertices[i]);
+	}
+
+	double extent = bounds.get_longest_axis_size();
+	double max_error = p_max_error * extent;
+	double max_error_squared = max_error * max_error;
+
+	Vector<uint8_t> locked;
+	locked.resize(vertex_count);
+	uint8_t *lockedptr = locked.ptrw();
+	for (int i = 0; i < vertex_count; i++) {
+		lockedptr[i] = 0;
+	}
+
+	/* lock attribute seams, where several vertices share a position */
+	{
+		Vector<int> order;
+		order.resize(vertex_count);
+		int *orderptr = order.ptrw();
+		for (int i = 0; i < vertex_count; i++) {
+			orderptr[i] = i;
+		}
+
+		SortArray<int, _MeshSimplifierPositionSort> sorter;
+		sorter.compare.vertices = vertices;
+		sorter.sort(orderptr, vertex_count);
+
+		for (int i = 1; i < vertex_count; i++) {
+			if (vertices[orderptr[i]] == vertices[orderptr[i - 1]]) {
+				lockedptr[orderptr[i]] = 1;
+				lockedptr[orderptr[i - 1]] = 1;
+			}
+		}
+	}
+
+	/* lock open borders and non manifold edges, anything not shared by exactly two triangles */
+	{
+		Vector<uint64_t> edges;
+		edges.resize(index_count);
+		uint64_t *edgeptr = edges.ptrw();
+		const int *idx = indices.ptr();
+
+		for (int i = 0; i < index_count; i += 3) {
+			for (int j = 0; j < 3; j++) {
+				uint64_t a = idx[i + j];
+				uint64_t b = idx[i + (j + 1) % 3];
+				edgeptr[i + j] = a < b ? (a << 32) | b : (b << 32) | a;
+			}
+		}
+
+		SortArray<uint64_t> sorter;
+		sorter.sort(edgeptr, index_count);
+
+		int from = 0;
+		while (from < index_count) {
+			int to = from + 1;
+			while (to < index_count && edgeptr[to] == edgeptr[from]) {
+				to++;
+			}
+			if (to - from != 2) {
+				lockedptr[edgeptr[from] >> 32] = 1;
+				lockedptr[edgeptr[from] & 0xFFFFFFFF] = 1;
+			}
+			from = to;
+		}
+	}
+
+	/* accumulate the planes around each vertex, weighted by area */
+
+	Vector<Quadric> quadrics;
+	quadrics.resize(vertex_count);
+	Quadric *quadricptr = quadrics.ptrw();
+
+	for (int i = 0; i < index_count; i += 3) {
+
+		const Vector3 &a = vertices[indices[i + 0]];
+		Vector3 normal = (vertices[indices[i + 1]] - a).cross(vertices[indices[i + 2]] - a);
+		real_t area = normal.length();
+		if (area == 0) {
+			continue;
+		}
+		normal /= area;
+
+		for (int j = 0; j < 3; j++) {
+			quadricptr[indices[i + j]].add_plane(normal, -normal.dot(a), area * 0.5);
+		}
+	}
+
+	Vector<int> adjacency;
+	adjacency.resize(index_count);
+	Vector<int> adjacency_offsets;
+	adjacency_offsets.resize(vertex_count + 1);
+	Vector<int> remap;
+	remap.resize(vertex_count);
+	Vector<uint8_t> touched;
+	touched.resize(vertex_count);
+	Vector<Collapse> collapses;
+	collapses.resize(index_count);
+
+	double error_used = 0;
+
+	while (index_count > p_target_index_count) {
+
+		int *idx = indices.ptrw();
+		int *adjptr = adjacency.ptrw();
+		int *offsetptr = adjacency_offsets.ptrw();
+		int *remapptr = remap.ptrw();
+		uint8_t *touchedptr = touched.ptrw();
+		Collapse *collapseptr = collapses.ptrw();
+
+		/* triangles around each vertex */
+
+		for (int i = 0; i <= vertex_count; i++) {
+			offsetptr[i] = 0;
+		}
+		for (int i = 0; i < index_count; i++) {
+			offsetptr[idx[i] + 1]++;
+		}
+		for (int i = 0; i < vertex_count; i++) {
+			offsetptr[i + 1] += offsetptr[i];
+			remapptr[i] = offsetptr[i]; //fill cursor
+		}
+		for (int i = 0; i < index_count; i++) {
+			adjptr[remapptr[idx[i]]++] = i / 3;
+		}
+
+		/* every interior edge is seen once in each direction, one per triangle */
+
+		int collapse_count = 0;
+		for (int i = 0; i < index_count; i++) {
+
+			int from = idx[i];
+			int to = idx[i - i % 3 + (i + 1) % 3];
+			if (lockedptr[from]) {
+				continue;
+			}
+
+			Quadric q = quadricptr[from];
+			q.add(quadricptr[to]);
+
+			Collapse &c = collapseptr[collapse_count++];
+			c.from = from;
+			c.to = to;
+			c.error = q.evaluate(vertices[to]);
+		}
+
+		if (collapse_count == 0) {
+			break;
+		}
+
+		SortArray<Collapse> sorter;
+		sorter.sort(collapseptr, collapse_count);
+
+		for (int i = 0; i < vertex_count; i++) {
+			remapptr[i] = i;
+			touchedptr[i] = 0;
+		}
+
+		/* apply the cheapest collapses whose neighborhoods do not overlap */
+
+		int triangles_to_remove = (index_count - p_target_index_count + 2) / 3;
+		int triangles_removed = 0;
+		int applied = 0;
+
+		for (int i = 0; i < collapse_count && triangles_removed < triangles_to_remove; i++) {
+
+			const Collapse &c = collapseptr[i];
+			if (c.error > max_error_squared) {
+				break;
+			}
+
+			if (touchedptr[c.from] || touchedptr[c.to]) {
+				continue;
+			}
+
+			if (_collapse_flips(vertices, idx, adjptr, offsetptr, c.from, c.to)) {
+				continue;
+			}
+
+			for (int j = offsetptr[c.from]; j < offsetptr[c.from + 1]; j++) {
+
+				const int *tri = &idx[adjptr[j] * 3];
+				for (int k = 0; k < 3; k++) {
+					touchedptr[tri[k]] = 1;
+				}
+				if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+					triangles_removed++;
+				}
+			}
+
+			remapptr[c.from] = c.to;
+			quadricptr[c.to].add(quadricptr[c.from]);
+			error_used = MAX(error_used, c.error);
+			applied++;
+		}
+
+		if (applied == 0) {
+			break;
+		}
+
+		/* remap and drop the triangles that collapsed */
+
+		int new_index_count = 0;
+		for (int i = 0; i < index_count; i += 3) {
+
+			int a = remapptr[idx[i + 0]];
+			int b = remapptr[idx[i + 1]];
+			int c = remapptr[idx[i + 2]];
+			if (a == b || b == c || c == a) {
+				continue;
+			}
+
+			idx[new_index_count++] = a;
+			idx[new_index_count++] = b;
+			idx[new_index_count++] = c;
+		}
+
+		index_count = new_index_count;
+	}
+
+	if (r_error && extent > 0) {
+		*r_error = Math::sqrt(error_used) / extent;
+	}
+
+	PoolVector<int> result;
+	result.resize(index_count);
+	{
+		PoolVector<int>::Write w = result.write();
+		const int *idx = indices.ptr();
+		for (int i = 0; i < index_count; i++) {
+			w[i] = idx[i];
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,75 @@
+/*************************************************************************/
+/*  mesh_simplifier.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "core/math/vector3.h"
+#include "core/pool_vector.h"
+
+// Reduces the triangle count of an indexed mesh by collapsing edges in order
+// of quadric error. Vertices are never moved or created, so the result can be
+// drawn with the vertex array of the source mesh. Vertices on open borders and
+// on attribute seams (several vertices at the same position) are kept.
+class MeshSimplifier {
+
+	struct Quadric {
+
+		double a2, ab, ac, ad;
+		double b2, bc, bd;
+		double c2, cd;
+		double d2;
+		double weight;
+
+		void add_plane(const Vector3 &p_normal, double p_d, double p_weight);
+		void add(const Quadric &p_q);
+		double evaluate(const Vector3 &p_point) const;
+
+		Quadric();
+	};
+
+	struct Collapse {
+
+		int from;
+		int to;
+		double error;
+
+		_FORCE_INLINE_ bool operator<(const Collapse &p_c) const { return error < p_c.error; }
+	};
+
+	static bool _collapse_flips(const Vector3 *p_vertices, const int *p_indices, const int *p_adjacency, const int *p_adjacency_offsets, int p_from, int p_to);
+
+public:
+	// p_max_error and r_error are distances relative to the size of the mesh.
+	static PoolVector<int> simplify(const PoolVector<Vector3> &p_vertices, const PoolVector<int> &p_indices, int p_target_index_count, float p_max_error, float *r_error = NULL);
+};
+
+#endif // MESH_SIMPLIFIER_H
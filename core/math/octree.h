@@ -221,7 +221,7 @@ private:
 			} else {
 
 				if (unpair_callback) {
-					unpair_callback(pair_callback_userdata, p_pair->A->_id, p_pair->A->userdata, p_pair->A->subindex, p_pair->B->_id, p_pair->B->userdata, p_pair->B->subindex, p_pair->ud);
+					unpair_callback(unpair_callback_userdata, p_pair->A->_id, p_pair->A->userdata, p_pair->A->subindex, p_pair->B->_id, p_pair->B->userdata, p_pair->B->subindex, p_pair->ud);
 				}
 				pair_count--;
 			}
@@ -281,7 +281,7 @@ private:
 
 			if (E->get().intersect) {
 				if (unpair_callback) {
-					unpair_callback(pair_callback_userdata, p_A->_id, p_A->userdata, p_A->subindex, p_B->_id, p_B->userdata, p_B->subindex, E->get().ud);
+					unpair_callback(unpair_callback_userdata, p_A->_id, p_A->userdata, p_A->subindex, p_B->_id, p_B->userdata, p_B->subindex, E->get().ud);
 				}
 
 				pair_count--;
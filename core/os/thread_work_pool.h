@@ -0,0 +1,141 @@
+/*************************************************************************/
+/*  thread_work_pool.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef THREAD_WORK_POOL_H
+#define THREAD_WORK_POOL_H
+
+#include "core/os/memory.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+/**
+	Persistent pool of worker threads for splitting per-frame work across cores.
+	Unlike thread_process_array(), threads are created once in init() and
+	reused on every do_work() call, so it is cheap enough to use every frame.
+	The calling thread takes part in the work, and do_work() only returns once
+	all elements have been processed.
+*/
+
+class ThreadWorkPool {
+
+	struct BaseWork {
+		volatile uint32_t *index;
+		uint32_t max_elements;
+		virtual void work() = 0;
+		virtual ~BaseWork() {}
+	};
+
+	template <class C, class M, class U>
+	struct Work : public BaseWork {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void work() {
+
+			while (true) {
+				uint32_t work_index = atomic_increment(index) - 1;
+				if (work_index >= max_elements) {
+					break;
+				}
+				(instance->*method)(work_index, userdata);
+			}
+		}
+	};
+
+	struct ThreadData {
+		Thread *thread;
+		Semaphore *start;
+		Semaphore *completed;
+		volatile bool exit;
+		BaseWork *work;
+	};
+
+	ThreadData *threads;
+	uint32_t thread_count;
+	volatile uint32_t index;
+	volatile bool working;
+
+	static void _thread_function(void *p_user);
+
+public:
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+
+		if (p_elements == 0) {
+			return;
+		}
+
+		if (thread_count == 0 || p_elements == 1) {
+			//no workers (or nothing to split), just run everything here
+			for (uint32_t i = 0; i < p_elements; i++) {
+				(p_instance->*p_method)(i, p_userdata);
+			}
+			return;
+		}
+
+		Work<C, M, U> w;
+		w.index = &index;
+		w.max_elements = p_elements;
+		w.instance = p_instance;
+		w.method = p_method;
+		w.userdata = p_userdata;
+
+		index = 0;
+		working = true;
+
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].work = &w;
+			threads[i].start->post();
+		}
+
+		w.work();
+
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].completed->wait();
+			threads[i].work = NULL;
+		}
+
+		working = false;
+	}
+
+	_FORCE_INLINE_ bool is_initialized() const { return threads != NULL; }
+	_FORCE_INLINE_ uint32_t get_thread_count() const { return thread_count; }
+	//do_work() is not reentrant, check this before using the pool from code that may run inside a job
+	_FORCE_INLINE_ bool is_working() const { return working; }
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	ThreadWorkPool();
+	~ThreadWorkPool();
+};
+
+#endif // THREAD_WORK_POOL_H
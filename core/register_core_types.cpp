@@ -97,6 +97,8 @@ void register_core_types() {
 	MemoryPool::setup();
 
 	_global_mutex = Mutex::create();
+	Image::setup_work_pool();
+	PacketPeerUDP::setup_recv_batch();
 
 	StringName::setup();
 	ResourceLoader::initialize();
@@ -252,6 +254,9 @@ void unregister_core_types() {
 
 	memdelete(_geometry);
 
+	Image::finish_work_pool();
+	PacketPeerUDP::finish_recv_batch();
+
 	ResourceLoader::remove_resource_format_loader(resource_format_image);
 	resource_format_image.unref();
 
@@ -0,0 +1,103 @@
+/*************************************************************************/
+/*  spsc_queue.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include "core/os/memory.h"
+#include "core/safe_refcount.h"
+
+// Bounded FIFO for handing items from exactly one producer thread to exactly
+// one consumer thread without locking. Each position is only written by its
+// own side and published with an atomic increment, which also acts as the
+// memory barrier for the slot written before it.
+template <typename T>
+class SPSCQueue {
+
+	T *data;
+	uint32_t size_mask;
+	volatile uint32_t read_pos;
+	volatile uint32_t write_pos;
+
+public:
+	// Producer side. Returns false when the queue is full.
+	bool push(const T &p_value) {
+
+		uint32_t pos = write_pos;
+		if (pos - atomic_add(&read_pos, 0) > size_mask)
+			return false;
+
+		data[pos & size_mask] = p_value;
+		atomic_increment(&write_pos);
+		return true;
+	}
+
+	// Consumer side. Returns false when the queue is empty.
+	bool pop(T &r_value) {
+
+		uint32_t pos = read_pos;
+		if (atomic_add(&write_pos, 0) == pos)
+			return false;
+
+		r_value = data[pos & size_mask];
+		data[pos & size_mask] = T(); // Do not keep references alive until the slot is reused.
+		atomic_increment(&read_pos);
+		return true;
+	}
+
+	int size() const {
+
+		return size_mask + 1;
+	}
+
+	// Not thread safe, only call while neither side is using the queue.
+	void resize(int p_power) {
+
+		if (data)
+			memdelete_arr(data);
+		data = memnew_arr(T, 1 << p_power);
+		size_mask = (1 << p_power) - 1;
+		read_pos = 0;
+		write_pos = 0;
+	}
+
+	SPSCQueue<T>(int p_power = 0) {
+
+		data = NULL;
+		resize(p_power);
+	}
+
+	~SPSCQueue<T>() {
+
+		memdelete_arr(data);
+	}
+};
+
+#endif
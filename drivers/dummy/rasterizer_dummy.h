@@ -145,11 +145,15 @@ public:
 		Vector<DummySurface> surfaces;
 		int blend_shape_count;
 		VS::BlendShapeMode blend_shape_mode;
+		Vector<RID> lods;
+		Vector<float> lod_screen_ratios;
 	};
 
 	mutable RID_Owner<DummyTexture> texture_owner;
 	mutable RID_Owner<DummyMesh> mesh_owner;
 
+	uint64_t texture_mem; //bytes held by texture images, so memory use can be checked without a GPU
+
 	RID texture_create() {
 
 		DummyTexture *texture = memnew(DummyTexture);
@@ -164,16 +168,23 @@ public:
 		t->height = p_height;
 		t->flags = p_flags;
 		t->format = p_format;
+		if (t->image.is_valid()) {
+			texture_mem -= t->image->get_data().size();
+		}
 		t->image = Ref<Image>(memnew(Image));
 		t->image->create(p_width, p_height, false, p_format);
+		texture_mem += t->image->get_data().size();
 	}
 	void texture_set_data(RID p_texture, const Ref<Image> &p_image, int p_level) {
 		DummyTexture *t = texture_owner.getornull(p_texture);
 		ERR_FAIL_COND(!t);
+		ERR_FAIL_COND(t->image.is_null());
 		t->width = p_image->get_width();
 		t->height = p_image->get_height();
 		t->format = p_image->get_format();
-		t->image->create(t->width, t->height, false, t->format, p_image->get_data());
+		texture_mem -= t->image->get_data().size();
+		t->image->create(t->width, t->height, p_image->has_mipmaps(), t->format, p_image->get_data());
+		texture_mem += t->image->get_data().size();
 	}
 
 	void texture_set_data_partial(RID p_texture, const Ref<Image> &p_image, int src_x, int src_y, int src_w, int src_h, int dst_x, int dst_y, int p_dst_mip, int p_level) {
@@ -230,7 +241,23 @@ public:
 
 	void texture_set_shrink_all_x2_on_set_data(bool p_enable) {}
 
-	void texture_debug_usage(List<VS::TextureInfo> *r_info) {}
+	void texture_debug_usage(List<VS::TextureInfo> *r_info) {
+		List<RID> textures;
+		texture_owner.get_owned_list(&textures);
+
+		for (List<RID>::Element *E = textures.front(); E; E = E->next()) {
+			DummyTexture *t = texture_owner.get(E->get());
+			VS::TextureInfo tinfo;
+			tinfo.texture = E->get();
+			tinfo.path = t->path;
+			tinfo.format = t->format;
+			tinfo.width = t->width;
+			tinfo.height = t->height;
+			tinfo.depth = 0;
+			tinfo.bytes = t->image.is_valid() ? t->image->get_data().size() : 0;
+			r_info->push_back(tinfo);
+		}
+	}
 
 	RID texture_create_radiance_cubemap(RID p_source, int p_resolution = -1) const { return RID(); }
 
@@ -278,6 +305,7 @@ public:
 
 	bool material_is_animated(RID p_material) { return false; }
 	bool material_casts_shadows(RID p_material) { return false; }
+	bool material_is_opaque(RID p_material) { return false; }
 
 	void material_add_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance) {}
 	void material_remove_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance) {}
@@ -413,6 +441,46 @@ public:
 	AABB mesh_get_aabb(RID p_mesh, RID p_skeleton) const { return AABB(); }
 	void mesh_clear(RID p_mesh) {}
 
+	void mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count) {
+		DummyMesh *m = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND(!m);
+		DummyMesh *source = mesh_owner.getornull(p_source_mesh);
+		ERR_FAIL_COND(!source);
+		ERR_FAIL_INDEX(p_source_surface, source->surfaces.size());
+
+		DummySurface s = source->surfaces[p_source_surface];
+		s.format = p_index_count ? s.format | VS::ARRAY_FORMAT_INDEX : s.format & ~VS::ARRAY_FORMAT_INDEX;
+		s.index_array = p_index_array;
+		s.index_count = p_index_count;
+		s.blend_shapes.clear();
+		m->surfaces.push_back(s);
+	}
+	void mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios) {
+		DummyMesh *m = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND(!m);
+		ERR_FAIL_COND(p_lods.size() != p_screen_ratios.size());
+
+		m->lods = p_lods;
+		m->lod_screen_ratios = p_screen_ratios;
+	}
+	int mesh_get_lod_count(RID p_mesh) const {
+		DummyMesh *m = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!m, 0);
+		return m->lods.size();
+	}
+	RID mesh_get_lod(RID p_mesh, int p_lod) const {
+		DummyMesh *m = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!m, RID());
+		ERR_FAIL_INDEX_V(p_lod, m->lods.size(), RID());
+		return m->lods[p_lod];
+	}
+	float mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const {
+		DummyMesh *m = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!m, 0);
+		ERR_FAIL_INDEX_V(p_lod, m->lods.size(), 0);
+		return m->lod_screen_ratios[p_lod];
+	}
+
 	/* MULTIMESH API */
 
 	virtual RID multimesh_create() { return RID(); }
@@ -440,6 +508,9 @@ public:
 
 	AABB multimesh_get_aabb(RID p_multimesh) const { return AABB(); }
 
+	void multimesh_set_compute_aabb(RID p_multimesh, bool p_enable) {}
+	void update_dirty_multimeshes() {}
+
 	/* IMMEDIATE API */
 
 	RID immediate_create() { return RID(); }
@@ -467,6 +538,7 @@ public:
 	Transform skeleton_bone_get_transform(RID p_skeleton, int p_bone) const { return Transform(); }
 	void skeleton_bone_set_transform_2d(RID p_skeleton, int p_bone, const Transform2D &p_transform) {}
 	Transform2D skeleton_bone_get_transform_2d(RID p_skeleton, int p_bone) const { return Transform2D(); }
+	void skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array) {}
 
 	/* Light API */
 
@@ -719,6 +791,9 @@ public:
 		if (texture_owner.owns(p_rid)) {
 			// delete the texture
 			DummyTexture *texture = texture_owner.get(p_rid);
+			if (texture->image.is_valid()) {
+				texture_mem -= texture->image->get_data().size();
+			}
 			texture_owner.free(p_rid);
 			memdelete(texture);
 		}
@@ -735,11 +810,23 @@ public:
 	void render_info_end_capture() {}
 	int get_captured_render_info(VS::RenderInfo p_info) { return 0; }
 
-	int get_render_info(VS::RenderInfo p_info) { return 0; }
+	int get_render_info(VS::RenderInfo p_info) {
+		switch (p_info) {
+			case VS::INFO_VIDEO_MEM_USED:
+			case VS::INFO_TEXTURE_MEM_USED: {
+				return texture_mem;
+			}
+			default: {
+				return 0;
+			}
+		}
+	}
 
 	static RasterizerStorage *base_singleton;
 
-	RasterizerStorageDummy(){};
+	RasterizerStorageDummy() {
+		texture_mem = 0;
+	}
 	~RasterizerStorageDummy() {}
 };
 
@@ -1723,7 +1723,19 @@ void RasterizerStorageGLES2::material_set_next_pass(RID p_material, RID p_next_m
 	Material *material = material_owner.get(p_material);
 	ERR_FAIL_COND(!material);
 
+	if (material->next_pass == p_next_material)
+		return;
+
 	material->next_pass = p_next_material;
+
+	//instances only batch when every pass is opaque
+	for (Map<Geometry *, int>::Element *E = material->geometry_owners.front(); E; E = E->next()) {
+		E->key()->material_changed_notify();
+	}
+
+	for (Map<RasterizerScene::InstanceBase *, int>::Element *E = material->instance_owners.front(); E; E = E->next()) {
+		E->key()->base_changed(false, true);
+	}
 }
 
 bool RasterizerStorageGLES2::material_is_animated(RID p_material) {
@@ -1756,6 +1768,23 @@ bool RasterizerStorageGLES2::material_casts_shadows(RID p_material) {
 	return casts_shadows;
 }
 
+bool RasterizerStorageGLES2::material_is_opaque(RID p_material) {
+	Material *material = material_owner.get(p_material);
+	ERR_FAIL_COND_V(!material, false);
+	if (material->dirty_list.in_list()) {
+		_update_material(material);
+	}
+
+	//every pass has to be, they are drawn with the same instances
+	bool opaque = material->is_opaque_cache;
+
+	if (opaque && material->next_pass.is_valid()) {
+		opaque = material_is_opaque(material->next_pass);
+	}
+
+	return opaque;
+}
+
 void RasterizerStorageGLES2::material_add_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance) {
 
 	Material *material = material_owner.getornull(p_material);
@@ -1810,6 +1839,7 @@ void RasterizerStorageGLES2::_update_material(Material *p_material) {
 	{
 		bool can_cast_shadow = false;
 		bool is_animated = false;
+		bool is_opaque = false;
 
 		if (p_material->shader && p_material->shader->mode == VS::SHADER_SPATIAL) {
 
@@ -1818,6 +1848,15 @@ void RasterizerStorageGLES2::_update_material(Material *p_material) {
 				can_cast_shadow = true;
 			}
 
+			//what the scene renderer keeps out of the alpha pass
+			if (p_material->shader->spatial.blend_mode == Shader::Spatial::BLEND_MODE_MIX &&
+					(!p_material->shader->spatial.uses_alpha || p_material->shader->spatial.uses_alpha_scissor) &&
+					!p_material->shader->spatial.uses_screen_texture &&
+					!p_material->shader->spatial.uses_depth_texture &&
+					p_material->shader->spatial.depth_draw_mode != Shader::Spatial::DEPTH_DRAW_ALPHA_PREPASS) {
+				is_opaque = true;
+			}
+
 			if (p_material->shader->spatial.uses_discard && p_material->shader->uses_fragment_time) {
 				is_animated = true;
 			}
@@ -1826,9 +1865,10 @@ void RasterizerStorageGLES2::_update_material(Material *p_material) {
 				is_animated = true;
 			}
 
-			if (can_cast_shadow != p_material->can_cast_shadow_cache || is_animated != p_material->is_animated_cache) {
+			if (can_cast_shadow != p_material->can_cast_shadow_cache || is_animated != p_material->is_animated_cache || is_opaque != p_material->is_opaque_cache) {
 				p_material->can_cast_shadow_cache = can_cast_shadow;
 				p_material->is_animated_cache = is_animated;
+				p_material->is_opaque_cache = is_opaque;
 
 				for (Map<Geometry *, int>::Element *E = p_material->geometry_owners.front(); E; E = E->next()) {
 					E->key()->material_changed_notify();
@@ -2606,7 +2646,7 @@ void RasterizerStorageGLES2::mesh_remove_surface(RID p_mesh, int p_surface) {
 		_material_remove_geometry(surface->material, mesh->surfaces[p_surface]);
 	}
 
-	glDeleteBuffers(1, &surface->vertex_id);
+	_release_vertex_buffer(surface->vertex_id);
 	if (surface->index_id) {
 		glDeleteBuffers(1, &surface->index_id);
 	}
@@ -2768,6 +2808,124 @@ void RasterizerStorageGLES2::mesh_clear(RID p_mesh) {
 	}
 }
 
+void RasterizerStorageGLES2::_release_vertex_buffer(GLuint p_vertex_id) {
+	Map<GLuint, int>::Element *E = shared_vertex_buffers.find(p_vertex_id);
+	if (E) {
+		//still drawn by another surface, whichever goes last deletes it
+		E->get()--;
+		if (E->get() == 0) {
+			shared_vertex_buffers.erase(E);
+		}
+		return;
+	}
+
+	glDeleteBuffers(1, &p_vertex_id);
+}
+
+void RasterizerStorageGLES2::mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count) {
+	Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND(!mesh);
+	const Mesh *source_mesh = mesh_owner.getornull(p_source_mesh);
+	ERR_FAIL_COND(!source_mesh);
+	ERR_FAIL_INDEX(p_source_surface, source_mesh->surfaces.size());
+
+	const Surface *source = source_mesh->surfaces[p_source_surface];
+
+	int index_stride = source->array_len >= (1 << 16) ? 4 : 2;
+	ERR_FAIL_COND(p_index_array.size() != p_index_count * index_stride);
+
+	Surface *surface = memnew(Surface);
+
+	surface->active = true;
+	surface->array_len = source->array_len;
+	surface->index_array_len = p_index_count;
+	surface->array_byte_size = source->array_byte_size;
+	surface->index_array_byte_size = p_index_array.size();
+	surface->primitive = source->primitive;
+	surface->mesh = mesh;
+	surface->format = p_index_count ? source->format | VS::ARRAY_FORMAT_INDEX : source->format & ~VS::ARRAY_FORMAT_INDEX;
+	surface->skeleton_bone_aabb = source->skeleton_bone_aabb;
+	surface->skeleton_bone_used = source->skeleton_bone_used;
+	surface->aabb = source->aabb;
+	surface->max_bone = source->max_bone;
+#ifdef TOOLS_ENABLED
+	surface->data = source->data;
+	surface->index_data = p_index_array;
+#endif
+
+	surface->total_data_size += surface->index_array_byte_size;
+
+	for (int i = 0; i < VS::ARRAY_MAX; i++) {
+		surface->attribs[i] = source->attribs[i];
+	}
+
+	Surface::Attrib &index_attrib = surface->attribs[VS::ARRAY_INDEX];
+	index_attrib.enabled = p_index_count > 0;
+	index_attrib.integer = false;
+	index_attrib.size = 1;
+	index_attrib.type = index_stride == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	index_attrib.stride = index_stride;
+	index_attrib.normalized = GL_FALSE;
+
+	//draw from the source vertices, only the indices of this level are uploaded
+	surface->vertex_id = source->vertex_id;
+	shared_vertex_buffers[source->vertex_id]++;
+
+	if (p_index_count) {
+		PoolVector<uint8_t>::Read ir = p_index_array.read();
+
+		glGenBuffers(1, &surface->index_id);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface->index_id);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, p_index_array.size(), ir.ptr(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	} else {
+		surface->index_id = 0;
+	}
+
+	mesh->surfaces.push_back(surface);
+	mesh->instance_change_notify(true, true);
+
+	info.vertex_mem += surface->total_data_size;
+}
+
+void RasterizerStorageGLES2::mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios) {
+	Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND(!mesh);
+	ERR_FAIL_COND(p_lods.size() != p_screen_ratios.size());
+
+	for (int i = 1; i < p_screen_ratios.size(); i++) {
+		ERR_EXPLAIN("LOD screen ratios must be sorted from the most to the least detailed level.");
+		ERR_FAIL_COND(p_screen_ratios[i] > p_screen_ratios[i - 1]);
+	}
+
+	mesh->lods = p_lods;
+	mesh->lod_screen_ratios = p_screen_ratios;
+	mesh->instance_change_notify(true, true);
+}
+
+int RasterizerStorageGLES2::mesh_get_lod_count(RID p_mesh) const {
+	const Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND_V(!mesh, 0);
+
+	return mesh->lods.size();
+}
+
+RID RasterizerStorageGLES2::mesh_get_lod(RID p_mesh, int p_lod) const {
+	const Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND_V(!mesh, RID());
+	ERR_FAIL_INDEX_V(p_lod, mesh->lods.size(), RID());
+
+	return mesh->lods[p_lod];
+}
+
+float RasterizerStorageGLES2::mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const {
+	const Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND_V(!mesh, 0);
+	ERR_FAIL_INDEX_V(p_lod, mesh->lods.size(), 0);
+
+	return mesh->lod_screen_ratios[p_lod];
+}
+
 /* MULTIMESH API */
 
 RID RasterizerStorageGLES2::multimesh_create() {
@@ -3208,13 +3366,31 @@ AABB RasterizerStorageGLES2::multimesh_get_aabb(RID p_multimesh) const {
 	return multimesh->aabb;
 }
 
+void RasterizerStorageGLES2::multimesh_set_compute_aabb(RID p_multimesh, bool p_enable) {
+
+	MultiMesh *multimesh = multimesh_owner.getornull(p_multimesh);
+	ERR_FAIL_COND(!multimesh);
+
+	if (multimesh->compute_aabb == p_enable) {
+		return;
+	}
+
+	multimesh->compute_aabb = p_enable;
+	multimesh->aabb = AABB();
+	multimesh->dirty_aabb = true;
+
+	if (!multimesh->update_list.in_list()) {
+		multimesh_update_list.add(&multimesh->update_list);
+	}
+}
+
 void RasterizerStorageGLES2::update_dirty_multimeshes() {
 
 	while (multimesh_update_list.first()) {
 
 		MultiMesh *multimesh = multimesh_update_list.first()->self();
 
-		if (multimesh->size && multimesh->dirty_aabb) {
+		if (multimesh->size && multimesh->dirty_aabb && multimesh->compute_aabb) {
 
 			AABB mesh_aabb;
 
@@ -3590,6 +3766,22 @@ Transform2D RasterizerStorageGLES2::skeleton_bone_get_transform_2d(RID p_skeleto
 	return ret;
 }
 
+void RasterizerStorageGLES2::skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array) {
+	Skeleton *skeleton = skeleton_owner.getornull(p_skeleton);
+	ERR_FAIL_COND(!skeleton);
+
+	ERR_FAIL_COND(skeleton->use_2d);
+	ERR_FAIL_COND(p_array.size() != skeleton->size * 12);
+
+	//same layout as bone_data, 3 rows of 4 floats per bone
+	PoolVector<float>::Read r = p_array.read();
+	copymem(skeleton->bone_data.ptrw(), r.ptr(), sizeof(float) * p_array.size());
+
+	if (!skeleton->update_list.in_list()) {
+		skeleton_update_list.add(&skeleton->update_list);
+	}
+}
+
 void RasterizerStorageGLES2::skeleton_set_base_transform_2d(RID p_skeleton, const Transform2D &p_base_transform) {
 
 	Skeleton *skeleton = skeleton_owner.getornull(p_skeleton);
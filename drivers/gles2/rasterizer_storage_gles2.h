@@ -542,12 +542,14 @@ public:
 
 		bool can_cast_shadow_cache;
 		bool is_animated_cache;
+		bool is_opaque_cache;
 
 		Material() :
 				list(this),
 				dirty_list(this) {
 			can_cast_shadow_cache = false;
 			is_animated_cache = false;
+			is_opaque_cache = false;
 			shader = NULL;
 			line_width = 1.0;
 			last_pass = 0;
@@ -579,6 +581,7 @@ public:
 
 	virtual bool material_is_animated(RID p_material);
 	virtual bool material_casts_shadows(RID p_material);
+	virtual bool material_is_opaque(RID p_material);
 
 	virtual void material_add_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance);
 	virtual void material_remove_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance);
@@ -670,6 +673,9 @@ public:
 
 		SelfList<MultiMesh>::List multimeshes;
 
+		Vector<RID> lods;
+		Vector<float> lod_screen_ratios;
+
 		_FORCE_INLINE_ void update_multimeshes() {
 			SelfList<MultiMesh> *mm = multimeshes.first();
 
@@ -724,6 +730,16 @@ public:
 	virtual AABB mesh_get_aabb(RID p_mesh, RID p_skeleton) const;
 	virtual void mesh_clear(RID p_mesh);
 
+	//vertex buffers also referenced by LOD surfaces, mapped to the amount of extra references
+	Map<GLuint, int> shared_vertex_buffers;
+	void _release_vertex_buffer(GLuint p_vertex_id);
+
+	virtual void mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count);
+	virtual void mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios);
+	virtual int mesh_get_lod_count(RID p_mesh) const;
+	virtual RID mesh_get_lod(RID p_mesh, int p_lod) const;
+	virtual float mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const;
+
 	/* MULTIMESH API */
 
 	struct MultiMesh : public GeometryOwner {
@@ -750,6 +766,7 @@ public:
 
 		bool dirty_aabb;
 		bool dirty_data;
+		bool compute_aabb;
 
 		MultiMesh() :
 				size(0),
@@ -763,7 +780,8 @@ public:
 				color_floats(0),
 				custom_data_floats(0),
 				dirty_aabb(true),
-				dirty_data(true) {
+				dirty_data(true),
+				compute_aabb(true) {
 		}
 	};
 
@@ -795,8 +813,9 @@ public:
 	virtual int multimesh_get_visible_instances(RID p_multimesh) const;
 
 	virtual AABB multimesh_get_aabb(RID p_multimesh) const;
+	virtual void multimesh_set_compute_aabb(RID p_multimesh, bool p_enable);
 
-	void update_dirty_multimeshes();
+	virtual void update_dirty_multimeshes();
 
 	/* IMMEDIATE API */
 
@@ -890,6 +909,7 @@ public:
 	virtual Transform skeleton_bone_get_transform(RID p_skeleton, int p_bone) const;
 	virtual void skeleton_bone_set_transform_2d(RID p_skeleton, int p_bone, const Transform2D &p_transform);
 	virtual Transform2D skeleton_bone_get_transform_2d(RID p_skeleton, int p_bone) const;
+	virtual void skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array);
 	virtual void skeleton_set_base_transform_2d(RID p_skeleton, const Transform2D &p_base_transform);
 	virtual void skeleton_set_world_transform(RID p_skeleton, bool p_enable, const Transform &p_world_transform);
 
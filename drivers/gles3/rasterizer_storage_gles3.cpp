@@ -2422,7 +2422,19 @@ void RasterizerStorageGLES3::material_set_next_pass(RID p_material, RID p_next_m
 	Material *material = material_owner.get(p_material);
 	ERR_FAIL_COND(!material);
 
+	if (material->next_pass == p_next_material)
+		return;
+
 	material->next_pass = p_next_material;
+
+	//instances only batch when every pass is opaque
+	for (Map<Geometry *, int>::Element *E = material->geometry_owners.front(); E; E = E->next()) {
+		E->key()->material_changed_notify();
+	}
+
+	for (Map<RasterizerScene::InstanceBase *, int>::Element *E = material->instance_owners.front(); E; E = E->next()) {
+		E->key()->base_changed(false, true);
+	}
 }
 
 bool RasterizerStorageGLES3::material_is_animated(RID p_material) {
@@ -2456,6 +2468,24 @@ bool RasterizerStorageGLES3::material_casts_shadows(RID p_material) {
 	return casts_shadows;
 }
 
+bool RasterizerStorageGLES3::material_is_opaque(RID p_material) {
+
+	Material *material = material_owner.get(p_material);
+	ERR_FAIL_COND_V(!material, false);
+	if (material->dirty_list.in_list()) {
+		_update_material(material);
+	}
+
+	//every pass has to be, they are drawn with the same instances
+	bool opaque = material->is_opaque_cache;
+
+	if (opaque && material->next_pass.is_valid()) {
+		opaque = material_is_opaque(material->next_pass);
+	}
+
+	return opaque;
+}
+
 void RasterizerStorageGLES3::material_add_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance) {
 
 	Material *material = material_owner.get(p_material);
@@ -2979,6 +3009,7 @@ void RasterizerStorageGLES3::_update_material(Material *material) {
 	{
 		bool can_cast_shadow = false;
 		bool is_animated = false;
+		bool is_opaque = false;
 
 		if (material->shader && material->shader->mode == VS::SHADER_SPATIAL) {
 
@@ -2987,6 +3018,15 @@ void RasterizerStorageGLES3::_update_material(Material *material) {
 				can_cast_shadow = true;
 			}
 
+			//what the scene renderer keeps out of the alpha pass
+			if (material->shader->spatial.blend_mode == Shader::Spatial::BLEND_MODE_MIX &&
+					(!material->shader->spatial.uses_alpha || material->shader->spatial.uses_alpha_scissor) &&
+					!material->shader->spatial.uses_screen_texture &&
+					!material->shader->spatial.uses_depth_texture &&
+					material->shader->spatial.depth_draw_mode != Shader::Spatial::DEPTH_DRAW_ALPHA_PREPASS) {
+				is_opaque = true;
+			}
+
 			if (material->shader->spatial.uses_discard && material->shader->uses_fragment_time) {
 				is_animated = true;
 			}
@@ -2995,9 +3035,10 @@ void RasterizerStorageGLES3::_update_material(Material *material) {
 				is_animated = true;
 			}
 
-			if (can_cast_shadow != material->can_cast_shadow_cache || is_animated != material->is_animated_cache) {
+			if (can_cast_shadow != material->can_cast_shadow_cache || is_animated != material->is_animated_cache || is_opaque != material->is_opaque_cache) {
 				material->can_cast_shadow_cache = can_cast_shadow;
 				material->is_animated_cache = is_animated;
+				material->is_opaque_cache = is_opaque;
 
 				for (Map<Geometry *, int>::Element *E = material->geometry_owners.front(); E; E = E->next()) {
 					E->key()->material_changed_notify();
@@ -3875,7 +3916,7 @@ void RasterizerStorageGLES3::mesh_remove_surface(RID p_mesh, int p_surface) {
 		_material_remove_geometry(surface->material, mesh->surfaces[p_surface]);
 	}
 
-	glDeleteBuffers(1, &surface->vertex_id);
+	_release_vertex_buffer(surface->vertex_id);
 	if (surface->index_id) {
 		glDeleteBuffers(1, &surface->index_id);
 	}
@@ -4055,6 +4096,160 @@ void RasterizerStorageGLES3::mesh_clear(RID p_mesh) {
 	}
 }
 
+void RasterizerStorageGLES3::_release_vertex_buffer(GLuint p_vertex_id) {
+
+	Map<GLuint, int>::Element *E = shared_vertex_buffers.find(p_vertex_id);
+	if (E) {
+		//still drawn by another surface, whichever goes last deletes it
+		E->get()--;
+		if (E->get() == 0) {
+			shared_vertex_buffers.erase(E);
+		}
+		return;
+	}
+
+	glDeleteBuffers(1, &p_vertex_id);
+}
+
+void RasterizerStorageGLES3::mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count) {
+
+	Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND(!mesh);
+	const Mesh *source_mesh = mesh_owner.getornull(p_source_mesh);
+	ERR_FAIL_COND(!source_mesh);
+	ERR_FAIL_INDEX(p_source_surface, source_mesh->surfaces.size());
+
+	const Surface *source = source_mesh->surfaces[p_source_surface];
+
+	int index_stride = source->array_len >= (1 << 16) ? 4 : 2;
+	ERR_FAIL_COND(p_index_array.size() != p_index_count * index_stride);
+
+	Surface *surface = memnew(Surface);
+
+	surface->active = true;
+	surface->array_len = source->array_len;
+	surface->index_array_len = p_index_count;
+	surface->array_byte_size = source->array_byte_size;
+	surface->index_array_byte_size = p_index_array.size();
+	surface->primitive = source->primitive;
+	surface->mesh = mesh;
+	surface->format = p_index_count ? source->format | VS::ARRAY_FORMAT_INDEX : source->format & ~VS::ARRAY_FORMAT_INDEX;
+	surface->skeleton_bone_aabb = source->skeleton_bone_aabb;
+	surface->skeleton_bone_used = source->skeleton_bone_used;
+	surface->aabb = source->aabb;
+	surface->max_bone = source->max_bone;
+	surface->total_data_size += surface->index_array_byte_size;
+
+	for (int i = 0; i < VS::ARRAY_MAX; i++) {
+		surface->attribs[i] = source->attribs[i];
+	}
+
+	Surface::Attrib &index_attrib = surface->attribs[VS::ARRAY_INDEX];
+	index_attrib.enabled = p_index_count > 0;
+	index_attrib.integer = false;
+	index_attrib.size = 1;
+	index_attrib.type = index_stride == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	index_attrib.stride = index_stride;
+	index_attrib.normalized = GL_FALSE;
+
+	//draw from the source vertices, only the indices of this level are uploaded
+	surface->vertex_id = source->vertex_id;
+	shared_vertex_buffers[source->vertex_id]++;
+
+	{
+		if (p_index_count) {
+
+			PoolVector<uint8_t>::Read ir = p_index_array.read();
+
+			glGenBuffers(1, &surface->index_id);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface->index_id);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, p_index_array.size(), ir.ptr(), GL_STATIC_DRAW);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); //unbind
+		}
+
+		for (int ai = 0; ai < 2; ai++) {
+
+			if (ai == 0) {
+				glGenVertexArrays(1, &surface->array_id);
+				glBindVertexArray(surface->array_id);
+			} else {
+				glGenVertexArrays(1, &surface->instancing_array_id);
+				glBindVertexArray(surface->instancing_array_id);
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, surface->vertex_id);
+
+			for (int i = 0; i < VS::ARRAY_MAX - 1; i++) {
+
+				const Surface::Attrib &attrib = surface->attribs[i];
+				if (!attrib.enabled)
+					continue;
+
+				if (attrib.integer) {
+					glVertexAttribIPointer(attrib.index, attrib.size, attrib.type, attrib.stride, ((uint8_t *)0) + attrib.offset);
+				} else {
+					glVertexAttribPointer(attrib.index, attrib.size, attrib.type, attrib.normalized, attrib.stride, ((uint8_t *)0) + attrib.offset);
+				}
+				glEnableVertexAttribArray(attrib.index);
+			}
+
+			if (surface->index_id) {
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface->index_id);
+			}
+
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0); //unbind
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		}
+	}
+
+	mesh->surfaces.push_back(surface);
+	mesh->instance_change_notify(true, true);
+
+	info.vertex_mem += surface->total_data_size;
+}
+
+void RasterizerStorageGLES3::mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios) {
+
+	Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND(!mesh);
+	ERR_FAIL_COND(p_lods.size() != p_screen_ratios.size());
+
+	for (int i = 1; i < p_screen_ratios.size(); i++) {
+		ERR_EXPLAIN("LOD screen ratios must be sorted from the most to the least detailed level.");
+		ERR_FAIL_COND(p_screen_ratios[i] > p_screen_ratios[i - 1]);
+	}
+
+	mesh->lods = p_lods;
+	mesh->lod_screen_ratios = p_screen_ratios;
+	mesh->instance_change_notify(true, true);
+}
+
+int RasterizerStorageGLES3::mesh_get_lod_count(RID p_mesh) const {
+
+	const Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND_V(!mesh, 0);
+
+	return mesh->lods.size();
+}
+
+RID RasterizerStorageGLES3::mesh_get_lod(RID p_mesh, int p_lod) const {
+
+	const Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND_V(!mesh, RID());
+	ERR_FAIL_INDEX_V(p_lod, mesh->lods.size(), RID());
+
+	return mesh->lods[p_lod];
+}
+
+float RasterizerStorageGLES3::mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const {
+
+	const Mesh *mesh = mesh_owner.getornull(p_mesh);
+	ERR_FAIL_COND_V(!mesh, 0);
+	ERR_FAIL_INDEX_V(p_lod, mesh->lods.size(), 0);
+
+	return mesh->lod_screen_ratios[p_lod];
+}
+
 void RasterizerStorageGLES3::mesh_render_blend_shapes(Surface *s, const float *p_weights) {
 
 	glBindVertexArray(s->array_id);
@@ -4738,6 +4933,24 @@ AABB RasterizerStorageGLES3::multimesh_get_aabb(RID p_multimesh) const {
 	return multimesh->aabb;
 }
 
+void RasterizerStorageGLES3::multimesh_set_compute_aabb(RID p_multimesh, bool p_enable) {
+
+	MultiMesh *multimesh = multimesh_owner.getornull(p_multimesh);
+	ERR_FAIL_COND(!multimesh);
+
+	if (multimesh->compute_aabb == p_enable) {
+		return;
+	}
+
+	multimesh->compute_aabb = p_enable;
+	multimesh->aabb = AABB();
+	multimesh->dirty_aabb = true;
+
+	if (!multimesh->update_list.in_list()) {
+		multimesh_update_list.add(&multimesh->update_list);
+	}
+}
+
 void RasterizerStorageGLES3::update_dirty_multimeshes() {
 
 	while (multimesh_update_list.first()) {
@@ -4751,7 +4964,7 @@ void RasterizerStorageGLES3::update_dirty_multimeshes() {
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
 		}
 
-		if (multimesh->size && multimesh->dirty_aabb) {
+		if (multimesh->size && multimesh->dirty_aabb && multimesh->compute_aabb) {
 
 			AABB mesh_aabb;
 
@@ -5133,6 +5346,33 @@ Transform2D RasterizerStorageGLES3::skeleton_bone_get_transform_2d(RID p_skeleto
 	return ret;
 }
 
+void RasterizerStorageGLES3::skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array) {
+
+	Skeleton *skeleton = skeleton_owner.getornull(p_skeleton);
+
+	ERR_FAIL_COND(!skeleton);
+	ERR_FAIL_COND(skeleton->use_2d);
+	ERR_FAIL_COND(p_array.size() != skeleton->size * 12);
+
+	PoolVector<float>::Read r = p_array.read();
+	const float *src = r.ptr();
+	float *texture = skeleton->skel_texture.ptrw();
+
+	//the texture stores the three rows of each block of 256 bones one after another
+	for (int i = 0; i < skeleton->size; i++) {
+
+		int base_ofs = ((i / 256) * 256) * 3 * 4 + (i % 256) * 4;
+
+		copymem(&texture[base_ofs], &src[i * 12 + 0], sizeof(float) * 4);
+		copymem(&texture[base_ofs + 256 * 4], &src[i * 12 + 4], sizeof(float) * 4);
+		copymem(&texture[base_ofs + 256 * 4 * 2], &src[i * 12 + 8], sizeof(float) * 4);
+	}
+
+	if (!skeleton->update_list.in_list()) {
+		skeleton_update_list.add(&skeleton->update_list);
+	}
+}
+
 void RasterizerStorageGLES3::skeleton_set_base_transform_2d(RID p_skeleton, const Transform2D &p_base_transform) {
 
 	Skeleton *skeleton = skeleton_owner.getornull(p_skeleton);
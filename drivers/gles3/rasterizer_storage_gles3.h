@@ -557,6 +557,7 @@ public:
 
 		bool can_cast_shadow_cache;
 		bool is_animated_cache;
+		bool is_opaque_cache;
 
 		Material() :
 				shader(NULL),
@@ -568,7 +569,8 @@ public:
 				render_priority(0),
 				last_pass(0),
 				can_cast_shadow_cache(false),
-				is_animated_cache(false) {
+				is_animated_cache(false),
+				is_opaque_cache(false) {
 		}
 	};
 
@@ -593,6 +595,7 @@ public:
 
 	virtual bool material_is_animated(RID p_material);
 	virtual bool material_casts_shadows(RID p_material);
+	virtual bool material_is_opaque(RID p_material);
 
 	virtual void material_add_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance);
 	virtual void material_remove_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance);
@@ -702,6 +705,8 @@ public:
 		AABB custom_aabb;
 		mutable uint64_t last_pass;
 		SelfList<MultiMesh>::List multimeshes;
+		Vector<RID> lods;
+		Vector<float> lod_screen_ratios;
 		_FORCE_INLINE_ void update_multimeshes() {
 
 			SelfList<MultiMesh> *mm = multimeshes.first();
@@ -758,6 +763,16 @@ public:
 	virtual AABB mesh_get_aabb(RID p_mesh, RID p_skeleton) const;
 	virtual void mesh_clear(RID p_mesh);
 
+	//vertex buffers also referenced by LOD surfaces, mapped to the amount of extra references
+	Map<GLuint, int> shared_vertex_buffers;
+	void _release_vertex_buffer(GLuint p_vertex_id);
+
+	virtual void mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count);
+	virtual void mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios);
+	virtual int mesh_get_lod_count(RID p_mesh) const;
+	virtual RID mesh_get_lod(RID p_mesh, int p_lod) const;
+	virtual float mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const;
+
 	void mesh_render_blend_shapes(Surface *s, const float *p_weights);
 
 	/* MULTIMESH API */
@@ -781,6 +796,7 @@ public:
 
 		bool dirty_aabb;
 		bool dirty_data;
+		bool compute_aabb;
 
 		MultiMesh() :
 				size(0),
@@ -795,7 +811,8 @@ public:
 				color_floats(0),
 				custom_data_floats(0),
 				dirty_aabb(true),
-				dirty_data(true) {
+				dirty_data(true),
+				compute_aabb(true) {
 		}
 	};
 
@@ -803,7 +820,7 @@ public:
 
 	SelfList<MultiMesh>::List multimesh_update_list;
 
-	void update_dirty_multimeshes();
+	virtual void update_dirty_multimeshes();
 
 	virtual RID multimesh_create();
 
@@ -829,6 +846,7 @@ public:
 	virtual int multimesh_get_visible_instances(RID p_multimesh) const;
 
 	virtual AABB multimesh_get_aabb(RID p_multimesh) const;
+	virtual void multimesh_set_compute_aabb(RID p_multimesh, bool p_enable);
 
 	/* IMMEDIATE API */
 
@@ -915,6 +933,7 @@ public:
 	virtual Transform skeleton_bone_get_transform(RID p_skeleton, int p_bone) const;
 	virtual void skeleton_bone_set_transform_2d(RID p_skeleton, int p_bone, const Transform2D &p_transform);
 	virtual Transform2D skeleton_bone_get_transform_2d(RID p_skeleton, int p_bone) const;
+	virtual void skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array);
 	virtual void skeleton_set_base_transform_2d(RID p_skeleton, const Transform2D &p_base_transform);
 	virtual void skeleton_set_world_transform(RID p_skeleton, bool p_enable, const Transform &p_world_transform);
 
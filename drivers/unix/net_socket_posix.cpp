@@ -156,6 +156,7 @@ void NetSocketPosix::make_default() {
 	}
 #endif
 	_create = _create_func;
+	NetSocketPollerPosix::make_default();
 }
 
 void NetSocketPosix::cleanup() {
@@ -279,6 +280,8 @@ Error NetSocketPosix::open(Type p_sock_type, IP::Type &ip_type) {
 
 void NetSocketPosix::close() {
 
+	_unwatch();
+
 	if (_sock != SOCK_EMPTY)
 		SOCK_CLOSE(_sock);
 
@@ -511,6 +514,100 @@ Error NetSocketPosix::sendto(const uint8_t *p_buffer, int p_len, int &r_sent, IP
 	return OK;
 }
 
+#ifdef NET_SOCKET_HAS_MMSG
+Error NetSocketPosix::recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_received) {
+	ERR_FAIL_COND_V(!is_open(), ERR_UNCONFIGURED);
+
+	struct mmsghdr msgs[MMSG_BATCH_SIZE];
+	struct iovec iovs[MMSG_BATCH_SIZE];
+	struct sockaddr_storage from[MMSG_BATCH_SIZE];
+
+	r_received = 0;
+	while (r_received < p_count) {
+
+		int count = MIN(p_count - r_received, (int)MMSG_BATCH_SIZE);
+		for (int i = 0; i < count; i++) {
+			Datagram &d = r_datagrams[r_received + i];
+			iovs[i].iov_base = d.buffer;
+			iovs[i].iov_len = d.buffer_size;
+			memset(&msgs[i].msg_hdr, 0, sizeof(struct msghdr));
+			msgs[i].msg_hdr.msg_name = &from[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		// MSG_TRUNC makes msg_len the real datagram size, so cut ones can be told apart.
+		int ret = ::recvmmsg(_sock, msgs, count, MSG_WAITFORONE | MSG_TRUNC, NULL);
+		if (ret < 0) {
+			if (r_received)
+				return OK;
+
+			NetError err = _get_socket_error();
+			if (err == ERR_NET_WOULD_BLOCK)
+				return ERR_BUSY;
+
+			return FAILED;
+		}
+
+		for (int i = 0; i < ret; i++) {
+			Datagram &d = r_datagrams[r_received + i];
+			d.size = msgs[i].msg_len;
+			_set_ip_port(&from[i], d.ip, d.port);
+		}
+		r_received += ret;
+
+		if (ret < count)
+			break; // Drained.
+	}
+
+	return OK;
+}
+
+Error NetSocketPosix::sendto_batch(const Datagram *p_datagrams, int p_count, int &r_sent) {
+	ERR_FAIL_COND_V(!is_open(), ERR_UNCONFIGURED);
+
+	struct mmsghdr msgs[MMSG_BATCH_SIZE];
+	struct iovec iovs[MMSG_BATCH_SIZE];
+	struct sockaddr_storage to[MMSG_BATCH_SIZE];
+
+	r_sent = 0;
+	while (r_sent < p_count) {
+
+		int count = MIN(p_count - r_sent, (int)MMSG_BATCH_SIZE);
+		for (int i = 0; i < count; i++) {
+			const Datagram &d = p_datagrams[r_sent + i];
+			iovs[i].iov_base = d.buffer;
+			iovs[i].iov_len = d.size;
+			memset(&msgs[i].msg_hdr, 0, sizeof(struct msghdr));
+			msgs[i].msg_hdr.msg_name = &to[i];
+			msgs[i].msg_hdr.msg_namelen = _set_addr_storage(&to[i], d.ip, d.port, _ip_type);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		int ret = ::sendmmsg(_sock, msgs, count, 0);
+		if (ret < 0) {
+			if (r_sent)
+				return OK;
+
+			NetError err = _get_socket_error();
+			if (err == ERR_NET_WOULD_BLOCK)
+				return ERR_BUSY;
+
+			return FAILED;
+		}
+
+		r_sent += ret;
+
+		if (ret < count)
+			break; // Send buffer full.
+	}
+
+	return OK;
+}
+#endif
+
 void NetSocketPosix::set_broadcasting_enabled(bool p_enabled) {
 	ERR_FAIL_COND(!is_open());
 	// IPv6 has no broadcast support.
@@ -583,6 +680,24 @@ void NetSocketPosix::set_reuse_port_enabled(bool p_enabled) {
 #endif
 }
 
+void NetSocketPosix::set_recv_buffer_size(int p_bytes) {
+	ERR_FAIL_COND(!is_open());
+	ERR_FAIL_COND(p_bytes <= 0);
+
+	if (setsockopt(_sock, SOL_SOCKET, SO_RCVBUF, SOCK_CBUF(&p_bytes), sizeof(int)) != 0) {
+		WARN_PRINT("Unable to change socket receive buffer size");
+	}
+}
+
+void NetSocketPosix::set_send_buffer_size(int p_bytes) {
+	ERR_FAIL_COND(!is_open());
+	ERR_FAIL_COND(p_bytes <= 0);
+
+	if (setsockopt(_sock, SOL_SOCKET, SO_SNDBUF, SOCK_CBUF(&p_bytes), sizeof(int)) != 0) {
+		WARN_PRINT("Unable to change socket send buffer size");
+	}
+}
+
 bool NetSocketPosix::is_open() const {
 	return _sock != SOCK_EMPTY;
 }
@@ -614,3 +729,165 @@ Ref<NetSocket> NetSocketPosix::accept(IP_Address &r_ip, uint16_t &r_port) {
 	ns->set_blocking_enabled(false);
 	return Ref<NetSocket>(ns);
 }
+
+NetSocketPoller *NetSocketPollerPosix::_create_func() {
+	return memnew(NetSocketPollerPosix);
+}
+
+void NetSocketPollerPosix::make_default() {
+	_create = _create_func;
+}
+
+#ifdef NET_SOCKET_HAS_EPOLL
+static uint32_t _to_epoll_events(int p_events) {
+	uint32_t events = 0;
+	if (p_events & NetSocketPoller::EVENT_IN)
+		events |= EPOLLIN;
+	if (p_events & NetSocketPoller::EVENT_OUT)
+		events |= EPOLLOUT;
+	return events;
+}
+
+Error NetSocketPollerPosix::_add(NetSocket *p_sock, int p_events) {
+	ERR_FAIL_COND_V(_epoll < 0, ERR_UNCONFIGURED);
+
+	struct epoll_event ev;
+	ev.events = _to_epoll_events(p_events);
+	ev.data.ptr = p_sock;
+	if (epoll_ctl(_epoll, EPOLL_CTL_ADD, static_cast<NetSocketPosix *>(p_sock)->_sock, &ev) != 0) {
+		ERR_FAIL_V(FAILED);
+	}
+
+	return OK;
+}
+
+Error NetSocketPollerPosix::_modify(NetSocket *p_sock, int p_events) {
+	ERR_FAIL_COND_V(_epoll < 0, ERR_UNCONFIGURED);
+
+	struct epoll_event ev;
+	ev.events = _to_epoll_events(p_events);
+	ev.data.ptr = p_sock;
+	if (epoll_ctl(_epoll, EPOLL_CTL_MOD, static_cast<NetSocketPosix *>(p_sock)->_sock, &ev) != 0) {
+		ERR_FAIL_V(FAILED);
+	}
+
+	return OK;
+}
+
+void NetSocketPollerPosix::_remove(NetSocket *p_sock) {
+	// Pointer needed by kernels older than 2.6.9 even if ignored.
+	struct epoll_event ev;
+	epoll_ctl(_epoll, EPOLL_CTL_DEL, static_cast<NetSocketPosix *>(p_sock)->_sock, &ev);
+}
+
+Error NetSocketPollerPosix::_wait(int p_timeout) {
+	ERR_FAIL_COND_V(_epoll < 0, ERR_UNCONFIGURED);
+
+	// One call per wait(), level triggered sockets left out when more than
+	// MAX_EVENTS are ready are reported again by the next one.
+	int max_events = CLAMP(sockets.size(), 1, (int)MAX_EVENTS);
+	if (events.size() < max_events)
+		events.resize(max_events);
+
+	int ret = epoll_wait(_epoll, events.ptrw(), max_events, p_timeout);
+
+	if (ret < 0) {
+		if (errno == EINTR)
+			return OK;
+		ERR_FAIL_V(FAILED);
+	}
+
+	for (int i = 0; i < ret; i++) {
+		uint32_t ev = events[i].events;
+		int ready = 0;
+		if (ev & EPOLLIN)
+			ready |= EVENT_IN;
+		if (ev & EPOLLOUT)
+			ready |= EVENT_OUT;
+		if (ev & (EPOLLERR | EPOLLHUP))
+			ready |= EVENT_ERROR;
+		_set_ready((NetSocket *)events[i].data.ptr, ready);
+	}
+
+	return OK;
+}
+
+NetSocketPollerPosix::NetSocketPollerPosix() {
+	_epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (_epoll < 0)
+		ERR_PRINT("Unable to create epoll instance");
+}
+
+NetSocketPollerPosix::~NetSocketPollerPosix() {
+	if (_epoll >= 0)
+		::close(_epoll);
+}
+
+#else
+static short _to_poll_events(int p_events) {
+	short events = 0;
+	if (p_events & NetSocketPoller::EVENT_IN)
+		events |= POLLIN;
+	if (p_events & NetSocketPoller::EVENT_OUT)
+		events |= POLLOUT;
+	return events;
+}
+
+Error NetSocketPollerPosix::_add(NetSocket *p_sock, int p_events) {
+	struct pollfd pfd;
+	pfd.fd = static_cast<NetSocketPosix *>(p_sock)->_sock;
+	pfd.events = _to_poll_events(p_events);
+	pfd.revents = 0;
+	fds.push_back(pfd);
+	return OK;
+}
+
+Error NetSocketPollerPosix::_modify(NetSocket *p_sock, int p_events) {
+	fds.write[_get_index(p_sock)].events = _to_poll_events(p_events);
+	return OK;
+}
+
+void NetSocketPollerPosix::_remove(NetSocket *p_sock) {
+	int index = _get_index(p_sock);
+	int last = fds.size() - 1;
+	if (index != last)
+		fds.write[index] = fds[last];
+	fds.resize(last);
+}
+
+Error NetSocketPollerPosix::_wait(int p_timeout) {
+#if defined(WINDOWS_ENABLED)
+	int ret = WSAPoll(fds.ptrw(), fds.size(), p_timeout);
+	ERR_FAIL_COND_V(ret == SOCKET_ERROR, FAILED);
+#else
+	int ret = ::poll(fds.ptrw(), fds.size(), p_timeout);
+	if (ret < 0 && errno == EINTR)
+		return OK;
+	ERR_FAIL_COND_V(ret < 0, FAILED);
+#endif
+
+	for (int i = 0; i < fds.size() && ret > 0; i++) {
+		short ev = fds[i].revents;
+		if (!ev)
+			continue;
+
+		int ready = 0;
+		if (ev & POLLIN)
+			ready |= EVENT_IN;
+		if (ev & POLLOUT)
+			ready |= EVENT_OUT;
+		if (ev & (POLLERR | POLLHUP | POLLNVAL))
+			ready |= EVENT_ERROR;
+		_set_ready(sockets[i], ready);
+		ret--;
+	}
+
+	return OK;
+}
+
+NetSocketPollerPosix::NetSocketPollerPosix() {
+}
+
+NetSocketPollerPosix::~NetSocketPollerPosix() {
+}
+#endif
@@ -42,15 +42,35 @@
 #include <sys/socket.h>
 #define SOCKET_TYPE int
 
+// recvmmsg()/sendmmsg(), one syscall for a whole batch of datagrams.
+#if defined(__linux__) && !defined(ANDROID_ENABLED) && !defined(JAVASCRIPT_ENABLED)
+#define NET_SOCKET_HAS_MMSG
+#endif
+
+#if defined(__linux__) && !defined(JAVASCRIPT_ENABLED)
+#define NET_SOCKET_HAS_EPOLL
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
 #endif
 
 class NetSocketPosix : public NetSocket {
 
+	friend class NetSocketPollerPosix;
+
 private:
 	SOCKET_TYPE _sock;
 	IP::Type _ip_type;
 	bool _is_stream;
 
+#ifdef NET_SOCKET_HAS_MMSG
+	enum {
+		MMSG_BATCH_SIZE = 64
+	};
+#endif
+
 	enum NetError {
 		ERR_NET_WOULD_BLOCK,
 		ERR_NET_IS_CONNECTED,
@@ -83,6 +103,10 @@ public:
 	virtual Error send(const uint8_t *p_buffer, int p_len, int &r_sent);
 	virtual Error sendto(const uint8_t *p_buffer, int p_len, int &r_sent, IP_Address p_ip, uint16_t p_port);
 	virtual Ref<NetSocket> accept(IP_Address &r_ip, uint16_t &r_port);
+#ifdef NET_SOCKET_HAS_MMSG
+	virtual Error recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_received);
+	virtual Error sendto_batch(const Datagram *p_datagrams, int p_count, int &r_sent);
+#endif
 
 	virtual bool is_open() const;
 	virtual int get_available_bytes() const;
@@ -93,9 +117,40 @@ public:
 	virtual void set_tcp_no_delay_enabled(bool p_enabled);
 	virtual void set_reuse_address_enabled(bool p_enabled);
 	virtual void set_reuse_port_enabled(bool p_enabled);
+	virtual void set_recv_buffer_size(int p_bytes);
+	virtual void set_send_buffer_size(int p_bytes);
 
 	NetSocketPosix();
 	~NetSocketPosix();
 };
 
+// epoll on Linux, poll() (WSAPoll() on Windows) elsewhere.
+class NetSocketPollerPosix : public NetSocketPoller {
+
+#ifdef NET_SOCKET_HAS_EPOLL
+	enum {
+		MAX_EVENTS = 1024
+	};
+
+	int _epoll;
+	Vector<struct epoll_event> events;
+#else
+	Vector<struct pollfd> fds;
+#endif
+
+protected:
+	static NetSocketPoller *_create_func();
+
+	virtual Error _add(NetSocket *p_sock, int p_events);
+	virtual Error _modify(NetSocket *p_sock, int p_events);
+	virtual void _remove(NetSocket *p_sock);
+	virtual Error _wait(int p_timeout);
+
+public:
+	static void make_default();
+
+	NetSocketPollerPosix();
+	~NetSocketPollerPosix();
+};
+
 #endif
@@ -199,6 +199,9 @@ bool ResourceImporterScene::get_option_visibility(const String &p_option, const
 		if (p_option.begins_with("animation/optimizer/") && p_option != "animation/optimizer/enabled" && !bool(p_options["animation/optimizer/enabled"]))
 			return false;
 
+		if (p_option.begins_with("animation/compression/") && p_option != "animation/compression/enabled" && !bool(p_options["animation/compression/enabled"]))
+			return false;
+
 		if (p_option.begins_with("animation/clip_")) {
 			int max_clip = p_options["animation/clips/amount"];
 			int clip = p_option.get_slice("/", 1).get_slice("_", 1).to_int() - 1;
@@ -865,6 +868,24 @@ void ResourceImporterScene::_optimize_animations(Node *scene, float p_max_lin_er
 	}
 }
 
+void ResourceImporterScene::_compress_animations(Node *scene, float p_frame_rate, float p_max_lin_error, float p_max_ang_error) {
+
+	if (!scene->has_node(String("AnimationPlayer")))
+		return;
+	Node *n = scene->get_node(String("AnimationPlayer"));
+	ERR_FAIL_COND(!n);
+	AnimationPlayer *anim = Object::cast_to<AnimationPlayer>(n);
+	ERR_FAIL_COND(!anim);
+
+	List<StringName> anim_names;
+	anim->get_animation_list(&anim_names);
+	for (List<StringName>::Element *E = anim_names.front(); E; E = E->next()) {
+
+		Ref<Animation> a = anim->get_animation(E->get());
+		a->compress(p_frame_rate, p_max_lin_error, p_max_ang_error);
+	}
+}
+
 static String _make_extname(const String &p_str) {
 
 	String ext_name = p_str.replace(".", "_");
@@ -1089,6 +1110,7 @@ void ResourceImporterScene::get_import_options(List<ImportOption> *r_options, in
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/storage", PROPERTY_HINT_ENUM, "Built-In,Files"), meshes_out ? 1 : 0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/light_baking", PROPERTY_HINT_ENUM, "Disabled,Enable,Gen Lightmaps", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "meshes/lightmap_texel_size", PROPERTY_HINT_RANGE, "0.001,100,0.001"), 0.1));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/generate_lods"), false));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "external_files/store_in_subdir"), false));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "animation/import", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), true));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/fps", PROPERTY_HINT_RANGE, "1,120,1"), 15));
@@ -1100,6 +1122,10 @@ void ResourceImporterScene::get_import_options(List<ImportOption> *r_options, in
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/optimizer/max_angular_error"), 0.01));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/optimizer/max_angle"), 22));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "animation/optimizer/remove_unused_tracks"), true));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "animation/compression/enabled", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), false));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/compression/fps", PROPERTY_HINT_RANGE, "1,120,1"), 30));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/compression/max_linear_error"), 0.001));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::REAL, "animation/compression/max_angular_error"), 0.005));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "animation/clips/amount", PROPERTY_HINT_RANGE, "0,256,1", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 0));
 	for (int i = 0; i < 256; i++) {
 		r_options->push_back(ImportOption(PropertyInfo(Variant::STRING, "animation/clip_" + itos(i + 1) + "/name"), ""));
@@ -1301,6 +1327,10 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 		_filter_tracks(scene, animation_filter);
 	}
 
+	if (bool(p_options["animation/compression/enabled"])) {
+		_compress_animations(scene, p_options["animation/compression/fps"], p_options["animation/compression/max_linear_error"], p_options["animation/compression/max_angular_error"]);
+	}
+
 	bool external_animations = int(p_options["animation/storage"]) == 1;
 	bool keep_custom_tracks = p_options["animation/keep_custom_tracks"];
 	bool external_materials = p_options["materials/storage"];
@@ -1321,7 +1351,9 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 		}
 	}
 
-	if (light_bake_mode == 2 /* || generate LOD */) {
+	bool generate_lods = p_options["meshes/generate_lods"];
+
+	if (light_bake_mode == 2 || generate_lods) {
 
 		Map<Ref<ArrayMesh>, Transform> meshes;
 		_find_meshes(scene, meshes);
@@ -1350,6 +1382,28 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 				step++;
 			}
 		}
+
+		//after unwrapping, which rebuilds the surfaces
+		if (generate_lods) {
+
+			EditorProgress progress2("gen_lods", TTR("Generating LODs"), meshes.size());
+			int step = 0;
+			for (Map<Ref<ArrayMesh>, Transform>::Element *E = meshes.front(); E; E = E->next()) {
+
+				Ref<ArrayMesh> mesh = E->key();
+				String name = mesh->get_name();
+				if (name == "") {
+					name = "Mesh " + itos(step);
+				}
+
+				progress2.step(TTR("Generating for Mesh: ") + name + " (" + itos(step) + "/" + itos(meshes.size()) + ")", step);
+
+				if (mesh->get_blend_shape_count() == 0) {
+					mesh->generate_lods();
+				}
+				step++;
+			}
+		}
 	}
 
 	if (external_animations || external_materials || external_meshes) {
@@ -64,6 +64,7 @@
 #include "scene/main/viewport.h"
 #include "scene/register_scene_types.h"
 #include "scene/resources/packed_scene.h"
+#include "scene/resources/texture_streamer.h"
 #include "servers/arvr_server.h"
 #include "servers/audio_server.h"
 #include "servers/physics_2d_server.h"
@@ -1884,6 +1885,10 @@ bool Main::iteration() {
 	OS::get_singleton()->get_main_loop()->idle(step * time_scale);
 	message_queue->flush();
 
+	if (TextureStreamer::get_singleton()) {
+		TextureStreamer::get_singleton()->process(); //upload streamed mipmaps before drawing
+	}
+
 	VisualServer::get_singleton()->sync(); //sync if still drawing from previous frames.
 
 	if (OS::get_singleton()->can_draw() && !disable_render_loop) {
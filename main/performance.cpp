@@ -72,6 +72,7 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RENDER_INSTANCES_BATCHED_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -109,6 +110,7 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"raster/instances_batched",
 
 	};
 
@@ -153,6 +155,7 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+		case RENDER_INSTANCES_BATCHED_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_INSTANCES_BATCHED_IN_FRAME);
 
 		default: {}
 	}
@@ -193,6 +196,7 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -78,6 +78,7 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		RENDER_INSTANCES_BATCHED_IN_FRAME,
 		MONITOR_MAX
 	};
 
@@ -0,0 +1,268 @@
+/*************************************************************************/
+/*  test_animation.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_animation.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "scene/3d/skeleton.h"
+#include "scene/animation/animation_blend_tree.h"
+#include "scene/animation/animation_player.h"
+#include "scene/animation/animation_tree.h"
+#include "scene/resources/animation.h"
+
+// Sampling and blending benchmarks for transform tracks, run with:
+// godot_server --test animation
+
+namespace TestAnimation {
+
+enum {
+	TRACK_COUNT = 1000,
+	KEY_RATE = 30,
+	PLAYBACK_RATE = 60,
+	RIG_BONES = 100,
+	RIG_ANIMATIONS = 10
+};
+
+static Ref<Animation> _create_mocap_animation(float p_length) {
+
+	Ref<Animation> anim;
+	anim.instance();
+	anim->set_length(p_length);
+	anim->set_loop(true);
+
+	RandomPCG rng(1234);
+	int key_count = int(p_length * KEY_RATE) + 1;
+
+	for (int i = 0; i < TRACK_COUNT; i++) {
+
+		int track = anim->add_track(Animation::TYPE_TRANSFORM);
+		anim->track_set_path(track, NodePath("Skeleton:bone" + itos(i)));
+
+		//a few slow waves plus some sensor noise, like captured motion
+		Vector3 freq(rng.randf() * 2.0, rng.randf() * 2.0, rng.randf() * 2.0);
+		Vector3 phase(rng.randf() * Math_PI, rng.randf() * Math_PI, rng.randf() * Math_PI);
+		Vector3 offset(rng.randf(), rng.randf() + 1.0, rng.randf());
+
+		for (int j = 0; j < key_count; j++) {
+
+			float t = float(j) / KEY_RATE;
+			Vector3 wave(Math::sin(t * freq.x + phase.x), Math::sin(t * freq.y + phase.y), Math::sin(t * freq.z + phase.z));
+			Vector3 noise(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5);
+
+			Vector3 loc = offset + wave * 0.1 + noise * 0.0005;
+			Quat rot(Vector3(wave.x * 0.8, wave.y * 0.5 + noise.x * 0.001, wave.z * 0.3));
+			anim->transform_track_insert_key(track, t, loc, rot, Vector3(1, 1, 1));
+		}
+	}
+
+	return anim;
+}
+
+static int _get_storage_size(const Ref<Animation> &p_anim) {
+
+	int size = 0;
+	for (int i = 0; i < p_anim->get_track_count(); i++) {
+
+		if (p_anim->track_is_compressed(i)) {
+			PoolVector<uint8_t> data = p_anim->get("tracks/" + itos(i) + "/compressed");
+			size += data.size();
+		} else {
+			PoolVector<real_t> keys = p_anim->get("tracks/" + itos(i) + "/keys");
+			size += keys.size() * sizeof(real_t);
+		}
+	}
+	return size;
+}
+
+static uint64_t _time_playback(const Ref<Animation> &p_anim, bool p_use_cursors) {
+
+	Vector<int> cursors;
+	cursors.resize(p_anim->get_track_count());
+	for (int i = 0; i < cursors.size(); i++) {
+		cursors.write[i] = 0;
+	}
+
+	int frames = int(p_anim->get_length() * PLAYBACK_RATE);
+	Vector3 loc;
+	Quat rot;
+	Vector3 scale;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < frames; i++) {
+
+		float time = float(i) / PLAYBACK_RATE;
+		for (int j = 0; j < p_anim->get_track_count(); j++) {
+			p_anim->transform_track_interpolate(j, time, &loc, &rot, &scale, p_use_cursors ? &cursors.write[j] : NULL);
+		}
+	}
+	return (OS::get_singleton()->get_ticks_usec() - begin) / frames;
+}
+
+static void _benchmark_compressed_tracks() {
+
+	OS::get_singleton()->print("\n*** compressed transform tracks, %d tracks ***\n", int(TRACK_COUNT));
+
+	float length = 20.0;
+	Ref<Animation> anim = _create_mocap_animation(length);
+	Ref<Animation> compressed = _create_mocap_animation(length);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	compressed->compress();
+	uint64_t compress_time = OS::get_singleton()->get_ticks_usec() - begin;
+
+	int keys = 0;
+	int compressed_keys = 0;
+	for (int i = 0; i < TRACK_COUNT; i++) {
+		keys += anim->track_get_key_count(i);
+		compressed_keys += compressed->track_get_key_count(i);
+	}
+
+	OS::get_singleton()->print("keys: %d -> %d, stored bytes: %d -> %d, compressed in %d msec\n", keys, compressed_keys, _get_storage_size(anim), _get_storage_size(compressed), int(compress_time / 1000));
+
+	//error against the original, sampled between frames
+	float max_loc_error = 0;
+	float max_rot_error = 0;
+	for (int i = 0; i < TRACK_COUNT; i += 10) {
+		for (float t = 0; t < length; t += 1.0 / 97.0) {
+
+			Vector3 loc[2];
+			Quat rot[2];
+			anim->transform_track_interpolate(i, t, &loc[0], &rot[0], NULL);
+			compressed->transform_track_interpolate(i, t, &loc[1], &rot[1], NULL);
+
+			max_loc_error = MAX(max_loc_error, loc[0].distance_to(loc[1]));
+			max_rot_error = MAX(max_rot_error, 2.0 * Math::acos(MIN(1.0, Math::abs(rot[0].dot(rot[1])))));
+		}
+	}
+	OS::get_singleton()->print("max error: location %f, rotation %f rad\n", max_loc_error, max_rot_error);
+
+	OS::get_singleton()->print("sampling all tracks at %d fps, usec per frame:\n", int(PLAYBACK_RATE));
+	OS::get_singleton()->print("\tkeys: %d, keys with cursor: %d\n", int(_time_playback(anim, false)), int(_time_playback(anim, true)));
+	OS::get_singleton()->print("\tcompressed: %d, compressed with cursor: %d\n", int(_time_playback(compressed, false)), int(_time_playback(compressed, true)));
+}
+
+static float _time_blend_tree(AnimationTree *p_tree, float p_blend_amount) {
+
+	for (int i = 0; i < RIG_ANIMATIONS - 1; i++) {
+		p_tree->set("parameters/blend" + itos(i) + "/blend_amount", p_blend_amount);
+	}
+
+	p_tree->advance(0);
+
+	int frames = 10 * PLAYBACK_RATE;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < frames; i++) {
+		p_tree->advance(1.0 / PLAYBACK_RATE);
+	}
+	return float(OS::get_singleton()->get_ticks_usec() - begin) / frames;
+}
+
+static void _benchmark_blend_tree() {
+
+	OS::get_singleton()->print("\n*** blend tree, %d bones, %d nodes ***\n", int(RIG_BONES), int(RIG_ANIMATIONS * 2));
+
+	Node *root = memnew(Node);
+
+	Skeleton *skeleton = memnew(Skeleton);
+	skeleton->set_name("Skeleton");
+	root->add_child(skeleton);
+	for (int i = 0; i < RIG_BONES; i++) {
+		skeleton->add_bone("bone" + itos(i));
+		skeleton->set_bone_parent(i, i - 1);
+	}
+
+	AnimationPlayer *player = memnew(AnimationPlayer);
+	player->set_name("AnimationPlayer");
+	root->add_child(player);
+
+	Ref<AnimationNodeBlendTree> blend_tree;
+	blend_tree.instance();
+
+	for (int i = 0; i < RIG_ANIMATIONS; i++) {
+
+		Ref<Animation> anim;
+		anim.instance();
+		anim->set_length(2.0);
+		anim->set_loop(true);
+
+		for (int j = 0; j < RIG_BONES; j++) {
+
+			int track = anim->add_track(Animation::TYPE_TRANSFORM);
+			anim->track_set_path(track, NodePath("Skeleton:bone" + itos(j)));
+
+			for (int k = 0; k <= 2 * KEY_RATE; k++) {
+				float phase = float(k) / KEY_RATE + i * 0.3 + j * 0.1;
+				anim->transform_track_insert_key(track, float(k) / KEY_RATE, Vector3(Math::sin(phase), Math::cos(phase), 0) * 0.1, Quat(Vector3(0, 1, 0), phase), Vector3(1, 1, 1));
+			}
+		}
+
+		String name = "anim" + itos(i);
+		player->add_animation(name, anim);
+
+		Ref<AnimationNodeAnimation> node;
+		node.instance();
+		node->set_animation(name);
+		blend_tree->add_node(name, node);
+	}
+
+	//a chain of blend2 nodes, each mixing one more animation in
+	for (int i = 0; i < RIG_ANIMATIONS - 1; i++) {
+
+		Ref<AnimationNodeBlend2> node;
+		node.instance();
+		String name = "blend" + itos(i);
+		blend_tree->add_node(name, node);
+		blend_tree->connect_node(name, 0, i == 0 ? String("anim0") : "blend" + itos(i - 1));
+		blend_tree->connect_node(name, 1, "anim" + itos(i + 1));
+	}
+	blend_tree->connect_node("output", 0, "blend" + itos(RIG_ANIMATIONS - 2));
+
+	AnimationTree *tree = memnew(AnimationTree);
+	root->add_child(tree);
+	tree->set_process_mode(AnimationTree::ANIMATION_PROCESS_MANUAL);
+	tree->set_tree_root(blend_tree);
+	tree->set_animation_player(NodePath("../AnimationPlayer"));
+
+	OS::get_singleton()->print("usec per frame, all nodes blending: %.1f\n", _time_blend_tree(tree, 0.5));
+	OS::get_singleton()->print("usec per frame, only one animation weighted: %.1f\n", _time_blend_tree(tree, 0.0));
+
+	memdelete(root);
+}
+
+MainLoop *test() {
+
+	_benchmark_compressed_tracks();
+	_benchmark_blend_tree();
+
+	return NULL;
+}
+}
@@ -0,0 +1,139 @@
+/*************************************************************************/
+/*  test_cpu_particles.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_cpu_particles.h"
+
+#include "core/os/os.h"
+#include "scene/2d/cpu_particles_2d.h"
+#include "scene/3d/cpu_particles.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+// Headless particle simulation benchmark, run with:
+// godot_server --test cpu_particles
+
+namespace TestCPUParticles {
+
+enum {
+	EMITTER_COUNT = 4,
+	PARTICLES_PER_EMITTER = 25000,
+	WARMUP_FRAMES = 60,
+	MEASURED_FRAMES = 300
+};
+
+class TestMainLoop : public SceneTree {
+
+	int phase;
+	int frame;
+	uint64_t elapsed;
+	Vector<Node *> emitters;
+
+	void _create_emitters() {
+
+		for (int i = 0; i < EMITTER_COUNT; i++) {
+
+			Node *emitter;
+
+			if (phase == 0) {
+				CPUParticles *particles = memnew(CPUParticles);
+				particles->set_amount(PARTICLES_PER_EMITTER);
+				particles->set_lifetime(2.0);
+				particles->set_emission_shape(CPUParticles::EMISSION_SHAPE_SPHERE);
+				particles->set_param(CPUParticles::PARAM_DAMPING, 0.5);
+				particles->set_param(CPUParticles::PARAM_ANGULAR_VELOCITY, 90);
+				particles->set_particle_flag(CPUParticles::FLAG_ALIGN_Y_TO_VELOCITY, true);
+				particles->set_translation(Vector3(i * 4, 0, 0));
+				emitter = particles;
+			} else {
+				CPUParticles2D *particles = memnew(CPUParticles2D);
+				particles->set_amount(PARTICLES_PER_EMITTER);
+				particles->set_lifetime(2.0);
+				particles->set_emission_shape(CPUParticles2D::EMISSION_SHAPE_CIRCLE);
+				particles->set_param(CPUParticles2D::PARAM_DAMPING, 0.5);
+				particles->set_param(CPUParticles2D::PARAM_ANGULAR_VELOCITY, 90);
+				particles->set_position(Vector2(i * 64, 0));
+				emitter = particles;
+			}
+
+			get_root()->add_child(emitter);
+			emitters.push_back(emitter);
+		}
+
+		frame = 0;
+		elapsed = 0;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		OS::get_singleton()->print("*** cpu particles, %d emitters with %d particles, %d worker threads ***\n", int(EMITTER_COUNT), int(PARTICLES_PER_EMITTER), int(get_work_pool()->get_thread_count()));
+
+		phase = 0;
+		_create_emitters();
+	}
+
+	virtual bool idle(float p_time) {
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		bool quit = SceneTree::idle(p_time);
+		if (frame >= WARMUP_FRAMES) {
+			elapsed += OS::get_singleton()->get_ticks_usec() - begin;
+		}
+
+		frame++;
+		if (frame < WARMUP_FRAMES + MEASURED_FRAMES) {
+			return quit;
+		}
+
+		OS::get_singleton()->print("%s: %d usec per frame\n", phase == 0 ? "CPUParticles" : "CPUParticles2D", int(elapsed / MEASURED_FRAMES));
+
+		for (int i = 0; i < emitters.size(); i++) {
+			emitters[i]->queue_delete();
+		}
+		emitters.clear();
+
+		phase++;
+		if (phase == 2) {
+			return true;
+		}
+
+		_create_emitters();
+		return quit;
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestCPUParticles
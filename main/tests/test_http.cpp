@@ -0,0 +1,567 @@
+/*************************************************************************/
+/*  test_http.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_http.h"
+
+#include "core/io/http_client.h"
+#include "core/io/tcp_server.h"
+#include "core/message_queue.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "scene/main/http_request.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+// Download throughput and memory of HTTPClient and HTTPRequest against a
+// minimal HTTP/1.1 server on loopback, plus keep-alive reuse and range
+// resume. Run with:
+// godot_server --test http
+
+namespace TestHTTP {
+
+enum {
+	PORT = 47125,
+	FILE_SIZE = 64 * 1024 * 1024,
+	SMALL_SIZE = 1024,
+	SMALL_REQUESTS = 200,
+	SEND_SIZE = 64 * 1024
+};
+
+static uint8_t _file_byte(int p_offset) {
+
+	return (p_offset * 7 + (p_offset >> 12)) & 0xFF;
+}
+
+// Stand-in for the asset CDN, serving one connection at a time on its own
+// thread. Connections are kept alive unless the client closes them.
+//   /file     FILE_SIZE bytes, honours "Range: bytes=N-"
+//   /cut      the same, but drops the connection halfway through the body
+//   /chunked  the same with chunked transfer encoding
+//   /small    SMALL_SIZE bytes
+//   /drop     closes the connection without answering
+class StandInServer {
+
+	Ref<TCP_Server> server;
+	Thread *thread;
+	volatile bool quit;
+	PoolByteArray content;
+
+	static void _thread_func(void *p_userdata) {
+
+		StandInServer *self = (StandInServer *)p_userdata;
+		while (!self->quit) {
+			if (self->server->is_connection_available()) {
+				self->connections++;
+				self->_serve(self->server->take_connection());
+			} else {
+				OS::get_singleton()->delay_usec(100);
+			}
+		}
+	}
+
+	void _serve(Ref<StreamPeerTCP> p_peer) {
+
+		p_peer->set_no_delay(true);
+
+		Vector<uint8_t> head;
+		while (!quit && p_peer->get_status() == StreamPeerTCP::STATUS_CONNECTED) {
+
+			uint8_t byte;
+			int read;
+			if (p_peer->get_partial_data(&byte, 1, read) != OK)
+				return;
+			if (read == 0) {
+				OS::get_singleton()->delay_usec(50);
+				continue;
+			}
+
+			head.push_back(byte);
+			int hs = head.size();
+			if (hs < 4 || head[hs - 4] != '\r' || head[hs - 3] != '\n' || head[hs - 2] != '\r' || head[hs - 1] != '\n')
+				continue;
+
+			String request;
+			request.parse_utf8((const char *)head.ptr(), hs);
+			head.clear();
+			if (!_respond(p_peer, request))
+				return;
+		}
+	}
+
+	bool _respond(Ref<StreamPeerTCP> &p_peer, const String &p_request) {
+
+		Vector<String> lines = p_request.split("\r\n");
+		String path = lines[0].get_slicec(' ', 1);
+		int from = 0;
+		for (int i = 1; i < lines.size(); i++) {
+			String line = lines[i].to_lower();
+			if (line.begins_with("range: bytes="))
+				from = line.substr(13, line.length()).get_slicec('-', 0).to_int();
+		}
+
+		if (path == "/drop") {
+			drops++;
+			p_peer->disconnect_from_host();
+			return false;
+		}
+
+		int size = path == "/small" ? SMALL_SIZE : FILE_SIZE;
+		bool chunked = path == "/chunked";
+
+		String response;
+		if (from >= size) {
+			response = "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n\r\n";
+			CharString cs = response.utf8();
+			return p_peer->put_data((const uint8_t *)cs.get_data(), cs.length()) == OK;
+		}
+
+		if (from > 0) {
+			response = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + itos(from) + "-" + itos(size - 1) + "/" + itos(size) + "\r\n";
+		} else {
+			response = "HTTP/1.1 200 OK\r\n";
+		}
+		if (chunked) {
+			response += "Transfer-Encoding: chunked\r\n\r\n";
+		} else {
+			response += "Content-Length: " + itos(size - from) + "\r\n\r\n";
+		}
+		CharString cs = response.utf8();
+		if (p_peer->put_data((const uint8_t *)cs.get_data(), cs.length()) != OK)
+			return false;
+
+		int to = path == "/cut" ? size / 2 : size;
+		PoolByteArray::Read r = content.read();
+		for (int ofs = from; ofs < to; ofs += SEND_SIZE) {
+
+			int len = MIN(SEND_SIZE, to - ofs);
+			if (chunked) {
+				CharString chunk_head = (String::num_int64(len, 16) + "\r\n").utf8();
+				p_peer->put_data((const uint8_t *)chunk_head.get_data(), chunk_head.length());
+			}
+			if (p_peer->put_data(&r[ofs], len) != OK)
+				return false;
+			if (chunked) {
+				p_peer->put_data((const uint8_t *)"\r\n", 2);
+			}
+		}
+		if (chunked) {
+			p_peer->put_data((const uint8_t *)"0\r\n\r\n", 5);
+		}
+
+		if (to < size) {
+			p_peer->disconnect_from_host();
+			return false;
+		}
+		return true;
+	}
+
+public:
+	volatile int connections;
+	volatile int drops;
+
+	Error start() {
+
+		content.resize(FILE_SIZE);
+		PoolByteArray::Write w = content.write();
+		for (int i = 0; i < FILE_SIZE; i++)
+			w[i] = _file_byte(i);
+
+		server.instance();
+		Error err = server->listen(PORT, IP_Address("127.0.0.1"));
+		if (err != OK)
+			return err;
+
+		quit = false;
+		connections = 0;
+		drops = 0;
+		thread = Thread::create(_thread_func, this);
+		return OK;
+	}
+
+	void stop() {
+
+		quit = true;
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+		server->stop();
+	}
+};
+
+// Receives HTTPRequest signals and checks the data against what was served.
+class Watcher : public Object {
+
+	GDCLASS(Watcher, Object);
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("_completed", "result", "response_code", "headers", "body"), &Watcher::_completed);
+		ClassDB::bind_method(D_METHOD("_chunk", "chunk"), &Watcher::_chunk);
+	}
+
+public:
+	bool done;
+	int result;
+	int response_code;
+	int offset;
+	int chunks;
+	int mismatches;
+
+	void reset(int p_offset = 0) {
+
+		done = false;
+		result = -1;
+		response_code = 0;
+		offset = p_offset;
+		chunks = 0;
+		mismatches = 0;
+	}
+
+	void _check(const PoolByteArray &p_data) {
+
+		PoolByteArray::Read r = p_data.read();
+		for (int i = 0; i < p_data.size(); i++) {
+			if (r[i] != _file_byte(offset + i))
+				mismatches++;
+		}
+		offset += p_data.size();
+	}
+
+	void _completed(int p_result, int p_response_code, const PoolStringArray &p_headers, const PoolByteArray &p_body) {
+
+		done = true;
+		result = p_result;
+		response_code = p_response_code;
+		_check(p_body);
+	}
+
+	void _chunk(const PoolByteArray &p_chunk) {
+
+		chunks++;
+		_check(p_chunk);
+	}
+};
+
+class TestMainLoop : public SceneTree {
+
+	StandInServer server;
+	Watcher *watcher;
+
+	String _url(const String &p_path) const {
+
+		return "http://127.0.0.1:" + itos(PORT) + p_path;
+	}
+
+	// Drives the request the way the scene tree would, as fast as possible.
+	// Returns the elapsed time and the peak extra memory in use meanwhile.
+	uint64_t _run(HTTPRequest *p_request, const String &p_path, uint64_t &r_peak_memory, HTTPClient::Method p_method = HTTPClient::METHOD_GET) {
+
+		uint64_t base_memory = Memory::get_mem_usage();
+		r_peak_memory = 0;
+		uint64_t start = OS::get_singleton()->get_ticks_usec();
+
+		Error err = p_request->request(_url(p_path), Vector<String>(), true, p_method);
+		if (err != OK) {
+			watcher->done = true;
+			return 0;
+		}
+
+		while (!watcher->done) {
+
+			if (p_request->is_using_threads())
+				OS::get_singleton()->delay_usec(100);
+			else
+				p_request->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+			MessageQueue::get_singleton()->flush();
+
+			uint64_t memory = Memory::get_mem_usage();
+			if (memory > base_memory)
+				r_peak_memory = MAX(r_peak_memory, memory - base_memory);
+		}
+
+		return OS::get_singleton()->get_ticks_usec() - start;
+	}
+
+	HTTPRequest *_create_request() {
+
+		HTTPRequest *request = memnew(HTTPRequest);
+		get_root()->add_child(request);
+		request->connect("request_completed", watcher, "_completed");
+		request->connect("body_chunk_received", watcher, "_chunk");
+		return request;
+	}
+
+	bool _benchmark_client() {
+
+		OS::get_singleton()->print("HTTPClient, %d MiB body:\n", FILE_SIZE >> 20);
+
+		bool pass = true;
+
+		for (int into_buffer = 0; into_buffer < 2; into_buffer++) {
+
+			Ref<HTTPClient> client;
+			client.instance();
+			client->set_read_chunk_size(1 << 16);
+			client->connect_to_host("127.0.0.1", PORT);
+			while (client->get_status() == HTTPClient::STATUS_CONNECTING || client->get_status() == HTTPClient::STATUS_RESOLVING)
+				client->poll();
+			client->request(HTTPClient::METHOD_GET, "/file", Vector<String>());
+			while (client->get_status() == HTTPClient::STATUS_REQUESTING)
+				client->poll();
+
+			uint64_t start = OS::get_singleton()->get_ticks_usec();
+			uint64_t received = 0;
+			uint8_t buffer[1 << 16];
+			while (client->get_status() == HTTPClient::STATUS_BODY) {
+				client->poll();
+				if (into_buffer) {
+					received += client->read_response_body_data(buffer, sizeof(buffer));
+				} else {
+					received += client->read_response_body_chunk().size();
+				}
+			}
+			uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+
+			OS::get_singleton()->print("  %-34s %8.1f MiB/s %s\n", into_buffer ? "read_response_body_data()" : "read_response_body_chunk()",
+					received / 1048576.0 / (usec / 1000000.0), received == FILE_SIZE ? "" : "(SHORT)");
+			client->close();
+
+			if (received != FILE_SIZE)
+				pass = false;
+		}
+
+		return pass;
+	}
+
+	bool _benchmark_request() {
+
+		OS::get_singleton()->print("\nHTTPRequest, %d MiB body:\n", FILE_SIZE >> 20);
+		OS::get_singleton()->print("  %-34s %10s %14s %8s\n", "mode", "MiB/s", "peak memory", "chunks");
+
+		String download_path = OS::get_singleton()->get_cache_path().plus_file("godot_test_http.bin");
+
+		bool pass = true;
+		for (int mode = 0; mode < 6; mode++) {
+
+			static const char *names[6] = { "body in memory", "body in memory, threads", "stream_body", "stream_body, threads", "stream_body, chunked encoding", "download_file" };
+
+			HTTPRequest *request = _create_request();
+			request->set_use_threads(mode == 1 || mode == 3);
+			request->set_stream_body(mode >= 2 && mode <= 4);
+			if (mode == 5)
+				request->set_download_file(download_path);
+
+			watcher->reset();
+			uint64_t peak;
+			uint64_t usec = _run(request, mode == 4 ? "/chunked" : "/file", peak);
+
+			if (mode == 5) {
+				// Check what was written.
+				FileAccess *f = FileAccess::open(download_path, FileAccess::READ);
+				if (f) {
+					PoolByteArray data;
+					data.resize(f->get_len());
+					PoolByteArray::Write w = data.write();
+					f->get_buffer(w.ptr(), data.size());
+					w = PoolByteArray::Write();
+					memdelete(f);
+					watcher->_check(data);
+				}
+			}
+
+			bool ok = watcher->result == HTTPRequest::RESULT_SUCCESS && watcher->offset == FILE_SIZE && watcher->mismatches == 0;
+			OS::get_singleton()->print("  %-34s %10.1f %11.1f MiB %8d %s\n", names[mode], FILE_SIZE / 1048576.0 / (usec / 1000000.0), peak / 1048576.0, watcher->chunks, ok ? "" : "(FAILED)");
+			pass = pass && ok;
+
+			memdelete(request);
+		}
+
+		DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		da->remove(download_path);
+		memdelete(da);
+
+		return pass;
+	}
+
+	bool _benchmark_keep_alive() {
+
+		OS::get_singleton()->print("\nHTTPRequest, %d requests of %d bytes:\n", SMALL_REQUESTS, SMALL_SIZE);
+
+		bool pass = true;
+
+		for (int keep_alive = 0; keep_alive < 2; keep_alive++) {
+
+			HTTPRequest *request = _create_request();
+			request->set_keep_alive(keep_alive);
+
+			int connections = server.connections;
+			int failed = 0;
+			uint64_t usec = 0;
+			for (int i = 0; i < SMALL_REQUESTS; i++) {
+				watcher->reset();
+				uint64_t peak;
+				usec += _run(request, "/small", peak);
+				if (watcher->result != HTTPRequest::RESULT_SUCCESS || watcher->offset != SMALL_SIZE || watcher->mismatches)
+					failed++;
+			}
+
+			OS::get_singleton()->print("  %-34s %8.1f usec/request %4d connections %s\n", keep_alive ? "keep_alive" : "new connection each", usec / double(SMALL_REQUESTS), server.connections - connections, failed ? "(FAILED)" : "");
+			pass = pass && failed == 0;
+
+			memdelete(request);
+		}
+
+		return pass;
+	}
+
+	bool _test_resume() {
+
+		OS::get_singleton()->print("\nHTTPRequest resume_download after a dropped connection:\n");
+
+		String download_path = OS::get_singleton()->get_cache_path().plus_file("godot_test_http_resume.bin");
+		DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		da->remove(download_path);
+
+		HTTPRequest *request = _create_request();
+		request->set_download_file(download_path);
+		request->set_resume_download(true);
+
+		uint64_t peak;
+		watcher->reset();
+		_run(request, "/cut", peak);
+		OS::get_singleton()->print("  first attempt: result %d, %d bytes\n", watcher->result, request->get_downloaded_bytes());
+
+		watcher->reset();
+		_run(request, "/file", peak);
+		int resumed = request->get_downloaded_bytes();
+
+		watcher->reset();
+		FileAccess *f = FileAccess::open(download_path, FileAccess::READ);
+		if (f) {
+			PoolByteArray data;
+			data.resize(f->get_len());
+			PoolByteArray::Write w = data.write();
+			f->get_buffer(w.ptr(), data.size());
+			w = PoolByteArray::Write();
+			memdelete(f);
+			watcher->_check(data);
+		}
+		bool intact = watcher->offset == FILE_SIZE && watcher->mismatches == 0;
+		OS::get_singleton()->print("  resumed: %d more bytes, file has %d bytes, %s\n", resumed, watcher->offset, intact ? "intact" : "CORRUPT");
+
+		memdelete(request);
+		da->remove(download_path);
+		memdelete(da);
+
+		return intact;
+	}
+
+	// A kept alive connection dropped after the request went out is only
+	// tried again on a new one when repeating the request is safe.
+	bool _test_retry() {
+
+		OS::get_singleton()->print("\nHTTPRequest retry when a kept alive connection drops:\n");
+
+		HTTPRequest *request = _create_request();
+		request->set_keep_alive(true);
+
+		bool pass = true;
+		for (int post = 0; post < 2; post++) {
+
+			uint64_t peak;
+			watcher->reset();
+			_run(request, "/small", peak);
+
+			int drops = server.drops;
+			watcher->reset();
+			_run(request, "/drop", peak, post ? HTTPClient::METHOD_POST : HTTPClient::METHOD_GET);
+			int sent = server.drops - drops;
+
+			// GET goes out again once, POST must not.
+			bool ok = watcher->result != HTTPRequest::RESULT_SUCCESS && sent == (post ? 1 : 2);
+			OS::get_singleton()->print("  %-34s %d times %s\n", post ? "POST sent" : "GET sent", sent, ok ? "" : "(FAILED)");
+			pass = pass && ok;
+		}
+
+		memdelete(request);
+
+		return pass;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		if (server.start() != OK) {
+			OS::get_singleton()->print("Could not listen on port %d\n", PORT);
+			return;
+		}
+
+		watcher = memnew(Watcher);
+
+		bool results[] = {
+			_benchmark_client(),
+			_benchmark_request(),
+			_benchmark_keep_alive(),
+			_test_resume(),
+			_test_retry()
+		};
+
+		memdelete(watcher);
+		server.stop();
+
+		int count = sizeof(results) / sizeof(results[0]);
+		int passed = 0;
+		for (int i = 0; i < count; i++) {
+			if (results[i])
+				passed++;
+			OS::get_singleton()->print("\t%s\n", results[i] ? "PASS" : "FAILED");
+		}
+
+		OS::get_singleton()->print("\n");
+		OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	}
+
+	virtual bool idle(float p_time) {
+
+		SceneTree::idle(p_time);
+		return true;
+	}
+};
+
+MainLoop *test() {
+
+	ClassDB::register_class<Watcher>();
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestHTTP
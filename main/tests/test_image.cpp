@@ -0,0 +1,203 @@
+/*************************************************************************/
+/*  test_image.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_image.h"
+
+#include "core/image.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+
+// Image::resize(), generate_mipmaps() and convert() on 4K and 8K images,
+// first on the calling thread only and then split across the image work
+// pool. Run with:
+// godot_server --test image
+
+namespace TestImage {
+
+static Ref<Image> _make_image(int p_size, Image::Format p_format) {
+
+	// Smooth gradients with some high frequency detail, so every filter has
+	// something to do.
+	PoolVector<uint8_t> data;
+	data.resize(p_size * p_size * 4);
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		uint8_t *ptr = w.ptr();
+		for (int y = 0; y < p_size; y++) {
+			for (int x = 0; x < p_size; x++) {
+				uint8_t *pixel = &ptr[(y * p_size + x) * 4];
+				pixel[0] = x * 255 / p_size;
+				pixel[1] = y * 255 / p_size;
+				pixel[2] = ((x ^ y) & 0x1F) << 3;
+				pixel[3] = 255 - ((x + y) & 0x7F);
+			}
+		}
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(p_size, p_size, false, Image::FORMAT_RGBA8, data);
+
+	if (p_format != Image::FORMAT_RGBA8) {
+		image->convert(p_format);
+	}
+
+	return image;
+}
+
+static uint32_t _checksum(const Ref<Image> &p_image) {
+
+	PoolVector<uint8_t> data = p_image->get_data();
+	PoolVector<uint8_t>::Read r = data.read();
+	uint32_t hash = 5381;
+	for (int i = 0; i < data.size(); i++) {
+		hash = ((hash << 5) + hash) + r[i];
+	}
+	return hash;
+}
+
+static void _report(const char *p_what, const Ref<Image> &p_image, uint64_t p_begin, Vector<uint32_t> &r_checksums) {
+
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - p_begin;
+	uint32_t checksum = _checksum(p_image);
+	OS::get_singleton()->print("  %-40s %6d ms  (checksum %08x)\n", p_what, int(usec / 1000), checksum);
+	r_checksums.push_back(checksum);
+}
+
+static void _benchmark(int p_size, Image::Format p_format, Vector<uint32_t> &r_checksums) {
+
+	OS::get_singleton()->print("%dx%d %s:\n", p_size, p_size, Image::get_format_name(p_format).utf8().get_data());
+
+	Ref<Image> source = _make_image(p_size, p_format);
+
+	static const char *interpolation_names[] = { "nearest", "bilinear", "cubic", "trilinear", "lanczos" };
+	for (int i = Image::INTERPOLATE_NEAREST; i <= Image::INTERPOLATE_LANCZOS; i++) {
+
+		Ref<Image> image = source->duplicate();
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		image->resize(p_size / 2 + 1, p_size / 2 + 1, Image::Interpolation(i));
+		_report((String("resize to half, ") + interpolation_names[i]).utf8().get_data(), image, begin, r_checksums);
+	}
+
+	Ref<Image> image = source->duplicate();
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	image->generate_mipmaps();
+	_report("generate_mipmaps", image, begin, r_checksums);
+
+	Image::Format convert_formats[2];
+	if (p_format == Image::FORMAT_RGBA8) {
+		convert_formats[0] = Image::FORMAT_RGB8;
+		convert_formats[1] = Image::FORMAT_RGBAF;
+	} else {
+		convert_formats[0] = Image::FORMAT_RGBA8;
+		convert_formats[1] = Image::FORMAT_RGBAH;
+	}
+
+	for (int i = 0; i < 2; i++) {
+
+		image = source->duplicate();
+		begin = OS::get_singleton()->get_ticks_usec();
+		image->convert(convert_formats[i]);
+		_report(("convert to " + Image::get_format_name(convert_formats[i])).utf8().get_data(), image, begin, r_checksums);
+	}
+}
+
+static void _run(Vector<uint32_t> &r_checksums) {
+
+	_benchmark(4096, Image::FORMAT_RGBA8, r_checksums);
+	_benchmark(8192, Image::FORMAT_RGBA8, r_checksums);
+	_benchmark(4096, Image::FORMAT_RGBAF, r_checksums);
+}
+
+bool test_work_pool() {
+
+	OS::get_singleton()->print("\n*** Image processing ***\n");
+
+	// Holding the pool keeps every operation on this thread, the results must
+	// be identical either way.
+	Vector<uint32_t> single_checksums;
+	ThreadWorkPool *pool = Image::lock_work_pool();
+	OS::get_singleton()->print("\nsingle thread\n");
+	_run(single_checksums);
+	if (!pool) {
+		OS::get_singleton()->print("\nno worker threads available, skipped the threaded run\n");
+		return true;
+	}
+
+	Image::unlock_work_pool();
+	Vector<uint32_t> pool_checksums;
+	OS::get_singleton()->print("\nwork pool, %d worker threads\n", int(pool->get_thread_count()));
+	_run(pool_checksums);
+
+	int mismatches = 0;
+	for (int i = 0; i < single_checksums.size(); i++) {
+		if (single_checksums[i] != pool_checksums[i]) {
+			mismatches++;
+		}
+	}
+	if (mismatches) {
+		OS::get_singleton()->print("\n%d results differ from the single thread run\n", mismatches);
+	}
+
+	return mismatches == 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_work_pool,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestImage
@@ -0,0 +1,207 @@
+/*************************************************************************/
+/*  test_image_compress.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_image_compress.h"
+
+#include "core/image.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+
+// Image::compress() with every available block compressor on a corpus of
+// generated textures, like a texture import would do it, first on the calling
+// thread only and then split across the image work pool. The compressed data
+// must be the same either way. Run with:
+// godot --test image_compress
+
+namespace TestImageCompress {
+
+struct CorpusImage {
+	const char *name;
+	int width;
+	int height;
+	bool alpha;
+	bool mipmaps;
+	Image::CompressSource source;
+};
+
+static const CorpusImage corpus[] = {
+	{ "albedo 1024x1024", 1024, 1024, false, true, Image::COMPRESS_SOURCE_SRGB },
+	{ "albedo+alpha 1024x512", 1024, 512, true, true, Image::COMPRESS_SOURCE_SRGB },
+	{ "normal 512x512", 512, 512, false, true, Image::COMPRESS_SOURCE_NORMAL },
+	{ "ui 1000x600", 1000, 600, true, false, Image::COMPRESS_SOURCE_GENERIC },
+	{ "icon 64x64", 64, 64, true, true, Image::COMPRESS_SOURCE_GENERIC },
+};
+
+static Ref<Image> _make_image(const CorpusImage &p_desc) {
+
+	// Gradients with noise and hard edges, so the encoders have to search.
+	PoolVector<uint8_t> data;
+	data.resize(p_desc.width * p_desc.height * 4);
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		uint8_t *ptr = w.ptr();
+		uint32_t seed = 1;
+		for (int y = 0; y < p_desc.height; y++) {
+			for (int x = 0; x < p_desc.width; x++) {
+				seed = seed * 1103515245 + 12345;
+				int noise = (seed >> 16) & 0xF;
+				uint8_t *pixel = &ptr[(y * p_desc.width + x) * 4];
+				pixel[0] = CLAMP(x * 255 / p_desc.width + noise, 0, 255);
+				pixel[1] = CLAMP(y * 255 / p_desc.height + noise, 0, 255);
+				pixel[2] = ((x / 16 + y / 16) & 1) ? 200 : 40;
+				pixel[3] = p_desc.alpha ? (((x ^ y) & 0x3F) << 2) : 255;
+			}
+		}
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(p_desc.width, p_desc.height, false, Image::FORMAT_RGBA8, data);
+	if (!p_desc.alpha) {
+		image->convert(Image::FORMAT_RGB8);
+	}
+	if (p_desc.mipmaps) {
+		image->generate_mipmaps(p_desc.source == Image::COMPRESS_SOURCE_NORMAL);
+	}
+
+	return image;
+}
+
+static uint32_t _checksum(const Ref<Image> &p_image) {
+
+	PoolVector<uint8_t> data = p_image->get_data();
+	PoolVector<uint8_t>::Read r = data.read();
+	uint32_t hash = 5381;
+	for (int i = 0; i < data.size(); i++) {
+		hash = ((hash << 5) + hash) + r[i];
+	}
+	return hash;
+}
+
+static int _run(const Vector<Ref<Image> > &p_images, uint32_t *r_checksums) {
+
+	static const char *mode_names[] = { "S3TC", "PVRTC2", "PVRTC4", "ETC", "ETC2", "BPTC" };
+	static const Image::CompressMode modes[] = { Image::COMPRESS_S3TC, Image::COMPRESS_ETC2, Image::COMPRESS_BPTC };
+	bool available[] = { Image::_image_compress_bc_func != NULL, Image::_image_compress_etc2_func != NULL, Image::_image_compress_bptc_func != NULL };
+
+	int checksum_index = 0;
+	int mismatches = 0;
+
+	for (int i = 0; i < 3; i++) {
+
+		if (!available[i]) {
+			OS::get_singleton()->print("  %-30s unavailable\n", mode_names[modes[i]]);
+			continue;
+		}
+
+		uint64_t total = 0;
+		for (int j = 0; j < p_images.size(); j++) {
+
+			Ref<Image> image = p_images[j]->duplicate();
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			image->compress(modes[i], corpus[j].source, 0.7);
+			uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+			total += usec;
+
+			uint32_t checksum = _checksum(image);
+			OS::get_singleton()->print("  %-6s %-24s %6d ms  (checksum %08x)\n", mode_names[modes[i]], corpus[j].name, int(usec / 1000), checksum);
+			if (r_checksums[checksum_index] && r_checksums[checksum_index] != checksum) {
+				OS::get_singleton()->print("  ^ MISMATCH with the single thread run\n");
+				mismatches++;
+			}
+			r_checksums[checksum_index++] = checksum;
+		}
+		OS::get_singleton()->print("  %-6s %-24s %6d ms\n", mode_names[modes[i]], "total", int(total / 1000));
+	}
+
+	return mismatches;
+}
+
+bool test_work_pool() {
+
+	OS::get_singleton()->print("\n*** Image compression ***\n");
+
+	const int corpus_size = sizeof(corpus) / sizeof(corpus[0]);
+	Vector<Ref<Image> > images;
+	for (int i = 0; i < corpus_size; i++) {
+		images.push_back(_make_image(corpus[i]));
+	}
+
+	uint32_t checksums[3 * corpus_size];
+	for (int i = 0; i < 3 * corpus_size; i++) {
+		checksums[i] = 0;
+	}
+
+	// Holding the pool keeps every compressor on this thread.
+	ThreadWorkPool *pool = Image::lock_work_pool();
+	OS::get_singleton()->print("\nsingle thread\n");
+	_run(images, checksums);
+	if (!pool) {
+		OS::get_singleton()->print("\nno worker threads available, skipped the threaded run\n");
+		return true;
+	}
+
+	Image::unlock_work_pool();
+	OS::get_singleton()->print("\nwork pool, %d worker threads\n", int(pool->get_thread_count()));
+	return _run(images, checksums) == 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_work_pool,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestImageCompress
@@ -33,17 +33,31 @@
 
 #ifdef DEBUG_ENABLED
 
+#include "test_animation.h"
 #include "test_astar.h"
+#include "test_cpu_particles.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
+#include "test_http.h"
+#include "test_image.h"
+#include "test_image_compress.h"
 #include "test_math.h"
+#include "test_multiplayer.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
+#include "test_scene_tree.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_tcp.h"
+#include "test_texture_streaming.h"
+#include "test_tile_map.h"
+#include "test_udp.h"
+#include "test_visual_server_canvas.h"
+#include "test_visual_server_scene.h"
+#include "test_websocket.h"
 
 const char **tests_get_names() {
 
@@ -62,6 +76,20 @@ const char **tests_get_names() {
 		"gd_bytecode",
 		"ordered_hash_map",
 		"astar",
+		"visual_server_scene",
+		"animation",
+		"cpu_particles",
+		"tile_map",
+		"scene_tree",
+		"visual_server_canvas",
+		"multiplayer",
+		"udp",
+		"tcp",
+		"http",
+		"websocket",
+		"image",
+		"image_compress",
+		"texture_streaming",
 		NULL
 	};
 
@@ -142,6 +170,76 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "visual_server_scene") {
+
+		return TestVisualServerScene::test();
+	}
+
+	if (p_test == "animation") {
+
+		return TestAnimation::test();
+	}
+
+	if (p_test == "cpu_particles") {
+
+		return TestCPUParticles::test();
+	}
+
+	if (p_test == "tile_map") {
+
+		return TestTileMap::test();
+	}
+
+	if (p_test == "scene_tree") {
+
+		return TestSceneTree::test();
+	}
+
+	if (p_test == "visual_server_canvas") {
+
+		return TestVisualServerCanvas::test();
+	}
+
+	if (p_test == "multiplayer") {
+
+		return TestMultiplayer::test();
+	}
+
+	if (p_test == "udp") {
+
+		return TestUDP::test();
+	}
+
+	if (p_test == "tcp") {
+
+		return TestTCP::test();
+	}
+
+	if (p_test == "http") {
+
+		return TestHTTP::test();
+	}
+
+	if (p_test == "websocket") {
+
+		return TestWebSocket::test();
+	}
+
+	if (p_test == "image") {
+
+		return TestImage::test();
+	}
+
+	if (p_test == "image_compress") {
+
+		return TestImageCompress::test();
+	}
+
+	if (p_test == "texture_streaming") {
+
+		return TestTextureStreaming::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
@@ -0,0 +1,740 @@
+/*************************************************************************/
+/*  test_multiplayer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_multiplayer.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/multiplayer_api.h"
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+// RPC and replication bandwidth and throughput between two MultiplayerAPIs
+// in the same process, connected by an in-memory peer, and ENet latency
+// while the main thread stalls. Run with:
+// godot_server --test multiplayer
+
+namespace TestMultiplayer {
+
+enum {
+	PLAYER_COUNT = 64,
+	FRAMES = 600,
+	SETTLE_FRAMES = 30,
+	ACK_LOSS_FRAMES = 200 // Longer than the snapshots a peer keeps.
+};
+
+// Hands every packet straight to the other end, there are only two peers.
+// Unreliable packets can be dropped to see how replication copes with loss.
+class LoopbackPeer : public NetworkedMultiplayerPeer {
+
+	GDCLASS(LoopbackPeer, NetworkedMultiplayerPeer);
+
+	struct Packet {
+		int from;
+		Vector<uint8_t> data;
+	};
+
+	List<Packet> incoming;
+	Vector<uint8_t> current;
+	int unique_id;
+	TransferMode transfer_mode;
+
+public:
+	LoopbackPeer *remote;
+	uint64_t bytes_sent;
+	uint64_t packets_sent;
+	float drop_rate;
+
+	virtual void set_transfer_mode(TransferMode p_mode) { transfer_mode = p_mode; }
+	virtual TransferMode get_transfer_mode() const { return transfer_mode; }
+	virtual void set_target_peer(int p_peer_id) {}
+
+	virtual int get_packet_peer() const {
+
+		ERR_FAIL_COND_V(incoming.empty(), 0);
+		return incoming.front()->get().from;
+	}
+
+	virtual bool is_server() const { return unique_id == 1; }
+	virtual void poll() {}
+	virtual int get_unique_id() const { return unique_id; }
+	virtual void set_refuse_new_connections(bool p_enable) {}
+	virtual bool is_refusing_new_connections() const { return false; }
+	virtual ConnectionStatus get_connection_status() const { return CONNECTION_CONNECTED; }
+
+	virtual int get_available_packet_count() const { return incoming.size(); }
+
+	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) {
+
+		ERR_FAIL_COND_V(incoming.empty(), ERR_UNAVAILABLE);
+
+		current = incoming.front()->get().data;
+		incoming.pop_front();
+
+		*r_buffer = current.ptr();
+		r_buffer_size = current.size();
+		return OK;
+	}
+
+	virtual Error put_packet(const uint8_t *p_buffer, int p_buffer_size) {
+
+		bytes_sent += p_buffer_size;
+		packets_sent++;
+
+		if (transfer_mode != TRANSFER_MODE_RELIABLE && Math::randf() < drop_rate)
+			return OK;
+
+		Packet packet;
+		packet.from = unique_id;
+		packet.data.resize(p_buffer_size);
+		copymem(packet.data.ptrw(), p_buffer, p_buffer_size);
+		remote->incoming.push_back(packet);
+		return OK;
+	}
+
+	virtual int get_max_packet_size() const { return 1 << 24; }
+
+	LoopbackPeer() {
+		unique_id = 1;
+		transfer_mode = TRANSFER_MODE_RELIABLE;
+		remote = NULL;
+		bytes_sent = 0;
+		packets_sent = 0;
+		drop_rate = 0;
+	}
+
+	static void link(LoopbackPeer *p_server, LoopbackPeer *p_client) {
+
+		p_server->unique_id = 1;
+		p_client->unique_id = 2;
+		p_server->remote = p_client;
+		p_client->remote = p_server;
+	}
+};
+
+class TestPlayer : public Node {
+
+	GDCLASS(TestPlayer, Node);
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("sync_state", "position", "rotation", "input", "animation"), &TestPlayer::sync_state);
+
+		ClassDB::bind_method(D_METHOD("set_position", "position"), &TestPlayer::set_position);
+		ClassDB::bind_method(D_METHOD("get_position"), &TestPlayer::get_position);
+		ClassDB::bind_method(D_METHOD("set_rotation", "rotation"), &TestPlayer::set_rotation);
+		ClassDB::bind_method(D_METHOD("get_rotation"), &TestPlayer::get_rotation);
+		ClassDB::bind_method(D_METHOD("set_health", "health"), &TestPlayer::set_health);
+		ClassDB::bind_method(D_METHOD("get_health"), &TestPlayer::get_health);
+
+		ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "position"), "set_position", "get_position");
+		ADD_PROPERTY(PropertyInfo(Variant::REAL, "rotation"), "set_rotation", "get_rotation");
+		ADD_PROPERTY(PropertyInfo(Variant::INT, "health"), "set_health", "get_health");
+	}
+
+public:
+	int received;
+	Vector3 position;
+	float rotation;
+	int health;
+
+	void set_position(const Vector3 &p_position) { position = p_position; }
+	Vector3 get_position() const { return position; }
+	void set_rotation(float p_rotation) { rotation = p_rotation; }
+	float get_rotation() const { return rotation; }
+	void set_health(int p_health) { health = p_health; }
+	int get_health() const { return health; }
+
+	void sync_state(const Vector3 &p_position, float p_rotation, int p_input, const String &p_animation) {
+
+		received++;
+	}
+
+	TestPlayer() {
+		received = 0;
+		rotation = 0;
+		health = 100;
+		rpc_config("sync_state", MultiplayerAPI::RPC_MODE_REMOTE);
+	}
+};
+
+class TestMainLoop : public SceneTree {
+
+	Node *_create_players(const String &p_name, Vector<TestPlayer *> &r_players) {
+
+		Node *root = memnew(Node);
+		root->set_name(p_name);
+
+		Node *players = memnew(Node);
+		players->set_name("Players");
+		root->add_child(players);
+
+		for (int i = 0; i < PLAYER_COUNT; i++) {
+			TestPlayer *player = memnew(TestPlayer);
+			player->set_name("Player" + itos(i));
+			players->add_child(player);
+			r_players.push_back(player);
+		}
+
+		get_root()->add_child(root);
+		return root;
+	}
+
+	bool _benchmark_rpc() {
+
+		OS::get_singleton()->print("\n*** RPC, %d players, %d frames ***\n", int(PLAYER_COUNT), int(FRAMES));
+
+		Vector<TestPlayer *> server_players;
+		Vector<TestPlayer *> client_players;
+		Node *server_root = _create_players("Server", server_players);
+		Node *client_root = _create_players("Client", client_players);
+
+		Ref<LoopbackPeer> server_peer = memnew(LoopbackPeer);
+		Ref<LoopbackPeer> client_peer = memnew(LoopbackPeer);
+		LoopbackPeer::link(server_peer.ptr(), client_peer.ptr());
+
+		Ref<MultiplayerAPI> server;
+		server.instance();
+		server->set_root_node(server_root);
+		server->set_network_peer(server_peer);
+		server->_add_peer(2);
+
+		Ref<MultiplayerAPI> client;
+		client.instance();
+		client->set_root_node(client_root);
+		client->set_network_peer(client_peer);
+		client->_add_peer(1);
+
+		StringName method = "sync_state";
+		Variant args[4] = { Vector3(), 0.0, 0, "run" };
+		const Variant *argp[4] = { &args[0], &args[1], &args[2], &args[3] };
+
+		//what the same call cost with names and encode_variant() everywhere
+		int legacy_size = 1 + 4 + String(method).utf8().length() + 1 + 1;
+		for (int i = 0; i < 4; i++) {
+			int len;
+			encode_variant(args[i], NULL, len);
+			legacy_size += len;
+		}
+
+		uint64_t send_usec = 0;
+		uint64_t receive_usec = 0;
+		uint64_t steady_bytes = 0;
+		uint64_t steady_packets = 0;
+
+		for (int f = 0; f < FRAMES; f++) {
+
+			uint64_t bytes = server_peer->bytes_sent;
+			uint64_t packets = server_peer->packets_sent;
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			for (int i = 0; i < PLAYER_COUNT; i++) {
+				args[0] = Vector3(i, 0, f * 0.1);
+				args[1] = f * 0.01;
+				args[2] = f & 0xF;
+				server->rpcp(server_players[i], 0, true, method, argp, 4);
+			}
+			uint64_t mid = OS::get_singleton()->get_ticks_usec();
+			client->poll();
+			uint64_t end = OS::get_singleton()->get_ticks_usec();
+			server->poll(); //path and name confirmations
+
+			send_usec += mid - begin;
+			receive_usec += end - mid;
+
+			if (f > 0) {
+				steady_bytes += server_peer->bytes_sent - bytes;
+				steady_packets += server_peer->packets_sent - packets;
+			}
+		}
+
+		int received = 0;
+		for (int i = 0; i < client_players.size(); i++) {
+			received += client_players[i]->received;
+		}
+
+		uint64_t calls = uint64_t(PLAYER_COUNT) * FRAMES;
+		OS::get_singleton()->print("calls: %d, received: %d\n", int(calls), received);
+		OS::get_singleton()->print("bytes per call once cached: %d (was %d with names and full variants)\n", int(steady_bytes / MAX(1, steady_packets)), legacy_size);
+		OS::get_singleton()->print("send: %d nsec per call, receive: %d nsec per call\n", int(send_usec * 1000 / calls), int(receive_usec * 1000 / calls));
+
+		server->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		client->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		memdelete(server_root);
+		memdelete(client_root);
+
+		return uint64_t(received) == calls;
+	}
+
+	void _replicate(Vector<TestPlayer *> &p_players, Ref<MultiplayerAPI> p_multiplayer) {
+
+		for (int i = 0; i < p_players.size(); i++) {
+			p_multiplayer->replicate_property(p_players[i], "position", 0.01);
+			p_multiplayer->replicate_property(p_players[i], "rotation", 0.001);
+			p_multiplayer->replicate_property(p_players[i], "health");
+		}
+	}
+
+	// Moves half the players every frame, the others stand still most of the time.
+	void _move_players(Vector<TestPlayer *> &p_players, int p_frame) {
+
+		for (int i = 0; i < p_players.size(); i++) {
+			if (i & 1 && (p_frame % 20) != 0)
+				continue;
+			float t = p_frame * 0.016;
+			p_players[i]->position = Vector3(i + Math::sin(t + i), 0, Math::cos(t * 0.7 + i) * 4.0);
+			p_players[i]->rotation = Math::fmod(t + i * 0.1, Math_PI * 2.0);
+			if ((p_frame + i) % 97 == 0)
+				p_players[i]->health -= 3;
+		}
+	}
+
+	float _max_error(const Vector<TestPlayer *> &p_server, const Vector<TestPlayer *> &p_client) {
+
+		float error = 0;
+		for (int i = 0; i < p_server.size(); i++) {
+			Vector3 d = (p_server[i]->position - p_client[i]->position).abs();
+			error = MAX(error, MAX(d.x, MAX(d.y, d.z)));
+			error = MAX(error, Math::abs(p_server[i]->rotation - p_client[i]->rotation));
+			error = MAX(error, float(ABS(p_server[i]->health - p_client[i]->health)));
+		}
+		return error;
+	}
+
+	// True if the client ended up with the server state, within the
+	// quantization steps.
+	bool _run_replication(const String &p_label, Ref<MultiplayerAPI> p_server, Ref<MultiplayerAPI> p_client, const Ref<NetworkedMultiplayerPeer> &p_server_peer, Vector<TestPlayer *> &p_server_players, Vector<TestPlayer *> &p_client_players, uint64_t (*p_bytes_sent)(const Ref<NetworkedMultiplayerPeer> &), void (*p_wait)()) {
+
+		uint64_t bytes = 0;
+		uint64_t tick_usec = 0;
+
+		for (int f = 0; f < FRAMES + SETTLE_FRAMES; f++) {
+
+			if (f < FRAMES)
+				_move_players(p_server_players, f);
+
+			uint64_t sent = p_bytes_sent(p_server_peer);
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			p_server->poll(); //acks in, state out
+			tick_usec += OS::get_singleton()->get_ticks_usec() - begin;
+			if (f < FRAMES)
+				bytes += p_bytes_sent(p_server_peer) - sent;
+
+			if (p_wait)
+				p_wait();
+			p_client->poll();
+			if (p_wait)
+				p_wait();
+		}
+
+		float error = _max_error(p_server_players, p_client_players);
+		OS::get_singleton()->print("%s: %d bytes per tick, %d usec per tick, max error after settling %f (steps 0.01, 0.001)\n", p_label.utf8().get_data(), int(bytes / FRAMES), int(tick_usec / (FRAMES + SETTLE_FRAMES)), error);
+
+		return error <= 0.01;
+	}
+
+	static uint64_t _loopback_bytes(const Ref<NetworkedMultiplayerPeer> &p_peer) {
+
+		return Object::cast_to<LoopbackPeer>(p_peer.ptr())->bytes_sent;
+	}
+
+	static void _enet_wait() {
+
+		OS::get_singleton()->delay_usec(200);
+	}
+
+	static uint64_t _enet_bytes(const Ref<NetworkedMultiplayerPeer> &p_peer) {
+
+		return 0; // Not exposed by ENet, the loopback numbers apply.
+	}
+
+	// Acknowledgements stop reaching the server for a while, the client must
+	// still end up with the server state once they come through again.
+	bool _test_replication_ack_loss() {
+
+		Vector<TestPlayer *> server_players;
+		Vector<TestPlayer *> client_players;
+		Node *server_root = _create_players("Server", server_players);
+		Node *client_root = _create_players("Client", client_players);
+
+		Ref<LoopbackPeer> server_peer = memnew(LoopbackPeer);
+		Ref<LoopbackPeer> client_peer = memnew(LoopbackPeer);
+		LoopbackPeer::link(server_peer.ptr(), client_peer.ptr());
+
+		Ref<MultiplayerAPI> server;
+		server.instance();
+		server->set_root_node(server_root);
+		server->set_network_peer(server_peer);
+		server->_add_peer(2);
+		_replicate(server_players, server);
+
+		Ref<MultiplayerAPI> client;
+		client.instance();
+		client->set_root_node(client_root);
+		client->set_network_peer(client_peer);
+		client->_add_peer(1);
+		_replicate(client_players, client);
+
+		int frames = SETTLE_FRAMES + ACK_LOSS_FRAMES + SETTLE_FRAMES;
+		for (int f = 0; f < frames + SETTLE_FRAMES; f++) {
+
+			// Acks are unreliable, paths are confirmed reliably and still get through.
+			client_peer->drop_rate = (f >= SETTLE_FRAMES && f < SETTLE_FRAMES + ACK_LOSS_FRAMES) ? 1.0 : 0.0;
+
+			if (f < frames)
+				_move_players(server_players, f);
+
+			server->poll();
+			client->poll();
+		}
+
+		float error = _max_error(server_players, client_players);
+		OS::get_singleton()->print("\n*** Replication with %d frames of lost acknowledgements ***\nmax error after settling %f\n", int(ACK_LOSS_FRAMES), error);
+
+		server->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		client->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		memdelete(server_root);
+		memdelete(client_root);
+
+		return error <= 0.01;
+	}
+
+	bool _benchmark_replication() {
+
+		OS::get_singleton()->print("\n*** Replication, %d players, %d frames ***\n", int(PLAYER_COUNT), int(FRAMES));
+
+		// Full state with encode_variant() for comparison.
+		int full_size = 0;
+		{
+			Variant values[3] = { Vector3(), 0.0, 0 };
+			for (int i = 0; i < 3; i++) {
+				int len;
+				encode_variant(values[i], NULL, len);
+				full_size += len;
+			}
+			full_size *= PLAYER_COUNT;
+		}
+		OS::get_singleton()->print("full state with encode_variant: %d bytes per tick\n", full_size);
+
+		bool pass = true;
+
+		float drop_rates[3] = { 0, 0.05, 0.2 };
+		for (int d = 0; d < 3; d++) {
+
+			Vector<TestPlayer *> server_players;
+			Vector<TestPlayer *> client_players;
+			Node *server_root = _create_players("Server", server_players);
+			Node *client_root = _create_players("Client", client_players);
+
+			Ref<LoopbackPeer> server_peer = memnew(LoopbackPeer);
+			Ref<LoopbackPeer> client_peer = memnew(LoopbackPeer);
+			LoopbackPeer::link(server_peer.ptr(), client_peer.ptr());
+			server_peer->drop_rate = drop_rates[d];
+			client_peer->drop_rate = drop_rates[d];
+
+			Ref<MultiplayerAPI> server;
+			server.instance();
+			server->set_root_node(server_root);
+			server->set_network_peer(server_peer);
+			server->_add_peer(2);
+			_replicate(server_players, server);
+
+			Ref<MultiplayerAPI> client;
+			client.instance();
+			client->set_root_node(client_root);
+			client->set_network_peer(client_peer);
+			client->_add_peer(1);
+			_replicate(client_players, client);
+
+			if (!_run_replication("loopback, " + itos(drop_rates[d] * 100) + "% loss", server, client, server_peer, server_players, client_players, _loopback_bytes, NULL))
+				pass = false;
+
+			server->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+			client->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+			memdelete(server_root);
+			memdelete(client_root);
+		}
+
+		if (!ClassDB::class_exists("NetworkedMultiplayerENet"))
+			return pass;
+
+		// Same over real sockets, to check it holds with ENet's own framing and ordering.
+		Vector<TestPlayer *> server_players;
+		Vector<TestPlayer *> client_players;
+		Node *server_root = _create_players("Server", server_players);
+		Node *client_root = _create_players("Client", client_players);
+
+		Ref<NetworkedMultiplayerPeer> server_peer = Object::cast_to<NetworkedMultiplayerPeer>(ClassDB::instance("NetworkedMultiplayerENet"));
+		Ref<NetworkedMultiplayerPeer> client_peer = Object::cast_to<NetworkedMultiplayerPeer>(ClassDB::instance("NetworkedMultiplayerENet"));
+
+		const int port = 27341;
+		if (Error(int(server_peer->call("create_server", port))) != OK || Error(int(client_peer->call("create_client", "127.0.0.1", port))) != OK) {
+			OS::get_singleton()->print("ENet: could not open port %d, skipped\n", port);
+			memdelete(server_root);
+			memdelete(client_root);
+			return pass;
+		}
+
+		Ref<MultiplayerAPI> server;
+		server.instance();
+		server->set_root_node(server_root);
+		server->set_network_peer(server_peer);
+		_replicate(server_players, server);
+
+		Ref<MultiplayerAPI> client;
+		client.instance();
+		client->set_root_node(client_root);
+		client->set_network_peer(client_peer);
+		_replicate(client_players, client);
+
+		uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 2000;
+		while ((server->get_network_connected_peers().size() == 0 || client->get_network_connected_peers().size() == 0) && OS::get_singleton()->get_ticks_msec() < deadline) {
+			server->poll();
+			client->poll();
+			_enet_wait();
+		}
+
+		if (server->get_network_connected_peers().size() == 0) {
+			OS::get_singleton()->print("ENet: could not connect, skipped\n");
+		} else {
+			if (!_run_replication("ENet", server, client, server_peer, server_players, client_players, _enet_bytes, _enet_wait))
+				pass = false;
+		}
+
+		server_peer->call("close_connection");
+		client_peer->call("close_connection");
+		server->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		client->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+		memdelete(server_root);
+		memdelete(client_root);
+
+		return pass;
+	}
+
+	// Remote end for the network thread benchmark. Runs on its own thread and
+	// never stalls, stamping every packet with its send time. Stops sending at
+	// end_usec, but keeps servicing the peer until told to quit, so nothing is
+	// left queued behind ENet's reliable window.
+	struct StallClient {
+
+		Ref<NetworkedMultiplayerPeer> peer;
+		uint64_t end_usec;
+		volatile bool quit;
+		int sent[2];
+	};
+
+	static void _stall_client(void *p_userdata) {
+
+		StallClient *client = (StallClient *)p_userdata;
+		Ref<NetworkedMultiplayerPeer> peer = client->peer;
+
+		uint32_t seq = 0;
+		while (!client->quit) {
+
+			peer->poll();
+			while (peer->get_available_packet_count()) {
+				const uint8_t *data;
+				int size;
+				peer->get_packet(&data, size);
+			}
+
+			if (OS::get_singleton()->get_ticks_usec() < client->end_usec && peer->get_connection_status() == NetworkedMultiplayerPeer::CONNECTION_CONNECTED) {
+				for (int reliable = 0; reliable < 2; reliable++) {
+					uint8_t packet[16];
+					encode_uint32(seq++, &packet[0]);
+					encode_uint64(OS::get_singleton()->get_ticks_usec(), &packet[4]);
+					encode_uint32(reliable, &packet[12]);
+					peer->set_transfer_mode(reliable ? NetworkedMultiplayerPeer::TRANSFER_MODE_RELIABLE : NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+					if (peer->put_packet(packet, sizeof(packet)) == OK)
+						client->sent[reliable]++;
+				}
+			}
+
+			OS::get_singleton()->delay_usec(1000);
+		}
+	}
+
+	static void _receive_stamped(Ref<NetworkedMultiplayerPeer> p_peer, Vector<int> *r_latency) {
+
+		p_peer->poll();
+
+		uint64_t now = OS::get_singleton()->get_ticks_usec();
+		while (p_peer->get_available_packet_count()) {
+			const uint8_t *data;
+			int size;
+			if (p_peer->get_packet(&data, size) != OK || size != 16)
+				continue;
+			r_latency[decode_uint32(&data[12]) ? 1 : 0].push_back(now - decode_uint64(&data[4]));
+		}
+	}
+
+	// Server runs 60 FPS frames with periodic hitches, and measures how late
+	// the client's packets reach the game with ENet serviced from the main
+	// thread or from its own.
+	bool _benchmark_network_thread() {
+
+		if (!ClassDB::class_exists("NetworkedMultiplayerENet"))
+			return true;
+
+		bool pass = true;
+
+		OS::get_singleton()->print("\nENet latency with main thread stalls (client sends 1 reliable and 1 unreliable packet per msec):\n");
+		OS::get_singleton()->print("%-26s %-16s %10s %10s %10s %10s %10s %12s\n", "stalls", "servicing", "rel avg", "rel p99", "rel max", "unrel avg", "unrel p99", "unrel recv");
+
+		const int stall_usec[2] = { 100000, 1500000 };
+		const int period_usec[2] = { 500000, 2500000 };
+
+		for (int run = 0; run < 4; run++) {
+
+			const int stall = stall_usec[run / 2];
+			const int period = period_usec[run / 2];
+			const int threaded = run % 2;
+
+			Ref<NetworkedMultiplayerPeer> server_peer = Object::cast_to<NetworkedMultiplayerPeer>(ClassDB::instance("NetworkedMultiplayerENet"));
+			Ref<NetworkedMultiplayerPeer> client_peer = Object::cast_to<NetworkedMultiplayerPeer>(ClassDB::instance("NetworkedMultiplayerENet"));
+			server_peer->set("use_thread", threaded == 1);
+
+			const int port = 27342;
+			if (Error(int(server_peer->call("create_server", port))) != OK || Error(int(client_peer->call("create_client", "127.0.0.1", port))) != OK) {
+				OS::get_singleton()->print("ENet: could not open port %d, skipped\n", port);
+				return pass;
+			}
+
+			const uint64_t start = OS::get_singleton()->get_ticks_usec();
+			const uint64_t duration = 5000000;
+
+			StallClient client;
+			client.peer = client_peer;
+			client.end_usec = start + duration;
+			client.quit = false;
+			client.sent[0] = 0;
+			client.sent[1] = 0;
+			Thread *thread = Thread::create(_stall_client, &client);
+
+			Vector<int> latency[2];
+			uint64_t frame = start;
+			// Keep polling a little past the client, so nothing is still in flight.
+			while (frame < start + duration + 200000) {
+
+				_receive_stamped(server_peer, latency);
+
+				frame += 16667;
+				if (((frame - start) / period) != ((frame - 16667 - start) / period))
+					frame += stall;
+
+				uint64_t now = OS::get_singleton()->get_ticks_usec();
+				if (frame > now)
+					OS::get_singleton()->delay_usec(frame - now);
+			}
+
+			//a stall at the end may have held back the last reliable packets
+			uint64_t deadline = OS::get_singleton()->get_ticks_usec() + 2000000;
+			while (latency[1].size() < client.sent[1] && OS::get_singleton()->get_ticks_usec() < deadline) {
+				_receive_stamped(server_peer, latency);
+				OS::get_singleton()->delay_usec(1000);
+			}
+
+			client.quit = true;
+			Thread::wait_to_finish(thread);
+			memdelete(thread);
+
+			float avg[2] = { 0, 0 };
+			int p99[2] = { 0, 0 };
+			int max[2] = { 0, 0 };
+			for (int i = 0; i < 2; i++) {
+				if (latency[i].size() == 0)
+					continue;
+				latency[i].sort();
+				for (int j = 0; j < latency[i].size(); j++)
+					avg[i] += latency[i][j];
+				avg[i] /= latency[i].size();
+				p99[i] = latency[i][latency[i].size() * 99 / 100];
+				max[i] = latency[i][latency[i].size() - 1];
+			}
+
+			String label = itos(stall / 1000) + " msec every " + itos(period / 1000) + " msec";
+			OS::get_singleton()->print("%-26s %-16s %8.1fms %8.1fms %8.1fms %8.1fms %8.1fms %6d/%-5d\n", label.utf8().get_data(), threaded ? "network thread" : "main thread",
+					avg[1] / 1000.0, p99[1] / 1000.0, max[1] / 1000.0, avg[0] / 1000.0, p99[0] / 1000.0, latency[0].size(), client.sent[0]);
+
+			//reliable packets may come late, but never go missing
+			if (latency[1].size() != client.sent[1])
+				pass = false;
+
+			client_peer->call("close_connection");
+			server_peer->call("close_connection");
+		}
+
+		return pass;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		bool results[] = {
+			_benchmark_rpc(),
+			_benchmark_replication(),
+			_test_replication_ack_loss(),
+			_benchmark_network_thread()
+		};
+
+		int count = sizeof(results) / sizeof(results[0]);
+		int passed = 0;
+		for (int i = 0; i < count; i++) {
+			if (results[i])
+				passed++;
+			OS::get_singleton()->print("\t%s\n", results[i] ? "PASS" : "FAILED");
+		}
+
+		OS::get_singleton()->print("\n");
+		OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	}
+
+	virtual bool idle(float p_time) {
+
+		SceneTree::idle(p_time);
+		return true;
+	}
+};
+
+MainLoop *test() {
+
+	// Signals and bound methods need these known to ClassDB.
+	ClassDB::register_class<LoopbackPeer>();
+	ClassDB::register_class<TestPlayer>();
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestMultiplayer
@@ -0,0 +1,363 @@
+/*************************************************************************/
+/*  test_scene_tree.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_scene_tree.h"
+
+#include "core/os/os.h"
+#include "scene/3d/skeleton.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+// SceneTree benchmarks, run with:
+// godot_server --test scene_tree
+
+namespace TestSceneTree {
+
+enum {
+	GROUP_SIZE = 10000,
+	GROUP_CALLS = 100,
+	NOTIFICATION_BENCHMARK = 10000, //not handled by anyone
+	ACTOR_COUNT = 64,
+	ACTOR_PARTS = 8,
+	ACTOR_WORK = 2000,
+	PROCESS_FRAMES = 100,
+	LOOKUP_CHILDREN = 1000,
+	LOOKUPS = 100000
+};
+
+// stands in for script logic that only touches its own state
+class TestActor : public Node {
+
+	GDCLASS(TestActor, Node);
+
+	float value;
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what == NOTIFICATION_PROCESS) {
+			for (int i = 0; i < ACTOR_WORK; i++) {
+				value = Math::sin(value + i) * Math::cos(value - i);
+			}
+		}
+	}
+
+public:
+	float get_value() const { return value; }
+
+	TestActor() {
+		value = 1.0;
+		set_process(true);
+	}
+};
+
+// moves itself, one of its children and a bone on every frame, from a threaded subtree
+class TestMover : public Spatial {
+
+	GDCLASS(TestMover, Spatial);
+
+public:
+	Spatial *part;
+	Skeleton *skeleton;
+	int frames;
+	int transform_notifications;
+
+protected:
+	void _notification(int p_what) {
+
+		switch (p_what) {
+
+			case NOTIFICATION_PROCESS: {
+
+				frames++;
+				translate(Vector3(1, 0, 0));
+				part->set_translation(Vector3(0, frames, 0));
+				skeleton->set_bone_pose(0, Transform(Basis(), Vector3(0, 0, frames)));
+			} break;
+			case NOTIFICATION_TRANSFORM_CHANGED: {
+
+				transform_notifications++;
+			} break;
+		}
+	}
+
+public:
+	TestMover() {
+
+		part = memnew(Spatial);
+		add_child(part);
+
+		skeleton = memnew(Skeleton);
+		skeleton->add_bone("root");
+		add_child(skeleton);
+
+		frames = 0;
+		transform_notifications = 0;
+		set_notify_transform(true);
+		set_process(true);
+	}
+};
+
+class TestMainLoop : public SceneTree {
+
+	uint64_t _time_group_calls(const StringName &p_group, const StringName &p_method) {
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < GROUP_CALLS; i++) {
+			call_group_flags(GROUP_CALL_REALTIME, p_group, p_method);
+		}
+		return (OS::get_singleton()->get_ticks_usec() - begin) / GROUP_CALLS;
+	}
+
+	uint64_t _time_group_notifications(const StringName &p_group) {
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < GROUP_CALLS; i++) {
+			notify_group_flags(GROUP_CALL_REALTIME, p_group, NOTIFICATION_BENCHMARK);
+		}
+		return (OS::get_singleton()->get_ticks_usec() - begin) / GROUP_CALLS;
+	}
+
+	bool _benchmark_group_calls() {
+
+		OS::get_singleton()->print("\n*** group calls, %d nodes ***\n", int(GROUP_SIZE));
+
+		StringName group = "enemies";
+		Vector<Node *> nodes;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < GROUP_SIZE; i++) {
+			Node *node = memnew(Node);
+			get_root()->add_child(node);
+			node->add_to_group(group);
+			nodes.push_back(node);
+		}
+		OS::get_singleton()->print("add to group: %d usec\n", int(OS::get_singleton()->get_ticks_usec() - begin));
+
+		OS::get_singleton()->print("call_group: %d usec per call\n", int(_time_group_calls(group, "is_inside_tree")));
+		OS::get_singleton()->print("notify_group: %d usec per call\n", int(_time_group_notifications(group)));
+
+		begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < GROUP_SIZE; i += 2) {
+			nodes[i]->remove_from_group(group);
+		}
+		OS::get_singleton()->print("remove half from group: %d usec\n", int(OS::get_singleton()->get_ticks_usec() - begin));
+
+		OS::get_singleton()->print("call_group after removal: %d usec per call\n", int(_time_group_calls(group, "is_inside_tree")));
+
+		List<Node *> in_group;
+		get_nodes_in_group(group, &in_group);
+
+		for (int i = 0; i < nodes.size(); i++) {
+			memdelete(nodes[i]);
+		}
+
+		return in_group.size() == GROUP_SIZE / 2;
+	}
+
+	uint64_t _time_process_frames() {
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < PROCESS_FRAMES; i++) {
+			SceneTree::idle(1.0 / 60.0);
+		}
+		return (OS::get_singleton()->get_ticks_usec() - begin) / PROCESS_FRAMES;
+	}
+
+	bool _benchmark_threaded_process() {
+
+		OS::get_singleton()->print("\n*** threaded process, %d subtrees with %d nodes, %d worker threads ***\n", int(ACTOR_COUNT), int(ACTOR_PARTS + 1), int(get_work_pool()->get_thread_count()));
+
+		Vector<Node *> actors;
+		for (int i = 0; i < ACTOR_COUNT; i++) {
+			Node *actor = memnew(TestActor);
+			for (int j = 0; j < ACTOR_PARTS; j++) {
+				actor->add_child(memnew(TestActor));
+			}
+			get_root()->add_child(actor);
+			actors.push_back(actor);
+		}
+
+		OS::get_singleton()->print("main thread: %d usec per frame\n", int(_time_process_frames()));
+
+		for (int i = 0; i < actors.size(); i++) {
+			actors[i]->set_process_threaded(true);
+		}
+
+		OS::get_singleton()->print("threaded: %d usec per frame\n", int(_time_process_frames()));
+
+		//every node was processed once per frame, whichever thread ran it
+		float value = Object::cast_to<TestActor>(actors[0])->get_value();
+		bool same = true;
+		for (int i = 0; i < actors.size(); i++) {
+			same = same && Object::cast_to<TestActor>(actors[i])->get_value() == value;
+			for (int j = 0; j < ACTOR_PARTS; j++) {
+				same = same && Object::cast_to<TestActor>(actors[i]->get_child(j))->get_value() == value;
+			}
+		}
+
+		for (int i = 0; i < actors.size(); i++) {
+			memdelete(actors[i]);
+		}
+
+		return same;
+	}
+
+	bool _test_threaded_transforms() {
+
+		OS::get_singleton()->print("\n*** transforms and skeletons changed from %d threaded subtrees ***\n", int(ACTOR_COUNT));
+
+		Vector<TestMover *> movers;
+		for (int i = 0; i < ACTOR_COUNT; i++) {
+			TestMover *mover = memnew(TestMover);
+			mover->set_translation(Vector3(0, 0, i));
+			mover->set_process_threaded(true);
+			get_root()->add_child(mover);
+			movers.push_back(mover);
+		}
+
+		//the notifications of entering the tree are flushed first
+		SceneTree::idle(1.0 / 60.0);
+		for (int i = 0; i < movers.size(); i++) {
+			movers[i]->transform_notifications = 0;
+		}
+		int first_frames = movers[0]->frames;
+
+		_time_process_frames();
+
+		int wrong = 0;
+		for (int i = 0; i < movers.size(); i++) {
+
+			TestMover *mover = movers[i];
+			Vector3 origin(mover->frames, 0, i);
+
+			bool ok = mover->frames == first_frames + PROCESS_FRAMES;
+			ok = ok && mover->transform_notifications == PROCESS_FRAMES;
+			ok = ok && mover->get_global_transform().origin == origin;
+			ok = ok && mover->part->get_global_transform().origin == origin + Vector3(0, mover->frames, 0);
+			ok = ok && mover->skeleton->get_bone_global_pose(0).origin == Vector3(0, 0, mover->frames);
+			if (!ok) {
+				wrong++;
+			}
+		}
+
+		OS::get_singleton()->print("subtrees with a wrong transform, notification count or bone pose: %d\n", wrong);
+
+		for (int i = 0; i < movers.size(); i++) {
+			memdelete(movers[i]);
+		}
+
+		return wrong == 0;
+	}
+
+	uint64_t _time_get_node(Node *p_from, const NodePath &p_path) {
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < LOOKUPS; i++) {
+			p_from->get_node(p_path);
+		}
+		return (OS::get_singleton()->get_ticks_usec() - begin) * 1000 / LOOKUPS;
+	}
+
+	bool _benchmark_get_node() {
+
+		OS::get_singleton()->print("\n*** get_node, %d children ***\n", int(LOOKUP_CHILDREN));
+
+		Node *parent = memnew(Node);
+		parent->set_name("Parent");
+		for (int i = 0; i < LOOKUP_CHILDREN; i++) {
+			Node *child = memnew(Node);
+			child->set_name("Child" + itos(i));
+			parent->add_child(child);
+		}
+		Node *leaf = memnew(Node);
+		leaf->set_name("Leaf");
+		parent->get_child(LOOKUP_CHILDREN - 1)->add_child(leaf);
+		get_root()->add_child(parent);
+
+		NodePath child_path = "Child" + itos(LOOKUP_CHILDREN - 1);
+		NodePath nested_path = "Parent/" + String(child_path) + "/Leaf";
+
+		OS::get_singleton()->print("last child: %d nsec per lookup\n", int(_time_get_node(parent, child_path)));
+		OS::get_singleton()->print("nested path: %d nsec per lookup\n", int(_time_get_node(get_root(), nested_path)));
+
+		//changing the tree drops cached paths, this measures the name index alone
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < LOOKUPS / 100; i++) {
+			Node *child = parent->get_child(i % LOOKUP_CHILDREN);
+			child->set_name(child->get_name());
+			get_root()->get_node(nested_path);
+		}
+		OS::get_singleton()->print("nested path, tree changed before each lookup: %d nsec per lookup\n", int((OS::get_singleton()->get_ticks_usec() - begin) * 1000 / (LOOKUPS / 100)));
+
+		bool found = get_root()->get_node(nested_path) == leaf && parent->get_node(child_path) == parent->get_child(LOOKUP_CHILDREN - 1);
+
+		memdelete(parent);
+
+		return found;
+	}
+
+public:
+	virtual void init() {
+
+		SceneTree::init();
+
+		bool results[] = {
+			_benchmark_group_calls(),
+			_benchmark_threaded_process(),
+			_test_threaded_transforms(),
+			_benchmark_get_node()
+		};
+
+		int count = sizeof(results) / sizeof(results[0]);
+		int passed = 0;
+		for (int i = 0; i < count; i++) {
+			if (results[i])
+				passed++;
+			OS::get_singleton()->print("\t%s\n", results[i] ? "PASS" : "FAILED");
+		}
+
+		OS::get_singleton()->print("\n");
+		OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	}
+
+	virtual bool idle(float p_time) {
+
+		SceneTree::idle(p_time);
+		return true;
+	}
+};
+
+MainLoop *test() {
+
+	return memnew(TestMainLoop);
+}
+} // namespace TestSceneTree
@@ -0,0 +1,258 @@
+/*************************************************************************/
+/*  test_tcp.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_tcp.h"
+
+#include "core/io/tcp_server.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+
+// Server tick cost with many mostly idle loopback connections, checking
+// each one by itself against a NetSocketPoller wait, and poller waits with
+// data left unread. Run with:
+// godot_server --test tcp
+
+namespace TestTCP {
+
+enum {
+	PORT = 47124,
+	CONNECTIONS = 5000,
+	PENDING_CONNECTIONS = 16,
+	TICKS = 200,
+	SENDERS_PER_TICK = 50,
+	MESSAGE_SIZE = 32
+};
+
+// What a server does every frame with each of its peers.
+static int _service_peers(Vector<Ref<StreamPeerTCP> > &p_peers) {
+
+	uint8_t buffer[MESSAGE_SIZE * 4];
+	int received = 0;
+
+	for (int i = 0; i < p_peers.size(); i++) {
+
+		Ref<StreamPeerTCP> &peer = p_peers.write[i];
+		if (peer->get_status() != StreamPeerTCP::STATUS_CONNECTED)
+			continue;
+
+		while (peer->get_available_bytes() > 0) {
+			int read;
+			if (peer->get_partial_data(buffer, sizeof(buffer), read) != OK || read == 0)
+				break;
+			received += read;
+		}
+	}
+
+	return received;
+}
+
+static bool _run_ticks(const String &p_label, Vector<Ref<StreamPeerTCP> > &p_clients, Vector<Ref<StreamPeerTCP> > &p_peers, Ref<NetSocketPoller> p_poller) {
+
+	uint8_t message[MESSAGE_SIZE] = {};
+	uint64_t sent = 0;
+	uint64_t received = 0;
+	uint64_t tick_usec = 0;
+	RandomPCG rng(1234);
+
+	for (int t = 0; t < TICKS; t++) {
+
+		for (int i = 0; i < SENDERS_PER_TICK; i++) {
+			p_clients.write[rng.rand() % p_clients.size()]->put_data(message, MESSAGE_SIZE);
+			sent += MESSAGE_SIZE;
+		}
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		if (p_poller.is_valid())
+			p_poller->wait(0);
+		received += _service_peers(p_peers);
+		tick_usec += OS::get_singleton()->get_ticks_usec() - begin;
+	}
+
+	// Whatever was still in flight.
+	uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 1000;
+	while (received < sent && OS::get_singleton()->get_ticks_msec() < deadline) {
+		if (p_poller.is_valid())
+			p_poller->wait(10);
+		received += _service_peers(p_peers);
+	}
+
+	OS::get_singleton()->print("%s: %d usec per tick, received %d of %d bytes\n", p_label.utf8().get_data(), int(tick_usec / TICKS), int(received), int(sent));
+
+	return received == sent;
+}
+
+// Opens up to p_count loopback connections, r_peers are the server ends.
+static void _connect(Ref<TCP_Server> p_server, int p_port, int p_count, Vector<Ref<StreamPeerTCP> > &r_clients, Vector<Ref<StreamPeerTCP> > &r_peers) {
+
+	uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 20000;
+	while (r_peers.size() < p_count && OS::get_singleton()->get_ticks_msec() < deadline) {
+
+		if (r_clients.size() < p_count && r_clients.size() - r_peers.size() < 64) {
+			Ref<StreamPeerTCP> client;
+			client.instance();
+			if (client->connect_to_host(IP_Address("127.0.0.1"), p_port) != OK) {
+				OS::get_singleton()->print("out of sockets after %d connections\n", r_clients.size());
+				break;
+			}
+			r_clients.push_back(client);
+		}
+
+		while (p_server->is_connection_available()) {
+			Ref<StreamPeerTCP> peer = p_server->take_connection();
+			if (peer.is_valid())
+				r_peers.push_back(peer);
+		}
+	}
+
+	while (p_server->is_connection_available()) {
+		r_peers.push_back(p_server->take_connection());
+	}
+
+	for (int i = 0; i < r_clients.size(); i++) {
+		r_clients.write[i]->get_status(); // Finish connecting.
+	}
+}
+
+// Every watched socket has data nobody reads, each wait() must still return
+// and report all of them again.
+bool test_pending_data_wait() {
+
+	OS::get_singleton()->print("\n*** Poller wait with %d sockets left readable ***\n", int(PENDING_CONNECTIONS));
+
+	Ref<TCP_Server> server;
+	server.instance();
+	if (server->listen(PORT + 1, IP_Address("127.0.0.1")) != OK) {
+		OS::get_singleton()->print("could not listen on port %d\n", int(PORT + 1));
+		return false;
+	}
+
+	Vector<Ref<StreamPeerTCP> > clients;
+	Vector<Ref<StreamPeerTCP> > peers;
+	_connect(server, PORT + 1, PENDING_CONNECTIONS, clients, peers);
+
+	bool pass = peers.size() == PENDING_CONNECTIONS;
+
+	Ref<NetSocketPoller> poller = Ref<NetSocketPoller>(NetSocketPoller::create());
+	for (int i = 0; i < peers.size(); i++) {
+		peers.write[i]->set_poller(poller);
+	}
+
+	uint8_t message[MESSAGE_SIZE] = {};
+	for (int i = 0; i < clients.size(); i++) {
+		clients.write[i]->put_data(message, MESSAGE_SIZE);
+	}
+
+	uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 1000;
+	while (poller->get_ready_count() < peers.size() && OS::get_singleton()->get_ticks_msec() < deadline) {
+		poller->wait(10);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		poller->wait(0);
+		OS::get_singleton()->print("wait %d: %d of %d ready\n", i, poller->get_ready_count(), peers.size());
+		if (poller->get_ready_count() != peers.size())
+			pass = false;
+	}
+
+	peers.clear();
+	clients.clear();
+	server->stop();
+
+	return pass;
+}
+
+bool test_server_tick() {
+
+	OS::get_singleton()->print("\n*** TCP server tick, %d connections ***\n", int(CONNECTIONS));
+
+	Ref<TCP_Server> server;
+	server.instance();
+	if (server->listen(PORT, IP_Address("127.0.0.1")) != OK) {
+		OS::get_singleton()->print("could not listen on port %d\n", int(PORT));
+		return false;
+	}
+
+	Vector<Ref<StreamPeerTCP> > clients;
+	Vector<Ref<StreamPeerTCP> > peers;
+	_connect(server, PORT, CONNECTIONS, clients, peers);
+
+	OS::get_singleton()->print("connected: %d\n", peers.size());
+	if (peers.empty())
+		return false;
+
+	bool pass = _run_ticks("status and bytes checked per peer", clients, peers, Ref<NetSocketPoller>());
+
+	Ref<NetSocketPoller> poller = Ref<NetSocketPoller>(NetSocketPoller::create());
+	for (int i = 0; i < peers.size(); i++) {
+		peers.write[i]->set_poller(poller);
+	}
+
+	if (!_run_ticks("one poller wait, idle peers skipped", clients, peers, poller))
+		pass = false;
+
+	peers.clear();
+	clients.clear();
+	server->stop();
+
+	return pass;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_pending_data_wait,
+	test_server_tick,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestTCP
@@ -0,0 +1,339 @@
+/*************************************************************************/
+/*  test_texture_streaming.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_texture_streaming.h"
+
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "scene/resources/texture.h"
+#include "scene/resources/texture_streamer.h"
+
+// Loads a set of large streamable .stex files whole and then streamed, and
+// walks a "camera" over them so only a few need their high mipmaps at a time.
+// Resident bytes come from the streamer and from the visual server, which the
+// dummy rasterizer reports as the size of the texture images it holds. Also
+// checks a texture drawn once by a static canvas item stays resident. Run with:
+// godot_server --test texture_streaming
+
+namespace TestTextureStreaming {
+
+enum {
+	TEXTURE_COUNT = 16,
+	TEXTURE_SIZE = 1024,
+	MIN_SIZE = 64,
+	VISIBLE = 4,
+	BUDGET_MB = 24
+};
+
+static String _get_path(int p_index) {
+
+	return OS::get_singleton()->get_cache_path().plus_file("godot_test_texture_streaming_" + itos(p_index) + ".stex");
+}
+
+static void _save_stex(const String &p_path, int p_seed) {
+
+	PoolVector<uint8_t> data;
+	data.resize(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		for (int i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++) {
+			w[i * 4 + 0] = (i + p_seed * 17) & 0xFF;
+			w[i * 4 + 1] = (i / TEXTURE_SIZE) & 0xFF;
+			w[i * 4 + 2] = p_seed * 15;
+			w[i * 4 + 3] = 255;
+		}
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(TEXTURE_SIZE, TEXTURE_SIZE, false, Image::FORMAT_RGBA8, data);
+	image->generate_mipmaps();
+
+	// Same layout the texture importer writes for uncompressed, streamable textures.
+	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
+	ERR_FAIL_COND(!f);
+	f->store_8('G');
+	f->store_8('D');
+	f->store_8('S');
+	f->store_8('T');
+	f->store_16(TEXTURE_SIZE);
+	f->store_16(0);
+	f->store_16(TEXTURE_SIZE);
+	f->store_16(0);
+	f->store_32(Texture::FLAGS_DEFAULT);
+	f->store_32(Image::FORMAT_RGBA8 | StreamTexture::FORMAT_BIT_STREAM | StreamTexture::FORMAT_BIT_HAS_MIPMAPS);
+
+	PoolVector<uint8_t> mipmaps = image->get_data();
+	PoolVector<uint8_t>::Read r = mipmaps.read();
+	f->store_buffer(r.ptr(), mipmaps.size());
+	memdelete(f);
+}
+
+static uint32_t _checksum(const Ref<Image> &p_image) {
+
+	if (p_image.is_null()) {
+		return 0;
+	}
+
+	PoolVector<uint8_t> data = p_image->get_data();
+	PoolVector<uint8_t>::Read r = data.read();
+	uint32_t hash = 5381;
+	for (int i = 0; i < data.size(); i++) {
+		hash = ((hash << 5) + hash) + r[i];
+	}
+	return hash;
+}
+
+static int _get_texture_mem() {
+
+	return VS::get_singleton()->get_render_info(VS::INFO_TEXTURE_MEM_USED);
+}
+
+static void _load_all(Vector<Ref<StreamTexture> > &r_textures) {
+
+	for (int i = 0; i < TEXTURE_COUNT; i++) {
+		Ref<StreamTexture> texture;
+		texture.instance();
+		texture->load(_get_path(i));
+		r_textures.push_back(texture);
+	}
+}
+
+static void _save_all() {
+
+	for (int i = 0; i < TEXTURE_COUNT; i++) {
+		_save_stex(_get_path(i), i);
+	}
+}
+
+static void _remove_all() {
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	for (int i = 0; i < TEXTURE_COUNT; i++) {
+		da->remove(_get_path(i));
+	}
+	memdelete(da);
+}
+
+// Textures requested every frame by a moving window get their full size,
+// the budget holds, and the data matches a whole load.
+bool test_walk() {
+
+	OS::get_singleton()->print("\n*** Texture streaming, walking %d of %d textures ***\n", int(VISIBLE), int(TEXTURE_COUNT));
+
+	_save_all();
+
+	bool ok = true;
+	int base_mem = _get_texture_mem();
+
+	// Whole textures, as without streaming.
+	Vector<uint32_t> whole_checksums;
+	{
+		Vector<Ref<StreamTexture> > textures;
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		_load_all(textures);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		OS::get_singleton()->print("\nwhole:    load %5d ms, %7.2f MiB resident\n", int(usec / 1000), (_get_texture_mem() - base_mem) / 1048576.0);
+
+		for (int i = 0; i < TEXTURE_COUNT; i++) {
+			whole_checksums.push_back(_checksum(textures[i]->get_data()));
+		}
+	}
+
+	const uint64_t budget = BUDGET_MB * 1024 * 1024;
+	TextureStreamer *streamer = memnew(TextureStreamer(budget, MIN_SIZE));
+
+	{
+		Vector<Ref<StreamTexture> > textures;
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		_load_all(textures);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		streamer->process();
+		OS::get_singleton()->print("streamed: load %5d ms, %7.2f MiB resident (visual server %.2f MiB), budget %d MiB\n\n", int(usec / 1000), streamer->get_resident_bytes() / 1048576.0, (_get_texture_mem() - base_mem) / 1048576.0, BUDGET_MB);
+
+		for (int i = 0; i < TEXTURE_COUNT; i++) {
+			if (!textures[i]->is_streamed() || textures[i]->get_streamed_size() != MIN_SIZE) {
+				OS::get_singleton()->print("texture %d was not streamed from %d pixels\n", i, MIN_SIZE);
+				ok = false;
+			}
+		}
+
+		// Walk along the textures, VISIBLE of them need full resolution at a time.
+		for (int step = 0; step + VISIBLE <= TEXTURE_COUNT; step += 2) {
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			int frames = 0;
+			do {
+				for (int i = step; i < step + VISIBLE; i++) {
+					textures.write[i]->request_size(TEXTURE_SIZE);
+				}
+				streamer->flush();
+				frames++;
+			} while (streamer->get_pending_count() > 0);
+			uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+			int full = 0;
+			for (int i = 0; i < TEXTURE_COUNT; i++) {
+				if (textures[i]->get_streamed_size() == TEXTURE_SIZE) {
+					full++;
+				}
+			}
+
+			bool visible_full = true;
+			for (int i = step; i < step + VISIBLE; i++) {
+				if (textures[i]->get_streamed_size() != TEXTURE_SIZE || _checksum(textures[i]->get_data()) != whole_checksums[i]) {
+					visible_full = false;
+				}
+			}
+
+			uint64_t resident = streamer->get_resident_bytes();
+			int vs_resident = _get_texture_mem() - base_mem;
+			bool step_ok = visible_full && resident <= budget && uint64_t(vs_resident) == resident;
+			ok = ok && step_ok;
+
+			OS::get_singleton()->print("  visible %2d-%2d: %2d full size, %7.2f MiB resident (visual server %.2f MiB), %d frames %4d ms %s\n", step, step + VISIBLE - 1, full, resident / 1048576.0, vs_resident / 1048576.0, frames, int(usec / 1000), step_ok ? "" : "(FAILED)");
+		}
+	}
+
+	// Freed textures leave with the next frame.
+	streamer->process();
+	if (streamer->get_resident_bytes() != 0 || _get_texture_mem() != base_mem) {
+		OS::get_singleton()->print("textures still resident after being freed\n");
+		ok = false;
+	}
+
+	memdelete(streamer);
+	_remove_all();
+
+	return ok;
+}
+
+// Canvas items only draw again when they change, a texture drawn once must
+// not be evicted while other textures are requested every frame. Once drawn
+// small, it goes back to the mipmaps kept in memory, without the file.
+bool test_static_draw() {
+
+	OS::get_singleton()->print("\n*** Texture streaming, texture drawn once by a static canvas item ***\n");
+
+	_save_all();
+
+	bool ok = true;
+	TextureStreamer *streamer = memnew(TextureStreamer(BUDGET_MB * 1024 * 1024, MIN_SIZE));
+
+	{
+		Vector<Ref<StreamTexture> > textures;
+		_load_all(textures);
+		streamer->process();
+
+		uint32_t small_checksum = _checksum(textures[0]->get_data());
+
+		RID item = VS::get_singleton()->canvas_item_create();
+		textures[0]->draw_rect(item, Rect2(0, 0, TEXTURE_SIZE, TEXTURE_SIZE));
+		do {
+			streamer->flush();
+		} while (streamer->get_pending_count() > 0);
+
+		int drawn_size = textures[0]->get_streamed_size();
+
+		// The others take turns at full size, more than the budget allows in total.
+		for (int i = 1; i < TEXTURE_COUNT; i++) {
+			do {
+				textures.write[i]->request_size(TEXTURE_SIZE);
+				streamer->flush();
+			} while (streamer->get_pending_count() > 0);
+		}
+
+		int kept_size = textures[0]->get_streamed_size();
+		OS::get_singleton()->print("drawn once: %d pixels, after the others were requested: %d pixels\n", drawn_size, kept_size);
+		ok = ok && drawn_size == TEXTURE_SIZE && kept_size == TEXTURE_SIZE;
+
+		// Drawn small now, its high mipmaps may go once over budget. The file
+		// is gone, so the small ones can only come from memory.
+		_remove_all();
+		VS::get_singleton()->canvas_item_clear(item);
+		textures[0]->draw_rect(item, Rect2(0, 0, MIN_SIZE, MIN_SIZE));
+		streamer->process();
+		streamer->set_budget(0);
+		streamer->process();
+
+		int trimmed_size = textures[0]->get_streamed_size();
+		bool trimmed_data = _checksum(textures[0]->get_data()) == small_checksum;
+		OS::get_singleton()->print("drawn small: %d pixels, %s\n", trimmed_size, trimmed_data ? "same data as loaded" : "DATA DIFFERS");
+		ok = ok && trimmed_size == MIN_SIZE && trimmed_data;
+
+		VS::get_singleton()->free(item);
+	}
+
+	streamer->process();
+	memdelete(streamer);
+	_remove_all();
+
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_walk,
+	test_static_draw,
+	0
+
+};
+
+MainLoop *test() {
+
+	if (TextureStreamer::get_singleton()) {
+		OS::get_singleton()->print("streaming is enabled in the project settings, run without a project\n");
+		return NULL;
+	}
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestTextureStreaming
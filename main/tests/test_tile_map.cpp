@@ -0,0 +1,180 @@
+/*************************************************************************/
+/*  test_tile_map.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_tile_map.h"
+
+#include "core/image.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "scene/2d/tile_map.h"
+
+// Cell storage benchmark for large tile maps, run with:
+// godot_server --test tile_map
+
+namespace TestTileMap {
+
+enum {
+	MAP_SIZE = 1024,
+	TILE_TYPES = 8,
+	LOOKUPS = 4000000
+};
+
+static uint64_t _ticks() {
+
+	return OS::get_singleton()->get_ticks_usec();
+}
+
+static Ref<Image> _create_terrain_image() {
+
+	Ref<Image> image;
+	image.instance();
+
+	PoolVector<uint8_t> data;
+	data.resize(MAP_SIZE * MAP_SIZE);
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		RandomPCG rng(1234);
+		for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
+			//one value past the tile list leaves some holes in the map
+			w[i] = rng.rand() % (TILE_TYPES + 1);
+		}
+	}
+	image->create(MAP_SIZE, MAP_SIZE, false, Image::FORMAT_R8, data);
+
+	return image;
+}
+
+bool test_cell_storage() {
+
+	OS::get_singleton()->print("\n*** tile map, %dx%d cells ***\n", int(MAP_SIZE), int(MAP_SIZE));
+
+	PoolVector<int> tiles;
+	for (int i = 0; i < TILE_TYPES; i++) {
+		tiles.push_back(i);
+	}
+
+	Ref<Image> image = _create_terrain_image();
+	PoolVector<uint8_t> pixels = image->get_data();
+	PoolVector<uint8_t>::Read r = pixels.read();
+
+	TileMap *per_cell = memnew(TileMap);
+	TileMap *bulk = memnew(TileMap);
+
+	int expected_used = 0;
+	uint64_t begin = _ticks();
+	for (int y = 0; y < MAP_SIZE; y++) {
+		for (int x = 0; x < MAP_SIZE; x++) {
+			int value = r[y * MAP_SIZE + x];
+			per_cell->set_cell(x, y, value < TILE_TYPES ? value : TileMap::INVALID_CELL);
+			if (value < TILE_TYPES) {
+				expected_used++;
+			}
+		}
+	}
+	OS::get_singleton()->print("set_cell: %d msec\n", int((_ticks() - begin) / 1000));
+
+	begin = _ticks();
+	bulk->set_cells_from_image(image, Vector2(), tiles);
+	OS::get_singleton()->print("set_cells_from_image: %d msec\n", int((_ticks() - begin) / 1000));
+
+	int mismatches = 0;
+	for (int y = 0; y < MAP_SIZE; y++) {
+		for (int x = 0; x < MAP_SIZE; x++) {
+			if (per_cell->get_cell(x, y) != bulk->get_cell(x, y)) {
+				mismatches++;
+			}
+		}
+	}
+	OS::get_singleton()->print("mismatching cells: %d\n", mismatches);
+
+	RandomPCG rng(5678);
+	int sum = 0;
+	begin = _ticks();
+	for (int i = 0; i < LOOKUPS; i++) {
+		sum += bulk->get_cell(rng.rand() % MAP_SIZE, rng.rand() % MAP_SIZE);
+	}
+	OS::get_singleton()->print("get_cell: %d nsec per lookup (checksum %d)\n", int((_ticks() - begin) * 1000 / LOOKUPS), sum);
+
+	begin = _ticks();
+	Array used = bulk->get_used_cells();
+	OS::get_singleton()->print("get_used_cells: %d msec, %d cells\n", int((_ticks() - begin) / 1000), used.size());
+
+	begin = _ticks();
+	Rect2 used_rect = bulk->get_used_rect();
+	OS::get_singleton()->print("get_used_rect: %d msec, %s\n", int((_ticks() - begin) / 1000), String(used_rect).utf8().get_data());
+
+	begin = _ticks();
+	bulk->set_cells_rect(Rect2(0, 0, MAP_SIZE, MAP_SIZE), 0);
+	int filled = bulk->get_used_cells().size();
+	OS::get_singleton()->print("set_cells_rect (fill): %d msec, %d cells\n", int((_ticks() - begin) / 1000), filled);
+
+	begin = _ticks();
+	bulk->set_cells_rect(Rect2(0, 0, MAP_SIZE, MAP_SIZE), TileMap::INVALID_CELL);
+	int left = bulk->get_used_cells().size();
+	OS::get_singleton()->print("set_cells_rect (erase): %d msec, %d cells left\n", int((_ticks() - begin) / 1000), left);
+
+	memdelete(per_cell);
+	memdelete(bulk);
+
+	return mismatches == 0 && used.size() == expected_used && filled == MAP_SIZE * MAP_SIZE && left == 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_cell_storage,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestTileMap
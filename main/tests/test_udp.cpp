@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  test_udp.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_udp.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/packet_peer_udp.h"
+#include "core/os/os.h"
+
+// Loopback throughput of PacketPeerUDP, one packet per syscall against
+// batched sends. Run with:
+// godot_server --test udp
+
+namespace TestUDP {
+
+enum {
+	PORT = 47123,
+	PACKETS = 200000,
+	FLUSH_EVERY = 256
+};
+
+static void _benchmark(bool p_batching, int p_packet_size) {
+
+	Ref<PacketPeerUDP> receiver;
+	receiver.instance();
+	receiver->set_socket_recv_buffer_size(4 << 20);
+	if (receiver->listen(PORT, IP_Address("127.0.0.1"), 1 << 20) != OK) {
+		OS::get_singleton()->print("could not listen on port %d, skipped\n", int(PORT));
+		return;
+	}
+
+	Ref<PacketPeerUDP> sender;
+	sender.instance();
+	sender->set_socket_send_buffer_size(4 << 20);
+	sender->set_dest_address(IP_Address("127.0.0.1"), PORT);
+	sender->set_send_batching(p_batching);
+
+	Vector<uint8_t> data;
+	data.resize(p_packet_size);
+
+	int received = 0;
+	int out_of_order = 0;
+	int last = -1;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < PACKETS; i++) {
+
+		// Sequence number first, to check order and loss.
+		encode_uint32(i, data.ptrw());
+		sender->put_packet(data.ptr(), data.size());
+
+		if ((i % FLUSH_EVERY) != FLUSH_EVERY - 1 && i != PACKETS - 1)
+			continue;
+
+		sender->flush();
+		while (receiver->get_available_packet_count() > 0) {
+
+			const uint8_t *packet;
+			int size;
+			receiver->get_packet(&packet, size);
+
+			int sequence = decode_uint32(packet);
+			if (sequence <= last)
+				out_of_order++;
+			last = sequence;
+			received++;
+		}
+	}
+
+	uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, 1);
+
+	OS::get_singleton()->print("%s, %d bytes: %d kpackets/s, %d MB/s, received %d of %d, %d out of order\n", p_batching ? "batched" : "single", p_packet_size, int(uint64_t(received) * 1000 / usec), int(uint64_t(received) * p_packet_size / usec), received, int(PACKETS), out_of_order);
+
+	sender->close();
+	receiver->close();
+}
+
+MainLoop *test() {
+
+	OS::get_singleton()->print("\n*** UDP loopback, %d packets ***\n", int(PACKETS));
+
+	int sizes[3] = { 64, 512, 1400 };
+	for (int i = 0; i < 3; i++) {
+		_benchmark(false, sizes[i]);
+		_benchmark(true, sizes[i]);
+	}
+
+	return NULL;
+}
+} // namespace TestUDP
@@ -0,0 +1,160 @@
+/*************************************************************************/
+/*  test_visual_server_canvas.cpp                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_visual_server_canvas.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "servers/visual/visual_server_canvas.h"
+#include "servers/visual/visual_server_globals.h"
+
+// CPU side benchmarks of the canvas renderer. Like the scene ones, they talk
+// to VisualServerCanvas directly and are meant to be run headless, e.g.:
+// godot_server --test visual_server_canvas
+
+namespace TestVisualServerCanvas {
+
+struct BenchCanvas {
+
+	RID canvas;
+	RID ysort;
+	Vector<RID> items;
+	Vector<Vector2> positions;
+};
+
+static void _create_ysort_canvas(BenchCanvas &r_canvas, int p_item_count) {
+
+	VisualServerCanvas *vsc = VSG::canvas;
+
+	r_canvas.canvas = vsc->canvas_create();
+	r_canvas.ysort = vsc->canvas_item_create();
+	vsc->canvas_item_set_parent(r_canvas.ysort, r_canvas.canvas);
+	vsc->canvas_item_set_sort_children_by_y(r_canvas.ysort, true);
+
+	//an isometric field of sprites, created in a scrambled order
+	int side = MAX(1, int(Math::sqrt(double(p_item_count))));
+
+	r_canvas.items.resize(p_item_count);
+	r_canvas.positions.resize(p_item_count);
+	for (int i = 0; i < p_item_count; i++) {
+
+		int cell = (i * 7919) % p_item_count;
+		Vector2 pos = Vector2(cell % side, cell / side) * 16.0;
+		pos = Vector2(pos.x - pos.y, (pos.x + pos.y) * 0.5);
+
+		RID item = vsc->canvas_item_create();
+		vsc->canvas_item_set_parent(item, r_canvas.ysort);
+		vsc->canvas_item_add_rect(item, Rect2(-8, -16, 16, 16), Color(1, 1, 1));
+		vsc->canvas_item_set_transform(item, Transform2D(0, pos));
+		r_canvas.items.write[i] = item;
+		r_canvas.positions.write[i] = pos;
+	}
+}
+
+static void _free_canvas(BenchCanvas &p_canvas) {
+
+	VisualServerCanvas *vsc = VSG::canvas;
+
+	for (int i = 0; i < p_canvas.items.size(); i++) {
+		vsc->free(p_canvas.items[i]);
+	}
+	vsc->free(p_canvas.ysort);
+	vsc->free(p_canvas.canvas);
+}
+
+static void _render(BenchCanvas &p_canvas) {
+
+	VisualServerCanvas *vsc = VSG::canvas;
+	vsc->render_canvas(vsc->canvas_owner.get(p_canvas.canvas), Transform2D(), NULL, NULL, Rect2(-100000, -100000, 200000, 200000));
+}
+
+static uint64_t _time_frames(BenchCanvas &p_canvas, int p_moving, bool p_relink, int p_frames) {
+
+	VisualServerCanvas *vsc = VSG::canvas;
+	int count = p_canvas.items.size();
+
+	uint64_t usec = 0;
+	for (int f = 0; f < p_frames; f++) {
+
+		//walk a few sprites around, spread over the whole field
+		for (int i = 0; i < p_moving; i++) {
+			int idx = (i * (count / MAX(1, p_moving)) + f) % count;
+			Vector2 &pos = p_canvas.positions.write[idx];
+			pos += Vector2(Math::sin(f * 0.1 + i), Math::cos(f * 0.1 + i)) * 4.0;
+			vsc->canvas_item_set_transform(p_canvas.items[idx], Transform2D(0, pos));
+		}
+
+		if (p_relink) {
+			//changing the hierarchy forces the y-sorted list to be collected and sorted from scratch
+			vsc->canvas_item_set_parent(p_canvas.items[0], p_canvas.ysort);
+		}
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		_render(p_canvas);
+		usec += OS::get_singleton()->get_ticks_usec() - begin;
+	}
+
+	return usec / p_frames;
+}
+
+static void _benchmark_ysort() {
+
+	OS::get_singleton()->print("\n*** y-sorted canvas items ***\n");
+
+	const int counts[] = { 1000, 20000 };
+	const int frames = 60;
+
+	for (int i = 0; i < 2; i++) {
+
+		BenchCanvas canvas;
+		_create_ysort_canvas(canvas, counts[i]);
+		_render(canvas); //first frame sorts everything
+
+		uint64_t still = _time_frames(canvas, 0, false, frames);
+		uint64_t few = _time_frames(canvas, 300, false, frames);
+		uint64_t all = _time_frames(canvas, counts[i], false, frames);
+		uint64_t rebuilt = _time_frames(canvas, 300, true, frames);
+
+		OS::get_singleton()->print("items: %d, nothing moving: %d usec, 300 moving: %d usec, all moving: %d usec, 300 moving with full re-sort: %d usec\n", counts[i], int(still), int(few), int(all), int(rebuilt));
+
+		_free_canvas(canvas);
+	}
+}
+
+MainLoop *test() {
+
+	ERR_FAIL_COND_V(!VSG::canvas, NULL);
+
+	_benchmark_ysort();
+
+	return NULL;
+}
+}
@@ -0,0 +1,752 @@
+/*************************************************************************/
+/*  test_visual_server_scene.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_visual_server_scene.h"
+
+#include "core/math/bvh.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/octree.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "servers/visual/visual_server_globals.h"
+#include "servers/visual/visual_server_scene.h"
+
+// CPU side benchmarks of the scene renderer. They talk to VisualServerScene
+// directly, so they are meant to be run headless (dummy rasterizer) with a
+// single threaded render thread model, e.g.:
+// godot_server --test visual_server_scene
+
+namespace TestVisualServerScene {
+
+struct BenchScene {
+
+	RID scenario;
+	RID mesh;
+	Vector<RID> instances;
+	Transform camera_transform;
+	CameraMatrix camera_matrix;
+};
+
+static void _create_grid_scene(BenchScene &r_scene, int p_instance_count, bool p_use_bvh = false) {
+
+	VisualServerScene *vss = VSG::scene;
+
+	bool use_bvh = vss->use_bvh;
+	vss->use_bvh = p_use_bvh;
+	r_scene.scenario = vss->scenario_create();
+	vss->use_bvh = use_bvh;
+	r_scene.mesh = VSG::storage->mesh_create();
+
+	int side = MAX(1, int(Math::ceil(Math::pow(double(p_instance_count), 1.0 / 3.0))));
+	float spacing = 3.0;
+
+	r_scene.instances.resize(p_instance_count);
+	for (int i = 0; i < p_instance_count; i++) {
+
+		Vector3 pos(i % side, (i / side) % side, i / (side * side));
+		pos = (pos - Vector3(side, side, side) * 0.5) * spacing;
+
+		RID instance = vss->instance_create();
+		vss->instance_set_base(instance, r_scene.mesh);
+		vss->instance_set_custom_aabb(instance, AABB(Vector3(-0.5, -0.5, -0.5), Vector3(1, 1, 1)));
+		vss->instance_set_scenario(instance, r_scene.scenario);
+		vss->instance_set_transform(instance, Transform(Basis(), pos));
+		r_scene.instances.write[i] = instance;
+	}
+
+	vss->update_dirty_instances();
+
+	//look at the whole grid from one of its sides
+	float extent = side * spacing;
+	r_scene.camera_transform = Transform(Basis(), Vector3(0, 0, extent));
+	r_scene.camera_matrix.set_perspective(90, 16.0 / 9.0, 0.05, extent * 4.0);
+}
+
+static void _free_scene(BenchScene &p_scene) {
+
+	VisualServerScene *vss = VSG::scene;
+
+	for (int i = 0; i < p_scene.instances.size(); i++) {
+		vss->free(p_scene.instances[i]);
+	}
+	vss->free(p_scene.scenario);
+	VSG::storage->free(p_scene.mesh);
+}
+
+// Pairing and culling must not depend on the partition in use. Runs the same
+// random edits on an Octree and a BVH and compares the live pairs, tracked
+// through their callbacks, and what each returns for the same culls.
+
+struct PartitionElement {
+
+	int index;
+	AABB aabb;
+	bool pairable;
+	uint32_t type;
+	uint32_t mask;
+	bool alive;
+	OctreeElementID octree_id;
+	BVHElementID bvh_id;
+};
+
+// Pair and unpair callbacks count into their own userdata, so a callback
+// handed the wrong one shows up as unbalanced counts.
+struct PairCounter {
+
+	Map<uint64_t, int> counts;
+};
+
+static uint64_t _pair_key(const PartitionElement *p_a, const PartitionElement *p_b) {
+
+	return (uint64_t(MIN(p_a->index, p_b->index)) << 32) | uint64_t(MAX(p_a->index, p_b->index));
+}
+
+static void *_partition_pair(void *p_self, uint32_t, PartitionElement *p_a, int, uint32_t, PartitionElement *p_b, int) {
+
+	((PairCounter *)p_self)->counts[_pair_key(p_a, p_b)]++;
+	return NULL;
+}
+
+static void _partition_unpair(void *p_self, uint32_t, PartitionElement *p_a, int, uint32_t, PartitionElement *p_b, int, void *) {
+
+	((PairCounter *)p_self)->counts[_pair_key(p_a, p_b)]++;
+}
+
+static bool _get_live_pairs(const PairCounter &p_paired, const PairCounter &p_unpaired, Set<uint64_t> &r_pairs) {
+
+	r_pairs.clear();
+
+	for (const Map<uint64_t, int>::Element *E = p_paired.counts.front(); E; E = E->next()) {
+		const Map<uint64_t, int>::Element *U = p_unpaired.counts.find(E->key());
+		int live = E->get() - (U ? U->get() : 0);
+		if (live < 0 || live > 1) {
+			return false;
+		}
+		if (live) {
+			r_pairs.insert(E->key());
+		}
+	}
+
+	//unpaired without ever being paired
+	for (const Map<uint64_t, int>::Element *U = p_unpaired.counts.front(); U; U = U->next()) {
+		if (!p_paired.counts.has(U->key())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static AABB _random_aabb(RandomPCG &p_rng) {
+
+	Vector3 position(int(p_rng.rand() % 200) - 100, int(p_rng.rand() % 200) - 100, int(p_rng.rand() % 200) - 100);
+	Vector3 size(1 + p_rng.rand() % 10, 1 + p_rng.rand() % 10, 1 + p_rng.rand() % 10);
+	if (p_rng.rand() % 20 == 0) {
+		size = Vector3(); //points pair too
+	}
+	return AABB(position, size);
+}
+
+template <class T>
+static bool _same_results(T **p_a, int p_a_count, T **p_b, int p_b_count) {
+
+	if (p_a_count != p_b_count) {
+		return false;
+	}
+
+	Set<T *> a;
+	for (int i = 0; i < p_a_count; i++) {
+		a.insert(p_a[i]);
+	}
+	for (int i = 0; i < p_b_count; i++) {
+		if (!a.has(p_b[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool _test_partition_pairing() {
+
+	OS::get_singleton()->print("\n*** Octree and BVH pairing ***\n");
+
+	const int element_count = 1000;
+	const int edits = 20000;
+
+	Octree<PartitionElement, true> octree;
+	BVH<PartitionElement, true> bvh;
+
+	PairCounter octree_paired;
+	PairCounter octree_unpaired;
+	PairCounter bvh_paired;
+	PairCounter bvh_unpaired;
+	octree.set_pair_callback(_partition_pair, &octree_paired);
+	octree.set_unpair_callback(_partition_unpair, &octree_unpaired);
+	bvh.set_pair_callback(_partition_pair, &bvh_paired);
+	bvh.set_unpair_callback(_partition_unpair, &bvh_unpaired);
+
+	Vector<PartitionElement> elements;
+	elements.resize(element_count);
+	for (int i = 0; i < element_count; i++) {
+		elements.write[i].index = i;
+		elements.write[i].alive = false;
+	}
+
+	PartitionElement *octree_result[element_count];
+	PartitionElement *bvh_result[element_count];
+
+	RandomPCG rng(1234);
+	Set<uint64_t> octree_pairs;
+	Set<uint64_t> bvh_pairs;
+	int checks = 0;
+	int max_pairs = 0;
+	bool pass = true;
+
+	for (int i = 0; i < edits && pass; i++) {
+
+		PartitionElement &e = elements.write[rng.rand() % element_count];
+		int op = rng.rand() % 10;
+
+		if (!e.alive) {
+
+			//like lights, one in ten pairs with the geometry around it
+			bool light = rng.rand() % 10 == 0;
+			e.type = light ? 2 : 1;
+			e.pairable = light;
+			e.mask = light ? 1 : 0;
+			e.aabb = _random_aabb(rng);
+			if (light) {
+				e.aabb.size *= 4;
+			}
+			e.octree_id = octree.create(&e, e.aabb, 0, e.pairable, e.type, e.mask);
+			e.bvh_id = bvh.create(&e, e.aabb, 0, e.pairable, e.type, e.mask);
+			e.alive = true;
+
+		} else if (op < 6) {
+
+			if (op < 4) {
+				e.aabb.position += Vector3(int(rng.rand() % 5) - 2, int(rng.rand() % 5) - 2, int(rng.rand() % 5) - 2);
+			} else {
+				e.aabb = _random_aabb(rng);
+			}
+			octree.move(e.octree_id, e.aabb);
+			bvh.move(e.bvh_id, e.aabb);
+
+		} else if (op < 7) {
+
+			e.mask = rng.rand() % 2;
+			octree.set_pairable(e.octree_id, e.pairable, e.type, e.mask);
+			bvh.set_pairable(e.bvh_id, e.pairable, e.type, e.mask);
+
+		} else if (op < 8) {
+
+			octree.erase(e.octree_id);
+			bvh.erase(e.bvh_id);
+			e.alive = false;
+		}
+
+		if (i % 50 != 0) {
+			continue;
+		}
+
+		if (!_get_live_pairs(octree_paired, octree_unpaired, octree_pairs) || !_get_live_pairs(bvh_paired, bvh_unpaired, bvh_pairs)) {
+			OS::get_singleton()->print("unbalanced pair callbacks after %d edits\n", i + 1);
+			pass = false;
+			break;
+		}
+		if (octree_pairs.size() != bvh_pairs.size()) {
+			OS::get_singleton()->print("%d pairs in the Octree, %d in the BVH after %d edits\n", octree_pairs.size(), bvh_pairs.size(), i + 1);
+			pass = false;
+			break;
+		}
+		for (Set<uint64_t>::Element *E = octree_pairs.front(); E; E = E->next()) {
+			if (!bvh_pairs.has(E->get())) {
+				OS::get_singleton()->print("pair %d-%d missing from the BVH after %d edits\n", int(E->get() >> 32), int(E->get() & 0xFFFFFFFF), i + 1);
+				pass = false;
+				break;
+			}
+		}
+		if (!pass) {
+			break;
+		}
+		max_pairs = MAX(max_pairs, octree_pairs.size());
+
+		AABB box = _random_aabb(rng);
+		box.size *= 5;
+		int octree_count = octree.cull_aabb(box, octree_result, element_count);
+		int bvh_count = bvh.cull_aabb(box, bvh_result, element_count);
+		if (!_same_results(octree_result, octree_count, bvh_result, bvh_count)) {
+			OS::get_singleton()->print("cull_aabb found %d in the Octree, %d in the BVH after %d edits\n", octree_count, bvh_count, i + 1);
+			pass = false;
+		}
+
+		CameraMatrix camera;
+		camera.set_perspective(70, 1.5, 0.1, 150);
+		Transform camera_transform(Basis(Vector3(0, 1, 0), rng.randf() * Math_PI * 2.0), Vector3(rng.rand() % 50, rng.rand() % 50, rng.rand() % 50));
+		Vector<Plane> planes = camera.get_projection_planes(camera_transform);
+		octree_count = octree.cull_convex(planes, octree_result, element_count, 1);
+		bvh_count = bvh.cull_convex(planes, bvh_result, element_count, 1);
+		if (!_same_results(octree_result, octree_count, bvh_result, bvh_count)) {
+			OS::get_singleton()->print("cull_convex found %d in the Octree, %d in the BVH after %d edits\n", octree_count, bvh_count, i + 1);
+			pass = false;
+		}
+
+		checks++;
+	}
+
+	OS::get_singleton()->print("%d edits, %d comparisons, up to %d pairs\n", edits, checks, max_pairs);
+
+	for (int i = 0; i < element_count; i++) {
+		if (elements[i].alive) {
+			octree.erase(elements[i].octree_id);
+			bvh.erase(elements[i].bvh_id);
+		}
+	}
+
+	return pass;
+}
+
+static uint64_t _time_prepare_scene(BenchScene &p_scene, int p_iterations) {
+
+	VisualServerScene *vss = VSG::scene;
+
+	//warm up, the first pass also rebuilds dirty light and probe lists
+	vss->_prepare_scene(p_scene.camera_transform, p_scene.camera_matrix, false, RID(), 0xFFFFFFFF, p_scene.scenario, RID(), RID(), RID());
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		vss->_prepare_scene(p_scene.camera_transform, p_scene.camera_matrix, false, RID(), 0xFFFFFFFF, p_scene.scenario, RID(), RID(), RID());
+	}
+	return (OS::get_singleton()->get_ticks_usec() - begin) / p_iterations;
+}
+
+static bool _benchmark_prepare_scene() {
+
+	OS::get_singleton()->print("\n*** _prepare_scene ***\n");
+
+	VisualServerScene *vss = VSG::scene;
+	bool threaded = vss->threaded_cull;
+
+	const int counts[] = { 1000, 10000, 60000 };
+	bool pass = true;
+
+	for (int i = 0; i < 3; i++) {
+
+		BenchScene scene;
+		_create_grid_scene(scene, counts[i]);
+
+		vss->threaded_cull = false;
+		uint64_t serial = _time_prepare_scene(scene, 50);
+		int visible = vss->instance_cull_count;
+
+		vss->threaded_cull = true;
+		uint64_t parallel = _time_prepare_scene(scene, 50);
+
+		OS::get_singleton()->print("instances: %d, visible: %d, serial: %d usec, threaded (%d workers): %d usec\n", counts[i], visible, int(serial), int(vss->cull_work_pool.get_thread_count()), int(parallel));
+
+		if (vss->instance_cull_count != visible) {
+			OS::get_singleton()->print("threaded cull found %d visible instances\n", vss->instance_cull_count);
+			pass = false;
+		}
+
+		_free_scene(scene);
+	}
+
+	vss->threaded_cull = threaded;
+
+	return pass;
+}
+
+static bool _benchmark_moving_crowd() {
+
+	OS::get_singleton()->print("\n*** moving crowd, Octree vs BVH ***\n");
+
+	VisualServerScene *vss = VSG::scene;
+
+	const int instance_count = 60000;
+	const int moving_count = 10000;
+	const int frames = 30;
+	const float speeds[] = { 0.05, 1.0 };
+	int visible[2][2];
+
+	for (int i = 0; i < 2; i++) {
+
+		BenchScene scene;
+		_create_grid_scene(scene, instance_count, i == 1);
+
+		Vector<Transform> xforms;
+		xforms.resize(moving_count);
+		for (int j = 0; j < moving_count; j++) {
+			xforms.write[j] = vss->instance_owner.get(scene.instances[j])->transform;
+		}
+
+		for (int s = 0; s < 2; s++) {
+
+			uint64_t move_usec = 0;
+			uint64_t cull_usec = 0;
+
+			for (int f = 0; f < frames; f++) {
+
+				uint64_t begin = OS::get_singleton()->get_ticks_usec();
+				for (int j = 0; j < moving_count; j++) {
+					Vector3 dir = Vector3(Math::sin(j * 0.1), 0, Math::cos(j * 0.1));
+					xforms.write[j].origin += dir * speeds[s];
+					vss->instance_set_transform(scene.instances[j], xforms[j]);
+				}
+				vss->update_dirty_instances();
+
+				uint64_t mid = OS::get_singleton()->get_ticks_usec();
+				vss->_prepare_scene(scene.camera_transform, scene.camera_matrix, false, RID(), 0xFFFFFFFF, scene.scenario, RID(), RID(), RID());
+
+				uint64_t end = OS::get_singleton()->get_ticks_usec();
+				move_usec += mid - begin;
+				cull_usec += end - mid;
+			}
+
+			visible[i][s] = vss->instance_cull_count;
+			OS::get_singleton()->print("%s, speed %.2f: update %d usec, cull %d usec per frame, %d visible\n", i == 1 ? "BVH" : "Octree", speeds[s], int(move_usec / frames), int(cull_usec / frames), visible[i][s]);
+		}
+
+		_free_scene(scene);
+	}
+
+	//both see the same crowd after the same moves
+	return visible[0][0] == visible[1][0] && visible[0][1] == visible[1][1];
+}
+
+// True if the box is behind the wall (in the z = p_wall_z plane, facing the
+// eye) and every ray from the eye to one of its corners goes through it.
+static bool _is_hidden_by_wall(const Vector3 &p_eye, const AABB &p_aabb, float p_wall_z, const Rect2 &p_wall) {
+
+	for (int i = 0; i < 8; i++) {
+
+		Vector3 corner = p_aabb.get_endpoint(i);
+		if (corner.z >= p_wall_z) {
+			return false;
+		}
+
+		Vector3 hit = p_eye + (corner - p_eye) * ((p_eye.z - p_wall_z) / (p_eye.z - corner.z));
+		if (!p_wall.has_point(Point2(hit.x, hit.y))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool _benchmark_occlusion() {
+
+	OS::get_singleton()->print("\n*** occlusion culling ***\n");
+
+	VisualServerScene *vss = VSG::scene;
+	bool occlusion_culling = vss->occlusion_culling;
+
+	BenchScene scene;
+	_create_grid_scene(scene, 60000);
+
+	//a wall between the camera and the left half of the grid
+	float extent = scene.camera_transform.origin.z;
+	float wall_z = extent * 0.5 + 1.0;
+
+	PoolVector<Vector3> vertices;
+	vertices.push_back(Vector3(-extent, -extent, wall_z));
+	vertices.push_back(Vector3(-2.0, -extent, wall_z));
+	vertices.push_back(Vector3(-2.0, extent, wall_z));
+	vertices.push_back(Vector3(-extent, extent, wall_z));
+
+	PoolVector<int> indices;
+	const int quad[6] = { 0, 1, 2, 0, 2, 3 };
+	for (int i = 0; i < 6; i++) {
+		indices.push_back(quad[i]);
+	}
+
+	RID occluder = vss->occluder_create();
+	vss->occluder_set_mesh(occluder, vertices, indices);
+	RID occluder_instance = vss->instance_create();
+	vss->instance_set_base(occluder_instance, occluder);
+	vss->instance_set_scenario(occluder_instance, scene.scenario);
+	vss->update_dirty_instances();
+
+	vss->occlusion_culling = false;
+	uint64_t off = _time_prepare_scene(scene, 20);
+	int visible_off = vss->instance_cull_count;
+
+	Vector<bool> was_visible;
+	was_visible.resize(scene.instances.size());
+	for (int i = 0; i < scene.instances.size(); i++) {
+		was_visible.write[i] = vss->instance_owner.get(scene.instances[i])->last_render_pass == vss->render_pass;
+	}
+
+	vss->occlusion_culling = true;
+	uint64_t on = _time_prepare_scene(scene, 20);
+	int visible_on = vss->instance_cull_count;
+
+	//only instances the wall hides completely may be culled, and the depth
+	//buffer is coarse, so a few of those along its edges can stay visible
+	Rect2 wall(-extent, -extent, extent - 2.0, extent * 2.0);
+	int hidden = 0;
+	int culled = 0;
+	int wrongly_culled = 0;
+	for (int i = 0; i < scene.instances.size(); i++) {
+
+		if (!was_visible[i]) {
+			continue;
+		}
+
+		VisualServerScene::Instance *ins = vss->instance_owner.get(scene.instances[i]);
+		bool is_hidden = _is_hidden_by_wall(scene.camera_transform.origin, ins->transformed_aabb, wall_z, wall);
+		if (is_hidden) {
+			hidden++;
+		}
+		if (ins->last_render_pass != vss->render_pass) {
+			if (is_hidden) {
+				culled++;
+			} else {
+				wrongly_culled++;
+			}
+		}
+	}
+
+	OS::get_singleton()->print("buffer %dx%d, visible without occlusion: %d (%d usec), with occlusion: %d (%d usec)\n", vss->occlusion_culler.get_width(), vss->occlusion_culler.get_height(), visible_off, int(off), visible_on, int(on));
+	OS::get_singleton()->print("hidden by the wall: %d, culled: %d, wrongly culled: %d\n", hidden, culled, wrongly_culled);
+
+	vss->free(occluder_instance);
+	vss->free(occluder);
+	_free_scene(scene);
+
+	vss->occlusion_culling = occlusion_culling;
+
+	return wrongly_culled == 0 && visible_off - visible_on == culled && culled >= hidden * 0.9;
+}
+
+static bool _benchmark_instance_batching() {
+
+	OS::get_singleton()->print("\n*** instance batching ***\n");
+
+	VisualServerScene *vss = VSG::scene;
+
+	BenchScene scene;
+	_create_grid_scene(scene, 20000);
+
+	//spread the instances over a few meshes, so several batches are built
+	const int mesh_count = 4;
+	RID meshes[mesh_count];
+	for (int i = 0; i < mesh_count; i++) {
+		meshes[i] = VSG::storage->mesh_create();
+	}
+	for (int i = 0; i < scene.instances.size(); i++) {
+		vss->instance_set_base(scene.instances[i], meshes[i % mesh_count]);
+		vss->instance_set_custom_aabb(scene.instances[i], AABB(Vector3(-0.5, -0.5, -0.5), Vector3(1, 1, 1)));
+	}
+	vss->update_dirty_instances();
+
+	vss->instance_batching = false;
+	uint64_t off = _time_prepare_scene(scene, 20);
+	int items_off = vss->instance_cull_count;
+
+	vss->instance_batching = true;
+	vss->update_render_info();
+	uint64_t on = _time_prepare_scene(scene, 20);
+	int items_on = vss->instance_cull_count;
+	vss->update_render_info();
+
+	OS::get_singleton()->print("render list items without batching: %d (%d usec), with batching: %d (%d usec), instances batched over %d passes: %d\n", items_off, int(off), items_on, int(on), 21, vss->get_instances_batched_in_frame());
+
+	_free_scene(scene);
+	for (int i = 0; i < mesh_count; i++) {
+		VSG::storage->free(meshes[i]);
+	}
+
+	return items_on < items_off;
+}
+
+static bool _benchmark_mesh_lod() {
+
+	OS::get_singleton()->print("\n*** mesh LOD selection ***\n");
+
+	VisualServerScene *vss = VSG::scene;
+
+	BenchScene scene;
+	_create_grid_scene(scene, 20000);
+
+	Vector<RID> lods;
+	lods.push_back(VSG::storage->mesh_create());
+	lods.push_back(VSG::storage->mesh_create());
+	//the grid spans screen ratios of about 0.007 to 0.019 from the camera
+	Vector<float> ratios;
+	ratios.push_back(0.016);
+	ratios.push_back(0.01);
+	VSG::storage->mesh_set_lods(scene.mesh, lods, ratios);
+
+	//setting the base again refreshes the LOD table cached by the instances
+	for (int i = 0; i < scene.instances.size(); i++) {
+		vss->instance_set_base(scene.instances[i], scene.mesh);
+		vss->instance_set_custom_aabb(scene.instances[i], AABB(Vector3(-0.5, -0.5, -0.5), Vector3(1, 1, 1)));
+	}
+	vss->update_dirty_instances();
+
+	bool mesh_lod = vss->mesh_lod;
+
+	vss->mesh_lod = false;
+	uint64_t off = _time_prepare_scene(scene, 20);
+
+	vss->mesh_lod = true;
+	uint64_t on = _time_prepare_scene(scene, 20);
+
+	int level_counts[3] = { 0, 0, 0 };
+	for (int i = 0; i < vss->instance_cull_count; i++) {
+		RID base = vss->instance_cull_result[i]->base;
+		level_counts[base == lods[0] ? 1 : (base == lods[1] ? 2 : 0)]++;
+	}
+
+	OS::get_singleton()->print("prepare without LOD: %d usec, with LOD: %d usec, instances per level: %d / %d / %d\n", int(off), int(on), level_counts[0], level_counts[1], level_counts[2]);
+
+	vss->mesh_lod = mesh_lod;
+
+	_free_scene(scene);
+	for (int i = 0; i < lods.size(); i++) {
+		VSG::storage->free(lods[i]);
+	}
+
+	//the near end of the grid keeps the full mesh, the far end reaches both levels
+	return level_counts[0] > 0 && level_counts[1] > 0 && level_counts[2] > 0;
+}
+
+static bool _is_lod_selected(RID p_scenario, RID p_view, float p_distance, RID p_lod_mesh) {
+
+	VisualServerScene *vss = VSG::scene;
+
+	CameraMatrix camera_matrix;
+	camera_matrix.set_perspective(90, 1.0, 0.05, 100.0);
+	vss->_prepare_scene(Transform(Basis(), Vector3(0, 0, p_distance)), camera_matrix, false, RID(), 0xFFFFFFFF, p_scenario, RID(), RID(), p_view);
+
+	return vss->instance_cull_count == 1 && vss->instance_cull_result[0]->base == p_lod_mesh;
+}
+
+static bool _test_mesh_lod_views() {
+
+	OS::get_singleton()->print("\n*** mesh LOD hysteresis per view ***\n");
+
+	VisualServerScene *vss = VSG::scene;
+
+	RID scenario = vss->scenario_create();
+	RID mesh = VSG::storage->mesh_create();
+	RID lod_mesh = VSG::storage->mesh_create();
+
+	Vector<RID> lods;
+	lods.push_back(lod_mesh);
+	Vector<float> ratios;
+	ratios.push_back(0.1);
+	VSG::storage->mesh_set_lods(mesh, lods, ratios);
+
+	RID instance = vss->instance_create();
+	vss->instance_set_base(instance, mesh);
+	vss->instance_set_custom_aabb(instance, AABB(Vector3(-0.5, -0.5, -0.5), Vector3(1, 1, 1)));
+	vss->instance_set_scenario(instance, scenario);
+	vss->update_dirty_instances();
+
+	RID near_view = vss->camera_create();
+	RID far_view = vss->camera_create();
+
+	bool mesh_lod = vss->mesh_lod;
+	float hysteresis = vss->mesh_lod_hysteresis;
+	vss->mesh_lod = true;
+	vss->mesh_lod_hysteresis = 0.1;
+
+	//the level switches at a distance of about 8.66, both views then stay inside the hysteresis band
+	bool pass = !_is_lod_selected(scenario, near_view, 4, lod_mesh);
+	pass = pass && _is_lod_selected(scenario, far_view, 20, lod_mesh);
+
+	for (int i = 0; i < 4; i++) {
+		pass = pass && !_is_lod_selected(scenario, near_view, 9, lod_mesh);
+		pass = pass && _is_lod_selected(scenario, far_view, 8.3, lod_mesh);
+	}
+
+	OS::get_singleton()->print("views kept their own level: %s\n", pass ? "yes" : "no");
+
+	vss->mesh_lod = mesh_lod;
+	vss->mesh_lod_hysteresis = hysteresis;
+
+	vss->free(near_view);
+	vss->free(far_view);
+	vss->free(instance);
+	vss->free(scenario);
+	VSG::storage->free(lod_mesh);
+	VSG::storage->free(mesh);
+
+	return pass;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	_test_partition_pairing,
+	_benchmark_prepare_scene,
+	_benchmark_moving_crowd,
+	_benchmark_occlusion,
+	_benchmark_mesh_lod,
+	_test_mesh_lod_views,
+	_benchmark_instance_batching,
+	0
+
+};
+
+MainLoop *test() {
+
+	ERR_FAIL_COND_V(!VSG::scene, NULL);
+
+	//the culling benchmarks measure the cull result, keep it unmerged
+	bool instance_batching = VSG::scene->instance_batching;
+	VSG::scene->instance_batching = false;
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	VSG::scene->instance_batching = instance_batching;
+
+	return NULL;
+}
+} // namespace TestVisualServerScene
@@ -0,0 +1,499 @@
+/*************************************************************************/
+/*  test_websocket.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_websocket.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/networked_multiplayer_peer.h"
+#include "core/io/stream_peer_tcp.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+// Loopback load test for WebSocketServer with many clients, serviced from the
+// main thread or from its own thread. The clients are minimal WebSocket
+// implementations over plain TCP, run on a thread of their own so they do not
+// count against the server's main thread. Run with:
+// godot_server --test websocket
+
+namespace TestWebSocket {
+
+enum {
+	PORT = 47126,
+	CLIENTS = 2000,
+	CONNECTING_MAX = 64,
+	FAN_IN_MESSAGES = 20,
+	FAN_IN_SIZE = 64,
+	FAN_OUT_MESSAGES = 50,
+	FAN_OUT_SIZE = 512,
+	CLIENT_BUFFER = 16384,
+	TIMEOUT_MSEC = 60000
+};
+
+static const char *_handshake =
+		"GET / HTTP/1.1\r\n"
+		"Host: 127.0.0.1\r\n"
+		"Upgrade: websocket\r\n"
+		"Connection: Upgrade\r\n"
+		"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+		"Sec-WebSocket-Version: 13\r\n\r\n";
+
+class LoadClients {
+
+	enum State {
+		STATE_IDLE,
+		STATE_CONNECTING,
+		STATE_UPGRADING,
+		STATE_OPEN,
+		STATE_FAILED
+	};
+
+	struct Client {
+		Ref<StreamPeerTCP> tcp;
+		State state;
+		int to_send;
+		int in_size;
+		uint8_t in[CLIENT_BUFFER];
+	};
+
+	Client *clients;
+	Ref<NetSocketPoller> poller;
+	Thread *thread;
+	volatile bool quit;
+	volatile uint32_t send_requested;
+
+	static void _thread_func(void *p_userdata) {
+
+		LoadClients *self = (LoadClients *)p_userdata;
+		while (!self->quit) {
+			self->_update();
+		}
+	}
+
+	void _update() {
+
+		poller->wait(1);
+
+		if (send_requested) {
+			for (int i = 0; i < CLIENTS; i++) {
+				clients[i].to_send = send_requested;
+			}
+			send_requested = 0;
+		}
+
+		int connecting = 0;
+		for (int i = 0; i < CLIENTS; i++) {
+
+			Client &c = clients[i];
+			switch (c.state) {
+				case STATE_IDLE: {
+
+					if (connecting >= CONNECTING_MAX)
+						break;
+					connecting++;
+					c.state = c.tcp->connect_to_host(IP_Address("127.0.0.1"), PORT) == OK ? STATE_CONNECTING : STATE_FAILED;
+				} break;
+				case STATE_CONNECTING: {
+
+					connecting++;
+					StreamPeerTCP::Status status = c.tcp->get_status();
+					if (status == StreamPeerTCP::STATUS_CONNECTED) {
+						c.tcp->put_data((const uint8_t *)_handshake, strlen(_handshake));
+						c.state = STATE_UPGRADING;
+					} else if (status != StreamPeerTCP::STATUS_CONNECTING) {
+						c.state = STATE_FAILED;
+					}
+				} break;
+				case STATE_UPGRADING: {
+
+					connecting++;
+					_receive(c);
+				} break;
+				case STATE_OPEN: {
+
+					_receive(c);
+					if (c.to_send > 0) {
+						_send(c);
+						c.to_send--;
+					}
+				} break;
+				default: {
+				}
+			}
+		}
+	}
+
+	void _send(Client &p_client) {
+
+		// Binary frame, masked with a zero key as clients must mask.
+		uint8_t frame[6 + FAN_IN_SIZE] = {};
+		frame[0] = 0x82;
+		frame[1] = 0x80 | FAN_IN_SIZE;
+		p_client.tcp->put_data(frame, sizeof(frame));
+	}
+
+	void _receive(Client &p_client) {
+
+		while (p_client.tcp->get_available_bytes() > 0) {
+
+			int read = 0;
+			if (p_client.tcp->get_partial_data(&p_client.in[p_client.in_size], CLIENT_BUFFER - p_client.in_size, read) != OK || read == 0)
+				break;
+			p_client.in_size += read;
+
+			int pos = 0;
+			if (p_client.state == STATE_UPGRADING) {
+				for (int i = 3; i < p_client.in_size; i++) {
+					if (p_client.in[i - 3] == '\r' && p_client.in[i - 2] == '\n' && p_client.in[i - 1] == '\r' && p_client.in[i] == '\n') {
+						bool ok = p_client.in_size > 12 && memcmp(p_client.in, "HTTP/1.1 101", 12) == 0;
+						p_client.state = ok ? STATE_OPEN : STATE_FAILED;
+						if (ok)
+							atomic_increment(&open_count);
+						pos = i + 1;
+						break;
+					}
+				}
+			}
+
+			if (p_client.state == STATE_OPEN)
+				pos = _parse(p_client, pos);
+
+			p_client.in_size -= pos;
+			memmove(p_client.in, &p_client.in[pos], p_client.in_size);
+		}
+	}
+
+	// Server frames are not masked. Payloads start with the time they were sent.
+	int _parse(Client &p_client, int p_pos) {
+
+		const uint8_t *in = p_client.in;
+		while (p_client.in_size - p_pos >= 2) {
+
+			int header = 2;
+			uint64_t size = in[p_pos + 1] & 0x7F;
+			if (size == 126) {
+				header = 4;
+				if (p_client.in_size - p_pos < header)
+					break;
+				size = (in[p_pos + 2] << 8) | in[p_pos + 3];
+			} else if (size == 127) {
+				header = 10;
+				if (p_client.in_size - p_pos < header)
+					break;
+				size = 0;
+				for (int i = 0; i < 8; i++) {
+					size = (size << 8) | in[p_pos + 2 + i];
+				}
+			}
+
+			if ((uint64_t)(p_client.in_size - p_pos - header) < size)
+				break;
+
+			if (size >= 8) {
+				uint64_t latency = OS::get_singleton()->get_ticks_usec() - decode_uint64(&in[p_pos + header]);
+				latency_sum += latency;
+				latency_max = MAX(latency_max, latency);
+			}
+			frames++;
+			bytes += size;
+			p_pos += header + size;
+		}
+		return p_pos;
+	}
+
+public:
+	volatile uint32_t open_count;
+	// Only written by the client thread.
+	volatile uint64_t frames;
+	volatile uint64_t bytes;
+	volatile uint64_t latency_sum;
+	volatile uint64_t latency_max;
+
+	void start() {
+
+		quit = false;
+		thread = Thread::create(_thread_func, this);
+	}
+
+	// Every open client sends p_count messages, one per update.
+	void send(int p_count) {
+
+		send_requested = p_count;
+	}
+
+	void reset_stats() {
+
+		frames = 0;
+		bytes = 0;
+		latency_sum = 0;
+		latency_max = 0;
+	}
+
+	LoadClients() {
+
+		poller = Ref<NetSocketPoller>(NetSocketPoller::create());
+		clients = memnew_arr(Client, CLIENTS);
+		for (int i = 0; i < CLIENTS; i++) {
+			clients[i].tcp.instance();
+			clients[i].tcp->set_poller(poller);
+			clients[i].state = STATE_IDLE;
+			clients[i].to_send = 0;
+			clients[i].in_size = 0;
+		}
+		thread = NULL;
+		quit = true;
+		send_requested = 0;
+		open_count = 0;
+		reset_stats();
+	}
+
+	~LoadClients() {
+
+		quit = true;
+		if (thread) {
+			Thread::wait_to_finish(thread);
+			memdelete(thread);
+		}
+		memdelete_arr(clients);
+	}
+};
+
+// Stands in for a lobby's game code, reading whatever the clients send.
+class Lobby : public Object {
+
+	GDCLASS(Lobby, Object);
+
+	Object *server;
+	Map<int, Ref<PacketPeer> > peers;
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("_client_connected", "id", "protocol"), &Lobby::_client_connected);
+		ClassDB::bind_method(D_METHOD("_client_disconnected", "id", "was_clean_close"), &Lobby::_client_disconnected);
+		ClassDB::bind_method(D_METHOD("_data_received", "id"), &Lobby::_data_received);
+	}
+
+public:
+	int received;
+
+	void _client_connected(int p_id, const String &p_protocol) {
+
+		Ref<PacketPeer> peer = server->call("get_peer", p_id);
+		peers[p_id] = peer;
+	}
+
+	void _client_disconnected(int p_id, bool p_was_clean) {
+
+		peers.erase(p_id);
+	}
+
+	void _data_received(int p_id) {
+
+		Map<int, Ref<PacketPeer> >::Element *E = peers.find(p_id);
+		if (!E)
+			return;
+
+		const uint8_t *buffer;
+		int size;
+		while (E->get()->get_available_packet_count() > 0 && E->get()->get_packet(&buffer, size) == OK) {
+			received++;
+		}
+	}
+
+	int get_peer_count() const {
+
+		return peers.size();
+	}
+
+	// What a server without broadcast_packet() does.
+	void put_each(const uint8_t *p_buffer, int p_size) {
+
+		for (Map<int, Ref<PacketPeer> >::Element *E = peers.front(); E; E = E->next()) {
+			E->get()->put_packet(p_buffer, p_size);
+		}
+	}
+
+	void setup(Object *p_server) {
+
+		server = p_server;
+		received = 0;
+		server->connect("client_connected", this, "_client_connected");
+		server->connect("client_disconnected", this, "_client_disconnected");
+		server->connect("data_received", this, "_data_received");
+	}
+};
+
+// Main thread frames, paced as a game would. Keeps the time spent in the
+// server apart from the time it all took.
+class Frames {
+
+	NetworkedMultiplayerPeer *server;
+	uint64_t begin;
+	uint64_t frame_begin;
+	uint64_t deadline;
+
+public:
+	int count;
+	uint64_t busy;
+
+	// False when out of time.
+	bool begin_frame() {
+
+		if (count > 0)
+			OS::get_singleton()->delay_usec(1000); // Rest of the previous frame.
+
+		frame_begin = OS::get_singleton()->get_ticks_usec();
+		return OS::get_singleton()->get_ticks_msec() < deadline;
+	}
+
+	void end_frame() {
+
+		server->poll();
+		busy += OS::get_singleton()->get_ticks_usec() - frame_begin;
+		count++;
+	}
+
+	uint64_t get_wall_usec() const {
+
+		return OS::get_singleton()->get_ticks_usec() - begin;
+	}
+
+	Frames(NetworkedMultiplayerPeer *p_server) {
+
+		server = p_server;
+		begin = OS::get_singleton()->get_ticks_usec();
+		frame_begin = begin;
+		deadline = OS::get_singleton()->get_ticks_msec() + TIMEOUT_MSEC;
+		count = 0;
+		busy = 0;
+	}
+};
+
+static void _run(bool p_threaded) {
+
+	OS::get_singleton()->print("\n%s:\n", p_threaded ? "lws serviced by its own thread" : "lws serviced by poll() on the main thread");
+
+	LoadClients *clients = memnew(LoadClients);
+	uint64_t mem_before = Memory::get_mem_usage();
+
+	Object *obj = ClassDB::instance("WebSocketServer");
+	Ref<NetworkedMultiplayerPeer> server = Object::cast_to<NetworkedMultiplayerPeer>(obj);
+	Lobby *lobby = memnew(Lobby);
+	lobby->setup(obj);
+
+	obj->set("use_thread", p_threaded);
+	if ((int)obj->call("listen", PORT) != OK) {
+		OS::get_singleton()->print("could not listen on port %d, skipped\n", int(PORT));
+		memdelete(lobby);
+		memdelete(clients);
+		return;
+	}
+
+	// Connect everyone.
+	clients->start();
+	Frames connect(server.ptr());
+	while (connect.begin_frame()) {
+		bool done = lobby->get_peer_count() == CLIENTS && clients->open_count == CLIENTS;
+		connect.end_frame();
+		if (done)
+			break;
+	}
+	OS::get_singleton()->print("connect: %d clients in %d ms, main thread busy %d ms, %d KiB per client\n", lobby->get_peer_count(), int(connect.get_wall_usec() / 1000), int(connect.busy / 1000), int((Memory::get_mem_usage() - mem_before) / CLIENTS / 1024));
+
+	// Every client sends to the server.
+	int expected = clients->open_count * FAN_IN_MESSAGES;
+	clients->send(FAN_IN_MESSAGES);
+	Frames fan_in(server.ptr());
+	while (fan_in.begin_frame()) {
+		bool done = lobby->received >= expected;
+		fan_in.end_frame();
+		if (done)
+			break;
+	}
+	OS::get_singleton()->print("fan in: %d of %d messages in %d ms, main thread busy %d ms\n", lobby->received, expected, int(fan_in.get_wall_usec() / 1000), int(fan_in.busy / 1000));
+
+	// The server sends one message per frame to every client, either peer
+	// by peer or with broadcast_packet().
+	for (int mode = 0; mode < 2; mode++) {
+
+		uint64_t total = (uint64_t)clients->open_count * FAN_OUT_MESSAGES;
+		clients->reset_stats();
+
+		PoolByteArray packet;
+		packet.resize(FAN_OUT_SIZE);
+
+		Frames fan_out(server.ptr());
+		while (fan_out.begin_frame()) {
+
+			if (fan_out.count < FAN_OUT_MESSAGES) {
+				encode_uint64(OS::get_singleton()->get_ticks_usec(), packet.write().ptr());
+				if (mode == 0) {
+					lobby->put_each(packet.read().ptr(), FAN_OUT_SIZE);
+				} else {
+					obj->call("broadcast_packet", packet);
+				}
+			}
+
+			bool done = clients->frames >= total;
+			fan_out.end_frame();
+			if (done)
+				break;
+		}
+
+		uint64_t wall = fan_out.get_wall_usec();
+		OS::get_singleton()->print("fan out, %s: %d of %d messages in %d ms (%.1f MiB/s), main thread busy %d ms, latency avg %d usec max %d ms\n",
+				mode == 0 ? "put_packet() per peer" : "broadcast_packet()",
+				int(clients->frames), int(total), int(wall / 1000), clients->bytes / (wall / 1000000.0) / (1024 * 1024), int(fan_out.busy / 1000),
+				int(clients->frames ? clients->latency_sum / clients->frames : 0), int(clients->latency_max / 1000));
+	}
+
+	memdelete(clients);
+	obj->call("stop");
+	memdelete(lobby);
+}
+
+MainLoop *test() {
+
+	OS::get_singleton()->print("\n*** WebSocket server load, %d clients ***\n", int(CLIENTS));
+
+	if (!ClassDB::class_exists("WebSocketServer")) {
+		OS::get_singleton()->print("WebSocket module not available, skipped\n");
+		return NULL;
+	}
+
+	ClassDB::register_class<Lobby>();
+
+	_run(false);
+	_run(true);
+
+	return NULL;
+}
+} // namespace TestWebSocket
@@ -111,6 +111,7 @@ Error NetworkedMultiplayerENet::create_server(int p_port, int p_max_clients, int
 	refuse_connections = false;
 	unique_id = 1;
 	connection_status = CONNECTION_CONNECTED;
+	_start_thread();
 	return OK;
 }
 Error NetworkedMultiplayerENet::create_client(const String &p_address, int p_port, int p_in_bandwidth, int p_out_bandwidth, int p_client_port) {
@@ -196,6 +197,7 @@ Error NetworkedMultiplayerENet::create_client(const String &p_address, int p_por
 	active = true;
 	server = false;
 	refuse_connections = false;
+	_start_thread();
 
 	return OK;
 }
@@ -206,69 +208,59 @@ void NetworkedMultiplayerENet::poll() {
 
 	_pop_current_packet();
 
-	ENetEvent event;
+	if (thread)
+		_flush(); // Retry commands the queue had no room for.
+
+	Event event;
 	/* Keep servicing until there are no available events left in queue. */
 	while (true) {
 
 		if (!host || !active) // Might have been disconnected while emitting a notification
 			return;
 
-		int ret = enet_host_service(host, &event, 0);
-
-		if (ret < 0) {
-			// Error, do something?
-			break;
-		} else if (ret == 0) {
+		if (!_next_event(event))
 			break;
-		}
 
 		switch (event.type) {
 			case ENET_EVENT_TYPE_CONNECT: {
 				// Store any relevant client information here.
 
 				if (server && refuse_connections) {
-					enet_peer_reset(event.peer);
+					_push_command(CMD_RESET, event.peer, event.peer_id);
 					break;
 				}
 
 				// A client joined with an invalid ID (neagtive values, 0, and 1 are reserved).
 				// Probably trying to exploit us.
-				if (server && ((int)event.data < 2 || peer_map.has((int)event.data))) {
-					enet_peer_reset(event.peer);
+				if (server && (event.peer_id < 2 || peer_map.has(event.peer_id))) {
+					_push_command(CMD_RESET, event.peer, event.peer_id);
 					ERR_CONTINUE(true);
 				}
 
-				int *new_id = memnew(int);
-				*new_id = event.data;
-
-				if (*new_id == 0) { // Data zero is sent by server (enet won't let you configure this). Server is always 1.
-					*new_id = 1;
-				}
-
-				event.peer->data = new_id;
+				int new_id = event.peer_id;
 
-				peer_map[*new_id] = event.peer;
+				peer_map[new_id] = event.peer;
 
 				connection_status = CONNECTION_CONNECTED; // If connecting, this means it connected to something!
 
-				emit_signal("peer_connected", *new_id);
+				emit_signal("peer_connected", new_id);
 
 				if (server) {
 					// Someone connected, notify all the peers available
 					for (Map<int, ENetPeer *>::Element *E = peer_map.front(); E; E = E->next()) {
 
-						if (E->key() == *new_id)
+						if (E->key() == new_id)
 							continue;
 						// Send existing peers to new peer
 						ENetPacket *packet = enet_packet_create(NULL, 8, ENET_PACKET_FLAG_RELIABLE);
 						encode_uint32(SYSMSG_ADD_PEER, &packet->data[0]);
 						encode_uint32(E->key(), &packet->data[4]);
-						enet_peer_send(event.peer, SYSCH_CONFIG, packet);
+						_push_command(CMD_SEND, event.peer, new_id, SYSCH_CONFIG, packet);
 						// Send the new peer to existing peers
 						packet = enet_packet_create(NULL, 8, ENET_PACKET_FLAG_RELIABLE);
 						encode_uint32(SYSMSG_ADD_PEER, &packet->data[0]);
-						encode_uint32(*new_id, &packet->data[4]);
-						enet_peer_send(E->get(), SYSCH_CONFIG, packet);
+						encode_uint32(new_id, &packet->data[4]);
+						_push_command(CMD_SEND, E->get(), E->key(), SYSCH_CONFIG, packet);
 					}
 				} else {
 
@@ -278,9 +270,9 @@ void NetworkedMultiplayerENet::poll() {
 			} break;
 			case ENET_EVENT_TYPE_DISCONNECT: {
 
-				// Reset the peer's client information.
+				// The peer's client information was already released along with the event.
 
-				int *id = (int *)event.peer->data;
+				int id = event.peer_id;
 
 				if (!id) {
 					if (!server) {
@@ -292,13 +284,13 @@ void NetworkedMultiplayerENet::poll() {
 						// Someone disconnected, notify everyone else
 						for (Map<int, ENetPeer *>::Element *E = peer_map.front(); E; E = E->next()) {
 
-							if (E->key() == *id)
+							if (E->key() == id)
 								continue;
 
 							ENetPacket *packet = enet_packet_create(NULL, 8, ENET_PACKET_FLAG_RELIABLE);
 							encode_uint32(SYSMSG_REMOVE_PEER, &packet->data[0]);
-							encode_uint32(*id, &packet->data[4]);
-							enet_peer_send(E->get(), SYSCH_CONFIG, packet);
+							encode_uint32(id, &packet->data[4]);
+							_push_command(CMD_SEND, E->get(), E->key(), SYSCH_CONFIG, packet);
 						}
 					} else {
 						emit_signal("server_disconnected");
@@ -306,15 +298,14 @@ void NetworkedMultiplayerENet::poll() {
 						return;
 					}
 
-					emit_signal("peer_disconnected", *id);
-					peer_map.erase(*id);
-					memdelete(id);
+					emit_signal("peer_disconnected", id);
+					peer_map.erase(id);
 				}
 
 			} break;
 			case ENET_EVENT_TYPE_RECEIVE: {
 
-				if (event.channelID == SYSCH_CONFIG) {
+				if (event.channel == SYSCH_CONFIG) {
 					// Some config message
 					ERR_CONTINUE(event.packet->dataLength < 8);
 
@@ -339,12 +330,12 @@ void NetworkedMultiplayerENet::poll() {
 					}
 
 					enet_packet_destroy(event.packet);
-				} else if (event.channelID < channel_count) {
+				} else if (event.channel < channel_count) {
 
 					Packet packet;
 					packet.packet = event.packet;
 
-					uint32_t *id = (uint32_t *)event.peer->data;
+					uint32_t id = event.peer_id;
 
 					ERR_CONTINUE(event.packet->dataLength < 12)
 
@@ -353,13 +344,19 @@ void NetworkedMultiplayerENet::poll() {
 					uint32_t flags = decode_uint32(&event.packet->data[8]);
 
 					packet.from = source;
-					packet.channel = event.channelID;
+					packet.channel = event.channel;
 
 					if (server) {
 						// Someone is cheating and trying to fake the source!
-						ERR_CONTINUE(source != *id);
+						ERR_CONTINUE(source != id);
+
+						if (!peer_map.has(id)) {
+							// Sender was dropped with disconnect_peer() while this was queued.
+							enet_packet_destroy(packet.packet);
+							continue;
+						}
 
-						packet.from = *id;
+						packet.from = id;
 
 						if (target == 0) {
 							// Re-send to everyone but sender :|
@@ -373,7 +370,7 @@ void NetworkedMultiplayerENet::poll() {
 
 								ENetPacket *packet2 = enet_packet_create(packet.packet->data, packet.packet->dataLength, flags);
 
-								enet_peer_send(E->get(), event.channelID, packet2);
+								_push_command(CMD_SEND, E->get(), E->key(), event.channel, packet2);
 							}
 
 						} else if (target < 0) {
@@ -387,7 +384,7 @@ void NetworkedMultiplayerENet::poll() {
 
 								ENetPacket *packet2 = enet_packet_create(packet.packet->data, packet.packet->dataLength, flags);
 
-								enet_peer_send(E->get(), event.channelID, packet2);
+								_push_command(CMD_SEND, E->get(), E->key(), event.channel, packet2);
 							}
 
 							if (-target != 1) {
@@ -404,7 +401,7 @@ void NetworkedMultiplayerENet::poll() {
 						} else {
 							// To someone else, specifically
 							ERR_CONTINUE(!peer_map.has(target));
-							enet_peer_send(peer_map[target], event.channelID, packet.packet);
+							_push_command(CMD_SEND, peer_map[target], target, event.channel, packet.packet);
 						}
 					} else {
 
@@ -435,6 +432,7 @@ void NetworkedMultiplayerENet::close_connection(uint32_t wait_usec) {
 	ERR_FAIL_COND(!active);
 
 	_pop_current_packet();
+	_stop_thread();
 
 	bool peers_disconnected = false;
 	for (Map<int, ENetPeer *>::Element *E = peer_map.front(); E; E = E->next()) {
@@ -466,7 +464,7 @@ void NetworkedMultiplayerENet::disconnect_peer(int p_peer, bool now) {
 	ERR_FAIL_COND(!peer_map.has(p_peer))
 
 	if (now) {
-		enet_peer_disconnect_now(peer_map[p_peer], 0);
+		_push_command(CMD_DISCONNECT_NOW, peer_map[p_peer], p_peer);
 
 		// enet_peer_disconnect_now doesn't generate ENET_EVENT_TYPE_DISCONNECT,
 		// notify everyone else, send disconnect signal & remove from peer_map like in poll()
@@ -479,13 +477,13 @@ void NetworkedMultiplayerENet::disconnect_peer(int p_peer, bool now) {
 			ENetPacket *packet = enet_packet_create(NULL, 8, ENET_PACKET_FLAG_RELIABLE);
 			encode_uint32(SYSMSG_REMOVE_PEER, &packet->data[0]);
 			encode_uint32(p_peer, &packet->data[4]);
-			enet_peer_send(E->get(), SYSCH_CONFIG, packet);
+			_push_command(CMD_SEND, E->get(), E->key(), SYSCH_CONFIG, packet);
 		}
 
 		emit_signal("peer_disconnected", p_peer);
 		peer_map.erase(p_peer);
 	} else {
-		enet_peer_disconnect_later(peer_map[p_peer], 0);
+		_push_command(CMD_DISCONNECT, peer_map[p_peer], p_peer);
 	}
 }
 
@@ -558,7 +556,7 @@ Error NetworkedMultiplayerENet::put_packet(const uint8_t *p_buffer, int p_buffer
 	if (server) {
 
 		if (target_peer == 0) {
-			enet_host_broadcast(host, channel, packet);
+			_push_command(CMD_BROADCAST, NULL, 0, channel, packet);
 		} else if (target_peer < 0) {
 			// Send to all but one
 			// and make copies for sending
@@ -572,20 +570,20 @@ Error NetworkedMultiplayerENet::put_packet(const uint8_t *p_buffer, int p_buffer
 
 				ENetPacket *packet2 = enet_packet_create(packet->data, packet->dataLength, packet_flags);
 
-				enet_peer_send(F->get(), channel, packet2);
+				_push_command(CMD_SEND, F->get(), F->key(), channel, packet2);
 			}
 
 			enet_packet_destroy(packet); // Original packet no longer needed
 		} else {
-			enet_peer_send(E->get(), channel, packet);
+			_push_command(CMD_SEND, E->get(), E->key(), channel, packet);
 		}
 	} else {
 
 		ERR_FAIL_COND_V(!peer_map.has(1), ERR_BUG);
-		enet_peer_send(peer_map[1], channel, packet); // Send to server for broadcast
+		_push_command(CMD_SEND, peer_map[1], 1, channel, packet); // Send to server for broadcast
 	}
 
-	enet_host_flush(host);
+	_flush();
 
 	return OK;
 }
@@ -605,6 +603,222 @@ void NetworkedMultiplayerENet::_pop_current_packet() {
 	}
 }
 
+bool NetworkedMultiplayerENet::_convert_event(const ENetEvent &p_event, Event &r_event) {
+
+	r_event.type = p_event.type;
+	r_event.peer = p_event.peer;
+	r_event.peer_id = p_event.peer->data ? *(int *)p_event.peer->data : 0;
+	r_event.channel = p_event.channelID;
+	r_event.packet = NULL;
+
+	// Peer ids live in peer->data, which only the thread owning the host may
+	// touch, so they are assigned and released here rather than in poll().
+	switch (p_event.type) {
+		case ENET_EVENT_TYPE_CONNECT: {
+
+			int *new_id = memnew(int);
+			*new_id = p_event.data;
+
+			if (*new_id == 0) { // Data zero is sent by server (enet won't let you configure this). Server is always 1.
+				*new_id = 1;
+			}
+
+			p_event.peer->data = new_id;
+			r_event.peer_id = *new_id;
+		} break;
+		case ENET_EVENT_TYPE_DISCONNECT: {
+
+			if (p_event.peer->data) {
+				memdelete((int *)p_event.peer->data);
+				p_event.peer->data = NULL;
+			}
+		} break;
+		case ENET_EVENT_TYPE_RECEIVE: {
+
+			r_event.packet = p_event.packet;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool NetworkedMultiplayerENet::_next_event(Event &r_event) {
+
+	if (thread)
+		return event_queue.pop(r_event);
+
+	ENetEvent event;
+	while (enet_host_service(host, &event, 0) > 0) {
+
+		if (_convert_event(event, r_event))
+			return true;
+	}
+
+	return false;
+}
+
+void NetworkedMultiplayerENet::_run_command(const Command &p_command) {
+
+	if (p_command.type == CMD_BROADCAST) {
+		enet_host_broadcast(host, p_command.channel, p_command.packet);
+		return;
+	}
+
+	// When threaded, the peer may have gone away (and its slot been reused)
+	// while the command was queued.
+	ENetPeer *peer = p_command.peer;
+	if (!peer->data || *(int *)peer->data != p_command.peer_id) {
+		if (p_command.packet)
+			enet_packet_destroy(p_command.packet);
+		return;
+	}
+
+	switch (p_command.type) {
+		case CMD_SEND: {
+
+			if (enet_peer_send(peer, p_command.channel, p_command.packet) < 0 && p_command.packet->referenceCount == 0) {
+				enet_packet_destroy(p_command.packet);
+			}
+		} break;
+		case CMD_RESET: {
+
+			enet_peer_reset(peer);
+			memdelete((int *)peer->data);
+			peer->data = NULL;
+		} break;
+		case CMD_DISCONNECT: {
+
+			enet_peer_disconnect_later(peer, 0);
+		} break;
+		case CMD_DISCONNECT_NOW: {
+
+			enet_peer_disconnect_now(peer, 0);
+			memdelete((int *)peer->data);
+			peer->data = NULL;
+		} break;
+		default: {}
+	}
+}
+
+void NetworkedMultiplayerENet::_push_command(CommandType p_type, ENetPeer *p_peer, int p_peer_id, int p_channel, ENetPacket *p_packet) {
+
+	Command command;
+	command.type = p_type;
+	command.peer = p_peer;
+	command.peer_id = p_peer_id;
+	command.channel = p_channel;
+	command.packet = p_packet;
+
+	if (!thread) {
+		_run_command(command);
+		return;
+	}
+
+	// Keep commands in order if the network thread fell behind.
+	if (command_overflow.size() || !command_queue.push(command)) {
+		command_overflow.push_back(command);
+	}
+}
+
+void NetworkedMultiplayerENet::_flush() {
+
+	if (!thread) {
+		enet_host_flush(host);
+		return;
+	}
+
+	// The network thread flushes as soon as it picks commands up.
+	while (command_overflow.size() && command_queue.push(command_overflow.front()->get())) {
+		command_overflow.pop_front();
+	}
+}
+
+void NetworkedMultiplayerENet::_start_thread() {
+
+	if (!use_thread)
+		return;
+
+	event_queue.resize(12);
+	command_queue.resize(12);
+	thread_exit = false;
+	thread = Thread::create(_thread_func, this); // Stays NULL without thread support, poll() services the host then.
+}
+
+void NetworkedMultiplayerENet::_stop_thread() {
+
+	if (!thread)
+		return;
+
+	thread_exit = true;
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	thread = NULL;
+
+	// The host belongs to the main thread again. Send what was still queued
+	// and drop events nobody will poll anymore.
+	Command command;
+	while (command_queue.pop(command)) {
+		_run_command(command);
+	}
+	for (List<Command>::Element *E = command_overflow.front(); E; E = E->next()) {
+		_run_command(E->get());
+	}
+	command_overflow.clear();
+
+	Event event;
+	while (event_queue.pop(event)) {
+		event_overflow.push_back(event);
+	}
+	for (List<Event>::Element *E = event_overflow.front(); E; E = E->next()) {
+		if (E->get().packet)
+			enet_packet_destroy(E->get().packet);
+	}
+	event_overflow.clear();
+}
+
+void NetworkedMultiplayerENet::_thread_loop() {
+
+	ENetEvent event;
+	Event queued;
+	Command command;
+
+	while (!thread_exit) {
+
+		bool sent = false;
+		while (command_queue.pop(command)) {
+			_run_command(command);
+			sent = true;
+		}
+		if (sent) {
+			enet_host_flush(host);
+		}
+
+		// Retry events the main thread had no room for before adding new ones, so order holds.
+		while (event_overflow.size() && event_queue.push(event_overflow.front()->get())) {
+			event_overflow.pop_front();
+		}
+
+		// Short timeout, as commands queued by the main thread wait for this to return.
+		int ret = enet_host_service(host, &event, 1);
+		while (ret > 0) {
+
+			if (_convert_event(event, queued) && (event_overflow.size() || !event_queue.push(queued))) {
+				event_overflow.push_back(queued);
+			}
+			ret = enet_host_check_events(host, &event);
+		}
+	}
+}
+
+void NetworkedMultiplayerENet::_thread_func(void *p_userdata) {
+
+	NetworkedMultiplayerENet *enet = (NetworkedMultiplayerENet *)p_userdata;
+	enet->_thread_loop();
+}
+
 NetworkedMultiplayerPeer::ConnectionStatus NetworkedMultiplayerENet::get_connection_status() const {
 
 	return connection_status;
@@ -823,6 +1037,16 @@ bool NetworkedMultiplayerENet::is_always_ordered() const {
 	return always_ordered;
 }
 
+void NetworkedMultiplayerENet::set_use_thread(bool p_enable) {
+
+	ERR_FAIL_COND(active);
+	use_thread = p_enable;
+}
+
+bool NetworkedMultiplayerENet::is_using_thread() const {
+	return use_thread;
+}
+
 void NetworkedMultiplayerENet::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("create_server", "port", "max_clients", "in_bandwidth", "out_bandwidth"), &NetworkedMultiplayerENet::create_server, DEFVAL(32), DEFVAL(0), DEFVAL(0));
@@ -843,11 +1067,14 @@ void NetworkedMultiplayerENet::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_channel_count"), &NetworkedMultiplayerENet::get_channel_count);
 	ClassDB::bind_method(D_METHOD("set_always_ordered", "ordered"), &NetworkedMultiplayerENet::set_always_ordered);
 	ClassDB::bind_method(D_METHOD("is_always_ordered"), &NetworkedMultiplayerENet::is_always_ordered);
+	ClassDB::bind_method(D_METHOD("set_use_thread", "enable"), &NetworkedMultiplayerENet::set_use_thread);
+	ClassDB::bind_method(D_METHOD("is_using_thread"), &NetworkedMultiplayerENet::is_using_thread);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "compression_mode", PROPERTY_HINT_ENUM, "None,Range Coder,FastLZ,ZLib,ZStd"), "set_compression_mode", "get_compression_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "transfer_channel"), "set_transfer_channel", "get_transfer_channel");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "channel_count"), "set_channel_count", "get_channel_count");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "always_ordered"), "set_always_ordered", "is_always_ordered");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_thread"), "set_use_thread", "is_using_thread");
 
 	BIND_ENUM_CONSTANT(COMPRESS_NONE);
 	BIND_ENUM_CONSTANT(COMPRESS_RANGE_CODER);
@@ -868,6 +1095,9 @@ NetworkedMultiplayerENet::NetworkedMultiplayerENet() {
 	channel_count = SYSCH_MAX;
 	transfer_channel = -1;
 	always_ordered = false;
+	use_thread = false;
+	thread = NULL;
+	thread_exit = false;
 	connection_status = CONNECTION_DISCONNECTED;
 	compression_mode = COMPRESS_NONE;
 	enet_compressor.context = this;
@@ -880,7 +1110,9 @@ NetworkedMultiplayerENet::NetworkedMultiplayerENet() {
 
 NetworkedMultiplayerENet::~NetworkedMultiplayerENet() {
 
-	close_connection();
+	if (active) {
+		close_connection();
+	}
 }
 
 // Sets IP for ENet to bind when using create_server or create_client
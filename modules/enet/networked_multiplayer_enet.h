@@ -33,6 +33,8 @@
 
 #include "core/io/compression.h"
 #include "core/io/networked_multiplayer_peer.h"
+#include "core/os/thread.h"
+#include "core/spsc_queue.h"
 
 #include <enet/enet.h>
 
@@ -95,6 +97,56 @@ private:
 
 	Packet current_packet;
 
+	// What poll() consumes, either straight from enet_host_service() or,
+	// in threaded mode, handed over by the network thread.
+	struct Event {
+
+		ENetEventType type;
+		ENetPeer *peer;
+		int peer_id;
+		int channel;
+		ENetPacket *packet;
+	};
+
+	// Work for whoever owns the host. Run immediately when unthreaded,
+	// queued to the network thread otherwise.
+	enum CommandType {
+		CMD_SEND,
+		CMD_BROADCAST,
+		CMD_RESET,
+		CMD_DISCONNECT,
+		CMD_DISCONNECT_NOW
+	};
+
+	struct Command {
+
+		CommandType type;
+		ENetPeer *peer;
+		int peer_id;
+		int channel;
+		ENetPacket *packet;
+	};
+
+	bool use_thread;
+	Thread *thread;
+	volatile bool thread_exit;
+
+	SPSCQueue<Event> event_queue;
+	SPSCQueue<Command> command_queue;
+	List<Event> event_overflow; // Network thread only.
+	List<Command> command_overflow; // Main thread only.
+
+	bool _convert_event(const ENetEvent &p_event, Event &r_event);
+	bool _next_event(Event &r_event);
+	void _run_command(const Command &p_command);
+	void _push_command(CommandType p_type, ENetPeer *p_peer, int p_peer_id, int p_channel = 0, ENetPacket *p_packet = NULL);
+	void _flush();
+
+	void _start_thread();
+	void _stop_thread();
+	void _thread_loop();
+	static void _thread_func(void *p_userdata);
+
 	uint32_t _gen_unique_id() const;
 	void _pop_current_packet();
 
@@ -157,6 +209,8 @@ public:
 	int get_channel_count() const;
 	void set_always_ordered(bool p_ordered);
 	bool is_always_ordered() const;
+	void set_use_thread(bool p_enable);
+	bool is_using_thread() const;
 
 	NetworkedMultiplayerENet();
 	~NetworkedMultiplayerENet();
@@ -88,6 +88,37 @@ static Etc::Image::Format _image_format_to_etc2comp_format(Image::Format format)
 	}
 }
 
+struct ETCBandParams {
+	Etc::Image::Format format;
+	Etc::ErrorMetric error_metric;
+	float effort;
+	int block_size;
+};
+
+static void _compress_etc_band(const uint8_t *p_src, int p_width, int p_height, uint8_t *p_dst, void *p_userdata) {
+	const ETCBandParams &params = *static_cast<const ETCBandParams *>(p_userdata);
+
+	// convert source band to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
+	// NOTE: We can alternatively add a case to Image::convert to handle Image::FORMAT_RGBAF conversion.
+	Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[p_width * p_height];
+	for (int j = 0; j < p_width * p_height; j++) {
+		int si = j * 4; // RGBA8
+		src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(p_src[si], p_src[si + 1], p_src[si + 2], p_src[si + 3]);
+	}
+
+	unsigned char *etc_data = NULL;
+	unsigned int etc_data_len = 0;
+	unsigned int extended_width = 0, extended_height = 0;
+	int encoding_time = 0;
+	Etc::Encode((float *)src_rgba_f, p_width, p_height, params.format, params.error_metric, params.effort, 1, 1, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
+
+	CRASH_COND(etc_data_len != (unsigned int)(((p_width + 3) / 4) * ((p_height + 3) / 4) * params.block_size));
+	memcpy(p_dst, etc_data, etc_data_len);
+
+	delete[] etc_data;
+	delete[] src_rgba_f;
+}
+
 static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_format, Image::CompressSource p_source) {
 	Image::Format img_format = p_img->get_format();
 	Image::DetectChannels detected_channels = p_img->get_detected_channels();
@@ -169,7 +200,6 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
 	PoolVector<uint8_t>::Read r = img->get_data().read();
 
 	unsigned int target_size = Image::get_image_data_size(imgw, imgh, etc_format, p_img->has_mipmaps());
-	int mmc = 1 + (p_img->has_mipmaps() ? Image::get_image_required_mipmaps(imgw, imgh, etc_format) : 0);
 
 	PoolVector<uint8_t> dst_data;
 	dst_data.resize(target_size);
@@ -177,52 +207,31 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
 	PoolVector<uint8_t>::Write w = dst_data.write();
 
 	// prepare parameters to be passed to etc2comp
-	int num_cpus = OS::get_singleton()->get_processor_count();
-	int encoding_time = 0;
-	float effort = 0.0; //default, reasonable time
+	ETCBandParams params;
+	params.effort = 0.0; //default, reasonable time
 
 	if (p_lossy_quality > 0.75)
-		effort = 0.4;
+		params.effort = 0.4;
 	else if (p_lossy_quality > 0.85)
-		effort = 0.6;
+		params.effort = 0.6;
 	else if (p_lossy_quality > 0.95)
-		effort = 0.8;
-
-	Etc::ErrorMetric error_metric = Etc::ErrorMetric::RGBX; // NOTE: we can experiment with other error metrics
-	Etc::Image::Format etc2comp_etc_format = _image_format_to_etc2comp_format(etc_format);
+		params.effort = 0.8;
 
-	int wofs = 0;
+	params.error_metric = Etc::ErrorMetric::RGBX; // NOTE: we can experiment with other error metrics
+	params.format = _image_format_to_etc2comp_format(etc_format);
+	params.block_size = (16 * Image::get_format_pixel_size(etc_format)) >> Image::get_format_pixel_rshift(etc_format);
 
 	print_verbose("ETC: Begin encoding, format: " + Image::get_format_name(etc_format));
 	uint64_t t = OS::get_singleton()->get_ticks_msec();
-	for (int i = 0; i < mmc; i++) {
-		// convert source image to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
-		// NOTE: We can alternatively add a case to Image::convert to handle Image::FORMAT_RGBAF conversion.
-		int mipmap_ofs = 0, mipmap_size = 0, mipmap_w = 0, mipmap_h = 0;
-		img->get_mipmap_offset_size_and_dimensions(i, mipmap_ofs, mipmap_size, mipmap_w, mipmap_h);
-		const uint8_t *src = &r[mipmap_ofs];
-
-		Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[mipmap_w * mipmap_h];
-		for (int j = 0; j < mipmap_w * mipmap_h; j++) {
-			int si = j * 4; // RGBA8
-			src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(src[si], src[si + 1], src[si + 2], src[si + 3]);
-		}
-
-		unsigned char *etc_data = NULL;
-		unsigned int etc_data_len = 0;
-		unsigned int extended_width = 0, extended_height = 0;
-		Etc::Encode((float *)src_rgba_f, mipmap_w, mipmap_h, etc2comp_etc_format, error_metric, effort, num_cpus, num_cpus, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
 
-		CRASH_COND(wofs + etc_data_len > target_size);
-		memcpy(&w[wofs], etc_data, etc_data_len);
-		wofs += etc_data_len;
-
-		delete[] etc_data;
-		delete[] src_rgba_f;
-	}
+	// etc2comp is given one band at a time with a single job, the bands are spread over the image work pool instead
+	Image::compress_bands(r.ptr(), Image::FORMAT_RGBA8, w.ptr(), etc_format, imgw, imgh, p_img->has_mipmaps(), _compress_etc_band, &params);
 
 	print_verbose("ETC: Time encoding: " + rtos(OS::get_singleton()->get_ticks_msec() - t));
 
+	r = PoolVector<uint8_t>::Read();
+	w = PoolVector<uint8_t>::Write();
+
 	p_img->create(imgw, imgh, p_img->has_mipmaps(), etc_format, dst_data);
 }
 
@@ -75,6 +75,11 @@ void image_decompress_squish(Image *p_image) {
 }
 
 #ifdef TOOLS_ENABLED
+static void _compress_squish_band(const uint8_t *p_src, int p_width, int p_height, uint8_t *p_dst, void *p_userdata) {
+
+	squish::CompressImage(p_src, p_width, p_height, p_dst, *(int *)p_userdata);
+}
+
 void image_compress_squish(Image *p_image, float p_lossy_quality, Image::CompressSource p_source) {
 
 	if (p_image->get_format() >= Image::FORMAT_DXT1)
@@ -176,26 +181,12 @@ void image_compress_squish(Image *p_image, float p_lossy_quality, Image::Compres
 
 		PoolVector<uint8_t> data;
 		int target_size = Image::get_image_data_size(w, h, target_format, p_image->has_mipmaps());
-		int mm_count = p_image->has_mipmaps() ? Image::get_image_required_mipmaps(w, h, target_format) : 0;
 		data.resize(target_size);
-		int shift = Image::get_format_pixel_rshift(target_format);
 
 		PoolVector<uint8_t>::Read rb = p_image->get_data().read();
 		PoolVector<uint8_t>::Write wb = data.write();
 
-		int dst_ofs = 0;
-
-		for (int i = 0; i <= mm_count; i++) {
-
-			int bw = w % 4 != 0 ? w + (4 - w % 4) : w;
-			int bh = h % 4 != 0 ? h + (4 - h % 4) : h;
-
-			int src_ofs = p_image->get_mipmap_offset(i);
-			squish::CompressImage(&rb[src_ofs], w, h, &wb[dst_ofs], squish_comp);
-			dst_ofs += (MAX(4, bw) * MAX(4, bh)) >> shift;
-			w = MAX(w / 2, 1);
-			h = MAX(h / 2, 1);
-		}
+		Image::compress_bands(rb.ptr(), Image::FORMAT_RGBA8, wb.ptr(), target_format, w, h, p_image->has_mipmaps(), _compress_squish_band, &squish_comp);
 
 		rb = PoolVector<uint8_t>::Read();
 		wb = PoolVector<uint8_t>::Write();
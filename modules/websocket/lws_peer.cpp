@@ -33,6 +33,7 @@
 #include "lws_peer.h"
 
 #include "core/io/ip.h"
+#include "lws_server.h"
 
 // Needed for socket_helpers on Android at least. UNIXes has it, just include if not windows
 #if !defined(WINDOWS_ENABLED)
@@ -42,13 +43,43 @@
 
 #include "drivers/unix/net_socket_posix.h"
 
+LWSPeer::SharedFrame *LWSPeer::create_shared_frame(const uint8_t *p_buffer, int p_buffer_size, bool p_is_string) {
+
+	ERR_FAIL_COND_V(p_buffer_size < 0, NULL);
+
+	// One allocation, frame, then the room lws_write() needs for the header, then the payload.
+	uint8_t *mem = (uint8_t *)memalloc(sizeof(SharedFrame) + LWS_PRE + p_buffer_size);
+	SharedFrame *frame = (SharedFrame *)mem;
+	frame->refcount.init();
+	frame->size = p_buffer_size;
+	frame->is_string = p_is_string;
+	frame->payload = &mem[sizeof(SharedFrame) + LWS_PRE];
+	if (p_buffer_size)
+		copymem(frame->payload, p_buffer, p_buffer_size);
+	return frame;
+}
+
+void LWSPeer::unref_shared_frame(SharedFrame *p_frame) {
+
+	if (p_frame->refcount.unref())
+		memfree(p_frame);
+}
+
 void LWSPeer::set_wsi(struct lws *p_wsi, unsigned int p_in_buf_size, unsigned int p_in_pkt_size, unsigned int p_out_buf_size, unsigned int p_out_pkt_size) {
 	ERR_FAIL_COND(wsi != NULL);
 
-	_in_buffer.resize(p_in_pkt_size, p_in_buf_size);
-	_out_buffer.resize(p_out_pkt_size, p_out_buf_size);
-	_packet_buffer.resize((1 << MAX(p_in_buf_size, p_out_buf_size)) + LWS_PRE);
+	_in_buffer.resize(p_in_buf_size, p_in_pkt_size);
+	_out_buffer.resize(p_out_buf_size, p_out_pkt_size, LWS_PRE);
 	wsi = p_wsi;
+	_connected = true;
+
+	// Kept, as wsi may belong to another thread later.
+	struct sockaddr_storage addr;
+	socklen_t len = sizeof(addr);
+	int fd = lws_get_socket_fd(wsi);
+	if (fd != -1 && getpeername(fd, (struct sockaddr *)&addr, &len) == 0) {
+		NetSocketPosix::_set_ip_port(&addr, _ip, _port);
+	}
 };
 
 void LWSPeer::set_write_mode(WriteMode p_mode) {
@@ -61,17 +92,18 @@ LWSPeer::WriteMode LWSPeer::get_write_mode() const {
 
 Error LWSPeer::read_wsi(void *in, size_t len) {
 
-	ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
+	ERR_FAIL_COND_V(wsi == NULL, FAILED);
 
-	if (lws_is_first_fragment(wsi))
+	if (lws_is_first_fragment(wsi)) {
+		_in_buffer.discard();
 		_in_size = 0;
-	else if (_in_size == -1) // Trash this frame
+	} else if (_in_size == -1) // Trash this frame
 		return ERR_FILE_CORRUPT;
 
-	Error err = _in_buffer.write_packet((const uint8_t *)in, len, NULL);
+	Error err = _in_buffer.append((const uint8_t *)in, len);
 
 	if (err != OK) {
-		_in_buffer.discard_payload(_in_size);
+		_in_buffer.discard();
 		_in_size = -1;
 		ERR_FAIL_V(err);
 	}
@@ -79,10 +111,8 @@ Error LWSPeer::read_wsi(void *in, size_t len) {
 	_in_size += len;
 
 	if (lws_is_final_fragment(wsi)) {
-		uint8_t is_string = lws_frame_is_binary(wsi) ? 0 : 1;
-		err = _in_buffer.write_packet(NULL, _in_size, &is_string);
+		err = _in_buffer.commit(lws_frame_is_binary(wsi) ? 0 : PACKET_STRING);
 		if (err != OK) {
-			_in_buffer.discard_payload(_in_size);
 			_in_size = -1;
 			ERR_FAIL_V(err);
 		}
@@ -93,53 +123,115 @@ Error LWSPeer::read_wsi(void *in, size_t len) {
 
 Error LWSPeer::write_wsi() {
 
-	ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
-
-	PoolVector<uint8_t> tmp;
-	int count = _out_buffer.packets_left();
+	ERR_FAIL_COND_V(wsi == NULL, FAILED);
 
-	if (count == 0)
-		return OK;
+	uint8_t *payload;
+	uint32_t size;
+	uint8_t flags;
 
-	int read = 0;
-	uint8_t is_string = 0;
-	PoolVector<uint8_t>::Write rw = _packet_buffer.write();
-	_out_buffer.read_packet(&(rw[LWS_PRE]), _packet_buffer.size() - LWS_PRE, &is_string, read);
+	// Packets are sent from where they are queued, the room for the header is
+	// reserved before each of them. lws only allows one write per writable
+	// callback, and holds what could not be sent until the next one.
+	if (!lws_partial_buffered(wsi) && _out_buffer.peek(&payload, size, flags)) {
 
-	enum lws_write_protocol mode = is_string ? LWS_WRITE_TEXT : LWS_WRITE_BINARY;
-	lws_write(wsi, &(rw[LWS_PRE]), read, mode);
+		if (flags & PACKET_SHARED) {
+			SharedFrame *frame = *(SharedFrame **)payload;
+			lws_write(wsi, frame->payload, frame->size, frame->is_string ? LWS_WRITE_TEXT : LWS_WRITE_BINARY);
+			unref_shared_frame(frame);
+		} else {
+			lws_write(wsi, payload, size, (flags & PACKET_STRING) ? LWS_WRITE_TEXT : LWS_WRITE_BINARY);
+		}
+		_out_buffer.pop();
+	}
 
-	if (count > 1)
+	if (_out_buffer.packets_left() > 0)
 		lws_callback_on_writable(wsi); // we want to write more!
 
 	return OK;
 }
 
+Error LWSPeer::_put_frame(const uint8_t *p_buffer, int p_buffer_size, uint8_t p_flags) {
+
+	Error err = _out_buffer.append(p_buffer, p_buffer_size);
+	if (err == OK)
+		err = _out_buffer.commit(p_flags);
+	if (err != OK) {
+		ERR_PRINT("Buffer full! Dropping data.");
+		return err;
+	}
+
+	_request_write();
+	return OK;
+}
+
+void LWSPeer::_request_write() {
+
+	if (!_server) {
+		lws_callback_on_writable(wsi); // notify that we want to write
+		return;
+	}
+
+	// Ask the server thread once, until it picked the request up.
+	if (_write_requested == 0) {
+		atomic_increment(&_write_requested);
+		_server->_push_command(LWSServer::CMD_WRITE, this);
+	}
+}
+
+void LWSPeer::_drain_out_buffer() {
+
+	uint8_t *payload;
+	uint32_t size;
+	uint8_t flags;
+	while (_out_buffer.peek(&payload, size, flags)) {
+		if (flags & PACKET_SHARED)
+			unref_shared_frame(*(SharedFrame **)payload);
+		_out_buffer.pop();
+	}
+}
+
 Error LWSPeer::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 
 	ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
 
-	uint8_t is_string = write_mode == WRITE_MODE_TEXT;
-	_out_buffer.write_packet(p_buffer, p_buffer_size, &is_string);
-	lws_callback_on_writable(wsi); // notify that we want to write
-	return OK;
+	return _put_frame(p_buffer, p_buffer_size, write_mode == WRITE_MODE_TEXT ? PACKET_STRING : 0);
 };
 
+Error LWSPeer::put_shared_frame(SharedFrame *p_frame) {
+
+	ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
+
+	// Only the pointer is queued.
+	p_frame->refcount.ref();
+	Error err = _put_frame((const uint8_t *)&p_frame, sizeof(SharedFrame *), PACKET_SHARED);
+	if (err != OK)
+		unref_shared_frame(p_frame);
+	return err;
+}
+
 Error LWSPeer::get_packet(const uint8_t **r_buffer, int &r_buffer_size) {
 
 	r_buffer_size = 0;
 
 	ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
 
-	if (_in_buffer.packets_left() == 0)
+	if (_in_pending) {
+		_in_buffer.pop();
+		_in_pending = false;
+	}
+
+	uint8_t *payload;
+	uint32_t size;
+	uint8_t flags;
+	if (!_in_buffer.peek(&payload, size, flags))
 		return ERR_UNAVAILABLE;
 
-	int read = 0;
-	PoolVector<uint8_t>::Write rw = _packet_buffer.write();
-	_in_buffer.read_packet(rw.ptr(), _packet_buffer.size(), &_is_string, read);
+	// Read in place, so it stays in the buffer until the next call.
+	_in_pending = true;
+	_is_string = flags & PACKET_STRING;
 
-	*r_buffer = rw.ptr();
-	r_buffer_size = read;
+	*r_buffer = payload;
+	r_buffer_size = size;
 
 	return OK;
 };
@@ -149,7 +241,7 @@ int LWSPeer::get_available_packet_count() const {
 	if (!is_connected_to_host())
 		return 0;
 
-	return _in_buffer.packets_left();
+	return _in_buffer.packets_left() - (_in_pending ? 1 : 0);
 };
 
 bool LWSPeer::was_string_packet() const {
@@ -159,7 +251,7 @@ bool LWSPeer::was_string_packet() const {
 
 bool LWSPeer::is_connected_to_host() const {
 
-	return wsi != NULL;
+	return _connected;
 };
 
 String LWSPeer::get_close_reason(void *in, size_t len, int &r_code) {
@@ -195,6 +287,17 @@ void LWSPeer::send_close_status(struct lws *p_wsi) {
 }
 
 void LWSPeer::close(int p_code, String p_reason) {
+	if (_server) {
+		// wsi belongs to the server thread, which starts the close handshake.
+		if (_connected) {
+			close_code = p_code;
+			close_reason = p_reason;
+			_server->_push_command(LWSServer::CMD_CLOSE, this);
+		}
+		_connected = false;
+		return;
+	}
+
 	if (wsi != NULL) {
 		close_code = p_code;
 		close_reason = p_reason;
@@ -207,58 +310,36 @@ void LWSPeer::close(int p_code, String p_reason) {
 		close_reason = "";
 	}
 	wsi = NULL;
+	_connected = false;
 	_in_buffer.clear();
+	_drain_out_buffer();
 	_out_buffer.clear();
 	_in_size = 0;
+	_in_pending = false;
 	_is_string = 0;
-	_packet_buffer.resize(0);
 };
 
 IP_Address LWSPeer::get_connected_host() const {
 
 	ERR_FAIL_COND_V(!is_connected_to_host(), IP_Address());
 
-	IP_Address ip;
-	uint16_t port = 0;
-
-	struct sockaddr_storage addr;
-	socklen_t len = sizeof(addr);
-
-	int fd = lws_get_socket_fd(wsi);
-	ERR_FAIL_COND_V(fd == -1, IP_Address());
-
-	int ret = getpeername(fd, (struct sockaddr *)&addr, &len);
-	ERR_FAIL_COND_V(ret != 0, IP_Address());
-
-	NetSocketPosix::_set_ip_port(&addr, ip, port);
-
-	return ip;
+	return _ip;
 };
 
 uint16_t LWSPeer::get_connected_port() const {
 
 	ERR_FAIL_COND_V(!is_connected_to_host(), 0);
 
-	IP_Address ip;
-	uint16_t port = 0;
-
-	struct sockaddr_storage addr;
-	socklen_t len = sizeof(addr);
-
-	int fd = lws_get_socket_fd(wsi);
-	ERR_FAIL_COND_V(fd == -1, 0);
-
-	int ret = getpeername(fd, (struct sockaddr *)&addr, &len);
-	ERR_FAIL_COND_V(ret != 0, 0);
-
-	NetSocketPosix::_set_ip_port(&addr, ip, port);
-
-	return port;
+	return _port;
 };
 
 LWSPeer::LWSPeer() {
 	wsi = NULL;
 	write_mode = WRITE_MODE_BINARY;
+	_connected = false;
+	_port = 0;
+	_server = NULL;
+	_write_requested = 0;
 	close();
 };
 
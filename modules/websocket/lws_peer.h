@@ -38,28 +38,63 @@
 #include "core/ring_buffer.h"
 #include "libwebsockets.h"
 #include "lws_config.h"
-#include "packet_buffer.h"
+#include "packet_ring.h"
 #include "websocket_peer.h"
 
+class LWSServer;
+
 class LWSPeer : public WebSocketPeer {
 
 	GDCIIMPL(LWSPeer, WebSocketPeer);
 
+	friend class LWSServer;
+
+public:
+	// A message queued for many peers at once, each of them sends the same
+	// buffer and the last one frees it.
+	struct SharedFrame {
+		SafeRefCount refcount;
+		uint32_t size;
+		bool is_string;
+		uint8_t *payload; // With LWS_PRE free bytes before it.
+	};
+
+	static SharedFrame *create_shared_frame(const uint8_t *p_buffer, int p_buffer_size, bool p_is_string);
+	static void unref_shared_frame(SharedFrame *p_frame);
+
 private:
+	enum {
+		PACKET_STRING = 1,
+		PACKET_SHARED = 2, // The payload is a SharedFrame pointer.
+	};
+
+	// Packets are read and written in place. When the server services lws on
+	// its own thread, that thread produces _in_buffer and consumes
+	// _out_buffer, the main thread does the opposite.
+	PacketRing _in_buffer;
+	PacketRing _out_buffer;
 	int _in_size;
+	bool _in_pending; // Returned by the last get_packet(), released by the next one.
 	uint8_t _is_string;
-	// Our packet info is just a boolean (is_string), using uint8_t for it.
-	PacketBuffer<uint8_t> _in_buffer;
-	PacketBuffer<uint8_t> _out_buffer;
-
-	PoolVector<uint8_t> _packet_buffer;
 
-	struct lws *wsi;
+	struct lws *wsi; // Only touched by whoever services lws.
 	WriteMode write_mode;
+	bool _connected;
+	IP_Address _ip;
+	uint16_t _port;
+
+	// Set while a server thread services lws, which then owns wsi. Writes and
+	// closes are requested from it instead.
+	LWSServer *_server;
+	volatile uint32_t _write_requested;
 
 	int close_code;
 	String close_reason;
 
+	Error _put_frame(const uint8_t *p_buffer, int p_buffer_size, uint8_t p_flags);
+	void _request_write();
+	void _drain_out_buffer();
+
 public:
 	struct PeerData {
 		uint32_t peer_id;
@@ -70,7 +105,7 @@ public:
 	virtual int get_available_packet_count() const;
 	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size);
 	virtual Error put_packet(const uint8_t *p_buffer, int p_buffer_size);
-	virtual int get_max_packet_size() const { return _packet_buffer.size(); };
+	virtual int get_max_packet_size() const { return _out_buffer.get_max_packet_size(); };
 
 	virtual void close(int p_code = 1000, String p_reason = "");
 	virtual bool is_connected_to_host() const;
@@ -86,6 +121,7 @@ public:
 	Error write_wsi();
 	void send_close_status(struct lws *wsi);
 	String get_close_reason(void *in, size_t len, int &r_code);
+	Error put_shared_frame(SharedFrame *p_frame);
 
 	LWSPeer();
 	~LWSPeer();
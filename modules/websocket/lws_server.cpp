@@ -62,6 +62,8 @@ Error LWSServer::listen(int p_port, PoolVector<String> p_protocols, bool gd_mp_a
 		ERR_FAIL_V(FAILED);
 	}
 
+	_start_thread();
+
 	return OK;
 }
 
@@ -70,13 +72,26 @@ bool LWSServer::is_listening() const {
 }
 
 int LWSServer::get_max_packet_size() const {
-	return (1 << _out_buf_size) - PROTO_SIZE;
+	return PacketRing::get_max_packet_size(1 << _out_buf_size, LWS_PRE) - PROTO_SIZE;
+}
+
+LWSPeer *LWSServer::_find_peer(int32_t p_peer_id) {
+
+	if (threaded) {
+		Map<int, Ref<LWSPeer> >::Element *E = thread_peer_map.find(p_peer_id);
+		return E ? E->get().ptr() : NULL;
+	}
+
+	Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.find(p_peer_id);
+	return E ? static_cast<LWSPeer *>(E->get().ptr()) : NULL;
 }
 
 int LWSServer::_handle_cb(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len) {
 
 	LWSPeer::PeerData *peer_data = (LWSPeer::PeerData *)user;
 
+	// When threaded, this runs on the service thread. Peers are tracked in
+	// thread_peer_map and everything else goes to poll() as events.
 	switch (reason) {
 		case LWS_CALLBACK_HTTP:
 			// no http for now
@@ -92,11 +107,25 @@ int LWSServer::_handle_cb(struct lws *wsi, enum lws_callback_reasons reason, voi
 
 			Ref<LWSPeer> peer = Ref<LWSPeer>(memnew(LWSPeer));
 			peer->set_wsi(wsi, _in_buf_size, _in_pkt_size, _out_buf_size, _out_pkt_size);
-			_peer_map[id] = peer;
 
 			peer_data->peer_id = id;
 			peer_data->force_close = false;
 			peer_data->clean_close = false;
+
+			if (threaded) {
+				peer->_server = this;
+				thread_peer_map[id] = peer;
+
+				Event event;
+				event.type = EVENT_CONNECT;
+				event.peer_id = id;
+				event.peer = peer;
+				event.text = lws_get_protocol(wsi)->name;
+				_push_event(event);
+				break;
+			}
+
+			_peer_map[id] = peer;
 			_on_connect(id, lws_get_protocol(wsi)->name);
 			break;
 		}
@@ -106,12 +135,22 @@ int LWSServer::_handle_cb(struct lws *wsi, enum lws_callback_reasons reason, voi
 				return 0;
 
 			int32_t id = peer_data->peer_id;
-			if (_peer_map.has(id)) {
+			LWSPeer *peer = _find_peer(id);
+			if (peer) {
 				int code;
-				Ref<LWSPeer> peer = _peer_map[id];
 				String reason2 = peer->get_close_reason(in, len, code);
 				peer_data->clean_close = true;
-				_on_close_request(id, code, reason2);
+
+				if (threaded) {
+					Event event;
+					event.type = EVENT_CLOSE_REQUEST;
+					event.peer_id = id;
+					event.code = code;
+					event.text = reason2;
+					_push_event(event);
+				} else {
+					_on_close_request(id, code, reason2);
+				}
 			}
 			return 0;
 		}
@@ -121,6 +160,24 @@ int LWSServer::_handle_cb(struct lws *wsi, enum lws_callback_reasons reason, voi
 				return 0;
 			int32_t id = peer_data->peer_id;
 			bool clean = peer_data->clean_close;
+
+			if (threaded) {
+				// Done with it here, the main thread closes it on its side.
+				Map<int, Ref<LWSPeer> >::Element *E = thread_peer_map.find(id);
+				if (E) {
+					E->get()->wsi = NULL;
+					E->get()->_drain_out_buffer();
+					thread_peer_map.erase(E);
+				}
+
+				Event event;
+				event.type = EVENT_DISCONNECT;
+				event.peer_id = id;
+				event.clean = clean;
+				_push_event(event);
+				return 0;
+			}
+
 			if (_peer_map.has(id)) {
 				_peer_map[id]->close();
 				_peer_map.erase(id);
@@ -131,26 +188,34 @@ int LWSServer::_handle_cb(struct lws *wsi, enum lws_callback_reasons reason, voi
 
 		case LWS_CALLBACK_RECEIVE: {
 			int32_t id = peer_data->peer_id;
-			if (_peer_map.has(id)) {
-				static_cast<Ref<LWSPeer> >(_peer_map[id])->read_wsi(in, len);
-				if (_peer_map[id]->get_available_packet_count() > 0)
+			LWSPeer *peer = _find_peer(id);
+			if (peer) {
+				Error err = peer->read_wsi(in, len);
+				if (threaded) {
+					if (err == OK && lws_is_final_fragment(wsi)) {
+						Event event;
+						event.type = EVENT_RECEIVE;
+						event.peer_id = id;
+						_push_event(event);
+					}
+				} else if (peer->get_available_packet_count() > 0) {
 					_on_peer_packet(id);
+				}
 			}
 			break;
 		}
 
 		case LWS_CALLBACK_SERVER_WRITEABLE: {
 			int id = peer_data->peer_id;
+			LWSPeer *peer = _find_peer(id);
 			if (peer_data->force_close) {
-				if (_peer_map.has(id)) {
-					Ref<LWSPeer> peer = _peer_map[id];
+				if (peer)
 					peer->send_close_status(wsi);
-				}
 				return -1;
 			}
 
-			if (_peer_map.has(id))
-				static_cast<Ref<LWSPeer> >(_peer_map[id])->write_wsi();
+			if (peer)
+				peer->write_wsi();
 			break;
 		}
 
@@ -161,10 +226,219 @@ int LWSServer::_handle_cb(struct lws *wsi, enum lws_callback_reasons reason, voi
 	return 0;
 }
 
+void LWSServer::poll() {
+
+	if (!thread) {
+		_lws_poll();
+		return;
+	}
+
+	// Retry commands the queue had no room for.
+	if (command_overflow.size()) {
+		while (command_overflow.size() && command_queue.push(command_overflow.front()->get())) {
+			command_overflow.pop_front();
+		}
+		_wake_thread();
+	}
+
+	Event event;
+	while (thread && event_queue.pop(event)) { // Signals may stop() the server.
+
+		switch (event.type) {
+			case EVENT_CONNECT: {
+
+				_peer_map[event.peer_id] = event.peer;
+				_on_connect(event.peer_id, event.text);
+			} break;
+			case EVENT_RECEIVE: {
+
+				Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.find(event.peer_id);
+				if (E && E->get()->get_available_packet_count() > 0)
+					_on_peer_packet(event.peer_id);
+			} break;
+			case EVENT_CLOSE_REQUEST: {
+
+				if (_peer_map.has(event.peer_id))
+					_on_close_request(event.peer_id, event.code, event.text);
+			} break;
+			case EVENT_DISCONNECT: {
+
+				Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.find(event.peer_id);
+				if (E) {
+					// Not the service thread's anymore.
+					LWSPeer *peer = static_cast<LWSPeer *>(E->get().ptr());
+					peer->_server = NULL;
+					peer->close();
+					_peer_map.erase(E);
+				}
+				_on_disconnect(event.peer_id, event.clean);
+			} break;
+		}
+	}
+}
+
+Error LWSServer::_broadcast(const uint8_t *p_buffer, int p_buffer_size, WebSocketPeer::WriteMode p_mode, int32_t p_exclude, int32_t p_exclude2) {
+
+	ERR_FAIL_COND_V(!is_listening(), FAILED);
+	ERR_FAIL_COND_V(p_buffer_size > PacketRing::get_max_packet_size(1 << _out_buf_size, LWS_PRE), ERR_INVALID_PARAMETER);
+
+	// Every peer queues a pointer to the same copy, and lws_write() writes
+	// the same header in front of it each time, as servers do not mask.
+	LWSPeer::SharedFrame *frame = LWSPeer::create_shared_frame(p_buffer, p_buffer_size, p_mode == WebSocketPeer::WRITE_MODE_TEXT);
+
+	for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
+
+		if (E->key() == p_exclude || E->key() == p_exclude2)
+			continue;
+
+		LWSPeer *peer = static_cast<LWSPeer *>(E->get().ptr());
+		if (peer->is_connected_to_host())
+			peer->put_shared_frame(frame);
+	}
+
+	LWSPeer::unref_shared_frame(frame);
+	return OK;
+}
+
+void LWSServer::_push_event(const Event &p_event) {
+
+	// Keep events in order if the main thread fell behind.
+	if (event_overflow.size() || !event_queue.push(p_event)) {
+		event_overflow.push_back(p_event);
+	}
+}
+
+void LWSServer::_push_command(CommandType p_type, LWSPeer *p_peer) {
+
+	Command command;
+	command.type = p_type;
+	command.peer = Ref<LWSPeer>(p_peer);
+
+	// Keep commands in order if the service thread fell behind.
+	if (command_overflow.size() || !command_queue.push(command)) {
+		command_overflow.push_back(command);
+	}
+	_wake_thread();
+}
+
+void LWSServer::_run_command(Command &p_command) {
+
+	LWSPeer *peer = p_command.peer.ptr();
+	if (p_command.type == CMD_WRITE)
+		atomic_decrement(&peer->_write_requested);
+
+	// The connection may have closed while the command was queued.
+	if (peer->wsi == NULL)
+		return;
+
+	switch (p_command.type) {
+		case CMD_WRITE: {
+
+			lws_callback_on_writable(peer->wsi);
+		} break;
+		case CMD_CLOSE: {
+
+			LWSPeer::PeerData *data = (LWSPeer::PeerData *)lws_wsi_user(peer->wsi);
+			data->force_close = true;
+			data->clean_close = true;
+			lws_callback_on_writable(peer->wsi); // Notify that we want to disconnect
+		} break;
+	}
+}
+
+void LWSServer::_wake_thread() {
+
+	// lws_cancel_service() writes to a pipe, only do it once until the
+	// service thread picked the commands up.
+	if (wake_requested == 0) {
+		atomic_increment(&wake_requested);
+		lws_cancel_service(context);
+	}
+}
+
+void LWSServer::_start_thread() {
+
+	if (!use_thread)
+		return;
+
+	event_queue.resize(12);
+	command_queue.resize(13);
+	thread_exit = false;
+	wake_requested = 0;
+	threaded = true;
+	thread = Thread::create(_thread_func, this);
+	if (!thread)
+		threaded = false; // No thread support, poll() services lws then.
+}
+
+void LWSServer::_stop_thread() {
+
+	if (!thread)
+		return;
+
+	thread_exit = true;
+	lws_cancel_service(context);
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	thread = NULL;
+	threaded = false;
+
+	// lws belongs to the main thread again, as do the peers.
+	for (Map<int, Ref<LWSPeer> >::Element *E = thread_peer_map.front(); E; E = E->next()) {
+		E->get()->_server = NULL;
+	}
+	for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
+		static_cast<LWSPeer *>(E->get().ptr())->_server = NULL;
+	}
+	thread_peer_map.clear();
+
+	// Nobody will send or poll these anymore.
+	Command command;
+	while (command_queue.pop(command)) {
+	}
+	command_overflow.clear();
+
+	Event event;
+	while (event_queue.pop(event)) {
+	}
+	event_overflow.clear();
+}
+
+void LWSServer::_thread_loop() {
+
+	Command command;
+
+	while (!thread_exit) {
+
+		// Everything queued so far is picked up below, later commands need to wake us again.
+		if (wake_requested)
+			atomic_decrement(&wake_requested);
+
+		while (command_queue.pop(command)) {
+			_run_command(command);
+		}
+
+		// Retry events the main thread had no room for before adding new ones, so order holds.
+		while (event_overflow.size() && event_queue.push(event_overflow.front()->get())) {
+			event_overflow.pop_front();
+		}
+
+		// Returns early when woken up by lws_cancel_service().
+		lws_service(context, event_overflow.size() ? 1 : 100);
+	}
+}
+
+void LWSServer::_thread_func(void *p_userdata) {
+
+	LWSServer *server = (LWSServer *)p_userdata;
+	server->_thread_loop();
+}
+
 void LWSServer::stop() {
 	if (context == NULL)
 		return;
 
+	_stop_thread();
 	_peer_map.clear();
 	destroy_context();
 	context = NULL;
@@ -204,6 +478,10 @@ LWSServer::LWSServer() {
 	_out_pkt_size = nearest_shift((int)GLOBAL_GET(WSS_OUT_PKT) - 1);
 	context = NULL;
 	_lws_ref = NULL;
+	thread = NULL;
+	threaded = false;
+	thread_exit = false;
+	wake_requested = 0;
 }
 
 LWSServer::~LWSServer() {
@@ -33,7 +33,9 @@
 
 #ifndef JAVASCRIPT_ENABLED
 
+#include "core/os/thread.h"
 #include "core/reference.h"
+#include "core/spsc_queue.h"
 #include "lws_helper.h"
 #include "lws_peer.h"
 #include "websocket_server.h"
@@ -44,13 +46,69 @@ class LWSServer : public WebSocketServer {
 
 	LWS_HELPER(LWSServer);
 
+	friend class LWSPeer;
+
 private:
-	Map<int, Ref<LWSPeer> > peer_map;
 	int _in_buf_size;
 	int _in_pkt_size;
 	int _out_buf_size;
 	int _out_pkt_size;
 
+	// What poll() consumes when lws is serviced by its own thread.
+	enum EventType {
+		EVENT_CONNECT,
+		EVENT_RECEIVE,
+		EVENT_CLOSE_REQUEST,
+		EVENT_DISCONNECT
+	};
+
+	struct Event {
+
+		EventType type;
+		int32_t peer_id;
+		Ref<LWSPeer> peer; // Connect only.
+		String text; // Protocol or close reason.
+		int code;
+		bool clean;
+	};
+
+	// Requests from the main thread to the one servicing lws.
+	enum CommandType {
+		CMD_WRITE,
+		CMD_CLOSE
+	};
+
+	struct Command {
+
+		CommandType type;
+		Ref<LWSPeer> peer;
+	};
+
+	Thread *thread;
+	bool threaded; // Set before the thread starts, so callbacks know where they run.
+	volatile bool thread_exit;
+	volatile uint32_t wake_requested;
+
+	SPSCQueue<Event> event_queue;
+	SPSCQueue<Command> command_queue;
+	List<Event> event_overflow; // Service thread only.
+	List<Command> command_overflow; // Main thread only.
+	Map<int, Ref<LWSPeer> > thread_peer_map; // Service thread only.
+
+	LWSPeer *_find_peer(int32_t p_peer_id);
+	void _push_event(const Event &p_event);
+	void _push_command(CommandType p_type, LWSPeer *p_peer);
+	void _run_command(Command &p_command);
+	void _wake_thread();
+
+	void _start_thread();
+	void _stop_thread();
+	void _thread_loop();
+	static void _thread_func(void *p_userdata);
+
+protected:
+	virtual Error _broadcast(const uint8_t *p_buffer, int p_buffer_size, WebSocketPeer::WriteMode p_mode, int32_t p_exclude = 0, int32_t p_exclude2 = 0);
+
 public:
 	Error listen(int p_port, PoolVector<String> p_protocols = PoolVector<String>(), bool gd_mp_api = false);
 	void stop();
@@ -61,7 +119,7 @@ public:
 	IP_Address get_peer_address(int p_peer_id) const;
 	int get_peer_port(int p_peer_id) const;
 	void disconnect_peer(int p_peer_id, int p_code = 1000, String p_reason = "");
-	virtual void poll() { _lws_poll(); }
+	virtual void poll();
 
 	LWSServer();
 	~LWSServer();
@@ -0,0 +1,272 @@
+/*************************************************************************/
+/*  packet_ring.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PACKET_RING_H
+#define PACKET_RING_H
+
+#include "core/error_list.h"
+#include "core/error_macros.h"
+#include "core/os/copymem.h"
+#include "core/os/memory.h"
+#include "core/safe_refcount.h"
+
+// Packets stored back to back in one preallocated buffer. Unlike PacketBuffer
+// each packet is kept contiguous, so it can be handed out (or given to
+// lws_write()) in place instead of being copied out first. A packet that does
+// not fit before the end of the buffer starts again at its beginning.
+//
+// Safe for one producer and one consumer thread, as SPSCQueue: each position
+// is only written by its own side and published with an atomic add, which
+// also acts as the memory barrier for the data written before it.
+class PacketRing {
+
+	enum {
+		HEADER_SIZE = 8,
+		ALIGN = 8,
+		FLAG_WRAP = 0x80, // The rest of the buffer is unused, next packet at its start.
+	};
+
+	struct Header {
+		uint32_t size;
+		uint32_t flags;
+	};
+
+	uint8_t *data;
+	uint32_t size_mask;
+	uint32_t headroom;
+	uint32_t max_packets;
+
+	volatile uint32_t read_pos;
+	volatile uint32_t write_pos;
+	volatile uint32_t packets_written;
+	volatile uint32_t packets_read;
+
+	// Producer side, the packet being written but not committed yet.
+	bool open;
+	uint32_t open_pos;
+	uint32_t open_size;
+
+	// Reads a value written by the other side, with a full barrier.
+	_FORCE_INLINE_ static uint32_t _load(const volatile uint32_t *p_pos) {
+
+		return atomic_add(const_cast<volatile uint32_t *>(p_pos), 0);
+	}
+
+	_FORCE_INLINE_ uint32_t _span(uint32_t p_size) const {
+
+		return (HEADER_SIZE + headroom + p_size + ALIGN - 1) & ~(uint32_t)(ALIGN - 1);
+	}
+
+	_FORCE_INLINE_ uint8_t *_payload(uint32_t p_pos) const {
+
+		return &data[(p_pos & size_mask) + HEADER_SIZE + headroom];
+	}
+
+	// Where a packet of p_span bytes can start, at p_pos or at the start of
+	// the buffer. False if there is no room for it yet.
+	bool _place(uint32_t p_pos, uint32_t p_span, uint32_t &r_pos) const {
+
+		uint32_t capacity = size_mask + 1;
+		uint32_t offset = p_pos & size_mask;
+		r_pos = offset + p_span > capacity ? p_pos + capacity - offset : p_pos;
+		return r_pos + p_span - _load(&read_pos) <= capacity;
+	}
+
+public:
+	enum {
+		// Free to use by callers, the ring only keeps them.
+		FLAGS_MASK = 0x7F
+	};
+
+	// Producer side. Adds p_size bytes to the packet being written, starting
+	// a new one if needed. The whole packet is dropped if it does not fit.
+	Error append(const uint8_t *p_data, uint32_t p_size) {
+
+		ERR_FAIL_COND_V(!data, ERR_UNCONFIGURED);
+
+		if (!open) {
+			uint32_t pos;
+			if (!_place(write_pos, _span(p_size), pos))
+				return ERR_OUT_OF_MEMORY;
+			open = true;
+			open_pos = pos;
+			open_size = 0;
+
+		} else {
+			uint32_t pos;
+			if (!_place(open_pos, _span(open_size + p_size), pos)) {
+				open = false;
+				return ERR_OUT_OF_MEMORY;
+			}
+			if (pos != open_pos) {
+				// Grew past the end of the buffer, move what is there to its start.
+				copymem(_payload(pos), _payload(open_pos), open_size);
+				open_pos = pos;
+			}
+		}
+
+		if (p_size) {
+			copymem(_payload(open_pos) + open_size, p_data, p_size);
+			open_size += p_size;
+		}
+		return OK;
+	}
+
+	// Producer side. Makes the packet being written (possibly empty)
+	// available to the consumer.
+	Error commit(uint8_t p_flags) {
+
+		if (!open) {
+			Error err = append(NULL, 0);
+			if (err != OK)
+				return err;
+		}
+		open = false;
+
+		if (packets_written - _load(&packets_read) >= max_packets)
+			return ERR_OUT_OF_MEMORY;
+
+		if (open_pos != write_pos) {
+			Header *wrap = (Header *)&data[write_pos & size_mask];
+			wrap->size = 0;
+			wrap->flags = FLAG_WRAP;
+		}
+
+		Header *header = (Header *)&data[open_pos & size_mask];
+		header->size = open_size;
+		header->flags = p_flags & FLAGS_MASK;
+
+		atomic_add(&write_pos, open_pos + _span(open_size) - write_pos);
+		atomic_increment(&packets_written);
+		return OK;
+	}
+
+	// Producer side. Drops the packet being written.
+	void discard() {
+
+		open = false;
+	}
+
+	// Consumer side. The oldest packet, which stays valid until pop(). The
+	// payload is writable, with headroom free bytes before it.
+	bool peek(uint8_t **r_payload, uint32_t &r_size, uint8_t &r_flags) {
+
+		uint32_t pos = read_pos;
+		if (_load(&write_pos) == pos)
+			return false;
+
+		Header *header = (Header *)&data[pos & size_mask];
+		if (header->flags & FLAG_WRAP) {
+			// Always committed together with the packet that follows it.
+			atomic_add(&read_pos, size_mask + 1 - (pos & size_mask));
+			pos = read_pos;
+			header = (Header *)&data[pos & size_mask];
+		}
+
+		*r_payload = _payload(pos);
+		r_size = header->size;
+		r_flags = header->flags;
+		return true;
+	}
+
+	// Consumer side. Releases the packet returned by peek().
+	void pop() {
+
+		uint32_t pos = read_pos;
+		ERR_FAIL_COND(_load(&write_pos) == pos);
+
+		const Header *header = (const Header *)&data[pos & size_mask];
+		ERR_FAIL_COND(header->flags & FLAG_WRAP);
+
+		atomic_add(&read_pos, _span(header->size));
+		atomic_increment(&packets_read);
+	}
+
+	int packets_left() const {
+
+		return _load(&packets_written) - _load(&packets_read);
+	}
+
+	// Largest packet the ring can ever hold.
+	int get_max_packet_size() const {
+
+		return data ? get_max_packet_size(size_mask + 1, headroom) : 0;
+	}
+
+	static int get_max_packet_size(int p_capacity, int p_headroom) {
+
+		return (p_capacity - HEADER_SIZE - p_headroom) & ~(ALIGN - 1);
+	}
+
+	// Not thread safe, only call while neither side is using the ring.
+	void resize(int p_buf_shift, int p_pkt_shift, int p_headroom = 0) {
+
+		clear();
+		if (p_buf_shift <= 0)
+			return;
+
+		ERR_FAIL_COND(get_max_packet_size(1 << p_buf_shift, p_headroom) <= 0);
+		data = (uint8_t *)memalloc(1 << p_buf_shift);
+		size_mask = (1 << p_buf_shift) - 1;
+		headroom = p_headroom;
+		max_packets = 1 << p_pkt_shift;
+	}
+
+	// Not thread safe, only call while neither side is using the ring.
+	void clear() {
+
+		if (data)
+			memfree(data);
+		data = NULL;
+		size_mask = 0;
+		headroom = 0;
+		max_packets = 0;
+		read_pos = 0;
+		write_pos = 0;
+		packets_written = 0;
+		packets_read = 0;
+		open = false;
+		open_pos = 0;
+		open_size = 0;
+	}
+
+	PacketRing() {
+
+		data = NULL;
+		clear();
+	}
+
+	~PacketRing() {
+
+		clear();
+	}
+};
+
+#endif // PACKET_RING_H
@@ -190,6 +190,22 @@ void WebSocketMultiplayerPeer::_send_sys(Ref<WebSocketPeer> p_peer, uint8_t p_ty
 	p_peer->put_packet(&(message.read()[0]), message.size());
 }
 
+Error WebSocketMultiplayerPeer::_broadcast(const uint8_t *p_buffer, int p_buffer_size, WebSocketPeer::WriteMode p_mode, int32_t p_exclude, int32_t p_exclude2) {
+
+	for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
+
+		if (E->key() == p_exclude || E->key() == p_exclude2 || E->get().is_null())
+			continue;
+
+		Ref<WebSocketPeer> peer = E->get();
+		WebSocketPeer::WriteMode mode = peer->get_write_mode();
+		peer->set_write_mode(p_mode);
+		peer->put_packet(p_buffer, p_buffer_size);
+		peer->set_write_mode(mode);
+	}
+	return OK;
+}
+
 PoolVector<uint8_t> WebSocketMultiplayerPeer::_make_pkt(uint32_t p_type, int32_t p_from, int32_t p_to, const uint8_t *p_data, uint32_t p_data_size) {
 
 	PoolVector<uint8_t> out;
@@ -212,24 +228,23 @@ void WebSocketMultiplayerPeer::_send_add(int32_t p_peer_id) {
 	// Then send the server peer (which will trigger connection_succeded in client)
 	_send_sys(get_peer(p_peer_id), SYS_ADD, 1);
 
+	// Send new peer to others, the message is the same for all of them
+	PoolVector<uint8_t> message = _make_pkt(SYS_ADD, 1, 0, (uint8_t *)&p_peer_id, 4);
+	_broadcast(&(message.read()[0]), message.size(), WebSocketPeer::WRITE_MODE_BINARY, p_peer_id);
+
 	for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
 		int32_t id = E->key();
 		if (p_peer_id == id)
 			continue; // Skip the newwly added peer (already confirmed)
 
-		// Send new peer to others
-		_send_sys(get_peer(id), SYS_ADD, p_peer_id);
 		// Send others to new peer
 		_send_sys(get_peer(p_peer_id), SYS_ADD, id);
 	}
 }
 
 void WebSocketMultiplayerPeer::_send_del(int32_t p_peer_id) {
-	for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
-		int32_t id = E->key();
-		if (p_peer_id != id)
-			_send_sys(get_peer(id), SYS_DEL, p_peer_id);
-	}
+	PoolVector<uint8_t> message = _make_pkt(SYS_DEL, 1, 0, (uint8_t *)&p_peer_id, 4);
+	_broadcast(&(message.read()[0]), message.size(), WebSocketPeer::WRITE_MODE_BINARY, p_peer_id);
 }
 
 void WebSocketMultiplayerPeer::_store_pkt(int32_t p_source, int32_t p_dest, const uint8_t *p_data, uint32_t p_data_size) {
@@ -250,19 +265,11 @@ Error WebSocketMultiplayerPeer::_server_relay(int32_t p_from, int32_t p_to, cons
 
 	} else if (p_to == 0) {
 
-		for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
-			if (E->key() != p_from)
-				E->get()->put_packet(p_buffer, p_buffer_size);
-		}
-		return OK; // Sent to all but sender
+		return _broadcast(p_buffer, p_buffer_size, WebSocketPeer::WRITE_MODE_BINARY, p_from); // Sent to all but sender
 
 	} else if (p_to < 0) {
 
-		for (Map<int, Ref<WebSocketPeer> >::Element *E = _peer_map.front(); E; E = E->next()) {
-			if (E->key() != p_from && E->key() != -p_to)
-				E->get()->put_packet(p_buffer, p_buffer_size);
-		}
-		return OK; // Sent to all but sender and excluded
+		return _broadcast(p_buffer, p_buffer_size, WebSocketPeer::WRITE_MODE_BINARY, p_from, -p_to); // Sent to all but sender and excluded
 
 	} else {
 
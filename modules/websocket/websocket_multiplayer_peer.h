@@ -78,6 +78,10 @@ protected:
 	void _send_del(int32_t p_peer_id);
 	int _gen_unique_id() const;
 
+	// Sends the same packet to all peers but the excluded ones (0 excludes
+	// none). Implementations able to share one buffer among peers override it.
+	virtual Error _broadcast(const uint8_t *p_buffer, int p_buffer_size, WebSocketPeer::WriteMode p_mode, int32_t p_exclude = 0, int32_t p_exclude2 = 0);
+
 public:
 	/* NetworkedMultiplayerPeer */
 	void set_transfer_mode(TransferMode p_mode);
@@ -34,6 +34,7 @@ GDCINULL(WebSocketServer);
 
 WebSocketServer::WebSocketServer() {
 	_peer_id = 1;
+	use_thread = false;
 }
 
 WebSocketServer::~WebSocketServer() {
@@ -48,6 +49,11 @@ void WebSocketServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_peer_address", "id"), &WebSocketServer::get_peer_address);
 	ClassDB::bind_method(D_METHOD("get_peer_port", "id"), &WebSocketServer::get_peer_port);
 	ClassDB::bind_method(D_METHOD("disconnect_peer", "id", "code", "reason"), &WebSocketServer::disconnect_peer, DEFVAL(1000), DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("broadcast_packet", "packet", "write_mode", "exclude_id"), &WebSocketServer::_broadcast_packet_bind, DEFVAL(WebSocketPeer::WRITE_MODE_BINARY), DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("set_use_thread", "enable"), &WebSocketServer::set_use_thread);
+	ClassDB::bind_method(D_METHOD("is_using_thread"), &WebSocketServer::is_using_thread);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_thread"), "set_use_thread", "is_using_thread");
 
 	ADD_SIGNAL(MethodInfo("client_close_request", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::INT, "code"), PropertyInfo(Variant::STRING, "reason")));
 	ADD_SIGNAL(MethodInfo("client_disconnected", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::BOOL, "was_clean_close")));
@@ -67,6 +73,30 @@ bool WebSocketServer::is_server() const {
 	return true;
 }
 
+Error WebSocketServer::broadcast_packet(const uint8_t *p_buffer, int p_buffer_size, WebSocketPeer::WriteMode p_mode, int p_exclude_id) {
+
+	ERR_FAIL_COND_V(!is_listening(), FAILED);
+
+	return _broadcast(p_buffer, p_buffer_size, p_mode, p_exclude_id);
+}
+
+Error WebSocketServer::_broadcast_packet_bind(const PoolVector<uint8_t> &p_packet, WebSocketPeer::WriteMode p_mode, int p_exclude_id) {
+
+	PoolVector<uint8_t>::Read r = p_packet.read();
+	return broadcast_packet(r.ptr(), p_packet.size(), p_mode, p_exclude_id);
+}
+
+void WebSocketServer::set_use_thread(bool p_enable) {
+
+	ERR_FAIL_COND(is_listening());
+	use_thread = p_enable;
+}
+
+bool WebSocketServer::is_using_thread() const {
+
+	return use_thread;
+}
+
 void WebSocketServer::_on_peer_packet(int32_t p_peer_id) {
 
 	if (_is_multiplayer) {
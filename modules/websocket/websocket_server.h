@@ -41,7 +41,10 @@ class WebSocketServer : public WebSocketMultiplayerPeer {
 	GDCICLASS(WebSocketServer);
 
 protected:
+	bool use_thread;
+
 	static void _bind_methods();
+	Error _broadcast_packet_bind(const PoolVector<uint8_t> &p_packet, WebSocketPeer::WriteMode p_mode, int p_exclude_id);
 
 public:
 	virtual void poll() = 0;
@@ -56,6 +59,10 @@ public:
 	virtual IP_Address get_peer_address(int p_peer_id) const = 0;
 	virtual int get_peer_port(int p_peer_id) const = 0;
 	virtual void disconnect_peer(int p_peer_id, int p_code = 1000, String p_reason = "") = 0;
+	Error broadcast_packet(const uint8_t *p_buffer, int p_buffer_size, WebSocketPeer::WriteMode p_mode = WebSocketPeer::WRITE_MODE_BINARY, int p_exclude_id = 0);
+
+	void set_use_thread(bool p_enable);
+	bool is_using_thread() const;
 
 	void _on_peer_packet(int32_t p_peer_id);
 	void _on_connect(int32_t p_peer_id, String p_protocol);
@@ -180,13 +180,24 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 
 	ERR_FAIL_COND_V(status != STATUS_BODY, PoolByteArray());
 
-	int to_read = MIN(read_limit, polled_response.size() - response_read_offset);
 	PoolByteArray chunk;
-	chunk.resize(to_read);
-	PoolByteArray::Write write = chunk.write();
+	chunk.resize(MIN(read_limit, polled_response.size() - response_read_offset));
+	{
+		PoolByteArray::Write write = chunk.write();
+		read_response_body_data(write.ptr(), chunk.size());
+	}
+
+	return chunk;
+}
+
+int HTTPClient::read_response_body_data(uint8_t *p_buffer, int p_size) {
+
+	ERR_FAIL_COND_V(status != STATUS_BODY, 0);
+	ERR_FAIL_COND_V(p_size < 0, 0);
+
+	int to_read = MIN(p_size, polled_response.size() - response_read_offset);
 	PoolByteArray::Read read = polled_response.read();
-	memcpy(write.ptr(), read.ptr() + response_read_offset, to_read);
-	write = PoolByteArray::Write();
+	memcpy(p_buffer, read.ptr() + response_read_offset, to_read);
 	read = PoolByteArray::Read();
 	response_read_offset += to_read;
 
@@ -196,7 +207,7 @@ PoolByteArray HTTPClient::read_response_body_chunk() {
 		godot_xhr_reset(xhr_id);
 	}
 
-	return chunk;
+	return to_read;
 }
 
 void HTTPClient::set_blocking_mode(bool p_enable) {
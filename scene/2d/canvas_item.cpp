@@ -945,10 +945,17 @@ void CanvasItem::_notify_transform(CanvasItem *p_node) {
 
 	p_node->global_invalid = true;
 
-	if (p_node->notify_transform && !p_node->xform_change.in_list()) {
-		if (!p_node->block_transform_notify) {
-			if (p_node->is_inside_tree())
-				get_tree()->xform_change_list.add(&p_node->xform_change);
+#ifdef DEBUG_ENABLED
+	if (p_node == this) {
+		_check_threaded_subtree_access();
+	}
+#endif
+
+	if (p_node->notify_transform && !p_node->block_transform_notify && p_node->is_inside_tree()) {
+
+		MutexLock lock(get_tree()->_get_xform_list_lock());
+		if (!p_node->xform_change.in_list()) {
+			get_tree()->xform_change_list.add(&p_node->xform_change);
 		}
 	}
 
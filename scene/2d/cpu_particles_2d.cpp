@@ -31,6 +31,7 @@
 #include "cpu_particles_2d.h"
 #include "particles_2d.h"
 #include "scene/2d/canvas_item.h"
+#include "scene/main/scene_tree.h"
 #include "scene/resources/particles_material.h"
 #include "servers/visual_server.h"
 
@@ -529,6 +530,19 @@ static float rand_from_seed(uint32_t &seed) {
 	return float(seed % uint32_t(65536)) / 65535.0;
 }
 
+ThreadWorkPool *CPUParticles2D::_get_work_pool(uint32_t p_chunks) {
+
+	if (p_chunks < 2 || !is_inside_tree() || Thread::get_caller_id() != Thread::get_main_id()) {
+		return NULL;
+	}
+
+	ThreadWorkPool *pool = get_tree()->get_work_pool();
+	if (pool->is_working()) {
+		return NULL; //already inside a job, don't nest
+	}
+	return pool;
+}
+
 void CPUParticles2D::_particles_process(float p_delta) {
 
 	p_delta *= speed_scale;
@@ -536,9 +550,12 @@ void CPUParticles2D::_particles_process(float p_delta) {
 	int pcount = particles.size();
 	PoolVector<Particle>::Write w = particles.write();
 
-	Particle *parray = w.ptr();
+	ProcessState state;
+	state.particles = w.ptr();
+	state.count = pcount;
+	state.delta = p_delta;
+	state.prev_time = time;
 
-	float prev_time = time;
 	time += p_delta;
 	if (time > lifetime) {
 		time = Math::fmod(time, lifetime);
@@ -548,316 +565,350 @@ void CPUParticles2D::_particles_process(float p_delta) {
 		}
 	}
 
-	Transform2D emission_xform;
-	Transform2D velocity_xform;
 	if (!local_coords) {
-		emission_xform = get_global_transform();
-		velocity_xform = emission_xform;
-		velocity_xform[2] = Vector2();
+		state.emission_xform = get_global_transform();
+		state.velocity_xform = state.emission_xform;
+		state.velocity_xform[2] = Vector2();
 	}
 
-	for (int i = 0; i < pcount; i++) {
+	PoolVector<Vector2>::Read emission_points_r = emission_points.read();
+	PoolVector<Vector2>::Read emission_normals_r = emission_normals.read();
+	PoolVector<Color>::Read emission_colors_r = emission_colors.read();
 
-		Particle &p = parray[i];
+	state.emission_point_count = emission_points.size();
+	state.emission_points = emission_points_r.ptr();
+	state.emission_normals = emission_normals.size() == state.emission_point_count ? emission_normals_r.ptr() : NULL;
+	state.emission_colors = emission_colors.size() == state.emission_point_count ? emission_colors_r.ptr() : NULL;
 
-		if (!emitting && !p.active)
-			continue;
+	if (color_ramp.is_valid()) {
+		color_ramp->get_color_at_offset(0); //sorts the points if needed, must not happen inside the jobs
+	}
 
-		float restart_time = (float(i) / float(pcount)) * lifetime;
-		float local_delta = p_delta;
+	uint32_t chunks = (pcount + PROCESS_CHUNK_SIZE - 1) / PROCESS_CHUNK_SIZE;
+	ThreadWorkPool *pool = _get_work_pool(chunks);
 
-		if (randomness_ratio > 0.0) {
-			uint32_t seed = cycle;
-			if (restart_time >= time) {
-				seed -= uint32_t(1);
-			}
-			seed *= uint32_t(pcount);
-			seed += uint32_t(i);
-			float random = float(idhash(seed) % uint32_t(65536)) / 65536.0;
-			restart_time += randomness_ratio * random * 1.0 / float(pcount);
+	if (pool) {
+		pool->do_work(chunks, this, &CPUParticles2D::_particles_process_chunk, (const ProcessState *)&state);
+	} else {
+		for (uint32_t i = 0; i < chunks; i++) {
+			_particles_process_chunk(i, &state);
 		}
+	}
+}
 
-		restart_time *= (1.0 - explosiveness_ratio);
-		bool restart = false;
+void CPUParticles2D::_particles_process_chunk(uint32_t p_chunk, const ProcessState *p_state) {
 
-		if (time > prev_time) {
-			// restart_time >= prev_time is used so particles emit in the first frame they are processed
+	int from = p_chunk * PROCESS_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_CHUNK_SIZE, p_state->count);
 
-			if (restart_time >= prev_time && restart_time < time) {
-				restart = true;
-				if (fractional_delta) {
-					local_delta = (time - restart_time) * lifetime;
-				}
-			}
+	for (int i = from; i < to; i++) {
+		_particle_process(i, p_state);
+	}
+}
 
-		} else if (local_delta > 0.0) {
-			if (restart_time >= prev_time) {
-				restart = true;
-				if (fractional_delta) {
-					local_delta = (lifetime - restart_time + time) * lifetime;
-				}
+void CPUParticles2D::_particle_process(int p_index, const ProcessState *p_state) {
 
-			} else if (restart_time < time) {
-				restart = true;
-				if (fractional_delta) {
-					local_delta = (time - restart_time) * lifetime;
-				}
-			}
-		}
+	Particle &p = p_state->particles[p_index];
 
-		if (restart) {
+	if (!emitting && !p.active)
+		return;
 
-			if (!emitting) {
-				p.active = false;
-				continue;
-			}
-			p.active = true;
+	float restart_time = (float(p_index) / float(p_state->count)) * lifetime;
+	float local_delta = p_state->delta;
+
+	if (randomness_ratio > 0.0) {
+		uint32_t seed = cycle;
+		if (restart_time >= time) {
+			seed -= uint32_t(1);
+		}
+		seed *= uint32_t(p_state->count);
+		seed += uint32_t(p_index);
+		float random = float(idhash(seed) % uint32_t(65536)) / 65536.0;
+		restart_time += randomness_ratio * random * 1.0 / float(p_state->count);
+	}
 
-			/*float tex_linear_velocity = 0;
-			if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
-				tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(0);
-			}*/
+	restart_time *= (1.0 - explosiveness_ratio);
+	bool restart = false;
 
-			float tex_angle = 0.0;
-			if (curve_parameters[PARAM_ANGLE].is_valid()) {
-				tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(0);
-			}
+	if (time > p_state->prev_time) {
+		// restart_time >= prev_time is used so particles emit in the first frame they are processed
 
-			float tex_anim_offset = 0.0;
-			if (curve_parameters[PARAM_ANGLE].is_valid()) {
-				tex_anim_offset = curve_parameters[PARAM_ANGLE]->interpolate(0);
+		if (restart_time >= p_state->prev_time && restart_time < time) {
+			restart = true;
+			if (fractional_delta) {
+				local_delta = (time - restart_time) * lifetime;
 			}
+		}
 
-			p.seed = Math::rand();
-
-			p.angle_rand = Math::randf();
-			p.scale_rand = Math::randf();
-			p.hue_rot_rand = Math::randf();
-			p.anim_offset_rand = Math::randf();
-
-			float angle1_rad = (Math::randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
-			Vector2 rot = Vector2(Math::cos(angle1_rad), Math::sin(angle1_rad));
-			p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(Math::randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
-
-			float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
-			p.rotation = Math::deg2rad(base_angle);
-
-			p.custom[0] = 0.0; // unused
-			p.custom[1] = 0.0; // phase [0..1]
-			p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]); //animation phase [0..1]
-			p.custom[3] = 0.0;
-			p.transform = Transform2D();
-			p.time = 0;
-			p.base_color = Color(1, 1, 1, 1);
-
-			switch (emission_shape) {
-				case EMISSION_SHAPE_POINT: {
-					//do none
-				} break;
-				case EMISSION_SHAPE_CIRCLE: {
-					p.transform[2] = Vector2(Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0).normalized() * emission_sphere_radius;
-				} break;
-				case EMISSION_SHAPE_RECTANGLE: {
-					p.transform[2] = Vector2(Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0) * emission_rect_extents;
-				} break;
-				case EMISSION_SHAPE_POINTS:
-				case EMISSION_SHAPE_DIRECTED_POINTS: {
-
-					int pc = emission_points.size();
-					if (pc == 0)
-						break;
-
-					int random_idx = Math::rand() % pc;
-
-					p.transform[2] = emission_points.get(random_idx);
-
-					if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && emission_normals.size() == pc) {
-						p.velocity = emission_normals.get(random_idx);
-					}
-
-					if (emission_colors.size() == pc) {
-						p.base_color = emission_colors.get(random_idx);
-					}
-				} break;
+	} else if (local_delta > 0.0) {
+		if (restart_time >= p_state->prev_time) {
+			restart = true;
+			if (fractional_delta) {
+				local_delta = (lifetime - restart_time + time) * lifetime;
 			}
 
-			if (!local_coords) {
-				p.velocity = velocity_xform.xform(p.velocity);
-				p.transform = emission_xform * p.transform;
+		} else if (restart_time < time) {
+			restart = true;
+			if (fractional_delta) {
+				local_delta = (time - restart_time) * lifetime;
 			}
+		}
+	}
 
-		} else if (!p.active) {
-			continue;
-		} else {
+	if (restart) {
 
-			uint32_t alt_seed = p.seed;
+		if (!emitting) {
+			p.active = false;
+			return;
+		}
+		p.active = true;
 
-			p.time += local_delta;
-			p.custom[1] = p.time / lifetime;
+		/*float tex_linear_velocity = 0;
+		if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
+			tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(0);
+		}*/
 
-			float tex_linear_velocity = 0.0;
-			if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
-				tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(p.custom[1]);
-			}
-			/*
-			float tex_orbit_velocity = 0.0;
+		float tex_angle = 0.0;
+		if (curve_parameters[PARAM_ANGLE].is_valid()) {
+			tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(0);
+		}
 
-			if (flags[FLAG_DISABLE_Z]) {
+		float tex_anim_offset = 0.0;
+		if (curve_parameters[PARAM_ANGLE].is_valid()) {
+			tex_anim_offset = curve_parameters[PARAM_ANGLE]->interpolate(0);
+		}
 
-				if (curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY].is_valid()) {
-					tex_orbit_velocity = curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY]->interpolate(p.custom[1]);
+		//seeded per particle and cycle rather than from the global generator, so results don't depend on which thread runs it
+		uint32_t rand_seed = idhash(random_seed + uint32_t(cycle) * uint32_t(p_state->count) + uint32_t(p_index));
+		p.seed = idhash(rand_seed);
+
+		p.angle_rand = rand_from_seed(rand_seed);
+		p.scale_rand = rand_from_seed(rand_seed);
+		p.hue_rot_rand = rand_from_seed(rand_seed);
+		p.anim_offset_rand = rand_from_seed(rand_seed);
+
+		float angle1_rad = (rand_from_seed(rand_seed) * 2.0 - 1.0) * Math_PI * spread / 180.0;
+		Vector2 rot = Vector2(Math::cos(angle1_rad), Math::sin(angle1_rad));
+		p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, rand_from_seed(rand_seed), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
+
+		float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
+		p.rotation = Math::deg2rad(base_angle);
+
+		p.custom[0] = 0.0; // unused
+		p.custom[1] = 0.0; // phase [0..1]
+		p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]); //animation phase [0..1]
+		p.custom[3] = 0.0;
+		p.transform = Transform2D();
+		p.time = 0;
+		p.base_color = Color(1, 1, 1, 1);
+
+		switch (emission_shape) {
+			case EMISSION_SHAPE_POINT: {
+				//do none
+			} break;
+			case EMISSION_SHAPE_CIRCLE: {
+				p.transform[2] = Vector2(rand_from_seed(rand_seed) * 2.0 - 1.0, rand_from_seed(rand_seed) * 2.0 - 1.0).normalized() * emission_sphere_radius;
+			} break;
+			case EMISSION_SHAPE_RECTANGLE: {
+				p.transform[2] = Vector2(rand_from_seed(rand_seed) * 2.0 - 1.0, rand_from_seed(rand_seed) * 2.0 - 1.0) * emission_rect_extents;
+			} break;
+			case EMISSION_SHAPE_POINTS:
+			case EMISSION_SHAPE_DIRECTED_POINTS: {
+
+				int pc = p_state->emission_point_count;
+				if (pc == 0)
+					break;
+
+				int random_idx = int(idhash(rand_seed) % uint32_t(pc));
+
+				p.transform[2] = p_state->emission_points[random_idx];
+
+				if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && p_state->emission_normals) {
+					p.velocity = p_state->emission_normals[random_idx];
 				}
-			}
-*/
-			float tex_angular_velocity = 0.0;
-			if (curve_parameters[PARAM_ANGULAR_VELOCITY].is_valid()) {
-				tex_angular_velocity = curve_parameters[PARAM_ANGULAR_VELOCITY]->interpolate(p.custom[1]);
-			}
 
-			float tex_linear_accel = 0.0;
-			if (curve_parameters[PARAM_LINEAR_ACCEL].is_valid()) {
-				tex_linear_accel = curve_parameters[PARAM_LINEAR_ACCEL]->interpolate(p.custom[1]);
-			}
+				if (p_state->emission_colors) {
+					p.base_color = p_state->emission_colors[random_idx];
+				}
+			} break;
+		}
 
-			float tex_tangential_accel = 0.0;
-			if (curve_parameters[PARAM_TANGENTIAL_ACCEL].is_valid()) {
-				tex_tangential_accel = curve_parameters[PARAM_TANGENTIAL_ACCEL]->interpolate(p.custom[1]);
-			}
+		if (!local_coords) {
+			p.velocity = p_state->velocity_xform.xform(p.velocity);
+			p.transform = p_state->emission_xform * p.transform;
+		}
 
-			float tex_radial_accel = 0.0;
-			if (curve_parameters[PARAM_RADIAL_ACCEL].is_valid()) {
-				tex_radial_accel = curve_parameters[PARAM_RADIAL_ACCEL]->interpolate(p.custom[1]);
-			}
+	} else if (!p.active) {
+		return;
+	} else {
 
-			float tex_damping = 0.0;
-			if (curve_parameters[PARAM_DAMPING].is_valid()) {
-				tex_damping = curve_parameters[PARAM_DAMPING]->interpolate(p.custom[1]);
-			}
+		uint32_t alt_seed = p.seed;
 
-			float tex_angle = 0.0;
-			if (curve_parameters[PARAM_ANGLE].is_valid()) {
-				tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(p.custom[1]);
-			}
-			float tex_anim_speed = 0.0;
-			if (curve_parameters[PARAM_ANIM_SPEED].is_valid()) {
-				tex_anim_speed = curve_parameters[PARAM_ANIM_SPEED]->interpolate(p.custom[1]);
-			}
+		p.time += local_delta;
+		p.custom[1] = p.time / lifetime;
 
-			float tex_anim_offset = 0.0;
-			if (curve_parameters[PARAM_ANIM_OFFSET].is_valid()) {
-				tex_anim_offset = curve_parameters[PARAM_ANIM_OFFSET]->interpolate(p.custom[1]);
-			}
+		float tex_linear_velocity = 0.0;
+		if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
+			tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(p.custom[1]);
+		}
+		/*
+		float tex_orbit_velocity = 0.0;
 
-			Vector2 force = gravity;
-			Vector2 pos = p.transform[2];
-
-			//apply linear acceleration
-			force += p.velocity.length() > 0.0 ? p.velocity.normalized() * (parameters[PARAM_LINEAR_ACCEL] + tex_linear_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_LINEAR_ACCEL]) : Vector2();
-			//apply radial acceleration
-			Vector2 org = emission_xform[2];
-			Vector2 diff = pos - org;
-			force += diff.length() > 0.0 ? diff.normalized() * (parameters[PARAM_RADIAL_ACCEL] + tex_radial_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_RADIAL_ACCEL]) : Vector2();
-			//apply tangential acceleration;
-			Vector2 yx = Vector2(diff.y, diff.x);
-			force += yx.length() > 0.0 ? (yx * Vector2(-1.0, 1.0)) * ((parameters[PARAM_TANGENTIAL_ACCEL] + tex_tangential_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_TANGENTIAL_ACCEL])) : Vector2();
-			//apply attractor forces
-			p.velocity += force * local_delta;
-			//orbit velocity
-#if 0
-			if (flags[FLAG_DISABLE_Z]) {
-
-				float orbit_amount = (orbit_velocity + tex_orbit_velocity) * mix(1.0, rand_from_seed(alt_seed), orbit_velocity_random);
-				if (orbit_amount != 0.0) {
-					float ang = orbit_amount * DELTA * pi * 2.0;
-					mat2 rot = mat2(vec2(cos(ang), -sin(ang)), vec2(sin(ang), cos(ang)));
-					TRANSFORM[3].xy -= diff.xy;
-					TRANSFORM[3].xy += rot * diff.xy;
-				}
-			}
-#endif
-			if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
-				p.velocity = p.velocity.normalized() * tex_linear_velocity;
+		if (flags[FLAG_DISABLE_Z]) {
+
+			if (curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY].is_valid()) {
+				tex_orbit_velocity = curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY]->interpolate(p.custom[1]);
 			}
+		}
+*/
+		float tex_angular_velocity = 0.0;
+		if (curve_parameters[PARAM_ANGULAR_VELOCITY].is_valid()) {
+			tex_angular_velocity = curve_parameters[PARAM_ANGULAR_VELOCITY]->interpolate(p.custom[1]);
+		}
 
-			if (parameters[PARAM_DAMPING] + tex_damping > 0.0) {
+		float tex_linear_accel = 0.0;
+		if (curve_parameters[PARAM_LINEAR_ACCEL].is_valid()) {
+			tex_linear_accel = curve_parameters[PARAM_LINEAR_ACCEL]->interpolate(p.custom[1]);
+		}
 
-				float v = p.velocity.length();
-				float damp = (parameters[PARAM_DAMPING] + tex_damping) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_DAMPING]);
-				v -= damp * local_delta;
-				if (v < 0.0) {
-					p.velocity = Vector2();
-				} else {
-					p.velocity = p.velocity.normalized() * v;
-				}
-			}
-			float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
-			base_angle += p.custom[1] * lifetime * (parameters[PARAM_ANGULAR_VELOCITY] + tex_angular_velocity) * Math::lerp(1.0f, rand_from_seed(alt_seed) * 2.0f - 1.0f, randomness[PARAM_ANGULAR_VELOCITY]);
-			p.rotation = Math::deg2rad(base_angle); //angle
-			float animation_phase = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]) + p.custom[1] * (parameters[PARAM_ANIM_SPEED] + tex_anim_speed) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_ANIM_SPEED]);
-			p.custom[2] = animation_phase;
+		float tex_tangential_accel = 0.0;
+		if (curve_parameters[PARAM_TANGENTIAL_ACCEL].is_valid()) {
+			tex_tangential_accel = curve_parameters[PARAM_TANGENTIAL_ACCEL]->interpolate(p.custom[1]);
 		}
-		//apply color
-		//apply hue rotation
 
-		float tex_scale = 1.0;
-		if (curve_parameters[PARAM_SCALE].is_valid()) {
-			tex_scale = curve_parameters[PARAM_SCALE]->interpolate(p.custom[1]);
+		float tex_radial_accel = 0.0;
+		if (curve_parameters[PARAM_RADIAL_ACCEL].is_valid()) {
+			tex_radial_accel = curve_parameters[PARAM_RADIAL_ACCEL]->interpolate(p.custom[1]);
 		}
 
-		float tex_hue_variation = 0.0;
-		if (curve_parameters[PARAM_HUE_VARIATION].is_valid()) {
-			tex_hue_variation = curve_parameters[PARAM_HUE_VARIATION]->interpolate(p.custom[1]);
+		float tex_damping = 0.0;
+		if (curve_parameters[PARAM_DAMPING].is_valid()) {
+			tex_damping = curve_parameters[PARAM_DAMPING]->interpolate(p.custom[1]);
 		}
 
-		float hue_rot_angle = (parameters[PARAM_HUE_VARIATION] + tex_hue_variation) * Math_PI * 2.0 * Math::lerp(1.0f, p.hue_rot_rand * 2.0f - 1.0f, randomness[PARAM_HUE_VARIATION]);
-		float hue_rot_c = Math::cos(hue_rot_angle);
-		float hue_rot_s = Math::sin(hue_rot_angle);
+		float tex_angle = 0.0;
+		if (curve_parameters[PARAM_ANGLE].is_valid()) {
+			tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(p.custom[1]);
+		}
+		float tex_anim_speed = 0.0;
+		if (curve_parameters[PARAM_ANIM_SPEED].is_valid()) {
+			tex_anim_speed = curve_parameters[PARAM_ANIM_SPEED]->interpolate(p.custom[1]);
+		}
 
-		Basis hue_rot_mat;
-		{
-			Basis mat1(0.299, 0.587, 0.114, 0.299, 0.587, 0.114, 0.299, 0.587, 0.114);
-			Basis mat2(0.701, -0.587, -0.114, -0.299, 0.413, -0.114, -0.300, -0.588, 0.886);
-			Basis mat3(0.168, 0.330, -0.497, -0.328, 0.035, 0.292, 1.250, -1.050, -0.203);
+		float tex_anim_offset = 0.0;
+		if (curve_parameters[PARAM_ANIM_OFFSET].is_valid()) {
+			tex_anim_offset = curve_parameters[PARAM_ANIM_OFFSET]->interpolate(p.custom[1]);
+		}
 
-			for (int j = 0; j < 3; j++) {
-				hue_rot_mat[j] = mat1[j] + mat2[j] * hue_rot_c + mat3[j] * hue_rot_s;
+		Vector2 force = gravity;
+		Vector2 pos = p.transform[2];
+
+		//apply linear acceleration
+		force += p.velocity.length() > 0.0 ? p.velocity.normalized() * (parameters[PARAM_LINEAR_ACCEL] + tex_linear_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_LINEAR_ACCEL]) : Vector2();
+		//apply radial acceleration
+		Vector2 org = p_state->emission_xform[2];
+		Vector2 diff = pos - org;
+		force += diff.length() > 0.0 ? diff.normalized() * (parameters[PARAM_RADIAL_ACCEL] + tex_radial_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_RADIAL_ACCEL]) : Vector2();
+		//apply tangential acceleration;
+		Vector2 yx = Vector2(diff.y, diff.x);
+		force += yx.length() > 0.0 ? (yx * Vector2(-1.0, 1.0)) * ((parameters[PARAM_TANGENTIAL_ACCEL] + tex_tangential_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_TANGENTIAL_ACCEL])) : Vector2();
+		//apply attractor forces
+		p.velocity += force * local_delta;
+		//orbit velocity
+#if 0
+		if (flags[FLAG_DISABLE_Z]) {
+
+			float orbit_amount = (orbit_velocity + tex_orbit_velocity) * mix(1.0, rand_from_seed(alt_seed), orbit_velocity_random);
+			if (orbit_amount != 0.0) {
+				float ang = orbit_amount * DELTA * pi * 2.0;
+				mat2 rot = mat2(vec2(cos(ang), -sin(ang)), vec2(sin(ang), cos(ang)));
+				TRANSFORM[3].xy -= diff.xy;
+				TRANSFORM[3].xy += rot * diff.xy;
 			}
 		}
+#endif
+		if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
+			p.velocity = p.velocity.normalized() * tex_linear_velocity;
+		}
 
-		if (color_ramp.is_valid()) {
-			p.color = color_ramp->get_color_at_offset(p.custom[1]) * color;
-		} else {
-			p.color = color;
+		if (parameters[PARAM_DAMPING] + tex_damping > 0.0) {
+
+			float v = p.velocity.length();
+			float damp = (parameters[PARAM_DAMPING] + tex_damping) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_DAMPING]);
+			v -= damp * local_delta;
+			if (v < 0.0) {
+				p.velocity = Vector2();
+			} else {
+				p.velocity = p.velocity.normalized() * v;
+			}
 		}
+		float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
+		base_angle += p.custom[1] * lifetime * (parameters[PARAM_ANGULAR_VELOCITY] + tex_angular_velocity) * Math::lerp(1.0f, rand_from_seed(alt_seed) * 2.0f - 1.0f, randomness[PARAM_ANGULAR_VELOCITY]);
+		p.rotation = Math::deg2rad(base_angle); //angle
+		float animation_phase = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]) + p.custom[1] * (parameters[PARAM_ANIM_SPEED] + tex_anim_speed) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_ANIM_SPEED]);
+		p.custom[2] = animation_phase;
+	}
+	//apply color
+	//apply hue rotation
 
-		Vector3 color_rgb = hue_rot_mat.xform_inv(Vector3(p.color.r, p.color.g, p.color.b));
-		p.color.r = color_rgb.x;
-		p.color.g = color_rgb.y;
-		p.color.b = color_rgb.z;
+	float tex_scale = 1.0;
+	if (curve_parameters[PARAM_SCALE].is_valid()) {
+		tex_scale = curve_parameters[PARAM_SCALE]->interpolate(p.custom[1]);
+	}
 
-		p.color *= p.base_color;
+	float tex_hue_variation = 0.0;
+	if (curve_parameters[PARAM_HUE_VARIATION].is_valid()) {
+		tex_hue_variation = curve_parameters[PARAM_HUE_VARIATION]->interpolate(p.custom[1]);
+	}
 
-		if (flags[FLAG_ALIGN_Y_TO_VELOCITY]) {
-			if (p.velocity.length() > 0.0) {
+	float hue_rot_angle = (parameters[PARAM_HUE_VARIATION] + tex_hue_variation) * Math_PI * 2.0 * Math::lerp(1.0f, p.hue_rot_rand * 2.0f - 1.0f, randomness[PARAM_HUE_VARIATION]);
+	float hue_rot_c = Math::cos(hue_rot_angle);
+	float hue_rot_s = Math::sin(hue_rot_angle);
 
-				p.transform.elements[1] = p.velocity.normalized();
-				p.transform.elements[0] = p.transform.elements[1].tangent();
-			}
+	Basis hue_rot_mat;
+	{
+		Basis mat1(0.299, 0.587, 0.114, 0.299, 0.587, 0.114, 0.299, 0.587, 0.114);
+		Basis mat2(0.701, -0.587, -0.114, -0.299, 0.413, -0.114, -0.300, -0.588, 0.886);
+		Basis mat3(0.168, 0.330, -0.497, -0.328, 0.035, 0.292, 1.250, -1.050, -0.203);
 
-		} else {
-			p.transform.elements[0] = Vector2(Math::cos(p.rotation), -Math::sin(p.rotation));
-			p.transform.elements[1] = Vector2(Math::sin(p.rotation), Math::cos(p.rotation));
+		for (int j = 0; j < 3; j++) {
+			hue_rot_mat[j] = mat1[j] + mat2[j] * hue_rot_c + mat3[j] * hue_rot_s;
 		}
+	}
 
-		//scale by scale
-		float base_scale = Math::lerp(parameters[PARAM_SCALE] * tex_scale, 1.0f, p.scale_rand * randomness[PARAM_SCALE]);
-		if (base_scale == 0.0) base_scale = 0.000001;
+	if (color_ramp.is_valid()) {
+		p.color = color_ramp->get_color_at_offset(p.custom[1]) * color;
+	} else {
+		p.color = color;
+	}
+
+	Vector3 color_rgb = hue_rot_mat.xform_inv(Vector3(p.color.r, p.color.g, p.color.b));
+	p.color.r = color_rgb.x;
+	p.color.g = color_rgb.y;
+	p.color.b = color_rgb.z;
+
+	p.color *= p.base_color;
 
-		p.transform.elements[0] *= base_scale;
-		p.transform.elements[1] *= base_scale;
+	if (flags[FLAG_ALIGN_Y_TO_VELOCITY]) {
+		if (p.velocity.length() > 0.0) {
 
-		p.transform[2] += p.velocity * local_delta;
+			p.transform.elements[1] = p.velocity.normalized();
+			p.transform.elements[0] = p.transform.elements[1].tangent();
+		}
+
+	} else {
+		p.transform.elements[0] = Vector2(Math::cos(p.rotation), -Math::sin(p.rotation));
+		p.transform.elements[1] = Vector2(Math::sin(p.rotation), Math::cos(p.rotation));
 	}
+
+	//scale by scale
+	float base_scale = Math::lerp(parameters[PARAM_SCALE] * tex_scale, 1.0f, p.scale_rand * randomness[PARAM_SCALE]);
+	if (base_scale == 0.0) base_scale = 0.000001;
+
+	p.transform.elements[0] *= base_scale;
+	p.transform.elements[1] *= base_scale;
+
+	p.transform[2] += p.velocity * local_delta;
 }
 
 void CPUParticles2D::_update_particle_data_buffer() {
@@ -895,50 +946,75 @@ void CPUParticles2D::_update_particle_data_buffer() {
 			}
 		}
 
-		for (int i = 0; i < pc; i++) {
+		PackState state;
+		state.particles = r.ptr();
+		state.order = order;
+		state.data = ptr;
+		state.count = pc;
+		state.un_transform = un_transform;
 
-			int idx = order ? order[i] : i;
+		uint32_t chunks = (pc + PROCESS_CHUNK_SIZE - 1) / PROCESS_CHUNK_SIZE;
+		ThreadWorkPool *pool = _get_work_pool(chunks);
 
-			Transform2D t = r[idx].transform;
-
-			if (!local_coords) {
-				t = un_transform * t;
+		if (pool) {
+			pool->do_work(chunks, this, &CPUParticles2D::_pack_particles_chunk, (const PackState *)&state);
+		} else {
+			for (uint32_t i = 0; i < chunks; i++) {
+				_pack_particles_chunk(i, &state);
 			}
+		}
+	}
 
-			if (r[idx].active) {
+#ifndef NO_THREADS
+	update_mutex->unlock();
+#endif
+}
 
-				ptr[0] = t.elements[0][0];
-				ptr[1] = t.elements[1][0];
-				ptr[2] = 0;
-				ptr[3] = t.elements[2][0];
-				ptr[4] = t.elements[0][1];
-				ptr[5] = t.elements[1][1];
-				ptr[6] = 0;
-				ptr[7] = t.elements[2][1];
+void CPUParticles2D::_pack_particles_chunk(uint32_t p_chunk, const PackState *p_state) {
 
-			} else {
-				zeromem(ptr, sizeof(float) * 8);
-			}
+	int from = p_chunk * PROCESS_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_CHUNK_SIZE, p_state->count);
+	float *ptr = p_state->data + from * 13;
 
-			Color c = r[idx].color;
-			uint8_t *data8 = (uint8_t *)&ptr[8];
-			data8[0] = CLAMP(c.r * 255.0, 0, 255);
-			data8[1] = CLAMP(c.g * 255.0, 0, 255);
-			data8[2] = CLAMP(c.b * 255.0, 0, 255);
-			data8[3] = CLAMP(c.a * 255.0, 0, 255);
+	for (int i = from; i < to; i++) {
 
-			ptr[9] = r[idx].custom[0];
-			ptr[10] = r[idx].custom[1];
-			ptr[11] = r[idx].custom[2];
-			ptr[12] = r[idx].custom[3];
+		int idx = p_state->order ? p_state->order[i] : i;
 
-			ptr += 13;
+		Transform2D t = p_state->particles[idx].transform;
+
+		if (!local_coords) {
+			t = p_state->un_transform * t;
 		}
-	}
 
-#ifndef NO_THREADS
-	update_mutex->unlock();
-#endif
+		if (p_state->particles[idx].active) {
+
+			ptr[0] = t.elements[0][0];
+			ptr[1] = t.elements[1][0];
+			ptr[2] = 0;
+			ptr[3] = t.elements[2][0];
+			ptr[4] = t.elements[0][1];
+			ptr[5] = t.elements[1][1];
+			ptr[6] = 0;
+			ptr[7] = t.elements[2][1];
+
+		} else {
+			zeromem(ptr, sizeof(float) * 8);
+		}
+
+		Color c = p_state->particles[idx].color;
+		uint8_t *data8 = (uint8_t *)&ptr[8];
+		data8[0] = CLAMP(c.r * 255.0, 0, 255);
+		data8[1] = CLAMP(c.g * 255.0, 0, 255);
+		data8[2] = CLAMP(c.b * 255.0, 0, 255);
+		data8[3] = CLAMP(c.a * 255.0, 0, 255);
+
+		ptr[9] = p_state->particles[idx].custom[0];
+		ptr[10] = p_state->particles[idx].custom[1];
+		ptr[11] = p_state->particles[idx].custom[2];
+		ptr[12] = p_state->particles[idx].custom[3];
+
+		ptr += 13;
+	}
 }
 
 void CPUParticles2D::_update_render_thread() {
@@ -1354,6 +1430,7 @@ CPUParticles2D::CPUParticles2D() {
 	inactive_time = 0;
 	frame_remainder = 0;
 	cycle = 0;
+	random_seed = Math::rand();
 
 	mesh = VisualServer::get_singleton()->mesh_create();
 	multimesh = VisualServer::get_singleton()->multimesh_create();
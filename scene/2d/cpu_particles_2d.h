@@ -31,6 +31,7 @@
 #ifndef CPU_PARTICLES_2D_H
 #define CPU_PARTICLES_2D_H
 
+#include "core/os/thread_work_pool.h"
 #include "core/rid.h"
 #include "scene/2d/node_2d.h"
 #include "scene/resources/texture.h"
@@ -170,8 +171,42 @@ private:
 
 	Vector2 gravity;
 
+	//particles are processed in chunks, on the scene tree work pool when there is more than one
+
+	enum {
+		PROCESS_CHUNK_SIZE = 512
+	};
+
+	struct ProcessState {
+		Particle *particles;
+		int count;
+		float delta;
+		float prev_time;
+		Transform2D emission_xform;
+		Transform2D velocity_xform;
+		int emission_point_count;
+		const Vector2 *emission_points;
+		const Vector2 *emission_normals;
+		const Color *emission_colors;
+	};
+
+	struct PackState {
+		const Particle *particles;
+		const int *order;
+		float *data;
+		int count;
+		Transform2D un_transform;
+	};
+
+	uint32_t random_seed;
+
+	ThreadWorkPool *_get_work_pool(uint32_t p_chunks);
+
 	void _particles_process(float p_delta);
+	void _particles_process_chunk(uint32_t p_chunk, const ProcessState *p_state);
+	void _particle_process(int p_index, const ProcessState *p_state);
 	void _update_particle_data_buffer();
+	void _pack_particles_chunk(uint32_t p_chunk, const PackState *p_state);
 
 	Mutex *update_mutex;
 
@@ -310,15 +310,17 @@ void TileMap::update_dirty_quadrants() {
 
 		for (int i = 0; i < q.cells.size(); i++) {
 
-			Map<PosKey, Cell>::Element *E = tile_map.find(q.cells[i]);
-			Cell &c = E->get();
+			const PosKey &pk = q.cells[i];
+			Cell *cell = _get_cell(pk.x, pk.y);
+			ERR_CONTINUE(!cell);
+			Cell &c = *cell;
 			//moment of truth
 			if (!tile_set->has_tile(c.id))
 				continue;
 			Ref<Texture> tex = tile_set->tile_get_texture(c.id);
 			Vector2 tile_ofs = tile_set->tile_get_texture_offset(c.id);
 
-			Vector2 wofs = _map_to_world(E->key().x, E->key().y);
+			Vector2 wofs = _map_to_world(pk.x, pk.y);
 			Vector2 offset = wofs - q.pos + tofs;
 
 			if (!tex.is_valid())
@@ -486,7 +488,7 @@ void TileMap::update_dirty_quadrants() {
 								Ref<ConvexPolygonShape2D> convex = _shapes[k];
 								if (convex.is_valid()) {
 									ps->body_add_shape(q.body, convex->get_rid(), xform);
-									ps->body_set_shape_metadata(q.body, shape_idx, Vector2(E->key().x, E->key().y));
+									ps->body_set_shape_metadata(q.body, shape_idx, Vector2(pk.x, pk.y));
 									ps->body_set_shape_as_one_way_collision(q.body, shape_idx, shapes[j].one_way_collision, shapes[j].one_way_collision_margin);
 									shape_idx++;
 #ifdef DEBUG_ENABLED
@@ -497,7 +499,7 @@ void TileMap::update_dirty_quadrants() {
 							}
 						} else {
 							ps->body_add_shape(q.body, shape->get_rid(), xform);
-							ps->body_set_shape_metadata(q.body, shape_idx, Vector2(E->key().x, E->key().y));
+							ps->body_set_shape_metadata(q.body, shape_idx, Vector2(pk.x, pk.y));
 							ps->body_set_shape_as_one_way_collision(q.body, shape_idx, shapes[j].one_way_collision, shapes[j].one_way_collision_margin);
 							shape_idx++;
 						}
@@ -530,7 +532,7 @@ void TileMap::update_dirty_quadrants() {
 					Quadrant::NavPoly np;
 					np.id = pid;
 					np.xform = xform;
-					q.navpoly_ids[E->key()] = np;
+					q.navpoly_ids[pk] = np;
 
 					if (debug_navigation) {
 						RID debug_navigation_item = vs->canvas_item_create();
@@ -603,7 +605,7 @@ void TileMap::update_dirty_quadrants() {
 				Quadrant::Occluder oc;
 				oc.xform = xform;
 				oc.id = orid;
-				q.occluder_instances[E->key()] = oc;
+				q.occluder_instances[pk] = oc;
 			}
 		}
 
@@ -754,32 +756,71 @@ void TileMap::_set_celld(const Vector2 &p_pos, const Dictionary &p_data) {
 
 void TileMap::set_cell(int p_x, int p_y, int p_tile, bool p_flip_x, bool p_flip_y, bool p_transpose, Vector2 p_autotile_coord) {
 
+	Cell c;
+	c.id = p_tile;
+	c.flip_h = p_flip_x;
+	c.flip_v = p_flip_y;
+	c.transpose = p_transpose;
+	c.autotile_coord_x = (uint16_t)p_autotile_coord.x;
+	c.autotile_coord_y = (uint16_t)p_autotile_coord.y;
+
+	Map<PosKey, Quadrant>::Element *Q = NULL;
+	_set_cell(p_x, p_y, c, &Q);
+}
+
+void TileMap::_set_cell(int p_x, int p_y, const Cell &p_cell, Map<PosKey, Quadrant>::Element **r_quadrant) {
+
 	PosKey pk(p_x, p_y);
+	PosKey ck = _get_chunk_key(pk.x, pk.y);
+
+	CellChunk **chunk = cell_chunks.getptr(ck);
+	Cell *E = chunk ? &(*chunk)->cells[_get_chunk_index(pk.x, pk.y)] : NULL;
+	bool exists = E && E->id != INVALID_CELL;
 
-	Map<PosKey, Cell>::Element *E = tile_map.find(pk);
-	if (!E && p_tile == INVALID_CELL)
+	if (!exists && p_cell.id == INVALID_CELL)
 		return; //nothing to do
 
-	PosKey qk(p_x / _get_quadrant_size(), p_y / _get_quadrant_size());
-	if (p_tile == INVALID_CELL) {
+	//the caller passes the last quadrant it used, bulk edits mostly stay in the same one
+	PosKey qk(pk.x / _get_quadrant_size(), pk.y / _get_quadrant_size());
+	Map<PosKey, Quadrant>::Element *Q = *r_quadrant;
+	if (!Q || !(Q->key() == qk)) {
+		Q = quadrant_map.find(qk);
+	}
+
+	if (p_cell.id == INVALID_CELL) {
 		//erase existing
-		tile_map.erase(pk);
-		Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+		E->id = INVALID_CELL;
+		cell_count--;
+		(*chunk)->used--;
+		if ((*chunk)->used == 0) {
+			memdelete(*chunk);
+			cell_chunks.erase(ck);
+		}
+		used_size_cache_dirty = true;
+
+		*r_quadrant = NULL;
 		ERR_FAIL_COND(!Q);
 		Quadrant &q = Q->get();
 		q.cells.erase(pk);
-		if (q.cells.size() == 0)
+		if (q.cells.size() == 0) {
 			_erase_quadrant(Q);
-		else
+		} else {
 			_make_quadrant_dirty(Q);
+			*r_quadrant = Q;
+		}
 
 		return;
 	}
 
-	Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+	if (!exists) {
+		if (!chunk) {
+			cell_chunks[ck] = memnew(CellChunk);
+			chunk = cell_chunks.getptr(ck);
+			E = &(*chunk)->cells[_get_chunk_index(pk.x, pk.y)];
+		}
+		(*chunk)->used++;
+		cell_count++;
 
-	if (!E) {
-		E = tile_map.insert(pk, Cell());
 		if (!Q) {
 			Q = _create_quadrant(qk);
 		}
@@ -788,12 +829,22 @@ void TileMap::set_cell(int p_x, int p_y, int p_tile, bool p_flip_x, bool p_flip_
 	} else {
 		ERR_FAIL_COND(!Q); // quadrant should exist...
 
-		if (E->get().id == p_tile && E->get().flip_h == p_flip_x && E->get().flip_v == p_flip_y && E->get().transpose == p_transpose && E->get().autotile_coord_x == (uint16_t)p_autotile_coord.x && E->get().autotile_coord_y == (uint16_t)p_autotile_coord.y)
+		if (E->id == p_cell.id && E->flip_h == p_cell.flip_h && E->flip_v == p_cell.flip_v && E->transpose == p_cell.transpose && E->autotile_coord_x == p_cell.autotile_coord_x && E->autotile_coord_y == p_cell.autotile_coord_y) {
+			*r_quadrant = Q;
 			return; //nothing changed
+		}
 	}
 
-	Cell &c = E->get();
+	*E = p_cell;
+
+	_make_quadrant_dirty(Q);
+	used_size_cache_dirty = true;
+	*r_quadrant = Q;
+}
+
+void TileMap::set_cells_rect(const Rect2 &p_rect, int p_tile, bool p_flip_x, bool p_flip_y, bool p_transpose, Vector2 p_autotile_coord) {
 
+	Cell c;
 	c.id = p_tile;
 	c.flip_h = p_flip_x;
 	c.flip_v = p_flip_y;
@@ -801,8 +852,54 @@ void TileMap::set_cell(int p_x, int p_y, int p_tile, bool p_flip_x, bool p_flip_
 	c.autotile_coord_x = (uint16_t)p_autotile_coord.x;
 	c.autotile_coord_y = (uint16_t)p_autotile_coord.y;
 
-	_make_quadrant_dirty(Q);
-	used_size_cache_dirty = true;
+	int from_x = p_rect.position.x;
+	int from_y = p_rect.position.y;
+	int to_x = from_x + int(p_rect.size.x);
+	int to_y = from_y + int(p_rect.size.y);
+
+	Map<PosKey, Quadrant>::Element *Q = NULL;
+	for (int y = from_y; y < to_y; y++) {
+		for (int x = from_x; x < to_x; x++) {
+			_set_cell(x, y, c, &Q);
+		}
+	}
+}
+
+void TileMap::set_cells_from_image(const Ref<Image> &p_image, const Vector2 &p_position, const PoolVector<int> &p_tiles) {
+
+	ERR_FAIL_COND(p_image.is_null() || p_image->empty());
+
+	Ref<Image> image = p_image;
+	if (image->is_compressed() || image->get_format() != Image::FORMAT_R8) {
+		image = p_image->duplicate();
+		if (image->is_compressed()) {
+			ERR_FAIL_COND(image->decompress() != OK);
+		}
+		image->convert(Image::FORMAT_R8);
+	}
+
+	int width = image->get_width();
+	int height = image->get_height();
+	int ofs_x = p_position.x;
+	int ofs_y = p_position.y;
+
+	PoolVector<uint8_t> data = image->get_data();
+	PoolVector<uint8_t>::Read r = data.read();
+	PoolVector<int>::Read tiles = p_tiles.read();
+	int tile_count = p_tiles.size();
+
+	Map<PosKey, Quadrant>::Element *Q = NULL;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+
+			//the red channel indexes the tile list, values past its end erase the cell
+			int value = r[y * width + x];
+
+			Cell c;
+			c.id = value < tile_count ? tiles[value] : int(INVALID_CELL);
+			_set_cell(ofs_x + x, ofs_y + y, c, &Q);
+		}
+	}
 }
 
 int TileMap::get_cellv(const Vector2 &p_pos) const {
@@ -853,10 +950,9 @@ void TileMap::update_bitmask_region(const Vector2 &p_start, const Vector2 &p_end
 
 void TileMap::update_cell_bitmask(int p_x, int p_y) {
 
-	PosKey p(p_x, p_y);
-	Map<PosKey, Cell>::Element *E = tile_map.find(p);
+	Cell *E = _get_cell(p_x, p_y);
 	if (E != NULL) {
-		int id = get_cell(p_x, p_y);
+		int id = E->id;
 		if (tile_set->tile_get_tile_mode(id) == TileSet::AUTO_TILE) {
 			uint16_t mask = 0;
 			if (tile_set->autotile_get_bitmask_mode(id) == TileSet::BITMASK_2X2) {
@@ -915,16 +1011,16 @@ void TileMap::update_cell_bitmask(int p_x, int p_y) {
 				}
 			}
 			Vector2 coord = tile_set->autotile_get_subtile_for_bitmask(id, mask, this, Vector2(p_x, p_y));
-			E->get().autotile_coord_x = (int)coord.x;
-			E->get().autotile_coord_y = (int)coord.y;
+			E->autotile_coord_x = (int)coord.x;
+			E->autotile_coord_y = (int)coord.y;
 
 			PosKey qk(p_x / _get_quadrant_size(), p_y / _get_quadrant_size());
 			Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
 			_make_quadrant_dirty(Q);
 
 		} else if (tile_set->tile_get_tile_mode(id) == TileSet::SINGLE_TILE) {
-			E->get().autotile_coord_x = 0;
-			E->get().autotile_coord_y = 0;
+			E->autotile_coord_x = 0;
+			E->autotile_coord_y = 0;
 		}
 	}
 }
@@ -939,72 +1035,63 @@ void TileMap::update_dirty_bitmask() {
 
 void TileMap::fix_invalid_tiles() {
 
-	for (Map<PosKey, Cell>::Element *E = tile_map.front(); E; E = E->next()) {
+	Vector<PosKey> cells;
+	_get_used_cells(&cells);
 
-		if (!tile_set->has_tile(get_cell(E->key().x, E->key().y))) {
-			set_cell(E->key().x, E->key().y, INVALID_CELL);
+	for (int i = 0; i < cells.size(); i++) {
+
+		if (!tile_set->has_tile(get_cell(cells[i].x, cells[i].y))) {
+			set_cell(cells[i].x, cells[i].y, INVALID_CELL);
 		}
 	}
 }
 
 int TileMap::get_cell(int p_x, int p_y) const {
 
-	PosKey pk(p_x, p_y);
-
-	const Map<PosKey, Cell>::Element *E = tile_map.find(pk);
+	const Cell *E = _get_cell(p_x, p_y);
 
 	if (!E)
 		return INVALID_CELL;
 
-	return E->get().id;
+	return E->id;
 }
 bool TileMap::is_cell_x_flipped(int p_x, int p_y) const {
 
-	PosKey pk(p_x, p_y);
-
-	const Map<PosKey, Cell>::Element *E = tile_map.find(pk);
+	const Cell *E = _get_cell(p_x, p_y);
 
 	if (!E)
 		return false;
 
-	return E->get().flip_h;
+	return E->flip_h;
 }
 bool TileMap::is_cell_y_flipped(int p_x, int p_y) const {
 
-	PosKey pk(p_x, p_y);
-
-	const Map<PosKey, Cell>::Element *E = tile_map.find(pk);
+	const Cell *E = _get_cell(p_x, p_y);
 
 	if (!E)
 		return false;
 
-	return E->get().flip_v;
+	return E->flip_v;
 }
 bool TileMap::is_cell_transposed(int p_x, int p_y) const {
 
-	PosKey pk(p_x, p_y);
-
-	const Map<PosKey, Cell>::Element *E = tile_map.find(pk);
+	const Cell *E = _get_cell(p_x, p_y);
 
 	if (!E)
 		return false;
 
-	return E->get().transpose;
+	return E->transpose;
 }
 
 void TileMap::set_cell_autotile_coord(int p_x, int p_y, const Vector2 &p_coord) {
 
-	PosKey pk(p_x, p_y);
-
-	const Map<PosKey, Cell>::Element *E = tile_map.find(pk);
+	Cell *E = _get_cell(p_x, p_y);
 
 	if (!E)
 		return;
 
-	Cell c = E->get();
-	c.autotile_coord_x = p_coord.x;
-	c.autotile_coord_y = p_coord.y;
-	tile_map[pk] = c;
+	E->autotile_coord_x = p_coord.x;
+	E->autotile_coord_y = p_coord.y;
 
 	PosKey qk(p_x / _get_quadrant_size(), p_y / _get_quadrant_size());
 	Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
@@ -1017,31 +1104,80 @@ void TileMap::set_cell_autotile_coord(int p_x, int p_y, const Vector2 &p_coord)
 
 Vector2 TileMap::get_cell_autotile_coord(int p_x, int p_y) const {
 
-	PosKey pk(p_x, p_y);
-
-	const Map<PosKey, Cell>::Element *E = tile_map.find(pk);
+	const Cell *E = _get_cell(p_x, p_y);
 
 	if (!E)
 		return Vector2();
 
-	return Vector2(E->get().autotile_coord_x, E->get().autotile_coord_y);
+	return Vector2(E->autotile_coord_x, E->autotile_coord_y);
+}
+
+void TileMap::_get_used_cells(Vector<PosKey> *r_cells) const {
+
+	//same order a sorted map would give (by y, then x), so saved data and used cell lists stay stable
+
+	Vector<PosKey> chunk_keys;
+	chunk_keys.resize(cell_chunks.size());
+
+	int idx = 0;
+	const PosKey *K = NULL;
+	while ((K = cell_chunks.next(K))) {
+		chunk_keys.write[idx++] = *K;
+	}
+	chunk_keys.sort();
+
+	r_cells->resize(cell_count);
+	PosKey *w = r_cells->ptrw();
+	int count = 0;
+
+	int row_begin = 0;
+	while (row_begin < chunk_keys.size()) {
+
+		int row_end = row_begin + 1;
+		while (row_end < chunk_keys.size() && chunk_keys[row_end].y == chunk_keys[row_begin].y) {
+			row_end++;
+		}
+
+		for (int y = 0; y < CELL_CHUNK_SIZE; y++) {
+			for (int i = row_begin; i < row_end; i++) {
+
+				const PosKey &ck = chunk_keys[i];
+				const Cell *cells = &cell_chunks[ck]->cells[y << CELL_CHUNK_SHIFT];
+
+				for (int x = 0; x < CELL_CHUNK_SIZE; x++) {
+					if (cells[x].id != INVALID_CELL) {
+						ERR_FAIL_COND(count >= cell_count);
+						w[count++] = PosKey((ck.x << CELL_CHUNK_SHIFT) + x, (ck.y << CELL_CHUNK_SHIFT) + y);
+					}
+				}
+			}
+		}
+
+		row_begin = row_end;
+	}
 }
 
 void TileMap::_recreate_quadrants() {
 
 	_clear_quadrants();
 
-	for (Map<PosKey, Cell>::Element *E = tile_map.front(); E; E = E->next()) {
+	Vector<PosKey> cells;
+	_get_used_cells(&cells);
 
-		PosKey qk(E->key().x / _get_quadrant_size(), E->key().y / _get_quadrant_size());
+	Map<PosKey, Quadrant>::Element *Q = NULL;
+	for (int i = 0; i < cells.size(); i++) {
 
-		Map<PosKey, Quadrant>::Element *Q = quadrant_map.find(qk);
+		PosKey qk(cells[i].x / _get_quadrant_size(), cells[i].y / _get_quadrant_size());
+
+		if (!Q || !(Q->key() == qk)) {
+			Q = quadrant_map.find(qk);
+		}
 		if (!Q) {
 			Q = _create_quadrant(qk);
 			dirty_quadrant_list.add(&Q->get().dirty_list);
 		}
 
-		Q->get().cells.insert(E->key());
+		Q->get().cells.insert(cells[i]);
 		_make_quadrant_dirty(Q, false);
 	}
 	update_dirty_quadrants();
@@ -1086,7 +1222,14 @@ void TileMap::_update_item_material_state(const RID &p_canvas_item) {
 void TileMap::clear() {
 
 	_clear_quadrants();
-	tile_map.clear();
+
+	const PosKey *K = NULL;
+	while ((K = cell_chunks.next(K))) {
+		memdelete(cell_chunks[*K]);
+	}
+	cell_chunks.clear();
+	cell_count = 0;
+
 	used_size_cache_dirty = true;
 }
 
@@ -1143,27 +1286,31 @@ void TileMap::_set_tile_data(const PoolVector<int> &p_data) {
 
 PoolVector<int> TileMap::_get_tile_data() const {
 
+	Vector<PosKey> cells;
+	_get_used_cells(&cells);
+
 	PoolVector<int> data;
-	data.resize(tile_map.size() * 3);
+	data.resize(cells.size() * 3);
 	PoolVector<int>::Write w = data.write();
 
 	format = FORMAT_2;
 
 	int idx = 0;
-	for (const Map<PosKey, Cell>::Element *E = tile_map.front(); E; E = E->next()) {
+	for (int i = 0; i < cells.size(); i++) {
+		const Cell *E = _get_cell(cells[i].x, cells[i].y);
 		uint8_t *ptr = (uint8_t *)&w[idx];
-		encode_uint16(E->key().x, &ptr[0]);
-		encode_uint16(E->key().y, &ptr[2]);
-		uint32_t val = E->get().id;
-		if (E->get().flip_h)
+		encode_uint16(cells[i].x, &ptr[0]);
+		encode_uint16(cells[i].y, &ptr[2]);
+		uint32_t val = E->id;
+		if (E->flip_h)
 			val |= (1 << 29);
-		if (E->get().flip_v)
+		if (E->flip_v)
 			val |= (1 << 30);
-		if (E->get().transpose)
+		if (E->transpose)
 			val |= (1 << 31);
 		encode_uint32(val, &ptr[4]);
-		encode_uint16(E->get().autotile_coord_x, &ptr[8]);
-		encode_uint16(E->get().autotile_coord_y, &ptr[10]);
+		encode_uint16(E->autotile_coord_x, &ptr[8]);
+		encode_uint16(E->autotile_coord_y, &ptr[10]);
 		idx += 3;
 	}
 
@@ -1494,13 +1641,15 @@ bool TileMap::is_y_sort_mode_enabled() const {
 
 Array TileMap::get_used_cells() const {
 
+	Vector<PosKey> cells;
+	_get_used_cells(&cells);
+
 	Array a;
-	a.resize(tile_map.size());
-	int i = 0;
-	for (Map<PosKey, Cell>::Element *E = tile_map.front(); E; E = E->next()) {
+	a.resize(cells.size());
+	for (int i = 0; i < cells.size(); i++) {
 
-		Vector2 p(E->key().x, E->key().y);
-		a[i++] = p;
+		Vector2 p(cells[i].x, cells[i].y);
+		a[i] = p;
 	}
 
 	return a;
@@ -1508,11 +1657,14 @@ Array TileMap::get_used_cells() const {
 
 Array TileMap::get_used_cells_by_id(int p_id) const {
 
+	Vector<PosKey> cells;
+	_get_used_cells(&cells);
+
 	Array a;
-	for (Map<PosKey, Cell>::Element *E = tile_map.front(); E; E = E->next()) {
+	for (int i = 0; i < cells.size(); i++) {
 
-		if (E->value().id == p_id) {
-			Vector2 p(E->key().x, E->key().y);
+		if (_get_cell(cells[i].x, cells[i].y)->id == p_id) {
+			Vector2 p(cells[i].x, cells[i].y);
 			a.push_back(p);
 		}
 	}
@@ -1523,11 +1675,35 @@ Array TileMap::get_used_cells_by_id(int p_id) const {
 Rect2 TileMap::get_used_rect() { // Not const because of cache
 
 	if (used_size_cache_dirty) {
-		if (tile_map.size() > 0) {
-			used_size_cache = Rect2(tile_map.front()->key().x, tile_map.front()->key().y, 0, 0);
+		if (cell_count > 0) {
+			bool first = true;
+
+			const PosKey *K = NULL;
+			while ((K = cell_chunks.next(K))) {
+
+				const CellChunk *chunk = cell_chunks[*K];
+				int base_x = K->x << CELL_CHUNK_SHIFT;
+				int base_y = K->y << CELL_CHUNK_SHIFT;
+
+				//chunks fully inside the rect found so far can't grow it
+				if (!first && used_size_cache.has_point(Vector2(base_x, base_y)) && used_size_cache.has_point(Vector2(base_x + CELL_CHUNK_MASK, base_y + CELL_CHUNK_MASK))) {
+					continue;
+				}
 
-			for (Map<PosKey, Cell>::Element *E = tile_map.front(); E; E = E->next()) {
-				used_size_cache.expand_to(Vector2(E->key().x, E->key().y));
+				for (int i = 0; i < CELL_CHUNK_SIZE * CELL_CHUNK_SIZE; i++) {
+
+					if (chunk->cells[i].id == INVALID_CELL) {
+						continue;
+					}
+
+					Vector2 pos(base_x + (i & CELL_CHUNK_MASK), base_y + (i >> CELL_CHUNK_SHIFT));
+					if (first) {
+						used_size_cache = Rect2(pos, Vector2());
+						first = false;
+					} else {
+						used_size_cache.expand_to(pos);
+					}
+				}
 			}
 
 			used_size_cache.size += Vector2(1, 1);
@@ -1641,6 +1817,8 @@ void TileMap::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_cell", "x", "y", "tile", "flip_x", "flip_y", "transpose", "autotile_coord"), &TileMap::set_cell, DEFVAL(false), DEFVAL(false), DEFVAL(false), DEFVAL(Vector2()));
 	ClassDB::bind_method(D_METHOD("set_cellv", "position", "tile", "flip_x", "flip_y", "transpose"), &TileMap::set_cellv, DEFVAL(false), DEFVAL(false), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("set_cells_rect", "rect", "tile", "flip_x", "flip_y", "transpose", "autotile_coord"), &TileMap::set_cells_rect, DEFVAL(false), DEFVAL(false), DEFVAL(false), DEFVAL(Vector2()));
+	ClassDB::bind_method(D_METHOD("set_cells_from_image", "image", "position", "tiles"), &TileMap::set_cells_from_image);
 	ClassDB::bind_method(D_METHOD("_set_celld", "position", "data"), &TileMap::_set_celld);
 	ClassDB::bind_method(D_METHOD("get_cell", "x", "y"), &TileMap::get_cell);
 	ClassDB::bind_method(D_METHOD("get_cellv", "position"), &TileMap::get_cellv);
@@ -1735,6 +1913,7 @@ TileMap::TileMap() {
 	occluder_light_mask = 1;
 	clip_uv = false;
 	format = FORMAT_1; //Always initialize with the lowest format
+	cell_count = 0;
 
 	fp_adjust = 0.00001;
 	tile_origin = TILE_ORIGIN_TOP_LEFT;
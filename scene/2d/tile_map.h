@@ -31,6 +31,7 @@
 #ifndef TILE_MAP_H
 #define TILE_MAP_H
 
+#include "core/hash_map.h"
 #include "core/self_list.h"
 #include "core/vset.h"
 #include "scene/2d/navigation_2d.h"
@@ -113,9 +114,51 @@ private:
 		Cell() { _u64t = 0; }
 	};
 
-	Map<PosKey, Cell> tile_map;
+	struct PosKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PosKey &p_key) { return hash_one_uint64(p_key.key); }
+	};
+
+	//cells are stored densely in fixed size chunks, an empty cell has INVALID_CELL as id
+
+	enum {
+		CELL_CHUNK_SHIFT = 5,
+		CELL_CHUNK_SIZE = 1 << CELL_CHUNK_SHIFT,
+		CELL_CHUNK_MASK = CELL_CHUNK_SIZE - 1
+	};
+
+	struct CellChunk {
+		Cell cells[CELL_CHUNK_SIZE * CELL_CHUNK_SIZE];
+		int used;
+
+		CellChunk() {
+			for (int i = 0; i < CELL_CHUNK_SIZE * CELL_CHUNK_SIZE; i++) {
+				cells[i].id = INVALID_CELL;
+			}
+			used = 0;
+		}
+	};
+
+	HashMap<PosKey, CellChunk *, PosKeyHasher> cell_chunks;
+	int cell_count;
 	List<PosKey> dirty_bitmask;
 
+	_FORCE_INLINE_ static PosKey _get_chunk_key(int p_x, int p_y) { return PosKey(p_x >> CELL_CHUNK_SHIFT, p_y >> CELL_CHUNK_SHIFT); }
+	_FORCE_INLINE_ static int _get_chunk_index(int p_x, int p_y) { return ((p_y & CELL_CHUNK_MASK) << CELL_CHUNK_SHIFT) + (p_x & CELL_CHUNK_MASK); }
+
+	_FORCE_INLINE_ const Cell *_get_cell(int p_x, int p_y) const {
+
+		PosKey pk(p_x, p_y);
+		CellChunk *const *chunk = cell_chunks.getptr(_get_chunk_key(pk.x, pk.y));
+		if (!chunk) {
+			return NULL;
+		}
+		const Cell *cell = &(*chunk)->cells[_get_chunk_index(pk.x, pk.y)];
+		return cell->id == INVALID_CELL ? NULL : cell;
+	}
+	_FORCE_INLINE_ Cell *_get_cell(int p_x, int p_y) { return const_cast<Cell *>(static_cast<const TileMap *>(this)->_get_cell(p_x, p_y)); }
+
+	void _get_used_cells(Vector<PosKey> *r_cells) const;
+
 	struct Quadrant {
 
 		Vector2 pos;
@@ -187,6 +230,7 @@ private:
 	void _fix_cell_transform(Transform2D &xform, const Cell &p_cell, const Vector2 &p_offset, const Size2 &p_sc);
 
 	Map<PosKey, Quadrant>::Element *_create_quadrant(const PosKey &p_qk);
+	void _set_cell(int p_x, int p_y, const Cell &p_cell, Map<PosKey, Quadrant>::Element **r_quadrant);
 	void _erase_quadrant(Map<PosKey, Quadrant>::Element *Q);
 	void _make_quadrant_dirty(Map<PosKey, Quadrant>::Element *Q, bool update = true);
 	void _recreate_quadrants();
@@ -246,6 +290,9 @@ public:
 	void set_cellv(const Vector2 &p_pos, int p_tile, bool p_flip_x = false, bool p_flip_y = false, bool p_transpose = false);
 	int get_cellv(const Vector2 &p_pos) const;
 
+	void set_cells_rect(const Rect2 &p_rect, int p_tile, bool p_flip_x = false, bool p_flip_y = false, bool p_transpose = false, Vector2 p_autotile_coord = Vector2());
+	void set_cells_from_image(const Ref<Image> &p_image, const Vector2 &p_position, const PoolVector<int> &p_tiles);
+
 	void make_bitmask_area_dirty(const Vector2 &p_pos);
 	void update_bitmask_area(const Vector2 &p_pos);
 	void update_bitmask_region(const Vector2 &p_start = Vector2(), const Vector2 &p_end = Vector2());
@@ -32,6 +32,7 @@
 
 #include "scene/3d/camera.h"
 #include "scene/3d/particles.h"
+#include "scene/main/scene_tree.h"
 #include "scene/resources/particles_material.h"
 #include "servers/visual_server.h"
 
@@ -500,6 +501,19 @@ static float rand_from_seed(uint32_t &seed) {
 	return float(seed % uint32_t(65536)) / 65535.0;
 }
 
+ThreadWorkPool *CPUParticles::_get_work_pool(uint32_t p_chunks) {
+
+	if (p_chunks < 2 || !is_inside_tree() || Thread::get_caller_id() != Thread::get_main_id()) {
+		return NULL;
+	}
+
+	ThreadWorkPool *pool = get_tree()->get_work_pool();
+	if (pool->is_working()) {
+		return NULL; //already inside a job, don't nest
+	}
+	return pool;
+}
+
 void CPUParticles::_particles_process(float p_delta) {
 
 	p_delta *= speed_scale;
@@ -507,9 +521,12 @@ void CPUParticles::_particles_process(float p_delta) {
 	int pcount = particles.size();
 	PoolVector<Particle>::Write w = particles.write();
 
-	Particle *parray = w.ptr();
+	ProcessState state;
+	state.particles = w.ptr();
+	state.count = pcount;
+	state.delta = p_delta;
+	state.prev_time = time;
 
-	float prev_time = time;
 	time += p_delta;
 	if (time > lifetime) {
 		time = Math::fmod(time, lifetime);
@@ -519,390 +536,424 @@ void CPUParticles::_particles_process(float p_delta) {
 		}
 	}
 
-	Transform emission_xform;
-	Basis velocity_xform;
 	if (!local_coords) {
-		emission_xform = get_global_transform();
-		velocity_xform = emission_xform.basis;
+		state.emission_xform = get_global_transform();
+		state.velocity_xform = state.emission_xform.basis;
 	}
 
-	for (int i = 0; i < pcount; i++) {
+	PoolVector<Vector3>::Read emission_points_r = emission_points.read();
+	PoolVector<Vector3>::Read emission_normals_r = emission_normals.read();
+	PoolVector<Color>::Read emission_colors_r = emission_colors.read();
 
-		Particle &p = parray[i];
+	state.emission_point_count = emission_points.size();
+	state.emission_points = emission_points_r.ptr();
+	state.emission_normals = emission_normals.size() == state.emission_point_count ? emission_normals_r.ptr() : NULL;
+	state.emission_colors = emission_colors.size() == state.emission_point_count ? emission_colors_r.ptr() : NULL;
 
-		if (!emitting && !p.active)
-			continue;
+	if (color_ramp.is_valid()) {
+		color_ramp->get_color_at_offset(0); //sorts the points if needed, must not happen inside the jobs
+	}
 
-		float restart_time = (float(i) / float(pcount)) * lifetime;
-		float local_delta = p_delta;
+	uint32_t chunks = (pcount + PROCESS_CHUNK_SIZE - 1) / PROCESS_CHUNK_SIZE;
+	ThreadWorkPool *pool = _get_work_pool(chunks);
 
-		if (randomness_ratio > 0.0) {
-			uint32_t seed = cycle;
-			if (restart_time >= time) {
-				seed -= uint32_t(1);
-			}
-			seed *= uint32_t(pcount);
-			seed += uint32_t(i);
-			float random = float(idhash(seed) % uint32_t(65536)) / 65536.0;
-			restart_time += randomness_ratio * random * 1.0 / float(pcount);
+	if (pool) {
+		pool->do_work(chunks, this, &CPUParticles::_particles_process_chunk, (const ProcessState *)&state);
+	} else {
+		for (uint32_t i = 0; i < chunks; i++) {
+			_particles_process_chunk(i, &state);
 		}
+	}
+}
 
-		restart_time *= (1.0 - explosiveness_ratio);
-		bool restart = false;
+void CPUParticles::_particles_process_chunk(uint32_t p_chunk, const ProcessState *p_state) {
 
-		if (time > prev_time) {
-			// restart_time >= prev_time is used so particles emit in the first frame they are processed
+	int from = p_chunk * PROCESS_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_CHUNK_SIZE, p_state->count);
 
-			if (restart_time >= prev_time && restart_time < time) {
-				restart = true;
-				if (fractional_delta) {
-					local_delta = (time - restart_time) * lifetime;
-				}
-			}
+	for (int i = from; i < to; i++) {
+		_particle_process(i, p_state);
+	}
+}
 
-		} else if (local_delta > 0.0) {
-			if (restart_time >= prev_time) {
-				restart = true;
-				if (fractional_delta) {
-					local_delta = (1.0 - restart_time + time) * lifetime;
-				}
+void CPUParticles::_particle_process(int p_index, const ProcessState *p_state) {
 
-			} else if (restart_time < time) {
-				restart = true;
-				if (fractional_delta) {
-					local_delta = (time - restart_time) * lifetime;
-				}
-			}
+	Particle &p = p_state->particles[p_index];
+
+	if (!emitting && !p.active)
+		return;
+
+	float restart_time = (float(p_index) / float(p_state->count)) * lifetime;
+	float local_delta = p_state->delta;
+
+	if (randomness_ratio > 0.0) {
+		uint32_t seed = cycle;
+		if (restart_time >= time) {
+			seed -= uint32_t(1);
 		}
+		seed *= uint32_t(p_state->count);
+		seed += uint32_t(p_index);
+		float random = float(idhash(seed) % uint32_t(65536)) / 65536.0;
+		restart_time += randomness_ratio * random * 1.0 / float(p_state->count);
+	}
 
-		if (restart) {
+	restart_time *= (1.0 - explosiveness_ratio);
+	bool restart = false;
 
-			if (!emitting) {
-				p.active = false;
-				continue;
-			}
-			p.active = true;
+	if (time > p_state->prev_time) {
+		// restart_time >= prev_time is used so particles emit in the first frame they are processed
 
-			/*float tex_linear_velocity = 0;
-			if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
-				tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(0);
-			}*/
+		if (restart_time >= p_state->prev_time && restart_time < time) {
+			restart = true;
+			if (fractional_delta) {
+				local_delta = (time - restart_time) * lifetime;
+			}
+		}
 
-			float tex_angle = 0.0;
-			if (curve_parameters[PARAM_ANGLE].is_valid()) {
-				tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(0);
+	} else if (local_delta > 0.0) {
+		if (restart_time >= p_state->prev_time) {
+			restart = true;
+			if (fractional_delta) {
+				local_delta = (1.0 - restart_time + time) * lifetime;
 			}
 
-			float tex_anim_offset = 0.0;
-			if (curve_parameters[PARAM_ANGLE].is_valid()) {
-				tex_anim_offset = curve_parameters[PARAM_ANGLE]->interpolate(0);
+		} else if (restart_time < time) {
+			restart = true;
+			if (fractional_delta) {
+				local_delta = (time - restart_time) * lifetime;
 			}
+		}
+	}
 
-			p.seed = Math::rand();
+	if (restart) {
 
-			p.angle_rand = Math::randf();
-			p.scale_rand = Math::randf();
-			p.hue_rot_rand = Math::randf();
-			p.anim_offset_rand = Math::randf();
+		if (!emitting) {
+			p.active = false;
+			return;
+		}
+		p.active = true;
 
-			if (flags[FLAG_DISABLE_Z]) {
-				float angle1_rad = (Math::randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
-				Vector3 rot = Vector3(Math::cos(angle1_rad), Math::sin(angle1_rad), 0.0);
-				p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(Math::randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
-			} else {
-				//initiate velocity spread in 3D
-				float angle1_rad = (Math::randf() * 2.0 - 1.0) * Math_PI * spread / 180.0;
-				float angle2_rad = (Math::randf() * 2.0 - 1.0) * (1.0 - flatness) * Math_PI * spread / 180.0;
-
-				Vector3 direction_xz = Vector3(Math::sin(angle1_rad), 0, Math::cos(angle1_rad));
-				Vector3 direction_yz = Vector3(0, Math::sin(angle2_rad), Math::cos(angle2_rad));
-				direction_yz.z = direction_yz.z / MAX(0.0001, Math::sqrt(ABS(direction_yz.z))); //better uniform distribution
-				Vector3 direction = Vector3(direction_xz.x * direction_yz.z, direction_yz.y, direction_xz.z * direction_yz.z);
-				direction.normalize();
-				p.velocity = direction * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, float(Math::randf()), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
-			}
+		/*float tex_linear_velocity = 0;
+		if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
+			tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(0);
+		}*/
 
-			float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
-			p.custom[0] = Math::deg2rad(base_angle); //angle
-			p.custom[1] = 0.0; //phase
-			p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]); //animation offset (0-1)
-			p.transform = Transform();
-			p.time = 0;
-			p.base_color = Color(1, 1, 1, 1);
-
-			switch (emission_shape) {
-				case EMISSION_SHAPE_POINT: {
-					//do none
-				} break;
-				case EMISSION_SHAPE_SPHERE: {
-					p.transform.origin = Vector3(Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0).normalized() * emission_sphere_radius;
-				} break;
-				case EMISSION_SHAPE_BOX: {
-					p.transform.origin = Vector3(Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0, Math::randf() * 2.0 - 1.0) * emission_box_extents;
-				} break;
-				case EMISSION_SHAPE_POINTS:
-				case EMISSION_SHAPE_DIRECTED_POINTS: {
-
-					int pc = emission_points.size();
-					if (pc == 0)
-						break;
-
-					int random_idx = Math::rand() % pc;
-
-					p.transform.origin = emission_points.get(random_idx);
-
-					if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && emission_normals.size() == pc) {
-						if (flags[FLAG_DISABLE_Z]) {
-							/*
-							mat2 rotm;
-							";
-									rotm[0] = texelFetch(emission_texture_normal, emission_tex_ofs, 0).xy;
-							rotm[1] = rotm[0].yx * vec2(1.0, -1.0);
-							VELOCITY.xy = rotm * VELOCITY.xy;
-							*/
-						} else {
-							Vector3 normal = emission_normals.get(random_idx);
-							Vector3 v0 = Math::abs(normal.z) < 0.999 ? Vector3(0.0, 0.0, 1.0) : Vector3(0, 1.0, 0.0);
-							Vector3 tangent = v0.cross(normal).normalized();
-							Vector3 bitangent = tangent.cross(normal).normalized();
-							Basis m3;
-							m3.set_axis(0, tangent);
-							m3.set_axis(1, bitangent);
-							m3.set_axis(2, normal);
-							p.velocity = m3.xform(p.velocity);
-						}
-					}
+		float tex_angle = 0.0;
+		if (curve_parameters[PARAM_ANGLE].is_valid()) {
+			tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(0);
+		}
 
-					if (emission_colors.size() == pc) {
-						p.base_color = emission_colors.get(random_idx);
-					}
-				} break;
-			}
+		float tex_anim_offset = 0.0;
+		if (curve_parameters[PARAM_ANGLE].is_valid()) {
+			tex_anim_offset = curve_parameters[PARAM_ANGLE]->interpolate(0);
+		}
 
-			if (!local_coords) {
-				p.velocity = velocity_xform.xform(p.velocity);
-				p.transform = emission_xform * p.transform;
-			}
+		//seeded per particle and cycle rather than from the global generator, so results don't depend on which thread runs it
+		uint32_t rand_seed = idhash(random_seed + uint32_t(cycle) * uint32_t(p_state->count) + uint32_t(p_index));
+		p.seed = idhash(rand_seed);
 
-			if (flags[FLAG_DISABLE_Z]) {
-				p.velocity.z = 0.0;
-				p.transform.origin.z = 0.0;
-			}
+		p.angle_rand = rand_from_seed(rand_seed);
+		p.scale_rand = rand_from_seed(rand_seed);
+		p.hue_rot_rand = rand_from_seed(rand_seed);
+		p.anim_offset_rand = rand_from_seed(rand_seed);
 
-		} else if (!p.active) {
-			continue;
+		if (flags[FLAG_DISABLE_Z]) {
+			float angle1_rad = (rand_from_seed(rand_seed) * 2.0 - 1.0) * Math_PI * spread / 180.0;
+			Vector3 rot = Vector3(Math::cos(angle1_rad), Math::sin(angle1_rad), 0.0);
+			p.velocity = rot * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, rand_from_seed(rand_seed), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
 		} else {
+			//initiate velocity spread in 3D
+			float angle1_rad = (rand_from_seed(rand_seed) * 2.0 - 1.0) * Math_PI * spread / 180.0;
+			float angle2_rad = (rand_from_seed(rand_seed) * 2.0 - 1.0) * (1.0 - flatness) * Math_PI * spread / 180.0;
+
+			Vector3 direction_xz = Vector3(Math::sin(angle1_rad), 0, Math::cos(angle1_rad));
+			Vector3 direction_yz = Vector3(0, Math::sin(angle2_rad), Math::cos(angle2_rad));
+			direction_yz.z = direction_yz.z / MAX(0.0001, Math::sqrt(ABS(direction_yz.z))); //better uniform distribution
+			Vector3 direction = Vector3(direction_xz.x * direction_yz.z, direction_yz.y, direction_xz.z * direction_yz.z);
+			direction.normalize();
+			p.velocity = direction * parameters[PARAM_INITIAL_LINEAR_VELOCITY] * Math::lerp(1.0f, rand_from_seed(rand_seed), randomness[PARAM_INITIAL_LINEAR_VELOCITY]);
+		}
 
-			uint32_t alt_seed = p.seed;
+		float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
+		p.custom[0] = Math::deg2rad(base_angle); //angle
+		p.custom[1] = 0.0; //phase
+		p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]); //animation offset (0-1)
+		p.transform = Transform();
+		p.time = 0;
+		p.base_color = Color(1, 1, 1, 1);
+
+		switch (emission_shape) {
+			case EMISSION_SHAPE_POINT: {
+				//do none
+			} break;
+			case EMISSION_SHAPE_SPHERE: {
+				p.transform.origin = Vector3(rand_from_seed(rand_seed) * 2.0 - 1.0, rand_from_seed(rand_seed) * 2.0 - 1.0, rand_from_seed(rand_seed) * 2.0 - 1.0).normalized() * emission_sphere_radius;
+			} break;
+			case EMISSION_SHAPE_BOX: {
+				p.transform.origin = Vector3(rand_from_seed(rand_seed) * 2.0 - 1.0, rand_from_seed(rand_seed) * 2.0 - 1.0, rand_from_seed(rand_seed) * 2.0 - 1.0) * emission_box_extents;
+			} break;
+			case EMISSION_SHAPE_POINTS:
+			case EMISSION_SHAPE_DIRECTED_POINTS: {
+
+				int pc = p_state->emission_point_count;
+				if (pc == 0)
+					break;
+
+				int random_idx = int(idhash(rand_seed) % uint32_t(pc));
+
+				p.transform.origin = p_state->emission_points[random_idx];
+
+				if (emission_shape == EMISSION_SHAPE_DIRECTED_POINTS && p_state->emission_normals) {
+					if (flags[FLAG_DISABLE_Z]) {
+						/*
+						mat2 rotm;
+						";
+								rotm[0] = texelFetch(emission_texture_normal, emission_tex_ofs, 0).xy;
+						rotm[1] = rotm[0].yx * vec2(1.0, -1.0);
+						VELOCITY.xy = rotm * VELOCITY.xy;
+						*/
+					} else {
+						Vector3 normal = p_state->emission_normals[random_idx];
+						Vector3 v0 = Math::abs(normal.z) < 0.999 ? Vector3(0.0, 0.0, 1.0) : Vector3(0, 1.0, 0.0);
+						Vector3 tangent = v0.cross(normal).normalized();
+						Vector3 bitangent = tangent.cross(normal).normalized();
+						Basis m3;
+						m3.set_axis(0, tangent);
+						m3.set_axis(1, bitangent);
+						m3.set_axis(2, normal);
+						p.velocity = m3.xform(p.velocity);
+					}
+				}
 
-			p.time += local_delta;
-			p.custom[1] = p.time / lifetime;
+				if (p_state->emission_colors) {
+					p.base_color = p_state->emission_colors[random_idx];
+				}
+			} break;
+		}
 
-			float tex_linear_velocity = 0.0;
-			if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
-				tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(p.custom[1]);
-			}
-			/*
-			float tex_orbit_velocity = 0.0;
+		if (!local_coords) {
+			p.velocity = p_state->velocity_xform.xform(p.velocity);
+			p.transform = p_state->emission_xform * p.transform;
+		}
 
-			if (flags[FLAG_DISABLE_Z]) {
+		if (flags[FLAG_DISABLE_Z]) {
+			p.velocity.z = 0.0;
+			p.transform.origin.z = 0.0;
+		}
 
-				if (curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY].is_valid()) {
-					tex_orbit_velocity = curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY]->interpolate(p.custom[1]);
-				}
+	} else if (!p.active) {
+		return;
+	} else {
+
+		uint32_t alt_seed = p.seed;
+
+		p.time += local_delta;
+		p.custom[1] = p.time / lifetime;
+
+		float tex_linear_velocity = 0.0;
+		if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
+			tex_linear_velocity = curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY]->interpolate(p.custom[1]);
+		}
+		/*
+		float tex_orbit_velocity = 0.0;
+
+		if (flags[FLAG_DISABLE_Z]) {
+
+			if (curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY].is_valid()) {
+				tex_orbit_velocity = curve_parameters[PARAM_INITIAL_ORBIT_VELOCITY]->interpolate(p.custom[1]);
 			}
+		}
 */
-			float tex_angular_velocity = 0.0;
-			if (curve_parameters[PARAM_ANGULAR_VELOCITY].is_valid()) {
-				tex_angular_velocity = curve_parameters[PARAM_ANGULAR_VELOCITY]->interpolate(p.custom[1]);
-			}
+		float tex_angular_velocity = 0.0;
+		if (curve_parameters[PARAM_ANGULAR_VELOCITY].is_valid()) {
+			tex_angular_velocity = curve_parameters[PARAM_ANGULAR_VELOCITY]->interpolate(p.custom[1]);
+		}
 
-			float tex_linear_accel = 0.0;
-			if (curve_parameters[PARAM_LINEAR_ACCEL].is_valid()) {
-				tex_linear_accel = curve_parameters[PARAM_LINEAR_ACCEL]->interpolate(p.custom[1]);
-			}
+		float tex_linear_accel = 0.0;
+		if (curve_parameters[PARAM_LINEAR_ACCEL].is_valid()) {
+			tex_linear_accel = curve_parameters[PARAM_LINEAR_ACCEL]->interpolate(p.custom[1]);
+		}
 
-			float tex_tangential_accel = 0.0;
-			if (curve_parameters[PARAM_TANGENTIAL_ACCEL].is_valid()) {
-				tex_tangential_accel = curve_parameters[PARAM_TANGENTIAL_ACCEL]->interpolate(p.custom[1]);
-			}
+		float tex_tangential_accel = 0.0;
+		if (curve_parameters[PARAM_TANGENTIAL_ACCEL].is_valid()) {
+			tex_tangential_accel = curve_parameters[PARAM_TANGENTIAL_ACCEL]->interpolate(p.custom[1]);
+		}
 
-			float tex_radial_accel = 0.0;
-			if (curve_parameters[PARAM_RADIAL_ACCEL].is_valid()) {
-				tex_radial_accel = curve_parameters[PARAM_RADIAL_ACCEL]->interpolate(p.custom[1]);
-			}
+		float tex_radial_accel = 0.0;
+		if (curve_parameters[PARAM_RADIAL_ACCEL].is_valid()) {
+			tex_radial_accel = curve_parameters[PARAM_RADIAL_ACCEL]->interpolate(p.custom[1]);
+		}
 
-			float tex_damping = 0.0;
-			if (curve_parameters[PARAM_DAMPING].is_valid()) {
-				tex_damping = curve_parameters[PARAM_DAMPING]->interpolate(p.custom[1]);
-			}
+		float tex_damping = 0.0;
+		if (curve_parameters[PARAM_DAMPING].is_valid()) {
+			tex_damping = curve_parameters[PARAM_DAMPING]->interpolate(p.custom[1]);
+		}
 
-			float tex_angle = 0.0;
-			if (curve_parameters[PARAM_ANGLE].is_valid()) {
-				tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(p.custom[1]);
-			}
-			float tex_anim_speed = 0.0;
-			if (curve_parameters[PARAM_ANIM_SPEED].is_valid()) {
-				tex_anim_speed = curve_parameters[PARAM_ANIM_SPEED]->interpolate(p.custom[1]);
-			}
+		float tex_angle = 0.0;
+		if (curve_parameters[PARAM_ANGLE].is_valid()) {
+			tex_angle = curve_parameters[PARAM_ANGLE]->interpolate(p.custom[1]);
+		}
+		float tex_anim_speed = 0.0;
+		if (curve_parameters[PARAM_ANIM_SPEED].is_valid()) {
+			tex_anim_speed = curve_parameters[PARAM_ANIM_SPEED]->interpolate(p.custom[1]);
+		}
 
-			float tex_anim_offset = 0.0;
-			if (curve_parameters[PARAM_ANIM_OFFSET].is_valid()) {
-				tex_anim_offset = curve_parameters[PARAM_ANIM_OFFSET]->interpolate(p.custom[1]);
-			}
+		float tex_anim_offset = 0.0;
+		if (curve_parameters[PARAM_ANIM_OFFSET].is_valid()) {
+			tex_anim_offset = curve_parameters[PARAM_ANIM_OFFSET]->interpolate(p.custom[1]);
+		}
 
-			Vector3 force = gravity;
-			Vector3 position = p.transform.origin;
-			if (flags[FLAG_DISABLE_Z]) {
-				position.z = 0.0;
-			}
-			//apply linear acceleration
-			force += p.velocity.length() > 0.0 ? p.velocity.normalized() * (parameters[PARAM_LINEAR_ACCEL] + tex_linear_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_LINEAR_ACCEL]) : Vector3();
-			//apply radial acceleration
-			Vector3 org = emission_xform.origin;
-			Vector3 diff = position - org;
-			force += diff.length() > 0.0 ? diff.normalized() * (parameters[PARAM_RADIAL_ACCEL] + tex_radial_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_RADIAL_ACCEL]) : Vector3();
-			//apply tangential acceleration;
-			if (flags[FLAG_DISABLE_Z]) {
-
-				Vector3 yx = Vector3(diff.y, 0, diff.x);
-				force += yx.length() > 0.0 ? (yx * Vector3(-1.0, 0, 1.0)) * ((parameters[PARAM_TANGENTIAL_ACCEL] + tex_tangential_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_TANGENTIAL_ACCEL])) : Vector3();
+		Vector3 force = gravity;
+		Vector3 position = p.transform.origin;
+		if (flags[FLAG_DISABLE_Z]) {
+			position.z = 0.0;
+		}
+		//apply linear acceleration
+		force += p.velocity.length() > 0.0 ? p.velocity.normalized() * (parameters[PARAM_LINEAR_ACCEL] + tex_linear_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_LINEAR_ACCEL]) : Vector3();
+		//apply radial acceleration
+		Vector3 org = p_state->emission_xform.origin;
+		Vector3 diff = position - org;
+		force += diff.length() > 0.0 ? diff.normalized() * (parameters[PARAM_RADIAL_ACCEL] + tex_radial_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_RADIAL_ACCEL]) : Vector3();
+		//apply tangential acceleration;
+		if (flags[FLAG_DISABLE_Z]) {
 
-			} else {
-				Vector3 crossDiff = diff.normalized().cross(gravity.normalized());
-				force += crossDiff.length() > 0.0 ? crossDiff.normalized() * ((parameters[PARAM_TANGENTIAL_ACCEL] + tex_tangential_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_TANGENTIAL_ACCEL])) : Vector3();
-			}
-			//apply attractor forces
-			p.velocity += force * local_delta;
-			//orbit velocity
+			Vector3 yx = Vector3(diff.y, 0, diff.x);
+			force += yx.length() > 0.0 ? (yx * Vector3(-1.0, 0, 1.0)) * ((parameters[PARAM_TANGENTIAL_ACCEL] + tex_tangential_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_TANGENTIAL_ACCEL])) : Vector3();
+
+		} else {
+			Vector3 crossDiff = diff.normalized().cross(gravity.normalized());
+			force += crossDiff.length() > 0.0 ? crossDiff.normalized() * ((parameters[PARAM_TANGENTIAL_ACCEL] + tex_tangential_accel) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_TANGENTIAL_ACCEL])) : Vector3();
+		}
+		//apply attractor forces
+		p.velocity += force * local_delta;
+		//orbit velocity
 #if 0
-			if (flags[FLAG_DISABLE_Z]) {
-
-				float orbit_amount = (orbit_velocity + tex_orbit_velocity) * mix(1.0, rand_from_seed(alt_seed), orbit_velocity_random);
-				if (orbit_amount != 0.0) {
-					float ang = orbit_amount * DELTA * pi * 2.0;
-					mat2 rot = mat2(vec2(cos(ang), -sin(ang)), vec2(sin(ang), cos(ang)));
-					TRANSFORM[3].xy -= diff.xy;
-					TRANSFORM[3].xy += rot * diff.xy;
-				}
+		if (flags[FLAG_DISABLE_Z]) {
+
+			float orbit_amount = (orbit_velocity + tex_orbit_velocity) * mix(1.0, rand_from_seed(alt_seed), orbit_velocity_random);
+			if (orbit_amount != 0.0) {
+				float ang = orbit_amount * DELTA * pi * 2.0;
+				mat2 rot = mat2(vec2(cos(ang), -sin(ang)), vec2(sin(ang), cos(ang)));
+				TRANSFORM[3].xy -= diff.xy;
+				TRANSFORM[3].xy += rot * diff.xy;
 			}
+		}
 #endif
-			if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
-				p.velocity = p.velocity.normalized() * tex_linear_velocity;
-			}
-			if (parameters[PARAM_DAMPING] + tex_damping > 0.0) {
-
-				float v = p.velocity.length();
-				float damp = (parameters[PARAM_DAMPING] + tex_damping) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_DAMPING]);
-				v -= damp * local_delta;
-				if (v < 0.0) {
-					p.velocity = Vector3();
-				} else {
-					p.velocity = p.velocity.normalized() * v;
-				}
-			}
-			float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
-			base_angle += p.custom[1] * lifetime * (parameters[PARAM_ANGULAR_VELOCITY] + tex_angular_velocity) * Math::lerp(1.0f, rand_from_seed(alt_seed) * 2.0f - 1.0f, randomness[PARAM_ANGULAR_VELOCITY]);
-			p.custom[0] = Math::deg2rad(base_angle); //angle
-			p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]) + p.custom[1] * (parameters[PARAM_ANIM_SPEED] + tex_anim_speed) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_ANIM_SPEED]); //angle
+		if (curve_parameters[PARAM_INITIAL_LINEAR_VELOCITY].is_valid()) {
+			p.velocity = p.velocity.normalized() * tex_linear_velocity;
 		}
-		//apply color
-		//apply hue rotation
+		if (parameters[PARAM_DAMPING] + tex_damping > 0.0) {
 
-		float tex_scale = 1.0;
-		if (curve_parameters[PARAM_SCALE].is_valid()) {
-			tex_scale = curve_parameters[PARAM_SCALE]->interpolate(p.custom[1]);
+			float v = p.velocity.length();
+			float damp = (parameters[PARAM_DAMPING] + tex_damping) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_DAMPING]);
+			v -= damp * local_delta;
+			if (v < 0.0) {
+				p.velocity = Vector3();
+			} else {
+				p.velocity = p.velocity.normalized() * v;
+			}
 		}
+		float base_angle = (parameters[PARAM_ANGLE] + tex_angle) * Math::lerp(1.0f, p.angle_rand, randomness[PARAM_ANGLE]);
+		base_angle += p.custom[1] * lifetime * (parameters[PARAM_ANGULAR_VELOCITY] + tex_angular_velocity) * Math::lerp(1.0f, rand_from_seed(alt_seed) * 2.0f - 1.0f, randomness[PARAM_ANGULAR_VELOCITY]);
+		p.custom[0] = Math::deg2rad(base_angle); //angle
+		p.custom[2] = (parameters[PARAM_ANIM_OFFSET] + tex_anim_offset) * Math::lerp(1.0f, p.anim_offset_rand, randomness[PARAM_ANIM_OFFSET]) + p.custom[1] * (parameters[PARAM_ANIM_SPEED] + tex_anim_speed) * Math::lerp(1.0f, rand_from_seed(alt_seed), randomness[PARAM_ANIM_SPEED]); //angle
+	}
+	//apply color
+	//apply hue rotation
 
-		float tex_hue_variation = 0.0;
-		if (curve_parameters[PARAM_HUE_VARIATION].is_valid()) {
-			tex_hue_variation = curve_parameters[PARAM_HUE_VARIATION]->interpolate(p.custom[1]);
-		}
+	float tex_scale = 1.0;
+	if (curve_parameters[PARAM_SCALE].is_valid()) {
+		tex_scale = curve_parameters[PARAM_SCALE]->interpolate(p.custom[1]);
+	}
 
-		float hue_rot_angle = (parameters[PARAM_HUE_VARIATION] + tex_hue_variation) * Math_PI * 2.0 * Math::lerp(1.0f, p.hue_rot_rand * 2.0f - 1.0f, randomness[PARAM_HUE_VARIATION]);
-		float hue_rot_c = Math::cos(hue_rot_angle);
-		float hue_rot_s = Math::sin(hue_rot_angle);
+	float tex_hue_variation = 0.0;
+	if (curve_parameters[PARAM_HUE_VARIATION].is_valid()) {
+		tex_hue_variation = curve_parameters[PARAM_HUE_VARIATION]->interpolate(p.custom[1]);
+	}
 
-		Basis hue_rot_mat;
-		{
-			Basis mat1(0.299, 0.587, 0.114, 0.299, 0.587, 0.114, 0.299, 0.587, 0.114);
-			Basis mat2(0.701, -0.587, -0.114, -0.299, 0.413, -0.114, -0.300, -0.588, 0.886);
-			Basis mat3(0.168, 0.330, -0.497, -0.328, 0.035, 0.292, 1.250, -1.050, -0.203);
+	float hue_rot_angle = (parameters[PARAM_HUE_VARIATION] + tex_hue_variation) * Math_PI * 2.0 * Math::lerp(1.0f, p.hue_rot_rand * 2.0f - 1.0f, randomness[PARAM_HUE_VARIATION]);
+	float hue_rot_c = Math::cos(hue_rot_angle);
+	float hue_rot_s = Math::sin(hue_rot_angle);
 
-			for (int j = 0; j < 3; j++) {
-				hue_rot_mat[j] = mat1[j] + mat2[j] * hue_rot_c + mat3[j] * hue_rot_s;
-			}
-		}
+	Basis hue_rot_mat;
+	{
+		Basis mat1(0.299, 0.587, 0.114, 0.299, 0.587, 0.114, 0.299, 0.587, 0.114);
+		Basis mat2(0.701, -0.587, -0.114, -0.299, 0.413, -0.114, -0.300, -0.588, 0.886);
+		Basis mat3(0.168, 0.330, -0.497, -0.328, 0.035, 0.292, 1.250, -1.050, -0.203);
 
-		if (color_ramp.is_valid()) {
-			p.color = color_ramp->get_color_at_offset(p.custom[1]) * color;
-		} else {
-			p.color = color;
+		for (int j = 0; j < 3; j++) {
+			hue_rot_mat[j] = mat1[j] + mat2[j] * hue_rot_c + mat3[j] * hue_rot_s;
 		}
+	}
 
-		Vector3 color_rgb = hue_rot_mat.xform_inv(Vector3(p.color.r, p.color.g, p.color.b));
-		p.color.r = color_rgb.x;
-		p.color.g = color_rgb.y;
-		p.color.b = color_rgb.z;
+	if (color_ramp.is_valid()) {
+		p.color = color_ramp->get_color_at_offset(p.custom[1]) * color;
+	} else {
+		p.color = color;
+	}
 
-		p.color *= p.base_color;
+	Vector3 color_rgb = hue_rot_mat.xform_inv(Vector3(p.color.r, p.color.g, p.color.b));
+	p.color.r = color_rgb.x;
+	p.color.g = color_rgb.y;
+	p.color.b = color_rgb.z;
 
-		if (flags[FLAG_DISABLE_Z]) {
+	p.color *= p.base_color;
 
-			if (flags[FLAG_ALIGN_Y_TO_VELOCITY]) {
-				if (p.velocity.length() > 0.0) {
-					p.transform.basis.set_axis(1, p.velocity.normalized());
-				} else {
-					p.transform.basis.set_axis(1, p.transform.basis.get_axis(1));
-				}
-				p.transform.basis.set_axis(0, p.transform.basis.get_axis(1).cross(p.transform.basis.get_axis(2)).normalized());
-				p.transform.basis.set_axis(2, Vector3(0, 0, 1));
+	if (flags[FLAG_DISABLE_Z]) {
 
+		if (flags[FLAG_ALIGN_Y_TO_VELOCITY]) {
+			if (p.velocity.length() > 0.0) {
+				p.transform.basis.set_axis(1, p.velocity.normalized());
 			} else {
-				p.transform.basis.set_axis(0, Vector3(Math::cos(p.custom[0]), -Math::sin(p.custom[0]), 0.0));
-				p.transform.basis.set_axis(1, Vector3(Math::sin(p.custom[0]), Math::cos(p.custom[0]), 0.0));
-				p.transform.basis.set_axis(2, Vector3(0, 0, 1));
+				p.transform.basis.set_axis(1, p.transform.basis.get_axis(1));
 			}
+			p.transform.basis.set_axis(0, p.transform.basis.get_axis(1).cross(p.transform.basis.get_axis(2)).normalized());
+			p.transform.basis.set_axis(2, Vector3(0, 0, 1));
 
 		} else {
-			//orient particle Y towards velocity
-			if (flags[FLAG_ALIGN_Y_TO_VELOCITY]) {
-				if (p.velocity.length() > 0.0) {
-					p.transform.basis.set_axis(1, p.velocity.normalized());
-				} else {
-					p.transform.basis.set_axis(1, p.transform.basis.get_axis(1).normalized());
-				}
-				if (p.transform.basis.get_axis(1) == p.transform.basis.get_axis(0)) {
-					p.transform.basis.set_axis(0, p.transform.basis.get_axis(1).cross(p.transform.basis.get_axis(2)).normalized());
-					p.transform.basis.set_axis(2, p.transform.basis.get_axis(0).cross(p.transform.basis.get_axis(1)).normalized());
-				} else {
-					p.transform.basis.set_axis(2, p.transform.basis.get_axis(0).cross(p.transform.basis.get_axis(1)).normalized());
-					p.transform.basis.set_axis(0, p.transform.basis.get_axis(1).cross(p.transform.basis.get_axis(2)).normalized());
-				}
+			p.transform.basis.set_axis(0, Vector3(Math::cos(p.custom[0]), -Math::sin(p.custom[0]), 0.0));
+			p.transform.basis.set_axis(1, Vector3(Math::sin(p.custom[0]), Math::cos(p.custom[0]), 0.0));
+			p.transform.basis.set_axis(2, Vector3(0, 0, 1));
+		}
+
+	} else {
+		//orient particle Y towards velocity
+		if (flags[FLAG_ALIGN_Y_TO_VELOCITY]) {
+			if (p.velocity.length() > 0.0) {
+				p.transform.basis.set_axis(1, p.velocity.normalized());
 			} else {
-				p.transform.basis.orthonormalize();
+				p.transform.basis.set_axis(1, p.transform.basis.get_axis(1).normalized());
 			}
-
-			//turn particle by rotation in Y
-			if (flags[FLAG_ROTATE_Y]) {
-				Basis rot_y(Vector3(0, 1, 0), p.custom[0]);
-				p.transform.basis = p.transform.basis * rot_y;
+			if (p.transform.basis.get_axis(1) == p.transform.basis.get_axis(0)) {
+				p.transform.basis.set_axis(0, p.transform.basis.get_axis(1).cross(p.transform.basis.get_axis(2)).normalized());
+				p.transform.basis.set_axis(2, p.transform.basis.get_axis(0).cross(p.transform.basis.get_axis(1)).normalized());
+			} else {
+				p.transform.basis.set_axis(2, p.transform.basis.get_axis(0).cross(p.transform.basis.get_axis(1)).normalized());
+				p.transform.basis.set_axis(0, p.transform.basis.get_axis(1).cross(p.transform.basis.get_axis(2)).normalized());
 			}
+		} else {
+			p.transform.basis.orthonormalize();
 		}
 
-		//scale by scale
-		float base_scale = Math::lerp(parameters[PARAM_SCALE] * tex_scale, 1.0f, p.scale_rand * randomness[PARAM_SCALE]);
-		if (base_scale == 0.0) base_scale = 0.000001;
+		//turn particle by rotation in Y
+		if (flags[FLAG_ROTATE_Y]) {
+			Basis rot_y(Vector3(0, 1, 0), p.custom[0]);
+			p.transform.basis = p.transform.basis * rot_y;
+		}
+	}
 
-		p.transform.basis.scale(Vector3(1, 1, 1) * base_scale);
+	//scale by scale
+	float base_scale = Math::lerp(parameters[PARAM_SCALE] * tex_scale, 1.0f, p.scale_rand * randomness[PARAM_SCALE]);
+	if (base_scale == 0.0) base_scale = 0.000001;
 
-		if (flags[FLAG_DISABLE_Z]) {
-			p.velocity.z = 0.0;
-			p.transform.origin.z = 0.0;
-		}
+	p.transform.basis.scale(Vector3(1, 1, 1) * base_scale);
 
-		p.transform.origin += p.velocity * local_delta;
+	if (flags[FLAG_DISABLE_Z]) {
+		p.velocity.z = 0.0;
+		p.transform.origin.z = 0.0;
 	}
+
+	p.transform.origin += p.velocity * local_delta;
 }
 
 void CPUParticles::_update_particle_data_buffer() {
@@ -954,46 +1005,22 @@ void CPUParticles::_update_particle_data_buffer() {
 			}
 		}
 
-		for (int i = 0; i < pc; i++) {
-
-			int idx = order ? order[i] : i;
+		PackState state;
+		state.particles = r.ptr();
+		state.order = order;
+		state.data = ptr;
+		state.count = pc;
+		state.un_transform = un_transform;
 
-			Transform t = r[idx].transform;
+		uint32_t chunks = (pc + PROCESS_CHUNK_SIZE - 1) / PROCESS_CHUNK_SIZE;
+		ThreadWorkPool *pool = _get_work_pool(chunks);
 
-			if (!local_coords) {
-				t = un_transform * t;
-			}
-
-			if (r[idx].active) {
-				ptr[0] = t.basis.elements[0][0];
-				ptr[1] = t.basis.elements[0][1];
-				ptr[2] = t.basis.elements[0][2];
-				ptr[3] = t.origin.x;
-				ptr[4] = t.basis.elements[1][0];
-				ptr[5] = t.basis.elements[1][1];
-				ptr[6] = t.basis.elements[1][2];
-				ptr[7] = t.origin.y;
-				ptr[8] = t.basis.elements[2][0];
-				ptr[9] = t.basis.elements[2][1];
-				ptr[10] = t.basis.elements[2][2];
-				ptr[11] = t.origin.z;
-			} else {
-				zeromem(ptr, sizeof(float) * 12);
+		if (pool) {
+			pool->do_work(chunks, this, &CPUParticles::_pack_particles_chunk, (const PackState *)&state);
+		} else {
+			for (uint32_t i = 0; i < chunks; i++) {
+				_pack_particles_chunk(i, &state);
 			}
-
-			Color c = r[idx].color;
-			uint8_t *data8 = (uint8_t *)&ptr[12];
-			data8[0] = CLAMP(c.r * 255.0, 0, 255);
-			data8[1] = CLAMP(c.g * 255.0, 0, 255);
-			data8[2] = CLAMP(c.b * 255.0, 0, 255);
-			data8[3] = CLAMP(c.a * 255.0, 0, 255);
-
-			ptr[13] = r[idx].custom[0];
-			ptr[14] = r[idx].custom[1];
-			ptr[15] = r[idx].custom[2];
-			ptr[16] = r[idx].custom[3];
-
-			ptr += 17;
 		}
 
 		can_update = true;
@@ -1004,6 +1031,55 @@ void CPUParticles::_update_particle_data_buffer() {
 #endif
 }
 
+void CPUParticles::_pack_particles_chunk(uint32_t p_chunk, const PackState *p_state) {
+
+	int from = p_chunk * PROCESS_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_CHUNK_SIZE, p_state->count);
+	float *ptr = p_state->data + from * 17;
+
+	for (int i = from; i < to; i++) {
+
+		int idx = p_state->order ? p_state->order[i] : i;
+
+		Transform t = p_state->particles[idx].transform;
+
+		if (!local_coords) {
+			t = p_state->un_transform * t;
+		}
+
+		if (p_state->particles[idx].active) {
+			ptr[0] = t.basis.elements[0][0];
+			ptr[1] = t.basis.elements[0][1];
+			ptr[2] = t.basis.elements[0][2];
+			ptr[3] = t.origin.x;
+			ptr[4] = t.basis.elements[1][0];
+			ptr[5] = t.basis.elements[1][1];
+			ptr[6] = t.basis.elements[1][2];
+			ptr[7] = t.origin.y;
+			ptr[8] = t.basis.elements[2][0];
+			ptr[9] = t.basis.elements[2][1];
+			ptr[10] = t.basis.elements[2][2];
+			ptr[11] = t.origin.z;
+		} else {
+			zeromem(ptr, sizeof(float) * 12);
+		}
+
+		Color c = p_state->particles[idx].color;
+		uint8_t *data8 = (uint8_t *)&ptr[12];
+		data8[0] = CLAMP(c.r * 255.0, 0, 255);
+		data8[1] = CLAMP(c.g * 255.0, 0, 255);
+		data8[2] = CLAMP(c.b * 255.0, 0, 255);
+		data8[3] = CLAMP(c.a * 255.0, 0, 255);
+
+		ptr[13] = p_state->particles[idx].custom[0];
+		ptr[14] = p_state->particles[idx].custom[1];
+		ptr[15] = p_state->particles[idx].custom[2];
+		ptr[16] = p_state->particles[idx].custom[3];
+
+		ptr += 17;
+	}
+}
+
 void CPUParticles::_update_render_thread() {
 
 #ifndef NO_THREADS
@@ -1406,6 +1482,7 @@ CPUParticles::CPUParticles() {
 	inactive_time = 0;
 	frame_remainder = 0;
 	cycle = 0;
+	random_seed = Math::rand();
 
 	multimesh = VisualServer::get_singleton()->multimesh_create();
 	set_base(multimesh);
@@ -0,0 +1,102 @@
+/*************************************************************************/
+/*  occluder_instance.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occluder_instance.h"
+
+void OccluderInstance::_update_occluder() {
+
+	PoolVector<Vector3> vertices;
+	PoolVector<int> indices;
+
+	if (mesh.is_valid()) {
+
+		PoolVector<Face3> faces = mesh->get_faces();
+		vertices.resize(faces.size() * 3);
+		indices.resize(faces.size() * 3);
+
+		PoolVector<Face3>::Read r = faces.read();
+		PoolVector<Vector3>::Write vw = vertices.write();
+		PoolVector<int>::Write iw = indices.write();
+
+		for (int i = 0; i < faces.size(); i++) {
+			for (int j = 0; j < 3; j++) {
+				vw[i * 3 + j] = r[i].vertex[j];
+				iw[i * 3 + j] = i * 3 + j;
+			}
+		}
+	}
+
+	VS::get_singleton()->occluder_set_mesh(occluder, vertices, indices);
+	update_gizmo();
+}
+
+void OccluderInstance::set_mesh(const Ref<Mesh> &p_mesh) {
+
+	mesh = p_mesh;
+	_update_occluder();
+}
+
+Ref<Mesh> OccluderInstance::get_mesh() const {
+
+	return mesh;
+}
+
+AABB OccluderInstance::get_aabb() const {
+
+	if (mesh.is_valid()) {
+		return mesh->get_aabb();
+	}
+
+	return AABB();
+}
+
+PoolVector<Face3> OccluderInstance::get_faces(uint32_t p_usage_flags) const {
+
+	return PoolVector<Face3>();
+}
+
+void OccluderInstance::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("set_mesh", "mesh"), &OccluderInstance::set_mesh);
+	ClassDB::bind_method(D_METHOD("get_mesh"), &OccluderInstance::get_mesh);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_mesh", "get_mesh");
+}
+
+OccluderInstance::OccluderInstance() {
+
+	occluder = VS::get_singleton()->occluder_create();
+	set_base(occluder);
+}
+
+OccluderInstance::~OccluderInstance() {
+
+	VS::get_singleton()->free(occluder);
+}
@@ -32,10 +32,26 @@
 
 #include "core/message_queue.h"
 
+#include "core/os/thread.h"
 #include "core/project_settings.h"
 #include "scene/3d/physics_body.h"
+#include "scene/main/scene_tree.h"
 #include "scene/resources/surface_tool.h"
 
+SelfList<Skeleton>::List Skeleton::dirty_list;
+Mutex *Skeleton::dirty_list_mutex = NULL;
+
+void Skeleton::init_dirty_list() {
+
+	dirty_list_mutex = Mutex::create();
+}
+
+void Skeleton::finish_dirty_list() {
+
+	memdelete(dirty_list_mutex);
+	dirty_list_mutex = NULL;
+}
+
 bool Skeleton::_set(const StringName &p_path, const Variant &p_value) {
 
 	String path = p_path;
@@ -210,116 +226,207 @@ void Skeleton::_notification(int p_what) {
 		} break;
 		case NOTIFICATION_UPDATE_SKELETON: {
 
-			VisualServer *vs = VisualServer::get_singleton();
-			Bone *bonesptr = bones.ptrw();
-			int len = bones.size();
+			if (dirty) {
+				_update_dirty_skeletons();
+			}
+		} break;
+	}
+}
 
-			vs->skeleton_allocate(skeleton, len); // if same size, nothing really happens
+void Skeleton::_evaluate_pose() {
 
-			_update_process_order();
+	Bone *bonesptr = bones.ptrw();
+	int len = bones.size();
 
-			const int *order = process_order.ptr();
+	_update_process_order();
 
-			// pose changed, rebuild cache of inverses
-			if (rest_global_inverse_dirty) {
+	const int *order = process_order.ptr();
 
-				// calculate global rests and invert them
-				for (int i = 0; i < len; i++) {
-					Bone &b = bonesptr[order[i]];
-					if (b.parent >= 0)
-						b.rest_global_inverse = bonesptr[b.parent].rest_global_inverse * b.rest;
-					else
-						b.rest_global_inverse = b.rest;
-				}
-				for (int i = 0; i < len; i++) {
-					Bone &b = bonesptr[order[i]];
-					b.rest_global_inverse.affine_invert();
-				}
+	if (bone_transforms.size() != len * 12) {
+		bone_transforms.resize(len * 12);
+	}
+	PoolVector<float>::Write w = bone_transforms.write();
+	float *dataptr = w.ptr();
 
-				rest_global_inverse_dirty = false;
-			}
+	// pose changed, rebuild cache of inverses
+	if (rest_global_inverse_dirty) {
 
-			for (int i = 0; i < len; i++) {
+		// calculate global rests and invert them
+		for (int i = 0; i < len; i++) {
+			Bone &b = bonesptr[order[i]];
+			if (b.parent >= 0)
+				b.rest_global_inverse = bonesptr[b.parent].rest_global_inverse * b.rest;
+			else
+				b.rest_global_inverse = b.rest;
+		}
+		for (int i = 0; i < len; i++) {
+			Bone &b = bonesptr[order[i]];
+			b.rest_global_inverse.affine_invert();
+		}
 
-				Bone &b = bonesptr[order[i]];
+		rest_global_inverse_dirty = false;
+	}
 
-				if (b.disable_rest) {
-					if (b.enabled) {
+	for (int i = 0; i < len; i++) {
 
-						Transform pose = b.pose;
-						if (b.custom_pose_enable) {
+		Bone &b = bonesptr[order[i]];
 
-							pose = b.custom_pose * pose;
-						}
+		if (b.disable_rest) {
+			if (b.enabled) {
 
-						if (b.parent >= 0) {
+				Transform pose = b.pose;
+				if (b.custom_pose_enable) {
 
-							b.pose_global = bonesptr[b.parent].pose_global * pose;
-						} else {
+					pose = b.custom_pose * pose;
+				}
 
-							b.pose_global = pose;
-						}
-					} else {
+				if (b.parent >= 0) {
 
-						if (b.parent >= 0) {
+					b.pose_global = bonesptr[b.parent].pose_global * pose;
+				} else {
 
-							b.pose_global = bonesptr[b.parent].pose_global;
-						} else {
+					b.pose_global = pose;
+				}
+			} else {
 
-							b.pose_global = Transform();
-						}
-					}
+				if (b.parent >= 0) {
 
+					b.pose_global = bonesptr[b.parent].pose_global;
 				} else {
-					if (b.enabled) {
-
-						Transform pose = b.pose;
-						if (b.custom_pose_enable) {
 
-							pose = b.custom_pose * pose;
-						}
+					b.pose_global = Transform();
+				}
+			}
 
-						if (b.parent >= 0) {
+		} else {
+			if (b.enabled) {
 
-							b.pose_global = bonesptr[b.parent].pose_global * (b.rest * pose);
-						} else {
+				Transform pose = b.pose;
+				if (b.custom_pose_enable) {
 
-							b.pose_global = b.rest * pose;
-						}
-					} else {
+					pose = b.custom_pose * pose;
+				}
 
-						if (b.parent >= 0) {
+				if (b.parent >= 0) {
 
-							b.pose_global = bonesptr[b.parent].pose_global * b.rest;
-						} else {
+					b.pose_global = bonesptr[b.parent].pose_global * (b.rest * pose);
+				} else {
 
-							b.pose_global = b.rest;
-						}
-					}
+					b.pose_global = b.rest * pose;
 				}
+			} else {
 
-				b.transform_final = b.pose_global * b.rest_global_inverse;
-				vs->skeleton_bone_set_transform(skeleton, order[i], b.transform_final);
+				if (b.parent >= 0) {
 
-				for (List<uint32_t>::Element *E = b.nodes_bound.front(); E; E = E->next()) {
+					b.pose_global = bonesptr[b.parent].pose_global * b.rest;
+				} else {
 
-					Object *obj = ObjectDB::get_instance(E->get());
-					ERR_CONTINUE(!obj);
-					Spatial *sp = Object::cast_to<Spatial>(obj);
-					ERR_CONTINUE(!sp);
-					sp->set_transform(b.pose_global);
+					b.pose_global = b.rest;
 				}
 			}
+		}
 
-			dirty = false;
-		} break;
+		b.transform_final = b.pose_global * b.rest_global_inverse;
+
+		const Transform &t = b.transform_final;
+		float *dst = &dataptr[order[i] * 12];
+		for (int j = 0; j < 3; j++) {
+			dst[j * 4 + 0] = t.basis.elements[j][0];
+			dst[j * 4 + 1] = t.basis.elements[j][1];
+			dst[j * 4 + 2] = t.basis.elements[j][2];
+			dst[j * 4 + 3] = t.origin[j];
+		}
+	}
+}
+
+void Skeleton::_apply_pose() {
+
+	VisualServer *vs = VisualServer::get_singleton();
+	int len = bones.size();
+
+	vs->skeleton_allocate(skeleton, len); // if same size, nothing really happens
+	vs->skeleton_set_bones_as_bulk_array(skeleton, bone_transforms);
+
+	const Bone *bonesptr = bones.ptr();
+	const int *order = process_order.ptr();
+
+	for (int i = 0; i < len; i++) {
+
+		const Bone &b = bonesptr[order[i]];
+
+		for (const List<uint32_t>::Element *E = b.nodes_bound.front(); E; E = E->next()) {
+
+			Object *obj = ObjectDB::get_instance(E->get());
+			ERR_CONTINUE(!obj);
+			Spatial *sp = Object::cast_to<Spatial>(obj);
+			ERR_CONTINUE(!sp);
+			sp->set_transform(b.pose_global);
+		}
+	}
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->lock();
+
+	if (dirty_item.in_list()) {
+		dirty_list.remove(&dirty_item);
+	}
+	dirty = false;
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->unlock();
+}
+
+void Skeleton::_update_skeleton() {
+
+	_evaluate_pose();
+	_apply_pose();
+}
+
+void Skeleton::_evaluate_dirty_skeleton(uint32_t p_index, Skeleton *const *p_skeletons) {
+
+	p_skeletons[p_index]->_evaluate_pose();
+}
+
+void Skeleton::_update_dirty_skeletons() {
+
+	// All skeletons that went dirty this frame are flushed together, so their poses can be
+	// evaluated in parallel. Uploading and moving bound nodes must stay on the calling thread.
+	Vector<Skeleton *> skeletons;
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->lock();
+
+	for (SelfList<Skeleton> *E = dirty_list.first(); E; E = E->next()) {
+		skeletons.push_back(E->self());
+	}
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->unlock();
+
+	if (skeletons.size() == 0) {
+		return;
+	}
+
+	SceneTree *tree = SceneTree::get_singleton();
+	bool threaded = skeletons.size() > 1 && tree && Thread::get_caller_id() == Thread::get_main_id() && !tree->get_work_pool()->is_working();
+
+	if (threaded) {
+		tree->get_work_pool()->do_work(skeletons.size(), skeletons[0], &Skeleton::_evaluate_dirty_skeleton, skeletons.ptr());
+	} else {
+		for (int i = 0; i < skeletons.size(); i++) {
+			skeletons[i]->_evaluate_pose();
+		}
+	}
+
+	for (int i = 0; i < skeletons.size(); i++) {
+		skeletons[i]->_apply_pose();
 	}
 }
 
 Transform Skeleton::get_bone_transform(int p_bone) const {
 	ERR_FAIL_INDEX_V(p_bone, bones.size(), Transform());
 	if (dirty)
-		const_cast<Skeleton *>(this)->notification(NOTIFICATION_UPDATE_SKELETON);
+		const_cast<Skeleton *>(this)->_update_skeleton();
 	return bones[p_bone].pose_global * bones[p_bone].rest_global_inverse;
 }
 
@@ -339,7 +446,7 @@ Transform Skeleton::get_bone_global_pose(int p_bone) const {
 
 	ERR_FAIL_INDEX_V(p_bone, bones.size(), Transform());
 	if (dirty)
-		const_cast<Skeleton *>(this)->notification(NOTIFICATION_UPDATE_SKELETON);
+		const_cast<Skeleton *>(this)->_update_skeleton();
 	return bones[p_bone].pose_global;
 }
 
@@ -573,8 +680,22 @@ void Skeleton::_make_dirty() {
 	if (dirty)
 		return;
 
-	MessageQueue::get_singleton()->push_notification(this, NOTIFICATION_UPDATE_SKELETON);
-	dirty = true;
+#ifdef DEBUG_ENABLED
+	_check_threaded_subtree_access();
+#endif
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->lock();
+
+	//checked again, another thread may have made it dirty meanwhile
+	if (!dirty) {
+		MessageQueue::get_singleton()->push_notification(this, NOTIFICATION_UPDATE_SKELETON);
+		dirty_list.add_last(&dirty_item);
+		dirty = true;
+	}
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->unlock();
 }
 
 int Skeleton::get_process_order(int p_idx) {
@@ -810,7 +931,8 @@ void Skeleton::_bind_methods() {
 	BIND_CONSTANT(NOTIFICATION_UPDATE_SKELETON);
 }
 
-Skeleton::Skeleton() {
+Skeleton::Skeleton() :
+		dirty_item(this) {
 
 	rest_global_inverse_dirty = true;
 	dirty = false;
@@ -821,5 +943,16 @@ Skeleton::Skeleton() {
 }
 
 Skeleton::~Skeleton() {
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->lock();
+
+	if (dirty_item.in_list()) {
+		dirty_list.remove(&dirty_item);
+	}
+
+	if (dirty_list_mutex)
+		dirty_list_mutex->unlock();
+
 	VisualServer::get_singleton()->free(skeleton);
 }
@@ -31,7 +31,9 @@
 #ifndef SKELETON_H
 #define SKELETON_H
 
+#include "core/os/mutex.h"
 #include "core/rid.h"
+#include "core/self_list.h"
 #include "scene/3d/spatial.h"
 
 /**
@@ -102,6 +104,19 @@ class Skeleton : public Spatial {
 	bool dirty;
 	bool use_bones_in_world_transform;
 
+	//final bone transforms, 12 floats per bone as uploaded to the visual server
+	PoolVector<float> bone_transforms;
+
+	SelfList<Skeleton> dirty_item;
+	static SelfList<Skeleton>::List dirty_list;
+	static Mutex *dirty_list_mutex; //skeletons can be posed from threaded process callbacks
+
+	void _evaluate_pose(); // only touches this skeleton, safe to run in a worker thread
+	void _apply_pose();
+	void _update_skeleton();
+	void _evaluate_dirty_skeleton(uint32_t p_index, Skeleton *const *p_skeletons);
+	static void _update_dirty_skeletons();
+
 	// bind helpers
 	Array _get_bound_child_nodes_to_bone(int p_bone) const {
 
@@ -131,6 +146,9 @@ public:
 		NOTIFICATION_UPDATE_SKELETON = 50
 	};
 
+	static void init_dirty_list();
+	static void finish_dirty_list();
+
 	RID get_skeleton() const;
 
 	// skeleton creation api
@@ -32,6 +32,7 @@
 
 #include "core/engine.h"
 #include "core/message_queue.h"
+#include "core/os/thread.h"
 #include "scene/main/scene_tree.h"
 #include "scene/main/viewport.h"
 #include "scene/scene_string_names.h"
@@ -90,35 +91,172 @@ void Spatial::_update_local_transform() const {
 
 	data.dirty &= ~DIRTY_LOCAL;
 }
+void Spatial::_propagate_global_dirty() {
+
+	if (data.dirty & DIRTY_GLOBAL) {
+		return; //children of a dirty node are always dirty too
+	}
+
+	data.dirty |= DIRTY_GLOBAL;
+
+	for (List<Spatial *>::Element *E = data.children.front(); E; E = E->next()) {
+
+		if (E->get()->data.toplevel_active)
+			continue; //don't propagate to a toplevel
+		E->get()->_propagate_global_dirty();
+	}
+}
+
 void Spatial::_propagate_transform_changed(Spatial *p_origin) {
 
 	if (!is_inside_tree()) {
 		return;
 	}
 
-	/*
-	if (data.dirty&DIRTY_GLOBAL)
-		return; //already dirty
-	*/
+	//dirty flags are enough to keep reads correct, notifying the subtree and
+	//updating its global transforms is left to the tree, once per flush
+#ifdef DEBUG_ENABLED
+	_check_threaded_subtree_access();
+#endif
 
-	data.children_lock++;
+	_propagate_global_dirty();
 
-	for (List<Spatial *>::Element *E = data.children.front(); E; E = E->next()) {
+	MutexLock lock(get_tree()->_get_xform_list_lock());
 
-		if (E->get()->data.toplevel_active)
-			continue; //don't propagate to a toplevel
-		E->get()->_propagate_transform_changed(p_origin);
+	//ignoring notifications only lasts around the change (physics bodies syncing their state),
+	//so whether this change notifies is decided now, not when the tree flushes
+	if (!xform_dirty.in_list()) {
+		data.ignore_pending_notification = data.ignore_notification;
+		get_tree()->xform_dirty_list.add(&xform_dirty);
+	} else if (!data.ignore_notification) {
+		data.ignore_pending_notification = false;
+	}
+}
+
+void Spatial::TransformUpdate::update_subtree(uint32_t p_index, void *p_userdata) {
+
+	int from = subtrees[p_index];
+	int to = subtrees[p_index + 1];
+
+	for (int i = from; i < to; i++) {
+
+		Spatial *s = nodes[i];
+
+		if (!(s->data.dirty & DIRTY_GLOBAL)) {
+			continue; //was read after the change, so it's up to date
+		}
+
+		if (s->data.dirty & DIRTY_LOCAL) {
+			s->_update_local_transform();
+		}
+
+		if (parents[i] < 0) {
+			s->data.global_transform = root_parent_xforms[p_index] * s->data.local_transform;
+		} else {
+			s->data.global_transform = nodes[parents[i]]->data.global_transform * s->data.local_transform;
+		}
+
+		if (s->data.disable_scale) {
+			s->data.global_transform.basis.orthonormalize();
+		}
+
+		s->data.dirty &= ~DIRTY_GLOBAL;
 	}
+}
+
+void Spatial::_flush_dirty_transforms(SceneTree *p_tree) {
+
+	TransformUpdate update;
+	Vector<Spatial *> roots;
+
+	//subtrees inside another changed subtree are updated along with it
+	for (SelfList<Node> *n = p_tree->xform_dirty_list.first(); n; n = n->next()) {
+
+		Spatial *root = static_cast<Spatial *>(n->self());
+
+		bool nested = false;
+		for (const Spatial *p = root; p->data.parent && !p->data.toplevel_active; p = p->data.parent) {
+			if (p->data.parent->xform_dirty.in_list()) {
+				nested = true;
+				break;
+			}
+		}
+
+		if (nested) {
+			continue;
+		}
+
+		Transform parent_xform;
+		if (root->data.parent && !root->data.toplevel_active) {
+			parent_xform = root->data.parent->get_global_transform();
+		}
+
+		roots.push_back(root);
+		update.root_parent_xforms.push_back(parent_xform);
+	}
+
+	while (p_tree->xform_dirty_list.first()) {
+		p_tree->xform_dirty_list.remove(p_tree->xform_dirty_list.first());
+	}
+
+	for (int i = 0; i < roots.size(); i++) {
+
+		int begin = update.nodes.size();
+		update.subtrees.push_back(begin);
+		update.nodes.push_back(roots[i]);
+		update.parents.push_back(-1);
+
+		for (int j = begin; j < update.nodes.size(); j++) {
+
+			const Spatial *s = update.nodes[j];
+			for (const List<Spatial *>::Element *E = s->data.children.front(); E; E = E->next()) {
+
+				if (E->get()->data.toplevel_active)
+					continue; //don't propagate to a toplevel
+				update.nodes.push_back(E->get());
+				update.parents.push_back(j);
+			}
+		}
+	}
+	update.subtrees.push_back(update.nodes.size());
+
+	int subtree_count = roots.size();
+
+	//subtrees don't share nodes, so they can be updated in parallel
+	ThreadWorkPool *pool = NULL;
+	if (subtree_count > 1 && update.nodes.size() >= TRANSFORM_UPDATE_THREAD_MIN_NODES && Thread::get_caller_id() == Thread::get_main_id()) {
+		pool = p_tree->get_work_pool();
+		if (pool->is_working()) {
+			pool = NULL; //already inside a job, don't nest
+		}
+	}
+
+	if (pool) {
+		pool->do_work(subtree_count, &update, &TransformUpdate::update_subtree, (void *)NULL);
+	} else {
+		for (int i = 0; i < subtree_count; i++) {
+			update.update_subtree(i, NULL);
+		}
+	}
+
+	//notification list is sent front to back, queue in reverse so parents go first
+	for (int i = update.nodes.size() - 1; i >= 0; i--) {
+
+		Spatial *s = update.nodes[i];
+
+		//nodes below a root were moved by it, so only the roots can skip their notification
+		if (update.parents[i] < 0 && s->data.ignore_pending_notification) {
+			continue;
+		}
+
 #ifdef TOOLS_ENABLED
-	if ((data.gizmo.is_valid() || data.notify_transform) && !data.ignore_notification && !xform_change.in_list()) {
+		if ((s->data.gizmo.is_valid() || s->data.notify_transform) && !s->xform_change.in_list()) {
 #else
-	if (data.notify_transform && !data.ignore_notification && !xform_change.in_list()) {
+		if (s->data.notify_transform && !s->xform_change.in_list()) {
 #endif
-		get_tree()->xform_change_list.add(&xform_change);
+			p_tree->xform_change_list.add(&s->xform_change);
+		}
 	}
-	data.dirty |= DIRTY_GLOBAL;
-
-	data.children_lock--;
 }
 
 void Spatial::_notification(int p_what) {
@@ -155,6 +293,8 @@ void Spatial::_notification(int p_what) {
 			notification(NOTIFICATION_EXIT_WORLD, true);
 			if (xform_change.in_list())
 				get_tree()->xform_change_list.remove(&xform_change);
+			if (xform_dirty.in_list())
+				get_tree()->xform_dirty_list.remove(&xform_dirty);
 			if (data.C)
 				data.parent->data.children.erase(data.C);
 			data.parent = NULL;
@@ -726,10 +866,22 @@ bool Spatial::is_local_transform_notification_enabled() const {
 
 void Spatial::force_update_transform() {
 	ERR_FAIL_COND(!is_inside_tree());
-	if (!xform_change.in_list()) {
-		return; //nothing to update
+	if (xform_change.in_list()) {
+		get_tree()->xform_change_list.remove(&xform_change);
+	} else {
+		//changes to this node or its parents may still be waiting for the next flush
+		bool pending = false;
+		for (const Spatial *p = this; p; p = p->data.toplevel_active ? NULL : p->data.parent) {
+			if (p->xform_dirty.in_list()) {
+				pending = true;
+				break;
+			}
+		}
+
+		if (!pending) {
+			return; //nothing to update
+		}
 	}
-	get_tree()->xform_change_list.remove(&xform_change);
 
 	notification(NOTIFICATION_TRANSFORM_CHANGED);
 }
@@ -818,12 +970,14 @@ void Spatial::_bind_methods() {
 }
 
 Spatial::Spatial() :
-		xform_change(this) {
+		xform_change(this),
+		xform_dirty(this) {
 
 	data.dirty = DIRTY_NONE;
 	data.children_lock = 0;
 
 	data.ignore_notification = false;
+	data.ignore_pending_notification = false;
 	data.toplevel = false;
 	data.toplevel_active = false;
 	data.scale = Vector3(1, 1, 1);
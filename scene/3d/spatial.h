@@ -66,6 +66,22 @@ class Spatial : public Node {
 	};
 
 	mutable SelfList<Node> xform_change;
+	SelfList<Node> xform_dirty;
+
+	enum {
+		TRANSFORM_UPDATE_THREAD_MIN_NODES = 1024
+	};
+
+	//changed subtrees flattened in depth order, a parent always comes before its children
+	struct TransformUpdate {
+
+		Vector<Spatial *> nodes;
+		Vector<int> parents; //index in nodes, -1 for subtree roots
+		Vector<int> subtrees; //first node of each subtree, plus the end
+		Vector<Transform> root_parent_xforms;
+
+		void update_subtree(uint32_t p_index, void *p_userdata);
+	};
 
 	struct Data {
 
@@ -88,6 +104,7 @@ class Spatial : public Node {
 		List<Spatial *>::Element *C;
 
 		bool ignore_notification;
+		bool ignore_pending_notification; //every change waiting for the flush was made while ignoring notifications
 		bool notify_local_transform;
 		bool notify_transform;
 
@@ -104,6 +121,7 @@ class Spatial : public Node {
 
 	void _update_gizmo();
 	void _notify_dirty();
+	void _propagate_global_dirty();
 	void _propagate_transform_changed(Spatial *p_origin);
 
 	void _propagate_visibility_changed();
@@ -126,6 +144,8 @@ public:
 		NOTIFICATION_LOCAL_TRANSFORM_CHANGED = 44,
 	};
 
+	static void _flush_dirty_transforms(SceneTree *p_tree);
+
 	Spatial *get_parent_spatial() const;
 
 	Ref<World> get_world() const;
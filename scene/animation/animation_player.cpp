@@ -333,7 +333,7 @@ void AnimationPlayer::_ensure_node_caches(AnimationData *p_anim) {
 	}
 }
 
-void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float p_time, float p_delta, float p_interp, bool p_is_current, bool p_seeked, bool p_started) {
+void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, Vector<int> &r_key_cursors, float p_time, float p_delta, float p_interp, bool p_is_current, bool p_seeked, bool p_started) {
 
 	_ensure_node_caches(p_anim);
 	ERR_FAIL_COND(p_anim->node_cache.size() != p_anim->animation->get_track_count());
@@ -341,6 +341,13 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 	Animation *a = p_anim->animation.operator->();
 	bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
 
+	if (r_key_cursors.size() != a->get_track_count()) {
+		r_key_cursors.resize(a->get_track_count());
+		for (int i = 0; i < r_key_cursors.size(); i++) {
+			r_key_cursors.write[i] = 0;
+		}
+	}
+
 	for (int i = 0; i < a->get_track_count(); i++) {
 
 		// If an animation changes this animation (or it animates itself)
@@ -371,7 +378,9 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, float
 				Quat rot;
 				Vector3 scale;
 
-				Error err = a->transform_track_interpolate(i, p_time, &loc, &rot, &scale);
+				// the track count may change while processing, if the animation animates itself
+				int *key_cursor = i < r_key_cursors.size() ? &r_key_cursors.write[i] : NULL;
+				Error err = a->transform_track_interpolate(i, p_time, &loc, &rot, &scale, key_cursor);
 				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
 				if (err != OK)
@@ -799,7 +808,7 @@ void AnimationPlayer::_animation_process_data(PlaybackData &cd, float p_delta, f
 
 	cd.pos = next_pos;
 
-	_animation_process_animation(cd.from, cd.pos, delta, p_blend, &cd == &playback.current, p_seeked, p_started);
+	_animation_process_animation(cd.from, cd.key_cursors, cd.pos, delta, p_blend, &cd == &playback.current, p_seeked, p_started);
 }
 void AnimationPlayer::_animation_process2(float p_delta, bool p_started) {
 
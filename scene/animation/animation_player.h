@@ -207,6 +207,7 @@ private:
 		AnimationData *from;
 		float pos;
 		float speed_scale;
+		Vector<int> key_cursors; // one per track, speeds up key lookups while playing forward
 
 		PlaybackData() {
 
@@ -251,7 +252,7 @@ private:
 
 	NodePath root;
 
-	void _animation_process_animation(AnimationData *p_anim, float p_time, float p_delta, float p_interp, bool p_is_current = true, bool p_seeked = false, bool p_started = false);
+	void _animation_process_animation(AnimationData *p_anim, Vector<int> &r_key_cursors, float p_time, float p_delta, float p_interp, bool p_is_current = true, bool p_seeked = false, bool p_started = false);
 
 	void _ensure_node_caches(AnimationData *p_anim);
 	void _animation_process_data(PlaybackData &cd, float p_delta, float p_blend, bool p_seeked, bool p_started);
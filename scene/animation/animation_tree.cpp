@@ -108,9 +108,23 @@ void AnimationNode::blend_animation(const StringName &p_animation, float p_time,
 
 	ERR_FAIL_COND(!animation.is_valid());
 
+	bool any_valid = false;
+	const float *blendr = blends.ptr();
+	for (int i = 0; i < blends.size(); i++) {
+		if (blendr[i] > CMP_EPSILON) {
+			any_valid = true;
+			break;
+		}
+	}
+
+	if (!any_valid) {
+		return; //no track would be blended, so don't even sample it
+	}
+
 	AnimationState anim_state;
 	anim_state.blend = p_blend;
 	anim_state.track_blends = &blends;
+	anim_state.key_cursors = &key_cursors;
 	anim_state.delta = p_delta;
 	anim_state.time = p_time;
 	anim_state.animation = animation;
@@ -281,21 +295,38 @@ float AnimationNode::_blend_node(const StringName &p_subpath, const Vector<Strin
 	if (!p_seek && p_optimize && !any_valid) //pointless to go on, all are zero
 		return 0;
 
-	String new_path;
+	StringName new_path;
 	AnimationNode *new_parent;
 
-	//this is the slowest part of processing, but as strings process in powers of 2, and the paths always exist, it will not result in that many allocations
 	if (p_new_parent) {
 		new_parent = p_new_parent;
-		new_path = String(base_path) + String(p_subpath) + "/";
+		new_path = _get_child_path(p_subpath);
 	} else {
 		ERR_FAIL_COND_V(!parent, 0);
 		new_parent = parent;
-		new_path = String(parent->base_path) + String(p_subpath) + "/";
+		new_path = parent->_get_child_path(p_subpath);
 	}
 	return p_node->_pre_process(new_path, new_parent, state, p_time, p_seek, p_connections);
 }
 
+StringName AnimationNode::_get_child_path(const StringName &p_subpath) {
+
+	if (child_path_base != base_path) {
+		child_paths.clear();
+		child_path_base = base_path;
+	}
+
+	const StringName *path = child_paths.getptr(p_subpath);
+	if (path) {
+		return *path;
+	}
+
+	//building paths from strings is the slowest part of processing, so only do it once per child
+	StringName new_path = String(base_path) + String(p_subpath) + "/";
+	child_paths[p_subpath] = new_path;
+	return new_path;
+}
+
 int AnimationNode::get_input_count() const {
 
 	return inputs.size();
@@ -716,16 +747,36 @@ bool AnimationTree::_update_caches(AnimationPlayer *player) {
 	}
 
 	state.track_map.clear();
+	track_array.resize(track_cache.size());
+	animation_track_indices.clear();
 
 	K = NULL;
 	int idx = 0;
+	xform_count = 0;
 	while ((K = track_cache.next(K))) {
+		TrackCache *tc = track_cache[*K];
+		tc->blend_idx = idx;
+		if (tc->type == Animation::TYPE_TRANSFORM) {
+			static_cast<TrackCacheTransform *>(tc)->xform_idx = xform_count++;
+		}
+		track_array.write[idx] = tc;
 		state.track_map[*K] = idx;
 		idx++;
 	}
 
 	state.track_count = idx;
 
+	xform_loc.resize(xform_count);
+	xform_rot.resize(xform_count);
+	xform_rot_accum.resize(xform_count);
+	xform_scale.resize(xform_count);
+
+	sample_xform.resize(xform_count);
+	sample_blend.resize(xform_count);
+	sample_loc.resize(xform_count);
+	sample_rot.resize(xform_count);
+	sample_scale.resize(xform_count);
+
 	cache_valid = true;
 
 	return true;
@@ -740,9 +791,77 @@ void AnimationTree::_clear_caches() {
 	playing_caches.clear();
 
 	track_cache.clear();
+	track_array.clear();
+	animation_track_indices.clear();
 	cache_valid = false;
 }
 
+const int *AnimationTree::_get_animation_track_indices(const Ref<Animation> &p_animation) {
+
+	AnimationTrackIndices *ati = animation_track_indices.getptr(p_animation->get_instance_id());
+
+	if (!ati || ati->setup_pass != setup_pass || ati->indices.size() != p_animation->get_track_count()) {
+
+		if (!ati) {
+			animation_track_indices[p_animation->get_instance_id()] = AnimationTrackIndices();
+			ati = animation_track_indices.getptr(p_animation->get_instance_id());
+		}
+
+		ati->setup_pass = setup_pass;
+		ati->indices.resize(p_animation->get_track_count());
+
+		for (int i = 0; i < p_animation->get_track_count(); i++) {
+
+			int *idx = state.track_map.getptr(p_animation->track_get_path(i));
+			if (!idx || track_array[*idx]->type != p_animation->track_get_type(i)) {
+				ati->indices.write[i] = -1; //unresolved, or type mismatch (may happen, should not)
+			} else {
+				ati->indices.write[i] = *idx;
+			}
+		}
+	}
+
+	return ati->indices.ptr();
+}
+
+void AnimationTree::_blend_transform_samples(int p_count) {
+
+	const int *target = sample_xform.ptr();
+	const float *blend = sample_blend.ptr();
+	const Vector3 *sloc = sample_loc.ptr();
+	const Quat *srot = sample_rot.ptr();
+	const Vector3 *sscale = sample_scale.ptr();
+
+	Vector3 *loc = xform_loc.ptrw();
+	Quat *rot = xform_rot.ptrw();
+	float *rot_accum = xform_rot_accum.ptrw();
+	Vector3 *scale = xform_scale.ptrw();
+
+	//lerps are kept in separate, branchless loops so they can be vectorized
+
+	for (int i = 0; i < p_count; i++) {
+		Vector3 &l = loc[target[i]];
+		l += (sloc[i] - l) * blend[i];
+	}
+
+	for (int i = 0; i < p_count; i++) {
+		Vector3 &s = scale[target[i]];
+		s += (sscale[i] - s) * blend[i];
+	}
+
+	for (int i = 0; i < p_count; i++) {
+		int x = target[i];
+		if (rot_accum[x] == 0) {
+			rot[x] = srot[i];
+			rot_accum[x] = blend[i];
+		} else {
+			float rot_total = rot_accum[x] + blend[i];
+			rot[x] = srot[i].slerp(rot[x], rot_accum[x] / rot_total).normalized();
+			rot_accum[x] = rot_total;
+		}
+	}
+}
+
 void AnimationTree::_process_graph(float p_delta) {
 
 	_update_properties(); //if properties need updating, update them
@@ -845,6 +964,16 @@ void AnimationTree::_process_graph(float p_delta) {
 
 		bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
 
+		int root_motion_idx = -1;
+		if (!root_motion_track.is_empty() && state.track_map.has(root_motion_track)) {
+			root_motion_idx = state.track_map[root_motion_track];
+		}
+
+		Vector3 *xform_locw = xform_loc.ptrw();
+		Quat *xform_rotw = xform_rot.ptrw();
+		float *xform_rot_accumw = xform_rot_accum.ptrw();
+		Vector3 *xform_scalew = xform_scale.ptrw();
+
 		for (List<AnimationNode::AnimationState>::Element *E = state.animation_states.front(); E; E = E->next()) {
 
 			const AnimationNode::AnimationState &as = E->get();
@@ -854,42 +983,68 @@ void AnimationTree::_process_graph(float p_delta) {
 			float delta = as.delta;
 			bool seeked = as.seeked;
 
-			for (int i = 0; i < a->get_track_count(); i++) {
-
-				NodePath path = a->track_get_path(i);
-
-				ERR_CONTINUE(!track_cache.has(path));
+			if (sample_xform.size() < a->get_track_count()) {
+				//more tracks than transform caches, can only happen with repeated paths
+				sample_xform.resize(a->get_track_count());
+				sample_blend.resize(a->get_track_count());
+				sample_loc.resize(a->get_track_count());
+				sample_rot.resize(a->get_track_count());
+				sample_scale.resize(a->get_track_count());
+			}
 
-				TrackCache *track = track_cache[path];
-				if (track->type != a->track_get_type(i)) {
-					continue; //may happen should not
+			int *sample_xformw = sample_xform.ptrw();
+			float *sample_blendw = sample_blend.ptrw();
+			Vector3 *sample_locw = sample_loc.ptrw();
+			Quat *sample_rotw = sample_rot.ptrw();
+			Vector3 *sample_scalew = sample_scale.ptrw();
+
+			const int *track_indices = _get_animation_track_indices(a);
+			const float *track_blends = as.track_blends->ptr();
+			int sample_count = 0;
+
+			int *key_cursors = NULL;
+			if (as.key_cursors) {
+				if (as.key_cursors->size() != a->get_track_count()) {
+					as.key_cursors->resize(a->get_track_count());
+					for (int i = 0; i < a->get_track_count(); i++) {
+						as.key_cursors->write[i] = 0;
+					}
 				}
+				key_cursors = as.key_cursors->ptrw();
+			}
 
-				track->root_motion = root_motion_track == path;
+			for (int i = 0; i < a->get_track_count(); i++) {
 
-				ERR_CONTINUE(!state.track_map.has(path));
-				int blend_idx = state.track_map[path];
+				int blend_idx = track_indices[i];
+				if (blend_idx < 0) {
+					continue; //track could not be resolved
+				}
 
-				ERR_CONTINUE(blend_idx < 0 || blend_idx >= state.track_count);
+				ERR_CONTINUE(blend_idx >= state.track_count);
 
-				float blend = (*as.track_blends)[blend_idx];
+				float blend = track_blends[blend_idx];
 
 				if (blend < CMP_EPSILON)
 					continue; //nothing to blend
 
+				TrackCache *track = track_array[blend_idx];
+
+				track->root_motion = blend_idx == root_motion_idx;
+
 				switch (track->type) {
 
 					case Animation::TYPE_TRANSFORM: {
 
 						TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
+						int x = t->xform_idx;
 
 						if (t->process_pass != process_pass) {
 
 							t->process_pass = process_pass;
-							t->loc = Vector3();
-							t->rot = Quat();
-							t->rot_blend_accum = 0;
-							t->scale = Vector3();
+							xform_locw[x] = Vector3();
+							xform_rotw[x] = Quat();
+							xform_rot_accumw[x] = 0;
+							xform_scalew[x] = Vector3();
 						}
 
 						if (track->root_motion) {
@@ -916,10 +1071,10 @@ void AnimationTree::_process_graph(float p_delta) {
 
 								a->transform_track_interpolate(i, a->get_length(), &loc[1], &rot[1], &scale[1]);
 
-								t->loc += (loc[1] - loc[0]) * blend;
-								t->scale += (scale[1] - scale[0]) * blend;
+								xform_locw[x] += (loc[1] - loc[0]) * blend;
+								xform_scalew[x] += (scale[1] - scale[0]) * blend;
 								Quat q = Quat().slerp(rot[0].normalized().inverse() * rot[1].normalized(), blend).normalized();
-								t->rot = (t->rot * q).normalized();
+								xform_rotw[x] = (xform_rotw[x] * q).normalized();
 
 								prev_time = 0;
 							}
@@ -931,36 +1086,26 @@ void AnimationTree::_process_graph(float p_delta) {
 
 							a->transform_track_interpolate(i, time, &loc[1], &rot[1], &scale[1]);
 
-							t->loc += (loc[1] - loc[0]) * blend;
-							t->scale += (scale[1] - scale[0]) * blend;
+							xform_locw[x] += (loc[1] - loc[0]) * blend;
+							xform_scalew[x] += (scale[1] - scale[0]) * blend;
 							Quat q = Quat().slerp(rot[0].normalized().inverse() * rot[1].normalized(), blend).normalized();
-							t->rot = (t->rot * q).normalized();
+							xform_rotw[x] = (xform_rotw[x] * q).normalized();
 
 							prev_time = 0;
 
 						} else {
-							Vector3 loc;
-							Quat rot;
-							Vector3 scale;
 
-							Error err = a->transform_track_interpolate(i, time, &loc, &rot, &scale);
+							//only sample here, blending happens for all transform tracks of this animation at once
+							Error err = a->transform_track_interpolate(i, time, &sample_locw[sample_count], &sample_rotw[sample_count], &sample_scalew[sample_count], key_cursors ? &key_cursors[i] : NULL);
 							//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
-							scale -= Vector3(1.0, 1.0, 1.0); //helps make it work properly with Add nodes
-
 							if (err != OK)
 								continue;
 
-							t->loc = t->loc.linear_interpolate(loc, blend);
-							if (t->rot_blend_accum == 0) {
-								t->rot = rot;
-								t->rot_blend_accum = blend;
-							} else {
-								float rot_total = t->rot_blend_accum + blend;
-								t->rot = rot.slerp(t->rot, t->rot_blend_accum / rot_total).normalized();
-								t->rot_blend_accum = rot_total;
-							}
-							t->scale = t->scale.linear_interpolate(scale, blend);
+							sample_scalew[sample_count] -= Vector3(1.0, 1.0, 1.0); //helps make it work properly with Add nodes
+							sample_xformw[sample_count] = x;
+							sample_blendw[sample_count] = blend;
+							sample_count++;
 						}
 
 					} break;
@@ -1213,14 +1358,19 @@ void AnimationTree::_process_graph(float p_delta) {
 					} break;
 				}
 			}
+
+			_blend_transform_samples(sample_count);
 		}
 	}
 
 	{
 		// finally, set the tracks
-		const NodePath *K = NULL;
-		while ((K = track_cache.next(K))) {
-			TrackCache *track = track_cache[*K];
+		const Vector3 *xform_locr = xform_loc.ptr();
+		const Quat *xform_rotr = xform_rot.ptr();
+		const Vector3 *xform_scaler = xform_scale.ptr();
+
+		for (int i = 0; i < track_array.size(); i++) {
+			TrackCache *track = track_array[i];
 			if (track->process_pass != process_pass)
 				continue; //not processed, ignore
 
@@ -1231,11 +1381,11 @@ void AnimationTree::_process_graph(float p_delta) {
 					TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
 
 					Transform xform;
-					xform.origin = t->loc;
+					xform.origin = xform_locr[t->xform_idx];
 
-					t->scale += Vector3(1.0, 1.0, 1.0); //helps make it work properly with Add nodes and root motion
+					Vector3 scale = xform_scaler[t->xform_idx] + Vector3(1.0, 1.0, 1.0); //helps make it work properly with Add nodes and root motion
 
-					xform.basis.set_quat_scale(t->rot, t->scale);
+					xform.basis.set_quat_scale(xform_rotr[t->xform_idx], scale);
 
 					if (t->root_motion) {
 
@@ -1567,6 +1717,7 @@ AnimationTree::AnimationTree() {
 	active = false;
 	cache_valid = false;
 	setup_pass = 1;
+	xform_count = 0;
 	started = true;
 	properties_dirty = true;
 	last_animation_player = 0;
@@ -67,6 +67,7 @@ public:
 		float time;
 		float delta;
 		const Vector<float> *track_blends;
+		Vector<int> *key_cursors;
 		float blend;
 		bool seeked;
 	};
@@ -84,6 +85,7 @@ public:
 	};
 
 	Vector<float> blends;
+	Vector<int> key_cursors;
 	State *state;
 
 	float _pre_process(const StringName &p_base_path, AnimationNode *p_parent, State *p_state, float p_time, bool p_seek, const Vector<StringName> &p_connections);
@@ -94,6 +96,11 @@ public:
 	Vector<StringName> connections;
 	AnimationNode *parent;
 
+	//child paths are rebuilt only when the base path changes, not every frame
+	StringName child_path_base;
+	HashMap<StringName, StringName> child_paths;
+	StringName _get_child_path(const StringName &p_subpath);
+
 	HashMap<NodePath, bool> filter;
 	bool filter_enabled;
 
@@ -173,6 +180,7 @@ private:
 	struct TrackCache {
 
 		bool root_motion;
+		int blend_idx;
 		uint64_t setup_pass;
 		uint64_t process_pass;
 		Animation::TrackType type;
@@ -181,6 +189,7 @@ private:
 
 		TrackCache() {
 			root_motion = false;
+			blend_idx = -1;
 			setup_pass = 0;
 			process_pass = 0;
 			object = NULL;
@@ -193,15 +202,13 @@ private:
 		Spatial *spatial;
 		Skeleton *skeleton;
 		int bone_idx;
-		Vector3 loc;
-		Quat rot;
-		float rot_blend_accum;
-		Vector3 scale;
+		int xform_idx;
 
 		TrackCacheTransform() {
 			type = Animation::TYPE_TRANSFORM;
 			spatial = NULL;
 			bone_idx = -1;
+			xform_idx = -1;
 			skeleton = NULL;
 		}
 	};
@@ -253,8 +260,33 @@ private:
 	};
 
 	HashMap<NodePath, TrackCache *> track_cache;
+	Vector<TrackCache *> track_array; //same caches, indexed by blend index
 	Set<TrackCache *> playing_caches;
 
+	//animation track -> blend index, resolved once instead of looking up paths every frame
+	struct AnimationTrackIndices {
+		uint64_t setup_pass;
+		Vector<int> indices;
+	};
+
+	HashMap<ObjectID, AnimationTrackIndices> animation_track_indices;
+	const int *_get_animation_track_indices(const Ref<Animation> &p_animation);
+
+	//blended transforms, one array per component indexed by TrackCacheTransform::xform_idx
+	int xform_count;
+	Vector<Vector3> xform_loc;
+	Vector<Quat> xform_rot;
+	Vector<float> xform_rot_accum;
+	Vector<Vector3> xform_scale;
+
+	//transforms sampled from the animation being blended, applied in one pass
+	Vector<int> sample_xform;
+	Vector<float> sample_blend;
+	Vector<Vector3> sample_loc;
+	Vector<Quat> sample_rot;
+	Vector<Vector3> sample_scale;
+	void _blend_transform_samples(int p_count);
+
 	Ref<AnimationNode> root;
 
 	AnimationProcessMode process_mode;
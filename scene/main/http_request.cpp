@@ -35,9 +35,33 @@ void HTTPRequest::_redirect_request(const String &p_new_url) {
 
 Error HTTPRequest::_request() {
 
+	// Reuse the connection a previous request kept alive, if it goes to the same server
+	reused_connection = keep_alive && client->get_status() == HTTPClient::STATUS_CONNECTED && url == connected_host && port == connected_port && use_ssl == connected_ssl;
+	if (reused_connection)
+		return OK;
+
+	connected_host = url;
+	connected_port = port;
+	connected_ssl = use_ssl;
 	return client->connect_to_host(url, port, use_ssl, validate_ssl);
 }
 
+bool HTTPRequest::_retry_reused_connection() {
+
+	// The server may have closed a kept alive connection while it was idle,
+	// that is only noticed once the request fails. Connect again, once.
+	if (!reused_connection || got_response)
+		return false;
+
+	// Once sent, the server may have acted on it already, only repeat what is safe to.
+	if (request_sent && (method == HTTPClient::METHOD_POST || method == HTTPClient::METHOD_PATCH || method == HTTPClient::METHOD_CONNECT))
+		return false;
+
+	client->close();
+	request_sent = false;
+	return _request() == OK;
+}
+
 Error HTTPRequest::_parse_url(const String &p_url) {
 
 	url = p_url;
@@ -51,6 +75,8 @@ Error HTTPRequest::_parse_url(const String &p_url) {
 	body.resize(0);
 	downloaded = 0;
 	redirections = 0;
+	chunk_buffered = 0;
+	response_keep_alive = false;
 
 	String url_lower = url.to_lower();
 	if (url_lower.begins_with("http://")) {
@@ -106,6 +132,19 @@ Error HTTPRequest::request(const String &p_url, const Vector<String> &p_custom_h
 
 	headers = p_custom_headers;
 
+	resume_offset = 0;
+	if (resume_download && download_to_file != String()) {
+		FileAccess *f = FileAccess::open(download_to_file, FileAccess::READ);
+		if (f) {
+			resume_offset = f->get_len();
+			memdelete(f);
+		}
+		if (resume_offset > 0) {
+			// Only ask for what is missing, it is appended if the server agrees
+			headers.push_back("Range: bytes=" + itos(resume_offset) + "-");
+		}
+	}
+
 	request_data = p_request_data;
 
 	requesting = true;
@@ -153,6 +192,11 @@ void HTTPRequest::_thread_func(void *p_userdata) {
 
 void HTTPRequest::cancel_request() {
 
+	_finish_request(false);
+}
+
+void HTTPRequest::_finish_request(bool p_keep_connection) {
+
 	if (!requesting)
 		return;
 
@@ -169,8 +213,11 @@ void HTTPRequest::cancel_request() {
 		memdelete(file);
 		file = NULL;
 	}
-	client->close();
+	if (!p_keep_connection || client->get_status() != HTTPClient::STATUS_CONNECTED) {
+		client->close();
+	}
 	body.resize(0);
+	chunk_buffered = 0;
 	got_response = false;
 	response_code = -1;
 	request_sent = false;
@@ -191,8 +238,12 @@ bool HTTPRequest::_handle_response(bool *ret_value) {
 	client->get_response_headers(&rheaders);
 	response_headers.resize(0);
 	downloaded = 0;
+	response_keep_alive = true;
 	for (List<String>::Element *E = rheaders.front(); E; E = E->next()) {
 		response_headers.push_back(E->get());
+		if (E->get().to_lower().begins_with("connection: close")) {
+			response_keep_alive = false;
+		}
 	}
 
 	if (response_code == 301 || response_code == 302) {
@@ -246,6 +297,8 @@ bool HTTPRequest::_update_connection() {
 
 	switch (client->get_status()) {
 		case HTTPClient::STATUS_DISCONNECTED: {
+			if (_retry_reused_connection())
+				return false;
 			call_deferred("_request_done", RESULT_CANT_CONNECT, 0, PoolStringArray(), PoolByteArray());
 			return true; // End it, since it's doing something
 		} break;
@@ -288,7 +341,7 @@ bool HTTPRequest::_update_connection() {
 				}
 				if (got_response && body_len < 0) {
 					// Chunked transfer is done
-					call_deferred("_request_done", RESULT_SUCCESS, response_code, response_headers, body);
+					_finish_body();
 					return true;
 				}
 
@@ -300,6 +353,8 @@ bool HTTPRequest::_update_connection() {
 
 				Error err = client->request(method, request_string, headers, request_data);
 				if (err != OK) {
+					if (_retry_reused_connection())
+						return false;
 					call_deferred("_request_done", RESULT_CONNECTION_ERROR, 0, PoolStringArray(), PoolByteArray());
 					return true;
 				}
@@ -338,8 +393,28 @@ bool HTTPRequest::_update_connection() {
 					return true;
 				}
 
-				if (download_to_file != String()) {
-					file = FileAccess::open(download_to_file, FileAccess::WRITE);
+				// A 416 answer to a resumed download means there is nothing left to get,
+				// leave the file alone.
+				if (download_to_file != String() && !(resume_offset > 0 && response_code == 416)) {
+					if (resume_offset > 0 && response_code == 206) {
+						int range_start = -1;
+						for (int i = 0; i < response_headers.size(); i++) {
+							String header = response_headers[i].to_lower();
+							if (header.begins_with("content-range:")) {
+								range_start = header.substr(header.find("bytes") + 5, header.length()).strip_edges().get_slicec('-', 0).to_int();
+							}
+						}
+						if (range_start != resume_offset) {
+							call_deferred("_request_done", RESULT_REQUEST_FAILED, response_code, response_headers, PoolByteArray());
+							return true;
+						}
+						file = FileAccess::open(download_to_file, FileAccess::READ_WRITE);
+						if (file) {
+							file->seek_end();
+						}
+					} else {
+						file = FileAccess::open(download_to_file, FileAccess::WRITE);
+					}
 					if (!file) {
 
 						call_deferred("_request_done", RESULT_DOWNLOAD_FILE_CANT_OPEN, response_code, response_headers, PoolByteArray());
@@ -350,20 +425,20 @@ bool HTTPRequest::_update_connection() {
 
 			client->poll();
 
-			PoolByteArray chunk = client->read_response_body_chunk();
-			downloaded += chunk.size();
-
-			if (file) {
-				PoolByteArray::Read r = chunk.read();
-				file->store_buffer(r.ptr(), chunk.size());
-				if (file->get_error() != OK) {
-					call_deferred("_request_done", RESULT_DOWNLOAD_FILE_WRITE_ERROR, response_code, response_headers, PoolByteArray());
+			// Read what is available, up to a limit so a fast server can't stall the frame.
+			int budget = download_chunk_size * 16;
+			while (budget > 0 && client->get_status() == HTTPClient::STATUS_BODY) {
+				int read = _read_body_data();
+				if (read < 0)
 					return true;
-				}
-			} else {
-				body.append_array(chunk);
+				if (read == 0)
+					break;
+				budget -= read;
 			}
 
+			if (!requesting)
+				return true; // Cancelled from a body_chunk_received handler
+
 			if (body_size_limit >= 0 && downloaded > body_size_limit) {
 				call_deferred("_request_done", RESULT_BODY_SIZE_LIMIT_EXCEEDED, response_code, response_headers, PoolByteArray());
 				return true;
@@ -372,18 +447,21 @@ bool HTTPRequest::_update_connection() {
 			if (body_len >= 0) {
 
 				if (downloaded == body_len) {
-					call_deferred("_request_done", RESULT_SUCCESS, response_code, response_headers, body);
+					_finish_body();
 					return true;
 				}
 			} else if (client->get_status() == HTTPClient::STATUS_DISCONNECTED) {
 				// We read till EOF, with no errors. Request is done.
-				call_deferred("_request_done", RESULT_SUCCESS, response_code, response_headers, body);
+				_finish_body();
+				return true;
 			}
 
 			return false;
 
 		} break; // Request resulted in body: break which must be read
 		case HTTPClient::STATUS_CONNECTION_ERROR: {
+			if (_retry_reused_connection())
+				return false;
 			call_deferred("_request_done", RESULT_CONNECTION_ERROR, 0, PoolStringArray(), PoolByteArray());
 			return true;
 		} break;
@@ -396,9 +474,90 @@ bool HTTPRequest::_update_connection() {
 	ERR_FAIL_V(false);
 }
 
+int HTTPRequest::_read_body_data() {
+
+	int read;
+
+	if (file || stream_body) {
+
+		// Read into the reused chunk buffer, then hand it on whole
+		if (chunk_buffer.size() != download_chunk_size) {
+			chunk_buffer.resize(download_chunk_size);
+		}
+		{
+			PoolByteArray::Write w = chunk_buffer.write();
+			read = client->read_response_body_data(w.ptr() + chunk_buffered, download_chunk_size - chunk_buffered);
+		}
+		chunk_buffered += read;
+		downloaded += read;
+
+		if (file) {
+			PoolByteArray::Read r = chunk_buffer.read();
+			file->store_buffer(r.ptr(), chunk_buffered);
+			chunk_buffered = 0;
+			if (file->get_error() != OK) {
+				call_deferred("_request_done", RESULT_DOWNLOAD_FILE_WRITE_ERROR, response_code, response_headers, PoolByteArray());
+				return -1;
+			}
+		} else if (chunk_buffered == download_chunk_size) {
+			_emit_body_chunk();
+		}
+	} else {
+
+		// Read straight into the body. Without a known length it grows geometrically
+		// and the excess is trimmed at the end. The announced length is only
+		// allocated at once when body_size_limit already checked it.
+		if (body.size() == downloaded) {
+			int size = MAX(body.size() * 2, downloaded + download_chunk_size);
+			if (body_len >= 0)
+				size = body_size_limit >= 0 ? body_len : MIN(body_len, MAX(size, (int)BODY_PREALLOCATE_MAX));
+			body.resize(size);
+		}
+		PoolByteArray::Write w = body.write();
+		read = client->read_response_body_data(w.ptr() + downloaded, body.size() - downloaded);
+		downloaded += read;
+	}
+
+	return read;
+}
+
+void HTTPRequest::_emit_body_chunk() {
+
+	if (chunk_buffered == 0)
+		return;
+
+	if (chunk_buffered < chunk_buffer.size()) {
+		chunk_buffer.resize(chunk_buffered);
+	}
+
+	if (use_threads) {
+		// The main thread keeps this one, the next read allocates a new buffer
+		call_deferred("emit_signal", "body_chunk_received", chunk_buffer);
+		chunk_buffer = PoolByteArray();
+	} else {
+		// Reading continues in the same buffer, unless a listener kept it
+		emit_signal("body_chunk_received", chunk_buffer);
+	}
+	chunk_buffered = 0;
+}
+
+void HTTPRequest::_finish_body() {
+
+	if (stream_body && !file) {
+		_emit_body_chunk();
+	} else if (!file) {
+		body.resize(downloaded);
+	}
+
+	if (requesting) {
+		call_deferred("_request_done", RESULT_SUCCESS, response_code, response_headers, body);
+	}
+}
+
 void HTTPRequest::_request_done(int p_status, int p_code, const PoolStringArray &headers, const PoolByteArray &p_data) {
 
-	cancel_request();
+	// Keep the connection for the next request, when the server allows it
+	_finish_request(keep_alive && p_status == RESULT_SUCCESS && response_keep_alive);
 	emit_signal("request_completed", p_status, p_code, headers, p_data);
 }
 
@@ -471,6 +630,53 @@ int HTTPRequest::get_max_redirects() const {
 	return max_redirects;
 }
 
+void HTTPRequest::set_download_chunk_size(int p_bytes) {
+
+	ERR_FAIL_COND(status != HTTPClient::STATUS_DISCONNECTED);
+	ERR_FAIL_COND(p_bytes < 256 || p_bytes > (1 << 24));
+
+	download_chunk_size = p_bytes;
+}
+
+int HTTPRequest::get_download_chunk_size() const {
+
+	return download_chunk_size;
+}
+
+void HTTPRequest::set_stream_body(bool p_enable) {
+
+	ERR_FAIL_COND(status != HTTPClient::STATUS_DISCONNECTED);
+
+	stream_body = p_enable;
+}
+
+bool HTTPRequest::is_streaming_body() const {
+
+	return stream_body;
+}
+
+void HTTPRequest::set_resume_download(bool p_enable) {
+
+	ERR_FAIL_COND(status != HTTPClient::STATUS_DISCONNECTED);
+
+	resume_download = p_enable;
+}
+
+bool HTTPRequest::is_resuming_download() const {
+
+	return resume_download;
+}
+
+void HTTPRequest::set_keep_alive(bool p_enable) {
+
+	keep_alive = p_enable;
+}
+
+bool HTTPRequest::is_keep_alive_enabled() const {
+
+	return keep_alive;
+}
+
 int HTTPRequest::get_downloaded_bytes() const {
 
 	return downloaded;
@@ -498,6 +704,18 @@ void HTTPRequest::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_download_file", "path"), &HTTPRequest::set_download_file);
 	ClassDB::bind_method(D_METHOD("get_download_file"), &HTTPRequest::get_download_file);
 
+	ClassDB::bind_method(D_METHOD("set_download_chunk_size", "bytes"), &HTTPRequest::set_download_chunk_size);
+	ClassDB::bind_method(D_METHOD("get_download_chunk_size"), &HTTPRequest::get_download_chunk_size);
+
+	ClassDB::bind_method(D_METHOD("set_stream_body", "enable"), &HTTPRequest::set_stream_body);
+	ClassDB::bind_method(D_METHOD("is_streaming_body"), &HTTPRequest::is_streaming_body);
+
+	ClassDB::bind_method(D_METHOD("set_resume_download", "enable"), &HTTPRequest::set_resume_download);
+	ClassDB::bind_method(D_METHOD("is_resuming_download"), &HTTPRequest::is_resuming_download);
+
+	ClassDB::bind_method(D_METHOD("set_keep_alive", "enable"), &HTTPRequest::set_keep_alive);
+	ClassDB::bind_method(D_METHOD("is_keep_alive_enabled"), &HTTPRequest::is_keep_alive_enabled);
+
 	ClassDB::bind_method(D_METHOD("get_downloaded_bytes"), &HTTPRequest::get_downloaded_bytes);
 	ClassDB::bind_method(D_METHOD("get_body_size"), &HTTPRequest::get_body_size);
 
@@ -508,8 +726,13 @@ void HTTPRequest::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_threads"), "set_use_threads", "is_using_threads");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "body_size_limit", PROPERTY_HINT_RANGE, "-1,2000000000"), "set_body_size_limit", "get_body_size_limit");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_redirects", PROPERTY_HINT_RANGE, "-1,64"), "set_max_redirects", "get_max_redirects");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "download_chunk_size", PROPERTY_HINT_RANGE, "256,16777216"), "set_download_chunk_size", "get_download_chunk_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "stream_body"), "set_stream_body", "is_streaming_body");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "resume_download"), "set_resume_download", "is_resuming_download");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "keep_alive"), "set_keep_alive", "is_keep_alive_enabled");
 
 	ADD_SIGNAL(MethodInfo("request_completed", PropertyInfo(Variant::INT, "result"), PropertyInfo(Variant::INT, "response_code"), PropertyInfo(Variant::POOL_STRING_ARRAY, "headers"), PropertyInfo(Variant::POOL_BYTE_ARRAY, "body")));
+	ADD_SIGNAL(MethodInfo("body_chunk_received", PropertyInfo(Variant::POOL_BYTE_ARRAY, "chunk")));
 
 	BIND_ENUM_CONSTANT(RESULT_SUCCESS);
 	//BIND_ENUM_CONSTANT( RESULT_NO_BODY );
@@ -545,6 +768,16 @@ HTTPRequest::HTTPRequest() {
 	thread_done = false;
 	downloaded = 0;
 	body_size_limit = -1;
+	download_chunk_size = 65536;
+	stream_body = false;
+	chunk_buffered = 0;
+	resume_download = false;
+	resume_offset = 0;
+	keep_alive = false;
+	response_keep_alive = false;
+	reused_connection = false;
+	connected_port = 0;
+	connected_ssl = false;
 	file = NULL;
 	status = HTTPClient::STATUS_DISCONNECTED;
 }
@@ -58,6 +58,10 @@ public:
 	};
 
 private:
+	enum {
+		BODY_PREALLOCATE_MAX = 1 << 24 // Allocated ahead from Content-Length without a body_size_limit.
+	};
+
 	bool requesting;
 
 	String request_string;
@@ -86,6 +90,21 @@ private:
 	volatile int downloaded;
 	int body_size_limit;
 
+	int download_chunk_size;
+	bool stream_body;
+	PoolByteArray chunk_buffer; // Reused between reads while nobody else holds it.
+	int chunk_buffered;
+
+	bool resume_download;
+	int resume_offset;
+
+	bool keep_alive;
+	bool response_keep_alive;
+	bool reused_connection;
+	String connected_host;
+	int connected_port;
+	bool connected_ssl;
+
 	int redirections;
 
 	HTTPClient::Status status;
@@ -100,6 +119,12 @@ private:
 
 	Error _parse_url(const String &p_url);
 	Error _request();
+	bool _retry_reused_connection();
+
+	int _read_body_data();
+	void _emit_body_chunk();
+	void _finish_body();
+	void _finish_request(bool p_keep_connection);
 
 	volatile bool thread_done;
 	volatile bool thread_request_quit;
@@ -130,6 +155,18 @@ public:
 	void set_max_redirects(int p_max);
 	int get_max_redirects() const;
 
+	void set_download_chunk_size(int p_bytes);
+	int get_download_chunk_size() const;
+
+	void set_stream_body(bool p_enable);
+	bool is_streaming_body() const;
+
+	void set_resume_download(bool p_enable);
+	bool is_resuming_download() const;
+
+	void set_keep_alive(bool p_enable);
+	bool is_keep_alive_enabled() const;
+
 	int get_downloaded_bytes() const;
 	int get_body_size() const;
 
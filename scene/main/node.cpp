@@ -33,6 +33,7 @@
 #include "core/core_string_names.h"
 #include "core/io/resource_loader.h"
 #include "core/message_queue.h"
+#include "core/os/thread.h"
 #include "core/print_string.h"
 #include "instance_placeholder.h"
 #include "scene/resources/packed_scene.h"
@@ -76,6 +77,11 @@ void Node::_notification(int p_notification) {
 				data.pause_owner = this;
 			}
 
+			if (data.parent && data.parent->data.process_thread_owner)
+				data.process_thread_owner = data.parent->data.process_thread_owner;
+			else
+				data.process_thread_owner = data.process_threaded ? this : NULL;
+
 			if (data.input)
 				add_to_group("_vp_input" + itos(get_viewport()->get_instance_id()));
 			if (data.unhandled_input)
@@ -97,10 +103,15 @@ void Node::_notification(int p_notification) {
 				remove_from_group("_vp_unhandled_key_input" + itos(get_viewport()->get_instance_id()));
 
 			data.pause_owner = NULL;
+			data.process_thread_owner = NULL;
 			if (data.path_cache) {
 				memdelete(data.path_cache);
 				data.path_cache = NULL;
 			}
+			if (data.resolved_paths) {
+				memdelete(data.resolved_paths);
+				data.resolved_paths = NULL;
+			}
 		} break;
 		case NOTIFICATION_PATH_CHANGED: {
 
@@ -314,6 +325,9 @@ void Node::_propagate_exit_tree() {
 void Node::move_child(Node *p_child, int p_pos) {
 
 	ERR_FAIL_NULL(p_child);
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
 	ERR_EXPLAIN("Invalid new child position: " + itos(p_pos));
 	ERR_FAIL_INDEX(p_pos, data.children.size() + 1);
 	ERR_EXPLAIN("child is not a child of this node.");
@@ -466,6 +480,67 @@ void Node::_propagate_pause_owner(Node *p_owner) {
 	}
 }
 
+void Node::set_process_threaded(bool p_enable) {
+
+	if (data.process_threaded == p_enable)
+		return;
+
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
+
+	data.process_threaded = p_enable;
+	if (!is_inside_tree())
+		return;
+
+	if (data.parent && data.parent->data.process_thread_owner)
+		return; //already part of a threaded subtree, nothing changes
+
+	_propagate_process_thread_owner(p_enable ? this : NULL);
+}
+
+bool Node::is_process_threaded() const {
+
+	return data.process_threaded;
+}
+
+void Node::_propagate_process_thread_owner(Node *p_owner) {
+
+	//nested threaded nodes are processed along with the outermost one
+	if (!p_owner && data.process_threaded)
+		p_owner = this;
+
+	data.process_thread_owner = p_owner;
+	for (int i = 0; i < data.children.size(); i++) {
+
+		data.children[i]->_propagate_process_thread_owner(p_owner);
+	}
+}
+
+#ifdef DEBUG_ENABLED
+bool Node::_check_threaded_process_access() const {
+
+	if (data.tree && data.tree->process_threaded_active && Thread::get_caller_id() != Thread::get_main_id()) {
+		ERR_EXPLAIN("Nodes processed on a thread can't change the scene tree directly, use call_deferred() instead.");
+		ERR_FAIL_V(false);
+	}
+
+	return true;
+}
+
+bool Node::_check_threaded_subtree_access() const {
+
+	if (data.tree && data.tree->process_threaded_active && Thread::get_caller_id() != Thread::get_main_id()) {
+		if (!data.process_thread_owner || data.process_thread_owner->data.process_thread_id != Thread::get_caller_id()) {
+			ERR_EXPLAIN("Nodes processed on a thread can only change nodes of their own subtree directly, use call_deferred() for the others.");
+			ERR_FAIL_V(false);
+		}
+	}
+
+	return true;
+}
+#endif
+
 void Node::set_network_master(int p_peer_id, bool p_recursive) {
 
 	data.network_master = p_peer_id;
@@ -906,7 +981,14 @@ StringName Node::get_name() const {
 
 void Node::_set_name_nocheck(const StringName &p_name) {
 
+	StringName old_name = data.name;
 	data.name = p_name;
+
+	if (data.parent) {
+		data.parent->_unindex_child(this, old_name);
+		data.parent->_index_child(this);
+	}
+	_tree_structure_changed();
 }
 
 String Node::invalid_character = ". : @ / \"";
@@ -928,12 +1010,16 @@ void Node::set_name(const String &p_name) {
 	_validate_node_name(name);
 
 	ERR_FAIL_COND(name == "");
+	StringName old_name = data.name;
 	data.name = name;
 
 	if (data.parent) {
 
 		data.parent->_validate_child_name(this);
+		data.parent->_unindex_child(this, old_name);
+		data.parent->_index_child(this);
 	}
+	_tree_structure_changed();
 
 	propagate_notification(NOTIFICATION_PATH_CHANGED);
 
@@ -990,17 +1076,8 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
 			unique = false;
 		} else {
 			//check if exists
-			Node **children = data.children.ptrw();
-			int cc = data.children.size();
-
-			for (int i = 0; i < cc; i++) {
-				if (children[i] == p_child)
-					continue;
-				if (children[i]->data.name == p_child->data.name) {
-					unique = false;
-					break;
-				}
-			}
+			Node *existing = _get_child_by_name(p_child->data.name);
+			unique = !existing || existing == p_child;
 		}
 
 		if (!unique) {
@@ -1138,6 +1215,8 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 	p_child->data.pos = data.children.size();
 	data.children.push_back(p_child);
 	p_child->data.parent = this;
+	_index_child(p_child);
+	_tree_structure_changed();
 	p_child->notification(NOTIFICATION_PARENTED);
 
 	if (data.tree) {
@@ -1153,6 +1232,9 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 void Node::add_child(Node *p_child, bool p_legible_unique_name) {
 
 	ERR_FAIL_NULL(p_child);
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
 
 	if (p_child == this) {
 		ERR_EXPLAIN("Can't add child '" + p_child->get_name() + "' to itself.")
@@ -1227,6 +1309,9 @@ void Node::_propagate_validate_owner() {
 void Node::remove_child(Node *p_child) {
 
 	ERR_FAIL_NULL(p_child);
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
 	if (data.blocked > 0) {
 		ERR_EXPLAIN("Parent node is busy setting up children, remove_node() failed. Consider using call_deferred(\"remove_child\",child) instead.");
 		ERR_FAIL_COND(data.blocked > 0);
@@ -1265,6 +1350,8 @@ void Node::remove_child(Node *p_child) {
 	p_child->notification(NOTIFICATION_UNPARENTED);
 
 	data.children.remove(idx);
+	_unindex_child(p_child, p_child->data.name);
+	_tree_structure_changed();
 
 	//update pointer and size
 	child_count = data.children.size();
@@ -1300,6 +1387,14 @@ Node *Node::get_child(int p_index) const {
 
 Node *Node::_get_child_by_name(const StringName &p_name) const {
 
+	//the index is only built when children are added (see _index_child), so
+	//lookups never write and stay safe from threaded processing
+	if (data.children_index) {
+
+		Node *const *child = data.children_index->getptr(p_name);
+		return child ? *child : NULL;
+	}
+
 	int cc = data.children.size();
 	Node *const *cd = data.children.ptr();
 
@@ -1311,6 +1406,49 @@ Node *Node::_get_child_by_name(const StringName &p_name) const {
 	return NULL;
 }
 
+void Node::_tree_structure_changed() {
+
+	if (data.tree)
+		data.tree->tree_version++; //invalidates resolved paths right away
+}
+
+void Node::_index_child(Node *p_child) {
+
+	if (!data.children_index && data.children.size() >= CHILDREN_INDEX_MIN_SIZE) {
+
+		data.children_index = memnew((HashMap<StringName, Node *>));
+		for (int i = data.children.size() - 1; i >= 0; i--) { //backwards, so the first child wins if names are repeated
+			data.children_index->set(data.children[i]->data.name, data.children[i]);
+		}
+		return;
+	}
+
+	if (data.children_index && !data.children_index->has(p_child->data.name)) {
+		data.children_index->set(p_child->data.name, p_child);
+	}
+}
+
+void Node::_unindex_child(Node *p_child, const StringName &p_name) {
+
+	if (!data.children_index)
+		return;
+
+	Node **child = data.children_index->getptr(p_name);
+	if (!child || *child != p_child)
+		return;
+
+	data.children_index->erase(p_name);
+
+	//names are not always unique (see _set_name_nocheck), index the next one if any
+	for (int i = 0; i < data.children.size(); i++) {
+		Node *other = data.children[i];
+		if (other != p_child && other->data.name == p_name) {
+			data.children_index->set(p_name, other);
+			break;
+		}
+	}
+}
+
 Node *Node::get_node_or_null(const NodePath &p_path) const {
 
 	if (!data.inside_tree && p_path.is_absolute()) {
@@ -1318,6 +1456,43 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 		ERR_FAIL_V(NULL);
 	}
 
+	//scripts tend to look up the same paths every frame, remember the last few
+	//until the tree changes (not while processing on threads, the cache isn't shared safely)
+	ResolvedPathCache *cache = NULL;
+	if (data.inside_tree && !data.tree->process_threaded_active && !p_path.is_empty()) {
+
+		if (!data.resolved_paths) {
+			data.resolved_paths = memnew(ResolvedPathCache);
+		}
+		cache = data.resolved_paths;
+
+		if (cache->tree_version == data.tree->tree_version) {
+			for (int i = 0; i < RESOLVED_PATH_CACHE_SIZE; i++) {
+				if (cache->paths[i] == p_path)
+					return cache->nodes[i];
+			}
+		} else {
+			for (int i = 0; i < RESOLVED_PATH_CACHE_SIZE; i++) {
+				cache->paths[i] = NodePath();
+				cache->nodes[i] = NULL;
+			}
+			cache->tree_version = data.tree->tree_version;
+		}
+	}
+
+	Node *node = _resolve_path(p_path);
+
+	if (cache) {
+		cache->paths[cache->next] = p_path;
+		cache->nodes[cache->next] = node;
+		cache->next = (cache->next + 1) % RESOLVED_PATH_CACHE_SIZE;
+	}
+
+	return node;
+}
+
+Node *Node::_resolve_path(const NodePath &p_path) const {
+
 	Node *current = NULL;
 	Node *root = NULL;
 
@@ -1352,18 +1527,7 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 
 		} else {
 
-			next = NULL;
-
-			for (int j = 0; j < current->data.children.size(); j++) {
-
-				Node *child = current->data.children[j];
-
-				if (child->data.name == name) {
-
-					next = child;
-					break;
-				}
-			}
+			next = current->_get_child_by_name(name);
 			if (next == NULL) {
 				return NULL;
 			};
@@ -1677,6 +1841,9 @@ bool Node::is_in_group(const StringName &p_identifier) const {
 void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 
 	ERR_FAIL_COND(!p_identifier.operator String().length());
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
 
 	if (data.grouped.has(p_identifier))
 		return;
@@ -1697,6 +1864,9 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 void Node::remove_from_group(const StringName &p_identifier) {
 
 	ERR_FAIL_COND(!data.grouped.has(p_identifier));
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
 
 	Map<StringName, GroupData>::Element *E = data.grouped.find(p_identifier);
 
@@ -2592,6 +2762,10 @@ void Node::print_stray_nodes() {
 
 void Node::queue_delete() {
 
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(!_check_threaded_process_access());
+#endif
+
 	if (is_inside_tree()) {
 		get_tree()->queue_delete(this);
 	} else {
@@ -2743,6 +2917,8 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_process_delta_time"), &Node::get_process_delta_time);
 	ClassDB::bind_method(D_METHOD("set_process", "enable"), &Node::set_process);
 	ClassDB::bind_method(D_METHOD("set_process_priority", "priority"), &Node::set_process_priority);
+	ClassDB::bind_method(D_METHOD("set_process_threaded", "enable"), &Node::set_process_threaded);
+	ClassDB::bind_method(D_METHOD("is_process_threaded"), &Node::is_process_threaded);
 	ClassDB::bind_method(D_METHOD("is_processing"), &Node::is_processing);
 	ClassDB::bind_method(D_METHOD("set_process_input", "enable"), &Node::set_process_input);
 	ClassDB::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
@@ -2855,6 +3031,9 @@ void Node::_bind_methods() {
 	//ADD_PROPERTY( PropertyInfo( Variant::BOOL, "process/unhandled_input" ), "set_process_unhandled_input","is_processing_unhandled_input" ) ;
 	ADD_GROUP("Pause", "pause_");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "pause_mode", PROPERTY_HINT_ENUM, "Inherit,Stop,Process"), "set_pause_mode", "get_pause_mode");
+	ADD_GROUP("Process", "process_");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "process_threaded"), "set_process_threaded", "is_process_threaded");
+	ADD_GROUP("", "");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "editor/display_folded", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL), "set_display_folded", "is_displayed_folded");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "name", PROPERTY_HINT_NONE, "", 0), "set_name", "get_name");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "filename", PROPERTY_HINT_NONE, "", 0), "set_filename", "get_filename");
@@ -2908,8 +3087,15 @@ Node::Node() {
 	data.unhandled_key_input = false;
 	data.pause_mode = PAUSE_MODE_INHERIT;
 	data.pause_owner = NULL;
+	data.process_threaded = false;
+	data.process_thread_owner = NULL;
+#ifdef DEBUG_ENABLED
+	data.process_thread_id = 0;
+#endif
 	data.network_master = 1; //server by default
 	data.path_cache = NULL;
+	data.children_index = NULL;
+	data.resolved_paths = NULL;
 	data.parent_owned = false;
 	data.in_constructor = true;
 	data.viewport = NULL;
@@ -2924,6 +3110,11 @@ Node::~Node() {
 	data.owned.clear();
 	data.children.clear();
 
+	if (data.children_index)
+		memdelete(data.children_index);
+	if (data.resolved_paths)
+		memdelete(data.resolved_paths);
+
 	ERR_FAIL_COND(data.parent);
 	ERR_FAIL_COND(data.children.size());
 }
@@ -32,9 +32,11 @@
 #define NODE_H
 
 #include "core/class_db.h"
+#include "core/hash_map.h"
 #include "core/map.h"
 #include "core/node_path.h"
 #include "core/object.h"
+#include "core/os/thread.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
 #include "scene/main/scene_tree.h"
@@ -76,6 +78,28 @@ public:
 	};
 
 private:
+	enum {
+		CHILDREN_INDEX_MIN_SIZE = 32, //below this, a linear search by name is faster
+		RESOLVED_PATH_CACHE_SIZE = 4
+	};
+
+	//last paths resolved by get_node(), valid while the tree version doesn't change
+	struct ResolvedPathCache {
+
+		NodePath paths[RESOLVED_PATH_CACHE_SIZE];
+		Node *nodes[RESOLVED_PATH_CACHE_SIZE];
+		uint64_t tree_version;
+		int next;
+
+		ResolvedPathCache() {
+			for (int i = 0; i < RESOLVED_PATH_CACHE_SIZE; i++) {
+				nodes[i] = NULL;
+			}
+			tree_version = 0;
+			next = 0;
+		}
+	};
+
 	struct GroupData {
 
 		bool persistent;
@@ -115,6 +139,12 @@ private:
 		PauseMode pause_mode;
 		Node *pause_owner;
 
+		bool process_threaded;
+		Node *process_thread_owner; //outermost threaded ancestor, its subtree is processed on one worker
+#ifdef DEBUG_ENABLED
+		Thread::ID process_thread_id; //worker processing the subtree of this owner, 0 outside of its job
+#endif
+
 		int network_master;
 		Map<StringName, MultiplayerAPI::RPCMode> rpc_methods;
 		Map<StringName, MultiplayerAPI::RPCMode> rpc_properties;
@@ -139,6 +169,8 @@ private:
 		bool display_folded;
 
 		mutable NodePath *path_cache;
+		HashMap<StringName, Node *> *children_index; //children by name, built once there are many
+		mutable ResolvedPathCache *resolved_paths;
 
 	} data;
 
@@ -154,6 +186,10 @@ private:
 	void _print_tree(const Node *p_node);
 
 	Node *_get_child_by_name(const StringName &p_name) const;
+	Node *_resolve_path(const NodePath &p_path) const;
+	void _index_child(Node *p_child);
+	void _unindex_child(Node *p_child, const StringName &p_name);
+	void _tree_structure_changed();
 
 	void _replace_connections_target(Node *p_new_target);
 
@@ -169,6 +205,10 @@ private:
 	void _propagate_validate_owner();
 	void _print_stray_nodes();
 	void _propagate_pause_owner(Node *p_owner);
+	void _propagate_process_thread_owner(Node *p_owner);
+#ifdef DEBUG_ENABLED
+	bool _check_threaded_process_access() const;
+#endif
 	Array _get_node_and_resource(const NodePath &p_path);
 
 	void _duplicate_signals(const Node *p_original, Node *p_copy) const;
@@ -204,6 +244,9 @@ protected:
 	virtual void move_child_notify(Node *p_child);
 
 	void _propagate_replace_owner(Node *p_owner, Node *p_by_owner);
+#ifdef DEBUG_ENABLED
+	bool _check_threaded_subtree_access() const;
+#endif
 
 	static void _bind_methods();
 	static String _get_name_num_separator();
@@ -330,6 +373,9 @@ public:
 
 	void set_process_priority(int p_priority);
 
+	void set_process_threaded(bool p_enable);
+	bool is_process_threaded() const;
+
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
 
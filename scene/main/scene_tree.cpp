@@ -30,6 +30,7 @@
 
 #include "scene_tree.h"
 
+#include "core/core_string_names.h"
 #include "core/io/marshalls.h"
 #include "core/io/resource_loader.h"
 #include "core/message_queue.h"
@@ -40,6 +41,7 @@
 #include "editor/editor_node.h"
 #include "main/input_default.h"
 #include "node.h"
+#include "scene/3d/spatial.h"
 #include "scene/resources/dynamic_font.h"
 #include "scene/resources/material.h"
 #include "scene/resources/mesh.h"
@@ -112,10 +114,7 @@ SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_nod
 		E = group_map.insert(p_group, Group());
 	}
 
-	if (E->get().nodes.find(p_node) != -1) {
-		ERR_EXPLAIN("Already in group: " + p_group);
-		ERR_FAIL_V(&E->get());
-	}
+	//Node keeps track of its own groups, so no need to search for duplicates here
 	E->get().nodes.push_back(p_node);
 	//E->get().last_tree_version=0;
 	E->get().changed = true;
@@ -127,8 +126,15 @@ void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
 	ERR_FAIL_COND(!E);
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.empty())
+	Group &g = E->get();
+	int idx = g.nodes.find(p_node);
+	ERR_FAIL_COND(idx == -1);
+
+	//don't shift the members on every removal, holes are compacted lazily
+	g.nodes.write[idx] = NULL;
+	g.removed++;
+
+	if (g.removed == g.nodes.size())
 		group_map.erase(E);
 }
 
@@ -140,6 +146,10 @@ void SceneTree::make_group_changed(const StringName &p_group) {
 
 void SceneTree::flush_transform_notifications() {
 
+	if (xform_dirty_list.first()) {
+		Spatial::_flush_dirty_transforms(this);
+	}
+
 	SelfList<Node> *n = xform_change_list.first();
 	while (n) {
 
@@ -173,6 +183,19 @@ void SceneTree::_flush_ugc() {
 
 void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
 
+	if (g.removed) {
+
+		Node **nodes = g.nodes.ptrw();
+		int node_count = g.nodes.size();
+		int to = 0;
+		for (int i = 0; i < node_count; i++) {
+			if (nodes[i])
+				nodes[to++] = nodes[i];
+		}
+		g.nodes.resize(to);
+		g.removed = 0;
+	}
+
 	if (!g.changed)
 		return;
 	if (g.nodes.empty())
@@ -191,6 +214,48 @@ void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
 	g.changed = false;
 }
 
+void SceneTree::_call_group_member(Node *p_node, const StringName &p_function, const Variant **p_args, int p_argcount, GroupCallCache *r_cache) {
+
+	Variant::CallError ce;
+
+	if (p_function == CoreStringNames::get_singleton()->_free) {
+		p_node->call(p_function, p_args, p_argcount, ce);
+		return;
+	}
+
+	ScriptInstance *script_instance = p_node->get_script_instance();
+	const Script *script = script_instance ? script_instance->get_script().ptr() : NULL;
+	const void *class_name = p_node->get_class_name().data_unique_pointer();
+
+	const GroupCallCache::Target *target = NULL;
+	for (int i = 0; i < r_cache->target_count; i++) {
+		if (r_cache->targets[i].class_name == class_name && r_cache->targets[i].script == script) {
+			target = &r_cache->targets[i];
+			break;
+		}
+	}
+
+	GroupCallCache::Target resolved;
+	if (!target) {
+		//same lookup order as Object::call(), scripts first
+		resolved.class_name = class_name;
+		resolved.script = script;
+		resolved.script_method = script_instance && script_instance->has_method(p_function);
+		resolved.method = resolved.script_method ? NULL : ClassDB::get_method(p_node->get_class_name(), p_function);
+
+		if (r_cache->target_count < GroupCallCache::MAX_TARGETS) {
+			r_cache->targets[r_cache->target_count++] = resolved;
+		}
+		target = &resolved;
+	}
+
+	if (target->script_method) {
+		p_node->call(p_function, p_args, p_argcount, ce);
+	} else if (target->method) {
+		target->method->call(p_node, p_args, p_argcount, ce);
+	}
+}
+
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
 
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
@@ -226,10 +291,22 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 
 	_update_group_order(g);
 
+	//share the member array, copy on write keeps it intact if the group changes while calling
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
+	VARIANT_ARGPTRS;
+
+	int argc = 0;
+	for (int i = 0; i < VARIANT_ARG_MAX; i++) {
+		if (argptr[i]->get_type() == Variant::NIL)
+			break;
+		argc++;
+	}
+
+	GroupCallCache cache;
+
 	call_lock++;
 
 	if (p_call_flags & GROUP_CALL_REVERSE) {
@@ -243,7 +320,7 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 				if (p_call_flags & GROUP_CALL_MULTILEVEL)
 					nodes[i]->call_multilevel(p_function, VARIANT_ARG_PASS);
 				else
-					nodes[i]->call(p_function, VARIANT_ARG_PASS);
+					_call_group_member(nodes[i], p_function, argptr, argc, &cache);
 			} else
 				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
 		}
@@ -259,7 +336,7 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 				if (p_call_flags & GROUP_CALL_MULTILEVEL)
 					nodes[i]->call_multilevel(p_function, VARIANT_ARG_PASS);
 				else
-					nodes[i]->call(p_function, VARIANT_ARG_PASS);
+					_call_group_member(nodes[i], p_function, argptr, argc, &cache);
 			} else
 				MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
 		}
@@ -281,8 +358,9 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 
 	_update_group_order(g);
 
+	//share the member array, copy on write keeps it intact if the group changes while calling
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -330,8 +408,9 @@ void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group
 
 	_update_group_order(g);
 
+	//share the member array, copy on write keeps it intact if the group changes while calling
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -611,6 +690,17 @@ void SceneTree::finish() {
 		root->_propagate_after_exit_tree();
 		memdelete(root); //delete root
 	}
+
+	work_pool.finish();
+}
+
+ThreadWorkPool *SceneTree::get_work_pool() {
+
+	if (!work_pool.is_initialized()) {
+		work_pool.init();
+	}
+
+	return &work_pool;
 }
 
 void SceneTree::quit() {
@@ -907,7 +997,7 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 	Vector<Node *> nodes_copy = g.nodes;
 
 	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 
 	Variant arg = p_input;
 	const Variant *v[1] = { &arg };
@@ -951,7 +1041,12 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 	Vector<Node *> nodes_copy = g.nodes;
 
 	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
+
+	//only user callbacks can be threaded, internal processing always runs here.
+	//script debuggers keep one unsynchronized call stack, so everything runs here while one is attached
+	bool can_thread = (p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS) && !ScriptDebugger::get_singleton();
+	Vector<Node *> threaded_nodes;
 
 	call_lock++;
 
@@ -966,15 +1061,101 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 		if (!n->can_process_notification(p_notification))
 			continue;
 
+		if (can_thread && n->data.process_thread_owner) {
+			threaded_nodes.push_back(n);
+			continue;
+		}
+
+		//threaded nodes of a lower priority are done before this one runs,
+		//with equal priorities they run after the nodes processed here
+		if (threaded_nodes.size() && threaded_nodes[threaded_nodes.size() - 1]->data.process_priority < n->data.process_priority) {
+			_process_threaded_nodes(threaded_nodes, p_notification);
+			threaded_nodes.clear();
+		}
+
 		n->notification(p_notification);
 		//ERR_FAIL_COND(node_count != g.nodes.size());
 	}
 
+	if (threaded_nodes.size()) {
+		_process_threaded_nodes(threaded_nodes, p_notification);
+	}
+
 	call_lock--;
 	if (call_lock == 0)
 		call_skip.clear();
 }
 
+void SceneTree::_process_threaded_nodes(const Vector<Node *> &p_nodes, int p_notification) {
+
+	//group the nodes by subtree, keeping their processing order inside each one
+	ThreadedProcess process;
+	process.notification = p_notification;
+
+	Map<Node *, int> owner_index;
+	Vector<int> node_subtree;
+	node_subtree.resize(p_nodes.size());
+	for (int i = 0; i < p_nodes.size(); i++) {
+
+		Node *owner = p_nodes[i]->data.process_thread_owner;
+		Map<Node *, int>::Element *O = owner_index.find(owner);
+		if (!O) {
+			O = owner_index.insert(owner, owner_index.size());
+		}
+		node_subtree.write[i] = O->get();
+	}
+
+	int subtree_count = owner_index.size();
+	process.subtrees.resize(subtree_count + 1);
+	for (int i = 0; i <= subtree_count; i++) {
+		process.subtrees.write[i] = 0;
+	}
+	for (int i = 0; i < node_subtree.size(); i++) {
+		process.subtrees.write[node_subtree[i] + 1]++;
+	}
+	for (int i = 0; i < subtree_count; i++) {
+		process.subtrees.write[i + 1] += process.subtrees[i];
+	}
+
+	Vector<int> fill = process.subtrees;
+	process.nodes.resize(p_nodes.size());
+	for (int i = 0; i < p_nodes.size(); i++) {
+		process.nodes.write[fill.write[node_subtree[i]]++] = p_nodes[i];
+	}
+
+	ThreadWorkPool *pool = subtree_count > 1 ? get_work_pool() : NULL;
+	if (pool && !pool->is_working()) {
+
+		process_threaded_active = true;
+		pool->do_work(subtree_count, this, &SceneTree::_process_threaded_subtree, (const ThreadedProcess *)&process);
+		process_threaded_active = false;
+	} else {
+		for (int i = 0; i < subtree_count; i++) {
+			_process_threaded_subtree(i, &process);
+		}
+	}
+}
+
+void SceneTree::_process_threaded_subtree(uint32_t p_index, const ThreadedProcess *p_process) {
+
+	int from = p_process->subtrees[p_index];
+	int to = p_process->subtrees[p_index + 1];
+
+#ifdef DEBUG_ENABLED
+	//lets the access checks tell this subtree apart from the ones on other workers
+	Node *owner = p_process->nodes[from]->data.process_thread_owner;
+	owner->data.process_thread_id = Thread::get_caller_id();
+#endif
+
+	for (int i = from; i < to; i++) {
+		p_process->nodes[i]->notification(p_process->notification);
+	}
+
+#ifdef DEBUG_ENABLED
+	owner->data.process_thread_id = 0;
+#endif
+}
+
 /*
 void SceneMainLoop::_update_listener_2d() {
 
@@ -1053,7 +1234,7 @@ Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 
 	ret.resize(nc);
 
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = E->get().nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 
 		ret[i] = ptr[i];
@@ -1076,7 +1257,7 @@ void SceneTree::get_nodes_in_group(const StringName &p_group, List<Node *> *p_li
 	int nc = E->get().nodes.size();
 	if (nc == 0)
 		return;
-	Node **ptr = E->get().nodes.ptrw();
+	Node *const *ptr = E->get().nodes.ptr();
 	for (int i = 0; i < nc; i++) {
 
 		p_list->push_back(ptr[i]);
@@ -1984,6 +2165,8 @@ SceneTree::SceneTree() {
 	node_removed_name = "node_removed";
 	ugc_locked = false;
 	call_lock = 0;
+	process_threaded_active = false;
+	xform_list_mutex = Mutex::create();
 	root_lock = 0;
 	node_count = 0;
 
@@ -2099,4 +2282,6 @@ SceneTree::SceneTree() {
 }
 
 SceneTree::~SceneTree() {
+
+	memdelete(xform_list_mutex);
 }
@@ -33,6 +33,7 @@
 
 #include "core/io/multiplayer_api.h"
 #include "core/os/main_loop.h"
+#include "core/os/thread_work_pool.h"
 #include "core/os/thread_safe.h"
 #include "core/self_list.h"
 #include "scene/resources/mesh.h"
@@ -96,10 +97,14 @@ public:
 private:
 	struct Group {
 
-		Vector<Node *> nodes;
+		Vector<Node *> nodes; //removed nodes leave a NULL behind until the next _update_group_order()
+		int removed;
 		//uint64_t last_tree_version;
 		bool changed;
-		Group() { changed = false; };
+		Group() {
+			removed = 0;
+			changed = false;
+		};
 	};
 
 	Viewport *root;
@@ -128,6 +133,8 @@ private:
 	StringName node_removed_name;
 
 	bool use_font_oversampling;
+
+	ThreadWorkPool work_pool;
 	int64_t current_frame;
 	int64_t current_event;
 	int node_count;
@@ -162,6 +169,28 @@ private:
 	void _flush_ugc();
 
 	_FORCE_INLINE_ void _update_group_order(Group &g, bool p_use_priority = false);
+
+	//methods resolved during a group call, members usually share a few types
+	struct GroupCallCache {
+
+		enum {
+			MAX_TARGETS = 8
+		};
+
+		struct Target {
+			const void *class_name;
+			const Script *script;
+			bool script_method;
+			MethodBind *method;
+		};
+
+		Target targets[MAX_TARGETS];
+		int target_count;
+
+		GroupCallCache() { target_count = 0; }
+	};
+
+	void _call_group_member(Node *p_node, const StringName &p_function, const Variant **p_args, int p_argcount, GroupCallCache *r_cache);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -207,6 +236,18 @@ private:
 	void make_group_changed(const StringName &p_group);
 
 	void _notify_group_pause(const StringName &p_group, int p_notification);
+
+	//process notifications for threaded subtrees, one job per subtree
+	struct ThreadedProcess {
+
+		Vector<Node *> nodes; //grouped by subtree, in processing order
+		Vector<int> subtrees; //first node of each subtree, plus the end
+		int notification;
+	};
+
+	bool process_threaded_active;
+	void _process_threaded_nodes(const Vector<Node *> &p_nodes, int p_notification);
+	void _process_threaded_subtree(uint32_t p_index, const ThreadedProcess *p_process);
 	void _call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input);
 	Variant _call_group_flags(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	Variant _call_group(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
@@ -219,6 +260,11 @@ private:
 	friend class Viewport;
 
 	SelfList<Node>::List xform_change_list;
+	SelfList<Node>::List xform_dirty_list; //spatial subtrees changed since the last flush
+
+	//threaded subtrees share the transform lists, they are only locked while those are processed
+	Mutex *xform_list_mutex;
+	_FORCE_INLINE_ Mutex *_get_xform_list_lock() const { return process_threaded_active ? xform_list_mutex : NULL; }
 
 #ifdef DEBUG_ENABLED
 
@@ -408,6 +454,9 @@ public:
 
 	static SceneTree *get_singleton() { return singleton; }
 
+	//shared pool for splitting per-frame scene work across cores, threads are started on first use
+	ThreadWorkPool *get_work_pool();
+
 	void drop_files(const Vector<String> &p_files, int p_from_screen = 0);
 
 	//network API
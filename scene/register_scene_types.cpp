@@ -159,6 +159,7 @@
 #include "scene/resources/surface_tool.h"
 #include "scene/resources/text_file.h"
 #include "scene/resources/texture.h"
+#include "scene/resources/texture_streamer.h"
 #include "scene/resources/tile_set.h"
 #include "scene/resources/video_stream.h"
 #include "scene/resources/visual_shader.h"
@@ -189,6 +190,7 @@
 #include "scene/3d/multimesh_instance.h"
 #include "scene/3d/navigation.h"
 #include "scene/3d/navigation_mesh.h"
+#include "scene/3d/occluder_instance.h"
 #include "scene/3d/particles.h"
 #include "scene/3d/path.h"
 #include "scene/3d/physics_body.h"
@@ -216,6 +218,7 @@ static Ref<ResourceFormatLoaderText> resource_loader_text;
 static Ref<ResourceFormatLoaderDynamicFont> resource_loader_dynamic_font;
 
 static Ref<ResourceFormatLoaderStreamTexture> resource_loader_stream_texture;
+static TextureStreamer *texture_streamer = NULL;
 static Ref<ResourceFormatLoaderTextureLayered> resource_loader_texture_layered;
 
 static Ref<ResourceFormatLoaderBMFont> resource_loader_bmfont;
@@ -237,6 +240,18 @@ void register_scene_types() {
 	resource_loader_stream_texture.instance();
 	ResourceLoader::add_resource_format_loader(resource_loader_stream_texture);
 
+	bool texture_streaming = GLOBAL_DEF("rendering/texture_streaming/enabled", false);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/enabled", PropertyInfo(Variant::BOOL, "rendering/texture_streaming/enabled", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_RESTART_IF_CHANGED));
+	int texture_streaming_budget = GLOBAL_DEF("rendering/texture_streaming/memory_budget_mb", 256);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/memory_budget_mb", PropertyInfo(Variant::INT, "rendering/texture_streaming/memory_budget_mb", PROPERTY_HINT_RANGE, "1,16384,1"));
+	int texture_streaming_min_size = GLOBAL_DEF("rendering/texture_streaming/min_size", 128);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/min_size", PropertyInfo(Variant::INT, "rendering/texture_streaming/min_size", PROPERTY_HINT_RANGE, "1,4096,1"));
+
+	//the editor always works with whole textures
+	if (texture_streaming && !Engine::get_singleton()->is_editor_hint()) {
+		texture_streamer = memnew(TextureStreamer(uint64_t(texture_streaming_budget) * 1024 * 1024, texture_streaming_min_size));
+	}
+
 	resource_loader_texture_layered.instance();
 	ResourceLoader::add_resource_format_loader(resource_loader_texture_layered);
 
@@ -362,6 +377,7 @@ void register_scene_types() {
 	ClassDB::register_class<Spatial>();
 	ClassDB::register_virtual_class<SpatialGizmo>();
 	ClassDB::register_class<Skeleton>();
+	Skeleton::init_dirty_list();
 	ClassDB::register_class<AnimationPlayer>();
 	ClassDB::register_class<Tween>();
 
@@ -388,6 +404,7 @@ void register_scene_types() {
 	ClassDB::register_class<OmniLight>();
 	ClassDB::register_class<SpotLight>();
 	ClassDB::register_class<ReflectionProbe>();
+	ClassDB::register_class<OccluderInstance>();
 	ClassDB::register_class<GIProbe>();
 	ClassDB::register_class<GIProbeData>();
 	ClassDB::register_class<BakedLightmap>();
@@ -743,6 +760,11 @@ void unregister_scene_types() {
 	ResourceLoader::remove_resource_format_loader(resource_loader_stream_texture);
 	resource_loader_stream_texture.unref();
 
+	if (texture_streamer) {
+		memdelete(texture_streamer);
+		texture_streamer = NULL;
+	}
+
 	DynamicFont::finish_dynamic_fonts();
 
 	ResourceSaver::remove_resource_format_saver(resource_saver_text);
@@ -760,6 +782,7 @@ void unregister_scene_types() {
 	ResourceLoader::remove_resource_format_loader(resource_loader_bmfont);
 	resource_loader_bmfont.unref();
 
+	Skeleton::finish_dirty_list();
 	SpatialMaterial::finish_shaders();
 	ParticlesMaterial::finish_shaders();
 	CanvasItemMaterial::finish_shaders();
@@ -31,6 +31,7 @@
 #include "animation.h"
 #include "scene/scene_string_names.h"
 
+#include "core/io/marshalls.h"
 #include "core/math/geometry.h"
 
 #define ANIM_MIN_LENGTH 0.001
@@ -86,7 +87,16 @@ bool Animation::_set(const StringName &p_name, const Variant &p_value) {
 			track_set_imported(track, p_value);
 		else if (what == "enabled")
 			track_set_enabled(track, p_value);
-		else if (what == "keys" || what == "key_values") {
+		else if (what == "compressed") {
+
+			ERR_FAIL_COND_V(track_get_type(track) != TYPE_TRANSFORM, false);
+			TransformTrack *tt = static_cast<TransformTrack *>(tracks[track]);
+			CompressedTransforms compressed;
+			ERR_FAIL_COND_V(!_compressed_deserialize(p_value, &compressed), false);
+			tt->transforms.clear();
+			tt->compressed = compressed;
+
+		} else if (what == "keys" || what == "key_values") {
 
 			if (track_get_type(track) == TYPE_TRANSFORM) {
 
@@ -97,6 +107,7 @@ bool Animation::_set(const StringName &p_name, const Variant &p_value) {
 
 				PoolVector<float>::Read r = values.read();
 
+				tt->compressed = CompressedTransforms();
 				tt->transforms.resize(vcount / 12);
 
 				for (int i = 0; i < (vcount / 12); i++) {
@@ -369,7 +380,12 @@ bool Animation::_get(const StringName &p_name, Variant &r_ret) const {
 			r_ret = track_is_imported(track);
 		else if (what == "enabled")
 			r_ret = track_is_enabled(track);
-		else if (what == "keys") {
+		else if (what == "compressed") {
+
+			ERR_FAIL_COND_V(!track_is_compressed(track), false);
+			r_ret = _compressed_serialize(static_cast<const TransformTrack *>(tracks[track])->compressed);
+
+		} else if (what == "keys") {
 
 			if (track_get_type(track) == TYPE_TRANSFORM) {
 
@@ -622,7 +638,11 @@ void Animation::_get_property_list(List<PropertyInfo> *p_list) const {
 		p_list->push_back(PropertyInfo(Variant::BOOL, "tracks/" + itos(i) + "/loop_wrap", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
 		p_list->push_back(PropertyInfo(Variant::BOOL, "tracks/" + itos(i) + "/imported", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
 		p_list->push_back(PropertyInfo(Variant::BOOL, "tracks/" + itos(i) + "/enabled", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
-		p_list->push_back(PropertyInfo(Variant::ARRAY, "tracks/" + itos(i) + "/keys", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
+		if (track_is_compressed(i)) {
+			p_list->push_back(PropertyInfo(Variant::POOL_BYTE_ARRAY, "tracks/" + itos(i) + "/compressed", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
+		} else {
+			p_list->push_back(PropertyInfo(Variant::ARRAY, "tracks/" + itos(i) + "/keys", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
+		}
 	}
 }
 
@@ -684,6 +704,7 @@ void Animation::remove_track(int p_track) {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
 			_clear(tt->transforms);
+			tt->compressed = CompressedTransforms();
 
 		} break;
 		case TYPE_VALUE: {
@@ -849,14 +870,22 @@ Error Animation::transform_track_get_key(int p_track, int p_key, Vector3 *r_loc,
 
 	TransformTrack *tt = static_cast<TransformTrack *>(t);
 	ERR_FAIL_COND_V(t->type != TYPE_TRANSFORM, ERR_INVALID_PARAMETER);
-	ERR_FAIL_INDEX_V(p_key, tt->transforms.size(), ERR_INVALID_PARAMETER);
+
+	TransformKey key;
+	if (tt->compressed.keys.size()) {
+		ERR_FAIL_INDEX_V(p_key, tt->compressed.keys.size(), ERR_INVALID_PARAMETER);
+		key = _compressed_decode_key(tt->compressed.keys[p_key], tt->compressed.pages[_compressed_get_key_page(tt->compressed, p_key)]);
+	} else {
+		ERR_FAIL_INDEX_V(p_key, tt->transforms.size(), ERR_INVALID_PARAMETER);
+		key = tt->transforms[p_key].value;
+	}
 
 	if (r_loc)
-		*r_loc = tt->transforms[p_key].value.loc;
+		*r_loc = key.loc;
 	if (r_rot)
-		*r_rot = tt->transforms[p_key].value.rot;
+		*r_rot = key.rot;
 	if (r_scale)
-		*r_scale = tt->transforms[p_key].value.scale;
+		*r_scale = key.scale;
 
 	return OK;
 }
@@ -868,6 +897,7 @@ int Animation::transform_track_insert_key(int p_track, float p_time, const Vecto
 	ERR_FAIL_COND_V(t->type != TYPE_TRANSFORM, -1);
 
 	TransformTrack *tt = static_cast<TransformTrack *>(t);
+	_transform_track_decompress(tt);
 
 	TKey<TransformKey> tkey;
 	tkey.time = p_time;
@@ -896,6 +926,7 @@ void Animation::track_remove_key(int p_track, int p_idx) {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_idx, tt->transforms.size());
 			tt->transforms.remove(p_idx);
 
@@ -949,6 +980,14 @@ int Animation::track_find_key(int p_track, float p_time, bool p_exact) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed.keys.size()) {
+				int k = _compressed_find(tt->compressed, p_time);
+				if (k < 0)
+					return -1;
+				if (_compressed_get_key_time(tt->compressed, k) != p_time && p_exact)
+					return -1;
+				return k;
+			}
 			int k = _find(tt->transforms, p_time);
 			if (k < 0 || k >= tt->transforms.size())
 				return -1;
@@ -1134,6 +1173,8 @@ int Animation::track_get_key_count(int p_track) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed.keys.size())
+				return tt->compressed.keys.size();
 			return tt->transforms.size();
 		} break;
 		case TYPE_VALUE: {
@@ -1176,13 +1217,15 @@ Variant Animation::track_get_key_value(int p_track, int p_key_idx) const {
 
 		case TYPE_TRANSFORM: {
 
-			TransformTrack *tt = static_cast<TransformTrack *>(t);
-			ERR_FAIL_INDEX_V(p_key_idx, tt->transforms.size(), Variant());
+			Vector3 loc;
+			Quat rot;
+			Vector3 scale;
+			ERR_FAIL_COND_V(transform_track_get_key(p_track, p_key_idx, &loc, &rot, &scale) != OK, Variant());
 
 			Dictionary d;
-			d["location"] = tt->transforms[p_key_idx].value.loc;
-			d["rotation"] = tt->transforms[p_key_idx].value.rot;
-			d["scale"] = tt->transforms[p_key_idx].value.scale;
+			d["location"] = loc;
+			d["rotation"] = rot;
+			d["scale"] = scale;
 
 			return d;
 		} break;
@@ -1253,6 +1296,10 @@ float Animation::track_get_key_time(int p_track, int p_key_idx) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed.keys.size()) {
+				ERR_FAIL_INDEX_V(p_key_idx, tt->compressed.keys.size(), -1);
+				return _compressed_get_key_time(tt->compressed, p_key_idx);
+			}
 			ERR_FAIL_INDEX_V(p_key_idx, tt->transforms.size(), -1);
 			return tt->transforms[p_key_idx].time;
 		} break;
@@ -1306,6 +1353,10 @@ float Animation::track_get_key_transition(int p_track, int p_key_idx) const {
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			if (tt->compressed.keys.size()) {
+				ERR_FAIL_INDEX_V(p_key_idx, tt->compressed.keys.size(), -1);
+				return 1; //easing is baked into compressed keys
+			}
 			ERR_FAIL_INDEX_V(p_key_idx, tt->transforms.size(), -1);
 			return tt->transforms[p_key_idx].transition;
 		} break;
@@ -1350,6 +1401,7 @@ void Animation::track_set_key_value(int p_track, int p_key_idx, const Variant &p
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_key_idx, tt->transforms.size());
 			Dictionary d = p_value;
 			if (d.has("location"))
@@ -1428,6 +1480,7 @@ void Animation::track_set_key_transition(int p_track, int p_key_idx, float p_tra
 		case TYPE_TRANSFORM: {
 
 			TransformTrack *tt = static_cast<TransformTrack *>(t);
+			_transform_track_decompress(tt);
 			ERR_FAIL_INDEX(p_key_idx, tt->transforms.size());
 			tt->transforms.write[p_key_idx].transition = p_transition;
 		} break;
@@ -1491,6 +1544,33 @@ int Animation::_find(const Vector<K> &p_keys, float p_time) const {
 	return middle;
 }
 
+template <class K>
+int Animation::_find_with_cursor(const Vector<K> &p_keys, float p_time, int *p_cursor) const {
+
+	int len = p_keys.size();
+	const K *keys = p_keys.ptr();
+
+	//when playing forward, time is usually still between the same two keys or between the next ones
+	for (int i = 0; i < 2; i++) {
+
+		int k = *p_cursor + i;
+		if (k < 0 || k >= len)
+			continue;
+		if (p_time < keys[k].time)
+			break;
+		if (k + 1 == len || p_time <= keys[k + 1].time - CMP_EPSILON) {
+			*p_cursor = k;
+			return k;
+		}
+	}
+
+	int idx = _find(p_keys, p_time);
+	if (idx >= 0)
+		*p_cursor = idx;
+
+	return idx;
+}
+
 Animation::TransformKey Animation::_interpolate(const Animation::TransformKey &p_a, const Animation::TransformKey &p_b, float p_c) const {
 
 	TransformKey ret;
@@ -1644,9 +1724,13 @@ float Animation::_cubic_interpolate(const float &p_pre_a, const float &p_a, cons
 }
 
 template <class T>
-T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok) const {
+T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok, int *p_cursor) const {
 
-	int len = _find(p_keys, length) + 1; // try to find last key (there may be more past the end)
+	int len;
+	if (p_keys.size() && p_keys[p_keys.size() - 1].time <= length)
+		len = p_keys.size(); // common case, no need to search
+	else
+		len = _find(p_keys, length) + 1; // try to find last key (there may be more past the end)
 
 	if (len <= 0) {
 		// (-1 or -2 returned originally) (plus one above)
@@ -1661,7 +1745,7 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 		return p_keys[0].value;
 	}
 
-	int idx = _find(p_keys, p_time);
+	int idx = p_cursor ? _find_with_cursor(p_keys, p_time, p_cursor) : _find(p_keys, p_time);
 
 	ERR_FAIL_COND_V(idx == -2, T());
 
@@ -1787,7 +1871,7 @@ T Animation::_interpolate(const Vector<TKey<T> > &p_keys, float p_time, Interpol
 	// do a barrel roll
 }
 
-Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale) const {
+Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale, int *p_cursor) const {
 
 	ERR_FAIL_INDEX_V(p_track, tracks.size(), ERR_INVALID_PARAMETER);
 	Track *t = tracks[p_track];
@@ -1795,12 +1879,20 @@ Error Animation::transform_track_interpolate(int p_track, float p_time, Vector3
 
 	TransformTrack *tt = static_cast<TransformTrack *>(t);
 
-	bool ok = false;
+	TransformKey tk;
 
-	TransformKey tk = _interpolate(tt->transforms, p_time, tt->interpolation, tt->loop_wrap, &ok);
+	if (tt->compressed.keys.size()) {
 
-	if (!ok)
-		return ERR_UNAVAILABLE;
+		tk = _compressed_interpolate(tt->compressed, p_time, tt->interpolation, p_cursor);
+	} else {
+
+		bool ok = false;
+
+		tk = _interpolate(tt->transforms, p_time, tt->interpolation, tt->loop_wrap, &ok, p_cursor);
+
+		if (!ok)
+			return ERR_UNAVAILABLE;
+	}
 
 	if (r_loc)
 		*r_loc = tk.loc;
@@ -1989,8 +2081,13 @@ void Animation::track_get_key_indices_in_range(int p_track, float p_time, float
 				case TYPE_TRANSFORM: {
 
 					const TransformTrack *tt = static_cast<const TransformTrack *>(t);
-					_track_get_key_indices_in_range(tt->transforms, from_time, length, p_indices);
-					_track_get_key_indices_in_range(tt->transforms, 0, to_time, p_indices);
+					if (tt->compressed.keys.size()) {
+						_compressed_get_key_indices_in_range(tt->compressed, from_time, length, p_indices);
+						_compressed_get_key_indices_in_range(tt->compressed, 0, to_time, p_indices);
+					} else {
+						_track_get_key_indices_in_range(tt->transforms, from_time, length, p_indices);
+						_track_get_key_indices_in_range(tt->transforms, 0, to_time, p_indices);
+					}
 
 				} break;
 				case TYPE_VALUE: {
@@ -2049,7 +2146,11 @@ void Animation::track_get_key_indices_in_range(int p_track, float p_time, float
 		case TYPE_TRANSFORM: {
 
 			const TransformTrack *tt = static_cast<const TransformTrack *>(t);
-			_track_get_key_indices_in_range(tt->transforms, from_time, to_time, p_indices);
+			if (tt->compressed.keys.size()) {
+				_compressed_get_key_indices_in_range(tt->compressed, from_time, to_time, p_indices);
+			} else {
+				_track_get_key_indices_in_range(tt->transforms, from_time, to_time, p_indices);
+			}
 
 		} break;
 		case TYPE_VALUE: {
@@ -2728,6 +2829,9 @@ void Animation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("clear"), &Animation::clear);
 	ClassDB::bind_method(D_METHOD("copy_track", "track", "to_animation"), &Animation::copy_track);
 
+	ClassDB::bind_method(D_METHOD("compress", "frame_rate", "max_linear_error", "max_angular_error"), &Animation::compress, DEFVAL(30), DEFVAL(0.001), DEFVAL(0.005));
+	ClassDB::bind_method(D_METHOD("track_is_compressed", "idx"), &Animation::track_is_compressed);
+
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "length", PROPERTY_HINT_RANGE, "0.001,99999,0.001"), "set_length", "get_length");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "loop"), "set_loop", "has_loop");
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "step", PROPERTY_HINT_RANGE, "0,4096,0.001"), "set_step", "get_step");
@@ -2938,6 +3042,9 @@ void Animation::_transform_track_optimize(int p_idx, float p_allowed_linear_err,
 	ERR_FAIL_INDEX(p_idx, tracks.size());
 	ERR_FAIL_COND(tracks[p_idx]->type != TYPE_TRANSFORM);
 	TransformTrack *tt = static_cast<TransformTrack *>(tracks[p_idx]);
+	if (tt->compressed.keys.size())
+		return; // already reduced when compressed
+
 	bool prev_erased = false;
 	TKey<TransformKey> first_erased;
 
@@ -2985,6 +3092,460 @@ void Animation::optimize(float p_allowed_linear_err, float p_allowed_angular_err
 	}
 }
 
+/* COMPRESSED TRANSFORM TRACKS */
+
+static _FORCE_INLINE_ uint16_t _quantize_unit(float p_value, int p_max) {
+
+	return uint16_t(CLAMP(int(Math::round(p_value * p_max)), 0, p_max));
+}
+
+int Animation::_compressed_find_in_page(const CompressedTransformKey *p_keys, int p_from, int p_to, float p_frame) {
+
+	// pages start with a key at frame 0, so there is always one at or before p_frame
+	int low = p_from;
+	int high = p_to - 1;
+
+	while (low < high) {
+
+		int middle = (low + high + 1) / 2;
+		if (p_keys[middle].frame <= p_frame)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+void Animation::_compressed_encode_key(const TransformKey &p_key, const CompressedTransformPage &p_page, CompressedTransformKey *r_key) {
+
+	for (int i = 0; i < 3; i++) {
+
+		r_key->loc[i] = p_page.loc_size[i] > 0 ? _quantize_unit((p_key.loc[i] - p_page.loc_min[i]) / p_page.loc_size[i], 65535) : 0;
+		r_key->scale[i] = p_page.scale_size[i] > 0 ? _quantize_unit((p_key.scale[i] - p_page.scale_min[i]) / p_page.scale_size[i], 65535) : 0;
+	}
+
+	// smallest three, the largest component is rebuilt from the others when decoding
+	Quat q = p_key.rot.normalized();
+	const real_t comps[4] = { q.x, q.y, q.z, q.w };
+	int largest = 0;
+	for (int i = 1; i < 4; i++) {
+		if (Math::abs(comps[i]) > Math::abs(comps[largest]))
+			largest = i;
+	}
+
+	real_t sign = comps[largest] < 0 ? -1.0 : 1.0;
+	int idx = 0;
+	for (int i = 0; i < 4; i++) {
+
+		if (i == largest)
+			continue;
+		// the other components are within [-1/sqrt(2), 1/sqrt(2)]
+		r_key->rot[idx++] = _quantize_unit((comps[i] * sign * Math_SQRT2 + 1.0) * 0.5, 32767);
+	}
+
+	r_key->rot[0] |= (largest & 1) << 15;
+	r_key->rot[1] |= (largest >> 1) << 15;
+}
+
+Animation::TransformKey Animation::_compressed_decode_key(const CompressedTransformKey &p_key, const CompressedTransformPage &p_page) {
+
+	TransformKey ret;
+
+	for (int i = 0; i < 3; i++) {
+
+		ret.loc[i] = p_page.loc_min[i] + p_page.loc_size[i] * (p_key.loc[i] * (1.0 / 65535.0));
+		ret.scale[i] = p_page.scale_min[i] + p_page.scale_size[i] * (p_key.scale[i] * (1.0 / 65535.0));
+	}
+
+	int largest = (p_key.rot[0] >> 15) | ((p_key.rot[1] >> 15) << 1);
+	real_t comps[4];
+	real_t sum = 0;
+	int idx = 0;
+	for (int i = 0; i < 4; i++) {
+
+		if (i == largest)
+			continue;
+		real_t v = ((p_key.rot[idx++] & 0x7FFF) * (2.0 / 32767.0) - 1.0) * Math_SQRT12;
+		comps[i] = v;
+		sum += v * v;
+	}
+	comps[largest] = Math::sqrt(MAX(0.0, 1.0 - sum));
+
+	ret.rot = Quat(comps[0], comps[1], comps[2], comps[3]);
+	return ret;
+}
+
+int Animation::_compressed_get_key_page(const CompressedTransforms &p_compressed, int p_key) const {
+
+	const CompressedTransformPage *pages = p_compressed.pages.ptr();
+	int low = 0;
+	int high = p_compressed.pages.size() - 1;
+
+	while (low < high) {
+
+		int middle = (low + high + 1) / 2;
+		if (pages[middle].first_key <= uint32_t(p_key))
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+float Animation::_compressed_get_key_time(const CompressedTransforms &p_compressed, int p_key) const {
+
+	int page = _compressed_get_key_page(p_compressed, p_key);
+	return (page * COMPRESSED_PAGE_FRAMES + p_compressed.keys[p_key].frame) / p_compressed.frame_rate;
+}
+
+int Animation::_compressed_find(const CompressedTransforms &p_compressed, float p_time) const {
+
+	if (p_time < 0)
+		return -1;
+
+	const CompressedTransformPage *pages = p_compressed.pages.ptr();
+	int page_count = p_compressed.pages.size();
+
+	float frame = p_time * p_compressed.frame_rate;
+	int page = MIN(int(frame) / COMPRESSED_PAGE_FRAMES, page_count - 1);
+	int from = pages[page].first_key;
+	int to = page + 1 < page_count ? int(pages[page + 1].first_key) : p_compressed.keys.size();
+
+	return _compressed_find_in_page(p_compressed.keys.ptr(), from, to, frame - page * COMPRESSED_PAGE_FRAMES);
+}
+
+void Animation::_compressed_get_key_indices_in_range(const CompressedTransforms &p_compressed, float from_time, float to_time, List<int> *p_indices) const {
+
+	if (from_time != length && to_time == length)
+		to_time = length * 1.01; //include a little more if at the end
+
+	int from = _compressed_find(p_compressed, from_time);
+	if (from < 0 || _compressed_get_key_time(p_compressed, from) < from_time)
+		from++;
+
+	for (int i = from; i < p_compressed.keys.size(); i++) {
+
+		if (_compressed_get_key_time(p_compressed, i) >= to_time)
+			break;
+		p_indices->push_back(i);
+	}
+}
+
+Animation::TransformKey Animation::_compressed_interpolate(const CompressedTransforms &p_compressed, float p_time, InterpolationType p_interp, int *p_cursor) const {
+
+	const CompressedTransformPage *pages = p_compressed.pages.ptr();
+	const CompressedTransformKey *keys = p_compressed.keys.ptr();
+	int page_count = p_compressed.pages.size();
+	int key_count = p_compressed.keys.size();
+
+	// the page is found directly from the time, only keys inside it are searched
+	float last_frame = (page_count - 1) * COMPRESSED_PAGE_FRAMES + keys[key_count - 1].frame;
+	float frame = CLAMP(p_time * p_compressed.frame_rate, 0, last_frame);
+	int page = MIN(int(frame) / COMPRESSED_PAGE_FRAMES, page_count - 1);
+	float local_frame = frame - page * COMPRESSED_PAGE_FRAMES;
+	int from = pages[page].first_key;
+	int to = page + 1 < page_count ? int(pages[page + 1].first_key) : key_count;
+
+	int idx = -1;
+
+	if (p_cursor) {
+		//when playing forward, time is usually still between the same two keys or between the next ones
+		for (int i = 0; i < 2; i++) {
+
+			int k = *p_cursor + i;
+			if (k < from || k >= to)
+				continue;
+			if (local_frame < keys[k].frame)
+				break;
+			if (k + 1 == to || local_frame < keys[k + 1].frame) {
+				idx = k;
+				break;
+			}
+		}
+	}
+
+	if (idx < 0) {
+		idx = _compressed_find_in_page(keys, from, to, local_frame);
+	}
+
+	if (p_cursor)
+		*p_cursor = idx;
+
+	TransformKey a = _compressed_decode_key(keys[idx], pages[page]);
+
+	int next_page;
+	float next_frame;
+	if (idx + 1 < to) {
+		next_page = page;
+		next_frame = keys[idx + 1].frame;
+	} else if (page + 1 < page_count) {
+		next_page = page + 1;
+		next_frame = COMPRESSED_PAGE_FRAMES;
+	} else {
+		return a; // at the last key
+	}
+
+	if (p_interp == INTERPOLATION_NEAREST)
+		return a;
+
+	TransformKey b = _compressed_decode_key(keys[idx + 1], pages[next_page]);
+	return _interpolate(a, b, (local_frame - keys[idx].frame) / (next_frame - keys[idx].frame));
+}
+
+PoolVector<uint8_t> Animation::_compressed_serialize(const CompressedTransforms &p_compressed) const {
+
+	int page_count = p_compressed.pages.size();
+	int key_count = p_compressed.keys.size();
+
+	PoolVector<uint8_t> data;
+	data.resize(4 * 3 + page_count * 4 * 13 + key_count * 2 * 10);
+	PoolVector<uint8_t>::Write w = data.write();
+	uint8_t *ptr = w.ptr();
+
+	ptr += encode_float(p_compressed.frame_rate, ptr);
+	ptr += encode_uint32(page_count, ptr);
+	ptr += encode_uint32(key_count, ptr);
+
+	for (int i = 0; i < page_count; i++) {
+
+		const CompressedTransformPage &page = p_compressed.pages[i];
+		ptr += encode_uint32(page.first_key, ptr);
+		for (int j = 0; j < 3; j++) {
+			ptr += encode_float(page.loc_min[j], ptr);
+			ptr += encode_float(page.loc_size[j], ptr);
+			ptr += encode_float(page.scale_min[j], ptr);
+			ptr += encode_float(page.scale_size[j], ptr);
+		}
+	}
+
+	for (int i = 0; i < key_count; i++) {
+
+		const CompressedTransformKey &key = p_compressed.keys[i];
+		ptr += encode_uint16(key.frame, ptr);
+		for (int j = 0; j < 3; j++) {
+			ptr += encode_uint16(key.rot[j], ptr);
+			ptr += encode_uint16(key.loc[j], ptr);
+			ptr += encode_uint16(key.scale[j], ptr);
+		}
+	}
+
+	return data;
+}
+
+bool Animation::_compressed_deserialize(const PoolVector<uint8_t> &p_data, CompressedTransforms *r_compressed) const {
+
+	ERR_FAIL_COND_V(p_data.size() < 4 * 3, false);
+	PoolVector<uint8_t>::Read r = p_data.read();
+	const uint8_t *ptr = r.ptr();
+
+	float frame_rate = decode_float(ptr);
+	int page_count = decode_uint32(ptr + 4);
+	int key_count = decode_uint32(ptr + 8);
+	ptr += 4 * 3;
+
+	ERR_FAIL_COND_V(frame_rate <= 0 || page_count <= 0 || key_count < page_count, false);
+	ERR_FAIL_COND_V(p_data.size() != 4 * 3 + page_count * 4 * 13 + key_count * 2 * 10, false);
+
+	r_compressed->frame_rate = frame_rate;
+	r_compressed->pages.resize(page_count);
+	r_compressed->keys.resize(key_count);
+
+	for (int i = 0; i < page_count; i++) {
+
+		CompressedTransformPage &page = r_compressed->pages.write[i];
+		page.first_key = decode_uint32(ptr);
+		ptr += 4;
+		for (int j = 0; j < 3; j++) {
+			page.loc_min[j] = decode_float(ptr);
+			page.loc_size[j] = decode_float(ptr + 4);
+			page.scale_min[j] = decode_float(ptr + 8);
+			page.scale_size[j] = decode_float(ptr + 12);
+			ptr += 16;
+		}
+
+		// every page must start with its own key
+		ERR_FAIL_COND_V(i == 0 ? page.first_key != 0 : page.first_key <= r_compressed->pages[i - 1].first_key, false);
+		ERR_FAIL_COND_V(page.first_key >= uint32_t(key_count), false);
+	}
+
+	for (int i = 0; i < key_count; i++) {
+
+		CompressedTransformKey &key = r_compressed->keys.write[i];
+		key.frame = decode_uint16(ptr);
+		ptr += 2;
+		for (int j = 0; j < 3; j++) {
+			key.rot[j] = decode_uint16(ptr);
+			key.loc[j] = decode_uint16(ptr + 2);
+			key.scale[j] = decode_uint16(ptr + 4);
+			ptr += 6;
+		}
+	}
+
+	return true;
+}
+
+bool Animation::_compressed_segment_fits(const TransformKey *p_samples, int p_from, int p_to, float p_allowed_linear_err, float p_min_rot_dot) const {
+
+	const TransformKey &a = p_samples[p_from];
+	const TransformKey &b = p_samples[p_to];
+	float span = p_to - p_from;
+
+	for (int i = p_from + 1; i < p_to; i++) {
+
+		float c = (i - p_from) / span;
+		const TransformKey &s = p_samples[i];
+
+		if (s.loc.distance_to(a.loc.linear_interpolate(b.loc, c)) > p_allowed_linear_err)
+			return false;
+		if (s.scale.distance_to(a.scale.linear_interpolate(b.scale, c)) > p_allowed_linear_err)
+			return false;
+		if (Math::abs(s.rot.dot(a.rot.slerp(b.rot, c))) < p_min_rot_dot)
+			return false;
+	}
+
+	return true;
+}
+
+void Animation::_transform_track_compress(int p_idx, float p_frame_rate, float p_allowed_linear_err, float p_allowed_angular_err) {
+
+	ERR_FAIL_INDEX(p_idx, tracks.size());
+	ERR_FAIL_COND(tracks[p_idx]->type != TYPE_TRANSFORM);
+	TransformTrack *tt = static_cast<TransformTrack *>(tracks[p_idx]);
+
+	// nearest tracks can't be resampled, and a single key is as small as it gets
+	if (tt->compressed.keys.size() || tt->interpolation == INTERPOLATION_NEAREST || tt->transforms.size() < 2 || length <= 0)
+		return;
+
+	int frame_count = MAX(1, int(Math::ceil(length * p_frame_rate)));
+	float frame_rate = frame_count / length;
+
+	// resample at a fixed rate, this also bakes the easing and cubic interpolation of the keys
+	Vector<TransformKey> samples;
+	samples.resize(frame_count + 1);
+
+	for (int i = 0; i <= frame_count; i++) {
+
+		bool ok = false;
+		TransformKey tk = _interpolate(tt->transforms, i == frame_count ? length : i / frame_rate, tt->interpolation, tt->loop_wrap, &ok);
+		if (!ok)
+			return; // starts after the beginning of a non looping animation, leave it as is
+		tk.rot.normalize();
+		samples.write[i] = tk;
+	}
+
+	// keep the fewest frames that linear interpolation can rebuild within the allowed error,
+	// checking every frame in between instead of only the neighbours like optimize() does
+	float min_rot_dot = Math::cos(p_allowed_angular_err * 0.5);
+	Vector<int> kept;
+	kept.push_back(0);
+
+	int anchor = 0;
+	while (anchor < frame_count) {
+
+		// every page starts with a key, so a segment can't go past the next page
+		int limit = MIN(frame_count, (anchor / COMPRESSED_PAGE_FRAMES + 1) * COMPRESSED_PAGE_FRAMES);
+		int end = anchor + 1;
+		while (end < limit && _compressed_segment_fits(samples.ptr(), anchor, end + 1, p_allowed_linear_err, min_rot_dot)) {
+			end++;
+		}
+
+		kept.push_back(end);
+		anchor = end;
+	}
+
+	CompressedTransforms compressed;
+	int page_count = frame_count / COMPRESSED_PAGE_FRAMES + 1;
+	compressed.frame_rate = frame_rate;
+	compressed.pages.resize(page_count);
+	compressed.keys.resize(kept.size());
+
+	int key = 0;
+	for (int i = 0; i < page_count; i++) {
+
+		int end = key;
+		while (end < kept.size() && kept[end] / COMPRESSED_PAGE_FRAMES == i) {
+			end++;
+		}
+
+		AABB loc_bounds(samples[kept[key]].loc, Vector3());
+		AABB scale_bounds(samples[kept[key]].scale, Vector3());
+		for (int j = key + 1; j < end; j++) {
+			loc_bounds.expand_to(samples[kept[j]].loc);
+			scale_bounds.expand_to(samples[kept[j]].scale);
+		}
+
+		CompressedTransformPage &page = compressed.pages.write[i];
+		page.first_key = key;
+		page.loc_min = loc_bounds.position;
+		page.loc_size = loc_bounds.size;
+		page.scale_min = scale_bounds.position;
+		page.scale_size = scale_bounds.size;
+
+		for (int j = key; j < end; j++) {
+
+			CompressedTransformKey &ck = compressed.keys.write[j];
+			ck.frame = kept[j] - i * COMPRESSED_PAGE_FRAMES;
+			_compressed_encode_key(samples[kept[j]], page, &ck);
+		}
+
+		key = end;
+	}
+
+	tt->transforms.clear();
+	if (tt->interpolation == INTERPOLATION_CUBIC) {
+		tt->interpolation = INTERPOLATION_LINEAR; // the curve is baked into the kept frames, played back linearly
+	}
+	tt->compressed = compressed;
+}
+
+void Animation::_transform_track_decompress(TransformTrack *p_track) {
+
+	if (p_track->compressed.keys.size() == 0)
+		return;
+
+	const CompressedTransforms &compressed = p_track->compressed;
+	p_track->transforms.resize(compressed.keys.size());
+
+	int page = 0;
+	for (int i = 0; i < compressed.keys.size(); i++) {
+
+		while (page + 1 < compressed.pages.size() && compressed.pages[page + 1].first_key <= uint32_t(i)) {
+			page++;
+		}
+
+		TKey<TransformKey> &tk = p_track->transforms.write[i];
+		tk.time = (page * COMPRESSED_PAGE_FRAMES + compressed.keys[i].frame) / compressed.frame_rate;
+		tk.transition = 1;
+		tk.value = _compressed_decode_key(compressed.keys[i], compressed.pages[page]);
+	}
+
+	p_track->compressed = CompressedTransforms();
+}
+
+bool Animation::track_is_compressed(int p_track) const {
+
+	ERR_FAIL_INDEX_V(p_track, tracks.size(), false);
+	if (tracks[p_track]->type != TYPE_TRANSFORM)
+		return false;
+
+	return static_cast<const TransformTrack *>(tracks[p_track])->compressed.keys.size() > 0;
+}
+
+void Animation::compress(float p_frame_rate, float p_allowed_linear_err, float p_allowed_angular_err) {
+
+	ERR_FAIL_COND(p_frame_rate <= 0);
+
+	for (int i = 0; i < tracks.size(); i++) {
+
+		if (tracks[i]->type == TYPE_TRANSFORM)
+			_transform_track_compress(i, p_frame_rate, p_allowed_linear_err, p_allowed_angular_err);
+	}
+
+	emit_changed();
+}
+
 Animation::Animation() {
 
 	step = 0.1;
@@ -104,11 +104,49 @@ private:
 		Vector3 scale;
 	};
 
+	/* COMPRESSED TRANSFORM TRACK */
+
+	// Compressed tracks are resampled at a fixed frame rate, reduced and quantized.
+	// Frames are grouped in pages, so key times fit in 16 bits, locations and scales
+	// are quantized against the bounds of their page, and the page holding a given
+	// time is found without searching. Every page starts with a key.
+
+	enum {
+		COMPRESSED_PAGE_FRAMES = 256
+	};
+
+	struct CompressedTransformKey {
+
+		uint16_t frame; // relative to the start of the page
+		uint16_t rot[3]; // smallest three, index of the dropped component in the top bits of rot[0] and rot[1]
+		uint16_t loc[3];
+		uint16_t scale[3];
+	};
+
+	struct CompressedTransformPage {
+
+		uint32_t first_key;
+		Vector3 loc_min;
+		Vector3 loc_size;
+		Vector3 scale_min;
+		Vector3 scale_size;
+	};
+
+	struct CompressedTransforms {
+
+		float frame_rate; // adjusted so the last frame falls exactly at the animation length
+		Vector<CompressedTransformPage> pages;
+		Vector<CompressedTransformKey> keys;
+
+		CompressedTransforms() { frame_rate = 0; }
+	};
+
 	/* TRANSFORM TRACK */
 
 	struct TransformTrack : public Track {
 
 		Vector<TKey<TransformKey> > transforms;
+		CompressedTransforms compressed; // used instead of transforms when it has keys
 
 		TransformTrack() { type = TYPE_TRANSFORM; }
 	};
@@ -204,6 +242,8 @@ private:
 
 	template <class K>
 	inline int _find(const Vector<K> &p_keys, float p_time) const;
+	template <class K>
+	inline int _find_with_cursor(const Vector<K> &p_keys, float p_time, int *p_cursor) const;
 
 	_FORCE_INLINE_ Animation::TransformKey _interpolate(const Animation::TransformKey &p_a, const Animation::TransformKey &p_b, float p_c) const;
 
@@ -219,7 +259,18 @@ private:
 	_FORCE_INLINE_ float _cubic_interpolate(const float &p_pre_a, const float &p_a, const float &p_b, const float &p_post_b, float p_c) const;
 
 	template <class T>
-	_FORCE_INLINE_ T _interpolate(const Vector<TKey<T> > &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok) const;
+	_FORCE_INLINE_ T _interpolate(const Vector<TKey<T> > &p_keys, float p_time, InterpolationType p_interp, bool p_loop_wrap, bool *p_ok, int *p_cursor = NULL) const;
+
+	static void _compressed_encode_key(const TransformKey &p_key, const CompressedTransformPage &p_page, CompressedTransformKey *r_key);
+	static TransformKey _compressed_decode_key(const CompressedTransformKey &p_key, const CompressedTransformPage &p_page);
+	static int _compressed_find_in_page(const CompressedTransformKey *p_keys, int p_from, int p_to, float p_frame);
+	int _compressed_get_key_page(const CompressedTransforms &p_compressed, int p_key) const;
+	float _compressed_get_key_time(const CompressedTransforms &p_compressed, int p_key) const;
+	int _compressed_find(const CompressedTransforms &p_compressed, float p_time) const;
+	void _compressed_get_key_indices_in_range(const CompressedTransforms &p_compressed, float from_time, float to_time, List<int> *p_indices) const;
+	TransformKey _compressed_interpolate(const CompressedTransforms &p_compressed, float p_time, InterpolationType p_interp, int *p_cursor) const;
+	PoolVector<uint8_t> _compressed_serialize(const CompressedTransforms &p_compressed) const;
+	bool _compressed_deserialize(const PoolVector<uint8_t> &p_data, CompressedTransforms *r_compressed) const;
 
 	template <class T>
 	_FORCE_INLINE_ void _track_get_key_indices_in_range(const Vector<T> &p_array, float from_time, float to_time, List<int> *p_indices) const;
@@ -272,6 +323,9 @@ private:
 
 	bool _transform_track_optimize_key(const TKey<TransformKey> &t0, const TKey<TransformKey> &t1, const TKey<TransformKey> &t2, float p_alowed_linear_err, float p_alowed_angular_err, float p_max_optimizable_angle, const Vector3 &p_norm);
 	void _transform_track_optimize(int p_idx, float p_allowed_linear_err = 0.05, float p_allowed_angular_err = 0.01, float p_max_optimizable_angle = Math_PI * 0.125);
+	bool _compressed_segment_fits(const TransformKey *p_samples, int p_from, int p_to, float p_allowed_linear_err, float p_min_rot_dot) const;
+	void _transform_track_compress(int p_idx, float p_frame_rate, float p_allowed_linear_err, float p_allowed_angular_err);
+	void _transform_track_decompress(TransformTrack *p_track);
 
 protected:
 	bool _set(const StringName &p_name, const Variant &p_value);
@@ -343,7 +397,9 @@ public:
 	void track_set_interpolation_loop_wrap(int p_track, bool p_enable);
 	bool track_get_interpolation_loop_wrap(int p_track) const;
 
-	Error transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale) const;
+	// p_cursor, if given, is a key index kept by the caller between calls, it makes lookups constant time when playing forward
+	Error transform_track_interpolate(int p_track, float p_time, Vector3 *r_loc, Quat *r_rot, Vector3 *r_scale, int *p_cursor = NULL) const;
+	bool track_is_compressed(int p_track) const;
 
 	Variant value_track_interpolate(int p_track, float p_time) const;
 	void value_track_get_key_indices(int p_track, float p_time, float p_delta, List<int> *p_indices) const;
@@ -370,6 +426,7 @@ public:
 	void clear();
 
 	void optimize(float p_allowed_linear_err = 0.05, float p_allowed_angular_err = 0.01, float p_max_optimizable_angle = Math_PI * 0.125);
+	void compress(float p_frame_rate = 30, float p_allowed_linear_err = 0.001, float p_allowed_angular_err = 0.005);
 
 	Animation();
 	~Animation();
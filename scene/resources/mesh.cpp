@@ -30,6 +30,7 @@
 
 #include "mesh.h"
 
+#include "core/math/mesh_simplifier.h"
 #include "core/pair.h"
 #include "scene/resources/concave_polygon_shape.h"
 #include "scene/resources/convex_polygon_shape.h"
@@ -639,7 +640,15 @@ bool ArrayMesh::_set(const StringName &p_name, const Variant &p_value) {
 				}
 			}
 
-			add_surface(format, PrimitiveType(primitive), array_data, vertex_count, array_index_data, index_count, aabb, blend_shapes, bone_aabb);
+			Array lods;
+			if (d.has("lods") && blend_shapes.empty()) {
+				lods = d["lods"];
+				if (idx == 0 && lods.size()) {
+					_create_lods(lods.size());
+				}
+			}
+
+			_add_surface(format, PrimitiveType(primitive), array_data, vertex_count, array_index_data, index_count, aabb, blend_shapes, bone_aabb, lods);
 		} else {
 			ERR_FAIL_V(false);
 		}
@@ -721,6 +730,19 @@ bool ArrayMesh::_get(const StringName &p_name, Variant &r_ret) const {
 
 	d["blend_shape_data"] = md;
 
+	if (lod_meshes.size()) {
+		Array lods;
+		for (int i = 0; i < lod_meshes.size(); i++) {
+			//an empty level is drawn with the full detail indices
+			if (VS::get_singleton()->mesh_surface_get_format(lod_meshes[i], idx) & ARRAY_FORMAT_INDEX) {
+				lods.push_back(VS::get_singleton()->mesh_surface_get_index_array(lod_meshes[i], idx));
+			} else {
+				lods.push_back(PoolVector<uint8_t>());
+			}
+		}
+		d["lods"] = lods;
+	}
+
 	Ref<Material> m = surface_get_material(idx);
 	if (m.is_valid())
 		d["material"] = m;
@@ -769,7 +791,84 @@ void ArrayMesh::_recompute_aabb() {
 	}
 }
 
-void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const PoolVector<uint8_t> &p_array, int p_vertex_count, const PoolVector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<PoolVector<uint8_t> > &p_blend_shapes, const Vector<AABB> &p_bone_aabbs) {
+void ArrayMesh::_clear_lods() {
+
+	if (lod_meshes.empty())
+		return;
+
+	VisualServer::get_singleton()->mesh_set_lods(mesh, Vector<RID>(), Vector<float>());
+	for (int i = 0; i < lod_meshes.size(); i++) {
+		VisualServer::get_singleton()->free(lod_meshes[i]);
+	}
+	lod_meshes.clear();
+}
+
+void ArrayMesh::_create_lods(int p_lod_count) {
+
+	_clear_lods();
+
+	for (int i = 0; i < p_lod_count; i++) {
+		RID lod_mesh = VisualServer::get_singleton()->mesh_create();
+		VisualServer::get_singleton()->mesh_set_custom_aabb(lod_mesh, custom_aabb);
+		lod_meshes.push_back(lod_mesh);
+	}
+
+	_update_lod_table();
+}
+
+void ArrayMesh::_add_surface_to_lods(int p_surface, const Array &p_lod_index_data) {
+
+	VisualServer *vs = VisualServer::get_singleton();
+
+	uint32_t format = vs->mesh_surface_get_format(mesh, p_surface);
+	int vertex_count = vs->mesh_surface_get_array_len(mesh, p_surface);
+	RID material = surfaces[p_surface].material.is_valid() ? surfaces[p_surface].material->get_rid() : RID();
+
+	PoolVector<uint8_t> index_array;
+	int index_count = 0;
+	if (format & ARRAY_FORMAT_INDEX) {
+		index_array = vs->mesh_surface_get_index_array(mesh, p_surface);
+		index_count = vs->mesh_surface_get_array_index_len(mesh, p_surface);
+	}
+
+	int index_size = vertex_count < (1 << 16) ? 2 : 4;
+
+	//levels share the vertex buffer of the surface, only their indices are uploaded
+	for (int i = 0; i < lod_meshes.size(); i++) {
+
+		PoolVector<uint8_t> lod_index_array = index_array;
+		int lod_index_count = index_count;
+
+		//levels past the ones generated for this surface reuse its coarsest
+		if (p_lod_index_data.size()) {
+			PoolVector<uint8_t> data = p_lod_index_data[MIN(i, p_lod_index_data.size() - 1)];
+			if (data.size()) {
+				lod_index_array = data;
+				lod_index_count = data.size() / index_size;
+			}
+		}
+
+		vs->mesh_add_lod_surface(lod_meshes[i], mesh, p_surface, lod_index_array, lod_index_count);
+		vs->mesh_surface_set_material(lod_meshes[i], p_surface, material);
+	}
+}
+
+void ArrayMesh::_update_lod_table() {
+
+	Vector<float> ratios;
+	ratios.resize(lod_meshes.size());
+
+	float ratio = 1.0;
+	for (int i = 0; i < lod_meshes.size(); i++) {
+		//levels without a ratio of their own take half the previous one
+		ratio = MIN(ratio, i < lod_screen_ratios.size() ? lod_screen_ratios[i] : ratio * 0.5);
+		ratios.write[i] = ratio;
+	}
+
+	VisualServer::get_singleton()->mesh_set_lods(mesh, lod_meshes, ratios);
+}
+
+void ArrayMesh::_add_surface(uint32_t p_format, PrimitiveType p_primitive, const PoolVector<uint8_t> &p_array, int p_vertex_count, const PoolVector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<PoolVector<uint8_t> > &p_blend_shapes, const Vector<AABB> &p_bone_aabbs, const Array &p_lod_index_data) {
 
 	Surface s;
 	s.aabb = p_aabb;
@@ -778,6 +877,15 @@ void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const
 	_recompute_aabb();
 
 	VisualServer::get_singleton()->mesh_add_surface(mesh, p_format, (VS::PrimitiveType)p_primitive, p_array, p_vertex_count, p_index_array, p_index_count, p_aabb, p_blend_shapes, p_bone_aabbs);
+
+	if (lod_meshes.size()) {
+		_add_surface_to_lods(surfaces.size() - 1, p_lod_index_data);
+	}
+}
+
+void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const PoolVector<uint8_t> &p_array, int p_vertex_count, const PoolVector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<PoolVector<uint8_t> > &p_blend_shapes, const Vector<AABB> &p_bone_aabbs) {
+
+	_add_surface(p_format, p_primitive, p_array, p_vertex_count, p_index_array, p_index_count, p_aabb, p_blend_shapes, p_bone_aabbs, Array());
 }
 
 void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, const Array &p_arrays, const Array &p_blend_shapes, uint32_t p_flags) {
@@ -814,6 +922,10 @@ void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, const Array &
 		_recompute_aabb();
 	}
 
+	if (lod_meshes.size()) {
+		_add_surface_to_lods(surfaces.size() - 1, Array());
+	}
+
 	clear_cache();
 	_change_notify();
 	emit_changed();
@@ -891,8 +1003,15 @@ void ArrayMesh::surface_remove(int p_idx) {
 
 	ERR_FAIL_INDEX(p_idx, surfaces.size());
 	VisualServer::get_singleton()->mesh_remove_surface(mesh, p_idx);
+	for (int i = 0; i < lod_meshes.size(); i++) {
+		VisualServer::get_singleton()->mesh_remove_surface(lod_meshes[i], p_idx);
+	}
 	surfaces.remove(p_idx);
 
+	if (surfaces.empty()) {
+		_clear_lods();
+	}
+
 	clear_cache();
 	_recompute_aabb();
 	_change_notify();
@@ -930,6 +1049,9 @@ void ArrayMesh::surface_set_material(int p_idx, const Ref<Material> &p_material)
 		return;
 	surfaces.write[p_idx].material = p_material;
 	VisualServer::get_singleton()->mesh_surface_set_material(mesh, p_idx, p_material.is_null() ? RID() : p_material->get_rid());
+	for (int i = 0; i < lod_meshes.size(); i++) {
+		VisualServer::get_singleton()->mesh_surface_set_material(lod_meshes[i], p_idx, p_material.is_null() ? RID() : p_material->get_rid());
+	}
 
 	_change_notify("material");
 	emit_changed();
@@ -962,6 +1084,7 @@ String ArrayMesh::surface_get_name(int p_idx) const {
 void ArrayMesh::surface_update_region(int p_surface, int p_offset, const PoolVector<uint8_t> &p_data) {
 
 	ERR_FAIL_INDEX(p_surface, surfaces.size());
+	//the LOD surfaces draw from the same vertex buffer
 	VS::get_singleton()->mesh_surface_update_region(mesh, p_surface, p_offset, p_data);
 	emit_changed();
 }
@@ -1002,6 +1125,9 @@ void ArrayMesh::add_surface_from_mesh_data(const Geometry::MeshData &p_mesh_data
 	clear_cache();
 
 	surfaces.push_back(s);
+	if (lod_meshes.size()) {
+		_add_surface_to_lods(surfaces.size() - 1, Array());
+	}
 	_change_notify();
 
 	emit_changed();
@@ -1020,6 +1146,9 @@ void ArrayMesh::set_custom_aabb(const AABB &p_custom) {
 
 	custom_aabb = p_custom;
 	VS::get_singleton()->mesh_set_custom_aabb(mesh, custom_aabb);
+	for (int i = 0; i < lod_meshes.size(); i++) {
+		VS::get_singleton()->mesh_set_custom_aabb(lod_meshes[i], custom_aabb);
+	}
 	emit_changed();
 }
 
@@ -1244,6 +1373,110 @@ Error ArrayMesh::lightmap_unwrap(const Transform &p_base_transform, float p_texe
 	return OK;
 }
 
+Error ArrayMesh::generate_lods(int p_lod_count, float p_reduction, float p_max_error) {
+
+	ERR_FAIL_COND_V(p_lod_count < 1, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_reduction <= 0 || p_reduction >= 1, ERR_INVALID_PARAMETER);
+	ERR_EXPLAIN("Can't generate LODs for a mesh with blend shapes");
+	ERR_FAIL_COND_V(blend_shapes.size() != 0, ERR_UNAVAILABLE);
+
+	Vector<Array> surface_lods;
+	int lod_count = 0;
+
+	for (int i = 0; i < surfaces.size(); i++) {
+
+		Array lods;
+
+		if (surface_get_primitive_type(i) == PRIMITIVE_TRIANGLES && !surfaces[i].is_2d) {
+
+			Array arrays = surface_get_arrays(i);
+			PoolVector<Vector3> vertices = arrays[ARRAY_VERTEX];
+			PoolVector<int> indices = arrays[ARRAY_INDEX];
+
+			if (indices.size() == 0) {
+				indices.resize(vertices.size());
+				PoolVector<int>::Write w = indices.write();
+				for (int j = 0; j < vertices.size(); j++) {
+					w[j] = j;
+				}
+			}
+
+			int index_size = vertices.size() < (1 << 16) ? 2 : 4;
+			float max_error = p_max_error;
+
+			for (int j = 0; j < p_lod_count; j++) {
+
+				int target = int(indices.size() * p_reduction) / 3 * 3;
+				PoolVector<int> lod_indices = MeshSimplifier::simplify(vertices, indices, target, max_error);
+				if (lod_indices.size() == 0 || lod_indices.size() == indices.size()) {
+					break; //no further reduction within the error limit
+				}
+
+				PoolVector<uint8_t> data;
+				data.resize(lod_indices.size() * index_size);
+				{
+					PoolVector<uint8_t>::Write w = data.write();
+					PoolVector<int>::Read r = lod_indices.read();
+
+					if (index_size == 2) {
+						uint16_t *dst = (uint16_t *)w.ptr();
+						for (int k = 0; k < lod_indices.size(); k++) {
+							dst[k] = r[k];
+						}
+					} else {
+						copymem(w.ptr(), r.ptr(), data.size());
+					}
+				}
+
+				lods.push_back(data);
+				indices = lod_indices;
+				max_error *= 2.0; //coarser levels are seen from further away
+			}
+		}
+
+		lod_count = MAX(lod_count, lods.size());
+		surface_lods.push_back(lods);
+	}
+
+	if (lod_count == 0) {
+		_clear_lods();
+	} else {
+		_create_lods(lod_count);
+		for (int i = 0; i < surfaces.size(); i++) {
+			_add_surface_to_lods(i, surface_lods[i]);
+		}
+	}
+
+	emit_changed();
+
+	return OK;
+}
+
+void ArrayMesh::clear_lods() {
+
+	_clear_lods();
+	emit_changed();
+}
+
+int ArrayMesh::get_lod_count() const {
+
+	return lod_meshes.size();
+}
+
+void ArrayMesh::set_lod_screen_ratios(const PoolVector<float> &p_ratios) {
+
+	lod_screen_ratios = p_ratios;
+	if (lod_meshes.size()) {
+		_update_lod_table();
+	}
+	emit_changed();
+}
+
+PoolVector<float> ArrayMesh::get_lod_screen_ratios() const {
+
+	return lod_screen_ratios;
+}
+
 void ArrayMesh::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("add_blend_shape", "name"), &ArrayMesh::add_blend_shape);
@@ -1271,14 +1504,21 @@ void ArrayMesh::_bind_methods() {
 	ClassDB::set_method_flags(get_class_static(), _scs_create("regen_normalmaps"), METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
 	ClassDB::bind_method(D_METHOD("lightmap_unwrap", "transform", "texel_size"), &ArrayMesh::lightmap_unwrap);
 	ClassDB::set_method_flags(get_class_static(), _scs_create("lightmap_unwrap"), METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
+	ClassDB::bind_method(D_METHOD("generate_lods", "lod_count", "reduction", "max_error"), &ArrayMesh::generate_lods, DEFVAL(3), DEFVAL(0.5), DEFVAL(0.01));
+	ClassDB::bind_method(D_METHOD("clear_lods"), &ArrayMesh::clear_lods);
+	ClassDB::bind_method(D_METHOD("get_lod_count"), &ArrayMesh::get_lod_count);
 	ClassDB::bind_method(D_METHOD("get_faces"), &ArrayMesh::get_faces);
 	ClassDB::bind_method(D_METHOD("generate_triangle_mesh"), &ArrayMesh::generate_triangle_mesh);
 
 	ClassDB::bind_method(D_METHOD("set_custom_aabb", "aabb"), &ArrayMesh::set_custom_aabb);
 	ClassDB::bind_method(D_METHOD("get_custom_aabb"), &ArrayMesh::get_custom_aabb);
 
+	ClassDB::bind_method(D_METHOD("set_lod_screen_ratios", "ratios"), &ArrayMesh::set_lod_screen_ratios);
+	ClassDB::bind_method(D_METHOD("get_lod_screen_ratios"), &ArrayMesh::get_lod_screen_ratios);
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "blend_shape_mode", PROPERTY_HINT_ENUM, "Normalized,Relative", PROPERTY_USAGE_NOEDITOR), "set_blend_shape_mode", "get_blend_shape_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::AABB, "custom_aabb", PROPERTY_HINT_NONE, ""), "set_custom_aabb", "get_custom_aabb");
+	ADD_PROPERTY(PropertyInfo(Variant::POOL_REAL_ARRAY, "lod_screen_ratios"), "set_lod_screen_ratios", "get_lod_screen_ratios");
 
 	BIND_CONSTANT(NO_INDEX_ARRAY);
 	BIND_CONSTANT(ARRAY_WEIGHTS_SIZE);
@@ -1306,6 +1546,7 @@ void ArrayMesh::_bind_methods() {
 }
 
 void ArrayMesh::reload_from_file() {
+	_clear_lods();
 	VisualServer::get_singleton()->mesh_clear(mesh);
 	surfaces.clear();
 	clear_blend_shapes();
@@ -1324,5 +1565,6 @@ ArrayMesh::ArrayMesh() {
 
 ArrayMesh::~ArrayMesh() {
 
+	_clear_lods();
 	VisualServer::get_singleton()->free(mesh);
 }
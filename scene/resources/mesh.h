@@ -169,8 +169,18 @@ private:
 	Vector<StringName> blend_shapes;
 	AABB custom_aabb;
 
+	//reduced detail copies of the mesh, sharing its vertex arrays
+	Vector<RID> lod_meshes;
+	PoolVector<float> lod_screen_ratios;
+
 	void _recompute_aabb();
 
+	void _clear_lods();
+	void _create_lods(int p_lod_count);
+	void _add_surface_to_lods(int p_surface, const Array &p_lod_index_data);
+	void _update_lod_table();
+	void _add_surface(uint32_t p_format, PrimitiveType p_primitive, const PoolVector<uint8_t> &p_array, int p_vertex_count, const PoolVector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<PoolVector<uint8_t> > &p_blend_shapes, const Vector<AABB> &p_bone_aabbs, const Array &p_lod_index_data);
+
 protected:
 	virtual bool _is_generated() const { return false; }
 
@@ -227,6 +237,13 @@ public:
 
 	Error lightmap_unwrap(const Transform &p_base_transform = Transform(), float p_texel_size = 0.05);
 
+	Error generate_lods(int p_lod_count = 3, float p_reduction = 0.5, float p_max_error = 0.01);
+	void clear_lods();
+	int get_lod_count() const;
+
+	void set_lod_screen_ratios(const PoolVector<float> &p_ratios);
+	PoolVector<float> get_lod_screen_ratios() const;
+
 	virtual void reload_from_file();
 
 	ArrayMesh();
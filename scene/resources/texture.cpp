@@ -35,6 +35,7 @@
 #include "core/method_bind_ext.gen.inc"
 #include "core/os/os.h"
 #include "scene/resources/bit_map.h"
+#include "scene/resources/texture_streamer.h"
 
 Size2 Texture::get_size() const {
 
@@ -539,6 +540,12 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 		VS::get_singleton()->texture_set_detect_normal_callback(texture, NULL, NULL);
 	}
 #endif
+
+	return _load_image_data(f, tw, th, df, image, p_size_limit);
+}
+
+Error StreamTexture::_load_image_data(FileAccess *f, int tw, int th, uint32_t df, Ref<Image> &image, int p_size_limit) {
+
 	if (!(df & FORMAT_BIT_STREAM)) {
 		p_size_limit = 0;
 	}
@@ -670,7 +677,7 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 			}
 
 			if (idx > 0) {
-				ofs = Image::get_image_data_size(tw, th, format, idx - 1);
+				ofs = Image::get_image_mipmap_offset(tw, th, format, idx);
 			}
 
 			if (total_size - ofs <= 0) {
@@ -708,12 +715,38 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 	return ERR_BUG; //unreachable
 }
 
+Error StreamTexture::_load_stream_image(const String &p_path, int p_size_limit, Ref<Image> &r_image) {
+
+	//same as _load_data, but only touches the file, so it can be used from the streaming thread
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
+
+	uint8_t header[4];
+	f->get_buffer(header, 4);
+	if (header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T') {
+		memdelete(f);
+		ERR_FAIL_V(ERR_FILE_CORRUPT);
+	}
+
+	int tw = f->get_16();
+	f->get_16(); //custom width
+	int th = f->get_16();
+	f->get_16(); //custom height
+	f->get_32(); //flags
+	uint32_t df = f->get_32();
+
+	r_image.instance();
+	return _load_image_data(f, tw, th, df, r_image, p_size_limit);
+}
+
 Error StreamTexture::load(const String &p_path) {
 
 	int lw, lh, lwc, lhc, lflags;
 	Ref<Image> image;
 	image.instance();
-	Error err = _load_data(p_path, lw, lh, lwc, lhc, lflags, image);
+	//when streaming, only the mipmaps up to the minimum size are read now
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	Error err = _load_data(p_path, lw, lh, lwc, lhc, lflags, image, streamer ? streamer->get_min_size() : 0);
 	if (err)
 		return err;
 
@@ -725,7 +758,9 @@ Error StreamTexture::load(const String &p_path) {
 	VS::get_singleton()->texture_set_data(texture, image);
 	if (lwc || lhc) {
 		VS::get_singleton()->texture_set_size_override(texture, lwc, lhc, 0);
-	} else {
+	} else if (image->get_width() != lw || image->get_height() != lh) {
+		//streamed, the small mipmaps stand in for the whole texture
+		VS::get_singleton()->texture_set_size_override(texture, lw, lh, 0);
 	}
 
 	w = lwc ? lwc : lw;
@@ -734,6 +769,12 @@ Error StreamTexture::load(const String &p_path) {
 	path_to_file = p_path;
 	format = image->get_format();
 
+	bool was_streamed = streamed;
+	streamed = image->get_width() < lw || image->get_height() < lh;
+	if (streamer && (streamed || was_streamed)) {
+		streamer->texture_loaded(this, lw, lh, image);
+	}
+
 	_change_notify();
 	return OK;
 }
@@ -755,10 +796,52 @@ RID StreamTexture::get_rid() const {
 	return texture;
 }
 
+void StreamTexture::_stream_set_image(const Ref<Image> &p_image) {
+
+	alpha_cache.unref();
+
+	VS::get_singleton()->texture_allocate(texture, p_image->get_width(), p_image->get_height(), 0, p_image->get_format(), VS::TEXTURE_TYPE_2D, flags);
+	VS::get_singleton()->texture_set_data(texture, p_image);
+	VS::get_singleton()->texture_set_size_override(texture, w, h, 0);
+}
+
+void StreamTexture::request_size(int p_size) {
+
+	ERR_FAIL_COND(Thread::get_caller_id() != Thread::get_main_id());
+
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	if (streamer && streamed) {
+		streamer->texture_request(this, p_size);
+	}
+}
+
+bool StreamTexture::is_streamed() const {
+
+	//only the texture's own state, so this is safe from any thread
+	return streamed && TextureStreamer::get_singleton();
+}
+
+int StreamTexture::get_streamed_size() const {
+
+	ERR_FAIL_COND_V(Thread::get_caller_id() != Thread::get_main_id(), 0);
+
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	return streamer && streamed ? streamer->get_texture_size(this) : 0;
+}
+
+void StreamTexture::_request_draw_size(const Size2 &p_size) const {
+
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	if (streamer && streamed) {
+		streamer->texture_request(const_cast<StreamTexture *>(this), Math::ceil(MAX(p_size.width, p_size.height)), true);
+	}
+}
+
 void StreamTexture::draw(RID p_canvas_item, const Point2 &p_pos, const Color &p_modulate, bool p_transpose, const Ref<Texture> &p_normal_map) const {
 
 	if ((w | h) == 0)
 		return;
+	_request_draw_size(Size2(w, h));
 	RID normal_rid = p_normal_map.is_valid() ? p_normal_map->get_rid() : RID();
 	VisualServer::get_singleton()->canvas_item_add_texture_rect(p_canvas_item, Rect2(p_pos, Size2(w, h)), texture, false, p_modulate, p_transpose, normal_rid);
 }
@@ -766,6 +849,7 @@ void StreamTexture::draw_rect(RID p_canvas_item, const Rect2 &p_rect, bool p_til
 
 	if ((w | h) == 0)
 		return;
+	_request_draw_size(p_tile ? Size2(w, h) : p_rect.size.abs());
 	RID normal_rid = p_normal_map.is_valid() ? p_normal_map->get_rid() : RID();
 	VisualServer::get_singleton()->canvas_item_add_texture_rect(p_canvas_item, p_rect, texture, p_tile, p_modulate, p_transpose, normal_rid);
 }
@@ -773,6 +857,9 @@ void StreamTexture::draw_rect_region(RID p_canvas_item, const Rect2 &p_rect, con
 
 	if ((w | h) == 0)
 		return;
+	if (p_src_rect.size.width != 0 && p_src_rect.size.height != 0) {
+		_request_draw_size(Size2(w, h) * (p_rect.size / p_src_rect.size).abs());
+	}
 	RID normal_rid = p_normal_map.is_valid() ? p_normal_map->get_rid() : RID();
 	VisualServer::get_singleton()->canvas_item_add_texture_rect_region(p_canvas_item, p_rect, texture, p_src_rect, p_modulate, p_transpose, normal_rid, p_clip_uv);
 }
@@ -846,6 +933,9 @@ void StreamTexture::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("load", "path"), &StreamTexture::load);
 	ClassDB::bind_method(D_METHOD("get_load_path"), &StreamTexture::get_load_path);
+	ClassDB::bind_method(D_METHOD("request_size", "size"), &StreamTexture::request_size);
+	ClassDB::bind_method(D_METHOD("is_streamed"), &StreamTexture::is_streamed);
+	ClassDB::bind_method(D_METHOD("get_streamed_size"), &StreamTexture::get_streamed_size);
 
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "load_path", PROPERTY_HINT_FILE, "*.stex"), "load", "get_load_path");
 }
@@ -857,11 +947,17 @@ StreamTexture::StreamTexture() {
 	w = 0;
 	h = 0;
 
+	streamed = false;
+
 	texture = VS::get_singleton()->texture_create();
 }
 
 StreamTexture::~StreamTexture() {
 
+	if (streamed && TextureStreamer::get_singleton()) {
+		TextureStreamer::get_singleton()->texture_removed(this);
+	}
+
 	VS::get_singleton()->free(texture);
 }
 
@@ -41,6 +41,8 @@
 #include "scene/resources/gradient.h"
 #include "servers/visual_server.h"
 
+class FileAccess;
+
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
 */
@@ -187,7 +189,11 @@ public:
 	};
 
 private:
+	friend class TextureStreamer;
+
 	Error _load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, Ref<Image> &image, int p_size_limit = 0);
+	static Error _load_image_data(FileAccess *f, int tw, int th, uint32_t df, Ref<Image> &image, int p_size_limit);
+	static Error _load_stream_image(const String &p_path, int p_size_limit, Ref<Image> &r_image);
 	String path_to_file;
 	RID texture;
 	Image::Format format;
@@ -195,6 +201,11 @@ private:
 	int w, h;
 	mutable Ref<BitMap> alpha_cache;
 
+	bool streamed; //only the smallest mipmaps were loaded, TextureStreamer keeps the rest of the state
+
+	void _stream_set_image(const Ref<Image> &p_image);
+	void _request_draw_size(const Size2 &p_size) const;
+
 	virtual void reload_from_file();
 
 	static void _requested_3d(void *p_ud);
@@ -220,6 +231,10 @@ public:
 	int get_height() const;
 	virtual RID get_rid() const;
 
+	void request_size(int p_size);
+	bool is_streamed() const;
+	int get_streamed_size() const;
+
 	virtual void set_path(const String &p_path, bool p_take_over);
 
 	virtual void draw(RID p_canvas_item, const Point2 &p_pos, const Color &p_modulate = Color(1, 1, 1), bool p_transpose = false, const Ref<Texture> &p_normal_map = Ref<Texture>()) const;
@@ -0,0 +1,495 @@
+/*************************************************************************/
+/*  texture_streamer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "texture_streamer.h"
+
+#include "core/os/os.h"
+#include "scene/resources/texture.h"
+
+TextureStreamer *TextureStreamer::singleton = NULL;
+
+TextureStreamer *TextureStreamer::get_singleton() {
+
+	return singleton;
+}
+
+int TextureStreamer::_fit_size(const Entry &p_entry, int p_size) const {
+
+	//largest dimension of the smallest mipmap that is at least p_size, which is what _load_data picks for that size limit
+	int size = MAX(p_entry.width, p_entry.height);
+	p_size = MAX(p_size, min_size);
+
+	while (size > 1 && (size >> 1) >= p_size) {
+		size >>= 1;
+	}
+
+	return size;
+}
+
+uint64_t TextureStreamer::_get_bytes(const Entry &p_entry, int p_size) const {
+
+	int w = p_entry.width;
+	int h = p_entry.height;
+
+	while ((w > 1 || h > 1) && MAX(w, h) > p_size) {
+		w = MAX(w >> 1, 1);
+		h = MAX(h >> 1, 1);
+	}
+
+	return Image::get_image_data_size(w, h, p_entry.base->get_format(), true);
+}
+
+void TextureStreamer::_apply_changes() {
+
+	mutex->lock();
+	List<Change> applied = changes;
+	changes.clear();
+	mutex->unlock();
+
+	for (List<Change>::Element *E = applied.front(); E; E = E->next()) {
+
+		const Change &change = E->get();
+
+		_remove(change.texture); //loaded again, or freed
+		if (change.removed) {
+			continue;
+		}
+
+		Entry entry;
+		entry.texture = change.texture;
+		entry.path = change.path;
+		entry.width = change.width;
+		entry.height = change.height;
+		entry.size = MAX(change.image->get_width(), change.image->get_height());
+		entry.target_size = entry.size;
+		entry.drawn_size = 0;
+		entry.bytes = change.image->get_data().size();
+		entry.last_used = frame;
+		entry.version = ++version;
+		entry.base = change.image;
+
+		resident_bytes += entry.bytes;
+		target_bytes += _get_bytes(entry, entry.size);
+
+		texture_map[entry.texture] = textures.push_back(entry);
+	}
+}
+
+TextureStreamer::Entry *TextureStreamer::_get_entry(const StreamTexture *p_texture) {
+
+	List<Entry>::Element **E = texture_map.getptr(p_texture->get_instance_id());
+	if (!E) {
+		//may have been loaded on another thread this frame
+		_apply_changes();
+		E = texture_map.getptr(p_texture->get_instance_id());
+	}
+
+	return E ? &(*E)->get() : NULL;
+}
+
+void TextureStreamer::_remove(ObjectID p_texture) {
+
+	List<Entry>::Element **E = texture_map.getptr(p_texture);
+	if (!E) {
+		return;
+	}
+
+	Entry &entry = (*E)->get();
+	_cancel(entry); //results still loading are discarded by version
+
+	resident_bytes -= entry.bytes;
+	target_bytes -= _get_bytes(entry, entry.target_size);
+
+	textures.erase(*E);
+	texture_map.erase(p_texture);
+}
+
+void TextureStreamer::_cancel(Entry &p_entry) {
+
+	//anything still loading for this texture is stale now
+	p_entry.version = ++version;
+
+	mutex->lock();
+	for (List<Request>::Element *E = requests.front(); E; E = E->next()) {
+		if (E->get().texture == p_entry.texture) {
+			requests.erase(E);
+			pending--;
+			break;
+		}
+	}
+	mutex->unlock();
+}
+
+void TextureStreamer::_load(Entry &p_entry, int p_size) {
+
+	if (p_size == p_entry.target_size) {
+		return;
+	}
+
+	target_bytes -= _get_bytes(p_entry, p_entry.target_size);
+	target_bytes += _get_bytes(p_entry, p_size);
+
+	p_entry.target_size = p_size;
+	_cancel(p_entry); //replace a request that was not picked up yet, rather than loading twice
+
+	if (p_size == p_entry.size) {
+		return; //back to what is uploaded already
+	}
+
+	Request request;
+	request.texture = p_entry.texture;
+	request.version = p_entry.version;
+	request.path = p_entry.path;
+	request.size = p_size;
+
+	mutex->lock();
+	requests.push_back(request);
+	pending++;
+	mutex->unlock();
+
+	if (thread) {
+		semaphore->post();
+	}
+}
+
+void TextureStreamer::_trim(Entry &p_entry) {
+
+	StreamTexture *texture = Object::cast_to<StreamTexture>(ObjectDB::get_instance(p_entry.texture));
+	if (!texture) {
+		return; //freed, removed with the next changes
+	}
+
+	//the smallest mipmaps are still in memory, no need to read them again
+	int size = MAX(p_entry.base->get_width(), p_entry.base->get_height());
+
+	target_bytes -= _get_bytes(p_entry, p_entry.target_size);
+	target_bytes += _get_bytes(p_entry, size);
+	p_entry.target_size = size;
+	_cancel(p_entry);
+
+	if (p_entry.size == size) {
+		return;
+	}
+
+	texture->_stream_set_image(p_entry.base);
+
+	resident_bytes -= p_entry.bytes;
+	p_entry.size = size;
+	p_entry.bytes = p_entry.base->get_data().size();
+	resident_bytes += p_entry.bytes;
+}
+
+void TextureStreamer::_load_request(Request &p_request) {
+
+	Ref<Image> image;
+	Error err = StreamTexture::_load_stream_image(p_request.path, p_request.size, image);
+	if (err == OK) {
+		p_request.image = image;
+	}
+}
+
+void TextureStreamer::_thread_func(void *p_userdata) {
+
+	TextureStreamer *ts = (TextureStreamer *)p_userdata;
+
+	while (true) {
+
+		ts->semaphore->wait();
+
+		ts->mutex->lock();
+
+		if (ts->exit_thread) {
+			ts->mutex->unlock();
+			break;
+		}
+
+		if (ts->requests.empty()) {
+			//request was replaced or cancelled before it was picked up
+			ts->mutex->unlock();
+			continue;
+		}
+
+		Request request = ts->requests.front()->get();
+		ts->requests.pop_front();
+		ts->loading = true;
+
+		ts->mutex->unlock();
+
+		_load_request(request);
+
+		ts->mutex->lock();
+		ts->results.push_back(request);
+		ts->loading = false;
+		ts->mutex->unlock();
+	}
+}
+
+void TextureStreamer::set_budget(uint64_t p_bytes) {
+
+	budget = p_bytes;
+}
+
+uint64_t TextureStreamer::get_budget() const {
+
+	return budget;
+}
+
+int TextureStreamer::get_min_size() const {
+
+	return min_size;
+}
+
+uint64_t TextureStreamer::get_resident_bytes() const {
+
+	return resident_bytes;
+}
+
+int TextureStreamer::get_pending_count() const {
+
+	return pending;
+}
+
+void TextureStreamer::texture_loaded(StreamTexture *p_texture, int p_width, int p_height, const Ref<Image> &p_image) {
+
+	Change change;
+	change.texture = p_texture->get_instance_id();
+	change.removed = p_image->get_width() >= p_width && p_image->get_height() >= p_height; //loaded whole, not streamable
+	change.path = p_texture->path_to_file;
+	change.width = p_width;
+	change.height = p_height;
+	if (!change.removed) {
+		change.image = p_image;
+	}
+
+	mutex->lock();
+	changes.push_back(change);
+	mutex->unlock();
+}
+
+void TextureStreamer::texture_removed(StreamTexture *p_texture) {
+
+	Change change;
+	change.texture = p_texture->get_instance_id();
+	change.removed = true;
+	change.width = 0;
+	change.height = 0;
+
+	mutex->lock();
+	changes.push_back(change);
+	mutex->unlock();
+}
+
+void TextureStreamer::texture_request(StreamTexture *p_texture, int p_size, bool p_drawn) {
+
+	Entry *entry = _get_entry(p_texture);
+	if (!entry) {
+		return;
+	}
+
+	//the file may be smaller than the texture, when imported with a size limit
+	int texture_size = MAX(p_texture->w, p_texture->h);
+	int file_size = MAX(entry->width, entry->height);
+	if (texture_size > 0 && texture_size != file_size) {
+		p_size = (int64_t(p_size) * file_size + texture_size - 1) / texture_size;
+	}
+
+	int size = _fit_size(*entry, p_size);
+	if (p_drawn) {
+		entry->drawn_size = size;
+	}
+
+	entry->last_used = frame;
+	List<Entry>::Element *E = texture_map[entry->texture];
+	textures.move_to_back(E);
+
+	if (size > entry->target_size) {
+		_load(*entry, size);
+	}
+}
+
+int TextureStreamer::get_texture_size(const StreamTexture *p_texture) const {
+
+	ObjectID id = p_texture->get_instance_id();
+
+	//a change queued by another thread is newer than the entry, look at it without applying it
+	int size = -1;
+	mutex->lock();
+	for (const List<Change>::Element *E = changes.back(); E; E = E->prev()) {
+
+		const Change &change = E->get();
+		if (change.texture == id) {
+			size = change.removed ? 0 : MAX(change.image->get_width(), change.image->get_height());
+			break;
+		}
+	}
+	mutex->unlock();
+
+	if (size >= 0) {
+		return size;
+	}
+
+	List<Entry>::Element *const *E = texture_map.getptr(id);
+	return E ? (*E)->get().size : 0;
+}
+
+void TextureStreamer::process() {
+
+	_apply_changes();
+
+	if (!thread) {
+		//no thread support, load here
+		while (true) {
+			mutex->lock();
+			if (requests.empty()) {
+				mutex->unlock();
+				break;
+			}
+			Request request = requests.front()->get();
+			requests.pop_front();
+			mutex->unlock();
+
+			_load_request(request);
+			results.push_back(request);
+		}
+	}
+
+	mutex->lock();
+	List<Request> loaded = results;
+	results.clear();
+	mutex->unlock();
+
+	for (List<Request>::Element *E = loaded.front(); E; E = E->next()) {
+
+		const Request &request = E->get();
+		pending--;
+
+		List<Entry>::Element **T = texture_map.getptr(request.texture);
+		if (!T || (*T)->get().version != request.version) {
+			continue;
+		}
+
+		Entry &entry = (*T)->get();
+		StreamTexture *texture = Object::cast_to<StreamTexture>(ObjectDB::get_instance(request.texture));
+		if (!texture) {
+			continue;
+		}
+
+		if (request.image.is_null()) {
+			ERR_PRINTS("Failed streaming mipmaps of texture: " + request.path);
+			_load(entry, entry.size);
+			continue;
+		}
+
+		texture->_stream_set_image(request.image);
+
+		resident_bytes -= entry.bytes;
+		entry.size = entry.target_size;
+		entry.bytes = request.image->get_data().size();
+		resident_bytes += entry.bytes;
+	}
+
+	//over budget, drop the high mipmaps of the textures that were not requested for longest,
+	//but never of the ones requested this frame, nor below what their last draw asked for
+	for (List<Entry>::Element *E = textures.front(); E && target_bytes > budget; E = E->next()) {
+
+		Entry &entry = E->get();
+		if (entry.last_used >= frame) {
+			break;
+		}
+
+		int size = MAX(_fit_size(entry, min_size), entry.drawn_size);
+		if (entry.target_size <= size) {
+			continue;
+		}
+
+		if (size == MAX(entry.base->get_width(), entry.base->get_height())) {
+			_trim(entry);
+		} else {
+			_load(entry, size); //drawn larger than what is kept in memory, read it again
+		}
+	}
+
+	frame++;
+}
+
+void TextureStreamer::flush() {
+
+	while (true) {
+
+		mutex->lock();
+		bool busy = loading || !requests.empty();
+		mutex->unlock();
+
+		if (!busy || !thread) {
+			break;
+		}
+
+		OS::get_singleton()->delay_usec(1000);
+	}
+
+	process();
+}
+
+TextureStreamer::TextureStreamer(uint64_t p_budget, int p_min_size) {
+
+	singleton = this;
+
+	budget = p_budget;
+	min_size = MAX(p_min_size, 1);
+	frame = 0;
+	version = 0;
+	resident_bytes = 0;
+	target_bytes = 0;
+	pending = 0;
+
+	mutex = Mutex::create();
+	semaphore = Semaphore::create();
+	exit_thread = false;
+	loading = false;
+	thread = Thread::create(_thread_func, this); //stays NULL without thread support, process() loads then
+}
+
+TextureStreamer::~TextureStreamer() {
+
+	if (thread) {
+		mutex->lock();
+		exit_thread = true;
+		mutex->unlock();
+		semaphore->post();
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+	}
+
+	memdelete(semaphore);
+	memdelete(mutex);
+
+	singleton = NULL;
+}
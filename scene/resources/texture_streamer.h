@@ -0,0 +1,148 @@
+/*************************************************************************/
+/*  texture_streamer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include "core/hash_map.h"
+#include "core/image.h"
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+
+class StreamTexture;
+
+/*
+	Keeps only the smallest mipmaps of streamable StreamTextures resident, and
+	loads the larger ones on a background thread when a texture asks for a
+	higher resolution. When the streamed textures take more than the memory
+	budget, the ones that have not been requested for the longest time go back
+	to the smallest mipmaps, which are kept in memory for that.
+
+	Textures drawn in 2D keep the size their last draw asked for, as canvas
+	items only draw again when they change.
+
+	Only the .stex files imported with streaming enabled are handled, anything
+	else is loaded whole as before.
+*/
+class TextureStreamer {
+
+	static TextureStreamer *singleton;
+
+	struct Request {
+		ObjectID texture;
+		uint32_t version;
+		String path;
+		int size;
+		Ref<Image> image; //set once loaded
+	};
+
+	//textures may be loaded and freed on any thread, the main thread applies it in process()
+	struct Change {
+		ObjectID texture;
+		bool removed;
+		String path;
+		int width, height;
+		Ref<Image> image;
+	};
+
+	struct Entry {
+		ObjectID texture;
+		String path;
+		int width, height; //largest mipmap in the file
+		int size; //largest dimension of the uploaded mipmap
+		int target_size; //same, once the load in progress is done
+		int drawn_size; //what the last draw asked for, kept until drawn again
+		int bytes;
+		uint64_t last_used;
+		uint32_t version;
+		Ref<Image> base; //the smallest mipmaps, to go back to them without reading the file
+	};
+
+	//shared with the thread
+	Thread *thread;
+	Semaphore *semaphore;
+	Mutex *mutex;
+	bool exit_thread;
+	bool loading;
+	List<Request> requests;
+	List<Request> results;
+	List<Change> changes;
+
+	//main thread only
+	List<Entry> textures; //least recently requested first
+	HashMap<ObjectID, List<Entry>::Element *> texture_map;
+	uint64_t budget;
+	int min_size;
+	uint64_t frame;
+	uint32_t version;
+	uint64_t resident_bytes;
+	uint64_t target_bytes; //what resident_bytes will be once all loads are done
+	int pending;
+
+	int _fit_size(const Entry &p_entry, int p_size) const;
+	uint64_t _get_bytes(const Entry &p_entry, int p_size) const;
+	void _apply_changes();
+	Entry *_get_entry(const StreamTexture *p_texture);
+	void _remove(ObjectID p_texture);
+	void _cancel(Entry &p_entry);
+	void _load(Entry &p_entry, int p_size);
+	void _trim(Entry &p_entry);
+	static void _load_request(Request &p_request);
+	static void _thread_func(void *p_userdata);
+
+public:
+	static TextureStreamer *get_singleton();
+
+	void set_budget(uint64_t p_bytes);
+	uint64_t get_budget() const;
+	int get_min_size() const;
+
+	uint64_t get_resident_bytes() const;
+	int get_pending_count() const;
+
+	//any thread
+	void texture_loaded(StreamTexture *p_texture, int p_width, int p_height, const Ref<Image> &p_image);
+	void texture_removed(StreamTexture *p_texture);
+
+	//main thread
+	void texture_request(StreamTexture *p_texture, int p_size, bool p_drawn = false);
+	int get_texture_size(const StreamTexture *p_texture) const;
+
+	void process(); //once per frame, uploads what was loaded and applies the budget
+	void flush(); //waits for pending loads and uploads them
+
+	TextureStreamer(uint64_t p_budget, int p_min_size);
+	~TextureStreamer();
+};
+
+#endif // TEXTURE_STREAMER_H
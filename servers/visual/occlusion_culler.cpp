@@ -0,0 +1,332 @@
+/*************************************************************************/
+/*  occlusion_culler.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occlusion_culler.h"
+
+OcclusionCuller::ClipVertex OcclusionCuller::_xform(const CameraMatrix &p_matrix, const Vector3 &p_vertex) const {
+
+	const real_t(*m)[4] = p_matrix.matrix;
+
+	ClipVertex v;
+	v.x = m[0][0] * p_vertex.x + m[1][0] * p_vertex.y + m[2][0] * p_vertex.z + m[3][0];
+	v.y = m[0][1] * p_vertex.x + m[1][1] * p_vertex.y + m[2][1] * p_vertex.z + m[3][1];
+	v.z = m[0][2] * p_vertex.x + m[1][2] * p_vertex.y + m[2][2] * p_vertex.z + m[3][2];
+	v.w = m[0][3] * p_vertex.x + m[1][3] * p_vertex.y + m[2][3] * p_vertex.z + m[3][3];
+	return v;
+}
+
+void OcclusionCuller::_rasterize_triangle(const ClipVertex &p_a, const ClipVertex &p_b, const ClipVertex &p_c) {
+
+	// to screen space, pixel centers are at +0.5
+	real_t x[3], y[3], z[3];
+	const ClipVertex *v[3] = { &p_a, &p_b, &p_c };
+	for (int i = 0; i < 3; i++) {
+		real_t inv_w = 1.0 / v[i]->w;
+		x[i] = (v[i]->x * inv_w * 0.5 + 0.5) * width;
+		y[i] = (0.5 - v[i]->y * inv_w * 0.5) * height;
+		z[i] = v[i]->z * inv_w;
+	}
+
+	real_t area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (Math::abs(area) < CMP_EPSILON) {
+		return;
+	}
+
+	if (area < 0) {
+		// occluders are double sided, just flip winding
+		SWAP(x[1], x[2]);
+		SWAP(y[1], y[2]);
+		SWAP(z[1], z[2]);
+		area = -area;
+	}
+
+	int min_x = MAX(0, int(Math::floor(MIN(x[0], MIN(x[1], x[2])))));
+	int max_x = MIN(width - 1, int(Math::ceil(MAX(x[0], MAX(x[1], x[2])))));
+	int min_y = MAX(0, int(Math::floor(MIN(y[0], MIN(y[1], y[2])))));
+	int max_y = MIN(height - 1, int(Math::ceil(MAX(y[0], MAX(y[1], y[2])))));
+
+	if (min_x > max_x || min_y > max_y) {
+		return;
+	}
+
+	// edge functions, evaluated at pixel centers and stepped incrementally
+	real_t inv_area = 1.0 / area;
+	float e_dx[3], e_dy[3], e_row[3], e_bias[3];
+	for (int i = 0; i < 3; i++) {
+		int a = (i + 1) % 3;
+		int b = (i + 2) % 3;
+		e_dx[i] = -(y[b] - y[a]);
+		e_dy[i] = x[b] - x[a];
+		real_t px = min_x + 0.5;
+		real_t py = min_y + 0.5;
+		e_row[i] = (px - x[a]) * e_dx[i] + (py - y[a]) * e_dy[i];
+		// pixels must be fully covered to be written, or boxes could be
+		// culled while partially visible around occluder edges
+		e_bias[i] = (Math::abs(e_dx[i]) + Math::abs(e_dy[i])) * 0.5;
+	}
+
+	// depth is linear in screen space, as a function of the edges
+	float z_dx = (e_dx[0] * z[0] + e_dx[1] * z[1] + e_dx[2] * z[2]) * inv_area;
+	float z_dy = (e_dy[0] * z[0] + e_dy[1] * z[1] + e_dy[2] * z[2]) * inv_area;
+	float z_row = (e_row[0] * z[0] + e_row[1] * z[1] + e_row[2] * z[2]) * inv_area;
+
+	// depth written is the farthest over the pixel, so it stays conservative
+	float z_bias = (Math::abs(z_dx) + Math::abs(z_dy)) * 0.5;
+	z_row += z_bias;
+
+	for (int i = 0; i < 3; i++) {
+		e_row[i] -= e_bias[i];
+	}
+
+	float *depth_ptr = depth.ptrw();
+
+	for (int py = min_y; py <= max_y; py++) {
+
+		float *row = &depth_ptr[py * width + min_x];
+		int count = max_x - min_x + 1;
+
+		// branchless and computed from the column index, so the compiler
+		// can vectorize it
+		for (int i = 0; i < count; i++) {
+			float fi = float(i);
+			float e0 = e_row[0] + fi * e_dx[0];
+			float e1 = e_row[1] + fi * e_dx[1];
+			float e2 = e_row[2] + fi * e_dx[2];
+			float pz = z_row + fi * z_dx;
+			bool inside = (e0 >= 0) & (e1 >= 0) & (e2 >= 0) & (pz < row[i]);
+			row[i] = inside ? pz : row[i];
+		}
+
+		e_row[0] += e_dy[0];
+		e_row[1] += e_dy[1];
+		e_row[2] += e_dy[2];
+		z_row += z_dy;
+	}
+}
+
+void OcclusionCuller::_clip_and_rasterize_triangle(const ClipVertex &p_a, const ClipVertex &p_b, const ClipVertex &p_c) {
+
+	// only clipping against the near plane (z > -w) is needed, the rest is
+	// handled by the screen bounds
+	const ClipVertex *in[3] = { &p_a, &p_b, &p_c };
+	real_t dist[3];
+	int inside_count = 0;
+	for (int i = 0; i < 3; i++) {
+		dist[i] = in[i]->z + in[i]->w;
+		if (dist[i] > 0) {
+			inside_count++;
+		}
+	}
+
+	if (inside_count == 0) {
+		return;
+	}
+
+	if (inside_count == 3) {
+		_rasterize_triangle(p_a, p_b, p_c);
+		return;
+	}
+
+	ClipVertex out[4];
+	int out_count = 0;
+
+	for (int i = 0; i < 3; i++) {
+		int j = (i + 1) % 3;
+		if (dist[i] > 0) {
+			out[out_count++] = *in[i];
+		}
+		if ((dist[i] > 0) != (dist[j] > 0)) {
+			real_t t = dist[i] / (dist[i] - dist[j]);
+			ClipVertex &v = out[out_count++];
+			v.x = in[i]->x + (in[j]->x - in[i]->x) * t;
+			v.y = in[i]->y + (in[j]->y - in[i]->y) * t;
+			v.z = in[i]->z + (in[j]->z - in[i]->z) * t;
+			v.w = in[i]->w + (in[j]->w - in[i]->w) * t;
+		}
+	}
+
+	for (int i = 2; i < out_count; i++) {
+		_rasterize_triangle(out[0], out[i - 1], out[i]);
+	}
+}
+
+void OcclusionCuller::set_width(int p_width) {
+
+	ERR_FAIL_COND(p_width < TILE_SIZE);
+	width = p_width;
+}
+
+void OcclusionCuller::begin(const CameraMatrix &p_projection, const Transform &p_cam_transform) {
+
+	// keep the buffer aspect the same as the projection
+	real_t aspect = Math::abs(p_projection.matrix[1][1] / p_projection.matrix[0][0]);
+	int new_height = CLAMP(int(width / aspect), TILE_SIZE, width * 4);
+
+	if (new_height != height || depth.size() != width * new_height) {
+		height = new_height;
+		tiles_x = (width + TILE_SIZE - 1) >> TILE_SHIFT;
+		tiles_y = (height + TILE_SIZE - 1) >> TILE_SHIFT;
+		depth.resize(width * height);
+		tile_max_depth.resize(tiles_x * tiles_y);
+	}
+
+	float *depth_ptr = depth.ptrw();
+	for (int i = 0; i < width * height; i++) {
+		depth_ptr[i] = 1.0;
+	}
+
+	view_projection = p_projection * CameraMatrix(p_cam_transform.affine_inverse());
+	has_occluders = false;
+}
+
+void OcclusionCuller::add_occluder(const Transform &p_transform, const Vector3 *p_vertices, int p_vertex_count, const int *p_indices, int p_index_count) {
+
+	CameraMatrix mvp = view_projection * CameraMatrix(p_transform);
+
+	for (int i = 0; i + 2 < p_index_count; i += 3) {
+
+		int a = p_indices[i + 0];
+		int b = p_indices[i + 1];
+		int c = p_indices[i + 2];
+		ERR_CONTINUE(a < 0 || b < 0 || c < 0 || a >= p_vertex_count || b >= p_vertex_count || c >= p_vertex_count);
+
+		_clip_and_rasterize_triangle(_xform(mvp, p_vertices[a]), _xform(mvp, p_vertices[b]), _xform(mvp, p_vertices[c]));
+	}
+
+	has_occluders = true;
+}
+
+void OcclusionCuller::end() {
+
+	if (!has_occluders) {
+		return;
+	}
+
+	const float *depth_ptr = depth.ptr();
+	float *tile_ptr = tile_max_depth.ptrw();
+
+	for (int ty = 0; ty < tiles_y; ty++) {
+		for (int tx = 0; tx < tiles_x; tx++) {
+
+			int from_x = tx << TILE_SHIFT;
+			int from_y = ty << TILE_SHIFT;
+			int to_x = MIN(from_x + TILE_SIZE, width);
+			int to_y = MIN(from_y + TILE_SIZE, height);
+
+			float max_depth = -1.0;
+			for (int y = from_y; y < to_y; y++) {
+				const float *row = &depth_ptr[y * width];
+				for (int x = from_x; x < to_x; x++) {
+					max_depth = MAX(max_depth, row[x]);
+				}
+			}
+
+			tile_ptr[ty * tiles_x + tx] = max_depth;
+		}
+	}
+}
+
+bool OcclusionCuller::is_occluded(const AABB &p_aabb) const {
+
+	if (!has_occluders) {
+		return false;
+	}
+
+	real_t min_x = 1e20, min_y = 1e20, max_x = -1e20, max_y = -1e20;
+	real_t min_z = 1e20;
+
+	for (int i = 0; i < 8; i++) {
+
+		Vector3 corner = p_aabb.position;
+		if (i & 1) corner.x += p_aabb.size.x;
+		if (i & 2) corner.y += p_aabb.size.y;
+		if (i & 4) corner.z += p_aabb.size.z;
+
+		ClipVertex v = _xform(view_projection, corner);
+		if (v.z + v.w <= 0) {
+			return false; // crosses the near plane, assume visible
+		}
+
+		real_t inv_w = 1.0 / v.w;
+		real_t sx = (v.x * inv_w * 0.5 + 0.5) * width;
+		real_t sy = (0.5 - v.y * inv_w * 0.5) * height;
+		min_x = MIN(min_x, sx);
+		max_x = MAX(max_x, sx);
+		min_y = MIN(min_y, sy);
+		max_y = MAX(max_y, sy);
+		min_z = MIN(min_z, v.z * inv_w);
+	}
+
+	int from_x = MAX(0, int(Math::floor(min_x)));
+	int to_x = MIN(width - 1, int(Math::ceil(max_x)));
+	int from_y = MAX(0, int(Math::floor(min_y)));
+	int to_y = MIN(height - 1, int(Math::ceil(max_y)));
+
+	if (from_x > to_x || from_y > to_y) {
+		return false; // outside the buffer, leave it to frustum culling
+	}
+
+	const float *depth_ptr = depth.ptr();
+	const float *tile_ptr = tile_max_depth.ptr();
+
+	for (int ty = from_y >> TILE_SHIFT; ty <= to_y >> TILE_SHIFT; ty++) {
+		for (int tx = from_x >> TILE_SHIFT; tx <= to_x >> TILE_SHIFT; tx++) {
+
+			if (tile_ptr[ty * tiles_x + tx] < min_z) {
+				continue; // everything in this tile is in front of the box
+			}
+
+			int y_begin = MAX(from_y, ty << TILE_SHIFT);
+			int y_end = MIN(to_y, ((ty + 1) << TILE_SHIFT) - 1);
+			int x_begin = MAX(from_x, tx << TILE_SHIFT);
+			int x_end = MIN(to_x, ((tx + 1) << TILE_SHIFT) - 1);
+
+			for (int y = y_begin; y <= y_end; y++) {
+				const float *row = &depth_ptr[y * width];
+				for (int x = x_begin; x <= x_end; x++) {
+					if (row[x] >= min_z) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+OcclusionCuller::OcclusionCuller() {
+
+	width = 256;
+	height = 0;
+	tiles_x = 0;
+	tiles_y = 0;
+	has_occluders = false;
+}
@@ -0,0 +1,88 @@
+/*************************************************************************/
+/*  occlusion_culler.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include "core/math/camera_matrix.h"
+#include "core/vector.h"
+
+/**
+	CPU occlusion culling. Occluder triangles are rasterized into a small
+	depth buffer from the camera point of view, then bounding boxes are
+	tested against it. The buffer stores normalized device depth, and a
+	per tile maximum is kept so most tests don't need to look at pixels.
+
+	Testing is read only, so it can be done from several threads once
+	end() was called.
+*/
+
+class OcclusionCuller {
+
+	enum {
+		TILE_SHIFT = 3,
+		TILE_SIZE = 1 << TILE_SHIFT,
+	};
+
+	struct ClipVertex {
+		real_t x, y, z, w;
+	};
+
+	int width;
+	int height;
+	int tiles_x;
+	int tiles_y;
+
+	Vector<float> depth;
+	Vector<float> tile_max_depth;
+
+	CameraMatrix view_projection;
+	bool has_occluders;
+
+	_FORCE_INLINE_ ClipVertex _xform(const CameraMatrix &p_matrix, const Vector3 &p_vertex) const;
+	void _rasterize_triangle(const ClipVertex &p_a, const ClipVertex &p_b, const ClipVertex &p_c);
+	void _clip_and_rasterize_triangle(const ClipVertex &p_a, const ClipVertex &p_b, const ClipVertex &p_c);
+
+public:
+	void set_width(int p_width);
+	int get_width() const { return width; }
+	int get_height() const { return height; }
+
+	void begin(const CameraMatrix &p_projection, const Transform &p_cam_transform);
+	void add_occluder(const Transform &p_transform, const Vector3 *p_vertices, int p_vertex_count, const int *p_indices, int p_index_count);
+	void end();
+
+	_FORCE_INLINE_ bool is_active() const { return has_occluders; }
+	bool is_occluded(const AABB &p_aabb) const;
+
+	OcclusionCuller();
+};
+
+#endif // OCCLUSION_CULLER_H
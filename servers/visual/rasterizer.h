@@ -258,6 +258,7 @@ public:
 
 	virtual bool material_is_animated(RID p_material) = 0;
 	virtual bool material_casts_shadows(RID p_material) = 0;
+	virtual bool material_is_opaque(RID p_material) = 0;
 
 	virtual void material_add_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance) = 0;
 	virtual void material_remove_instance_owner(RID p_material, RasterizerScene::InstanceBase *p_instance) = 0;
@@ -302,6 +303,12 @@ public:
 
 	virtual void mesh_clear(RID p_mesh) = 0;
 
+	virtual void mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count) = 0;
+	virtual void mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios) = 0;
+	virtual int mesh_get_lod_count(RID p_mesh) const = 0;
+	virtual RID mesh_get_lod(RID p_mesh, int p_lod) const = 0;
+	virtual float mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const = 0;
+
 	/* MULTIMESH API */
 
 	virtual RID multimesh_create() = 0;
@@ -329,6 +336,9 @@ public:
 
 	virtual AABB multimesh_get_aabb(RID p_multimesh) const = 0;
 
+	virtual void multimesh_set_compute_aabb(RID p_multimesh, bool p_enable) = 0; //off for multimeshes that are never culled, their AABB stays empty
+	virtual void update_dirty_multimeshes() = 0; //uploads pending multimesh changes now, rather than at the next resource update
+
 	/* IMMEDIATE API */
 
 	virtual RID immediate_create() = 0;
@@ -354,6 +364,7 @@ public:
 	virtual Transform skeleton_bone_get_transform(RID p_skeleton, int p_bone) const = 0;
 	virtual void skeleton_bone_set_transform_2d(RID p_skeleton, int p_bone, const Transform2D &p_transform) = 0;
 	virtual Transform2D skeleton_bone_get_transform_2d(RID p_skeleton, int p_bone) const = 0;
+	virtual void skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array) = 0;
 	virtual void skeleton_set_base_transform_2d(RID p_skeleton, const Transform2D &p_base_transform) = 0;
 	virtual void skeleton_set_world_transform(RID p_skeleton, bool p_enable, const Transform &p_world_transform) = 0;
 
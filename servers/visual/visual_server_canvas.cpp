@@ -35,19 +35,17 @@
 
 void VisualServerCanvas::_render_canvas_item_tree(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RasterizerCanvas::Light *p_lights) {
 
-	static const int z_range = VS::CANVAS_ITEM_Z_MAX - VS::CANVAS_ITEM_Z_MIN + 1;
-	RasterizerCanvas::Item *z_list[z_range];
-	RasterizerCanvas::Item *z_last_list[z_range];
-
-	memset(z_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
-	memset(z_last_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
+	z_list_min = Z_RANGE;
+	z_list_max = -1;
 
 	_render_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, NULL, NULL);
 
-	for (int i = 0; i < z_range; i++) {
+	for (int i = z_list_min; i <= z_list_max; i++) {
 		if (!z_list[i])
 			continue;
 		VSG::canvas_render->canvas_render_items(z_list[i], VS::CANVAS_ITEM_Z_MIN + i, p_modulate, p_lights, p_transform);
+		z_list[i] = NULL;
+		z_last_list[i] = NULL;
 	}
 }
 
@@ -68,6 +66,18 @@ void _collect_ysort_children(VisualServerCanvas::Item *p_canvas_item, Transform2
 	}
 }
 
+void _update_ysort_children(VisualServerCanvas::Item *p_canvas_item, Transform2D p_transform) {
+	int child_item_count = p_canvas_item->child_items.size();
+	VisualServerCanvas::Item **child_items = p_canvas_item->child_items.ptrw();
+	for (int i = 0; i < child_item_count; i++) {
+		child_items[i]->ysort_xform = p_transform;
+		child_items[i]->ysort_pos = p_transform.xform(child_items[i]->xform.elements[2]);
+
+		if (child_items[i]->sort_y)
+			_update_ysort_children(child_items[i], p_transform * child_items[i]->xform);
+	}
+}
+
 void _mark_ysort_dirty(VisualServerCanvas::Item *ysort_owner, RID_Owner<VisualServerCanvas::Item> &canvas_item_owner) {
 	while (ysort_owner && ysort_owner->sort_y) {
 		ysort_owner->ysort_children_count = -1;
@@ -75,6 +85,56 @@ void _mark_ysort_dirty(VisualServerCanvas::Item *ysort_owner, RID_Owner<VisualSe
 	}
 }
 
+void VisualServerCanvas::_sort_ysort_children(Item *p_canvas_item) {
+
+	Item *ci = p_canvas_item;
+
+	if (ci->ysort_children_count == -1) {
+
+		ci->ysort_children_count = 0;
+		_collect_ysort_children(ci, Transform2D(), NULL, ci->ysort_children_count);
+
+		ci->ysort_children.resize(ci->ysort_children_count);
+		int i = 0;
+		_collect_ysort_children(ci, Transform2D(), ci->ysort_children.ptrw(), i);
+
+		SortArray<Item *, ItemPtrSort> sorter;
+		sorter.sort(ci->ysort_children.ptrw(), ci->ysort_children_count);
+		return;
+	}
+
+	_update_ysort_children(ci, Transform2D());
+
+	//last frame's order is almost right when only a few items moved, so
+	//insertion sort it, unless it turns out to be too far off
+	Item **items = ci->ysort_children.ptrw();
+	int count = ci->ysort_children_count;
+	int max_shifts = count * YSORT_MAX_SHIFTS_PER_ITEM;
+	int shifts = 0;
+	ItemPtrSort compare;
+
+	for (int i = 1; i < count; i++) {
+
+		Item *item = items[i];
+		if (!compare(item, items[i - 1]))
+			continue;
+
+		int j = i;
+		do {
+			items[j] = items[j - 1];
+			j--;
+		} while (j > 0 && compare(item, items[j - 1]));
+		items[j] = item;
+
+		shifts += i - j;
+		if (shifts > max_shifts) {
+			SortArray<Item *, ItemPtrSort> sorter;
+			sorter.sort(items, count);
+			return;
+		}
+	}
+}
+
 void VisualServerCanvas::_render_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner) {
 
 	Item *ci = p_canvas_item;
@@ -122,19 +182,10 @@ void VisualServerCanvas::_render_canvas_item(Item *p_canvas_item, const Transfor
 
 	if (ci->sort_y) {
 
-		if (ci->ysort_children_count == -1) {
-			ci->ysort_children_count = 0;
-			_collect_ysort_children(ci, Transform2D(), NULL, ci->ysort_children_count);
-		}
+		_sort_ysort_children(ci);
 
 		child_item_count = ci->ysort_children_count;
-		child_items = (Item **)alloca(child_item_count * sizeof(Item *));
-
-		int i = 0;
-		_collect_ysort_children(ci, Transform2D(), child_items, i);
-
-		SortArray<Item *, ItemPtrSort> sorter;
-		sorter.sort(child_items, child_item_count);
+		child_items = ci->ysort_children.ptrw();
 	}
 
 	if (ci->z_relative)
@@ -171,6 +222,8 @@ void VisualServerCanvas::_render_canvas_item(Item *p_canvas_item, const Transfor
 		ci->light_masked = false;
 
 		int zidx = p_z - VS::CANVAS_ITEM_Z_MIN;
+		z_list_min = MIN(z_list_min, zidx);
+		z_list_max = MAX(z_list_max, zidx);
 
 		if (z_last_list[zidx]) {
 			z_last_list[zidx]->next = ci;
@@ -242,18 +295,14 @@ void VisualServerCanvas::render_canvas(Canvas *p_canvas, const Transform2D &p_tr
 
 	if (!has_mirror) {
 
-		static const int z_range = VS::CANVAS_ITEM_Z_MAX - VS::CANVAS_ITEM_Z_MIN + 1;
-		RasterizerCanvas::Item *z_list[z_range];
-		RasterizerCanvas::Item *z_last_list[z_range];
-
-		memset(z_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
-		memset(z_last_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
+		z_list_min = Z_RANGE;
+		z_list_max = -1;
 
 		for (int i = 0; i < l; i++) {
 			_render_canvas_item(ci[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, NULL, NULL);
 		}
 
-		for (int i = 0; i < z_range; i++) {
+		for (int i = z_list_min; i <= z_list_max; i++) {
 			if (!z_list[i])
 				continue;
 
@@ -262,6 +311,8 @@ void VisualServerCanvas::render_canvas(Canvas *p_canvas, const Transform2D &p_tr
 			}
 
 			VSG::canvas_render->canvas_render_items(z_list[i], VS::CANVAS_ITEM_Z_MIN + i, p_canvas->modulate, p_lights, p_transform);
+			z_list[i] = NULL;
+			z_last_list[i] = NULL;
 		}
 	} else {
 
@@ -873,8 +924,11 @@ void VisualServerCanvas::canvas_item_set_sort_children_by_y(RID p_item, bool p_e
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->sort_y = p_enable;
+	canvas_item->ysort_children_count = -1;
 
-	_mark_ysort_dirty(canvas_item, canvas_item_owner);
+	//a y-sorted parent flattens the children of this item too, or stops doing so
+	if (canvas_item_owner.owns(canvas_item->parent))
+		_mark_ysort_dirty(canvas_item_owner.get(canvas_item->parent), canvas_item_owner);
 }
 void VisualServerCanvas::canvas_item_set_z_index(RID p_item, int p_z) {
 
@@ -1434,4 +1488,9 @@ bool VisualServerCanvas::free(RID p_rid) {
 }
 
 VisualServerCanvas::VisualServerCanvas() {
+
+	memset(z_list, 0, Z_RANGE * sizeof(RasterizerCanvas::Item *));
+	memset(z_last_list, 0, Z_RANGE * sizeof(RasterizerCanvas::Item *));
+	z_list_min = Z_RANGE;
+	z_list_max = -1;
 }
@@ -51,6 +51,7 @@ public:
 		int ysort_children_count;
 		Transform2D ysort_xform;
 		Vector2 ysort_pos;
+		Vector<Item *> ysort_children; //kept sorted between frames, only rebuilt when the hierarchy changes
 
 		Vector<Item *> child_items;
 
@@ -151,6 +152,18 @@ public:
 	RID_Owner<RasterizerCanvas::Light> canvas_light_owner;
 
 private:
+	enum {
+		Z_RANGE = VS::CANVAS_ITEM_Z_MAX - VS::CANVAS_ITEM_Z_MIN + 1,
+		YSORT_MAX_SHIFTS_PER_ITEM = 2 //past this, the y-sorted children moved too much for insertion sort
+	};
+
+	//kept cleared between item trees, only the used range is walked and reset
+	RasterizerCanvas::Item *z_list[Z_RANGE];
+	RasterizerCanvas::Item *z_last_list[Z_RANGE];
+	int z_list_min;
+	int z_list_max;
+
+	void _sort_ysort_children(Item *p_canvas_item);
 	void _render_canvas_item_tree(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RasterizerCanvas::Light *p_lights);
 	void _render_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner);
 	void _light_mask_canvas_items(int p_z, RasterizerCanvas::Item *p_canvas_item, RasterizerCanvas::Light *p_masked_lights);
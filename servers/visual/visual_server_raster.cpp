@@ -101,6 +101,7 @@ void VisualServerRaster::draw(bool p_swap_buffers, double frame_step) {
 
 	VSG::rasterizer->begin_frame(frame_step);
 
+	VSG::scene->update_render_info();
 	VSG::scene->update_dirty_instances(); //update scene stuff
 
 	VSG::viewport->draw_viewports();
@@ -141,6 +142,8 @@ void VisualServerRaster::finish() {
 		free(test_cube);
 	}
 
+	VSG::scene->free_instance_batches();
+
 	VSG::rasterizer->finalize();
 }
 
@@ -148,6 +151,10 @@ void VisualServerRaster::finish() {
 
 int VisualServerRaster::get_render_info(RenderInfo p_info) {
 
+	if (p_info == INFO_INSTANCES_BATCHED_IN_FRAME) {
+		return VSG::scene->get_instances_batched_in_frame();
+	}
+
 	return VSG::storage->get_render_info(p_info);
 }
 
@@ -245,6 +245,12 @@ public:
 
 	BIND1(mesh_clear, RID)
 
+	BIND5(mesh_add_lod_surface, RID, RID, int, const PoolVector<uint8_t> &, int)
+	BIND3(mesh_set_lods, RID, const Vector<RID> &, const Vector<float> &)
+	BIND1RC(int, mesh_get_lod_count, RID)
+	BIND2RC(RID, mesh_get_lod, RID, int)
+	BIND2RC(float, mesh_get_lod_screen_ratio, RID, int)
+
 	/* MULTIMESH API */
 
 	BIND0R(RID, multimesh_create)
@@ -295,6 +301,7 @@ public:
 	BIND2RC(Transform, skeleton_bone_get_transform, RID, int)
 	BIND3(skeleton_bone_set_transform_2d, RID, int, const Transform2D &)
 	BIND2RC(Transform2D, skeleton_bone_get_transform_2d, RID, int)
+	BIND2(skeleton_set_bones_as_bulk_array, RID, const PoolVector<float> &)
 	BIND2(skeleton_set_base_transform_2d, RID, const Transform2D &)
 	BIND3(skeleton_set_world_transform, RID, bool, const Transform &)
 
@@ -435,6 +442,11 @@ public:
 	BIND2(camera_set_environment, RID, RID)
 	BIND2(camera_set_use_vertical_aspect, RID, bool)
 
+	/* OCCLUDER API */
+
+	BIND0R(RID, occluder_create)
+	BIND3(occluder_set_mesh, RID, const PoolVector<Vector3> &, const PoolVector<int> &)
+
 #undef BINDBASE
 //from now on, calls forwarded to this singleton
 #define BINDBASE VSG::viewport
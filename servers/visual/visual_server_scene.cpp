@@ -30,6 +30,7 @@
 
 #include "visual_server_scene.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "visual_server_globals.h"
 #include "visual_server_raster.h"
 #include <new>
@@ -90,9 +91,49 @@ void VisualServerScene::camera_set_use_vertical_aspect(RID p_camera, bool p_enab
 	camera->vaspect = p_enable;
 }
 
+/* OCCLUDER API */
+
+RID VisualServerScene::occluder_create() {
+
+	Occluder *occluder = memnew(Occluder);
+	return occluder_owner.make_rid(occluder);
+}
+
+void VisualServerScene::occluder_set_mesh(RID p_occluder, const PoolVector<Vector3> &p_vertices, const PoolVector<int> &p_indices) {
+
+	Occluder *occluder = occluder_owner.get(p_occluder);
+	ERR_FAIL_COND(!occluder);
+	ERR_FAIL_COND(p_indices.size() % 3 != 0);
+
+	int vertex_count = p_vertices.size();
+
+	{
+		PoolVector<int>::Read r = p_indices.read();
+		for (int i = 0; i < p_indices.size(); i++) {
+			ERR_FAIL_INDEX(r[i], vertex_count);
+		}
+	}
+
+	occluder->vertices = p_vertices;
+	occluder->indices = p_indices;
+	occluder->aabb = AABB();
+
+	if (vertex_count) {
+		PoolVector<Vector3>::Read r = p_vertices.read();
+		occluder->aabb.position = r[0];
+		for (int i = 1; i < vertex_count; i++) {
+			occluder->aabb.expand_to(r[i]);
+		}
+	}
+
+	for (Set<Instance *>::Element *E = occluder->users.front(); E; E = E->next()) {
+		_instance_queue_update(E->get(), true, false);
+	}
+}
+
 /* SCENARIO API */
 
-void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int) {
+void *VisualServerScene::_instance_pair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -171,7 +212,7 @@ void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance
 
 	return NULL;
 }
-void VisualServerScene::_instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *udata) {
+void VisualServerScene::_instance_unpair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int, void *udata) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -247,8 +288,8 @@ RID VisualServerScene::scenario_create() {
 	RID scenario_rid = scenario_owner.make_rid(scenario);
 	scenario->self = scenario_rid;
 
-	scenario->octree.set_pair_callback(_instance_pair, this);
-	scenario->octree.set_unpair_callback(_instance_unpair, this);
+	scenario->sp.use_bvh = use_bvh;
+	scenario->sp.set_pair_callbacks(_instance_pair, _instance_unpair, this);
 	scenario->reflection_probe_shadow_atlas = VSG::scene_render->shadow_atlas_create();
 	VSG::scene_render->shadow_atlas_set_size(scenario->reflection_probe_shadow_atlas, 1024); //make enough shadows for close distance, don't bother with rest
 	VSG::scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 0, 4);
@@ -326,7 +367,14 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 	if (instance->base_type != VS::INSTANCE_NONE) {
 		//free anything related to that base
 
-		VSG::storage->instance_remove_dependency(instance->base, instance);
+		if (instance->base_type == VS::INSTANCE_OCCLUDER) {
+			Occluder *occluder = occluder_owner.getornull(instance->base);
+			if (occluder) {
+				occluder->users.erase(instance);
+			}
+		} else {
+			VSG::storage->instance_remove_dependency(instance->base, instance);
+		}
 
 		if (instance->base_type == VS::INSTANCE_GI_PROBE) {
 			//if gi probe is baking, wait until done baking, else race condition may happen when removing it
@@ -345,9 +393,9 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 			}
 		}
 
-		if (scenario && instance->octree_id) {
-			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (scenario && instance->spatial_partition_id) {
+			scenario->sp.erase(instance->spatial_partition_id); //make dependencies generated by the spatial partition go away
+			instance->spatial_partition_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -422,7 +470,11 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 
 	if (p_base.is_valid()) {
 
-		instance->base_type = VSG::storage->get_base_type(p_base);
+		if (occluder_owner.owns(p_base)) {
+			instance->base_type = VS::INSTANCE_OCCLUDER;
+		} else {
+			instance->base_type = VSG::storage->get_base_type(p_base);
+		}
 		ERR_FAIL_COND(instance->base_type == VS::INSTANCE_NONE);
 
 		switch (instance->base_type) {
@@ -476,10 +528,16 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 				gi_probe->probe_instance = VSG::scene_render->gi_probe_instance_create();
 
 			} break;
+			case VS::INSTANCE_OCCLUDER: {
+
+				occluder_owner.get(p_base)->users.insert(instance);
+			} break;
 			default: {}
 		}
 
-		VSG::storage->instance_add_dependency(p_base, instance);
+		if (instance->base_type != VS::INSTANCE_OCCLUDER) {
+			VSG::storage->instance_add_dependency(p_base, instance);
+		}
 
 		instance->base = p_base;
 
@@ -496,9 +554,9 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 
 		instance->scenario->instances.remove(&instance->scenario_item);
 
-		if (instance->octree_id) {
-			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (instance->spatial_partition_id) {
+			instance->scenario->sp.erase(instance->spatial_partition_id); //make dependencies generated by the spatial partition go away
+			instance->spatial_partition_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -648,26 +706,26 @@ void VisualServerScene::instance_set_visible(RID p_instance, bool p_visible) {
 
 	switch (instance->base_type) {
 		case VS::INSTANCE_LIGHT: {
-			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sp.set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_REFLECTION_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sp.set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_LIGHTMAP_CAPTURE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sp.set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_GI_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
+			if (instance->spatial_partition_id && instance->scenario) {
+				instance->scenario->sp.set_pairable(instance->spatial_partition_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
 			}
 
 		} break;
@@ -770,7 +828,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_aabb(const AABB &p_aabb, RID
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_aabb(p_aabb, cull, 1024);
+	culled = scenario->sp.cull_aabb(p_aabb, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -793,7 +851,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_ray(const Vector3 &p_from, co
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
+	culled = scenario->sp.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 		Instance *instance = cull[i];
@@ -816,7 +874,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_convex(const Vector<Plane> &p
 	int culled = 0;
 	Instance *cull[1024];
 
-	culled = scenario->octree.cull_convex(p_convex, cull, 1024);
+	culled = scenario->sp.cull_convex(p_convex, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -944,7 +1002,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		return;
 	}
 
-	if (p_instance->octree_id == 0) {
+	if (p_instance->spatial_partition_id == 0) {
 
 		uint32_t base_type = 1 << p_instance->base_type;
 		uint32_t pairable_mask = 0;
@@ -962,8 +1020,8 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			pairable = true;
 		}
 
-		// not inside octree
-		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		// not inside spatial partition
+		p_instance->spatial_partition_id = p_instance->scenario->sp.create(p_instance, new_aabb, pairable, base_type, pairable_mask);
 
 	} else {
 
@@ -972,7 +1030,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			return;
 		*/
 
-		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->sp.move(p_instance->spatial_partition_id, new_aabb);
 	}
 }
 
@@ -1039,6 +1097,11 @@ void VisualServerScene::_update_instance_aabb(Instance *p_instance) {
 
 			new_aabb = VSG::storage->lightmap_capture_get_bounds(p_instance->base);
 
+		} break;
+		case VisualServer::INSTANCE_OCCLUDER: {
+
+			new_aabb = occluder_owner.get(p_instance->base)->aabb;
+
 		} break;
 		default: {}
 	}
@@ -1309,7 +1372,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
 				//optimize min/max
 				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = p_scenario->sp.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
 				//check distance max and min
 
@@ -1507,7 +1570,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = p_scenario->sp.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
@@ -1571,7 +1634,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
 					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+					int cull_count = p_scenario->sp.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
 
 					for (int j = 0; j < cull_count; j++) {
@@ -1625,7 +1688,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 					Vector<Plane> planes = cm.get_projection_planes(xform);
 
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+					int cull_count = p_scenario->sp.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 					Plane near_plane(xform.origin, -xform.basis.get_axis(2));
 					for (int j = 0; j < cull_count; j++) {
@@ -1662,7 +1725,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+			int cull_count = p_scenario->sp.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
 			for (int j = 0; j < cull_count; j++) {
@@ -1725,7 +1788,7 @@ void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_view
 		} break;
 	}
 
-	_prepare_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+	_prepare_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), p_camera);
 	_render_scene(camera->transform, camera_matrix, ortho, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 #endif
 }
@@ -1804,17 +1867,474 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInter
 		mono_transform *= apply_z_shift;
 
 		// now prepare our scene with our adjusted transform projection matrix
-		_prepare_scene(mono_transform, combined_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+		_prepare_scene(mono_transform, combined_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), p_camera);
 	} else if (p_eye == ARVRInterface::EYE_MONO) {
 		// For mono render, prepare as per usual
-		_prepare_scene(cam_transform, camera_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+		_prepare_scene(cam_transform, camera_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), p_camera);
 	}
 
 	// And render our scene...
 	_render_scene(cam_transform, camera_matrix, false, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
-void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe) {
+void VisualServerScene::_prepare_scene_cull_chunk(uint32_t p_chunk, InstanceCullParams *p_params) {
+
+	InstanceCullChunk &chunk = instance_cull_chunks[p_chunk];
+	chunk.geometry_count = 0;
+	chunk.serial_count = 0;
+	chunk.redraw = false;
+
+	for (int i = chunk.from; i < chunk.to; i++) {
+
+		Instance *ins = instance_cull_result[i];
+
+		if ((p_params->camera_layer_mask & ins->layer_mask) == 0 || !ins->visible) {
+
+			ins->last_render_pass = 0; // make invalid
+			continue;
+		}
+
+		if (ins->base_type == VS::INSTANCE_LIGHT || ins->base_type == VS::INSTANCE_REFLECTION_PROBE || ins->base_type == VS::INSTANCE_GI_PROBE) {
+
+			instance_cull_serial[chunk.from + chunk.serial_count++] = ins;
+			continue;
+		}
+
+		if (!((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) || ins->cast_shadows == VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+
+			ins->last_render_pass = 0; // make invalid
+			continue;
+		}
+
+		if (p_params->occlusion_cull && occlusion_culler.is_occluded(ins->transformed_aabb)) {
+
+			ins->last_render_pass = 0; // hidden behind an occluder
+			continue;
+		}
+
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
+
+		if (ins->redraw_if_visible) {
+			chunk.redraw = true;
+		}
+
+		if (geom->lighting_dirty) {
+			int l = 0;
+			//only called when lights AABB enter/exit this geometry
+			ins->light_instances.resize(geom->lighting.size());
+
+			for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+
+				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+
+				ins->light_instances.write[l++] = light->instance;
+			}
+
+			geom->lighting_dirty = false;
+		}
+
+		if (geom->reflection_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			ins->reflection_probe_instances.resize(geom->reflection_probes.size());
+
+			for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
+
+				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+
+				ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
+			}
+
+			geom->reflection_dirty = false;
+		}
+
+		if (geom->gi_probes_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			ins->gi_probe_instances.resize(geom->gi_probes.size());
+
+			for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+
+				ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+			}
+
+			geom->gi_probes_dirty = false;
+		}
+
+		ins->depth = p_params->near_plane.distance_to(ins->transform.origin);
+		ins->depth_layer = CLAMP(int(ins->depth * 16 / p_params->z_far), 0, 15);
+
+		if (ins->base_type == VS::INSTANCE_PARTICLES) {
+			//requesting particle processing is not thread safe, decided later
+			instance_cull_serial[chunk.from + chunk.serial_count++] = ins;
+			continue;
+		}
+
+		ins->last_render_pass = render_pass;
+
+		if (p_params->lod && geom->lod_meshes.size()) {
+
+			Instance *lod_proxy = _instance_select_lod(ins, geom, p_params);
+			if (lod_proxy) {
+				ins = lod_proxy;
+				ins->last_render_pass = render_pass;
+			}
+		}
+
+		instance_cull_result[chunk.from + chunk.geometry_count++] = ins;
+	}
+}
+
+VisualServerScene::Instance *VisualServerScene::_instance_select_lod(Instance *p_instance, InstanceGeometryData *p_geom, const InstanceCullParams *p_params) {
+
+	if (p_instance->blend_values.size()) {
+		return NULL; //reduced levels carry no blend shapes
+	}
+
+	//bounding sphere radius relative to half the viewport height
+	const AABB &aabb = p_instance->transformed_aabb;
+	float screen_ratio = aabb.size.length() * 0.5 * p_params->lod_scale;
+	if (!p_params->cam_orthogonal) {
+		screen_ratio /= MAX(p_params->cam_position.distance_to(aabb.position + aabb.size * 0.5), CMP_EPSILON);
+	}
+
+	//a level is only left once the ratio is clearly past its thresholds, so objects do not flicker
+	int lod = 0;
+	int min_lod = 0;
+	int max_lod = 0;
+	for (int i = 0; i < p_geom->lod_screen_ratios.size(); i++) {
+
+		float threshold = p_geom->lod_screen_ratios[i];
+		if (screen_ratio < threshold) {
+			lod = i + 1;
+		}
+		if (screen_ratio < threshold * (1.0 - mesh_lod_hysteresis)) {
+			min_lod = i + 1;
+		}
+		if (screen_ratio < threshold * (1.0 + mesh_lod_hysteresis)) {
+			max_lod = i + 1;
+		}
+	}
+
+	//the previous level is the one this view selected, a view seen for the first time takes the oldest slot
+	InstanceGeometryData::LODView *view = NULL;
+	InstanceGeometryData::LODView *oldest = &p_geom->lod_views[0];
+	for (int i = 0; i < MAX_LOD_VIEWS; i++) {
+
+		InstanceGeometryData::LODView *v = &p_geom->lod_views[i];
+		if (v->last_pass && v->view == p_params->lod_view) {
+			view = v;
+			break;
+		}
+		if (v->last_pass < oldest->last_pass) {
+			oldest = v;
+		}
+	}
+
+	if (view) {
+		lod = CLAMP(view->lod, min_lod, max_lod);
+	} else {
+		view = oldest;
+		view->view = p_params->lod_view;
+	}
+
+	view->lod = lod;
+	view->last_pass = render_pass;
+
+	if (lod == 0) {
+		return NULL;
+	}
+
+	Instance *proxy = p_geom->lod_proxy;
+	if (!proxy) {
+		proxy = memnew(Instance);
+		proxy->base_data = memnew(InstanceGeometryData);
+		p_geom->lod_proxy = proxy;
+	}
+
+	proxy->base_type = p_instance->base_type;
+	proxy->base = p_geom->lod_meshes[lod - 1];
+	proxy->skeleton = p_instance->skeleton;
+	proxy->material_override = p_instance->material_override;
+	proxy->transform = p_instance->transform;
+	proxy->depth_layer = p_instance->depth_layer;
+	proxy->layer_mask = p_instance->layer_mask;
+	proxy->materials = p_instance->materials;
+	proxy->light_instances = p_instance->light_instances;
+	proxy->reflection_probe_instances = p_instance->reflection_probe_instances;
+	proxy->gi_probe_instances = p_instance->gi_probe_instances;
+	proxy->cast_shadows = p_instance->cast_shadows;
+	proxy->mirror = p_instance->mirror;
+	proxy->receive_shadows = p_instance->receive_shadows;
+	proxy->baked_light = p_instance->baked_light;
+	proxy->redraw_if_visible = p_instance->redraw_if_visible;
+	proxy->depth = p_instance->depth;
+	proxy->lightmap_capture = p_instance->lightmap_capture;
+	proxy->lightmap = p_instance->lightmap;
+	proxy->lightmap_capture_data = p_instance->lightmap_capture_data;
+	proxy->aabb = p_instance->aabb;
+	proxy->transformed_aabb = p_instance->transformed_aabb;
+	proxy->object_ID = p_instance->object_ID;
+
+	InstanceGeometryData *proxy_geom = static_cast<InstanceGeometryData *>(proxy->base_data);
+	proxy_geom->can_cast_shadows = p_geom->can_cast_shadows;
+	proxy_geom->material_is_animated = p_geom->material_is_animated;
+	proxy_geom->can_batch = p_geom->can_batch;
+
+	return proxy;
+}
+
+bool VisualServerScene::_render_occluders(Scenario *p_scenario, const Vector<Plane> &p_planes, const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, uint32_t p_visible_layers) {
+
+	int occluder_count = p_scenario->sp.cull_convex(p_planes, occluder_cull_result, MAX_OCCLUDERS_CULLED, 1 << VS::INSTANCE_OCCLUDER);
+	if (occluder_count == 0) {
+		return false;
+	}
+
+	occlusion_culler.begin(p_cam_projection, p_cam_transform);
+
+	for (int i = 0; i < occluder_count; i++) {
+
+		Instance *ins = occluder_cull_result[i];
+		if ((p_visible_layers & ins->layer_mask) == 0 || !ins->visible) {
+			continue;
+		}
+
+		Occluder *occluder = occluder_owner.get(ins->base);
+		if (occluder->indices.size() == 0) {
+			continue;
+		}
+
+		PoolVector<Vector3>::Read vr = occluder->vertices.read();
+		PoolVector<int>::Read ir = occluder->indices.read();
+		occlusion_culler.add_occluder(ins->transform, vr.ptr(), occluder->vertices.size(), ir.ptr(), occluder->indices.size());
+	}
+
+	occlusion_culler.end();
+
+	return occlusion_culler.is_active();
+}
+
+uint32_t VisualServerScene::_instance_batch_hash(const Instance *p_instance) {
+
+	uint32_t hash = hash_djb2_one_64(p_instance->base.get_id());
+	hash = hash_djb2_one_64(p_instance->material_override.get_id(), hash);
+	hash = hash_djb2_one_32(p_instance->layer_mask, hash);
+	hash = hash_djb2_one_32((p_instance->mirror ? 1 : 0) | (p_instance->receive_shadows ? 2 : 0) | (p_instance->baked_light ? 4 : 0) | (p_instance->cast_shadows << 3), hash);
+
+	for (int i = 0; i < p_instance->light_instances.size(); i++) {
+		hash = hash_djb2_one_64(p_instance->light_instances[i].get_id(), hash);
+	}
+	for (int i = 0; i < p_instance->reflection_probe_instances.size(); i++) {
+		hash = hash_djb2_one_64(p_instance->reflection_probe_instances[i].get_id(), hash);
+	}
+	for (int i = 0; i < p_instance->gi_probe_instances.size(); i++) {
+		hash = hash_djb2_one_64(p_instance->gi_probe_instances[i].get_id(), hash);
+	}
+
+	return hash;
+}
+
+static _FORCE_INLINE_ bool _rid_vectors_equal(const Vector<RID> &p_a, const Vector<RID> &p_b) {
+
+	if (p_a.size() != p_b.size()) {
+		return false;
+	}
+
+	for (int i = 0; i < p_a.size(); i++) {
+		if (p_a[i] != p_b[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool VisualServerScene::_instance_batch_compatible(const Instance *p_a, const Instance *p_b) {
+
+	return p_a->base == p_b->base &&
+		   p_a->material_override == p_b->material_override &&
+		   p_a->layer_mask == p_b->layer_mask &&
+		   p_a->mirror == p_b->mirror &&
+		   p_a->receive_shadows == p_b->receive_shadows &&
+		   p_a->baked_light == p_b->baked_light &&
+		   p_a->cast_shadows == p_b->cast_shadows &&
+		   _rid_vectors_equal(p_a->light_instances, p_b->light_instances) &&
+		   _rid_vectors_equal(p_a->reflection_probe_instances, p_b->reflection_probe_instances) &&
+		   _rid_vectors_equal(p_a->gi_probe_instances, p_b->gi_probe_instances);
+}
+
+void VisualServerScene::_batch_instances() {
+
+	int candidate_count = 0;
+
+	for (int i = 0; i < instance_cull_count; i++) {
+
+		Instance *ins = instance_cull_result[i];
+
+		if (ins->base_type != VS::INSTANCE_MESH || ins->skeleton.is_valid() || ins->blend_values.size() || ins->lightmap.is_valid() || !ins->lightmap_capture_data.empty()) {
+			continue;
+		}
+
+		if (!static_cast<InstanceGeometryData *>(ins->base_data)->can_batch) {
+			continue;
+		}
+
+		InstanceBatchSort &sort = instance_batch_sort[candidate_count++];
+		sort.hash = _instance_batch_hash(ins);
+		sort.index = i;
+	}
+
+	if (candidate_count < instance_batching_min_instances) {
+		return;
+	}
+
+	SortArray<InstanceBatchSort> sorter;
+	sorter.sort(instance_batch_sort, candidate_count);
+
+	int batch_count = 0;
+	bool merged = false;
+
+	int from = 0;
+	while (from < candidate_count) {
+
+		int to = from + 1;
+		while (to < candidate_count && instance_batch_sort[to].hash == instance_batch_sort[from].hash) {
+			to++;
+		}
+
+		//the run shares a hash, but may still hold several groups if hashes collide
+		for (int i = from; i < to; i++) {
+
+			int leader_index = instance_batch_sort[i].index;
+			if (leader_index < 0) {
+				continue;
+			}
+
+			Instance *leader = instance_cull_result[leader_index];
+
+			int count = 1;
+			for (int j = i + 1; j < to; j++) {
+				int index = instance_batch_sort[j].index;
+				if (index >= 0 && _instance_batch_compatible(leader, instance_cull_result[index])) {
+					count++;
+				}
+			}
+
+			if (count < instance_batching_min_instances) {
+				instance_batch_sort[i].index = -1;
+				continue;
+			}
+
+			if (batch_count == instance_batches.size()) {
+
+				InstanceBatch new_batch;
+				new_batch.proxy = memnew(Instance);
+				new_batch.proxy->base_type = VS::INSTANCE_MULTIMESH;
+				new_batch.multimesh = VSG::storage->multimesh_create();
+				VSG::storage->multimesh_set_compute_aabb(new_batch.multimesh, false); //the proxy is already culled
+				new_batch.capacity = 0;
+				instance_batches.push_back(new_batch);
+			}
+
+			InstanceBatch &batch = instance_batches.write[batch_count++];
+
+			if (batch.capacity < count) {
+				batch.capacity = next_power_of_2(count);
+				VSG::storage->multimesh_allocate(batch.multimesh, batch.capacity, VS::MULTIMESH_TRANSFORM_3D, VS::MULTIMESH_COLOR_NONE);
+				batch.data.resize(batch.capacity * 12);
+				batch.mesh = RID();
+			}
+
+			if (batch.mesh != leader->base) {
+				VSG::storage->multimesh_set_mesh(batch.multimesh, leader->base);
+				batch.mesh = leader->base;
+			}
+
+			Instance *proxy = batch.proxy;
+			proxy->base = batch.multimesh;
+			proxy->material_override = leader->material_override;
+			proxy->layer_mask = leader->layer_mask;
+			proxy->mirror = leader->mirror;
+			proxy->receive_shadows = leader->receive_shadows;
+			proxy->baked_light = leader->baked_light;
+			proxy->cast_shadows = leader->cast_shadows;
+			proxy->light_instances = leader->light_instances;
+			proxy->reflection_probe_instances = leader->reflection_probe_instances;
+			proxy->gi_probe_instances = leader->gi_probe_instances;
+			proxy->depth = leader->depth;
+			proxy->depth_layer = leader->depth_layer;
+			proxy->last_render_pass = render_pass;
+
+			{
+				PoolVector<float>::Write w = batch.data.write();
+				float *dataptr = w.ptr();
+
+				for (int j = i; j < to; j++) {
+
+					int index = instance_batch_sort[j].index;
+					if (index < 0) {
+						continue;
+					}
+
+					Instance *ins = instance_cull_result[index];
+					if (ins != leader && !_instance_batch_compatible(leader, ins)) {
+						continue;
+					}
+
+					const Transform &xform = ins->transform;
+					dataptr[0] = xform.basis.elements[0][0];
+					dataptr[1] = xform.basis.elements[0][1];
+					dataptr[2] = xform.basis.elements[0][2];
+					dataptr[3] = xform.origin.x;
+					dataptr[4] = xform.basis.elements[1][0];
+					dataptr[5] = xform.basis.elements[1][1];
+					dataptr[6] = xform.basis.elements[1][2];
+					dataptr[7] = xform.origin.y;
+					dataptr[8] = xform.basis.elements[2][0];
+					dataptr[9] = xform.basis.elements[2][1];
+					dataptr[10] = xform.basis.elements[2][2];
+					dataptr[11] = xform.origin.z;
+					dataptr += 12;
+
+					proxy->depth = MIN(proxy->depth, ins->depth);
+					proxy->depth_layer = MIN(proxy->depth_layer, ins->depth_layer);
+
+					instance_cull_result[index] = NULL;
+					instance_batch_sort[j].index = -1;
+				}
+			}
+
+			VSG::storage->multimesh_set_as_bulk_array(batch.multimesh, batch.data);
+			VSG::storage->multimesh_set_visible_instances(batch.multimesh, count);
+
+			//the batch is drawn where its first instance was
+			instance_cull_result[leader_index] = proxy;
+			instances_batched_in_frame += count;
+			merged = true;
+		}
+
+		from = to;
+	}
+
+	if (!merged) {
+		return;
+	}
+
+	VSG::storage->update_dirty_multimeshes(); //upload the batches now, the scene is rendered before the next resource update
+
+	int count = 0;
+	for (int i = 0; i < instance_cull_count; i++) {
+		if (instance_cull_result[i]) {
+			instance_cull_result[count++] = instance_cull_result[i];
+		}
+	}
+	instance_cull_count = count;
+}
+
+void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, RID p_view) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
 	// - p_cam_projection is a wider frustrum that encompasses both eyes
@@ -1834,168 +2354,142 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	instance_cull_count = scenario->sp.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
 
 	//light_samplers_culled=0;
 
-	/*
-	print_line("OT: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
-	print_line("OTO: "+itos(p_scenario->octree.get_octant_count()));
-	print_line("OTE: "+itos(p_scenario->octree.get_elem_count()));
-	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
-	*/
-
 	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
 	//removed, will replace with culling
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
-	for (int i = 0; i < instance_cull_count; i++) {
+	InstanceCullParams cull_params;
+	cull_params.near_plane = near_plane;
+	cull_params.z_far = z_far;
+	cull_params.camera_layer_mask = camera_layer_mask;
+	cull_params.occlusion_cull = occlusion_culling && _render_occluders(scenario, planes, p_cam_transform, p_cam_projection, camera_layer_mask);
+	cull_params.lod = mesh_lod;
+	cull_params.lod_view = p_view.get_id();
+	cull_params.cam_orthogonal = p_cam_orthogonal;
+	cull_params.cam_position = p_cam_transform.origin;
+	cull_params.lod_scale = p_cam_projection.matrix[1][1] * mesh_lod_bias;
+
+	int chunk_count = (instance_cull_count + INSTANCE_CULL_CHUNK_SIZE - 1) / INSTANCE_CULL_CHUNK_SIZE;
+	for (int i = 0; i < chunk_count; i++) {
+		instance_cull_chunks[i].from = i * INSTANCE_CULL_CHUNK_SIZE;
+		instance_cull_chunks[i].to = MIN((i + 1) * INSTANCE_CULL_CHUNK_SIZE, instance_cull_count);
+	}
 
-		Instance *ins = instance_cull_result[i];
+	if (threaded_cull) {
+		cull_work_pool.do_work(chunk_count, this, &VisualServerScene::_prepare_scene_cull_chunk, &cull_params);
+	} else {
+		for (int i = 0; i < chunk_count; i++) {
+			_prepare_scene_cull_chunk(i, &cull_params);
+		}
+	}
 
-		bool keep = false;
+	//gather the geometry kept by each chunk at the front of the cull result
+	instance_cull_count = 0;
+	bool redraw = false;
 
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
+	for (int i = 0; i < chunk_count; i++) {
 
-			//failure
-		} else if (ins->base_type == VS::INSTANCE_LIGHT && ins->visible) {
+		const InstanceCullChunk &chunk = instance_cull_chunks[i];
 
-			if (ins->visible && light_cull_count < MAX_LIGHTS_CULLED) {
+		if (chunk.geometry_count && chunk.from != instance_cull_count) {
+			memmove(&instance_cull_result[instance_cull_count], &instance_cull_result[chunk.from], sizeof(Instance *) * chunk.geometry_count);
+		}
+		instance_cull_count += chunk.geometry_count;
+		redraw = redraw || chunk.redraw;
+	}
 
-				InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
+	if (redraw) {
+		VisualServerRaster::redraw_request();
+	}
 
-				if (!light->geometries.empty()) {
-					//do not add this light if no geometry is affected by it..
-					light_cull_result[light_cull_count] = ins;
-					light_instance_cull_result[light_cull_count] = light->instance;
-					if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
-						VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
-					}
+	//lights, probes and particles touch shared state, process them here in cull order
+	for (int i = 0; i < chunk_count; i++) {
 
-					light_cull_count++;
-				}
-			}
-		} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE && ins->visible) {
+		const InstanceCullChunk &chunk = instance_cull_chunks[i];
 
-			if (ins->visible && reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
+		for (int j = 0; j < chunk.serial_count; j++) {
 
-				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
+			Instance *ins = instance_cull_serial[chunk.from + j];
+			ins->last_render_pass = 0; // make invalid
 
-				if (p_reflection_probe != reflection_probe->instance) {
-					//avoid entering The Matrix
+			if (ins->base_type == VS::INSTANCE_LIGHT) {
 
-					if (!reflection_probe->geometries.empty()) {
-						//do not add this light if no geometry is affected by it..
+				if (light_cull_count < MAX_LIGHTS_CULLED) {
 
-						if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
-							if (!reflection_probe->update_list.in_list()) {
-								reflection_probe->render_step = 0;
-								reflection_probe_render_list.add_last(&reflection_probe->update_list);
-							}
+					InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
 
-							reflection_probe->reflection_dirty = false;
+					if (!light->geometries.empty()) {
+						//do not add this light if no geometry is affected by it..
+						light_cull_result[light_cull_count] = ins;
+						light_instance_cull_result[light_cull_count] = light->instance;
+						if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
+							VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
 						}
 
-						if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
-							reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
-							reflection_probe_cull_count++;
-						}
+						light_cull_count++;
 					}
 				}
-			}
+			} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE) {
 
-		} else if (ins->base_type == VS::INSTANCE_GI_PROBE && ins->visible) {
+				if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
 
-			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
-			if (!gi_probe->update_element.in_list()) {
-				gi_probe_update_list.add(&gi_probe->update_element);
-			}
-
-		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
-
-			keep = true;
-
-			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
-
-			if (ins->redraw_if_visible) {
-				VisualServerRaster::redraw_request();
-			}
+					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
 
-			if (ins->base_type == VS::INSTANCE_PARTICLES) {
-				//particles visible? process them
-				if (VSG::storage->particles_is_inactive(ins->base)) {
-					//but if nothing is going on, don't do it.
-					keep = false;
-				} else {
-					VSG::storage->particles_request_process(ins->base);
-					//particles visible? request redraw
-					VisualServerRaster::redraw_request();
-				}
-			}
+					if (p_reflection_probe != reflection_probe->instance) {
+						//avoid entering The Matrix
 
-			if (geom->lighting_dirty) {
-				int l = 0;
-				//only called when lights AABB enter/exit this geometry
-				ins->light_instances.resize(geom->lighting.size());
+						if (!reflection_probe->geometries.empty()) {
+							//do not add this light if no geometry is affected by it..
 
-				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+							if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
+								if (!reflection_probe->update_list.in_list()) {
+									reflection_probe->render_step = 0;
+									reflection_probe_render_list.add_last(&reflection_probe->update_list);
+								}
 
-					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+								reflection_probe->reflection_dirty = false;
+							}
 
-					ins->light_instances.write[l++] = light->instance;
+							if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
+								reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
+								reflection_probe_cull_count++;
+							}
+						}
+					}
 				}
 
-				geom->lighting_dirty = false;
-			}
-
-			if (geom->reflection_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
-
-				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
-
-					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+			} else if (ins->base_type == VS::INSTANCE_GI_PROBE) {
 
-					ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
+				if (!gi_probe->update_element.in_list()) {
+					gi_probe_update_list.add(&gi_probe->update_element);
 				}
 
-				geom->reflection_dirty = false;
-			}
-
-			if (geom->gi_probes_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->gi_probe_instances.resize(geom->gi_probes.size());
-
-				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+			} else if (ins->base_type == VS::INSTANCE_PARTICLES) {
 
-					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+				//particles visible? process them, but if nothing is going on, don't do it.
+				if (!VSG::storage->particles_is_inactive(ins->base)) {
+					VSG::storage->particles_request_process(ins->base);
+					//particles visible? request redraw
+					VisualServerRaster::redraw_request();
 
-					ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+					ins->last_render_pass = render_pass;
+					instance_cull_result[instance_cull_count++] = ins;
 				}
-
-				geom->gi_probes_dirty = false;
 			}
-
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
 		}
+	}
 
-		if (!keep) {
-			// remove, no reason to keep
-			instance_cull_count--;
-			SWAP(instance_cull_result[i], instance_cull_result[instance_cull_count]);
-			i--;
-			ins->last_render_pass = 0; // make invalid
-		} else {
-
-			ins->last_render_pass = render_pass;
-		}
+	if (instance_batching) {
+		_batch_instances();
 	}
 
 	/* STEP 5 - PROCESS LIGHTS */
@@ -2234,7 +2728,7 @@ bool VisualServerScene::_render_reflection_probe_step(Instance *p_instance, int
 			shadow_atlas = scenario->reflection_probe_shadow_atlas;
 		}
 
-		_prepare_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance);
+		_prepare_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_instance->self);
 		_render_scene(xform, cm, false, RID(), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_step);
 
 	} else {
@@ -3411,6 +3905,55 @@ void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
 			}
 
 			geom->material_is_animated = is_animated;
+
+			// batches are drawn as a multimesh, which only uses the mesh materials
+			// or the override, and is depth sorted as a single element, so only
+			// opaque materials qualify, next passes included
+			bool can_batch = false;
+
+			if (p_instance->base_type == VS::INSTANCE_MESH) {
+
+				can_batch = true;
+
+				if (p_instance->material_override.is_valid()) {
+					can_batch = VSG::storage->material_is_opaque(p_instance->material_override);
+				} else {
+					for (int i = 0; i < p_instance->materials.size(); i++) {
+
+						if (p_instance->materials[i].is_valid()) {
+							can_batch = false;
+							break;
+						}
+
+						RID mat = VSG::storage->mesh_surface_get_material(p_instance->base, i);
+						if (mat.is_valid() && !VSG::storage->material_is_opaque(mat)) {
+							can_batch = false;
+							break;
+						}
+					}
+				}
+			}
+
+			geom->can_batch = can_batch;
+
+			// cache the LOD table, it is only changed through the mesh, which notifies this instance
+			geom->lod_meshes.clear();
+			geom->lod_screen_ratios.clear();
+			for (int i = 0; i < MAX_LOD_VIEWS; i++) {
+				geom->lod_views[i].last_pass = 0;
+			}
+
+			if (p_instance->base_type == VS::INSTANCE_MESH) {
+
+				int lod_count = VSG::storage->mesh_get_lod_count(p_instance->base);
+				geom->lod_meshes.resize(lod_count);
+				geom->lod_screen_ratios.resize(lod_count);
+
+				for (int i = 0; i < lod_count; i++) {
+					geom->lod_meshes.write[i] = VSG::storage->mesh_get_lod(p_instance->base, i);
+					geom->lod_screen_ratios.write[i] = VSG::storage->mesh_get_lod_screen_ratio(p_instance->base, i);
+				}
+			}
 		}
 	}
 
@@ -3422,6 +3965,23 @@ void VisualServerScene::_update_dirty_instance(Instance *p_instance) {
 	p_instance->update_materials = false;
 }
 
+void VisualServerScene::update_render_info() {
+
+	instances_batched_last_frame = instances_batched_in_frame;
+	instances_batched_in_frame = 0;
+}
+
+void VisualServerScene::free_instance_batches() {
+
+	for (int i = 0; i < instance_batches.size(); i++) {
+		if (instance_batches[i].multimesh.is_valid()) {
+			VSG::storage->free(instance_batches[i].multimesh);
+		}
+		memdelete(instance_batches[i].proxy);
+	}
+	instance_batches.clear();
+}
+
 void VisualServerScene::update_dirty_instances() {
 
 	VSG::storage->update_dirty_resources();
@@ -3441,6 +4001,16 @@ bool VisualServerScene::free(RID p_rid) {
 		camera_owner.free(p_rid);
 		memdelete(camera);
 
+	} else if (occluder_owner.owns(p_rid)) {
+
+		Occluder *occluder = occluder_owner.get(p_rid);
+
+		while (occluder->users.front()) {
+			instance_set_base(occluder->users.front()->get()->self, RID());
+		}
+		occluder_owner.free(p_rid);
+		memdelete(occluder);
+
 	} else if (scenario_owner.owns(p_rid)) {
 
 		Scenario *scenario = scenario_owner.get(p_rid);
@@ -3490,6 +4060,28 @@ VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+
+	use_bvh = GLOBAL_DEF("rendering/quality/spatial_partitioning/use_bvh", false);
+
+	occlusion_culling = GLOBAL_DEF("rendering/quality/occlusion_culling/enable", false);
+	occlusion_culler.set_width(GLOBAL_DEF("rendering/quality/occlusion_culling/buffer_width", 256));
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/occlusion_culling/buffer_width", PropertyInfo(Variant::INT, "rendering/quality/occlusion_culling/buffer_width", PROPERTY_HINT_RANGE, "64,1024"));
+
+	instance_batching = GLOBAL_DEF("rendering/quality/instance_batching/enable", false);
+	instance_batching_min_instances = MAX(2, int(GLOBAL_DEF("rendering/quality/instance_batching/min_instances", 8)));
+	instances_batched_in_frame = 0;
+	instances_batched_last_frame = 0;
+
+	mesh_lod = GLOBAL_DEF("rendering/quality/lod/enable", true);
+	mesh_lod_hysteresis = GLOBAL_DEF("rendering/quality/lod/hysteresis", 0.1);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/lod/hysteresis", PropertyInfo(Variant::REAL, "rendering/quality/lod/hysteresis", PROPERTY_HINT_RANGE, "0,0.5,0.01"));
+	mesh_lod_bias = GLOBAL_DEF("rendering/quality/lod/bias", 1.0);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/lod/bias", PropertyInfo(Variant::REAL, "rendering/quality/lod/bias", PROPERTY_HINT_RANGE, "0.1,4,0.01"));
+
+	threaded_cull = GLOBAL_DEF("rendering/threads/threaded_culling", true);
+	if (threaded_cull) {
+		cull_work_pool.init();
+	}
 }
 
 VisualServerScene::~VisualServerScene() {
@@ -3503,4 +4095,10 @@ VisualServerScene::~VisualServerScene() {
 	memdelete(probe_bake_mutex);
 
 #endif
+
+	cull_work_pool.finish();
+
+	for (int i = 0; i < instance_batches.size(); i++) {
+		memdelete(instance_batches[i].proxy);
+	}
 }
@@ -33,12 +33,15 @@
 
 #include "servers/visual/rasterizer.h"
 
+#include "core/math/bvh.h"
 #include "core/math/geometry.h"
 #include "core/math/octree.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
+#include "core/os/thread_work_pool.h"
 #include "core/self_list.h"
 #include "servers/arvr/arvr_interface.h"
+#include "servers/visual/occlusion_culler.h"
 
 class VisualServerScene {
 public:
@@ -47,8 +50,12 @@ public:
 		MAX_INSTANCE_CULL = 65536,
 		MAX_LIGHTS_CULLED = 4096,
 		MAX_REFLECTION_PROBES_CULLED = 4096,
+		MAX_OCCLUDERS_CULLED = 1024,
 		MAX_ROOM_CULL = 32,
 		MAX_EXTERIOR_PORTALS = 128,
+		INSTANCE_CULL_CHUNK_SIZE = 1024,
+		MAX_INSTANCE_CULL_CHUNKS = MAX_INSTANCE_CULL / INSTANCE_CULL_CHUNK_SIZE,
+		MAX_LOD_VIEWS = 4,
 	};
 
 	uint64_t render_pass;
@@ -111,16 +118,91 @@ public:
 	virtual void camera_set_environment(RID p_camera, RID p_env);
 	virtual void camera_set_use_vertical_aspect(RID p_camera, bool p_enable);
 
-	/* SCENARIO API */
+	/* OCCLUDER API */
 
 	struct Instance;
 
+	struct Occluder : RID_Data {
+
+		PoolVector<Vector3> vertices;
+		PoolVector<int> indices;
+		AABB aabb;
+
+		Set<Instance *> users;
+	};
+
+	mutable RID_Owner<Occluder> occluder_owner;
+
+	virtual RID occluder_create();
+	virtual void occluder_set_mesh(RID p_occluder, const PoolVector<Vector3> &p_vertices, const PoolVector<int> &p_indices);
+
+	/* SCENARIO API */
+
+	typedef uint32_t SpatialPartitionID;
+
+	// Spatial index of a scenario, either an Octree or a BVH depending on
+	// rendering/quality/spatial_partitioning/use_bvh. Only one is ever used.
+	struct SpatialPartition {
+
+		typedef void *(*PairCallback)(void *, SpatialPartitionID, Instance *, int, SpatialPartitionID, Instance *, int);
+		typedef void (*UnpairCallback)(void *, SpatialPartitionID, Instance *, int, SpatialPartitionID, Instance *, int, void *);
+
+		bool use_bvh;
+		Octree<Instance, true> octree;
+		BVH<Instance, true> bvh;
+
+		_FORCE_INLINE_ SpatialPartitionID create(Instance *p_userdata, const AABB &p_aabb, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+			return use_bvh ? bvh.create(p_userdata, p_aabb, 0, p_pairable, p_pairable_type, p_pairable_mask) : octree.create(p_userdata, p_aabb, 0, p_pairable, p_pairable_type, p_pairable_mask);
+		}
+		_FORCE_INLINE_ void move(SpatialPartitionID p_id, const AABB &p_aabb) {
+			if (use_bvh) {
+				bvh.move(p_id, p_aabb);
+			} else {
+				octree.move(p_id, p_aabb);
+			}
+		}
+		_FORCE_INLINE_ void erase(SpatialPartitionID p_id) {
+			if (use_bvh) {
+				bvh.erase(p_id);
+			} else {
+				octree.erase(p_id);
+			}
+		}
+		_FORCE_INLINE_ void set_pairable(SpatialPartitionID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+			if (use_bvh) {
+				bvh.set_pairable(p_id, p_pairable, p_pairable_type, p_pairable_mask);
+			} else {
+				octree.set_pairable(p_id, p_pairable, p_pairable_type, p_pairable_mask);
+			}
+		}
+		_FORCE_INLINE_ int cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) {
+			return use_bvh ? bvh.cull_convex(p_convex, p_result_array, p_result_max, p_mask) : octree.cull_convex(p_convex, p_result_array, p_result_max, p_mask);
+		}
+		_FORCE_INLINE_ int cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max) {
+			return use_bvh ? bvh.cull_aabb(p_aabb, p_result_array, p_result_max) : octree.cull_aabb(p_aabb, p_result_array, p_result_max);
+		}
+		_FORCE_INLINE_ int cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max) {
+			return use_bvh ? bvh.cull_segment(p_from, p_to, p_result_array, p_result_max) : octree.cull_segment(p_from, p_to, p_result_array, p_result_max);
+		}
+		void set_pair_callbacks(PairCallback p_pair_callback, UnpairCallback p_unpair_callback, void *p_userdata) {
+			if (use_bvh) {
+				bvh.set_pair_callback(p_pair_callback, p_userdata);
+				bvh.set_unpair_callback(p_unpair_callback, p_userdata);
+			} else {
+				octree.set_pair_callback(p_pair_callback, p_userdata);
+				octree.set_unpair_callback(p_unpair_callback, p_userdata);
+			}
+		}
+
+		SpatialPartition() { use_bvh = false; }
+	};
+
 	struct Scenario : RID_Data {
 
 		VS::ScenarioDebugMode debug;
 		RID self;
 
-		Octree<Instance, true> octree;
+		SpatialPartition sp;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -135,8 +217,10 @@ public:
 
 	mutable RID_Owner<Scenario> scenario_owner;
 
-	static void *_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int);
-	static void _instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *);
+	bool use_bvh;
+
+	static void *_instance_pair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int);
+	static void _instance_unpair(void *p_self, SpatialPartitionID, Instance *p_A, int, SpatialPartitionID, Instance *p_B, int, void *);
 
 	virtual RID scenario_create();
 
@@ -156,7 +240,7 @@ public:
 
 		RID self;
 		//scenario stuff
-		OctreeElementID octree_id;
+		SpatialPartitionID spatial_partition_id;
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -199,7 +283,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 
-			octree_id = 0;
+			spatial_partition_id = 0;
 			scenario = NULL;
 
 			update_aabb = false;
@@ -241,6 +325,7 @@ public:
 		bool lighting_dirty;
 		bool can_cast_shadows;
 		bool material_is_animated;
+		bool can_batch;
 
 		List<Instance *> reflection_probes;
 		bool reflection_dirty;
@@ -250,13 +335,40 @@ public:
 
 		List<Instance *> lightmap_captures;
 
+		//mesh LODs, the proxy is drawn in place of the instance when a reduced level is selected
+		Vector<RID> lod_meshes;
+		Vector<float> lod_screen_ratios;
+		Instance *lod_proxy;
+
+		//the level last selected by each view, kept apart so the hysteresis of one camera does not move another
+		struct LODView {
+			uint32_t view;
+			int lod;
+			uint64_t last_pass;
+		};
+
+		LODView lod_views[MAX_LOD_VIEWS];
+
 		InstanceGeometryData() {
 
 			lighting_dirty = false;
 			reflection_dirty = true;
 			can_cast_shadows = true;
 			material_is_animated = true;
+			can_batch = false;
 			gi_probes_dirty = true;
+			lod_proxy = NULL;
+			for (int i = 0; i < MAX_LOD_VIEWS; i++) {
+				lod_views[i].view = 0;
+				lod_views[i].lod = 0;
+				lod_views[i].last_pass = 0;
+			}
+		}
+
+		~InstanceGeometryData() {
+
+			if (lod_proxy)
+				memdelete(lod_proxy);
 		}
 	};
 
@@ -444,6 +556,81 @@ public:
 	RID reflection_probe_instance_cull_result[MAX_REFLECTION_PROBES_CULLED];
 	int reflection_probe_cull_count;
 
+	// Culled instances are classified in chunks, possibly on several threads.
+	// Each chunk compacts the geometry it keeps at the start of its own range
+	// in instance_cull_result, and stores instances that must be processed on
+	// the calling thread (lights, probes, particles) in the same range of
+	// instance_cull_serial.
+	struct InstanceCullChunk {
+		int from;
+		int to;
+		int geometry_count;
+		int serial_count;
+		bool redraw;
+	};
+
+	struct InstanceCullParams {
+		Plane near_plane;
+		float z_far;
+		uint32_t camera_layer_mask;
+		bool occlusion_cull;
+		bool lod;
+		uint32_t lod_view;
+		bool cam_orthogonal;
+		Vector3 cam_position;
+		float lod_scale;
+	};
+
+	InstanceCullChunk instance_cull_chunks[MAX_INSTANCE_CULL_CHUNKS];
+	Instance *instance_cull_serial[MAX_INSTANCE_CULL];
+	ThreadWorkPool cull_work_pool;
+	bool threaded_cull;
+
+	Instance *occluder_cull_result[MAX_OCCLUDERS_CULLED];
+	OcclusionCuller occlusion_culler;
+	bool occlusion_culling;
+
+	bool _render_occluders(Scenario *p_scenario, const Vector<Plane> &p_planes, const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, uint32_t p_visible_layers);
+
+	// Visible mesh instances sharing mesh, materials and lighting are drawn
+	// together through a transient multimesh. The proxy instance takes the
+	// place of the whole group in the cull result.
+	struct InstanceBatch {
+		Instance *proxy;
+		RID multimesh;
+		RID mesh;
+		int capacity;
+		PoolVector<float> data;
+	};
+
+	struct InstanceBatchSort {
+		uint32_t hash;
+		int index;
+
+		_FORCE_INLINE_ bool operator<(const InstanceBatchSort &p_r) const {
+			return hash < p_r.hash || (hash == p_r.hash && index < p_r.index);
+		}
+	};
+
+	Vector<InstanceBatch> instance_batches;
+	InstanceBatchSort instance_batch_sort[MAX_INSTANCE_CULL];
+	bool instance_batching;
+	int instance_batching_min_instances;
+	int instances_batched_in_frame;
+	int instances_batched_last_frame;
+
+	static uint32_t _instance_batch_hash(const Instance *p_instance);
+	static bool _instance_batch_compatible(const Instance *p_a, const Instance *p_b);
+	void _batch_instances();
+
+	bool mesh_lod;
+	float mesh_lod_hysteresis;
+	float mesh_lod_bias;
+
+	Instance *_instance_select_lod(Instance *p_instance, InstanceGeometryData *p_geom, const InstanceCullParams *p_params);
+
+	void _prepare_scene_cull_chunk(uint32_t p_chunk, InstanceCullParams *p_params);
+
 	RID_Owner<Instance> instance_owner;
 
 	// from can be mesh, light,  area and portal so far.
@@ -485,7 +672,7 @@ public:
 
 	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
 
-	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe);
+	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, RID p_view);
 	void _render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass);
 	void render_empty_scene(RID p_scenario, RID p_shadow_atlas);
 
@@ -493,6 +680,10 @@ public:
 	void render_camera(Ref<ARVRInterface> &p_interface, ARVRInterface::Eyes p_eye, RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas);
 	void update_dirty_instances();
 
+	void update_render_info();
+	int get_instances_batched_in_frame() const { return instances_batched_last_frame; }
+	void free_instance_batches();
+
 	//probes
 	struct GIProbeDataHeader {
 
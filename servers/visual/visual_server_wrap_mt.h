@@ -181,6 +181,12 @@ public:
 
 	FUNC1(mesh_clear, RID)
 
+	FUNC5(mesh_add_lod_surface, RID, RID, int, const PoolVector<uint8_t> &, int)
+	FUNC3(mesh_set_lods, RID, const Vector<RID> &, const Vector<float> &)
+	FUNC1RC(int, mesh_get_lod_count, RID)
+	FUNC2RC(RID, mesh_get_lod, RID, int)
+	FUNC2RC(float, mesh_get_lod_screen_ratio, RID, int)
+
 	/* MULTIMESH API */
 
 	FUNCRID(multimesh)
@@ -231,6 +237,7 @@ public:
 	FUNC2RC(Transform, skeleton_bone_get_transform, RID, int)
 	FUNC3(skeleton_bone_set_transform_2d, RID, int, const Transform2D &)
 	FUNC2RC(Transform2D, skeleton_bone_get_transform_2d, RID, int)
+	FUNC2(skeleton_set_bones_as_bulk_array, RID, const PoolVector<float> &)
 	FUNC2(skeleton_set_base_transform_2d, RID, const Transform2D &)
 	FUNC3(skeleton_set_world_transform, RID, bool, const Transform &)
 
@@ -365,6 +372,11 @@ public:
 	FUNC2(camera_set_environment, RID, RID)
 	FUNC2(camera_set_use_vertical_aspect, RID, bool)
 
+	/* OCCLUDER API */
+
+	FUNCRID(occluder)
+	FUNC3(occluder_set_mesh, RID, const PoolVector<Vector3> &, const PoolVector<int> &)
+
 	/* VIEWPORT TARGET API */
 
 	FUNCRID(viewport)
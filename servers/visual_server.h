@@ -324,6 +324,12 @@ public:
 
 	virtual void mesh_clear(RID p_mesh) = 0;
 
+	virtual void mesh_add_lod_surface(RID p_mesh, RID p_source_mesh, int p_source_surface, const PoolVector<uint8_t> &p_index_array, int p_index_count) = 0;
+	virtual void mesh_set_lods(RID p_mesh, const Vector<RID> &p_lods, const Vector<float> &p_screen_ratios) = 0;
+	virtual int mesh_get_lod_count(RID p_mesh) const = 0;
+	virtual RID mesh_get_lod(RID p_mesh, int p_lod) const = 0;
+	virtual float mesh_get_lod_screen_ratio(RID p_mesh, int p_lod) const = 0;
+
 	/* MULTIMESH API */
 
 	virtual RID multimesh_create() = 0;
@@ -392,6 +398,7 @@ public:
 	virtual Transform skeleton_bone_get_transform(RID p_skeleton, int p_bone) const = 0;
 	virtual void skeleton_bone_set_transform_2d(RID p_skeleton, int p_bone, const Transform2D &p_transform) = 0;
 	virtual Transform2D skeleton_bone_get_transform_2d(RID p_skeleton, int p_bone) const = 0;
+	virtual void skeleton_set_bones_as_bulk_array(RID p_skeleton, const PoolVector<float> &p_array) = 0;
 	virtual void skeleton_set_base_transform_2d(RID p_skeleton, const Transform2D &p_base_transform) = 0;
 	virtual void skeleton_set_world_transform(RID p_skeleton, bool p_enable, const Transform &p_base_transform) = 0;
 
@@ -589,6 +596,11 @@ public:
 	virtual void camera_set_environment(RID p_camera, RID p_env) = 0;
 	virtual void camera_set_use_vertical_aspect(RID p_camera, bool p_enable) = 0;
 
+	/* OCCLUDER API */
+
+	virtual RID occluder_create() = 0;
+	virtual void occluder_set_mesh(RID p_occluder, const PoolVector<Vector3> &p_vertices, const PoolVector<int> &p_indices) = 0;
+
 	/*
 	enum ParticlesCollisionMode {
 		PARTICLES_COLLISION_NONE,
@@ -798,6 +810,7 @@ public:
 		INSTANCE_REFLECTION_PROBE,
 		INSTANCE_GI_PROBE,
 		INSTANCE_LIGHTMAP_CAPTURE,
+		INSTANCE_OCCLUDER,
 		INSTANCE_MAX,
 
 		INSTANCE_GEOMETRY_MASK = (1 << INSTANCE_MESH) | (1 << INSTANCE_MULTIMESH) | (1 << INSTANCE_IMMEDIATE) | (1 << INSTANCE_PARTICLES)
@@ -1005,6 +1018,7 @@ public:
 		INFO_VIDEO_MEM_USED,
 		INFO_TEXTURE_MEM_USED,
 		INFO_VERTEX_MEM_USED,
+		INFO_INSTANCES_BATCHED_IN_FRAME,
 	};
 
 	virtual int get_render_info(RenderInfo p_info) = 0;